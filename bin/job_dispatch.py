@@ -18,6 +18,11 @@ try:
 except ImportError:
     from ert_statoil.job_manager import JobManager, assert_file_executable
 
+try:
+    from res.job_queue import LicenseSemaphore
+except ImportError:
+    LicenseSemaphore = None
+
 REQUESTED_HEXVERSION  =  0x02070000
 
 LOG_URL       = "http://devnull.statoil.no:4444"
@@ -123,6 +128,8 @@ def cleanup( job ):
         unlink_empty( job["stdout"] )
     if job.get("stderr"):
         unlink_empty( job["stderr"] )
+    if job.get("license_semaphore"):
+        job["license_semaphore"].release()
     if job.get("license_link"):
         os.unlink(job["license_link"])
 
@@ -142,10 +149,21 @@ def cleanup( job ):
 #     file - this is how the number of concurrent uses is counted.
 #
 #  4. When the external program is finished the hard link is removed.
+#
+# The hard link counting is only used as a fallback when the
+# LicenseSemaphore class is not available; the semaphore uses file
+# locks which are released automatically if the job is killed, and
+# grants the slots in FIFO order.
 
 
 def license_check( job ):
     job["license_link"] = None
+    job["license_semaphore"] = None
+    if job.get("max_running") and LicenseSemaphore is not None:
+        job["license_semaphore"] = LicenseSemaphore( job["license_path"] , job["name"] , job["max_running"] )
+        job["license_semaphore"].acquire( )
+        return
+
     if "max_running" in job:
         if job["max_running"]:
             job["license_file"] = "%s/%s" % (job["license_path"] , job["name"])
@@ -45,6 +45,10 @@ struct analysis_module_struct {
   analysis_init_update_ftype     * init_update;
   analysis_complete_update_ftype * complete_update;
 
+  analysis_initX_covar_ftype       * initX_covar;
+  analysis_updateA_covar_ftype     * updateA_covar;
+  analysis_init_update_covar_ftype * init_update_covar;
+
   analysis_get_options_ftype     * get_options;
   analysis_set_int_ftype         * set_int;
   analysis_set_double_ftype      * set_double;
@@ -78,6 +82,9 @@ static analysis_module_type * analysis_module_alloc_empty( const char * symbol_t
   module->module_data     = NULL;
   module->init_update     = NULL;
   module->complete_update = NULL;
+  module->initX_covar       = NULL;
+  module->updateA_covar     = NULL;
+  module->init_update_covar = NULL;
   module->has_var         = NULL;
   module->get_int         = NULL;
   module->get_double      = NULL;
@@ -102,6 +109,7 @@ static bool analysis_module_internal_check( analysis_module_type * module ) {
 
 
 static analysis_module_type * analysis_module_alloc__( const analysis_table_type * table ,
+                                                       const analysis_covar_table_type * covar_table ,
                                                        const char * symbol_table ,
                                                        const char * lib_name ,
                                                        void * lib_handle ) {
@@ -125,6 +133,11 @@ static analysis_module_type * analysis_module_alloc__( const analysis_table_type
   module->get_double        = table->get_double;
   module->get_bool          = table->get_bool;
   module->get_ptr           = table->get_ptr;
+  if (covar_table) {
+    module->initX_covar       = covar_table->initX;
+    module->updateA_covar     = covar_table->updateA;
+    module->init_update_covar = covar_table->init_update;
+  }
   analysis_module_set_name( module , table->name );
 
   if (module->alloc)
@@ -152,8 +165,12 @@ static analysis_module_type * analysis_module_alloc( const char * libname ,
   if (lib_handle != NULL) {
     analysis_table_type * analysis_table = (analysis_table_type *) dlsym( lib_handle , table_name );
     if (analysis_table != NULL) {
+      char * covar_table_name = util_alloc_sprintf( "%s%s" , table_name , ANALYSIS_COVAR_TABLE_SUFFIX );
+      analysis_covar_table_type * covar_table = (analysis_covar_table_type *) dlsym( lib_handle , covar_table_name );
+
       *load_status = LOAD_OK;
-      module = analysis_module_alloc__( analysis_table , table_name , libname , lib_handle );
+      module = analysis_module_alloc__( analysis_table , covar_table , table_name , libname , lib_handle );
+      free( covar_table_name );
     } else {
       *load_status = LOAD_SYMBOL_TABLE_NOT_FOUND;
       if (verbose)
@@ -248,6 +265,33 @@ void analysis_module_free__( void * arg) {
 /* Update functions */
 
 
+/*
+  The update can be called with R either as a obs_covar instance or as
+  a dense matrix, and the module can implement either of the two
+  signatures; when they do not match R is converted. Modules which only
+  have the dense entries get R from obs_covar_alloc_matrix().
+*/
+
+void analysis_module_initX_covar(analysis_module_type * module ,
+                                 matrix_type * X ,
+                                 matrix_type * A ,
+                                 matrix_type * S ,
+                                 const obs_covar_type * R ,
+                                 matrix_type * dObs ,
+                                 matrix_type * E ,
+                                 matrix_type * D,
+                                 rng_type * rng) {
+
+  if (module->initX_covar != NULL)
+    module->initX_covar(module->module_data , X , A , S , R , dObs , E , D, rng);
+  else {
+    matrix_type * dense_R = obs_covar_alloc_matrix( R );
+    module->initX(module->module_data , X , A , S , dense_R , dObs , E , D, rng);
+    matrix_free( dense_R );
+  }
+}
+
+
 void analysis_module_initX(analysis_module_type * module ,
                            matrix_type * X ,
                            matrix_type * A ,
@@ -258,8 +302,32 @@ void analysis_module_initX(analysis_module_type * module ,
                            matrix_type * D,
                            rng_type * rng) {
 
+  if (module->initX_covar != NULL) {
+    obs_covar_type * covar = obs_covar_alloc_from_matrix( R );
+    module->initX_covar(module->module_data , X , A , S , covar , dObs , E , D, rng);
+    obs_covar_free( covar );
+  } else
+    module->initX(module->module_data , X , A , S , R , dObs , E , D, rng);
+}
+
 
-  module->initX(module->module_data , X , A , S , R , dObs , E , D, rng);
+void analysis_module_updateA_covar(analysis_module_type * module ,
+                                   matrix_type * A ,
+                                   matrix_type * S ,
+                                   const obs_covar_type * R ,
+                                   matrix_type * dObs ,
+                                   matrix_type * E ,
+                                   matrix_type * D ,
+                                   const module_info_type* module_info,
+                                   rng_type * rng) {
+
+  if (module->updateA_covar != NULL)
+    module->updateA_covar(module->module_data , A , S , R , dObs , E , D, module_info, rng);
+  else {
+    matrix_type * dense_R = obs_covar_alloc_matrix( R );
+    module->updateA(module->module_data , A , S , dense_R , dObs , E , D, module_info, rng);
+    matrix_free( dense_R );
+  }
 }
 
 
@@ -273,12 +341,35 @@ void analysis_module_updateA(analysis_module_type * module ,
                              const module_info_type* module_info,
                              rng_type * rng) {
 
-  module->updateA(module->module_data , A , S , R , dObs , E , D, module_info, rng);
+  if (module->updateA_covar != NULL) {
+    obs_covar_type * covar = obs_covar_alloc_from_matrix( R );
+    module->updateA_covar(module->module_data , A , S , covar , dObs , E , D, module_info, rng);
+    obs_covar_free( covar );
+  } else
+    module->updateA(module->module_data , A , S , R , dObs , E , D, module_info, rng);
 }
 
 
 
 
+void analysis_module_init_update_covar( analysis_module_type * module ,
+                                        const bool_vector_type * ens_mask ,
+                                        const matrix_type * S ,
+                                        const obs_covar_type * R ,
+                                        const matrix_type * dObs ,
+                                        const matrix_type * E ,
+                                        const matrix_type * D,
+                                        rng_type * rng) {
+  if (module->init_update_covar != NULL)
+    module->init_update_covar( module->module_data , ens_mask , S , R , dObs , E , D, rng);
+  else if (module->init_update != NULL) {
+    matrix_type * dense_R = obs_covar_alloc_matrix( R );
+    module->init_update( module->module_data , ens_mask , S , dense_R , dObs , E , D, rng);
+    matrix_free( dense_R );
+  }
+}
+
+
 void analysis_module_init_update( analysis_module_type * module ,
                                   const bool_vector_type * ens_mask ,
                                   const matrix_type * S ,
@@ -287,7 +378,11 @@ void analysis_module_init_update( analysis_module_type * module ,
                                   const matrix_type * E ,
                                   const matrix_type * D,
                                   rng_type * rng) {
-  if (module->init_update != NULL)
+  if (module->init_update_covar != NULL) {
+    obs_covar_type * covar = obs_covar_alloc_from_matrix( R );
+    module->init_update_covar( module->module_data , ens_mask , S , covar , dObs , E , D, rng);
+    obs_covar_free( covar );
+  } else if (module->init_update != NULL)
     module->init_update( module->module_data , ens_mask , S , R , dObs , E , D, rng);
 }
 
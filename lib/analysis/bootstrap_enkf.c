@@ -134,7 +134,7 @@ static void free_iens_resample( int ** iens_resample, int ens_size ) {
 void bootstrap_enkf_updateA(void * module_data ,
                             matrix_type * A ,
                             matrix_type * S ,
-                            matrix_type * R ,
+                            const obs_covar_type * R ,
                             matrix_type * dObs ,
                             matrix_type * E ,
                             matrix_type * D ,
@@ -286,7 +286,7 @@ analysis_table_type LINK_NAME = {
   .set_string      = NULL ,
   .get_options     = bootstrap_enkf_get_options ,
   .initX           = NULL,
-  .updateA         = bootstrap_enkf_updateA,
+  .updateA         = NULL,
   .init_update     = NULL,
   .complete_update = NULL,
   .has_var         = bootstrap_enkf_has_var,
@@ -295,3 +295,10 @@ analysis_table_type LINK_NAME = {
   .get_bool        = NULL,
   .get_ptr         = NULL,
 };
+
+
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+  .initX       = NULL,
+  .updateA     = bootstrap_enkf_updateA,
+  .init_update = NULL,
+};
@@ -123,7 +123,7 @@ void cv_enkf_data_free( void * arg ) {
 void cv_enkf_init_update( void * arg ,
                           const bool_vector_type * ens_mask ,
                           const matrix_type * S ,
-                          const matrix_type * R ,
+                          const obs_covar_type * R ,
                           const matrix_type * dObs ,
                           const matrix_type * E ,
                           const matrix_type * D,
@@ -169,12 +169,7 @@ void cv_enkf_init_update( void * arg ,
         matrix_iset( cv_data->Z , i , j , sig0[i] * matrix_iget( V0T , i , j ) );
 
     /* Also compute Rp */
-    {
-      matrix_type * X0 = matrix_alloc( nrmin , matrix_get_rows( R ));
-      matrix_dgemm(X0 , U0 , R  , true  , false , 1.0 , 0.0);   /* X0 = U0^T * R */
-      matrix_dgemm(cv_data->Rp  , X0 , U0 , false , false , 1.0 , 0.0);  /* Rp = X0 * U0 */
-      matrix_free(X0);
-    }
+    obs_covar_quadratic_form( R , U0 , cv_data->Rp );   /* Rp = U0^T * R * U0 */
 
     /*We also need to compute the reduced "Innovation matrix" Dp = U0' * D    */
     matrix_dgemm(cv_data->Dp , U0 , D , true , false , 1.0 , 0.0);
@@ -198,7 +193,7 @@ void cv_enkf_init_update( void * arg ,
 /*Function that computes the PRESS for different subspace dimensions using
   m-fold CV
   INPUT :
-  A   : State-Vector ensemble matrix
+  G   : The Gram matrix A' * A of the (centered) State-Vector ensemble matrix
   Z   : Ensemble matrix of principal components
   Rp  : Reduced order Observation error matrix
   indexTrain: index of training ensemble
@@ -210,36 +205,41 @@ void cv_enkf_init_update( void * arg ,
   OUTPUT:
   cvErr : UPDATED MATRIX OF PRESS VALUES
 
+  The prediction error of the test ensemble can be written as
+
+     ATest - AHat = A[:,indexTest] - A[:,indexTrain] * W2 = A * C
+
+  where C (nrens x nTest) is the selection of the test members minus
+  W2 scattered to the rows of the training members. The PRESS
+  statistic is then
+
+     |A * C|^2 = trace( C' * (A' * A) * C ) = sum( C .* (G * C) )
+
+  i.e. the state vector only enters through G which is computed once
+  for all the folds and subspace dimensions; the cost of each (p , fold)
+  combination is independent of the size of the state vector.
 */
 
 static void cv_enkf_get_cv_error_prin_comp( cv_enkf_data_type * cv_data ,
-                                                  matrix_type * cvErr ,
-                                                  const matrix_type * A ,
-                                                  const int * indexTest,
-                                                  const int * indexTrain ,
-                                                  const int nTest ,
-                                                  const int nTrain ,
-                                                  const int foldIndex,
-                                                  const int maxP) {
+                                            matrix_type * cvErr ,
+                                            const matrix_type * G ,
+                                            const int * indexTest,
+                                            const int * indexTrain ,
+                                            const int nTest ,
+                                            const int nTrain ,
+                                            const int foldIndex,
+                                            const int maxP) {
   /*
       We need to predict ATest(p), for p = 1,...,nens -1, based on the estimated regression model:
       AHatTest(p) = A[:,indexTrain] * Z[1:p,indexTrain]'* inv( Z[1:p,indexTrain] * Z[1:p,indexTrain]' + (nens-1) * Rp[1:p,1:p] ) * Z[1:p,indexTest];
   */
 
-
-  const int nx         = matrix_get_rows( A );
-  matrix_type * AHat   = matrix_alloc(nx , nTest );
-  matrix_type * ATrain = matrix_alloc( nx , nTrain );
+  const int nrens    = matrix_get_rows( G );
+  matrix_type * C    = matrix_alloc( nrens , nTest );
+  matrix_type * GC   = matrix_alloc( nrens , nTest );
 
   int p,i,j;
 
-
-  /* Copy elements*/
-  for (i = 0; i < nx; i++)
-    for (j = 0; j < nTrain; j++)
-      matrix_iset(ATrain , i , j , matrix_iget( A , i , indexTrain[j]));
-
-
   for (p = 0; p < maxP; p++) {
     matrix_type * ZpTrain = matrix_alloc( p + 1, nTrain );
     matrix_type *SigDp    = matrix_alloc( p + 1 , p + 1);
@@ -284,8 +284,12 @@ static void cv_enkf_get_cv_error_prin_comp( cv_enkf_data_type * cv_data ,
       /* W2 = ZpTrain' * W */
       matrix_dgemm( W2 , ZpTrain , W , true , false , 1.0 , 0.0);
 
-      /* Estimate the state-vector */
-      matrix_matmul( AHat , ATrain , W2 );
+      /* C = I[:,indexTest] - I[:,indexTrain] * W2 */
+      for (j = 0; j < nTest; j++) {
+        matrix_iset( C , indexTest[j] , j , 1.0 );
+        for (i = 0; i < nTrain; i++)
+          matrix_iset( C , indexTrain[i] , j , -matrix_iget( W2 , i , j ));
+      }
 
       matrix_free( W2 );
       matrix_free( W );
@@ -296,12 +300,11 @@ static void cv_enkf_get_cv_error_prin_comp( cv_enkf_data_type * cv_data ,
     {
       double R2Sum = 0;
 
-      for (i = 0; i < nx; i++) {
-        for (j = 0; j < nTest; j++) {
-          double tmp = matrix_iget(A , i , indexTest[j]) - matrix_iget(AHat , i , j);
-          R2Sum += tmp * tmp;
-        }
-      }
+      matrix_matmul( GC , G , C );
+      for (j = 0; j < nTest; j++)
+        for (i = 0; i < nrens; i++)
+          R2Sum += matrix_iget( C , i , j ) * matrix_iget( GC , i , j );
+
       matrix_iset( cvErr , p , foldIndex , R2Sum );
     }
 
@@ -311,11 +314,93 @@ static void cv_enkf_get_cv_error_prin_comp( cv_enkf_data_type * cv_data ,
     matrix_free( SigDp );
   } /*end for p */
 
-  matrix_free( AHat );
-  matrix_free( ATrain );
+  matrix_free( GC );
+  matrix_free( C );
+}
+
+
+/*
+  Computes the PRESS values, a maxP x nfolds matrix, for the (row
+  centered) state ensemble @A; @randperms is a permutation of the
+  ensemble members which is used to assign the members to folds.
+*/
+
+matrix_type * cv_enkf_alloc_cv_error( cv_enkf_data_type * cv_data ,
+                                      const matrix_type * A ,
+                                      const int * randperms ,
+                                      int maxP) {
+  const int nrens = matrix_get_columns( cv_data->Z );
+  matrix_type * cvError = matrix_alloc( maxP , cv_data->nfolds );
+  matrix_type * G = matrix_alloc( nrens , nrens );
+
+  /* G = A' * A; this is the only place where the full state vector is used. */
+  matrix_dgemm( G , A , A , true , false , 1.0 , 0.0 );
+  {
+    int ntest, ntrain, k,j,i;
+    int * indexTest  = util_calloc( nrens , sizeof * indexTest  );
+    int * indexTrain = util_calloc( nrens , sizeof * indexTrain );
+    for (i = 0; i < cv_data->nfolds; i++) {
+      ntest = 0;
+      ntrain = 0;
+      k = i;
+      /*extract members for the training and test ensembles */
+      for (j = 0; j < nrens; j++) {
+        if (j == k) {
+          indexTest[ntest] = randperms[j];
+          k += cv_data->nfolds;
+          ntest++;
+        } else {
+          indexTrain[ntrain] = randperms[j];
+          ntrain++;
+        }
+      }
+
+      /*Perform CV for each subspace dimension p */
+      cv_enkf_get_cv_error_prin_comp( cv_data , cvError , G , indexTest , indexTrain, ntest, ntrain , i , maxP);
+    }
+    free( indexTest );
+    free( indexTrain );
+  }
+
+  matrix_free( G );
+  return cvError;
+}
+
+
+/* We only want to search the non-zero eigenvalues */
+
+int cv_enkf_get_max_subspace_dimension( const cv_enkf_data_type * cv_data ) {
+  const int nrmin = matrix_get_rows( cv_data->Z );
+  int maxP  = nrmin;
+
+  for (int i = 0; i < nrmin; i++) {
+    if (matrix_iget(cv_data->Z,i,1) == 0.0) {
+      maxP = i;
+      break;
+    }
+  }
+
+  if (maxP > nrmin)
+    maxP = nrmin - 1;      // <- Change by Joakim; using nrmin here will load to out
+                           // bounds access oc cv_data->Z at line 460.
+
+  return maxP;
+}
+
+
+const matrix_type * cv_enkf_get_Z( const cv_enkf_data_type * cv_data ) {
+  return cv_data->Z;
+}
+
+
+const matrix_type * cv_enkf_get_Rp( const cv_enkf_data_type * cv_data ) {
+  return cv_data->Rp;
 }
 
 
+int cv_enkf_get_nfolds( const cv_enkf_data_type * cv_data ) {
+  return cv_data->nfolds;
+}
 
 
 
@@ -394,32 +479,13 @@ static int get_optimal_principal_components( cv_enkf_data_type * cv_data ,
 
 
   const int nrens = matrix_get_columns( cv_data->Z );
-  const int nrmin = matrix_get_rows( cv_data->Z );
-
-
-
   matrix_type * cvError;
   int * randperms     = util_calloc( nrens , sizeof * randperms);
 
-  int maxP  = nrmin;
+  int maxP  = cv_enkf_get_max_subspace_dimension( cv_data );
   int optP;
 
 
-  /* We only want to search the non-zero eigenvalues */
-  for (int i = 0; i < nrmin; i++) {
-    if (matrix_iget(cv_data->Z,i,1) == 0.0) {
-      maxP = i;
-      break;
-    }
-  }
-
-  if (maxP > nrmin)
-    maxP = nrmin - 1;      // <- Change by Joakim; using nrmin here will load to out
-                           // bounds access oc cv_data->Z at line 460.
-
-
-
-
   if ( nrens < cv_data->nfolds )
     util_abort("%s: number of ensemble members %d need to be larger than the number of cv-folds - aborting \n",
                __func__,
@@ -431,34 +497,7 @@ static int get_optimal_principal_components( cv_enkf_data_type * cv_data ,
 
   rng_shuffle_int( rng , randperms , nrens );
 
-  cvError = matrix_alloc( maxP , cv_data->nfolds );
-  {
-    int ntest, ntrain, k,j,i;
-    int * indexTest  = util_calloc( nrens , sizeof * indexTest  );
-    int * indexTrain = util_calloc( nrens , sizeof * indexTrain );
-    for (i = 0; i < cv_data->nfolds; i++) {
-      ntest = 0;
-      ntrain = 0;
-      k = i;
-      /*extract members for the training and test ensembles */
-      for (j = 0; j < nrens; j++) {
-        if (j == k) {
-          indexTest[ntest] = randperms[j];
-          k += cv_data->nfolds;
-          ntest++;
-        } else {
-          indexTrain[ntrain] = randperms[j];
-          ntrain++;
-        }
-      }
-
-      /*Perform CV for each subspace dimension p */
-      cv_enkf_get_cv_error_prin_comp( cv_data , cvError , A , indexTest , indexTrain, ntest, ntrain , i , maxP);
-    }
-    free( indexTest );
-    free( indexTrain );
-  }
-
+  cvError = cv_enkf_alloc_cv_error( cv_data , A , randperms , maxP );
 
   /* find optimal truncation value for the cv-scheme */
   optP = cv_enkf_get_optimal_numb_comp( cv_data , cvError , maxP);
@@ -527,7 +566,7 @@ void cv_enkf_initX(void * module_data ,
                    matrix_type * X ,
                    matrix_type * A ,
                    matrix_type * S ,
-                   matrix_type * R ,
+                   const obs_covar_type * R ,
                    matrix_type * dObs ,
                    matrix_type * E ,
                    matrix_type * D,
@@ -710,9 +749,9 @@ analysis_table_type LINK_NAME = {
   .set_bool        = cv_enkf_set_bool ,
   .set_string      = NULL ,
   .get_options     = cv_enkf_get_options ,
-  .initX           = cv_enkf_initX ,
+  .initX           = NULL,
   .updateA         = NULL,
-  .init_update     = cv_enkf_init_update ,
+  .init_update     = NULL,
   .complete_update = cv_enkf_complete_update ,
   .has_var         = cv_enkf_has_var,
   .get_int         = cv_enkf_get_int,
@@ -720,3 +759,10 @@ analysis_table_type LINK_NAME = {
   .get_bool        = cv_enkf_get_bool,
   .get_ptr         = NULL,
 };
+
+
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+  .initX       = cv_enkf_initX,
+  .updateA     = NULL,
+  .init_update = cv_enkf_init_update,
+};
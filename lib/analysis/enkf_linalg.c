@@ -293,14 +293,8 @@ void enkf_linalg_lowrankE(const matrix_type * S , /* (nrobs x nrens) */
 
 
 
-void enkf_linalg_Cee(matrix_type * B, int nrens , const matrix_type * R , const matrix_type * U0 , const double * inv_sig0) {
-  const int nrmin = matrix_get_rows( B );
-  {
-    matrix_type * X0 = matrix_alloc( nrmin , matrix_get_rows( R ));
-    matrix_dgemm(X0 , U0 , R  , true  , false , 1.0 , 0.0);  /* X0 = U0^T * R */
-    matrix_dgemm(B  , X0 , U0 , false , false , 1.0 , 0.0);  /* B = X0 * U0 */
-    matrix_free( X0 );
-  }
+void enkf_linalg_Cee(matrix_type * B, int nrens , const obs_covar_type * R , const matrix_type * U0 , const double * inv_sig0) {
+  obs_covar_quadratic_form( R , U0 , B );   /* B = U0^T * R * U0 */
 
   {
     int i ,j;
@@ -325,7 +319,7 @@ void enkf_linalg_Cee(matrix_type * B, int nrens , const matrix_type * R , const
 
 
 void enkf_linalg_lowrankCinv__(const matrix_type * S ,
-                               const matrix_type * R ,
+                               const obs_covar_type * R ,
                                matrix_type * V0T ,
                                matrix_type * Z,
                                double * eig ,
@@ -367,7 +361,7 @@ void enkf_linalg_lowrankCinv__(const matrix_type * S ,
 
 
 void enkf_linalg_lowrankCinv(const matrix_type * S ,
-                             const matrix_type * R ,
+                             const obs_covar_type * R ,
                              matrix_type * W       , /* Corresponding to X1 from Eq. 14.29 */
                              double * eig          , /* Corresponding to 1 / (1 + Lambda_1) (14.29) */
                              double truncation     ,
@@ -242,7 +242,7 @@ static void fwd_step_enkf_write_iter_info( fwd_step_enkf_data_type * data , step
 void fwd_step_enkf_updateA(void * module_data ,
                            matrix_type * A ,
                            matrix_type * S ,
-                           matrix_type * R ,
+                           const obs_covar_type * R ,
                            matrix_type * dObs ,
                            matrix_type * E ,
                            matrix_type * D ,
@@ -535,7 +535,7 @@ analysis_table_type LINK_NAME = {
   .set_string      = fwd_step_enkf_set_string ,
   .get_options     = fwd_step_enkf_get_options ,
   .initX           = NULL ,
-  .updateA         = fwd_step_enkf_updateA,
+  .updateA         = NULL,
   .init_update     = NULL ,
   .complete_update = NULL ,
   .has_var         = fwd_step_enkf_has_var,
@@ -546,3 +546,10 @@ analysis_table_type LINK_NAME = {
 };
 
 
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+  .initX       = NULL,
+  .updateA     = fwd_step_enkf_updateA,
+  .init_update = NULL,
+};
+
+
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include <ert/util/util.h>
 #include <ert/util/type_macros.h>
@@ -39,6 +40,7 @@
 #include <rml_enkf_common.h>
 #include <rml_enkf_config.h>
 #include <rml_enkf_log.h>
+#include <rml_enkf_state.h>
 
 typedef struct rml_enkf_data_struct rml_enkf_data_type;
 
@@ -68,6 +70,7 @@ typedef struct rml_enkf_data_struct rml_enkf_data_type;
 #define  ITER_KEY                    "ITER"
 #define  LOG_FILE_KEY                "LOG_FILE"
 #define  CLEAR_LOG_KEY               "CLEAR_LOG"
+#define  STATE_PATH_KEY              "STATE_PATH"
 
 
 
@@ -112,8 +115,9 @@ struct rml_enkf_data_struct {
 
   matrix_type *Am;                 // Scaled right singular vectors of ensemble anomalies.
 
-  matrix_type *global_prior;       // m_pr
-  matrix_type *previous_state;     // m_l
+  rml_enkf_state_type *global_prior;       // m_pr
+  rml_enkf_state_type *previous_state;     // m_l
+  char                *state_path;         // If set the states above are stored in files in this directory.
 
 
   double    lambda;               // parameter to control the setp length in Marquardt levenberg optimization
@@ -200,8 +204,9 @@ void * rml_enkf_data_alloc( rng_type * rng) {
   data->Csc          = NULL;
   data->iteration_nr = 0;
   data->Std          = 0;
-  data->previous_state = matrix_alloc(1,1);
+  data->previous_state = rml_enkf_state_alloc( NULL );
   data->global_prior = NULL;
+  data->state_path   = NULL;
   data->ens_mask     = NULL;
   return data;
 }
@@ -209,9 +214,11 @@ void * rml_enkf_data_alloc( rng_type * rng) {
 void rml_enkf_data_free( void * arg ) {
   rml_enkf_data_type * data = rml_enkf_data_safe_cast( arg );
 
-  matrix_free( data->previous_state );
+  rml_enkf_state_free( data->previous_state );
   if (data->global_prior)
-    matrix_free( data->global_prior );
+    rml_enkf_state_free( data->global_prior );
+
+  free( data->state_path );
 
   rml_enkf_log_free( data->rml_log );
   rml_enkf_config_free( data->config );
@@ -259,7 +266,7 @@ static void rml_enkf_init1__( rml_enkf_data_type * data) {
   // This routine does not change any ensemble matrix.
   // Um*Wm^(-1) are the scaled, truncated, right singular vectors of data->global_prior
 
-  matrix_type * prior = matrix_alloc_column_compressed_copy( data->global_prior , data->ens_mask);
+  matrix_type * prior = rml_enkf_state_alloc_compressed( data->global_prior , data->ens_mask);
   int state_size      = matrix_get_rows( prior );
   int ens_size        = matrix_get_columns( prior );
   int nrmin           = util_int_min( ens_size , state_size);
@@ -297,23 +304,22 @@ static void rml_enkf_init1__( rml_enkf_data_type * data) {
 // Creates state scaling matrix
 void rml_enkf_init_Csc(const rml_enkf_data_type * data ){
   // This seems a strange choice of scaling matrix. Review?
-  matrix_type * prior = matrix_alloc_column_compressed_copy( data->global_prior , data->ens_mask );
-  {
-    int state_size = matrix_get_rows( prior );
-    int ens_size   = matrix_get_columns( prior );
+  int state_size = rml_enkf_state_get_rows( data->global_prior );
+  int ens_size   = bool_vector_count_equal( data->ens_mask , true );
+  double * row_sum = util_calloc( state_size , sizeof * row_sum );
 
-    for (int row=0; row < state_size; row++) {
-      double sumrow = matrix_get_row_sum(prior , row);
-      double tmp    = sumrow / ens_size;
+  rml_enkf_state_row_sum( data->global_prior , data->ens_mask , row_sum );
+  for (int row=0; row < state_size; row++) {
+    double sumrow = row_sum[row];
+    double tmp    = sumrow / ens_size;
 
-      if (abs(tmp)< 1)
-        data->Csc[row] = 0.05;
-      else
-        data->Csc[row] = 1.00;
+    if (abs(tmp)< 1)
+      data->Csc[row] = 0.05;
+    else
+      data->Csc[row] = 1.00;
 
-    }
-    matrix_free( prior );
   }
+  free( row_sum );
 }
 
 // Calculates update from data mismatch (delta m_1). Also provides SVD for later use.
@@ -383,20 +389,17 @@ void rml_enkf_init2__( rml_enkf_data_type * data, matrix_type *A, double * Wdr,
   double nsc       = 1/sqrt(ens_size-1);
 
   matrix_type *Am  = matrix_alloc_copy(data->Am);
-  matrix_type *Apr = matrix_alloc_column_compressed_copy(data->global_prior , data->ens_mask );
 
  // fprintf(stdout,"\n");
  // fprintf(stdout,"A: %d x %d\n", matrix_get_rows(A), matrix_get_columns(A));
  // fprintf(stdout,"prior : %d x %d\n", matrix_get_rows(data->global_prior), matrix_get_columns(data->global_prior));
  // fprintf(stdout,"state : %d x %d\n", matrix_get_rows(data->previous_state), matrix_get_columns(data->previous_state));
- // fprintf(stdout,"Apr : %d x %d\n", matrix_get_rows(Apr), matrix_get_columns(Apr));
  // fprintf(stdout,"Am : %d x %d\n", matrix_get_rows(Am), matrix_get_columns(Am));
  // Example:
  // A            : 27760 x 10
  // prior        : 27760 x 10
  // state        : 27760 x 50
  // prior0       : 27760 x 50
- // Apr          : 27760 x 10
  // Am           : 27760 x 1
 
 
@@ -415,7 +418,7 @@ void rml_enkf_init2__( rml_enkf_data_type * data, matrix_type *A, double * Wdr,
   {
     matrix_type * Dk = matrix_alloc_copy( A );
 
-    matrix_inplace_sub( Dk , Apr );
+    rml_enkf_state_subtract( data->global_prior , Dk , data->ens_mask );
     rml_enkf_common_scaleA(Dk , data->Csc , true);
 
     matrix_dgemm(X4 , Am , Dk , true, false, 1.0, 0.0);
@@ -441,7 +444,6 @@ void rml_enkf_init2__( rml_enkf_data_type * data, matrix_type *A, double * Wdr,
   matrix_inplace_sub(A, dA2);
 
   matrix_free(Am);
-  matrix_free(Apr);
   matrix_free(X4);
   matrix_free(X5);
   matrix_free(X6);
@@ -450,8 +452,30 @@ void rml_enkf_init2__( rml_enkf_data_type * data, matrix_type *A, double * Wdr,
   matrix_free(Dk1);
 }
 
+// (Re)create the prior and previous state storage; in files below state_path if that has been set.
+static void rml_enkf_init_states( rml_enkf_data_type * data ) {
+  char * prior_file = NULL;
+  char * state_file = NULL;
+
+  if (data->state_path) {
+    util_make_path( data->state_path );
+    prior_file = util_alloc_sprintf( "%s/rml_prior.%d.%p" , data->state_path , getpid() , (void *) data );
+    state_file = util_alloc_sprintf( "%s/rml_state.%d.%p" , data->state_path , getpid() , (void *) data );
+  }
+
+  rml_enkf_state_free( data->previous_state );
+  if (data->global_prior)
+    rml_enkf_state_free( data->global_prior );
+
+  data->previous_state = rml_enkf_state_alloc( state_file );
+  data->global_prior   = rml_enkf_state_alloc( prior_file );
+
+  free( prior_file );
+  free( state_file );
+}
+
 // Initialize state and prior from A. Initialize lambda0, lambda. Call initA__, init1__
-static void rml_enkf_updateA_iter0(rml_enkf_data_type * data, matrix_type * A, matrix_type * S, matrix_type * R, matrix_type * dObs, matrix_type * E, matrix_type * D, matrix_type * Cd) {
+static void rml_enkf_updateA_iter0(rml_enkf_data_type * data, matrix_type * A, matrix_type * S, const obs_covar_type * R, matrix_type * dObs, matrix_type * E, matrix_type * D, matrix_type * Cd) {
 
   int ens_size      = matrix_get_columns( S );
   int nrobs         = matrix_get_rows( S );
@@ -475,11 +499,13 @@ static void rml_enkf_updateA_iter0(rml_enkf_data_type * data, matrix_type * A, m
   }
 
 
+  rml_enkf_init_states( data );
+
   // state = A
-  rml_enkf_common_store_state( data->previous_state  , A , data->ens_mask );
+  rml_enkf_state_store( data->previous_state  , A , data->ens_mask );
 
   // prior = A
-  data->global_prior = matrix_alloc_copy( data->previous_state );
+  rml_enkf_state_store( data->global_prior , A , data->ens_mask );
 
   // Update dependant on data mismatch
   rml_enkf_initA__(data , A, S , Cd , E , D , Ud , Wd , VdT);
@@ -502,7 +528,7 @@ static void rml_enkf_updateA_iter0(rml_enkf_data_type * data, matrix_type * A, m
 void rml_enkf_updateA(void * module_data,
                       matrix_type * A,
                       matrix_type * S,
-                      matrix_type * R,
+                      const obs_covar_type * R,
                       matrix_type * dObs,
                       matrix_type * E,
                       matrix_type * D,
@@ -576,7 +602,7 @@ void rml_enkf_updateA(void * module_data,
         if (std_reduced)
           data->lambda = data->lambda * rml_enkf_config_get_lambda_decrease_factor( data->config );
 
-        rml_enkf_common_store_state(data->previous_state , A , data->ens_mask );
+        rml_enkf_state_store(data->previous_state , A , data->ens_mask );
 
         data->Sk = Sk_new;
         data->Std=Std_new;
@@ -585,7 +611,7 @@ void rml_enkf_updateA(void * module_data,
         // Increase lambda
         data->lambda = data->lambda * rml_enkf_config_get_lambda_increase_factor( data->config );
         // A = data->previous_state
-        rml_enkf_common_recover_state( data->previous_state , A , data->ens_mask  );
+        rml_enkf_state_recover( data->previous_state , A , data->ens_mask  );
       }
     }
 
@@ -621,7 +647,7 @@ void rml_enkf_updateA(void * module_data,
 void rml_enkf_init_update(void * arg,
                           const bool_vector_type * ens_mask,
                           const matrix_type * S,
-                          const matrix_type * R,
+                          const obs_covar_type * R,
                           const matrix_type * dObs,
                           const matrix_type * E,
                           const matrix_type * D,
@@ -753,6 +779,8 @@ bool rml_enkf_set_string( void * arg , const char * var_name , const char * valu
 
     if (strcmp( var_name , LOG_FILE_KEY) == 0)
       rml_enkf_log_set_log_file( module_data->rml_log , value );
+    else if (strcmp( var_name , STATE_PATH_KEY) == 0)
+      module_data->state_path = util_realloc_string_copy( module_data->state_path , value );
     else
       name_recognized = false;
 
@@ -789,6 +817,8 @@ bool rml_enkf_has_var( const void * arg, const char * var_name) {
       return true;
     else if (strcmp(var_name , CLEAR_LOG_KEY) == 0)
       return true;
+    else if (strcmp(var_name , STATE_PATH_KEY) == 0)
+      return true;
     else
       return false;
   }
@@ -799,6 +829,8 @@ void * rml_enkf_get_ptr( const void * arg , const char * var_name ) {
   {
     if (strcmp(var_name , LOG_FILE_KEY) == 0)
       return (void *) rml_enkf_log_get_log_file( module_data->rml_log );
+    else if (strcmp(var_name , STATE_PATH_KEY) == 0)
+      return module_data->state_path;
     else
       return NULL;
   }
@@ -829,8 +861,8 @@ analysis_table_type LINK_NAME = {
   .set_string      = rml_enkf_set_string,
   .get_options     = rml_enkf_get_options ,
   .initX           = NULL,
-  .updateA         = rml_enkf_updateA ,
-  .init_update     = rml_enkf_init_update ,
+  .updateA         = NULL,
+  .init_update     = NULL,
   .complete_update = NULL,
   .has_var         = rml_enkf_has_var,
   .get_int         = rml_enkf_get_int,
@@ -839,3 +871,10 @@ analysis_table_type LINK_NAME = {
   .get_ptr         = rml_enkf_get_ptr,
 };
 
+
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+  .initX       = NULL,
+  .updateA     = rml_enkf_updateA,
+  .init_update = rml_enkf_init_update,
+};
+
@@ -0,0 +1,299 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'rml_enkf_state.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/bool_vector.h>
+
+#include <ert/res_util/matrix.h>
+
+#include <rml_enkf_common.h>
+#include <rml_enkf_state.h>
+
+/*
+  Storage for the ensemble states the RML module must keep between
+  iterations, i.e. the prior and the state from the previous
+  iteration. The state is stored with one column for every member in
+  the ens_mask, the columns of inactive members are zero - exactly
+  like rml_enkf_common_store_state().
+
+  If the state is created with a filename the data is kept in that
+  file, and is only read back in blocks of rows when it is needed;
+  otherwise it is kept in an ordinary matrix. The file consists of
+  consecutive row blocks of block_rows x columns doubles, each block
+  stored in column major order. All the operations are elementwise, so
+  the file backed and the in-memory state give identical results.
+*/
+
+#define RML_ENKF_STATE_TYPE_ID   71524377
+#define RML_ENKF_STATE_BLOCK_SIZE (1 << 20)      /* Number of doubles in one row block. */
+
+struct rml_enkf_state_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char        * filename;
+  FILE        * stream;
+  matrix_type * data;          /* Only used when the state is kept in memory. */
+  int           rows;
+  int           columns;
+  int           block_rows;
+};
+
+
+rml_enkf_state_type * rml_enkf_state_alloc( const char * filename ) {
+  rml_enkf_state_type * state = util_malloc( sizeof * state );
+  UTIL_TYPE_ID_INIT( state , RML_ENKF_STATE_TYPE_ID );
+  state->filename   = util_alloc_string_copy( filename );
+  state->stream     = NULL;
+  state->data       = NULL;
+  state->rows       = 0;
+  state->columns    = 0;
+  state->block_rows = 0;
+
+  if (filename == NULL)
+    state->data = matrix_alloc( 1 , 1 );
+
+  return state;
+}
+
+
+void rml_enkf_state_free( rml_enkf_state_type * state ) {
+  if (state->stream) {
+    fclose( state->stream );
+    unlink( state->filename );
+  }
+
+  if (state->data)
+    matrix_free( state->data );
+
+  free( state->filename );
+  free( state );
+}
+
+
+bool rml_enkf_state_is_file( const rml_enkf_state_type * state ) {
+  return (state->filename != NULL);
+}
+
+
+int rml_enkf_state_get_rows( const rml_enkf_state_type * state ) {
+  return state->rows;
+}
+
+
+/*
+  Mainly for testing; by default the number of rows in a block is
+  chosen to give blocks of approximately RML_ENKF_STATE_BLOCK_SIZE
+  elements.
+*/
+
+void rml_enkf_state_set_block_rows( rml_enkf_state_type * state , int block_rows ) {
+  state->block_rows = block_rows;
+}
+
+
+static int rml_enkf_state_get_block_rows( const rml_enkf_state_type * state ) {
+  if (state->block_rows > 0)
+    return state->block_rows;
+  else
+    return util_int_max( 1 , RML_ENKF_STATE_BLOCK_SIZE / util_int_max( 1 , state->columns ));
+}
+
+
+/*
+  Loads rows [row0, row0 + nrows) of the state into @block, in column
+  major order.
+*/
+
+static void rml_enkf_state_get_block( const rml_enkf_state_type * state , int row0 , int nrows , double * block ) {
+  if (state->data) {
+    for (int j = 0; j < state->columns; j++)
+      for (int i = 0; i < nrows; i++)
+        block[ j * nrows + i ] = matrix_iget( state->data , row0 + i , j );
+  } else {
+    util_fseek( state->stream , (long) row0 * state->columns * sizeof * block , SEEK_SET );
+    util_fread( block , sizeof * block , nrows * state->columns , state->stream , __func__ );
+  }
+}
+
+
+static void rml_enkf_state_assert_size( const rml_enkf_state_type * state , const bool_vector_type * ens_mask ) {
+  if (state->columns != bool_vector_size( ens_mask ))
+    util_abort("%s: size mismatch - state has %d columns, ens_mask has %d elements \n",__func__ , state->columns , bool_vector_size( ens_mask ));
+}
+
+
+/*
+  Equivalent to rml_enkf_common_store_state( state , A , ens_mask ).
+*/
+
+void rml_enkf_state_store( rml_enkf_state_type * state , const matrix_type * A , const bool_vector_type * ens_mask ) {
+  state->rows    = matrix_get_rows( A );
+  state->columns = bool_vector_size( ens_mask );
+
+  if (state->data)
+    rml_enkf_common_store_state( state->data , A , ens_mask );
+  else {
+    const int block_rows = rml_enkf_state_get_block_rows( state );
+    double * block = util_calloc( block_rows * state->columns , sizeof * block );
+
+    if (state->stream)
+      fclose( state->stream );
+    state->stream = util_fopen( state->filename , "w+" );
+
+    for (int row0 = 0; row0 < state->rows; row0 += block_rows) {
+      int nrows = util_int_min( block_rows , state->rows - row0 );
+      int active_index = 0;
+
+      for (int iens = 0; iens < state->columns; iens++) {
+        double * column = &block[ iens * nrows ];
+        if (bool_vector_iget( ens_mask , iens )) {
+          for (int i = 0; i < nrows; i++)
+            column[i] = matrix_iget( A , row0 + i , active_index );
+          active_index++;
+        } else {
+          for (int i = 0; i < nrows; i++)
+            column[i] = 0;
+        }
+      }
+      util_fwrite( block , sizeof * block , nrows * state->columns , state->stream , __func__ );
+    }
+    fflush( state->stream );
+    free( block );
+  }
+}
+
+
+/*
+  Equivalent to rml_enkf_common_recover_state( state , A , ens_mask ).
+*/
+
+void rml_enkf_state_recover( const rml_enkf_state_type * state , matrix_type * A , const bool_vector_type * ens_mask ) {
+  if (state->data)
+    rml_enkf_common_recover_state( state->data , A , ens_mask );
+  else {
+    const int block_rows = rml_enkf_state_get_block_rows( state );
+    const int active_size = bool_vector_count_equal( ens_mask , true );
+    double * block = util_calloc( block_rows * state->columns , sizeof * block );
+
+    rml_enkf_state_assert_size( state , ens_mask );
+    matrix_resize( A , state->rows , active_size , false );
+    for (int row0 = 0; row0 < state->rows; row0 += block_rows) {
+      int nrows = util_int_min( block_rows , state->rows - row0 );
+      int active_index = 0;
+
+      rml_enkf_state_get_block( state , row0 , nrows , block );
+      for (int iens = 0; iens < state->columns; iens++) {
+        if (bool_vector_iget( ens_mask , iens )) {
+          const double * column = &block[ iens * nrows ];
+          for (int i = 0; i < nrows; i++)
+            matrix_iset( A , row0 + i , active_index , column[i] );
+          active_index++;
+        }
+      }
+    }
+    free( block );
+  }
+}
+
+
+/*
+  Will subtract the active columns of the state from A, i.e. the same
+  as:
+
+     matrix_type * tmp = matrix_alloc_column_compressed_copy( state , ens_mask );
+     matrix_inplace_sub( A , tmp );
+
+  but without creating the full size temporary.
+*/
+
+void rml_enkf_state_subtract( const rml_enkf_state_type * state , matrix_type * A , const bool_vector_type * ens_mask ) {
+  const int block_rows = rml_enkf_state_get_block_rows( state );
+  double * block = util_calloc( block_rows * state->columns , sizeof * block );
+
+  rml_enkf_state_assert_size( state , ens_mask );
+  if (matrix_get_rows( A ) != state->rows)
+    util_abort("%s: size mismatch - A has %d rows, state has %d rows \n",__func__ , matrix_get_rows( A ) , state->rows);
+
+  for (int row0 = 0; row0 < state->rows; row0 += block_rows) {
+    int nrows = util_int_min( block_rows , state->rows - row0 );
+    int active_index = 0;
+
+    rml_enkf_state_get_block( state , row0 , nrows , block );
+
+    for (int iens = 0; iens < state->columns; iens++) {
+      if (bool_vector_iget( ens_mask , iens )) {
+        const double * column = &block[ iens * nrows ];
+        for (int i = 0; i < nrows; i++)
+          matrix_isub( A , row0 + i , active_index , column[i] );
+        active_index++;
+      }
+    }
+  }
+  free( block );
+}
+
+
+/*
+  Sums the active columns of every row, in the same order as
+  matrix_get_row_sum() on the compressed state.
+*/
+
+void rml_enkf_state_row_sum( const rml_enkf_state_type * state , const bool_vector_type * ens_mask , double * row_sum ) {
+  const int block_rows = rml_enkf_state_get_block_rows( state );
+  double * block = util_calloc( block_rows * state->columns , sizeof * block );
+
+  rml_enkf_state_assert_size( state , ens_mask );
+  for (int row0 = 0; row0 < state->rows; row0 += block_rows) {
+    int nrows = util_int_min( block_rows , state->rows - row0 );
+
+    rml_enkf_state_get_block( state , row0 , nrows , block );
+
+    for (int i = 0; i < nrows; i++)
+      row_sum[row0 + i] = 0;
+
+    for (int iens = 0; iens < state->columns; iens++) {
+      if (bool_vector_iget( ens_mask , iens )) {
+        const double * column = &block[ iens * nrows ];
+        for (int i = 0; i < nrows; i++)
+          row_sum[row0 + i] += column[i];
+      }
+    }
+  }
+  free( block );
+}
+
+
+/*
+  Creates a normal matrix with the active columns of the state; for
+  the file backed state this will of course bring the full state into
+  memory.
+*/
+
+matrix_type * rml_enkf_state_alloc_compressed( const rml_enkf_state_type * state , const bool_vector_type * ens_mask ) {
+  if (state->data)
+    return matrix_alloc_column_compressed_copy( state->data , ens_mask );
+  else {
+    matrix_type * A = matrix_alloc( 1 , 1 );
+    rml_enkf_state_recover( state , A , ens_mask );
+    return A;
+  }
+}
@@ -0,0 +1,23 @@
+#ifndef ERT_RML_ENKF_STATE_H
+#define ERT_RML_ENKF_STATE_H
+
+#include <stdbool.h>
+
+#include <ert/util/bool_vector.h>
+
+#include <ert/res_util/matrix.h>
+
+typedef struct rml_enkf_state_struct rml_enkf_state_type;
+
+rml_enkf_state_type * rml_enkf_state_alloc( const char * filename );
+void                  rml_enkf_state_free( rml_enkf_state_type * state );
+bool                  rml_enkf_state_is_file( const rml_enkf_state_type * state );
+int                   rml_enkf_state_get_rows( const rml_enkf_state_type * state );
+void                  rml_enkf_state_set_block_rows( rml_enkf_state_type * state , int block_rows );
+void                  rml_enkf_state_store( rml_enkf_state_type * state , const matrix_type * A , const bool_vector_type * ens_mask );
+void                  rml_enkf_state_recover( const rml_enkf_state_type * state , matrix_type * A , const bool_vector_type * ens_mask );
+void                  rml_enkf_state_subtract( const rml_enkf_state_type * state , matrix_type * A , const bool_vector_type * ens_mask );
+void                  rml_enkf_state_row_sum( const rml_enkf_state_type * state , const bool_vector_type * ens_mask , double * row_sum );
+matrix_type         * rml_enkf_state_alloc_compressed( const rml_enkf_state_type * state , const bool_vector_type * ens_mask );
+
+#endif
@@ -97,7 +97,7 @@ void std_enkf_debug_initX(void * module_data ,
                           matrix_type * X ,
                           matrix_type * A ,
                           matrix_type * S ,
-                          matrix_type * R ,
+                          const obs_covar_type * R ,
                           matrix_type * dObs ,
                           matrix_type * E ,
                           matrix_type * D,
@@ -115,7 +115,11 @@ void std_enkf_debug_initX(void * module_data ,
   std_enkf_debug_save_matrix( E , debug_path ,  "E.csv" , true);
   std_enkf_debug_save_matrix( E , debug_path ,  "measurementErrors.csv" , true);
 
-  std_enkf_debug_save_matrix( R , debug_path ,  "R.csv" , true);
+  {
+    matrix_type * dense_R = obs_covar_alloc_matrix( R );
+    std_enkf_debug_save_matrix( dense_R , debug_path ,  "R.csv" , true);
+    matrix_free( dense_R );
+  }
   std_enkf_debug_save_matrix( D , debug_path ,  "D.csv" , true);
   {
     matrix_type * value = matrix_alloc_sub_copy( dObs , 0 , 0 , matrix_get_rows( dObs ) , 1 );
@@ -176,6 +180,7 @@ long std_enkf_debug_get_options( void * arg , long flag ) {
   const std_enkf_debug_data_type * module_data = std_enkf_debug_data_safe_cast_const( arg );
   long options = std_enkf_get_options( module_data->std_data , flag );
   options |= ANALYSIS_USE_A;
+  options &= ~ANALYSIS_THREAD_SAFE;   /* The update counter and the debug files are per module. */
   return options;
 }
 
@@ -233,7 +238,7 @@ analysis_table_type LINK_NAME = {
     .set_bool        = std_enkf_debug_set_bool,
     .set_string      = std_enkf_debug_set_string,
     .get_options     = std_enkf_debug_get_options ,
-    .initX           = std_enkf_debug_initX ,
+    .initX           = NULL,
     .updateA         = NULL,
     .init_update     = NULL,
     .complete_update = NULL,
@@ -244,3 +249,10 @@ analysis_table_type LINK_NAME = {
     .get_ptr         = std_enkf_debug_get_ptr
 };
 
+
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+    .initX       = std_enkf_debug_initX,
+    .updateA     = NULL,
+    .init_update = NULL,
+};
+
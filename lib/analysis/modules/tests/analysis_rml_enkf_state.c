@@ -0,0 +1,198 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'analysis_rml_enkf_state.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/util/bool_vector.h>
+
+#include <ert/res_util/matrix.h>
+
+#include <ert/analysis/analysis_module.h>
+#include <ert/analysis/obs_covar.h>
+
+#include <rml_enkf_state.h>
+
+
+static bool_vector_type * alloc_mask( int ens_size , int inactive_stride ) {
+  bool_vector_type * ens_mask = bool_vector_alloc( ens_size , true );
+  for (int iens = 1; iens < ens_size; iens += inactive_stride)
+    bool_vector_iset( ens_mask , iens , false );
+  return ens_mask;
+}
+
+
+void test_state( rng_type * rng ) {
+  const int rows = 1003;
+  bool_vector_type * ens_mask = alloc_mask( 10 , 4 );
+  int active_size = bool_vector_count_equal( ens_mask , true );
+  matrix_type * A = matrix_alloc( rows , active_size );
+  rml_enkf_state_type * mem_state  = rml_enkf_state_alloc( NULL );
+  rml_enkf_state_type * file_state = rml_enkf_state_alloc( "state.bin" );
+
+  matrix_random_init( A , rng );
+  rml_enkf_state_set_block_rows( file_state , 64 );
+  rml_enkf_state_store( mem_state , A , ens_mask );
+  rml_enkf_state_store( file_state , A , ens_mask );
+  test_assert_true( rml_enkf_state_is_file( file_state ));
+  test_assert_false( rml_enkf_state_is_file( mem_state ));
+  test_assert_int_equal( rows , rml_enkf_state_get_rows( file_state ));
+  test_assert_true( util_file_exists( "state.bin" ));
+  test_assert_int_equal( rows * bool_vector_size( ens_mask ) * sizeof(double) , util_file_size( "state.bin" ));
+
+  {
+    matrix_type * A1 = matrix_alloc( 1 , 1 );
+    matrix_type * A2 = matrix_alloc( 1 , 1 );
+
+    rml_enkf_state_recover( mem_state , A1 , ens_mask );
+    rml_enkf_state_recover( file_state , A2 , ens_mask );
+    test_assert_true( matrix_equal( A , A1 ));
+    test_assert_true( matrix_equal( A , A2 ));
+
+    matrix_random_init( A1 , rng );
+    matrix_assign( A2 , A1 );
+    rml_enkf_state_subtract( mem_state , A1 , ens_mask );
+    rml_enkf_state_subtract( file_state , A2 , ens_mask );
+    test_assert_true( matrix_equal( A1 , A2 ));
+
+    matrix_free( A2 );
+    matrix_free( A1 );
+  }
+
+  {
+    matrix_type * C1 = rml_enkf_state_alloc_compressed( mem_state , ens_mask );
+    matrix_type * C2 = rml_enkf_state_alloc_compressed( file_state , ens_mask );
+    double * sum1 = util_calloc( rows , sizeof * sum1 );
+    double * sum2 = util_calloc( rows , sizeof * sum2 );
+
+    test_assert_true( matrix_equal( A , C1 ));
+    test_assert_true( matrix_equal( A , C2 ));
+
+    rml_enkf_state_row_sum( mem_state , ens_mask , sum1 );
+    rml_enkf_state_row_sum( file_state , ens_mask , sum2 );
+    for (int i = 0; i < rows; i++) {
+      test_assert_true( sum1[i] == matrix_get_row_sum( A , i ));
+      test_assert_true( sum2[i] == matrix_get_row_sum( A , i ));
+    }
+
+    free( sum2 );
+    free( sum1 );
+    matrix_free( C2 );
+    matrix_free( C1 );
+  }
+
+  rml_enkf_state_free( file_state );
+  rml_enkf_state_free( mem_state );
+  test_assert_false( util_file_exists( "state.bin" ));
+  matrix_free( A );
+  bool_vector_free( ens_mask );
+}
+
+
+static analysis_module_type * alloc_module( const char * lib_name , const char * state_path ) {
+  analysis_module_type * module = analysis_module_alloc_external( lib_name );
+  test_assert_true( analysis_module_set_var( module , "USE_PRIOR" , "True" ));
+  if (state_path)
+    test_assert_true( analysis_module_set_var( module , "STATE_PATH" , state_path ));
+  return module;
+}
+
+
+/*
+  Runs a few iterations of the RML module on a linear forward model,
+  with the states in memory and in files respectively. The two updated
+  ensembles should be bitwise identical.
+*/
+
+void test_update( const char * lib_name , rng_type * rng , int state_size ) {
+  const int nrobs = 10;
+  bool_vector_type * ens_mask = alloc_mask( 32 , 16 );
+  int ens_size = bool_vector_count_equal( ens_mask , true );
+  analysis_module_type * mem_module  = alloc_module( lib_name , NULL );
+  analysis_module_type * file_module = alloc_module( lib_name , "rml_state" );
+  analysis_module_type * modules[2] = { mem_module , file_module };
+  matrix_type * A[2];
+  matrix_type * G    = matrix_alloc( nrobs , state_size );
+  matrix_type * dObs = matrix_alloc( nrobs , 2 );
+  matrix_type * E    = matrix_alloc( nrobs , ens_size );
+  obs_covar_type * R = obs_covar_alloc( nrobs );
+
+  A[0] = matrix_alloc( state_size , ens_size );
+  matrix_random_init( A[0] , rng );
+  A[1] = matrix_alloc_copy( A[0] );
+  matrix_random_init( G , rng );
+  matrix_scale( G , 1.0 / state_size );
+  for (int i = 0; i < nrobs; i++) {
+    matrix_iset( dObs , i , 0 , rng_get_double( rng ));
+    matrix_iset( dObs , i , 1 , 0.1 );
+    obs_covar_iset_var( R , i , 0.01 );
+  }
+
+  for (int iter = 0; iter < 4; iter++) {
+    matrix_random_init( E , rng );
+    matrix_scale( E , 0.1 );
+
+    for (int m = 0; m < 2; m++) {
+      matrix_type * S  = matrix_alloc( nrobs , ens_size );
+      matrix_type * D  = matrix_alloc( nrobs , ens_size );
+      matrix_type * Ek = matrix_alloc_copy( E );
+
+      matrix_matmul( S , G , A[m] );
+      for (int i = 0; i < nrobs; i++)
+        for (int j = 0; j < ens_size; j++)
+          matrix_iset( D , i , j , matrix_iget( dObs , i , 0 ) + matrix_iget( E , i , j ) - matrix_iget( S , i , j ));
+
+      analysis_module_init_update_covar( modules[m] , ens_mask , S , R , dObs , Ek , D , rng );
+      analysis_module_updateA_covar( modules[m] , A[m] , S , R , dObs , Ek , D , NULL , rng );
+
+      matrix_free( Ek );
+      matrix_free( D );
+      matrix_free( S );
+    }
+    test_assert_true( matrix_equal( A[0] , A[1] ));
+  }
+  test_assert_true( util_is_directory( "rml_state" ));
+
+  obs_covar_free( R );
+  matrix_free( E );
+  matrix_free( dObs );
+  matrix_free( G );
+  matrix_free( A[1] );
+  matrix_free( A[0] );
+  analysis_module_free( file_module );
+  analysis_module_free( mem_module );
+  bool_vector_free( ens_mask );
+}
+
+
+int main(int argc , char ** argv) {
+  const char * lib_name = argv[1];
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  test_work_area_type * work_area = test_work_area_alloc( "rml_enkf_state" );
+
+  test_state( rng );
+  test_update( lib_name , rng , 2000 );
+  test_update( lib_name , rng , 20000 );
+
+  test_work_area_free( work_area );
+  rng_free( rng );
+  exit(0);
+}
@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'analysis_rml_enkf_state_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Time used by the RML module with the prior and previous states kept
+  in memory and in files under STATE_PATH respectively. The benchmark
+  is not part of the test suite, run it manually as:
+
+     analysis_rml_enkf_state_benchmark <rml_enkf.so> [state_size] [ens_size]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/util/bool_vector.h>
+
+#include <ert/res_util/matrix.h>
+
+#include <ert/analysis/analysis_module.h>
+#include <ert/analysis/obs_covar.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static analysis_module_type * alloc_module( const char * lib_name , const char * state_path ) {
+  analysis_module_type * module = analysis_module_alloc_external( lib_name );
+  test_assert_true( analysis_module_set_var( module , "USE_PRIOR" , "True" ));
+  if (state_path)
+    test_assert_true( analysis_module_set_var( module , "STATE_PATH" , state_path ));
+  return module;
+}
+
+
+static double run_update( analysis_module_type * module , matrix_type * A , const matrix_type * G ,
+                          matrix_type * dObs , obs_covar_type * R , const bool_vector_type * ens_mask , rng_type * rng) {
+  const int nrobs = matrix_get_rows( G );
+  const int ens_size = matrix_get_columns( A );
+  double elapsed = 0;
+
+  for (int iter = 0; iter < 4; iter++) {
+    matrix_type * S = matrix_alloc( nrobs , ens_size );
+    matrix_type * D = matrix_alloc( nrobs , ens_size );
+    matrix_type * E = matrix_alloc( nrobs , ens_size );
+    double start;
+
+    matrix_random_init( E , rng );
+    matrix_scale( E , 0.1 );
+    matrix_matmul( S , G , A );
+    for (int i = 0; i < nrobs; i++)
+      for (int j = 0; j < ens_size; j++)
+        matrix_iset( D , i , j , matrix_iget( dObs , i , 0 ) + matrix_iget( E , i , j ) - matrix_iget( S , i , j ));
+
+    start = wall_clock( );
+    analysis_module_init_update_covar( module , ens_mask , S , R , dObs , E , D , rng );
+    analysis_module_updateA_covar( module , A , S , R , dObs , E , D , NULL , rng );
+    elapsed += wall_clock( ) - start;
+
+    matrix_free( E );
+    matrix_free( D );
+    matrix_free( S );
+  }
+  return elapsed;
+}
+
+
+int main(int argc , char ** argv) {
+  const char * lib_name = argv[1];
+  const int state_size = int_arg( argc , argv , 2 , 200000 );
+  const int ens_size   = int_arg( argc , argv , 3 , 100 );
+  const int nrobs = 10;
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  test_work_area_type * work_area = test_work_area_alloc( "rml_enkf_state_benchmark" );
+  bool_vector_type * ens_mask = bool_vector_alloc( ens_size , true );
+  analysis_module_type * mem_module  = alloc_module( lib_name , NULL );
+  analysis_module_type * file_module = alloc_module( lib_name , "rml_state" );
+  matrix_type * A0   = matrix_alloc( state_size , ens_size );
+  matrix_type * G    = matrix_alloc( nrobs , state_size );
+  matrix_type * dObs = matrix_alloc( nrobs , 2 );
+  obs_covar_type * R = obs_covar_alloc( nrobs );
+
+  matrix_random_init( A0 , rng );
+  matrix_random_init( G , rng );
+  matrix_scale( G , 1.0 / state_size );
+  for (int i = 0; i < nrobs; i++) {
+    matrix_iset( dObs , i , 0 , rng_get_double( rng ));
+    matrix_iset( dObs , i , 1 , 0.1 );
+    obs_covar_iset_var( R , i , 0.01 );
+  }
+
+  {
+    matrix_type * A = matrix_alloc_copy( A0 );
+    double mem_time = run_update( mem_module , A , G , dObs , R , ens_mask , rng );
+    double file_time;
+
+    matrix_assign( A , A0 );
+    file_time = run_update( file_module , A , G , dObs , R , ens_mask , rng );
+    printf("state_size: %8d   ens_size: %4d   memory: %8.4f s   file: %8.4f s\n", state_size , ens_size , mem_time , file_time);
+    matrix_free( A );
+  }
+
+  obs_covar_free( R );
+  matrix_free( dObs );
+  matrix_free( G );
+  matrix_free( A0 );
+  analysis_module_free( file_module );
+  analysis_module_free( mem_module );
+  bool_vector_free( ens_mask );
+  test_work_area_free( work_area );
+  rng_free( rng );
+  exit(0);
+}
@@ -35,7 +35,7 @@ void null_enkf_initX(void * module_data ,
                     matrix_type * X ,
                     matrix_type * A ,
                     matrix_type * S ,
-                    matrix_type * R ,
+                    const obs_covar_type * R ,
                     matrix_type * dObs ,
                     matrix_type * E ,
                     matrix_type * D,
@@ -47,7 +47,7 @@ void null_enkf_initX(void * module_data ,
 
 
 long null_enkf_get_options( void * arg , long flag ) {
-  return 0L;
+  return ANALYSIS_THREAD_SAFE;
 }
 
 
@@ -74,7 +74,7 @@ analysis_table_type LINK_NAME = {
     .set_bool        = NULL ,
     .set_string      = NULL ,
     .get_options     = null_enkf_get_options,
-    .initX           = null_enkf_initX ,
+    .initX           = NULL,
     .updateA         = NULL,
     .init_update     = NULL,
     .complete_update = NULL,
@@ -83,3 +83,10 @@ analysis_table_type LINK_NAME = {
     .get_double      = NULL,
     .get_ptr         = NULL,
 };
+
+
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+    .initX       = null_enkf_initX,
+    .updateA     = NULL,
+    .init_update = NULL,
+};
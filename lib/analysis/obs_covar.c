@@ -0,0 +1,362 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'obs_covar.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/vector.h>
+#include <ert/util/int_vector.h>
+#include <ert/res_util/matrix.h>
+#include <ert/res_util/matrix_blas.h>
+
+#include <ert/analysis/obs_covar.h>
+
+/**
+   The obs_covar structure is a representation of the observation
+   error covariance matrix R which exploits that R is block
+   diagonal: most observations are uncorrelated, and only a few
+   observation groups have a full error covariance matrix. The
+   diagonal is stored for all the observations, and in addition there
+   is a list of dense symmetric blocks along the diagonal. For a
+   purely diagonal R the storage is O(n) instead of O(n^2).
+
+   The analysis modules use R through obs_covar_quadratic_form() and
+   obs_covar_matmul(); modules which really need the dense matrix can
+   get it with obs_covar_alloc_matrix().
+*/
+
+#define OBS_COVAR_TYPE_ID 661342
+
+struct obs_covar_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int               size;
+  double          * diag;           /* The diagonal of R - also for the elements covered by a block. */
+  int_vector_type * block_offset;
+  vector_type     * blocks;         /* Dense blocks: R[offset:offset + n, offset:offset + n]. */
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( obs_covar , OBS_COVAR_TYPE_ID )
+
+
+static void obs_covar_free_block__( void * arg ) {
+  matrix_free( (matrix_type *) arg );
+}
+
+
+obs_covar_type * obs_covar_alloc( int size ) {
+  obs_covar_type * covar = util_malloc( sizeof * covar );
+  UTIL_TYPE_ID_INIT( covar , OBS_COVAR_TYPE_ID );
+  covar->size         = size;
+  covar->diag         = util_calloc( util_int_max( size , 1 ) , sizeof * covar->diag );
+  covar->block_offset = int_vector_alloc( 0 , 0 );
+  covar->blocks       = vector_alloc_new();
+  return covar;
+}
+
+
+/**
+   Will create a obs_covar instance from a dense matrix; the block
+   structure is detected from the non zero off diagonal elements.
+*/
+
+obs_covar_type * obs_covar_alloc_from_matrix( const matrix_type * R ) {
+  const int size = matrix_get_rows( R );
+  obs_covar_type * covar = obs_covar_alloc( size );
+  int row = 0;
+
+  if (matrix_get_columns( R ) != size)
+    util_abort("%s: R must be square - is %d x %d \n",__func__ , size , matrix_get_columns( R ));
+
+  while (row < size) {
+    int block_start = row;
+    int block_end   = row + 1;
+
+    while (row < block_end) {
+      for (int col = size - 1; col >= block_end; col--) {
+        if ((matrix_iget( R , row , col ) != 0) || (matrix_iget( R , col , row ) != 0)) {
+          block_end = col + 1;
+          break;
+        }
+      }
+      row++;
+    }
+
+    if (block_end - block_start > 1) {
+      matrix_type * block = matrix_alloc_sub_copy( R , block_start , block_start , block_end - block_start , block_end - block_start );
+      obs_covar_add_block( covar , block_start , block );
+      matrix_free( block );
+    } else
+      covar->diag[ block_start ] = matrix_iget( R , block_start , block_start );
+  }
+
+  return covar;
+}
+
+
+/**
+   Will create a new obs_covar instance with the rows and columns
+   @index of @covar; the elements of @index must be strictly
+   increasing.
+*/
+
+obs_covar_type * obs_covar_alloc_subset( const obs_covar_type * covar , const int_vector_type * index ) {
+  const int size = int_vector_size( index );
+  obs_covar_type * subset = obs_covar_alloc( size );
+
+  for (int i = 0; i < size; i++)
+    subset->diag[i] = covar->diag[ int_vector_iget( index , i ) ];
+
+  for (int iblock = 0; iblock < vector_get_size( covar->blocks ); iblock++) {
+    const matrix_type * block = vector_iget_const( covar->blocks , iblock );
+    const int offset = int_vector_iget( covar->block_offset , iblock );
+    int first = -1;
+    int last  = -1;
+
+    for (int i = 0; i < size; i++) {
+      int elm = int_vector_iget( index , i );
+      if ((elm >= offset) && (elm < offset + matrix_get_rows( block ))) {
+        if (first < 0)
+          first = i;
+        last = i;
+      }
+    }
+
+    if (last > first) {
+      const int block_size = last - first + 1;
+      matrix_type * sub_block = matrix_alloc( block_size , block_size );
+
+      for (int col = 0; col < block_size; col++)
+        for (int row = 0; row < block_size; row++)
+          matrix_iset( sub_block , row , col , matrix_iget( block ,
+                                                            int_vector_iget( index , first + row ) - offset ,
+                                                            int_vector_iget( index , first + col ) - offset ));
+
+      obs_covar_add_block( subset , first , sub_block );
+      matrix_free( sub_block );
+    }
+  }
+
+  return subset;
+}
+
+
+void obs_covar_free( obs_covar_type * covar ) {
+  free( covar->diag );
+  int_vector_free( covar->block_offset );
+  vector_free( covar->blocks );
+  free( covar );
+}
+
+
+int obs_covar_get_size( const obs_covar_type * covar ) {
+  return covar->size;
+}
+
+
+int obs_covar_get_num_blocks( const obs_covar_type * covar ) {
+  return vector_get_size( covar->blocks );
+}
+
+
+bool obs_covar_is_diagonal( const obs_covar_type * covar ) {
+  return (vector_get_size( covar->blocks ) == 0);
+}
+
+
+/**
+   The number of double values stored.
+*/
+
+size_t obs_covar_get_storage_size( const obs_covar_type * covar ) {
+  size_t storage_size = covar->size;
+  for (int iblock = 0; iblock < vector_get_size( covar->blocks ); iblock++) {
+    const matrix_type * block = vector_iget_const( covar->blocks , iblock );
+    storage_size += (size_t) matrix_get_rows( block ) * matrix_get_rows( block );
+  }
+  return storage_size;
+}
+
+
+/*
+  Returns the block covering @index, or NULL if @index is only
+  on the diagonal.
+*/
+
+static matrix_type * obs_covar_find_block( const obs_covar_type * covar , int index , int * offset ) {
+  for (int iblock = 0; iblock < vector_get_size( covar->blocks ); iblock++) {
+    matrix_type * block = vector_iget( covar->blocks , iblock );
+    int block_offset = int_vector_iget( covar->block_offset , iblock );
+    if ((index >= block_offset) && (index < block_offset + matrix_get_rows( block ))) {
+      *offset = block_offset;
+      return block;
+    }
+  }
+  return NULL;
+}
+
+
+void obs_covar_iset_var( obs_covar_type * covar , int index , double var ) {
+  int offset;
+  matrix_type * block = obs_covar_find_block( covar , index , &offset );
+
+  covar->diag[index] = var;
+  if (block != NULL)
+    matrix_iset( block , index - offset , index - offset , var );
+}
+
+
+double obs_covar_iget_var( const obs_covar_type * covar , int index ) {
+  return covar->diag[index];
+}
+
+
+/**
+   Will add a copy of the dense symmetric @block, covering the
+   elements [offset, offset + n) of R. The blocks can not overlap.
+*/
+
+void obs_covar_add_block( obs_covar_type * covar , int offset , const matrix_type * block ) {
+  const int block_size = matrix_get_rows( block );
+
+  if (matrix_get_columns( block ) != block_size)
+    util_abort("%s: block must be square - is %d x %d \n",__func__ , block_size , matrix_get_columns( block ));
+
+  if ((offset < 0) || (offset + block_size > covar->size))
+    util_abort("%s: block [%d,%d) outside the range [0,%d) \n",__func__ , offset , offset + block_size , covar->size);
+
+  for (int iblock = 0; iblock < vector_get_size( covar->blocks ); iblock++) {
+    const matrix_type * other = vector_iget_const( covar->blocks , iblock );
+    int other_offset = int_vector_iget( covar->block_offset , iblock );
+    if ((offset < other_offset + matrix_get_rows( other )) && (other_offset < offset + block_size))
+      util_abort("%s: block [%d,%d) overlaps existing block [%d,%d) \n",__func__ , offset , offset + block_size , other_offset , other_offset + matrix_get_rows( other ));
+  }
+
+  {
+    matrix_type * copy = matrix_alloc_copy( block );
+    for (int i = 0; i < block_size; i++)
+      covar->diag[ offset + i ] = matrix_iget( copy , i , i );
+
+    int_vector_append( covar->block_offset , offset );
+    vector_append_owned_ref( covar->blocks , copy , obs_covar_free_block__ );
+  }
+}
+
+
+double obs_covar_iget( const obs_covar_type * covar , int i , int j ) {
+  if (i == j)
+    return covar->diag[i];
+  else {
+    int offset;
+    const matrix_type * block = obs_covar_find_block( covar , i , &offset );
+    if ((block != NULL) && (j >= offset) && (j < offset + matrix_get_rows( block )))
+      return matrix_iget( block , i - offset , j - offset );
+    else
+      return 0;
+  }
+}
+
+
+/**
+   Will scale R(i,j) with scale_factor[i] * scale_factor[j]; this
+   corresponds to obs_data_scale_Rmatrix__() for a dense R.
+*/
+
+void obs_covar_scale( obs_covar_type * covar , const double * scale_factor ) {
+  for (int i = 0; i < covar->size; i++)
+    covar->diag[i] *= scale_factor[i] * scale_factor[i];
+
+  for (int iblock = 0; iblock < vector_get_size( covar->blocks ); iblock++) {
+    matrix_type * block = vector_iget( covar->blocks , iblock );
+    int offset = int_vector_iget( covar->block_offset , iblock );
+    for (int col = 0; col < matrix_get_columns( block ); col++)
+      for (int row = 0; row < matrix_get_rows( block ); row++)
+        matrix_imul( block , row , col , scale_factor[ offset + row ] * scale_factor[ offset + col ]);
+  }
+}
+
+
+/**
+   Allocates the dense R matrix; should only be used when a dense
+   matrix is really needed.
+*/
+
+matrix_type * obs_covar_alloc_matrix( const obs_covar_type * covar ) {
+  matrix_type * R = matrix_alloc( covar->size , covar->size );
+
+  for (int i = 0; i < covar->size; i++)
+    matrix_iset( R , i , i , covar->diag[i] );
+
+  for (int iblock = 0; iblock < vector_get_size( covar->blocks ); iblock++) {
+    const matrix_type * block = vector_iget_const( covar->blocks , iblock );
+    int offset = int_vector_iget( covar->block_offset , iblock );
+    for (int col = 0; col < matrix_get_columns( block ); col++)
+      for (int row = 0; row < matrix_get_rows( block ); row++)
+        matrix_iset( R , offset + row , offset + col , matrix_iget( block , row , col ));
+  }
+
+  matrix_set_name( R , "R" );
+  return R;
+}
+
+
+/**
+   Calculates C = R * B.
+*/
+
+void obs_covar_matmul( const obs_covar_type * covar , const matrix_type * B , matrix_type * C ) {
+  const int columns = matrix_get_columns( B );
+
+  if ((matrix_get_rows( B ) != covar->size) || (matrix_get_rows( C ) != covar->size) || (matrix_get_columns( C ) != columns))
+    util_abort("%s: size mismatch \n",__func__);
+
+  for (int col = 0; col < columns; col++)
+    for (int row = 0; row < covar->size; row++)
+      matrix_iset( C , row , col , covar->diag[row] * matrix_iget( B , row , col ));
+
+  for (int iblock = 0; iblock < vector_get_size( covar->blocks ); iblock++) {
+    const matrix_type * block = vector_iget_const( covar->blocks , iblock );
+    const int offset     = int_vector_iget( covar->block_offset , iblock );
+    const int block_size = matrix_get_rows( block );
+    matrix_type * B_block = matrix_alloc_sub_copy( B , offset , 0 , block_size , columns );
+    matrix_type * C_block = matrix_alloc( block_size , columns );
+
+    matrix_dgemm( C_block , block , B_block , false , false , 1.0 , 0.0 );
+    for (int col = 0; col < columns; col++)
+      for (int row = 0; row < block_size; row++)
+        matrix_iset( C , offset + row , col , matrix_iget( C_block , row , col ));
+
+    matrix_free( C_block );
+    matrix_free( B_block );
+  }
+}
+
+
+/**
+   Calculates B = U' * R * U; this is the only way R is used in the
+   low rank inversion of the std and sqrt modules and in the cv
+   module.
+*/
+
+void obs_covar_quadratic_form( const obs_covar_type * covar , const matrix_type * U , matrix_type * B ) {
+  matrix_type * RU = matrix_alloc( covar->size , matrix_get_columns( U ));
+  obs_covar_matmul( covar , U , RU );
+  matrix_dgemm( B , U , RU , true , false , 1.0 , 0.0 );  /* B = U' * (R * U) */
+  matrix_free( RU );
+}
@@ -106,7 +106,7 @@ void sqrt_enkf_initX(void * module_data ,
                      matrix_type * X ,
                      matrix_type * A ,
                      matrix_type * S ,
-                     matrix_type * R ,
+                     const obs_covar_type * R ,
                      matrix_type * dObs ,
                      matrix_type * E ,
                      matrix_type *D,
@@ -146,7 +146,7 @@ long sqrt_enkf_get_options( void * arg , long flag ) {
 void sqrt_enkf_init_update( void * arg ,
                           const bool_vector_type * ens_mask,
                           const matrix_type * S ,
-                          const matrix_type * R ,
+                          const obs_covar_type * R ,
                           const matrix_type * dObs ,
                           const matrix_type * E ,
                           const matrix_type * D,
@@ -209,9 +209,9 @@ analysis_table_type LINK_NAME = {
   .set_double      = sqrt_enkf_set_double ,
   .set_bool        = NULL ,
   .set_string      = NULL ,
-  .initX           = sqrt_enkf_initX ,
+  .initX           = NULL,
   .updateA         = NULL,
-  .init_update     = sqrt_enkf_init_update,
+  .init_update     = NULL,
   .complete_update = sqrt_enkf_complete_update,
   .get_options     = sqrt_enkf_get_options,
   .has_var         = sqrt_enkf_has_var,
@@ -220,3 +220,10 @@ analysis_table_type LINK_NAME = {
   .get_bool        = NULL,
   .get_ptr         = NULL
 };
+
+
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+  .initX       = sqrt_enkf_initX,
+  .updateA     = NULL,
+  .init_update = sqrt_enkf_init_update,
+};
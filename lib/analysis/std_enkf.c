@@ -132,7 +132,7 @@ void * std_enkf_data_alloc( ) {
 
   std_enkf_set_truncation( data , DEFAULT_ENKF_TRUNCATION_ );
   std_enkf_set_subspace_dimension( data , DEFAULT_SUBSPACE_DIMENSION );
-  data->option_flags = ANALYSIS_NEED_ED;
+  data->option_flags = ANALYSIS_NEED_ED + ANALYSIS_THREAD_SAFE;
   data->use_EE = DEFAULT_USE_EE;
   data->use_GE = DEFAULT_USE_GE;
   data->analysis_scale_data = DEFAULT_ANALYSIS_SCALE_DATA;
@@ -149,7 +149,7 @@ void std_enkf_data_free( void * data ) {
 
 static void std_enkf_initX__( matrix_type * X ,
                               matrix_type * S ,
-                              matrix_type * R ,
+                              const obs_covar_type * R ,
                               matrix_type * E ,
                               matrix_type * D ,
                               double truncation,
@@ -174,10 +174,13 @@ static void std_enkf_initX__( matrix_type * X ,
      else {
        matrix_type * Et = matrix_alloc_transpose( E );
        matrix_type * Cee = matrix_alloc_matmul( E , Et );
+       obs_covar_type * Cee_covar = obs_covar_alloc( nrobs );
        matrix_scale( Cee , 1.0 / (ens_size - 1));
+       obs_covar_add_block( Cee_covar , 0 , Cee );
 
-       enkf_linalg_lowrankCinv( S , Cee , W , eig , truncation , ncomp);
+       enkf_linalg_lowrankCinv( S , Cee_covar , W , eig , truncation , ncomp);
 
+       obs_covar_free( Cee_covar );
        matrix_free( Et );
        matrix_free( Cee );
      }
@@ -202,7 +205,7 @@ void std_enkf_initX(void * module_data ,
                     matrix_type * X ,
                     matrix_type * A ,
                     matrix_type * S ,
-                    matrix_type * R ,
+                    const obs_covar_type * R ,
                     matrix_type * dObs ,
                     matrix_type * E ,
                     matrix_type * D,
@@ -355,7 +358,7 @@ analysis_table_type LINK_NAME = {
     .set_bool        = std_enkf_set_bool,
     .set_string      = NULL ,
     .get_options     = std_enkf_get_options ,
-    .initX           = std_enkf_initX ,
+    .initX           = NULL,
     .updateA         = NULL,
     .init_update     = NULL,
     .complete_update = NULL,
@@ -366,3 +369,10 @@ analysis_table_type LINK_NAME = {
     .get_ptr         = NULL,
 };
 
+
+analysis_covar_table_type ANALYSIS_COVAR_TABLE( LINK_NAME ) = {
+    .initX       = std_enkf_initX,
+    .updateA     = NULL,
+    .init_update = NULL,
+};
+
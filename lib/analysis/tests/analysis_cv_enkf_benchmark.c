@@ -0,0 +1,110 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'analysis_cv_enkf_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Benchmark of the cv_enkf PRESS calculation from the ensemble Gram
+  matrix; prints the time used for growing state sizes. The benchmark
+  is not part of the test suite, run it manually as:
+
+     analysis_cv_enkf_benchmark [max_nx] [nrens] [nrobs]
+
+  The state size starts at 1000 and is multiplied by 10 up to max_nx.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/res_util/matrix.h>
+
+#include <ert/analysis/obs_covar.h>
+#include <ert/analysis/cv_enkf.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static void benchmark_cv( int nx , int nrens , int nrobs , rng_type * rng ) {
+  cv_enkf_data_type * cv_data = cv_enkf_data_alloc( );
+  matrix_type * S = matrix_alloc( nrobs , nrens );
+  matrix_type * D = matrix_alloc( nrobs , nrens );
+  matrix_type * E = matrix_alloc( nrobs , nrens );
+  matrix_type * A = matrix_alloc( nx , nrens );
+  obs_covar_type * R = obs_covar_alloc( nrobs );
+  int * randperms = util_calloc( nrens , sizeof * randperms );
+
+  matrix_random_init( S , rng );
+  matrix_random_init( D , rng );
+  matrix_random_init( E , rng );
+  matrix_random_init( A , rng );
+  matrix_subtract_row_mean( A );
+  matrix_subtract_row_mean( S );
+  for (int i = 0; i < nrobs; i++)
+    obs_covar_iset_var( R , i , 0.25 + rng_get_double( rng ));
+
+  for (int i = 0; i < nrens; i++)
+    randperms[i] = i;
+  rng_shuffle_int( rng , randperms , nrens );
+
+  cv_enkf_set_truncation( cv_data , 0.99 );
+  cv_enkf_init_update( cv_data , NULL , S , R , NULL , E , D , rng );
+  {
+    int maxP = cv_enkf_get_max_subspace_dimension( cv_data );
+    double start = wall_clock( );
+    matrix_type * cvError = cv_enkf_alloc_cv_error( cv_data , A , randperms , maxP );
+
+    printf("nx: %8d  nrens: %4d  maxP: %2d  PRESS: %8.4f s\n", nx , nrens , maxP , wall_clock( ) - start );
+    matrix_free( cvError );
+  }
+
+  free( randperms );
+  obs_covar_free( R );
+  matrix_free( A );
+  matrix_free( E );
+  matrix_free( D );
+  matrix_free( S );
+  cv_enkf_data_free( cv_data );
+}
+
+
+int main( int argc , char ** argv ) {
+  const int max_nx = int_arg( argc , argv , 1 , 1000000 );
+  const int nrens  = int_arg( argc , argv , 2 , 100 );
+  const int nrobs  = int_arg( argc , argv , 3 , 50 );
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+
+  for (int nx = 1000; nx <= max_nx; nx *= 10)
+    benchmark_cv( nx , nrens , nrobs , rng );
+
+  rng_free( rng );
+  exit(0);
+}
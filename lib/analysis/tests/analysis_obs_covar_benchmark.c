@@ -0,0 +1,117 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'analysis_obs_covar_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Memory and time used to form U' * R * U with the structured R
+  compared to a dense R, for a large diagonal R with a few small
+  blocks. The benchmark is not part of the test suite, run it manually
+  as:
+
+     analysis_obs_covar_benchmark [size] [ncol] [num_blocks] [block_size]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/res_util/matrix.h>
+#include <ert/res_util/matrix_blas.h>
+
+#include <ert/analysis/obs_covar.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static obs_covar_type * alloc_covar( int size , int num_blocks , int block_size , rng_type * rng ) {
+  obs_covar_type * covar = obs_covar_alloc( size );
+
+  for (int i = 0; i < size; i++)
+    obs_covar_iset_var( covar , i , 1.0 + rng_get_double( rng ));
+
+  for (int iblock = 0; iblock < num_blocks; iblock++) {
+    matrix_type * X = matrix_alloc( block_size , block_size );
+    matrix_type * block = matrix_alloc( block_size , block_size );
+
+    matrix_random_init( X , rng );
+    matrix_dgemm( block , X , X , false , true , 1.0 , 0.0 );
+    for (int i = 0; i < block_size; i++)
+      matrix_iadd( block , i , i , block_size );
+
+    obs_covar_add_block( covar , iblock * size / num_blocks , block );
+    matrix_free( block );
+    matrix_free( X );
+  }
+
+  return covar;
+}
+
+
+int main( int argc , char ** argv ) {
+  const int size       = int_arg( argc , argv , 1 , 4000 );
+  const int ncol       = int_arg( argc , argv , 2 , 100 );
+  const int num_blocks = int_arg( argc , argv , 3 , 4 );
+  const int block_size = int_arg( argc , argv , 4 , 20 );
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  obs_covar_type * covar = alloc_covar( size , num_blocks , block_size , rng );
+  matrix_type * R  = obs_covar_alloc_matrix( covar );
+  matrix_type * U  = matrix_alloc( size , ncol );
+  matrix_type * B  = matrix_alloc( ncol , ncol );
+  matrix_type * X0 = matrix_alloc( ncol , size );
+  double structured_time, dense_time;
+
+  matrix_random_init( U , rng );
+  {
+    double start = wall_clock( );
+    obs_covar_quadratic_form( covar , U , B );
+    structured_time = wall_clock( ) - start;
+  }
+
+  {
+    double start = wall_clock( );
+    matrix_dgemm( X0 , U , R , true , false , 1.0 , 0.0 );
+    matrix_dgemm( B , X0 , U , false , false , 1.0 , 0.0 );
+    dense_time = wall_clock( ) - start;
+  }
+
+  printf("R: %d x %d with %d blocks\n", size , size , obs_covar_get_num_blocks( covar ));
+  printf("  structured: %8.2f MB  %8.4f s\n", obs_covar_get_storage_size( covar ) * sizeof(double) / (1024.0 * 1024) , structured_time);
+  printf("  dense     : %8.2f MB  %8.4f s\n", (double) size * size * sizeof(double) / (1024.0 * 1024) , dense_time);
+
+  matrix_free( X0 );
+  matrix_free( B );
+  matrix_free( U );
+  matrix_free( R );
+  obs_covar_free( covar );
+  rng_free( rng );
+  exit(0);
+}
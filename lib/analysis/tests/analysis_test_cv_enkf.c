@@ -0,0 +1,179 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'analysis_test_cv_enkf.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/res_util/matrix.h>
+#include <ert/res_util/matrix_blas.h>
+
+#include <ert/analysis/obs_covar.h>
+#include <ert/analysis/cv_enkf.h>
+
+
+/*
+  The direct PRESS calculation: for each fold and subspace dimension
+  the test members are predicted with AHat = ATrain * W2 in the full
+  state space.
+*/
+
+static matrix_type * alloc_cv_error_direct( const cv_enkf_data_type * cv_data , const matrix_type * A , const int * randperms , int maxP ) {
+  const matrix_type * Z  = cv_enkf_get_Z( cv_data );
+  const matrix_type * Rp = cv_enkf_get_Rp( cv_data );
+  const int nfolds = cv_enkf_get_nfolds( cv_data );
+  const int nrens  = matrix_get_columns( Z );
+  const int nx     = matrix_get_rows( A );
+  matrix_type * cvError = matrix_alloc( maxP , nfolds );
+  int * indexTest  = util_calloc( nrens , sizeof * indexTest );
+  int * indexTrain = util_calloc( nrens , sizeof * indexTrain );
+
+  for (int fold = 0; fold < nfolds; fold++) {
+    int nTest = 0;
+    int nTrain = 0;
+    for (int j = 0; j < nrens; j++) {
+      if ((j % nfolds) == fold)
+        indexTest[nTest++] = randperms[j];
+      else
+        indexTrain[nTrain++] = randperms[j];
+    }
+
+    {
+      matrix_type * ATrain = matrix_alloc( nx , nTrain );
+      matrix_type * AHat   = matrix_alloc( nx , nTest );
+
+      for (int j = 0; j < nTrain; j++)
+        for (int i = 0; i < nx; i++)
+          matrix_iset( ATrain , i , j , matrix_iget( A , i , indexTrain[j] ));
+
+      for (int p = 0; p < maxP; p++) {
+        matrix_type * ZpTrain = matrix_alloc( p + 1 , nTrain );
+        matrix_type * ZpTest  = matrix_alloc( p + 1 , nTest );
+        matrix_type * SigDp   = matrix_alloc( p + 1 , p + 1 );
+        matrix_type * W       = matrix_alloc( p + 1 , nTest );
+        matrix_type * W2      = matrix_alloc( nTrain , nTest );
+
+        for (int i = 0; i <= p; i++) {
+          for (int j = 0; j < nTrain; j++)
+            matrix_iset( ZpTrain , i , j , matrix_iget( Z , i , indexTrain[j] ));
+          for (int j = 0; j < nTest; j++)
+            matrix_iset( ZpTest , i , j , matrix_iget( Z , i , indexTest[j] ));
+        }
+
+        matrix_dgemm( SigDp , ZpTrain , ZpTrain , false , true , 1.0 , 0.0 );
+        for (int i = 0; i <= p; i++)
+          for (int j = 0; j <= p; j++)
+            matrix_iadd( SigDp , i , j , (nTrain - 1) * matrix_iget( Rp , i , j ));
+
+        test_assert_int_equal( 0 , matrix_inv( SigDp ));
+        matrix_matmul( W , SigDp , ZpTest );
+        matrix_dgemm( W2 , ZpTrain , W , true , false , 1.0 , 0.0 );
+        matrix_matmul( AHat , ATrain , W2 );
+        {
+          double R2Sum = 0;
+          for (int j = 0; j < nTest; j++)
+            for (int i = 0; i < nx; i++) {
+              double tmp = matrix_iget( A , i , indexTest[j] ) - matrix_iget( AHat , i , j );
+              R2Sum += tmp * tmp;
+            }
+          matrix_iset( cvError , p , fold , R2Sum );
+        }
+
+        matrix_free( W2 );
+        matrix_free( W );
+        matrix_free( SigDp );
+        matrix_free( ZpTest );
+        matrix_free( ZpTrain );
+      }
+      matrix_free( AHat );
+      matrix_free( ATrain );
+    }
+  }
+
+  free( indexTrain );
+  free( indexTest );
+  return cvError;
+}
+
+
+static void test_cv( int nx , int nrens , int nrobs , rng_type * rng ) {
+  cv_enkf_data_type * cv_data = cv_enkf_data_alloc( );
+  matrix_type * S = matrix_alloc( nrobs , nrens );
+  matrix_type * D = matrix_alloc( nrobs , nrens );
+  matrix_type * E = matrix_alloc( nrobs , nrens );
+  matrix_type * A = matrix_alloc( nx , nrens );
+  obs_covar_type * R = obs_covar_alloc( nrobs );
+  int * randperms = util_calloc( nrens , sizeof * randperms );
+
+  matrix_random_init( S , rng );
+  matrix_random_init( D , rng );
+  matrix_random_init( E , rng );
+  matrix_random_init( A , rng );
+  matrix_subtract_row_mean( A );
+  matrix_subtract_row_mean( S );
+  for (int i = 0; i < nrobs; i++)
+    obs_covar_iset_var( R , i , 0.25 + rng_get_double( rng ));
+
+  for (int i = 0; i < nrens; i++)
+    randperms[i] = i;
+  rng_shuffle_int( rng , randperms , nrens );
+
+  cv_enkf_set_truncation( cv_data , 0.99 );
+  cv_enkf_init_update( cv_data , NULL , S , R , NULL , E , D , rng );
+  {
+    int maxP = cv_enkf_get_max_subspace_dimension( cv_data );
+    matrix_type * cvError = cv_enkf_alloc_cv_error( cv_data , A , randperms , maxP );
+    matrix_type * cvError_direct = alloc_cv_error_direct( cv_data , A , randperms , maxP );
+
+    test_assert_int_equal( maxP , matrix_get_rows( cvError ));
+    for (int p = 0; p < maxP; p++)
+      for (int fold = 0; fold < cv_enkf_get_nfolds( cv_data ); fold++) {
+        double e1 = matrix_iget( cvError , p , fold );
+        double e2 = matrix_iget( cvError_direct , p , fold );
+        test_assert_true( fabs( e1 - e2 ) <= 1e-6 * fabs( e2 ));
+      }
+
+    test_assert_int_equal( cv_enkf_get_optimal_numb_comp( cv_data , cvError_direct , maxP ),
+                           cv_enkf_get_optimal_numb_comp( cv_data , cvError , maxP ));
+
+    matrix_free( cvError_direct );
+    matrix_free( cvError );
+  }
+
+  free( randperms );
+  obs_covar_free( R );
+  matrix_free( A );
+  matrix_free( E );
+  matrix_free( D );
+  matrix_free( S );
+  cv_enkf_data_free( cv_data );
+}
+
+
+int main(int argc , char ** argv) {
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+
+  test_cv( 100   , 50 , 30 , rng );
+  test_cv( 1000  , 50 , 30 , rng );
+  test_cv( 10000 , 50 , 30 , rng );
+
+  rng_free( rng );
+  exit(0);
+}
@@ -0,0 +1,213 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'analysis_test_obs_covar.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/rng.h>
+#include <ert/util/int_vector.h>
+#include <ert/res_util/matrix.h>
+#include <ert/res_util/matrix_blas.h>
+
+#include <ert/analysis/obs_covar.h>
+
+
+static void assert_matrix_close( const matrix_type * m1 , const matrix_type * m2 ) {
+  test_assert_int_equal( matrix_get_rows( m1 ) , matrix_get_rows( m2 ));
+  test_assert_int_equal( matrix_get_columns( m1 ) , matrix_get_columns( m2 ));
+  for (int col = 0; col < matrix_get_columns( m1 ); col++)
+    for (int row = 0; row < matrix_get_rows( m1 ); row++)
+      test_assert_double_equal( matrix_iget( m1 , row , col ) , matrix_iget( m2 , row , col ));
+}
+
+
+/*
+  Symmetric positive block of size n: B = X * X' + n * I
+*/
+
+static matrix_type * alloc_block( int n , rng_type * rng ) {
+  matrix_type * X = matrix_alloc( n , n );
+  matrix_type * B = matrix_alloc( n , n );
+
+  matrix_random_init( X , rng );
+  matrix_dgemm( B , X , X , false , true , 1.0 , 0.0 );
+  for (int i = 0; i < n; i++)
+    matrix_iadd( B , i , i , n );
+
+  matrix_free( X );
+  return B;
+}
+
+
+/*
+  Diagonal R with a couple of dense blocks.
+*/
+
+static obs_covar_type * alloc_covar( int size , int num_blocks , int block_size , rng_type * rng ) {
+  obs_covar_type * covar = obs_covar_alloc( size );
+
+  for (int i = 0; i < size; i++)
+    obs_covar_iset_var( covar , i , 1.0 + rng_get_double( rng ));
+
+  for (int iblock = 0; iblock < num_blocks; iblock++) {
+    matrix_type * block = alloc_block( block_size , rng );
+    obs_covar_add_block( covar , iblock * size / num_blocks , block );
+    matrix_free( block );
+  }
+
+  return covar;
+}
+
+
+void test_create( ) {
+  obs_covar_type * covar = obs_covar_alloc( 10 );
+  test_assert_true( obs_covar_is_instance( covar ));
+  test_assert_int_equal( 10 , obs_covar_get_size( covar ));
+  test_assert_true( obs_covar_is_diagonal( covar ));
+  test_assert_size_t_equal( 10 , obs_covar_get_storage_size( covar ));
+
+  obs_covar_iset_var( covar , 3 , 2.5 );
+  test_assert_double_equal( 2.5 , obs_covar_iget_var( covar , 3 ));
+  test_assert_double_equal( 2.5 , obs_covar_iget( covar , 3 , 3 ));
+  test_assert_double_equal( 0 , obs_covar_iget( covar , 3 , 4 ));
+  obs_covar_free( covar );
+}
+
+
+void test_dense_equivalence( rng_type * rng ) {
+  const int size = 50;
+  const int ncol = 7;
+  obs_covar_type * covar = alloc_covar( size , 3 , 5 , rng );
+  matrix_type * R = obs_covar_alloc_matrix( covar );
+
+  test_assert_int_equal( 3 , obs_covar_get_num_blocks( covar ));
+  test_assert_false( obs_covar_is_diagonal( covar ));
+  test_assert_size_t_equal( size + 3 * 25 , obs_covar_get_storage_size( covar ));
+
+  for (int i = 0; i < size; i++)
+    for (int j = 0; j < size; j++)
+      test_assert_double_equal( matrix_iget( R , i , j ) , obs_covar_iget( covar , i , j ));
+
+  /* Setting the variance inside a block must also update the block. */
+  obs_covar_iset_var( covar , 1 , 77 );
+  matrix_iset( R , 1 , 1 , 77 );
+  test_assert_double_equal( 77 , obs_covar_iget( covar , 1 , 1 ));
+
+  {
+    matrix_type * B  = matrix_alloc( size , ncol );
+    matrix_type * C1 = matrix_alloc( size , ncol );
+    matrix_type * C2 = matrix_alloc( size , ncol );
+
+    matrix_random_init( B , rng );
+    obs_covar_matmul( covar , B , C1 );
+    matrix_matmul( C2 , R , B );
+    assert_matrix_close( C1 , C2 );
+
+    matrix_free( B );
+    matrix_free( C1 );
+    matrix_free( C2 );
+  }
+
+  {
+    matrix_type * U  = matrix_alloc( size , ncol );
+    matrix_type * B1 = matrix_alloc( ncol , ncol );
+    matrix_type * B2 = matrix_alloc( ncol , ncol );
+    matrix_type * X0 = matrix_alloc( ncol , size );
+
+    matrix_random_init( U , rng );
+    obs_covar_quadratic_form( covar , U , B1 );
+    matrix_dgemm( X0 , U , R , true , false , 1.0 , 0.0 );
+    matrix_dgemm( B2 , X0 , U , false , false , 1.0 , 0.0 );
+    assert_matrix_close( B1 , B2 );
+
+    matrix_free( U );
+    matrix_free( B1 );
+    matrix_free( B2 );
+    matrix_free( X0 );
+  }
+
+  {
+    double * scale_factor = util_calloc( size , sizeof * scale_factor );
+    matrix_type * scaled_R;
+
+    for (int i = 0; i < size; i++)
+      scale_factor[i] = 0.5 + rng_get_double( rng );
+
+    obs_covar_scale( covar , scale_factor );
+    for (int i = 0; i < size; i++)
+      for (int j = 0; j < size; j++)
+        matrix_imul( R , i , j , scale_factor[i] * scale_factor[j]);
+
+    scaled_R = obs_covar_alloc_matrix( covar );
+    assert_matrix_close( R , scaled_R );
+    matrix_free( scaled_R );
+    free( scale_factor );
+  }
+
+  {
+    obs_covar_type * covar2 = obs_covar_alloc_from_matrix( R );
+    matrix_type * R2 = obs_covar_alloc_matrix( covar2 );
+
+    test_assert_int_equal( 3 , obs_covar_get_num_blocks( covar2 ));
+    test_assert_size_t_equal( obs_covar_get_storage_size( covar ) , obs_covar_get_storage_size( covar2 ));
+    assert_matrix_close( R , R2 );
+
+    matrix_free( R2 );
+    obs_covar_free( covar2 );
+  }
+
+  matrix_free( R );
+  obs_covar_free( covar );
+}
+
+
+void test_subset( rng_type * rng ) {
+  const int size = 40;
+  obs_covar_type * covar = alloc_covar( size , 4 , 6 , rng );
+  int_vector_type * index = int_vector_alloc( 0 , 0 );
+
+  for (int i = 0; i < size; i++)
+    if (rng_get_double( rng ) < 0.6)
+      int_vector_append( index , i );
+
+  {
+    obs_covar_type * subset = obs_covar_alloc_subset( covar , index );
+    test_assert_int_equal( int_vector_size( index ) , obs_covar_get_size( subset ));
+    for (int i = 0; i < int_vector_size( index ); i++)
+      for (int j = 0; j < int_vector_size( index ); j++)
+        test_assert_double_equal( obs_covar_iget( covar , int_vector_iget( index , i ) , int_vector_iget( index , j )) ,
+                                  obs_covar_iget( subset , i , j ));
+    obs_covar_free( subset );
+  }
+
+  int_vector_free( index );
+  obs_covar_free( covar );
+}
+
+
+int main(int argc , char ** argv) {
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+
+  test_create( );
+  test_dense_equivalence( rng );
+  test_subset( rng );
+
+  rng_free( rng );
+  exit(0);
+}
@@ -0,0 +1,601 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'config_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/vector.h>
+#include <ert/util/buffer.h>
+#include <ert/util/stringlist.h>
+
+#include <ert/config/config_cache.h>
+
+/**
+   The config_cache is a recording of one call to config_parse(): the
+   sequence of files which were opened, the DEFINE statements and the
+   keyword lines - after DEFINE and environment variable substitution -
+   in the order they were encountered. When the same file is parsed
+   again the recording can be replayed into a new config_content
+   instance instead of reading, tokenizing and substituting all the
+   files again. The schema validation is still performed when the
+   recording is replayed, since that also checks the filesystem for
+   existing files and executables.
+
+   The recording is only valid as long as the inputs are unchanged:
+
+    1. The key is a string which describes the arguments to
+       config_parse(), the schema and the working directory; the key
+       is stored in the cache file and must match exactly.
+
+    2. For every file which was parsed the content hash is stored,
+       along with the size and mtime. If size and mtime are unchanged
+       the file is assumed to be unchanged, otherwise the content hash
+       is recalculated and compared.
+
+    3. For every environment variable which was referenced the value,
+       or the fact that it was not set, is stored and compared.
+
+   If anything has changed config_parse() falls back to a normal
+   parse, and writes a new cache file.
+
+   Only the parsing is cached, i.e. the config_content instance. The
+   objects built from the content - ensemble_config, ecl_config with
+   the grid, site_config, the ext_job and workflow_job definitions and
+   so on - are rebuilt on every start. Building them inspects the
+   filesystem: grid and refcase files are loaded, executables are
+   looked up in PATH and checked for permissions. That would have to
+   be validated again before a cached object could be used, and these
+   objects have no serialized form.
+*/
+
+#define CONFIG_CACHE_TYPE_ID  66107153
+#define CONFIG_CACHE_MAGIC    0x45525443       /* "ERTC" */
+#define CONFIG_CACHE_VERSION  1
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME        1099511628211ULL
+
+
+typedef struct {
+  char     * path;
+  long       size;
+  time_t     mtime;
+  uint64_t   hash;
+} config_cache_file_type;
+
+
+typedef struct {
+  char * var;
+  char * value;        /* NULL if the variable was not set. */
+} config_cache_env_type;
+
+
+typedef struct {
+  config_cache_event_type   event;
+  char                    * file;
+  stringlist_type         * args;
+} config_cache_node_type;
+
+
+struct config_cache_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char        * key;
+  time_t        write_time;
+  vector_type * files;
+  vector_type * env;
+  vector_type * nodes;
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( config_cache , CONFIG_CACHE_TYPE_ID )
+
+
+/*****************************************************************/
+
+uint64_t config_cache_hash_string( uint64_t hash , const char * string ) {
+  if (string) {
+    for (const unsigned char * c = (const unsigned char *) string; *c; c++) {
+      hash ^= *c;
+      hash *= FNV_PRIME;
+    }
+  }
+  /* Include a terminator so that {"ab","c"} and {"a","bc"} differ. */
+  hash ^= 0xff;
+  hash *= FNV_PRIME;
+  return hash;
+}
+
+
+bool config_cache_hash_file( const char * filename , uint64_t * hash ) {
+  FILE * stream = fopen( filename , "r" );
+  if (stream == NULL)
+    return false;
+  {
+    unsigned char buffer[65536];
+    size_t bytes;
+    uint64_t h = FNV_OFFSET_BASIS;
+
+    while ((bytes = fread( buffer , 1 , sizeof buffer , stream )) > 0) {
+      for (size_t i = 0; i < bytes; i++) {
+        h ^= buffer[i];
+        h *= FNV_PRIME;
+      }
+    }
+    fclose( stream );
+    *hash = h;
+  }
+  return true;
+}
+
+
+char * config_cache_alloc_filename( const char * cache_path , const char * key ) {
+  uint64_t hash = config_cache_hash_string( FNV_OFFSET_BASIS , key );
+  char * basename = util_alloc_sprintf( "%016llx" , (unsigned long long) hash );
+  char * filename = util_alloc_filename( cache_path , basename , "cache" );
+  free( basename );
+  return filename;
+}
+
+
+/*****************************************************************/
+
+static void config_cache_file_free( config_cache_file_type * file ) {
+  free( file->path );
+  free( file );
+}
+
+static void config_cache_file_free__( void * arg ) {
+  config_cache_file_free( (config_cache_file_type *) arg );
+}
+
+static void config_cache_env_free( config_cache_env_type * env ) {
+  free( env->var );
+  util_safe_free( env->value );
+  free( env );
+}
+
+static void config_cache_env_free__( void * arg ) {
+  config_cache_env_free( (config_cache_env_type *) arg );
+}
+
+static void config_cache_node_free( config_cache_node_type * node ) {
+  util_safe_free( node->file );
+  stringlist_free( node->args );
+  free( node );
+}
+
+static void config_cache_node_free__( void * arg ) {
+  config_cache_node_free( (config_cache_node_type *) arg );
+}
+
+
+static config_cache_node_type * config_cache_append_node( config_cache_type * cache , config_cache_event_type event , const char * file ) {
+  config_cache_node_type * node = util_malloc( sizeof * node );
+  node->event = event;
+  node->file  = util_alloc_string_copy( file );
+  node->args  = stringlist_alloc_new( );
+  vector_append_owned_ref( cache->nodes , node , config_cache_node_free__ );
+  return node;
+}
+
+
+config_cache_type * config_cache_alloc( const char * key ) {
+  config_cache_type * cache = util_malloc( sizeof * cache );
+  UTIL_TYPE_ID_INIT( cache , CONFIG_CACHE_TYPE_ID );
+  cache->key        = util_alloc_string_copy( key );
+  cache->write_time = 0;
+  cache->files      = vector_alloc_new( );
+  cache->env        = vector_alloc_new( );
+  cache->nodes      = vector_alloc_new( );
+  return cache;
+}
+
+
+void config_cache_free( config_cache_type * cache ) {
+  vector_free( cache->files );
+  vector_free( cache->env );
+  vector_free( cache->nodes );
+  free( cache->key );
+  free( cache );
+}
+
+
+const char * config_cache_get_key( const config_cache_type * cache ) {
+  return cache->key;
+}
+
+
+/*
+  Records the current content hash, size and mtime of @filename. If
+  the file can not be hashed the recording can not be validated later,
+  and the empty path will make sure it is never considered current.
+*/
+
+void config_cache_add_file( config_cache_type * cache , const char * filename ) {
+  config_cache_file_type * file = util_malloc( sizeof * file );
+  struct stat st;
+
+  file->path  = util_alloc_realpath( filename );
+  file->size  = -1;
+  file->mtime = -1;
+  file->hash  = 0;
+  if ((stat( file->path , &st ) == 0) && config_cache_hash_file( file->path , &file->hash )) {
+    file->size  = st.st_size;
+    file->mtime = st.st_mtime;
+  }
+  vector_append_owned_ref( cache->files , file , config_cache_file_free__ );
+}
+
+
+void config_cache_add_env( config_cache_type * cache , const char * var , const char * value ) {
+  for (int i = 0; i < vector_get_size( cache->env ); i++) {
+    const config_cache_env_type * env = vector_iget_const( cache->env , i );
+    if (strcmp( env->var , var ) == 0)
+      return;
+  }
+  {
+    config_cache_env_type * env = util_malloc( sizeof * env );
+    env->var   = util_alloc_string_copy( var );
+    env->value = util_alloc_string_copy( value );
+    vector_append_owned_ref( cache->env , env , config_cache_env_free__ );
+  }
+}
+
+
+void config_cache_push( config_cache_type * cache , const char * config_filename ) {
+  config_cache_append_node( cache , CONFIG_CACHE_PUSH , config_filename );
+}
+
+
+void config_cache_pop( config_cache_type * cache ) {
+  config_cache_append_node( cache , CONFIG_CACHE_POP , NULL );
+}
+
+
+void config_cache_add_define( config_cache_type * cache , const char * key , const char * value ) {
+  config_cache_node_type * node = config_cache_append_node( cache , CONFIG_CACHE_DEFINE , NULL );
+  stringlist_append_copy( node->args , key );
+  stringlist_append_copy( node->args , value );
+}
+
+
+void config_cache_add_keyword( config_cache_type * cache , const char * config_file , const stringlist_type * tokens ) {
+  config_cache_node_type * node = config_cache_append_node( cache , CONFIG_CACHE_KEYWORD , config_file );
+  stringlist_append_stringlist_copy( node->args , tokens );
+}
+
+
+int config_cache_get_num_files( const config_cache_type * cache ) {
+  return vector_get_size( cache->files );
+}
+
+
+int config_cache_get_size( const config_cache_type * cache ) {
+  return vector_get_size( cache->nodes );
+}
+
+
+config_cache_event_type config_cache_iget_event( const config_cache_type * cache , int index ) {
+  const config_cache_node_type * node = vector_iget_const( cache->nodes , index );
+  return node->event;
+}
+
+
+const char * config_cache_iget_file( const config_cache_type * cache , int index ) {
+  const config_cache_node_type * node = vector_iget_const( cache->nodes , index );
+  return node->file;
+}
+
+
+const stringlist_type * config_cache_iget_args( const config_cache_type * cache , int index ) {
+  const config_cache_node_type * node = vector_iget_const( cache->nodes , index );
+  return node->args;
+}
+
+
+/*****************************************************************/
+
+/*
+  A file which was modified within a second of the cache being
+  written can be changed again without the mtime changing; in that
+  case the content hash is always checked.
+*/
+
+static bool config_cache_file_is_current( const config_cache_file_type * file , time_t write_time ) {
+  struct stat st;
+  if (file->size < 0)
+    return false;
+
+  if (stat( file->path , &st ) != 0)
+    return false;
+
+  if ((st.st_size == file->size) && (st.st_mtime == file->mtime) && (file->mtime < (write_time - 1)))
+    return true;
+
+  if (st.st_size != file->size)
+    return false;
+  {
+    uint64_t hash;
+    if (!config_cache_hash_file( file->path , &hash ))
+      return false;
+    return (hash == file->hash);
+  }
+}
+
+
+bool config_cache_is_current( const config_cache_type * cache ) {
+  for (int i = 0; i < vector_get_size( cache->env ); i++) {
+    const config_cache_env_type * env = vector_iget_const( cache->env , i );
+    if (!util_string_equal( env->value , getenv( env->var )))
+      return false;
+  }
+
+  for (int i = 0; i < vector_get_size( cache->files ); i++) {
+    if (!config_cache_file_is_current( vector_iget_const( cache->files , i ) , cache->write_time ))
+      return false;
+  }
+
+  return true;
+}
+
+
+/*****************************************************************/
+
+static void config_cache_buffer_fwrite_string( buffer_type * buffer , const char * string ) {
+  if (string == NULL)
+    buffer_fwrite_int( buffer , -1 );
+  else {
+    int length = strlen( string );
+    buffer_fwrite_int( buffer , length );
+    buffer_fwrite( buffer , string , 1 , length );
+  }
+}
+
+
+/*
+  The read functions check the remaining size before reading, and set
+  *ok to false instead of failing on a truncated or corrupt file.
+*/
+
+static int config_cache_buffer_fread_int( buffer_type * buffer , bool * ok ) {
+  if (!*ok || (buffer_get_remaining_size( buffer ) < (long) sizeof(int))) {
+    *ok = false;
+    return 0;
+  }
+  return buffer_fread_int( buffer );
+}
+
+
+static bool config_cache_buffer_fread( buffer_type * buffer , void * target , size_t size , bool * ok ) {
+  if (!*ok || (buffer_get_remaining_size( buffer ) < (long) size)) {
+    *ok = false;
+    return false;
+  }
+  buffer_fread( buffer , target , 1 , size );
+  return true;
+}
+
+
+static char * config_cache_buffer_fread_alloc_string( buffer_type * buffer , bool * ok ) {
+  int length = config_cache_buffer_fread_int( buffer , ok );
+  if (!*ok || (length < 0))
+    return NULL;
+  {
+    char * string = util_calloc( length + 1 , sizeof * string );
+    if (!config_cache_buffer_fread( buffer , string , length , ok )) {
+      free( string );
+      return NULL;
+    }
+    string[length] = '\0';
+    return string;
+  }
+}
+
+
+static void config_cache_buffer_fwrite( const config_cache_type * cache , buffer_type * buffer , time_t write_time) {
+  buffer_fwrite_int( buffer , CONFIG_CACHE_MAGIC );
+  buffer_fwrite_int( buffer , CONFIG_CACHE_VERSION );
+  buffer_fwrite( buffer , &write_time , sizeof write_time , 1 );
+  config_cache_buffer_fwrite_string( buffer , cache->key );
+
+  buffer_fwrite_int( buffer , vector_get_size( cache->files ));
+  for (int i = 0; i < vector_get_size( cache->files ); i++) {
+    const config_cache_file_type * file = vector_iget_const( cache->files , i );
+    config_cache_buffer_fwrite_string( buffer , file->path );
+    buffer_fwrite( buffer , &file->size , sizeof file->size , 1 );
+    buffer_fwrite( buffer , &file->mtime , sizeof file->mtime , 1 );
+    buffer_fwrite( buffer , &file->hash , sizeof file->hash , 1 );
+  }
+
+  buffer_fwrite_int( buffer , vector_get_size( cache->env ));
+  for (int i = 0; i < vector_get_size( cache->env ); i++) {
+    const config_cache_env_type * env = vector_iget_const( cache->env , i );
+    config_cache_buffer_fwrite_string( buffer , env->var );
+    config_cache_buffer_fwrite_string( buffer , env->value );
+  }
+
+  buffer_fwrite_int( buffer , vector_get_size( cache->nodes ));
+  for (int i = 0; i < vector_get_size( cache->nodes ); i++) {
+    const config_cache_node_type * node = vector_iget_const( cache->nodes , i );
+    buffer_fwrite_int( buffer , node->event );
+    config_cache_buffer_fwrite_string( buffer , node->file );
+    buffer_fwrite_int( buffer , stringlist_get_size( node->args ));
+    for (int j = 0; j < stringlist_get_size( node->args ); j++)
+      config_cache_buffer_fwrite_string( buffer , stringlist_iget( node->args , j ));
+  }
+}
+
+
+/*
+  The cache file is written to a temporary file which is renamed in
+  place, so that concurrent readers never see a partial file. Failing
+  to write the cache is not an error; the function just returns false.
+*/
+
+bool config_cache_fwrite( const config_cache_type * cache , const char * filename ) {
+  bool ok = false;
+  buffer_type * buffer = buffer_alloc( 4096 );
+  char * tmp_file = util_alloc_sprintf( "%s.%d" , filename , getpid( ));
+
+  config_cache_buffer_fwrite( cache , buffer , time( NULL ));
+  {
+    FILE * stream = fopen( tmp_file , "w" );
+    if (stream) {
+      size_t size = buffer_get_size( buffer );
+      ok = (fwrite( buffer_get_data( buffer ) , 1 , size , stream ) == size);
+      ok = (fclose( stream ) == 0) && ok;
+
+      if (ok)
+        ok = (rename( tmp_file , filename ) == 0);
+
+      if (!ok)
+        remove( tmp_file );
+    }
+  }
+
+  free( tmp_file );
+  buffer_free( buffer );
+  return ok;
+}
+
+
+/*
+  Checks that the events form a sequence which can be replayed: all
+  events are inside a PUSH / POP pair, the pairs are balanced and the
+  DEFINE and KEYWORD events have the right number of arguments.
+*/
+
+static bool config_cache_is_wellformed( const config_cache_type * cache ) {
+  int depth = 0;
+  for (int i = 0; i < vector_get_size( cache->nodes ); i++) {
+    const config_cache_node_type * node = vector_iget_const( cache->nodes , i );
+
+    if ((i > 0) && (depth == 0))
+      return false;
+
+    switch (node->event) {
+    case CONFIG_CACHE_PUSH:
+      if (node->file == NULL)
+        return false;
+      depth++;
+      break;
+    case CONFIG_CACHE_POP:
+      depth--;
+      break;
+    case CONFIG_CACHE_DEFINE:
+      if ((depth == 0) || (stringlist_get_size( node->args ) != 2))
+        return false;
+      break;
+    case CONFIG_CACHE_KEYWORD:
+      if ((depth == 0) || (stringlist_get_size( node->args ) < 1))
+        return false;
+      break;
+    default:
+      return false;
+    }
+  }
+  return (depth == 0);
+}
+
+
+/*
+  Returns NULL if the file does not exist, can not be read, is from a
+  different version, was written for a different key or is corrupt.
+*/
+
+config_cache_type * config_cache_fread_alloc( const char * filename , const char * key ) {
+  if (!util_file_readable( filename ))
+    return NULL;
+  {
+    buffer_type * buffer = buffer_fread_alloc( filename );
+    config_cache_type * cache = NULL;
+    bool ok = true;
+
+    if ((config_cache_buffer_fread_int( buffer , &ok ) == CONFIG_CACHE_MAGIC) &&
+        (config_cache_buffer_fread_int( buffer , &ok ) == CONFIG_CACHE_VERSION)) {
+      time_t write_time = 0;
+      char * stored_key;
+
+      config_cache_buffer_fread( buffer , &write_time , sizeof write_time , &ok );
+      stored_key = config_cache_buffer_fread_alloc_string( buffer , &ok );
+      if (ok && util_string_equal( stored_key , key )) {
+        cache = config_cache_alloc( key );
+        cache->write_time = write_time;
+        {
+          int num_files = config_cache_buffer_fread_int( buffer , &ok );
+          for (int i = 0; ok && (i < num_files); i++) {
+            config_cache_file_type * file = util_malloc( sizeof * file );
+            file->path = config_cache_buffer_fread_alloc_string( buffer , &ok );
+            config_cache_buffer_fread( buffer , &file->size , sizeof file->size , &ok );
+            config_cache_buffer_fread( buffer , &file->mtime , sizeof file->mtime , &ok );
+            config_cache_buffer_fread( buffer , &file->hash , sizeof file->hash , &ok );
+            if (file->path == NULL) {
+              ok = false;
+              free( file );
+            } else
+              vector_append_owned_ref( cache->files , file , config_cache_file_free__ );
+          }
+        }
+        {
+          int num_env = config_cache_buffer_fread_int( buffer , &ok );
+          for (int i = 0; ok && (i < num_env); i++) {
+            char * var = config_cache_buffer_fread_alloc_string( buffer , &ok );
+            char * value = config_cache_buffer_fread_alloc_string( buffer , &ok );
+            if (var)
+              config_cache_add_env( cache , var , value );
+            else
+              ok = false;
+            util_safe_free( var );
+            util_safe_free( value );
+          }
+        }
+        {
+          int num_nodes = config_cache_buffer_fread_int( buffer , &ok );
+          for (int i = 0; ok && (i < num_nodes); i++) {
+            config_cache_event_type event = config_cache_buffer_fread_int( buffer , &ok );
+            char * file = config_cache_buffer_fread_alloc_string( buffer , &ok );
+            int num_args = config_cache_buffer_fread_int( buffer , &ok );
+            config_cache_node_type * node = config_cache_append_node( cache , event , file );
+
+            for (int j = 0; ok && (j < num_args); j++) {
+              char * arg = config_cache_buffer_fread_alloc_string( buffer , &ok );
+              if (arg)
+                stringlist_append_owned_ref( node->args , arg );
+              else
+                ok = false;
+            }
+            util_safe_free( file );
+          }
+        }
+        if (!ok || !config_cache_is_wellformed( cache )) {
+          config_cache_free( cache );
+          cache = NULL;
+        }
+      }
+      util_safe_free( stored_key );
+    }
+    buffer_free( buffer );
+    return cache;
+  }
+}
@@ -40,6 +40,7 @@
 #include <ert/config/config_content_item.h>
 #include <ert/config/config_path_elm.h>
 #include <ert/config/config_root_path.h>
+#include <ert/config/config_cache.h>
 
 #define  CLEAR_STRING "__RESET__"
 
@@ -162,6 +163,11 @@ struct config_parser_struct {
   Returns a string with an error description, or NULL if the supplied
   arguments were OK. The string is allocated here, but is assumed that
   calling scope will free it.
+
+  When the tokens are replayed from a config_cache they have already
+  been substituted, and @substitute is false. When @cache is non NULL
+  the environment variables which are looked up are recorded in the
+  cache.
 */
 
 static config_content_node_type * config_content_item_set_arg__(subst_list_type * define_list ,
@@ -169,7 +175,9 @@ static config_content_node_type * config_content_item_set_arg__(subst_list_type
                                                                 config_content_item_type * item ,
                                                                 stringlist_type * token_list ,
                                                                 const config_path_elm_type * path_elm ,
-                                                                const char * config_file ) {
+                                                                const char * config_file ,
+                                                                bool substitute ,
+                                                                config_cache_type * cache) {
 
   config_content_node_type * new_node = NULL;
   int argc = stringlist_get_size( token_list ) - 1;
@@ -180,7 +188,7 @@ static config_content_node_type * config_content_item_set_arg__(subst_list_type
     const config_schema_item_type * schema_item = config_content_item_get_schema( item );
 
     /* Filtering based on DEFINE statements */
-    if (subst_list_get_size( define_list ) > 0) {
+    if (substitute && (subst_list_get_size( define_list ) > 0)) {
       int iarg;
       for (iarg = 0; iarg < argc; iarg++) {
         char * filtered_copy = subst_list_alloc_filtered_string( define_list , stringlist_iget(token_list , iarg + 1));
@@ -190,7 +198,7 @@ static config_content_node_type * config_content_item_set_arg__(subst_list_type
 
 
     /* Filtering based on environment variables */
-    if (config_schema_item_expand_envvar( schema_item )) {
+    if (substitute && config_schema_item_expand_envvar( schema_item )) {
       int iarg;
       for (iarg = 0; iarg < argc; iarg++) {
         int    env_offset = 0;
@@ -201,6 +209,9 @@ static config_content_node_type * config_content_item_set_arg__(subst_list_type
 
           {
             const char * env_value = getenv( &env_var[1] );
+            if (cache)
+              config_cache_add_env( cache , &env_var[1] , env_value );
+
             if (env_value != NULL) {
               char * new_value = util_string_replace_alloc( stringlist_iget( token_list , iarg + 1 ) , env_var , env_value );
               stringlist_iset_owned_ref( token_list , iarg + 1 , new_value );
@@ -442,13 +453,15 @@ static config_path_elm_type * config_relocate(const char * config_path,
 }
 
 
-bool config_parser_add_key_values(config_parser_type * config,
-                                  config_content_type * content,
-                                  const char * kw,
-                                  stringlist_type * values,
-                                  const config_path_elm_type * current_path_elm,
-                                  const char * config_filename,
-                                  config_schema_unrecognized_enum unrecognized)
+static bool config_parser_add_key_values__(config_parser_type * config,
+                                           config_content_type * content,
+                                           const char * kw,
+                                           stringlist_type * values,
+                                           const config_path_elm_type * current_path_elm,
+                                           const char * config_filename,
+                                           config_schema_unrecognized_enum unrecognized,
+                                           bool substitute,
+                                           config_cache_type * cache)
 {
   if (!config_has_schema_item(config, kw)) {
 
@@ -496,7 +509,9 @@ bool config_parser_add_key_values(config_parser_type * config,
                                                                       content_item,
                                                                       values,
                                                                       current_path_elm,
-                                                                      config_filename);
+                                                                      config_filename,
+                                                                      substitute,
+                                                                      cache);
 
   if(new_node)
     config_content_add_node(content, new_node);
@@ -505,6 +520,18 @@ bool config_parser_add_key_values(config_parser_type * config,
 }
 
 
+bool config_parser_add_key_values(config_parser_type * config,
+                                  config_content_type * content,
+                                  const char * kw,
+                                  stringlist_type * values,
+                                  const config_path_elm_type * current_path_elm,
+                                  const char * config_filename,
+                                  config_schema_unrecognized_enum unrecognized)
+{
+  return config_parser_add_key_values__(config, content, kw, values, current_path_elm, config_filename, unrecognized, true, NULL);
+}
+
+
 /**
    This function parses the config file 'filename', and updated the
    internal state of the config object as parsing proceeds. If
@@ -585,9 +612,14 @@ static void config_parse__(config_parser_type * config,
                            const char * include_kw,
                            const char * define_kw,
                            config_schema_unrecognized_enum unrecognized,
-                           bool validate)
+                           bool validate,
+                           config_cache_type * cache)
 {
   assert_no_circular_includes(content, config_filename);
+  if (cache) {
+    config_cache_add_file(cache, config_filename);
+    config_cache_push(cache, config_filename);
+  }
 
   // Relocate
   char * config_path;
@@ -636,7 +668,8 @@ static void config_parse__(config_parser_type * config,
                        include_kw,
                        define_kw,
                        unrecognized,
-                       false);
+                       false,
+                       cache);
       }
 
       // Add define
@@ -648,14 +681,19 @@ static void config_parse__(config_parser_type * config,
         char * value = stringlist_alloc_joined_substring(token_list, 2, active_tokens, " ");
 
         config_content_add_define(content, key, value);
+        if (cache)
+          config_cache_add_define(cache, key, value);
 
         free(key);
         free(value);
       }
 
       // Add keyword
-      else
-        config_parser_add_key_values(config, content, kw, token_list, current_path_elm, config_file, unrecognized);
+      else {
+        config_parser_add_key_values__(config, content, kw, token_list, current_path_elm, config_file, unrecognized, true, cache);
+        if (cache)
+          config_cache_add_keyword(cache, config_file, token_list);
+      }
     }
 
     stringlist_free(token_list);
@@ -671,9 +709,156 @@ static void config_parse__(config_parser_type * config,
   free(config_file);
   path_stack_pop(path_stack);
   config_content_pop_path_stack(content);
+  if (cache)
+    config_cache_pop(cache);
 }
 
 
+/*
+  Replays a recording made by config_parse__() into @content. The
+  relocation, the path elements and the validation are exactly as in
+  config_parse__(); the only difference is that the keyword lines
+  have already been tokenized and substituted.
+*/
+
+static void config_parse_cache__(config_parser_type * config,
+                                 config_content_type * content,
+                                 const config_cache_type * cache,
+                                 config_schema_unrecognized_enum unrecognized,
+                                 bool validate)
+{
+  path_stack_type * path_stack = path_stack_alloc();
+  vector_type * path_elm_stack = vector_alloc_new();
+
+  for (int i = 0; i < config_cache_get_size(cache); i++) {
+    const stringlist_type * args = config_cache_iget_args(cache, i);
+
+    switch (config_cache_iget_event(cache, i)) {
+    case CONFIG_CACHE_PUSH:
+      {
+        const char * config_filename = config_cache_iget_file(cache, i);
+        char * config_path;
+        char * config_file;
+
+        assert_no_circular_includes(content, config_filename);
+        alloc_config_filename_components(config_filename, &config_path, &config_file);
+        vector_append_ref(path_elm_stack, config_relocate(config_path, content, path_stack));
+
+        free(config_path);
+        free(config_file);
+      }
+      break;
+    case CONFIG_CACHE_POP:
+      if (validate && (vector_get_size(path_elm_stack) == 1))
+        config_validate(config, content);
+
+      vector_pop_back(path_elm_stack);
+      path_stack_pop(path_stack);
+      config_content_pop_path_stack(content);
+      break;
+    case CONFIG_CACHE_DEFINE:
+      config_content_add_define(content, stringlist_iget(args, 0), stringlist_iget(args, 1));
+      break;
+    case CONFIG_CACHE_KEYWORD:
+      {
+        stringlist_type * token_list = stringlist_alloc_deep_copy(args);
+        config_parser_add_key_values__(config,
+                                       content,
+                                       stringlist_iget(token_list, 0),
+                                       token_list,
+                                       vector_get_last_const(path_elm_stack),
+                                       config_cache_iget_file(cache, i),
+                                       unrecognized,
+                                       false,
+                                       NULL);
+        stringlist_free(token_list);
+      }
+      break;
+    }
+  }
+
+  vector_free(path_elm_stack);
+  path_stack_free(path_stack);
+}
+
+
+/*
+  The cache key must capture everything, apart from the content of
+  the files and the environment, which can influence the result of
+  config_parse(). The schema only enters through the set of keywords
+  and whether they are subject to environment variable expansion;
+  the remaining schema properties are used by the validation which is
+  always performed.
+*/
+
+static char * config_alloc_cache_key(const config_parser_type * config,
+                                     const char * filename,
+                                     const char * comment_string,
+                                     const char * include_kw,
+                                     const char * define_kw,
+                                     const hash_type * pre_defined_kw_map,
+                                     config_schema_unrecognized_enum unrecognized,
+                                     bool validate)
+{
+  stringlist_type * key_list = stringlist_alloc_new();
+  {
+    char * abs_filename = util_alloc_realpath(filename);
+    char * cwd = util_alloc_cwd();
+
+    stringlist_append_copy(key_list, abs_filename);
+    stringlist_append_copy(key_list, filename);
+    stringlist_append_copy(key_list, cwd);
+
+    free(abs_filename);
+    free(cwd);
+  }
+  stringlist_append_owned_ref(key_list, util_alloc_sprintf("COMMENT:%s", comment_string ? comment_string : "<NULL>"));
+  stringlist_append_owned_ref(key_list, util_alloc_sprintf("INCLUDE:%s", include_kw ? include_kw : "<NULL>"));
+  stringlist_append_owned_ref(key_list, util_alloc_sprintf("DEFINE:%s", define_kw ? define_kw : "<NULL>"));
+  stringlist_append_owned_ref(key_list, util_alloc_sprintf("UNRECOGNIZED:%d VALIDATE:%d", unrecognized, validate));
+
+  if (pre_defined_kw_map) {
+    stringlist_type * keys = hash_alloc_stringlist(pre_defined_kw_map);
+    stringlist_sort(keys, NULL);
+    for (int i = 0; i < stringlist_get_size(keys); i++) {
+      const char * key = stringlist_iget(keys, i);
+      stringlist_append_owned_ref(key_list, util_alloc_sprintf("PRE_DEFINED:%s=%s", key, (const char *) hash_get(pre_defined_kw_map, key)));
+    }
+    stringlist_free(keys);
+  }
+
+  {
+    stringlist_type * keys = hash_alloc_stringlist(config->schema_items);
+    stringlist_sort(keys, NULL);
+    for (int i = 0; i < stringlist_get_size(keys); i++) {
+      const char * kw = stringlist_iget(keys, i);
+      const config_schema_item_type * item = hash_get(config->schema_items, kw);
+      stringlist_append_owned_ref(key_list, util_alloc_sprintf("SCHEMA:%s=%s:%d",
+                                                               kw,
+                                                               config_schema_item_get_kw(item),
+                                                               config_schema_item_expand_envvar(item)));
+    }
+    stringlist_free(keys);
+  }
+
+  {
+    char * key = stringlist_alloc_joined_string(key_list, "\n");
+    stringlist_free(key_list);
+    return key;
+  }
+}
+
+
+/*
+  If the environment variable ERT_CONFIG_CACHE points to an existing
+  directory the result of the parsing is cached in that directory,
+  and later calls with the same arguments and unchanged input files
+  will replay the cached result instead of parsing the files; see
+  config_cache.c for details. This covers every caller of
+  config_parse(), including the job description files, but only the
+  parsing: the callers still build their objects from the content.
+*/
+
 config_content_type * config_parse(config_parser_type * config ,
                                    const char * filename,
                                    const char * comment_string ,
@@ -699,9 +884,42 @@ config_content_type * config_parse(config_parser_type * config ,
 
 
   if (util_file_readable( filename )) {
-    path_stack_type * path_stack = path_stack_alloc();
-    config_parse__(config , content , path_stack , filename , comment_string , include_kw , define_kw , unrecognized_behaviour , validate);
-    path_stack_free( path_stack );
+    const char * cache_path = getenv( CONFIG_CACHE_ENV );
+    config_cache_type * cache = NULL;
+    char * cache_file = NULL;
+    bool cache_hit = false;
+
+    if (cache_path && util_is_directory( cache_path )) {
+      char * key = config_alloc_cache_key( config , filename , comment_string , include_kw , define_kw , pre_defined_kw_map , unrecognized_behaviour , validate);
+      config_cache_type * stored_cache;
+
+      cache_file = config_cache_alloc_filename( cache_path , key );
+      stored_cache = config_cache_fread_alloc( cache_file , key );
+      if (stored_cache) {
+        if (config_cache_is_current( stored_cache )) {
+          config_parse_cache__( config , content , stored_cache , unrecognized_behaviour , validate );
+          cache_hit = true;
+        }
+        config_cache_free( stored_cache );
+      }
+
+      if (!cache_hit)
+        cache = config_cache_alloc( key );
+      free( key );
+    }
+
+    if (!cache_hit) {
+      path_stack_type * path_stack = path_stack_alloc();
+      config_parse__(config , content , path_stack , filename , comment_string , include_kw , define_kw , unrecognized_behaviour , validate , cache);
+      path_stack_free( path_stack );
+    }
+
+    if (cache) {
+      if (config_error_count( config_content_get_errors( content ) ) == 0)
+        config_cache_fwrite( cache , cache_file );
+      config_cache_free( cache );
+    }
+    util_safe_free( cache_file );
   } else {
     char * error_message = util_alloc_sprintf("Could not open file:%s for parsing" , filename);
     config_error_add( config_content_get_errors( content ) , error_message );
@@ -0,0 +1,200 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'config_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/config/config_parser.h>
+#include <ert/config/config_content.h>
+#include <ert/config/config_cache.h>
+#include <ert/config/config_schema_item.h>
+
+
+static void write_file( const char * filename , const char * content ) {
+  FILE * stream = util_mkdir_fopen( filename , "w" );
+  fprintf( stream , "%s" , content );
+  fclose( stream );
+}
+
+
+static config_parser_type * alloc_schema( ) {
+  config_parser_type * config = config_alloc( );
+  config_schema_item_type * item;
+
+  item = config_add_schema_item( config , "KEY" , true );
+  config_schema_item_set_argc_minmax( item , 1 , 1 );
+
+  item = config_add_schema_item( config , "FILE" , false );
+  config_schema_item_set_argc_minmax( item , 1 , 1 );
+  config_schema_item_iset_type( item , 0 , CONFIG_EXISTING_PATH );
+
+  item = config_add_schema_item( config , "ENV" , false );
+  config_schema_item_set_argc_minmax( item , 1 , 1 );
+  return config;
+}
+
+
+static config_content_type * parse( config_parser_type * config ) {
+  return config_parse( config , "config/main.txt" , "--" , "INCLUDE" , "DEFINE" , NULL , CONFIG_UNRECOGNIZED_ERROR , true );
+}
+
+
+static int num_cache_files( ) {
+  stringlist_type * files = stringlist_alloc_new( );
+  int num_files = stringlist_select_matching_files( files , "cache" , "*.cache" );
+  stringlist_free( files );
+  return num_files;
+}
+
+
+static void assert_content( const config_content_type * content , const char * key , const char * env ) {
+  test_assert_true( config_content_is_valid( content ));
+  test_assert_string_equal( key , config_content_get_value( content , "KEY" ));
+  test_assert_string_equal( env , config_content_get_value( content , "ENV" ));
+  {
+    char * abs_path = util_alloc_abs_path( "config/include/data.txt" );
+    test_assert_string_equal( abs_path , config_content_get_value_as_abspath( content , "FILE" ));
+    free( abs_path );
+  }
+}
+
+
+void test_cache( ) {
+  test_work_area_type * work_area = test_work_area_alloc( "config_cache" );
+  config_parser_type * config = alloc_schema( );
+
+  util_make_path( "cache" );
+  setenv( CONFIG_CACHE_ENV , "cache" , 1 );
+  setenv( "CONFIG_CACHE_TEST_VAR" , "env_value" , 1 );
+
+  write_file( "config/main.txt" , "DEFINE <VALUE> 100\nINCLUDE include/include.txt\nENV $CONFIG_CACHE_TEST_VAR\n" );
+  write_file( "config/include/include.txt" , "KEY <VALUE>  -- Comment\nFILE data.txt\n");
+  write_file( "config/include/data.txt" , "Data\n");
+
+  {
+    config_content_type * content = parse( config );
+    assert_content( content , "100" , "env_value" );
+    config_content_free( content );
+    test_assert_int_equal( 1 , num_cache_files( ));
+  }
+
+  /* Parsed from the cache. */
+  {
+    config_content_type * content = parse( config );
+    assert_content( content , "100" , "env_value" );
+    test_assert_int_equal( 1 , config_content_get_occurences( content , "KEY" ));
+    config_content_free( content );
+  }
+
+  /* Modified include file. */
+  write_file( "config/include/include.txt" , "KEY <VALUE>  -- Commen!\nFILE data.txt\nKEY 200\n");
+  {
+    config_content_type * content = parse( config );
+    assert_content( content , "200" , "env_value" );
+    config_content_free( content );
+  }
+
+  /* Modified environment variable. */
+  setenv( "CONFIG_CACHE_TEST_VAR" , "new_value" , 1 );
+  {
+    config_content_type * content = parse( config );
+    assert_content( content , "200" , "new_value" );
+    config_content_free( content );
+  }
+
+  /* The validation is still performed when parsing from the cache. */
+  remove( "config/include/data.txt" );
+  {
+    config_content_type * content = parse( config );
+    test_assert_false( config_content_is_valid( content ));
+    config_content_free( content );
+  }
+
+  /* A corrupt cache file is ignored. */
+  write_file( "config/include/data.txt" , "Data\n");
+  {
+    stringlist_type * files = stringlist_alloc_new( );
+    stringlist_select_matching_files( files , "cache" , "*.cache" );
+    for (int i = 0; i < stringlist_get_size( files ); i++)
+      write_file( stringlist_iget( files , i ) , "Garbage");
+    stringlist_free( files );
+  }
+  {
+    config_content_type * content = parse( config );
+    assert_content( content , "200" , "new_value" );
+    config_content_free( content );
+  }
+
+  unsetenv( CONFIG_CACHE_ENV );
+  config_free( config );
+  test_work_area_free( work_area );
+}
+
+
+void test_cache_file( ) {
+  test_work_area_type * work_area = test_work_area_alloc( "config_cache_file" );
+  config_cache_type * cache = config_cache_alloc( "KEY" );
+  write_file( "file.txt" , "Content\n");
+
+  config_cache_add_file( cache , "file.txt" );
+  config_cache_add_env( cache , "CONFIG_CACHE_UNSET_VAR" , NULL );
+  config_cache_push( cache , "file.txt" );
+  config_cache_add_define( cache , "<KEY>" , "VALUE" );
+  {
+    stringlist_type * tokens = stringlist_alloc_new( );
+    stringlist_append_copy( tokens , "KW" );
+    stringlist_append_copy( tokens , "ARG" );
+    config_cache_add_keyword( cache , "file.txt" , tokens );
+    stringlist_free( tokens );
+  }
+  config_cache_pop( cache );
+  test_assert_true( config_cache_fwrite( cache , "file.cache" ));
+  config_cache_free( cache );
+
+  test_assert_NULL( config_cache_fread_alloc( "file.cache" , "OTHER_KEY" ));
+  test_assert_NULL( config_cache_fread_alloc( "does/not/exist" , "KEY" ));
+
+  cache = config_cache_fread_alloc( "file.cache" , "KEY" );
+  test_assert_true( config_cache_is_instance( cache ));
+  test_assert_true( config_cache_is_current( cache ));
+  test_assert_int_equal( 1 , config_cache_get_num_files( cache ));
+  test_assert_int_equal( 4 , config_cache_get_size( cache ));
+  test_assert_int_equal( CONFIG_CACHE_KEYWORD , config_cache_iget_event( cache , 2 ));
+  test_assert_string_equal( "ARG" , stringlist_iget( config_cache_iget_args( cache , 2 ) , 1 ));
+
+  setenv( "CONFIG_CACHE_UNSET_VAR" , "value" , 1 );
+  test_assert_false( config_cache_is_current( cache ));
+  unsetenv( "CONFIG_CACHE_UNSET_VAR" );
+
+  remove( "file.txt" );
+  test_assert_false( config_cache_is_current( cache ));
+  config_cache_free( cache );
+
+  test_work_area_free( work_area );
+}
+
+
+int main( int argc , char ** argv) {
+  test_cache_file( );
+  test_cache( );
+  exit(0);
+}
@@ -42,6 +42,10 @@
 
 #define UPDATE_OVERLAP_KEY      "OVERLAP_LIMIT"
 #define UPDATE_STD_CUTOFF_KEY   "STD_CUTOFF"
+#define UPDATE_MINISTEP_THREADS_KEY "MINISTEP_THREADS"
+#define UPDATE_LOCALIZATION_RADIUS_KEY "LOCALIZATION_RADIUS"
+#define UPDATE_LOCALIZATION_TILE_SIZE_KEY "LOCALIZATION_TILE_SIZE"
+#define UPDATE_PROFILE_KEY      "PROFILE"
 
 
 #define ANALYSIS_CONFIG_TYPE_ID 64431306
@@ -222,6 +226,47 @@ double analysis_config_get_std_cutoff(const analysis_config_type * config) {
   return config_settings_get_double_value(config->update_settings, UPDATE_STD_CUTOFF_KEY);
 }
 
+void analysis_config_set_ministep_threads( analysis_config_type * config , int ministep_threads ) {
+  config_settings_set_int_value(config->update_settings, UPDATE_MINISTEP_THREADS_KEY, ministep_threads );
+}
+
+int analysis_config_get_ministep_threads(const analysis_config_type * config) {
+  return config_settings_get_int_value(config->update_settings, UPDATE_MINISTEP_THREADS_KEY);
+}
+
+void analysis_config_set_localization_radius( analysis_config_type * config , double radius ) {
+  config_settings_set_double_value(config->update_settings, UPDATE_LOCALIZATION_RADIUS_KEY, radius );
+}
+
+/*
+  A localization radius <= 0 means that the automatic distance based
+  localization is not used.
+*/
+double analysis_config_get_localization_radius(const analysis_config_type * config) {
+  return config_settings_get_double_value(config->update_settings, UPDATE_LOCALIZATION_RADIUS_KEY);
+}
+
+void analysis_config_set_localization_tile_size( analysis_config_type * config , int tile_size ) {
+  config_settings_set_int_value(config->update_settings, UPDATE_LOCALIZATION_TILE_SIZE_KEY, tile_size );
+}
+
+int analysis_config_get_localization_tile_size(const analysis_config_type * config) {
+  return config_settings_get_int_value(config->update_settings, UPDATE_LOCALIZATION_TILE_SIZE_KEY);
+}
+
+void analysis_config_set_update_profile( analysis_config_type * config , bool update_profile ) {
+  config_settings_set_bool_value(config->update_settings, UPDATE_PROFILE_KEY, update_profile );
+}
+
+/*
+  When the update profile is enabled a json report with the timing of
+  the different phases of the update is written to the update log
+  directory.
+*/
+bool analysis_config_get_update_profile(const analysis_config_type * config) {
+  return config_settings_get_bool_value(config->update_settings, UPDATE_PROFILE_KEY);
+}
+
 
 void analysis_config_set_log_path(analysis_config_type * config , const char * log_path ) {
   config->log_path        = util_realloc_string_copy(config->log_path , log_path);
@@ -599,6 +644,10 @@ analysis_config_type * analysis_config_alloc_default(void) {
   config->update_settings           = config_settings_alloc( UPDATE_SETTING_KEY );
   config_settings_add_double_setting(config->update_settings, UPDATE_OVERLAP_KEY , DEFAULT_ENKF_ALPHA);
   config_settings_add_double_setting(config->update_settings, UPDATE_STD_CUTOFF_KEY, DEFAULT_ENKF_STD_CUTOFF );
+  config_settings_add_int_setting(config->update_settings, UPDATE_MINISTEP_THREADS_KEY, DEFAULT_MINISTEP_THREADS );
+  config_settings_add_double_setting(config->update_settings, UPDATE_LOCALIZATION_RADIUS_KEY, DEFAULT_LOCALIZATION_RADIUS );
+  config_settings_add_int_setting(config->update_settings, UPDATE_LOCALIZATION_TILE_SIZE_KEY, DEFAULT_LOCALIZATION_TILE_SIZE );
+  config_settings_add_bool_setting(config->update_settings, UPDATE_PROFILE_KEY, DEFAULT_UPDATE_PROFILE );
 
   analysis_config_set_merge_observations( config       , DEFAULT_MERGE_OBSERVATIONS );
   analysis_config_set_rerun( config                    , DEFAULT_RERUN );
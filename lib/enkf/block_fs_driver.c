@@ -19,10 +19,12 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #include <ert/util/util.h>
 #include <ert/util/buffer.h>
 #include <ert/util/timer.h>
+#include <ert/util/arg_pack.h>
 
 #include <ert/res_util/block_fs.h>
 #include <ert/res_util/path_fmt.h>
@@ -39,12 +41,16 @@ typedef struct bfs_config_struct bfs_config_type;
 
 struct bfs_config_struct {
   int             fsync_interval;
+  size_t          fsync_bytes;
+  double          fsync_seconds;
   double          fragmentation_limit;
   bool            read_only;
   bool            preload;
+  bool            lazy;       /* Mount the block_fs instances on first access. */
   int             block_size;
   int             max_cache_size;
   bool            bfs_lock;
+  block_fs_codec_type codec;
 };
 
 
@@ -56,6 +62,8 @@ struct bfs_struct  {
   /* New variables */
   block_fs_type * block_fs;
   char          * mountfile;  // The full path to the file mounted by the block_fs layer - including extension.
+  bool            mounted;    // For lazy mounts; block_fs can still be NULL for a read only mount of a shard which does not exist.
+  pthread_mutex_t mount_lock;
 
   const bfs_config_type * config;
 };
@@ -67,6 +75,7 @@ struct block_fs_driver_struct {
   int                __id;
   int                num_fs;
   bfs_config_type  * config;
+  char             * mountfile_fmt;  // The mountfile format relative to the mount point, as stored in the fstab file.
 
   // New variables
   bfs_type        ** fs_list;
@@ -74,7 +83,7 @@ struct block_fs_driver_struct {
 
 /*****************************************************************/
 
-bfs_config_type * bfs_config_alloc( fs_driver_enum driver_type , bool read_only, bool bfs_lock) {
+bfs_config_type * bfs_config_alloc( fs_driver_enum driver_type , bool read_only, bool bfs_lock, bool lazy) {
   const int PARAMETER_blocksize    = 64;
   const int DYNAMIC_blocksize      = 64;
   const int DEFAULT_blocksize      = 64;
@@ -85,15 +94,21 @@ bfs_config_type * bfs_config_alloc( fs_driver_enum driver_type , bool read_only,
 
   const int max_cache_size         = 512;
   const int fsync_interval         =  10;     /* An fsync() call is issued for every 10'th write. */
+  const size_t fsync_bytes         =   0;     /* Group commit by written bytes - see block_fs_set_fsync_policy(). */
+  const double fsync_seconds       =   0;     /* Group commit by time since the last fsync(). */
   const double fragmentation_limit = 1.0;     /* 1.0 => NO defrag is run. */
 
   {
     bfs_config_type * config = util_malloc( sizeof * config );
     config->max_cache_size      = max_cache_size;
     config->fsync_interval      = fsync_interval;
+    config->fsync_bytes         = fsync_bytes;
+    config->fsync_seconds       = fsync_seconds;
     config->fragmentation_limit = fragmentation_limit;
     config->read_only           = read_only;
     config->bfs_lock            = bfs_lock;
+    config->lazy                = lazy;
+    config->codec               = BLOCK_FS_CODEC_NONE;   /* Set with block_fs_driver_set_codec(). */
 
     switch (driver_type) {
     case( DRIVER_PARAMETER ):
@@ -108,6 +123,15 @@ bfs_config_type * bfs_config_alloc( fs_driver_enum driver_type , bool read_only,
       config->block_size = DEFAULT_blocksize;
       config->preload = DEFAULT_preload;
     }
+
+    /*
+      With lazy mounting the shards are mounted when a realization is
+      accessed, preloading the complete data file at that point would
+      defeat the purpose.
+    */
+    if (lazy)
+      config->preload = false;
+
     return config;
   }
 }
@@ -123,6 +147,7 @@ static UTIL_SAFE_CAST_FUNCTION(bfs , BFS_TYPE_ID);
 static void bfs_close( bfs_type * bfs ) {
   if (bfs->block_fs != NULL)
     block_fs_close( bfs->block_fs , false);
+  pthread_mutex_destroy( &bfs->mount_lock );
   free( bfs->mountfile );
   free( bfs );
 }
@@ -142,6 +167,9 @@ static bfs_type * bfs_alloc( const bfs_config_type * config ) {
 
   // New init
   fs->mountfile = NULL;
+  fs->block_fs  = NULL;
+  fs->mounted   = false;
+  pthread_mutex_init( &fs->mount_lock , NULL );
 
   return fs;
 }
@@ -157,6 +185,16 @@ static bfs_type * bfs_alloc_new( const bfs_config_type * config , char * mountfi
 
 static void bfs_mount( bfs_type * bfs) {
   const bfs_config_type * config = bfs->config;
+
+  /*
+    A lazy read only mount should not create anything on disk; if the
+    shard has never been written to it is just left as NULL, and
+    treated as empty.
+  */
+  bfs->mounted = true;
+  if (config->lazy && config->read_only && !util_file_exists( bfs->mountfile ))
+    return;
+
   bfs->block_fs = block_fs_mount( bfs->mountfile ,
                                   config->block_size ,
                                   config->max_cache_size ,
@@ -165,6 +203,8 @@ static void bfs_mount( bfs_type * bfs) {
                                   config->preload ,
                                   config->read_only,
                                   config->bfs_lock);
+  block_fs_set_codec( bfs->block_fs , config->codec );
+  block_fs_set_fsync_policy( bfs->block_fs , config->fsync_interval , config->fsync_bytes , config->fsync_seconds );
 }
 
 
@@ -179,8 +219,45 @@ static void * bfs_mount__( void * arg ) {
 
 
 
+/*
+  Will mount the block_fs instance if that has not already been done;
+  the return value can be NULL for a lazy read only mount, see
+  bfs_mount().
+*/
+
+static block_fs_type * bfs_get_block_fs( bfs_type * bfs ) {
+  block_fs_type * block_fs;
+
+  pthread_mutex_lock( &bfs->mount_lock );
+  if (!bfs->mounted)
+    bfs_mount( bfs );
+  block_fs = bfs->block_fs;
+  pthread_mutex_unlock( &bfs->mount_lock );
+
+  return block_fs;
+}
+
+
 static void bfs_fsync( bfs_type * bfs ) {
-  block_fs_fsync( bfs->block_fs );
+  pthread_mutex_lock( &bfs->mount_lock );
+  if (bfs->block_fs != NULL)
+    block_fs_fsync( bfs->block_fs );
+  pthread_mutex_unlock( &bfs->mount_lock );
+}
+
+
+static void * bfs_clone__( void * arg ) {
+  arg_pack_type * arg_pack  = arg_pack_safe_cast( arg );
+  bfs_type * bfs            = bfs_safe_cast( arg_pack_iget_ptr( arg_pack , 0 ));
+  const char * target_file  = arg_pack_iget_const_ptr( arg_pack , 1 );
+  bool * clone_ok           = arg_pack_iget_ptr( arg_pack , 2 );
+  block_fs_type * block_fs  = bfs_get_block_fs( bfs );
+
+  if (block_fs == NULL)
+    *clone_ok = true;   /* Empty shard of a read only case - nothing to clone. */
+  else
+    *clone_ok = block_fs_clone( block_fs , target_file );
+  return NULL;
 }
 
 
@@ -256,14 +333,33 @@ static bfs_type * block_fs_driver_get_fs( block_fs_driver_type * driver , int ie
 }
 
 
+/*
+  Returns the block_fs instance holding realization @iens, mounting it
+  first if the driver was opened lazily. Will return NULL for a shard
+  which does not exist in a lazy read only mount.
+*/
+
+static block_fs_type * block_fs_driver_get_block_fs( block_fs_driver_type * driver , int iens ) {
+  return bfs_get_block_fs( block_fs_driver_get_fs( driver , iens ));
+}
+
+
+static block_fs_type * block_fs_driver_get_existing_block_fs( block_fs_driver_type * driver , int iens ) {
+  block_fs_type * block_fs = block_fs_driver_get_block_fs( driver , iens );
+  if (block_fs == NULL)
+    util_abort("%s: no data stored for realization:%d in read only case \n",__func__ , iens);
+  return block_fs;
+}
+
+
 
 static void block_fs_driver_load_node(void * _driver , const char * node_key , int report_step , int iens ,  buffer_type * buffer) {
   block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
   {
     char * key          = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
-    bfs_type      * bfs = block_fs_driver_get_fs( driver , iens );
+    block_fs_type * block_fs = block_fs_driver_get_existing_block_fs( driver , iens );
 
-    block_fs_fread_realloc_buffer( bfs->block_fs , key , buffer);
+    block_fs_fread_realloc_buffer( block_fs , key , buffer);
 
     free( key );
   }
@@ -274,9 +370,9 @@ static void block_fs_driver_load_vector(void * _driver , const char * node_key ,
   block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
   {
     char * key          = block_fs_driver_alloc_vector_key( driver , node_key , iens );
-    bfs_type      * bfs = block_fs_driver_get_fs( driver , iens );
+    block_fs_type * block_fs = block_fs_driver_get_existing_block_fs( driver , iens );
 
-    block_fs_fread_realloc_buffer( bfs->block_fs , key , buffer);
+    block_fs_fread_realloc_buffer( block_fs , key , buffer);
     free( key );
   }
 }
@@ -288,8 +384,8 @@ static void block_fs_driver_save_node(void * _driver , const char * node_key , i
   block_fs_driver_assert_cast(driver);
   {
     char * key     = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
-    bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_fwrite_buffer( bfs->block_fs , key , buffer);
+    block_fs_type * block_fs = block_fs_driver_get_existing_block_fs( driver , iens );
+    block_fs_fwrite_buffer( block_fs , key , buffer);
     free( key );
   }
 }
@@ -300,12 +396,33 @@ static void block_fs_driver_save_vector(void * _driver , const char * node_key ,
   block_fs_driver_assert_cast(driver);
   {
     char * key     = block_fs_driver_alloc_vector_key( driver , node_key , iens );
-    bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_fwrite_buffer( bfs->block_fs , key , buffer);
+    block_fs_type * block_fs = block_fs_driver_get_existing_block_fs( driver , iens );
+    block_fs_fwrite_buffer( block_fs , key , buffer);
     free( key );
   }
 }
 
+/*
+  Saves the vectors of all the keys in @node_keys for realization
+  @iens with one batch write; all the vectors of one realization live
+  in the same block_fs instance.
+*/
+
+static void block_fs_driver_save_vectors(void * _driver , const stringlist_type * node_keys , int iens , const vector_type * buffers) {
+  block_fs_driver_type * driver = (block_fs_driver_type *) _driver;
+  block_fs_driver_assert_cast(driver);
+  {
+    stringlist_type * keys = stringlist_alloc_new();
+    block_fs_type * block_fs = block_fs_driver_get_existing_block_fs( driver , iens );
+
+    for (int i = 0; i < stringlist_get_size( node_keys ); i++)
+      stringlist_append_owned_ref( keys , block_fs_driver_alloc_vector_key( driver , stringlist_iget( node_keys , i ) , iens ));
+
+    block_fs_fwrite_batch( block_fs , keys , buffers );
+    stringlist_free( keys );
+  }
+}
+
 /*****************************************************************/
 
 void block_fs_driver_unlink_node(void * _driver , const char * node_key , int report_step , int iens ) {
@@ -313,8 +430,9 @@ void block_fs_driver_unlink_node(void * _driver , const char * node_key , int re
   block_fs_driver_assert_cast(driver);
   {
     char * key     = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
-    bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_unlink_file( bfs->block_fs , key );
+    block_fs_type * block_fs = block_fs_driver_get_block_fs( driver , iens );
+    if (block_fs != NULL)
+      block_fs_unlink_file( block_fs , key );
     free( key );
   }
 }
@@ -324,8 +442,9 @@ void block_fs_driver_unlink_vector(void * _driver , const char * node_key , int
   block_fs_driver_assert_cast(driver);
   {
     char * key     = block_fs_driver_alloc_vector_key( driver , node_key , iens );
-    bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_unlink_file( bfs->block_fs , key );
+    block_fs_type * block_fs = block_fs_driver_get_block_fs( driver , iens );
+    if (block_fs != NULL)
+      block_fs_unlink_file( block_fs , key );
     free( key );
   }
 }
@@ -338,8 +457,8 @@ bool block_fs_driver_has_node(void * _driver , const char * node_key , int repor
   block_fs_driver_assert_cast(driver);
   {
     char * key      = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
-    bfs_type  * bfs = block_fs_driver_get_fs( driver , iens );
-    bool has_node   = block_fs_has_file( bfs->block_fs , key );
+    block_fs_type * block_fs = block_fs_driver_get_block_fs( driver , iens );
+    bool has_node   = (block_fs != NULL) && block_fs_has_file( block_fs , key );
     free( key );
     return has_node;
   }
@@ -351,8 +470,8 @@ bool block_fs_driver_has_vector(void * _driver , const char * node_key , int ien
   block_fs_driver_assert_cast(driver);
   {
     char * key      = block_fs_driver_alloc_vector_key( driver , node_key , iens );
-    bfs_type  * bfs = block_fs_driver_get_fs( driver , iens );
-    bool has_node   = block_fs_has_file( bfs->block_fs , key );
+    block_fs_type * block_fs = block_fs_driver_get_block_fs( driver , iens );
+    bool has_node   = (block_fs != NULL) && block_fs_has_file( block_fs , key );
     free( key );
     return has_node;
   }
@@ -380,6 +499,7 @@ void block_fs_driver_free(void *_driver) {
     thread_pool_free( tp );
   }
   bfs_config_free( driver->config );
+  free( driver->mountfile_fmt );
   free( driver->fs_list );
   free(driver);
 }
@@ -414,11 +534,13 @@ static block_fs_driver_type * block_fs_driver_alloc(int num_fs) {
   driver->save_vector   = block_fs_driver_save_vector;
   driver->unlink_vector = block_fs_driver_unlink_vector;
   driver->has_vector    = block_fs_driver_has_vector;
+  driver->save_vectors  = block_fs_driver_save_vectors;
 
   driver->free_driver   = block_fs_driver_free;
   driver->fsync_driver  = block_fs_driver_fsync;
   driver->__id          = BLOCK_FS_DRIVER_ID;
   driver->num_fs        = num_fs;
+  driver->mountfile_fmt = NULL;
 
   driver->fs_list       = util_calloc( driver->num_fs , sizeof * driver->fs_list );
   return driver;
@@ -427,9 +549,9 @@ static block_fs_driver_type * block_fs_driver_alloc(int num_fs) {
 
 
 
-static void * block_fs_driver_alloc_new( fs_driver_enum driver_type , bool read_only , int num_fs , const char * mountfile_fmt, bool block_level_lock ) {
+static void * block_fs_driver_alloc_new( fs_driver_enum driver_type , bool read_only , int num_fs , const char * mountfile_fmt, bool block_level_lock , bool lazy) {
   block_fs_driver_type * driver = block_fs_driver_alloc( num_fs);
-  driver->config = bfs_config_alloc( driver_type , read_only, block_level_lock );
+  driver->config = bfs_config_alloc( driver_type , read_only, block_level_lock , lazy );
   {
     for (int ifs = 0; ifs < driver->num_fs; ifs++)
       driver->fs_list[ifs] = bfs_alloc_new( driver->config , util_alloc_sprintf( mountfile_fmt , ifs) );
@@ -449,8 +571,68 @@ static void block_fs_driver_mount( block_fs_driver_type * driver ) {
 }
 
 
+/*
+  The number of block_fs instances which have actually been mounted;
+  with a lazy mount this is the number of shards which have been
+  accessed.
+*/
+
+int block_fs_driver_get_num_mounted( void * _driver ) {
+  block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
+  int num_mounted = 0;
+
+  for (int ifs = 0; ifs < driver->num_fs; ifs++) {
+    bfs_type * bfs = driver->fs_list[ifs];
+    pthread_mutex_lock( &bfs->mount_lock );
+    if (bfs->mounted)
+      num_mounted++;
+    pthread_mutex_unlock( &bfs->mount_lock );
+  }
+  return num_mounted;
+}
+
+
+/*
+  Sets the group commit fsync policy, see block_fs_set_fsync_policy(),
+  for the shards which are already mounted and for the shards which
+  are mounted later.
+*/
+
+void block_fs_driver_set_fsync_policy( void * _driver , int fsync_interval , size_t fsync_bytes , double fsync_seconds ) {
+  block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
+
+  driver->config->fsync_interval = fsync_interval;
+  driver->config->fsync_bytes    = fsync_bytes;
+  driver->config->fsync_seconds  = fsync_seconds;
+
+  for (int ifs = 0; ifs < driver->num_fs; ifs++) {
+    bfs_type * bfs = driver->fs_list[ifs];
+    pthread_mutex_lock( &bfs->mount_lock );
+    if (bfs->block_fs != NULL)
+      block_fs_set_fsync_policy( bfs->block_fs , fsync_interval , fsync_bytes , fsync_seconds );
+    pthread_mutex_unlock( &bfs->mount_lock );
+  }
+}
 
 
+/*
+  Sets the codec used for the nodes written from now on; the nodes
+  already stored keep the codec they were written with.
+*/
+
+void block_fs_driver_set_codec( void * _driver , block_fs_codec_type codec ) {
+  block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
+
+  driver->config->codec = codec;
+  for (int ifs = 0; ifs < driver->num_fs; ifs++) {
+    bfs_type * bfs = driver->fs_list[ifs];
+    pthread_mutex_lock( &bfs->mount_lock );
+    if (bfs->block_fs != NULL)
+      block_fs_set_codec( bfs->block_fs , codec );
+    pthread_mutex_unlock( &bfs->mount_lock );
+  }
+}
+
 
 /*****************************************************************/
 
@@ -485,24 +667,74 @@ void block_fs_driver_create_fs( FILE * stream ,
 /*
   @path should contain both elements called root_path and case_path in
   the block_fs_driver_create() function.
+
+  If @lazy is true none of the block_fs instances are mounted here;
+  each instance is mounted the first time a realization it holds is
+  accessed.
 */
 
-void * block_fs_driver_open(FILE * fstab_stream , const char * mount_point , fs_driver_enum driver_type , bool read_only) {
+void * block_fs_driver_open(FILE * fstab_stream , const char * mount_point , fs_driver_enum driver_type , bool read_only , bool lazy) {
   int num_fs                  = util_fread_int( fstab_stream );
   char * tmp_fmt              = util_fread_alloc_string( fstab_stream );
   char * mountfile_fmt        = util_alloc_sprintf("%s%c%s" , mount_point , UTIL_PATH_SEP_CHAR , tmp_fmt );
   const bool block_level_lock = false;
 
-  block_fs_driver_type * driver = block_fs_driver_alloc_new( driver_type , read_only , num_fs , mountfile_fmt, block_level_lock );
+  block_fs_driver_type * driver = block_fs_driver_alloc_new( driver_type , read_only , num_fs , mountfile_fmt, block_level_lock , lazy );
 
-  block_fs_driver_mount( driver );
+  if (!lazy)
+    block_fs_driver_mount( driver );
+  driver->mountfile_fmt = tmp_fmt;
 
-  free( tmp_fmt );
   free( mountfile_fmt );
   return driver;
 }
 
 
+/**
+   Will clone all the block_fs instances of this driver into the same
+   relative location below @target_mount_point, using
+   block_fs_clone(). The directory structure is created as needed, but
+   the fstab file of the target must be written by the calling scope.
+*/
+
+bool block_fs_driver_clone( void * _driver , const char * target_mount_point ) {
+  block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
+  bool clone_ok = true;
+  {
+    char * target_fmt          = util_alloc_sprintf("%s%c%s" , target_mount_point , UTIL_PATH_SEP_CHAR , driver->mountfile_fmt );
+    bool * clone_status        = util_calloc( driver->num_fs , sizeof * clone_status );
+    arg_pack_type ** arg_list  = util_calloc( driver->num_fs , sizeof * arg_list );
+    thread_pool_type * tp      = thread_pool_alloc( 4 , true );
+
+    for (int ifs = 0; ifs < driver->num_fs; ifs++) {
+      char * target_file = util_alloc_sprintf( target_fmt , ifs );
+      char * target_path = util_split_alloc_dirname( target_file );
+
+      util_make_path( target_path );
+      arg_list[ifs] = arg_pack_alloc( );
+      arg_pack_append_ptr( arg_list[ifs] , driver->fs_list[ifs] );
+      arg_pack_append_owned_ptr( arg_list[ifs] , target_file , free );
+      arg_pack_append_ptr( arg_list[ifs] , &clone_status[ifs] );
+      thread_pool_add_job( tp , bfs_clone__ , arg_list[ifs] );
+
+      free( target_path );
+    }
+    thread_pool_join( tp );
+    thread_pool_free( tp );
+
+    for (int ifs = 0; ifs < driver->num_fs; ifs++) {
+      clone_ok = clone_ok && clone_status[ifs];
+      arg_pack_free( arg_list[ifs] );
+    }
+
+    free( arg_list );
+    free( clone_status );
+    free( target_fmt );
+  }
+  return clone_ok;
+}
+
+
 void block_fs_driver_fskip(FILE * fstab_stream) {
   util_fskip_int( fstab_stream );
   {
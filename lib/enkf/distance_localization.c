@@ -0,0 +1,522 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'distance_localization.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/double_vector.h>
+#include <ert/util/bool_vector.h>
+#include <ert/util/arg_pack.h>
+
+#include <ert/res_util/thread_pool.h>
+#include <ert/res_util/matrix.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#include <ert/analysis/obs_covar.h>
+#include <ert/analysis/analysis_module.h>
+
+#include <ert/enkf/enkf_obs.h>
+#include <ert/enkf/obs_data.h>
+#include <ert/enkf/obs_vector.h>
+#include <ert/enkf/block_obs.h>
+#include <ert/enkf/active_list.h>
+#include <ert/enkf/distance_localization.h>
+
+/**
+   The distance_localization implements automatic distance based
+   localization of the update of FIELD parameters. Every observation
+   with a position gets a weight rho given by the Gaspari-Cohn
+   function of the distance between the observation and the grid
+   cell; observations further away than the localization radius are
+   not used at all. The localization is applied by inflating the
+   observation error variance with 1/rho, i.e. each cell is updated
+   with an X matrix computed from only the nearby observations. The
+   observation perturbations in E are scaled with 1/sqrt(rho) as well,
+   and D is recomputed from the scaled E, so the modules which use the
+   ensemble perturbations instead of R (e.g. std_enkf with USE_EE) are
+   localized in the same way.
+
+   Calculating one X matrix per cell would be far too expensive for
+   large grids; the cells are therefor grouped in tiles of
+   tile_size x tile_size x tile_size cells, and all the cells in one
+   tile share the observation subset, the weights - evaluated at the
+   centre of the tile - and the X matrix.
+
+   Observations without a position, i.e. everything except the
+   BLOCK_OBS observations, are added with weight 1 to all the tiles.
+*/
+
+#define DISTANCE_LOCALIZATION_TYPE_ID  661873
+
+struct distance_localization_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  double               radius;      /* The taper is zero beyond this distance. */
+  int                  tile_size;
+  double_vector_type * obs_x;
+  double_vector_type * obs_y;
+  double_vector_type * obs_z;
+  bool_vector_type   * obs_global;  /* Observations without a position. */
+};
+
+
+/*
+  The tiles of one field: the rows of tile t are tile_rows[tile_offset[t]
+  : tile_offset[t+1]], and the centre of the tile is (tile_x[t], tile_y[t],
+  tile_z[t]).
+*/
+
+typedef struct {
+  const distance_localization_type * localization;
+  int                    num_tiles;
+  int                  * tile_offset;
+  int                  * tile_rows;
+  double               * tile_x;
+  double               * tile_y;
+  double               * tile_z;
+  matrix_type          * A;
+  int                    row_offset;
+  analysis_module_type * module;
+  const matrix_type    * S;
+  const obs_covar_type * R;
+  const matrix_type    * dObs;
+  const matrix_type    * E;
+  const matrix_type    * D;
+  rng_type             * rng;
+} tile_update_info_type;
+
+
+UTIL_IS_INSTANCE_FUNCTION( distance_localization , DISTANCE_LOCALIZATION_TYPE_ID )
+
+
+/**
+   The Gaspari-Cohn fifth order piecewise rational function; eq. (4.10)
+   in Gaspari and Cohn (1999) with half width c = radius / 2. The
+   function is 1 for distance == 0, and 0 for distance >= radius.
+*/
+
+double distance_localization_gaspari_cohn( double distance , double radius ) {
+  double z = 2 * fabs( distance ) / radius;
+
+  if (z <= 1)
+    return 1 + z*z*(-5.0/3 + z*(5.0/8 + z*(1.0/2 - z/4)));
+  else if (z < 2)
+    return 4 + z*(-5 + z*(5.0/3 + z*(5.0/8 + z*(-1.0/2 + z/12)))) - 2.0 / (3*z);
+  else
+    return 0;
+}
+
+
+distance_localization_type * distance_localization_alloc( double radius , int tile_size ) {
+  distance_localization_type * localization = util_malloc( sizeof * localization );
+  UTIL_TYPE_ID_INIT( localization , DISTANCE_LOCALIZATION_TYPE_ID );
+
+  if (radius <= 0)
+    util_abort("%s: the localization radius must be positive - got:%g \n",__func__ , radius);
+
+  localization->radius     = radius;
+  localization->tile_size  = util_int_max( tile_size , 1 );
+  localization->obs_x      = double_vector_alloc( 0 , 0 );
+  localization->obs_y      = double_vector_alloc( 0 , 0 );
+  localization->obs_z      = double_vector_alloc( 0 , 0 );
+  localization->obs_global = bool_vector_alloc( 0 , false );
+  return localization;
+}
+
+
+void distance_localization_free( distance_localization_type * localization ) {
+  double_vector_free( localization->obs_x );
+  double_vector_free( localization->obs_y );
+  double_vector_free( localization->obs_z );
+  bool_vector_free( localization->obs_global );
+  free( localization );
+}
+
+
+double distance_localization_get_radius( const distance_localization_type * localization ) {
+  return localization->radius;
+}
+
+
+int distance_localization_get_tile_size( const distance_localization_type * localization ) {
+  return localization->tile_size;
+}
+
+
+int distance_localization_get_num_obs( const distance_localization_type * localization ) {
+  return bool_vector_size( localization->obs_global );
+}
+
+
+/**
+   The observations must be added in the same order as the rows of
+   the S matrix, i.e. the order of the active observations in the
+   obs_data instance.
+*/
+
+void distance_localization_add_obs( distance_localization_type * localization , double x , double y , double z ) {
+  double_vector_append( localization->obs_x , x );
+  double_vector_append( localization->obs_y , y );
+  double_vector_append( localization->obs_z , z );
+  bool_vector_append( localization->obs_global , false );
+}
+
+
+void distance_localization_add_global_obs( distance_localization_type * localization ) {
+  double_vector_append( localization->obs_x , 0 );
+  double_vector_append( localization->obs_y , 0 );
+  double_vector_append( localization->obs_z , 0 );
+  bool_vector_append( localization->obs_global , true );
+}
+
+
+/**
+   Will add the positions of all the active observations in
+   @obs_data. The block observations are positioned in the centre of
+   the observed cell; all other observations are global.
+*/
+
+void distance_localization_add_obs_data( distance_localization_type * localization , const enkf_obs_type * enkf_obs , const obs_data_type * obs_data , const ecl_grid_type * grid ) {
+  for (int block_nr = 0; block_nr < obs_data_get_num_blocks( obs_data ); block_nr++) {
+    const obs_block_type * obs_block = obs_data_iget_block_const( obs_data , block_nr );
+    const char * obs_key = obs_block_get_key( obs_block );
+    const block_obs_type * block_obs = NULL;
+
+    if ((grid != NULL) && enkf_obs_has_key( enkf_obs , obs_key )) {
+      const obs_vector_type * obs_vector = enkf_obs_get_vector( enkf_obs , obs_key );
+      if (obs_vector_get_impl_type( obs_vector ) == BLOCK_OBS) {
+        int step = obs_vector_get_next_active_step( obs_vector , -1 );
+        if (step >= 0)
+          block_obs = obs_vector_iget_node( obs_vector , step );
+      }
+    }
+
+    for (int iobs = 0; iobs < obs_block_get_size( obs_block ); iobs++) {
+      if (obs_block_iget_active( obs_block , iobs )) {
+        if (block_obs != NULL) {
+          int i , j , k;
+          double x , y , z;
+
+          block_obs_iget_ijk( block_obs , iobs , &i , &j , &k );
+          ecl_grid_get_xyz3( grid , i , j , k , &x , &y , &z );
+          distance_localization_add_obs( localization , x , y , z );
+        } else
+          distance_localization_add_global_obs( localization );
+      }
+    }
+  }
+}
+
+
+/*****************************************************************/
+
+static matrix_type * distance_localization_alloc_rows( const matrix_type * src , const int_vector_type * rows ) {
+  matrix_type * target = matrix_alloc( int_vector_size( rows ) , matrix_get_columns( src ));
+  for (int i = 0; i < int_vector_size( rows ); i++)
+    matrix_copy_row( target , src , i , int_vector_iget( rows , i ));
+  return target;
+}
+
+
+/*
+  Selects the observations with a nonzero weight in the tile, and
+  returns the inverse square root of the weights in @scale_factor.
+*/
+
+static void distance_localization_select_obs( const distance_localization_type * localization , double x , double y , double z ,
+                                              int_vector_type * obs_index , double_vector_type * scale_factor ) {
+  int_vector_reset( obs_index );
+  double_vector_reset( scale_factor );
+
+  for (int iobs = 0; iobs < bool_vector_size( localization->obs_global ); iobs++) {
+    double rho = 1;
+
+    if (!bool_vector_iget( localization->obs_global , iobs )) {
+      double dx = double_vector_iget( localization->obs_x , iobs ) - x;
+      double dy = double_vector_iget( localization->obs_y , iobs ) - y;
+      double dz = double_vector_iget( localization->obs_z , iobs ) - z;
+      rho = distance_localization_gaspari_cohn( sqrt( dx*dx + dy*dy + dz*dz ) , localization->radius );
+    }
+
+    if (rho > 0) {
+      int_vector_append( obs_index , iobs );
+      double_vector_append( scale_factor , 1.0 / sqrt( rho ));
+    }
+  }
+}
+
+
+static void distance_localization_update_tile( tile_update_info_type * info , int tile ,
+                                               int_vector_type * obs_index , double_vector_type * scale_factor ) {
+  const distance_localization_type * localization = info->localization;
+
+  distance_localization_select_obs( localization , info->tile_x[tile] , info->tile_y[tile] , info->tile_z[tile] , obs_index , scale_factor );
+  if (int_vector_size( obs_index ) == 0)
+    return;  /* No observations in range - the tile is not updated. */
+
+  {
+    const int ens_size   = matrix_get_columns( info->A );
+    const int tile_start = info->tile_offset[tile];
+    const int tile_size  = info->tile_offset[tile + 1] - tile_start;
+    matrix_type * S      = distance_localization_alloc_rows( info->S , obs_index );
+    matrix_type * dObs   = distance_localization_alloc_rows( info->dObs , obs_index );
+    matrix_type * E      = NULL;
+    matrix_type * D      = NULL;
+    obs_covar_type * R   = obs_covar_alloc_subset( info->R , obs_index );
+    matrix_type * X      = matrix_alloc( ens_size , ens_size );
+    matrix_type * A      = matrix_alloc( tile_size , ens_size );
+
+    if (info->E != NULL)
+      E = distance_localization_alloc_rows( info->E , obs_index );
+
+    if (info->D != NULL)
+      D = distance_localization_alloc_rows( info->D , obs_index );
+
+    /*
+      D = dObs + E - S, so when the rows of E are scaled D changes with
+      (scale - 1) * E.
+    */
+    if (E != NULL) {
+      for (int i = 0; i < matrix_get_rows( E ); i++) {
+        double scale = double_vector_iget( scale_factor , i );
+        for (int j = 0; j < ens_size; j++) {
+          double e = matrix_iget( E , i , j );
+          matrix_iset( E , i , j , scale * e );
+          if (D != NULL)
+            matrix_iadd( D , i , j , (scale - 1) * e );
+        }
+      }
+    }
+
+    obs_covar_scale( R , double_vector_get_const_ptr( scale_factor ));
+    analysis_module_initX_covar( info->module , X , NULL , S , R , dObs , E , D , info->rng );
+
+    for (int i = 0; i < tile_size; i++)
+      matrix_copy_row( A , info->A , i , info->row_offset + info->tile_rows[tile_start + i] );
+
+    matrix_inplace_matmul( A , X );
+
+    for (int i = 0; i < tile_size; i++)
+      matrix_copy_row( info->A , A , info->row_offset + info->tile_rows[tile_start + i] , i );
+
+    matrix_free( A );
+    matrix_free( X );
+    obs_covar_free( R );
+    matrix_safe_free( D );
+    matrix_safe_free( E );
+    matrix_free( dObs );
+    matrix_free( S );
+  }
+}
+
+
+static void * distance_localization_update_tiles_mt( void * arg ) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
+  tile_update_info_type * info = arg_pack_iget_ptr( arg_pack , 0 );
+  int thread_nr   = arg_pack_iget_int( arg_pack , 1 );
+  int num_threads = arg_pack_iget_int( arg_pack , 2 );
+  int_vector_type * obs_index = int_vector_alloc( 0 , 0 );
+  double_vector_type * scale_factor = double_vector_alloc( 0 , 0 );
+
+  for (int tile = thread_nr; tile < info->num_tiles; tile += num_threads)
+    distance_localization_update_tile( info , tile , obs_index , scale_factor );
+
+  double_vector_free( scale_factor );
+  int_vector_free( obs_index );
+  return NULL;
+}
+
+
+/*
+  Will group the rows [0, num_rows) of the field in tiles; this is a
+  counting sort on the tile index of each cell.
+*/
+
+static void distance_localization_init_tiles( const distance_localization_type * localization , tile_update_info_type * info ,
+                                              const ecl_grid_type * grid , const active_list_type * active_list , int num_rows ) {
+  const int tile_size = localization->tile_size;
+  const int ntx = (ecl_grid_get_nx( grid ) + tile_size - 1) / tile_size;
+  const int nty = (ecl_grid_get_ny( grid ) + tile_size - 1) / tile_size;
+  const int ntz = (ecl_grid_get_nz( grid ) + tile_size - 1) / tile_size;
+  const int * active_index = NULL;
+  int * row_tile = util_calloc( num_rows , sizeof * row_tile );
+  int * tile_id  = util_calloc( ntx * nty * ntz , sizeof * tile_id );
+  int num_tiles  = 0;
+
+  if (active_list != NULL && active_list_get_mode( active_list ) == PARTLY_ACTIVE)
+    active_index = active_list_get_active( active_list );
+
+  for (int t = 0; t < ntx * nty * ntz; t++)
+    tile_id[t] = -1;
+
+  /* Map every row to a tile, and number the tiles which contain cells. */
+  for (int row = 0; row < num_rows; row++) {
+    int index = (active_index == NULL) ? row : active_index[row];
+    int i , j , k , t;
+
+    ecl_grid_get_ijk1A( grid , index , &i , &j , &k );
+    t = (i / tile_size) + ntx * ((j / tile_size) + nty * (k / tile_size));
+    if (tile_id[t] < 0)
+      tile_id[t] = num_tiles++;
+    row_tile[row] = tile_id[t];
+  }
+
+  info->num_tiles   = num_tiles;
+  info->tile_offset = util_calloc( num_tiles + 1 , sizeof * info->tile_offset );
+  info->tile_rows   = util_calloc( util_int_max( num_rows , 1 ) , sizeof * info->tile_rows );
+  info->tile_x      = util_calloc( util_int_max( num_tiles , 1 ) , sizeof * info->tile_x );
+  info->tile_y      = util_calloc( util_int_max( num_tiles , 1 ) , sizeof * info->tile_y );
+  info->tile_z      = util_calloc( util_int_max( num_tiles , 1 ) , sizeof * info->tile_z );
+
+  for (int t = 0; t <= num_tiles; t++)
+    info->tile_offset[t] = 0;
+
+  for (int t = 0; t < num_tiles; t++) {
+    info->tile_x[t] = 0;
+    info->tile_y[t] = 0;
+    info->tile_z[t] = 0;
+  }
+
+  for (int row = 0; row < num_rows; row++)
+    info->tile_offset[ row_tile[row] + 1 ]++;
+
+  for (int t = 0; t < num_tiles; t++)
+    info->tile_offset[t + 1] += info->tile_offset[t];
+
+  {
+    int * fill = util_calloc( util_int_max( num_tiles , 1 ) , sizeof * fill );
+    for (int t = 0; t < num_tiles; t++)
+      fill[t] = info->tile_offset[t];
+
+    for (int row = 0; row < num_rows; row++) {
+      int index = (active_index == NULL) ? row : active_index[row];
+      int t = row_tile[row];
+      double x , y , z;
+
+      ecl_grid_get_xyz1A( grid , index , &x , &y , &z );
+      info->tile_x[t] += x;
+      info->tile_y[t] += y;
+      info->tile_z[t] += z;
+      info->tile_rows[ fill[t]++ ] = row;
+    }
+    free( fill );
+  }
+
+  for (int t = 0; t < num_tiles; t++) {
+    int size = info->tile_offset[t + 1] - info->tile_offset[t];
+    info->tile_x[t] /= size;
+    info->tile_y[t] /= size;
+    info->tile_z[t] /= size;
+  }
+
+  free( tile_id );
+  free( row_tile );
+}
+
+
+/**
+   Will update the rows [row_offset, row_offset + num_rows) of A,
+   which hold the serialized FIELD on @grid, with a localized X
+   matrix for every tile. The rows must correspond to the active
+   cells in @active_list; if @active_list is NULL all the active cells
+   of the grid are assumed.
+
+   The S, R, dObs, E and D matrices are the ones which would
+   otherwise be passed to analysis_module_initX(); the localization
+   must contain exactly one position per row in S. The tiles are
+   updated with @num_threads threads if the analysis module has the
+   ANALYSIS_THREAD_SAFE option, otherwise serially.
+
+   Returns the number of tiles.
+*/
+
+int distance_localization_update_field( const distance_localization_type * localization ,
+                                        const ecl_grid_type * grid ,
+                                        const active_list_type * active_list ,
+                                        matrix_type * A ,
+                                        int row_offset ,
+                                        int num_rows ,
+                                        analysis_module_type * module ,
+                                        const matrix_type * S ,
+                                        const obs_covar_type * R ,
+                                        const matrix_type * dObs ,
+                                        const matrix_type * E ,
+                                        const matrix_type * D ,
+                                        rng_type * rng ,
+                                        int num_threads) {
+
+  tile_update_info_type info;
+
+  if (matrix_get_rows( S ) != distance_localization_get_num_obs( localization ))
+    util_abort("%s: size mismatch - S has %d rows, %d observation positions \n",__func__ ,
+               matrix_get_rows( S ) , distance_localization_get_num_obs( localization ));
+
+  if ((row_offset < 0) || (row_offset + num_rows > matrix_get_rows( A )))
+    util_abort("%s: rows [%d,%d) outside of A \n",__func__ , row_offset , row_offset + num_rows);
+
+  info.localization = localization;
+  info.A            = A;
+  info.row_offset   = row_offset;
+  info.module       = module;
+  info.S            = S;
+  info.R            = R;
+  info.dObs         = dObs;
+  info.E            = E;
+  info.D            = D;
+  info.rng          = rng;
+  distance_localization_init_tiles( localization , &info , grid , active_list , num_rows );
+
+  if (!analysis_module_check_option( module , ANALYSIS_THREAD_SAFE ))
+    num_threads = 1;
+
+  if (num_threads > 1) {
+    thread_pool_type * tp = thread_pool_alloc( num_threads , true );
+    arg_pack_type ** arg_list = util_calloc( num_threads , sizeof * arg_list );
+
+    for (int thread_nr = 0; thread_nr < num_threads; thread_nr++) {
+      arg_list[thread_nr] = arg_pack_alloc( );
+      arg_pack_append_ptr( arg_list[thread_nr] , &info );
+      arg_pack_append_int( arg_list[thread_nr] , thread_nr );
+      arg_pack_append_int( arg_list[thread_nr] , num_threads );
+      thread_pool_add_job( tp , distance_localization_update_tiles_mt , arg_list[thread_nr] );
+    }
+    thread_pool_join( tp );
+    thread_pool_free( tp );
+
+    for (int thread_nr = 0; thread_nr < num_threads; thread_nr++)
+      arg_pack_free( arg_list[thread_nr] );
+    free( arg_list );
+  } else {
+    arg_pack_type * arg_pack = arg_pack_alloc( );
+    arg_pack_append_ptr( arg_pack , &info );
+    arg_pack_append_int( arg_pack , 0 );
+    arg_pack_append_int( arg_pack , 1 );
+    distance_localization_update_tiles_mt( arg_pack );
+    arg_pack_free( arg_pack );
+  }
+
+  free( info.tile_offset );
+  free( info.tile_rows );
+  free( info.tile_x );
+  free( info.tile_y );
+  free( info.tile_z );
+  return info.num_tiles;
+}
@@ -45,6 +45,7 @@
 #include <ert/enkf/time_map.h>
 #include <ert/enkf/state_map.h>
 #include <ert/enkf/summary_key_set.h>
+#include <ert/enkf/summary_store.h>
 #include <ert/enkf/misfit_ensemble.h>
 #include <ert/enkf/cases_config.h>
 #include <ert/enkf/custom_kw_config_set.h>
@@ -213,6 +214,7 @@
 #define MISFIT_ENSEMBLE_FILE      "misfit-ensemble"
 #define CASE_CONFIG_FILE          "case_config"
 #define CUSTOM_KW_CONFIG_SET_FILE "custom_kw_config_set"
+#define SUMMARY_STORE_FILE        "summary-store.mnt"
 
 struct enkf_fs_struct {
   UTIL_TYPE_ID_DECLARATION;
@@ -226,12 +228,14 @@ struct enkf_fs_struct {
   fs_driver_type         * dynamic_forecast;
   fs_driver_type         * parameter;
   fs_driver_type         * index ;
+  fs_driver_impl           driver_id;
 
   bool                        read_only;             /* Whether this filesystem has been mounted read-only. */
   time_map_type             * time_map;
   cases_config_type         * cases_config;
   state_map_type            * state_map;
   summary_key_set_type      * summary_key_set;
+  summary_store_type        * summary_store;         /* Optional columnar storage of the summary responses; NULL if not enabled. */
   misfit_ensemble_type      * misfit_ensemble;
   custom_kw_config_set_type * custom_kw_config_set;
   /*
@@ -243,6 +247,9 @@ struct enkf_fs_struct {
   path_fmt_type             * case_tstep_fmt;
   path_fmt_type             * case_tstep_member_fmt;
 
+  long                        bytes_read;            /* Node and vector payload bytes read/written since mount; */
+  long                        bytes_written;         /* used by the update instrumentation, updated atomically. */
+
   int                         refcount;
   int                         runcount;  // Counts the number of simulations currently writing to this enkf_fs; the purpose is to
                                          // be able to answer the question: Is this case currently 'running'?
@@ -293,23 +300,27 @@ enkf_fs_type * enkf_fs_get_ref( enkf_fs_type * fs ) {
 }
 
 
-static enkf_fs_type * enkf_fs_alloc_empty( const char * mount_point ) {
+static enkf_fs_type * enkf_fs_alloc_empty( const char * mount_point , bool read_only ) {
   enkf_fs_type * fs          = util_malloc(sizeof * fs );
   UTIL_TYPE_ID_INIT( fs , ENKF_FS_TYPE_ID );
   fs->time_map               = time_map_alloc(  );
   fs->cases_config           = cases_config_alloc();
   fs->state_map              = state_map_alloc();
   fs->summary_key_set        = summary_key_set_alloc();
+  fs->summary_store          = NULL;
   fs->custom_kw_config_set   = custom_kw_config_set_alloc();
   fs->misfit_ensemble        = misfit_ensemble_alloc();
   fs->index                  = NULL;
   fs->parameter              = NULL;
   fs->dynamic_forecast       = NULL;
+  fs->driver_id              = INVALID_DRIVER_ID;
   fs->read_only              = true;
   fs->mount_point            = util_alloc_string_copy( mount_point );
   fs->refcount               = 0;
   fs->runcount               = 0;
   fs->lock_fd                = 0;
+  fs->bytes_read             = 0;
+  fs->bytes_written          = 0;
 
   if (mount_point == NULL)
     util_abort("%s: fatal internal error: mount_point == NULL \n",__func__);
@@ -322,7 +333,10 @@ static enkf_fs_type * enkf_fs_alloc_empty( const char * mount_point ) {
     fs->root_path = util_alloc_joined_string( (const char **) path_tmp , path_len , UTIL_PATH_SEP_STRING);
     fs->lock_file = util_alloc_filename( fs->mount_point , fs->case_name , "lock");
 
-    if (util_try_lockf( fs->lock_file , S_IWUSR + S_IWGRP , &fs->lock_fd)) {
+    if (read_only) {
+      /* An explicit read only mount does not take, or touch, the lock file. */
+      fs->read_only = true;
+    } else if (util_try_lockf( fs->lock_file , S_IWUSR + S_IWGRP , &fs->lock_fd)) {
       fs->read_only = false;
     } else {
       fprintf(stderr," Another program has already opened filesystem read-write - this instance will be UNSYNCRONIZED read-only. Cross your fingers ....\n");
@@ -436,15 +450,15 @@ static void enkf_fs_assign_driver( enkf_fs_type * fs , fs_driver_type * driver ,
 }
 
 
-static enkf_fs_type *  enkf_fs_mount_block_fs( FILE * fstab_stream , const char * mount_point  ) {
-  enkf_fs_type * fs = enkf_fs_alloc_empty( mount_point );
+static enkf_fs_type *  enkf_fs_mount_block_fs( FILE * fstab_stream , const char * mount_point , bool lazy , bool read_only ) {
+  enkf_fs_type * fs = enkf_fs_alloc_empty( mount_point , read_only );
 
   {
     while (true) {
       fs_driver_enum driver_type;
       if (fread( &driver_type , sizeof driver_type , 1 , fstab_stream) == 1) {
         if (fs_types_valid( driver_type )) {
-          fs_driver_type * driver = block_fs_driver_open( fstab_stream , mount_point , driver_type , fs->read_only);
+          fs_driver_type * driver = block_fs_driver_open( fstab_stream , mount_point , driver_type , fs->read_only , lazy );
           enkf_fs_assign_driver( fs , driver , driver_type );
         } else
           block_fs_driver_fskip( fstab_stream );
@@ -459,8 +473,8 @@ static enkf_fs_type *  enkf_fs_mount_block_fs( FILE * fstab_stream , const char
 
 
 
-static enkf_fs_type *  enkf_fs_mount_plain( FILE * fstab_stream , const char * mount_point ) {
-  enkf_fs_type * fs = enkf_fs_alloc_empty( mount_point );
+static enkf_fs_type *  enkf_fs_mount_plain( FILE * fstab_stream , const char * mount_point , bool read_only ) {
+  enkf_fs_type * fs = enkf_fs_alloc_empty( mount_point , read_only );
   {
     while (true) {
       fs_driver_enum driver_type;
@@ -581,6 +595,35 @@ state_map_type * enkf_fs_alloc_readonly_state_map( const char * mount_point ) {
   return state_map;
 }
 
+/*
+  The columnar summary store is optional; it is mounted if the case
+  already has one, and can be created with
+  enkf_fs_enable_summary_store().
+*/
+
+static void enkf_fs_mount_summary_store( enkf_fs_type * fs ) {
+  char * mount_file = enkf_fs_alloc_case_filename( fs , SUMMARY_STORE_FILE );
+  if (util_file_exists( mount_file ))
+    fs->summary_store = summary_store_mount( mount_file , fs->read_only );
+  free( mount_file );
+}
+
+
+bool enkf_fs_enable_summary_store( enkf_fs_type * fs ) {
+  if ((fs->summary_store == NULL) && !fs->read_only) {
+    char * mount_file = path_fmt_alloc_file( fs->case_fmt , true , fs->mount_point , SUMMARY_STORE_FILE );
+    fs->summary_store = summary_store_mount( mount_file , false );
+    free( mount_file );
+  }
+  return (fs->summary_store != NULL);
+}
+
+
+summary_store_type * enkf_fs_get_summary_store( const enkf_fs_type * fs ) {
+  return fs->summary_store;
+}
+
+
 summary_key_set_type * enkf_fs_alloc_readonly_summary_key_set( const char * mount_point ) {
   path_fmt_type * path_fmt = path_fmt_alloc_directory_fmt( DEFAULT_CASE_PATH );
   char * filename = path_fmt_alloc_file( path_fmt , false , mount_point , SUMMARY_KEY_SET_FILE);
@@ -653,7 +696,7 @@ bool enkf_fs_update_disk_version(const char * mount_point , int src_version , in
 }
 
 
-enkf_fs_type * enkf_fs_mount(const char * mount_point) {
+static enkf_fs_type * enkf_fs_mount__(const char * mount_point, bool lazy, bool read_only) {
   FILE * stream = fs_driver_open_fstab(mount_point, false);
 
   if (!stream)
@@ -667,17 +710,18 @@ enkf_fs_type * enkf_fs_mount(const char * mount_point) {
 
   switch(driver_id) {
   case(BLOCK_FS_DRIVER_ID):
-    fs = enkf_fs_mount_block_fs(stream, mount_point);
-    res_log_fdebug("Mounting (block_fs) point %s.", mount_point);
+    fs = enkf_fs_mount_block_fs(stream, mount_point, lazy, read_only);
+    res_log_fdebug("Mounting (block_fs) point %s%s.", mount_point, lazy ? " lazily" : "");
     break;
   case(PLAIN_DRIVER_ID):
-    fs = enkf_fs_mount_plain(stream, mount_point);
+    fs = enkf_fs_mount_plain(stream, mount_point, read_only);
     res_log_fdebug("Mounting (plain) point %s.", mount_point);
     break;
   default:
     util_abort("%s: unrecognized driver_id:%d \n", __func__, driver_id);
   }
 
+  fs->driver_id = driver_id;
   fclose(stream);
   enkf_fs_init_path_fmt(fs);
   enkf_fs_fread_time_map(fs);
@@ -686,12 +730,82 @@ enkf_fs_type * enkf_fs_mount(const char * mount_point) {
   enkf_fs_fread_summary_key_set(fs);
   enkf_fs_fread_custom_kw_config_set(fs);
   enkf_fs_fread_misfit(fs);
+  enkf_fs_mount_summary_store(fs);
 
   enkf_fs_get_ref(fs);
   return fs;
 }
 
 
+enkf_fs_type * enkf_fs_mount(const char * mount_point) {
+  return enkf_fs_mount__(mount_point, false, false);
+}
+
+
+/*
+  Mounts the case without mounting any of the block_fs shards up
+  front; only the fstab and the case metadata (time map, state map,
+  ...) are read. The shard holding a realization is mounted the first
+  time that realization is accessed, so looking at a few realizations,
+  or only at the metadata, of a large case is cheap.
+
+  With @read_only the case is opened without taking the lock file, and
+  nothing is created on disk; this is suitable for browsing cases which
+  might be in use by another process.
+*/
+
+enkf_fs_type * enkf_fs_mount_lazy(const char * mount_point, bool read_only) {
+  return enkf_fs_mount__(mount_point, true, read_only);
+}
+
+
+/*
+  The number of block_fs shards which are currently mounted, summed
+  over the parameter, dynamic and index drivers; mainly for testing the
+  lazy mount.
+*/
+
+int enkf_fs_get_num_mounted_shards( const enkf_fs_type * fs ) {
+  if (fs->driver_id != BLOCK_FS_DRIVER_ID)
+    return 0;
+
+  return block_fs_driver_get_num_mounted( fs->parameter ) +
+         block_fs_driver_get_num_mounted( fs->dynamic_forecast ) +
+         block_fs_driver_get_num_mounted( fs->index );
+}
+
+
+/*
+  Sets the group commit fsync policy of all the block_fs shards of the
+  case; see block_fs_set_fsync_policy(). Has no effect for other
+  drivers.
+*/
+
+void enkf_fs_set_fsync_policy( enkf_fs_type * fs , int fsync_interval , size_t fsync_bytes , double fsync_seconds ) {
+  if (fs->driver_id != BLOCK_FS_DRIVER_ID)
+    return;
+
+  block_fs_driver_set_fsync_policy( fs->parameter , fsync_interval , fsync_bytes , fsync_seconds );
+  block_fs_driver_set_fsync_policy( fs->dynamic_forecast , fsync_interval , fsync_bytes , fsync_seconds );
+  block_fs_driver_set_fsync_policy( fs->index , fsync_interval , fsync_bytes , fsync_seconds );
+}
+
+
+/*
+  Sets the codec used to compress the parameter and dynamic nodes
+  written to the case from now on; the small index records are always
+  stored uncompressed. Has no effect for other drivers.
+*/
+
+void enkf_fs_set_codec( enkf_fs_type * fs , block_fs_codec_type codec ) {
+  if (fs->driver_id != BLOCK_FS_DRIVER_ID)
+    return;
+
+  block_fs_driver_set_codec( fs->parameter , codec );
+  block_fs_driver_set_codec( fs->dynamic_forecast , codec );
+}
+
+
 bool enkf_fs_exists( const char * mount_point ) {
   bool exists   = false;
 
@@ -707,6 +821,78 @@ bool enkf_fs_exists( const char * mount_point ) {
 
 
 
+/**
+   Will create a new case at @target_mount_point which is a complete
+   copy of @src_fs; all realizations, all nodes and the case metadata
+   (time map, state map, ...). The block_fs data files are copied
+   wholesale, using reflinks or copy_file_range() where available, so
+   this is much faster than copying the nodes one by one.
+
+   Cloning is only supported for the block_fs driver, and the target
+   case can not exist up front. If @mount is true the new case is
+   mounted and returned, otherwise the function returns NULL.
+*/
+
+enkf_fs_type * enkf_fs_clone( enkf_fs_type * src_fs , const char * target_mount_point , bool mount ) {
+  if (src_fs->driver_id != BLOCK_FS_DRIVER_ID)
+    util_abort("%s: cloning is only supported for the block_fs driver \n",__func__);
+
+  if (enkf_fs_exists( target_mount_point ))
+    util_abort("%s: can not clone into existing case:%s \n",__func__ , target_mount_point);
+
+  if (!src_fs->read_only)
+    enkf_fs_fsync( src_fs );
+
+  {
+    bool clone_ok = true;
+    char * src_fstab    = fs_driver_alloc_fstab_file( src_fs->mount_point );
+    char * target_fstab = fs_driver_alloc_fstab_file( target_mount_point );
+
+    util_make_path( target_mount_point );
+    clone_ok = clone_ok && block_fs_driver_clone( src_fs->parameter , target_mount_point );
+    clone_ok = clone_ok && block_fs_driver_clone( src_fs->dynamic_forecast , target_mount_point );
+    clone_ok = clone_ok && block_fs_driver_clone( src_fs->index , target_mount_point );
+
+    {
+      const char * case_files[] = { TIME_MAP_FILE , STATE_MAP_FILE , SUMMARY_KEY_SET_FILE , MISFIT_ENSEMBLE_FILE ,
+                                    CASE_CONFIG_FILE , CUSTOM_KW_CONFIG_SET_FILE };
+      for (int i = 0; i < sizeof case_files / sizeof case_files[0]; i++) {
+        char * src_file = enkf_fs_alloc_case_filename( src_fs , case_files[i] );
+        if (util_file_exists( src_file )) {
+          char * target_file = path_fmt_alloc_file( src_fs->case_fmt , true , target_mount_point , case_files[i] );
+          util_copy_file( src_file , target_file );
+          free( target_file );
+        }
+        free( src_file );
+      }
+    }
+
+    if (src_fs->summary_store) {
+      char * target_file = path_fmt_alloc_file( src_fs->case_fmt , true , target_mount_point , SUMMARY_STORE_FILE );
+      clone_ok = clone_ok && summary_store_clone( src_fs->summary_store , target_file );
+      free( target_file );
+    }
+
+    /*
+      The fstab file is copied last; until it is in place the target
+      is not recognized as an enkf_fs case.
+    */
+    if (clone_ok)
+      util_copy_file( src_fstab , target_fstab );
+    else
+      util_abort("%s: failed to clone case:%s to %s \n",__func__ , src_fs->mount_point , target_mount_point);
+
+    free( src_fstab );
+    free( target_fstab );
+  }
+
+  if (mount)
+    return enkf_fs_mount( target_mount_point );
+  else
+    return NULL;
+}
+
+
 /*****************************************************************/
 
 
@@ -734,6 +920,9 @@ static void enkf_fs_umount(enkf_fs_type * fs) {
   enkf_fs_free_driver(fs->parameter);
   enkf_fs_free_driver(fs->index);
 
+  if (fs->summary_store)
+    summary_store_close(fs->summary_store);
+
   if (fs->lock_fd > 0) {
     close(fs->lock_fd);  // Closing the lock_file file descriptor - and releasing the lock.
     util_unlink_existing(fs->lock_file);
@@ -801,12 +990,39 @@ void enkf_fs_fsync( enkf_fs_type * fs ) {
   enkf_fs_fsync_cases_config( fs) ;
   enkf_fs_fsync_state_map( fs );
   enkf_fs_fsync_summary_key_set( fs );
+
+  if (fs->summary_store)
+    summary_store_fsync( fs->summary_store );
   enkf_fs_fsync_custom_kw_config_set(fs);
 }
 
 
 
 
+/*
+  Called for every node and vector read/write; the counters are
+  updated with atomic adds so the hot path does not take a lock.
+*/
+
+static void enkf_fs_add_io( enkf_fs_type * fs , long bytes_read , long bytes_written) {
+  if (bytes_read > 0)
+    __sync_fetch_and_add( &fs->bytes_read , bytes_read );
+
+  if (bytes_written > 0)
+    __sync_fetch_and_add( &fs->bytes_written , bytes_written );
+}
+
+
+long enkf_fs_get_bytes_read( enkf_fs_type * fs ) {
+  return __sync_fetch_and_add( &fs->bytes_read , 0 );
+}
+
+
+long enkf_fs_get_bytes_written( enkf_fs_type * fs ) {
+  return __sync_fetch_and_add( &fs->bytes_written , 0 );
+}
+
+
 void enkf_fs_fread_node(enkf_fs_type * enkf_fs , buffer_type * buffer ,
                         const char * node_key ,
                         enkf_var_type var_type ,
@@ -820,6 +1036,7 @@ void enkf_fs_fread_node(enkf_fs_type * enkf_fs , buffer_type * buffer ,
 
   buffer_rewind( buffer );
   driver->load_node(driver , node_key ,  report_step , iens , buffer);
+  enkf_fs_add_io( enkf_fs , buffer_get_size( buffer ) , 0 );
 }
 
 
@@ -832,6 +1049,7 @@ void enkf_fs_fread_vector(enkf_fs_type * enkf_fs , buffer_type * buffer ,
 
   buffer_rewind( buffer );
   driver->load_vector(driver , node_key ,  iens , buffer);
+  enkf_fs_add_io( enkf_fs , buffer_get_size( buffer ) , 0 );
 }
 
 
@@ -862,6 +1080,7 @@ void enkf_fs_fwrite_node(enkf_fs_type * enkf_fs , buffer_type * buffer , const c
       driver->save_node(driver , node_key , report_step , iens , buffer);
     }
   }
+  enkf_fs_add_io( enkf_fs , 0 , buffer_get_size( buffer ));
 }
 
 
@@ -876,6 +1095,70 @@ void enkf_fs_fwrite_vector(enkf_fs_type * enkf_fs , buffer_type * buffer , const
       driver->save_vector(driver , node_key  , iens , buffer);
     }
   }
+  enkf_fs_add_io( enkf_fs , 0 , buffer_get_size( buffer ));
+}
+
+
+/**
+   Writes the vectors of several nodes of realization @iens in one
+   go; the buffers in @buffers correspond to the keys in
+   @node_keys. Drivers which do not support batched writes will get
+   the vectors one at a time.
+*/
+
+void enkf_fs_fwrite_vectors(enkf_fs_type * enkf_fs , const vector_type * buffers , const stringlist_type * node_keys, enkf_var_type var_type,
+                            int iens ) {
+  const int size = stringlist_get_size( node_keys );
+  if (size == 0)
+    return;
+
+  if (enkf_fs->read_only)
+    util_abort("%s: attempt to write to read_only filesystem mounted at:%s - aborting. \n",__func__ , enkf_fs->mount_point);
+  {
+    void * _driver = enkf_fs_select_driver(enkf_fs , var_type , stringlist_iget( node_keys , 0 ));
+    fs_driver_type * driver = fs_driver_safe_cast(_driver);
+
+    if (driver->save_vectors)
+      driver->save_vectors(driver , node_keys , iens , buffers);
+    else {
+      for (int i = 0; i < size; i++)
+        driver->save_vector(driver , stringlist_iget( node_keys , i ) , iens , vector_iget( buffers , i ));
+    }
+  }
+
+  for (int i = 0; i < size; i++)
+    enkf_fs_add_io( enkf_fs , 0 , buffer_get_size( vector_iget_const( buffers , i )));
+}
+
+
+/**
+   Copies the stored payload of one node from @src_fs to @target_fs
+   without instantiating an enkf_node; the bytes are read into
+   @buffer and written unmodified to the target. The buffer is
+   supplied by the calling scope so it can be reused when copying
+   many nodes. The node must exist in the source.
+
+   Observe that this bypasses the type specific load/store code;
+   node types which update config state when loaded (GEN_DATA) or
+   which do not have a payload of their own (CONTAINER) should be
+   copied with enkf_node_copy().
+*/
+
+void enkf_fs_copy_node(enkf_fs_type * src_fs , enkf_fs_type * target_fs , buffer_type * buffer ,
+                       const char * node_key , enkf_var_type var_type ,
+                       node_id_type src_id , node_id_type target_id) {
+
+  enkf_fs_fread_node( src_fs , buffer , node_key , var_type , src_id.report_step , src_id.iens );
+  enkf_fs_fwrite_node( target_fs , buffer , node_key , var_type , target_id.report_step , target_id.iens );
+}
+
+
+void enkf_fs_copy_vector(enkf_fs_type * src_fs , enkf_fs_type * target_fs , buffer_type * buffer ,
+                         const char * node_key , enkf_var_type var_type ,
+                         int src_iens , int target_iens) {
+
+  enkf_fs_fread_vector( src_fs , buffer , node_key , var_type , src_iens );
+  enkf_fs_fwrite_vector( target_fs , buffer , node_key , var_type , target_iens );
 }
 
 
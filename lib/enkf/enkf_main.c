@@ -79,13 +79,20 @@
 #include <ert/enkf/meas_data.h>
 #include <ert/enkf/enkf_state.h>
 #include <ert/enkf/enkf_obs.h>
+#include <ert/enkf/response_cache.h>
+#include <ert/enkf/distance_localization.h>
+#include <ert/enkf/update_profile.h>
 #include <ert/enkf/enkf_fs.h>
 #include <ert/enkf/enkf_main.h>
+#include <ert/enkf/ensemble_stat.h>
+#include <ert/enkf/gen_kw.h>
+#include <ert/enkf/ext_param.h>
 #include <ert/enkf/res_config.h>
 #include <ert/enkf/enkf_serialize.h>
 #include <ert/enkf/plot_settings.h>
 #include <ert/enkf/ensemble_config.h>
 #include <ert/enkf/model_config.h>
+#include <ert/enkf/summary_store.h>
 #include <ert/enkf/hook_manager.h>
 #include <ert/enkf/site_config.h>
 #include <ert/enkf/queue_config.h>
@@ -108,6 +115,7 @@
 #include <ert/enkf/analysis_config.h>
 #include <ert/enkf/analysis_iter_config.h>
 #include <ert/enkf/field.h>
+#include <ert/enkf/field_config.h>
 #include <ert/enkf/ert_run_context.h>
 #include <ert/enkf/run_arg.h>
 #include <ert/enkf/callback_arg.h>
@@ -145,6 +153,7 @@
 */
 
 #define ENKF_MAIN_ID              8301
+#define UPDATE_CPU_THREADS           4   /* The number of threads used to update one ministep. */
 
 struct enkf_main_struct {
   UTIL_TYPE_ID_DECLARATION;
@@ -161,6 +170,7 @@ struct enkf_main_struct {
   enkf_state_type       ** ensemble;         /* The ensemble ... */
   int                      ens_size;         /* The size of the ensemble */
   bool                     verbose;
+  update_profile_type    * update_profile;   /* Only != NULL while an update with UPDATE_SETTINGS PROFILE is running. */
 };
 
 
@@ -184,7 +194,9 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
                                        int step2 ,
                                        const local_ministep_type * ministep ,
                                        const meas_data_type * forecast ,
-                                       obs_data_type * obs_data);
+                                       obs_data_type * obs_data,
+                                       rng_type * rng,
+                                       int cpu_threads);
 /*****************************************************************/
 
 UTIL_SAFE_CAST_FUNCTION(enkf_main , ENKF_MAIN_ID)
@@ -347,135 +359,112 @@ void enkf_main_exit(enkf_main_type * enkf_main) {
 
 
 
-/**
-   This function returns a (enkf_node_type ** ) pointer, which points
-   to all the instances with the same keyword, i.e.
-
-   enkf_main_alloc_node_ensemble(enkf_main , "PRESSURE");
-
-   Will return an ensemble of pressure nodes. The enkf_node instances
-   must be free'd with enkf_node_free( ) afterwards.
-
-   Example:
+typedef struct {
+  const enkf_config_node_type * config_node;
+  enkf_fs_type                * src_fs;
+  enkf_fs_type                * target_fs;
+  const enkf_node_type        * mean;
+  const enkf_node_type        * inflation;
+  int                           report_step;
+  int                           iens1;
+  int                           iens2;
+} inflate_info_type;
 
-   vector_type * pressure_nodes = enkf_main_alloc_node_ensemble(enkf_main , "PRESSURE");
 
-   // Do something with the pressure nodes ...
+/*
+  Each realization is inflated as:
 
-   free(pressure_nodes);
+     x -> mean + inflation * (x - mean)
 
+  and stored in the target filesystem; only one realization is held
+  in memory per thread.
 */
 
-static vector_type * enkf_main_alloc_node_ensemble(const enkf_main_type * enkf_main , enkf_fs_type * src_fs, const char * key , int report_step) {
-  const int ens_size              = enkf_main_get_ensemble_size( enkf_main );
-  vector_type * node_ensemble = vector_alloc_new( );
-  const enkf_config_node_type * config_node = ensemble_config_get_node(enkf_main_get_ensemble_config(enkf_main), key );
-  node_id_type node_id = {.report_step = report_step ,
-                          .iens        = -1 };
-  int iens;
-
-
-  for (iens = 0; iens < ens_size; iens++) {
-    enkf_node_type * node = enkf_node_alloc( config_node );
-    node_id.iens = iens;
-    enkf_node_load( node , src_fs , node_id);
-    vector_append_owned_ref( node_ensemble , node , enkf_node_free__ );
+static void * enkf_main_inflate_nodes_mt( void * arg ) {
+  inflate_info_type * info = (inflate_info_type *) arg;
+  enkf_node_type * node = enkf_node_alloc( info->config_node );
+  enkf_node_type * neg_mean = enkf_node_copyc( info->mean );
+  enkf_node_scale( neg_mean , -1 );
+
+  for (int iens = info->iens1; iens < info->iens2; iens++) {
+    node_id_type node_id = {.report_step = info->report_step , .iens = iens };
+    enkf_node_load( node , info->src_fs , node_id );
+    enkf_node_iadd( node , neg_mean );
+    enkf_node_imul( node , info->inflation );
+    enkf_node_iadd( node , info->mean );
+    enkf_node_store( node , info->target_fs , true , node_id );
   }
 
-  return node_ensemble;
-}
-
-/*****************************************************************/
-
-
-
-
-
-
-static void enkf_main_node_mean( const vector_type * ensemble , enkf_node_type * mean ) {
-  if (vector_get_size( ensemble ) == 0)
-    util_abort("%s: internal error - calculation average of empty list\n",__func__);
-  {
-    int iens;
-    enkf_node_clear( mean );
-    for (iens = 0; iens < vector_get_size( ensemble ); iens++)
-      enkf_node_iadd( mean , vector_iget_const( ensemble , iens) );
-
-    enkf_node_scale( mean , 1.0 / vector_get_size( ensemble ) );
-  }
+  enkf_node_free( neg_mean );
+  enkf_node_free( node );
+  return NULL;
 }
 
 
 /**
-   This function calculates the node standard deviation from the
-   ensemble. The mean can be NULL, in which case it is assumed that
-   the mean has already been shifted away from the ensemble.
+   The mean and standard deviation of the ensemble are calculated
+   with the streaming ensemble_stat object, i.e. the full ensemble
+   is never loaded into memory at once.
 */
 
+void enkf_main_inflate_node(enkf_main_type * enkf_main , enkf_fs_type * src_fs , enkf_fs_type * target_fs , int report_step , const char * key , const enkf_node_type * min_std) {
+  const int ens_size                        = enkf_main_get_ensemble_size(enkf_main);
+  const int cpu_threads                     = 4;
+  const enkf_config_node_type * config_node = ensemble_config_get_node( enkf_main_get_ensemble_config(enkf_main) , key );
+  thread_pool_type * work_pool              = thread_pool_alloc( cpu_threads , false );
+  ensemble_stat_type * stat                 = ensemble_stat_alloc( NULL );
+  node_id_type node_id                      = {.report_step = report_step , .iens = 0 };
+  enkf_node_type * mean                     = enkf_node_alloc( config_node );
+  enkf_node_type * std;
+
+  if (ens_size == 0)
+    util_abort("%s: internal error - inflation of empty ensemble\n",__func__);
 
-static void enkf_main_node_std( const vector_type * ensemble , const enkf_node_type * mean , enkf_node_type * std) {
-  if (vector_get_size( ensemble ) == 0)
-    util_abort("%s: internal error - calculation std of empty list\n",__func__);
   {
-    int iens;
-    enkf_node_clear( std );
-    for (iens = 0; iens < vector_get_size( ensemble ); iens++)
-      enkf_node_iaddsqr( std , vector_iget_const( ensemble, iens) );
-    enkf_node_scale(std , 1.0 / vector_get_size( ensemble ));
-
-    if (mean != NULL) {
-      enkf_node_scale( std , -1 );
-      enkf_node_iaddsqr( std , mean );
-      enkf_node_scale( std , -1 );
-    }
+    int_vector_type * iens_list = int_vector_alloc( 0 , 0 );
+    for (int iens = 0; iens < ens_size; iens++)
+      int_vector_append( iens_list , iens );
 
-    enkf_node_sqrt( std );
+    ensemble_stat_add_ensemble( stat , config_node , src_fs , report_step , iens_list , work_pool );
+    int_vector_free( iens_list );
   }
-}
-
-
-void enkf_main_inflate_node(enkf_main_type * enkf_main , enkf_fs_type * src_fs , enkf_fs_type * target_fs , int report_step , const char * key , const enkf_node_type * min_std) {
-  int ens_size                              = enkf_main_get_ensemble_size(enkf_main);
-  vector_type * ensemble                    = enkf_main_alloc_node_ensemble( enkf_main , src_fs , key , report_step );  // Was ANALYZED
-  enkf_node_type * mean                     = enkf_node_copyc( vector_iget_const( ensemble, 0) );
-  enkf_node_type * std                      = enkf_node_copyc( mean );
-  int iens;
 
-  /* Shifting away the mean */
-  enkf_main_node_mean( ensemble , mean );
-  enkf_main_node_std( ensemble , mean , std);
-  enkf_node_scale( mean , -1 );
-  for (iens = 0; iens < ens_size; iens++)
-    enkf_node_iadd( vector_iget(ensemble,iens), mean );
-  enkf_node_scale( mean , -1 );
+  /* Loading a realization to get correctly shaped mean and std nodes. */
+  enkf_node_load( mean , src_fs , node_id );
+  std = enkf_node_copyc( mean );
+  ensemble_stat_get_mean_node( stat , mean , node_id );
+  ensemble_stat_get_std_node( stat , std , node_id );
 
-  /*****************************************************************/
-  /*
-    Now we have the ensemble represented as a mean and an ensemble of
-    deviations from the mean. This is the form suitable for actually
-    doing the inflation.
-  */
   {
     enkf_node_type * inflation = enkf_node_copyc( mean );
-    enkf_node_set_inflation( inflation , std , min_std  );
+    inflate_info_type * inflate_info = util_calloc( cpu_threads , sizeof * inflate_info );
+    int iens_offset = 0;
 
-    for (iens = 0; iens < vector_get_size( ensemble ); iens++)
-      enkf_node_imul( vector_iget( ensemble, iens) , inflation );
+    enkf_node_set_inflation( inflation , std , min_std  );
+    thread_pool_restart( work_pool );
+    for (int icpu = 0; icpu < cpu_threads; icpu++) {
+      inflate_info[icpu].config_node = config_node;
+      inflate_info[icpu].src_fs      = src_fs;
+      inflate_info[icpu].target_fs   = target_fs;
+      inflate_info[icpu].mean        = mean;
+      inflate_info[icpu].inflation   = inflation;
+      inflate_info[icpu].report_step = report_step;
+      inflate_info[icpu].iens1       = iens_offset;
+      inflate_info[icpu].iens2       = iens_offset + (ens_size - iens_offset) / (cpu_threads - icpu);
+      iens_offset = inflate_info[icpu].iens2;
+
+      thread_pool_add_job( work_pool , enkf_main_inflate_nodes_mt , &inflate_info[icpu] );
+    }
+    thread_pool_join( work_pool );
 
+    free( inflate_info );
     enkf_node_free( inflation );
   }
 
-
-  /* Add the mean back in - and store the updated node to disk.*/
-  for (iens = 0; iens < ens_size; iens++) {
-    node_id_type node_id = {.report_step = report_step , .iens = iens };
-    enkf_node_iadd( vector_iget( ensemble, iens) , mean );
-    enkf_node_store( vector_iget( ensemble, iens) , target_fs , true , node_id);
-  }
-
   enkf_node_free( mean );
   enkf_node_free( std );
-  vector_free( ensemble );
+  ensemble_stat_free( stat );
+  thread_pool_free( work_pool );
 }
 
 
@@ -895,15 +884,19 @@ static void assert_size_equal(int ens_size , const bool_vector_type * ens_mask)
 
 
 
-// Opens and returns a log file.  A subroutine of enkf_main_UPDATE.
-static FILE * enkf_main_log_step_list(enkf_main_type * enkf_main, const int_vector_type * step_list) {
+static char * enkf_main_alloc_update_log_file(enkf_main_type * enkf_main, const int_vector_type * step_list) {
   const char * log_path = analysis_config_get_log_path(enkf_main_get_analysis_config(enkf_main));
-  char * log_file;
   if (int_vector_size(step_list) == 1)
-    log_file = util_alloc_sprintf("%s%c%04d", log_path, UTIL_PATH_SEP_CHAR, int_vector_iget(step_list, 0));
+    return util_alloc_sprintf("%s%c%04d", log_path, UTIL_PATH_SEP_CHAR, int_vector_iget(step_list, 0));
   else
-    log_file = util_alloc_sprintf("%s%c%04d-%04d", log_path, UTIL_PATH_SEP_CHAR, int_vector_iget(step_list, 0),
-            int_vector_get_last(step_list));
+    return util_alloc_sprintf("%s%c%04d-%04d", log_path, UTIL_PATH_SEP_CHAR, int_vector_iget(step_list, 0),
+                              int_vector_get_last(step_list));
+}
+
+
+// Opens and returns a log file.  A subroutine of enkf_main_UPDATE.
+static FILE * enkf_main_log_step_list(enkf_main_type * enkf_main, const int_vector_type * step_list) {
+  char * log_file = enkf_main_alloc_update_log_file(enkf_main, step_list);
   FILE * log_stream = util_fopen(log_file, "w");
 
   free(log_file);
@@ -911,6 +904,260 @@ static FILE * enkf_main_log_step_list(enkf_main_type * enkf_main, const int_vect
 }
 
 
+/*
+  Collects the observations and the simulated responses of one
+  ministep in obs_data and meas_data, and deactivates the
+  outliers. The responses are loaded through the response cache
+  which is shared by all the ministeps of the update. Returns true if
+  the ministep has active observations.
+*/
+
+static bool enkf_main_measure_ministep(enkf_main_type * enkf_main,
+                                       response_cache_type * response_cache,
+                                       const int_vector_type * step_list,
+                                       const int_vector_type * ens_active_list,
+                                       local_ministep_type * ministep,
+                                       meas_data_type * meas_data,
+                                       obs_data_type * obs_data,
+                                       FILE * log_stream) {
+
+  const analysis_config_type * analysis_config = enkf_main_get_analysis_config(enkf_main);
+  local_obsdata_type * obsdata = local_ministep_get_obsdata(ministep);
+  enkf_fs_type * source_fs = response_cache_get_fs(response_cache);
+  update_phase_type * phase = update_profile_start_phase(enkf_main->update_profile, source_fs,
+                                                         local_ministep_get_name(ministep), NULL, "measure");
+
+  obs_data_reset(obs_data);
+  meas_data_reset(meas_data);
+
+  /*
+    Temporarily we will just force the timestep from the input
+    argument onto the obsdata instance; in the future the
+    obsdata should hold it's own here.
+  */
+  local_obsdata_reset_tstep_list(obsdata, step_list);
+
+  if (analysis_config_get_std_scale_correlated_obs(analysis_config)) {
+    double scale_factor = enkf_obs_scale_correlated_std_cached(enkf_main->obs, response_cache,
+                                                               ens_active_list, obsdata);
+    res_log_finfo("Scaling standard deviation in obdsata set:%s with %g",
+                  local_obsdata_get_name(obsdata), scale_factor);
+  }
+  enkf_obs_get_obs_and_measure_data_cached(enkf_main->obs, response_cache, obsdata,
+                                           ens_active_list, meas_data, obs_data);
+
+  double alpha = analysis_config_get_alpha(analysis_config);
+  double std_cutoff = analysis_config_get_std_cutoff(analysis_config);
+  enkf_analysis_deactivate_outliers(obs_data, meas_data,
+                                    std_cutoff, alpha, enkf_main->verbose);
+  update_phase_set_dims(phase, obs_data_get_active_size(obs_data), meas_data_get_active_ens_size(meas_data));
+  update_phase_stop(phase, source_fs);
+
+  if (enkf_main->verbose)
+    enkf_analysis_fprintf_obs_summary(obs_data, meas_data, step_list, local_ministep_get_name(ministep), stdout);
+  enkf_analysis_fprintf_obs_summary(obs_data, meas_data, step_list, local_ministep_get_name(ministep), log_stream);
+
+  return ((obs_data_get_active_size(obs_data) > 0) && (meas_data_get_active_obs_size(meas_data) > 0));
+}
+
+
+/*
+  With MINISTEP_THREADS > 1 every ministep of an update gets its own
+  rng, seeded from the shared rng in ministep order; that way the random
+  numbers drawn for a ministep do not depend on how the ministeps are
+  scheduled. The serial update draws directly from the shared rng, so
+  the two give different, but equally valid, perturbations.
+*/
+
+static rng_type * enkf_main_alloc_ministep_rng(enkf_main_type * enkf_main) {
+  rng_type * rng = rng_alloc(MZRAN, INIT_DEFAULT);
+  rng_rng_init(rng, enkf_main->shared_rng);
+  return rng;
+}
+
+
+static stringlist_type * enkf_main_alloc_ministep_keys(const local_ministep_type * ministep) {
+  stringlist_type * keys = stringlist_alloc_new();
+  hash_iter_type * dataset_iter = local_ministep_alloc_dataset_iter(ministep);
+
+  while (!hash_iter_is_complete(dataset_iter)) {
+    const char * dataset_name = hash_iter_get_next_key(dataset_iter);
+    const local_dataset_type * dataset = local_ministep_get_dataset(ministep, dataset_name);
+    stringlist_type * dataset_keys = local_dataset_alloc_keys(dataset);
+
+    for (int i = 0; i < stringlist_get_size(dataset_keys); i++) {
+      const char * key = stringlist_iget(dataset_keys, i);
+      if (!stringlist_contains(keys, key))
+        stringlist_append_copy(keys, key);
+    }
+    stringlist_free(dataset_keys);
+  }
+  hash_iter_free(dataset_iter);
+  return keys;
+}
+
+
+static bool enkf_main_ministep_keys_overlap(const stringlist_type * keys1, const stringlist_type * keys2) {
+  for (int i = 0; i < stringlist_get_size(keys1); i++)
+    if (stringlist_contains(keys2, stringlist_iget(keys1, i)))
+      return true;
+
+  return false;
+}
+
+
+static void * enkf_main_analysis_update_mt(void * arg) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast(arg);
+  enkf_main_type * enkf_main = enkf_main_safe_cast(arg_pack_iget_ptr(arg_pack, 0));
+  enkf_fs_type * target_fs = arg_pack_iget_ptr(arg_pack, 1);
+  const bool_vector_type * ens_mask = arg_pack_iget_const_ptr(arg_pack, 2);
+  int target_step = arg_pack_iget_int(arg_pack, 3);
+  hash_type * use_count = arg_pack_iget_ptr(arg_pack, 4);
+  run_mode_type run_mode = arg_pack_iget_int(arg_pack, 5);
+  int step1 = arg_pack_iget_int(arg_pack, 6);
+  int step2 = arg_pack_iget_int(arg_pack, 7);
+  const local_ministep_type * ministep = arg_pack_iget_const_ptr(arg_pack, 8);
+  const meas_data_type * meas_data = arg_pack_iget_const_ptr(arg_pack, 9);
+  obs_data_type * obs_data = arg_pack_iget_ptr(arg_pack, 10);
+  rng_type * rng = arg_pack_iget_ptr(arg_pack, 11);
+  int cpu_threads = arg_pack_iget_int(arg_pack, 12);
+
+  enkf_main_analysis_update(enkf_main, target_fs, ens_mask, target_step, use_count, run_mode,
+                            step1, step2, ministep, meas_data, obs_data, rng, cpu_threads);
+  return NULL;
+}
+
+
+/*
+  Updates the ministeps of the updatestep concurrently:
+
+  1. All the ministeps are measured, in order and on the calling
+     thread; the observation scaling and the log output are therefor
+     the same as in the serial update. Every ministep gets its own
+     rng, see enkf_main_alloc_ministep_rng().
+
+  2. The ministeps are assigned a level: a ministep which updates a
+     parameter which is also updated by an earlier ministep gets a
+     level one higher than that ministep. The ministeps of one level
+     update disjoint sets of parameters and are run concurrently; the
+     levels are run one after another.
+
+  Since overlapping ministeps are run in ministep order, and every
+  ministep has its own random stream, the result does not depend on
+  the number of threads; it does differ from the serial update, which
+  draws all the ministeps from the shared rng. If one of the analysis modules does not
+  support concurrent updates the ministeps are run one at a time.
+
+  The threads which update one ministep are divided among the
+  concurrent ministeps, so the update uses UPDATE_CPU_THREADS threads
+  in total, or ministep_threads if that is larger.
+*/
+
+static void enkf_main_update_ministeps_mt(enkf_main_type * enkf_main,
+                                          response_cache_type * response_cache,
+                                          enkf_fs_type * target_fs,
+                                          const int_vector_type * step_list,
+                                          int target_step,
+                                          run_mode_type run_mode,
+                                          const local_updatestep_type * updatestep,
+                                          const bool_vector_type * ens_mask,
+                                          const int_vector_type * ens_active_list,
+                                          hash_type * use_count,
+                                          FILE * log_stream,
+                                          int ministep_threads) {
+
+  const analysis_config_type * analysis_config = enkf_main_get_analysis_config(enkf_main);
+  const int num_ministep = local_updatestep_get_num_ministep(updatestep);
+  double global_std_scaling = analysis_config_get_global_std_scaling(analysis_config);
+  vector_type * arg_list = vector_alloc_new();
+  vector_type * key_list = vector_alloc_new();
+  int_vector_type * level = int_vector_alloc(num_ministep, -1);
+  int num_levels = 0;
+  bool thread_safe = true;
+
+  for (int ministep_nr = 0; ministep_nr < num_ministep; ministep_nr++) {
+    local_ministep_type * ministep = local_updatestep_iget_ministep(updatestep, ministep_nr);
+    meas_data_type * meas_data = meas_data_alloc(ens_mask);
+    obs_data_type * obs_data = obs_data_alloc(global_std_scaling);
+    rng_type * rng = enkf_main_alloc_ministep_rng(enkf_main);
+    stringlist_type * keys = enkf_main_alloc_ministep_keys(ministep);
+    arg_pack_type * arg_pack = arg_pack_alloc();
+
+    arg_pack_append_ptr(arg_pack, enkf_main);
+    arg_pack_append_ptr(arg_pack, target_fs);
+    arg_pack_append_const_ptr(arg_pack, ens_mask);
+    arg_pack_append_int(arg_pack, target_step);
+    arg_pack_append_ptr(arg_pack, use_count);
+    arg_pack_append_int(arg_pack, run_mode);
+    arg_pack_append_int(arg_pack, int_vector_get_first(step_list));
+    arg_pack_append_int(arg_pack, int_vector_get_last(step_list));
+    arg_pack_append_const_ptr(arg_pack, ministep);
+    arg_pack_append_ptr(arg_pack, meas_data);
+    arg_pack_append_ptr(arg_pack, obs_data);
+    arg_pack_append_ptr(arg_pack, rng);
+    vector_append_ref(arg_list, arg_pack);
+    vector_append_owned_ref(key_list, keys, stringlist_free__);
+
+    if (enkf_main_measure_ministep(enkf_main, response_cache, step_list, ens_active_list,
+                                   ministep, meas_data, obs_data, log_stream)) {
+      analysis_module_type * module = analysis_config_get_active_module(analysis_config);
+      int ministep_level = 0;
+
+      if (local_ministep_has_analysis_module(ministep))
+        module = local_ministep_get_analysis_module(ministep);
+
+      if (!analysis_module_check_option(module, ANALYSIS_THREAD_SAFE))
+        thread_safe = false;
+
+      for (int prev_nr = 0; prev_nr < ministep_nr; prev_nr++) {
+        int prev_level = int_vector_iget(level, prev_nr);
+        if ((prev_level >= 0) && enkf_main_ministep_keys_overlap(vector_iget_const(key_list, prev_nr), keys))
+          ministep_level = util_int_max(ministep_level, prev_level + 1);
+      }
+      int_vector_iset(level, ministep_nr, ministep_level);
+      num_levels = util_int_max(num_levels, ministep_level + 1);
+    } else if (target_fs != response_cache_get_fs(response_cache))
+      res_log_ferror("No active observations/parameters for MINISTEP: %s.",
+                     local_ministep_get_name(ministep));
+  }
+
+  {
+    int cpu_threads = thread_safe ? util_int_max(1, UPDATE_CPU_THREADS / ministep_threads) : UPDATE_CPU_THREADS;
+    for (int ministep_nr = 0; ministep_nr < num_ministep; ministep_nr++)
+      arg_pack_append_int(vector_iget(arg_list, ministep_nr), cpu_threads);
+  }
+
+  if (thread_safe) {
+    thread_pool_type * tp = thread_pool_alloc(ministep_threads, true);
+    res_log_finfo("Updating %d ministeps in %d levels with %d threads", num_ministep, num_levels, ministep_threads);
+    for (int ilevel = 0; ilevel < num_levels; ilevel++) {
+      for (int ministep_nr = 0; ministep_nr < num_ministep; ministep_nr++)
+        if (int_vector_iget(level, ministep_nr) == ilevel)
+          thread_pool_add_job(tp, enkf_main_analysis_update_mt, vector_iget(arg_list, ministep_nr));
+
+      thread_pool_join(tp);
+      thread_pool_restart(tp);
+    }
+    thread_pool_free(tp);
+  } else {
+    for (int ministep_nr = 0; ministep_nr < num_ministep; ministep_nr++)
+      if (int_vector_iget(level, ministep_nr) >= 0)
+        enkf_main_analysis_update_mt(vector_iget(arg_list, ministep_nr));
+  }
+
+  for (int ministep_nr = 0; ministep_nr < num_ministep; ministep_nr++) {
+    arg_pack_type * arg_pack = vector_iget(arg_list, ministep_nr);
+    meas_data_free(arg_pack_iget_ptr(arg_pack, 9));
+    obs_data_free(arg_pack_iget_ptr(arg_pack, 10));
+    rng_free(arg_pack_iget_ptr(arg_pack, 11));
+    arg_pack_free(arg_pack);
+  }
+  int_vector_free(level);
+  vector_free(key_list);
+  vector_free(arg_list);
+}
+
+
 /**
  * This is THE ENKF update function.  It should only be called from enkf_main_UPDATE.
  */
@@ -932,6 +1179,10 @@ static void enkf_main_update__(enkf_main_type * enkf_main, const int_vector_type
   state_map_type * source_state_map = enkf_fs_get_state_map( source_fs );
 
   state_map_select_matching(source_state_map, ens_mask, STATE_HAS_DATA);
+  if (analysis_config_get_update_profile(analysis_config))
+    enkf_main->update_profile = update_profile_alloc(enkf_fs_get_case_name(target_fs),
+                                                     int_vector_get_first(step_list),
+                                                     int_vector_get_last(step_list));
   {
     FILE * log_stream = enkf_main_log_step_list(enkf_main, step_list);
     double global_std_scaling = analysis_config_get_global_std_scaling(analysis_config);
@@ -943,65 +1194,44 @@ static void enkf_main_update__(enkf_main_type * enkf_main, const int_vector_type
       Copy all the parameter nodes from source case to target case;
       nodes which are updated will be fetched from the new target
       case, and nodes which are not updated will be manually copied
-      over there.
+      over there. The enkf_node_copy() function will copy the stored
+      bytes directly whenever possible, without deserializing the
+      nodes.
     */
     if (target_fs != source_fs) {
       const ensemble_config_type * ensemble_config = enkf_main_get_ensemble_config(enkf_main);
       stringlist_type * param_keys = ensemble_config_alloc_keylist_from_var_type(ensemble_config, PARAMETER);
+      update_phase_type * phase = update_profile_start_phase(enkf_main->update_profile, target_fs, NULL, NULL, "copy_parameters");
       for (int i = 0; i < stringlist_get_size(param_keys); i++) {
         const char * key = stringlist_iget(param_keys, i);
         enkf_config_node_type * config_node = ensemble_config_get_node(ensemble_config, key);
-        enkf_node_type * data_node = enkf_node_alloc(config_node);
         for (int j = 0; j < int_vector_size(ens_active_list); j++) {
           node_id_type node_id = { .iens = int_vector_iget(ens_active_list, j), .report_step = 0 };
-          enkf_node_load(data_node, source_fs, node_id);
-          enkf_node_store(data_node, target_fs, false, node_id);
+          enkf_node_copy(config_node, source_fs, target_fs, node_id, node_id);
         }
-        enkf_node_free(data_node);
       }
+      update_phase_set_dims(phase, stringlist_get_size(param_keys), int_vector_size(ens_active_list));
+      update_phase_stop(phase, target_fs);
       stringlist_free(param_keys);
     }
 
     {
       hash_type * use_count = hash_alloc();
       int current_step = int_vector_get_last(step_list);
-
-
-      /* Looping over local analysis ministep */
-      for (int ministep_nr = 0; ministep_nr < local_updatestep_get_num_ministep(updatestep); ministep_nr++) {
-        local_ministep_type * ministep = local_updatestep_iget_ministep(updatestep, ministep_nr);
-        local_obsdata_type * obsdata = local_ministep_get_obsdata(ministep);
-
-        obs_data_reset(obs_data);
-        meas_data_reset(meas_data);
-
-        /*
-          Temporarily we will just force the timestep from the input
-          argument onto the obsdata instance; in the future the
-          obsdata should hold it's own here.
-        */
-        local_obsdata_reset_tstep_list(obsdata, step_list);
-
-        const analysis_config_type * analysis_config = enkf_main_get_analysis_config(enkf_main);
-        if (analysis_config_get_std_scale_correlated_obs(analysis_config)) {
-          double scale_factor = enkf_obs_scale_correlated_std(enkf_main->obs, source_fs,
-                                                              ens_active_list, obsdata);
-          res_log_finfo("Scaling standard deviation in obdsata set:%s with %g",
-                        local_obsdata_get_name(obsdata), scale_factor);
-        }
-        enkf_obs_get_obs_and_measure_data(enkf_main->obs, source_fs, obsdata,
-                                          ens_active_list, meas_data, obs_data);
-
-        double alpha = analysis_config_get_alpha(analysis_config);
-        double std_cutoff = analysis_config_get_std_cutoff(analysis_config);
-        enkf_analysis_deactivate_outliers(obs_data, meas_data,
-                                          std_cutoff, alpha, enkf_main->verbose);
-
-        if (enkf_main->verbose)
-          enkf_analysis_fprintf_obs_summary(obs_data, meas_data, step_list, local_ministep_get_name(ministep), stdout);
-        enkf_analysis_fprintf_obs_summary(obs_data, meas_data, step_list, local_ministep_get_name(ministep), log_stream);
-
-        if ((obs_data_get_active_size(obs_data) > 0) && (meas_data_get_active_obs_size(meas_data) > 0))
+      int ministep_threads = analysis_config_get_ministep_threads(analysis_config);
+      response_cache_type * response_cache = response_cache_alloc(source_fs);
+
+      if (ministep_threads > 1)
+        enkf_main_update_ministeps_mt(enkf_main, response_cache, target_fs, step_list, target_step,
+                                      run_mode, updatestep, ens_mask, ens_active_list, use_count,
+                                      log_stream, ministep_threads);
+      else {
+        /* Looping over local analysis ministep */
+        for (int ministep_nr = 0; ministep_nr < local_updatestep_get_num_ministep(updatestep); ministep_nr++) {
+          local_ministep_type * ministep = local_updatestep_iget_ministep(updatestep, ministep_nr);
+
+          if (enkf_main_measure_ministep(enkf_main, response_cache, step_list, ens_active_list,
+                                         ministep, meas_data, obs_data, log_stream))
             enkf_main_analysis_update(enkf_main,
                                       target_fs,
                                       ens_mask,
@@ -1012,13 +1242,21 @@ static void enkf_main_update__(enkf_main_type * enkf_main, const int_vector_type
                                       current_step,
                                       ministep,
                                       meas_data,
-                                      obs_data);
-        else if (target_fs != source_fs)
-          res_log_ferror("No active observations/parameters for MINISTEP: %s.",
-                         local_ministep_get_name(ministep));
+                                      obs_data,
+                                      enkf_main->shared_rng,
+                                      UPDATE_CPU_THREADS);
+          else if (target_fs != source_fs)
+            res_log_ferror("No active observations/parameters for MINISTEP: %s.",
+                           local_ministep_get_name(ministep));
+        }
       }
+      response_cache_free(response_cache);
 
-      enkf_main_inflate(enkf_main, source_fs, target_fs, current_step, use_count);
+      {
+        update_phase_type * phase = update_profile_start_phase(enkf_main->update_profile, target_fs, NULL, NULL, "inflate");
+        enkf_main_inflate(enkf_main, source_fs, target_fs, current_step, use_count);
+        update_phase_stop(phase, target_fs);
+      }
       hash_free(use_count);
     }
 
@@ -1038,10 +1276,106 @@ static void enkf_main_update__(enkf_main_type * enkf_main, const int_vector_type
     meas_data_free(meas_data);
     fclose(log_stream);
   }
+
+  if (enkf_main->update_profile) {
+    char * log_file = enkf_main_alloc_update_log_file(enkf_main, step_list);
+    char * profile_file = util_alloc_sprintf("%s.json", log_file);
+
+    update_profile_fwrite_json(enkf_main->update_profile, profile_file);
+    res_log_finfo("Update profile written to: %s", profile_file);
+    update_profile_free(enkf_main->update_profile);
+    enkf_main->update_profile = NULL;
+
+    free(profile_file);
+    free(log_file);
+  }
   bool_vector_free( ens_mask);
 }
 
 
+/*
+  Returns a distance_localization instance with the positions of the
+  active observations in @obs_data, or NULL if the automatic
+  localization is not enabled. The localization works on the X
+  matrix, and can not be used with modules which update A directly.
+*/
+
+static distance_localization_type * enkf_main_alloc_localization( enkf_main_type * enkf_main ,
+                                                                  const analysis_module_type * module ,
+                                                                  const obs_data_type * obs_data) {
+  const analysis_config_type * analysis_config = enkf_main_get_analysis_config( enkf_main );
+  double radius = analysis_config_get_localization_radius( analysis_config );
+  distance_localization_type * localization;
+
+  if (radius <= 0)
+    return NULL;
+
+  if (analysis_module_check_option( module , ANALYSIS_UPDATE_A) || analysis_module_check_option( module , ANALYSIS_USE_A)) {
+    res_log_fwarning("The analysis module %s does not use an X matrix - LOCALIZATION_RADIUS is ignored.",
+                     analysis_module_get_name( module ));
+    return NULL;
+  }
+
+  localization = distance_localization_alloc( radius , analysis_config_get_localization_tile_size( analysis_config ));
+  distance_localization_add_obs_data( localization , enkf_main->obs , obs_data ,
+                                      ecl_config_get_grid( enkf_main_get_ecl_config( enkf_main )));
+  return localization;
+}
+
+
+/*
+  Replaces A = A*X for the serialized @dataset when the automatic
+  localization is enabled: the FIELD nodes are updated tile by tile
+  with localized X matrices, the other nodes with the global X.
+*/
+
+static void enkf_main_localized_matmul( const enkf_main_type * enkf_main ,
+                                        const distance_localization_type * localization ,
+                                        const local_dataset_type * dataset ,
+                                        const int * active_size ,
+                                        const int * row_offset ,
+                                        matrix_type * A ,
+                                        const matrix_type * X ,
+                                        analysis_module_type * module ,
+                                        const matrix_type * S ,
+                                        const obs_covar_type * R ,
+                                        const matrix_type * dObs ,
+                                        const matrix_type * E ,
+                                        const matrix_type * D ,
+                                        rng_type * rng ,
+                                        thread_pool_type * tp ,
+                                        int num_threads) {
+
+  const ensemble_config_type * ens_config = enkf_main_get_ensemble_config( enkf_main );
+  stringlist_type * update_keys = local_dataset_alloc_keys( dataset );
+  const int ens_size = matrix_get_columns( A );
+
+  for (int ikw = 0; ikw < stringlist_get_size( update_keys ); ikw++) {
+    if (active_size[ikw] > 0) {
+      const char * key = stringlist_iget( update_keys , ikw );
+      const enkf_config_node_type * config_node = ensemble_config_get_node( ens_config , key );
+
+      if (enkf_config_node_get_impl_type( config_node ) == FIELD) {
+        const field_config_type * field_config = enkf_config_node_get_ref( config_node );
+        int num_tiles = distance_localization_update_field( localization ,
+                                                            field_config_get_grid( field_config ) ,
+                                                            local_dataset_get_node_active_list( dataset , key ) ,
+                                                            A , row_offset[ikw] , active_size[ikw] ,
+                                                            module , S , R , dObs , E , D , rng ,
+                                                            num_threads );
+        res_log_fdebug("Localized update of %s: %d cells in %d tiles", key , active_size[ikw] , num_tiles);
+      } else {
+        matrix_type * localA = matrix_alloc_sub_copy( A , row_offset[ikw] , 0 , active_size[ikw] , ens_size );
+        matrix_inplace_matmul_mt2( localA , X , tp );
+        matrix_copy_block( A , row_offset[ikw] , 0 , active_size[ikw] , ens_size , localA , 0 , 0 );
+        matrix_free( localA );
+      }
+    }
+  }
+  stringlist_free( update_keys );
+}
+
+
 static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
                                        enkf_fs_type * target_fs ,
                                        const bool_vector_type * ens_mask ,
@@ -1052,22 +1386,38 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
                                        int step2 ,
                                        const local_ministep_type * ministep ,
                                        const meas_data_type * forecast ,
-                                       obs_data_type * obs_data) {
+                                       obs_data_type * obs_data,
+                                       rng_type * rng,
+                                       int cpu_threads) {
 
-  const int cpu_threads       = 4;
   const int matrix_start_size = 250000;
+  const char * ministep_name  = local_ministep_get_name( ministep );
+  update_profile_type * profile = enkf_main->update_profile;
+  update_phase_type * phase;
   thread_pool_type * tp       = thread_pool_alloc( cpu_threads , false );
   int active_ens_size   = meas_data_get_active_ens_size( forecast );
   int active_size       = obs_data_get_active_size( obs_data );
   matrix_type * X       = matrix_alloc( active_ens_size , active_ens_size );
-  matrix_type * S       = meas_data_allocS( forecast );
-  matrix_type * R       = obs_data_allocR( obs_data );
-  matrix_type * dObs    = obs_data_allocdObs( obs_data );
+  matrix_type * S;
+  obs_covar_type * R;
+  matrix_type * dObs;
   matrix_type * A       = matrix_alloc( matrix_start_size , active_ens_size );
   matrix_type * E       = NULL;
   matrix_type * D       = NULL;
   matrix_type * localA  = NULL;
   int_vector_type * iens_active_index = bool_vector_alloc_active_index_list(ens_mask , -1);
+  distance_localization_type * localization = NULL;
+
+  phase = update_profile_start_phase( profile , NULL , ministep_name , NULL , "allocS");
+  S = meas_data_allocS( forecast );
+  update_phase_set_dims( phase , matrix_get_rows( S ) , matrix_get_columns( S ));
+  update_phase_stop( phase , NULL );
+
+  phase = update_profile_start_phase( profile , NULL , ministep_name , NULL , "allocR");
+  R    = obs_data_alloc_covar( obs_data );
+  dObs = obs_data_allocdObs( obs_data );
+  update_phase_set_dims( phase , obs_covar_get_size( R ) , obs_covar_get_size( R ));
+  update_phase_stop( phase , NULL );
 
   const analysis_config_type * analysis_config = enkf_main_get_analysis_config(enkf_main);
   analysis_module_type * module = analysis_config_get_active_module(analysis_config);
@@ -1076,26 +1426,52 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
 
   assert_matrix_size(X , "X" , active_ens_size , active_ens_size);
   assert_matrix_size(S , "S" , active_size , active_ens_size);
-  assert_matrix_size(R , "R" , active_size , active_size);
+  if (obs_covar_get_size( R ) != active_size)
+    util_abort("%s: size mismatch R:%d  - expected:%d \n",__func__ , obs_covar_get_size( R ) , active_size);
   assert_size_equal( enkf_main_get_ensemble_size( enkf_main ) , ens_mask );
 
   if (analysis_module_check_option( module , ANALYSIS_NEED_ED)) {
-    E = obs_data_allocE( obs_data , enkf_main->shared_rng , active_ens_size );
+    const counter_rng_type * counter_rng = rng_manager_get_counter_rng( enkf_main->rng_manager );
+    phase = update_profile_start_phase( profile , NULL , ministep_name , NULL , "allocE");
+    if (counter_rng) {
+      int_vector_type * iens_list = bool_vector_alloc_active_list( ens_mask );
+      /*
+        The stream is keyed by the target case as well as the
+        ministep; the iterations of ES-MDA and IES are written to
+        different cases and must get different perturbations.
+      */
+      char * stream_name = util_alloc_sprintf( "%s/%s" , enkf_fs_get_case_name( target_fs ) , ministep_name );
+      unsigned int stream = counter_rng_stream_id( RNG_STREAM_OBS_PERTURBATION , stream_name );
+      E = obs_data_allocE_counter( obs_data , counter_rng , stream , iens_list , cpu_threads );
+      free( stream_name );
+      int_vector_free( iens_list );
+    } else
+      E = obs_data_allocE( obs_data , rng , active_ens_size );
+    update_phase_set_dims( phase , matrix_get_rows( E ) , matrix_get_columns( E ));
+    update_phase_stop( phase , NULL );
+
+    phase = update_profile_start_phase( profile , NULL , ministep_name , NULL , "allocD");
     D = obs_data_allocD( obs_data , E , S );
+    update_phase_set_dims( phase , matrix_get_rows( D ) , matrix_get_columns( D ));
+    update_phase_stop( phase , NULL );
 
     assert_matrix_size( E , "E" , active_size , active_ens_size);
     assert_matrix_size( D , "D" , active_size , active_ens_size);
   }
 
   if (analysis_module_check_option( module , ANALYSIS_SCALE_DATA))
-    obs_data_scale( obs_data , S , E , D , R , dObs );
+    obs_data_scale_covar( obs_data , S , E , D , R , dObs );
 
   if (analysis_module_check_option( module , ANALYSIS_USE_A) || analysis_module_check_option(module , ANALYSIS_UPDATE_A))
     localA = A;
 
+  localization = enkf_main_alloc_localization( enkf_main , module , obs_data );
+
   /*****************************************************************/
 
-  analysis_module_init_update( module , ens_mask , S , R , dObs , E , D, enkf_main->shared_rng);
+  phase = update_profile_start_phase( profile , NULL , ministep_name , NULL , "init_update");
+  analysis_module_init_update_covar( module , ens_mask , S , R , dObs , E , D, rng);
+  update_phase_stop( phase , NULL );
   {
     hash_iter_type * dataset_iter = local_ministep_alloc_dataset_iter( ministep );
     serialize_info_type * serialize_info = serialize_info_alloc( target_fs, //src_fs - we have already copied the parameters from the src_fs to the target_fs
@@ -1135,8 +1511,12 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
       double_vector_free( singular_values );
     }
 
-    if (localA == NULL)
-      analysis_module_initX( module , X , NULL , S , R , dObs , E , D, enkf_main->shared_rng);
+    if (localA == NULL) {
+      phase = update_profile_start_phase( profile , NULL , ministep_name , NULL , "initX");
+      analysis_module_initX_covar( module , X , NULL , S , R , dObs , E , D, rng);
+      update_phase_set_dims( phase , matrix_get_rows( X ) , matrix_get_columns( X ));
+      update_phase_stop( phase , NULL );
+    }
 
 
     while (!hash_iter_is_complete( dataset_iter )) {
@@ -1147,26 +1527,46 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
         int * row_offset  = util_calloc( local_dataset_get_size( dataset ) , sizeof * row_offset  );
         local_obsdata_type   * local_obsdata = local_ministep_get_obsdata( ministep );
 
+        phase = update_profile_start_phase( profile , target_fs , ministep_name , dataset_name , "serialize");
         enkf_main_serialize_dataset(enkf_main_get_ensemble_config(enkf_main), dataset , step2 ,  use_count , active_size , row_offset , tp , serialize_info);
+        update_phase_set_dims( phase , matrix_get_rows( A ) , matrix_get_columns( A ));
+        update_phase_stop( phase , target_fs );
         module_info_type * module_info = enkf_main_module_info_alloc(ministep, obs_data, dataset, local_obsdata, active_size , row_offset);
 
         if (analysis_module_check_option( module , ANALYSIS_UPDATE_A)){
+          phase = update_profile_start_phase( profile , NULL , ministep_name , dataset_name , "updateA");
           if (analysis_module_check_option( module , ANALYSIS_ITERABLE)){
-            analysis_module_updateA( module , localA , S , R , dObs , E , D , module_info, enkf_main->shared_rng);
+            analysis_module_updateA_covar( module , localA , S , R , dObs , E , D , module_info, rng);
           }
           else
-            analysis_module_updateA( module , localA , S , R , dObs , E , D , module_info, enkf_main->shared_rng);
+            analysis_module_updateA_covar( module , localA , S , R , dObs , E , D , module_info, rng);
+          update_phase_set_dims( phase , matrix_get_rows( A ) , matrix_get_columns( A ));
+          update_phase_stop( phase , NULL );
         }
         else {
           if (analysis_module_check_option( module , ANALYSIS_USE_A)){
-            analysis_module_initX( module , X , localA , S , R , dObs , E , D, enkf_main->shared_rng);
+            phase = update_profile_start_phase( profile , NULL , ministep_name , dataset_name , "initX");
+            analysis_module_initX_covar( module , X , localA , S , R , dObs , E , D, rng);
+            update_phase_set_dims( phase , matrix_get_rows( X ) , matrix_get_columns( X ));
+            update_phase_stop( phase , NULL );
           }
 
-          matrix_inplace_matmul_mt2( A , X , tp );
+          phase = update_profile_start_phase( profile , NULL , ministep_name , dataset_name ,
+                                              (localization != NULL) ? "localized_matmul" : "matmul");
+          if (localization != NULL)
+            enkf_main_localized_matmul( enkf_main , localization , dataset , active_size , row_offset ,
+                                        A , X , module , S , R , dObs , E , D , rng , tp , cpu_threads );
+          else
+            matrix_inplace_matmul_mt2( A , X , tp );
+          update_phase_set_dims( phase , matrix_get_rows( A ) , matrix_get_columns( A ));
+          update_phase_stop( phase , NULL );
         }
 
         // The deserialize also calls enkf_node_store() functions.
+        phase = update_profile_start_phase( profile , target_fs , ministep_name , dataset_name , "deserialize");
         enkf_main_deserialize_dataset( enkf_main_get_ensemble_config( enkf_main ) , dataset , active_size , row_offset , serialize_info , tp);
+        update_phase_set_dims( phase , matrix_get_rows( A ) , matrix_get_columns( A ));
+        update_phase_stop( phase , target_fs );
 
         free( active_size );
         free( row_offset );
@@ -1181,11 +1581,14 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
 
   /*****************************************************************/
 
+  if (localization != NULL)
+    distance_localization_free( localization );
+
   int_vector_free(iens_active_index);
   matrix_safe_free( E );
   matrix_safe_free( D );
   matrix_free( S );
-  matrix_free( R );
+  obs_covar_free( R );
   matrix_free( dObs );
   matrix_free( X );
   matrix_free( A );
@@ -1893,6 +2296,7 @@ static enkf_main_type * enkf_main_alloc_empty( ) {
   enkf_main->local_config       = NULL;
   enkf_main->rng_manager        = NULL;
   enkf_main->shared_rng         = NULL;
+  enkf_main->update_profile     = NULL;
   enkf_main->ens_size           = 0;
   enkf_main->res_config         = NULL;
   enkf_main->ranking_table      = ranking_table_alloc( 0 );
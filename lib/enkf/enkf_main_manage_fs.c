@@ -282,6 +282,162 @@ void enkf_main_init_case_from_existing_custom(const enkf_main_type * enkf_main,
 
 
 
+static void enkf_main_copy_realization( const enkf_main_type * enkf_main ,
+                                        enkf_fs_type * source_case_fs ,
+                                        enkf_fs_type * target_case_fs ,
+                                        const stringlist_type * param_list ,
+                                        int source_iens ,
+                                        int target_iens ) {
+  node_id_type src_id    = {.report_step = 0 , .iens = source_iens };
+  node_id_type target_id = {.report_step = 0 , .iens = target_iens };
+
+  for (int inode = 0; inode < stringlist_get_size( param_list ); inode++) {
+    enkf_config_node_type * config_node = ensemble_config_get_node( enkf_main_get_ensemble_config( enkf_main ) , stringlist_iget( param_list , inode ));
+    if (enkf_config_node_has_node( config_node , source_case_fs , src_id ))
+      enkf_node_copy( config_node , source_case_fs , target_case_fs , src_id , target_id );
+  }
+}
+
+
+static void * enkf_main_copy_realization_mt( void * void_arg ) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast( void_arg );
+  enkf_main_copy_realization( arg_pack_iget_const_ptr( arg_pack , 0 ),
+                              arg_pack_iget_ptr( arg_pack , 1 ),
+                              arg_pack_iget_ptr( arg_pack , 2 ),
+                              arg_pack_iget_const_ptr( arg_pack , 3 ),
+                              arg_pack_iget_int( arg_pack , 4 ),
+                              arg_pack_iget_int( arg_pack , 5 ));
+  return NULL;
+}
+
+
+/**
+   Initializes many realizations in one call: realization
+   target_iens[k] of @target_case_fs is initialized from realization
+   source_iens[k] of @source_case_fs, i.e. the same source realization
+   can be used for several targets. This is the bulk version of what
+   the BatchSimulator and the RPC server do for each simulation.
+
+   All the PARAMETER nodes except the nodes in @skip_keys are copied;
+   the nodes which can be copied as raw bytes (see enkf_node_copy())
+   are copied by a thread pool, with one job per realization. The
+   skipped nodes are typically the controls, which the caller has
+   stored with enkf_main_store_parameter_rows() in advance. Finally the
+   realizations are marked as initialized in the state map and the
+   target case is fsynced - once for the whole batch.
+*/
+
+void enkf_main_init_realizations_from_existing( enkf_main_type * enkf_main,
+                                                enkf_fs_type * source_case_fs,
+                                                enkf_fs_type * target_case_fs,
+                                                const int_vector_type * source_iens,
+                                                const int_vector_type * target_iens,
+                                                const stringlist_type * skip_keys) {
+  const int num_cpu = 4;
+  const int num_real = int_vector_size( target_iens );
+  ensemble_config_type * ensemble_config = enkf_main_get_ensemble_config( enkf_main );
+  stringlist_type * param_list = ensemble_config_alloc_keylist_from_var_type( ensemble_config , PARAMETER );
+  stringlist_type * raw_list = stringlist_alloc_new( );
+  stringlist_type * load_list = stringlist_alloc_new( );
+  state_map_type * target_state_map = enkf_fs_get_state_map( target_case_fs );
+
+  if (int_vector_size( source_iens ) != num_real)
+    util_abort("%s: size mismatch - %d source and %d target realizations \n",__func__ , int_vector_size( source_iens ) , num_real);
+
+  for (int inode = 0; inode < stringlist_get_size( param_list ); inode++) {
+    const char * key = stringlist_iget( param_list , inode );
+    if ((skip_keys != NULL) && stringlist_contains( skip_keys , key ))
+      continue;
+
+    if (enkf_node_raw_copy( ensemble_config_get_node( ensemble_config , key )))
+      stringlist_append_copy( raw_list , key );
+    else
+      stringlist_append_copy( load_list , key );
+  }
+
+  {
+    thread_pool_type * tp     = thread_pool_alloc( num_cpu , true );
+    arg_pack_type ** arg_list = util_calloc( num_real , sizeof * arg_list );
+
+    for (int k = 0; k < num_real; k++) {
+      arg_list[k] = arg_pack_alloc();
+      arg_pack_append_const_ptr( arg_list[k] , enkf_main );
+      arg_pack_append_ptr( arg_list[k] , source_case_fs );
+      arg_pack_append_ptr( arg_list[k] , target_case_fs );
+      arg_pack_append_const_ptr( arg_list[k] , raw_list );
+      arg_pack_append_int( arg_list[k] , int_vector_iget( source_iens , k ));
+      arg_pack_append_int( arg_list[k] , int_vector_iget( target_iens , k ));
+
+      thread_pool_add_job( tp , enkf_main_copy_realization_mt , arg_list[k] );
+    }
+    thread_pool_join( tp );
+
+    for (int k = 0; k < num_real; k++)
+      arg_pack_free( arg_list[k] );
+    free( arg_list );
+    thread_pool_free( tp );
+  }
+
+  /* Loading GEN_DATA and CONTAINER nodes updates the config; they are copied serially. */
+  for (int k = 0; k < num_real; k++)
+    enkf_main_copy_realization( enkf_main , source_case_fs , target_case_fs , load_list ,
+                                int_vector_iget( source_iens , k ) , int_vector_iget( target_iens , k ));
+
+  for (int k = 0; k < num_real; k++)
+    state_map_iset( target_state_map , int_vector_iget( target_iens , k ) , STATE_INITIALIZED );
+  enkf_fs_fsync( target_case_fs );
+
+  stringlist_free( load_list );
+  stringlist_free( raw_list );
+  stringlist_free( param_list );
+}
+
+
+/**
+   Stores the values for the parameter @key of realization
+   target_iens[k] from row k of @values, with one column for each of
+   the values in the parameter; only GEN_KW and EXT_PARAM parameters
+   are supported. The target case is not fsynced, see
+   enkf_main_init_realizations_from_existing().
+*/
+
+void enkf_main_store_parameter_rows( enkf_main_type * enkf_main,
+                                     enkf_fs_type * target_case_fs,
+                                     const char * key,
+                                     const int_vector_type * target_iens,
+                                     const matrix_type * values) {
+  const enkf_config_node_type * config_node = ensemble_config_get_node( enkf_main_get_ensemble_config( enkf_main ) , key );
+  ert_impl_type impl_type = enkf_config_node_get_impl_type( config_node );
+  enkf_node_type * node = enkf_node_alloc( config_node );
+  void * value_ptr = enkf_node_value_ptr( node );
+  int size;
+
+  if (impl_type == GEN_KW)
+    size = gen_kw_data_size( value_ptr );
+  else if (impl_type == EXT_PARAM)
+    size = ext_param_get_size( value_ptr );
+  else
+    util_abort("%s: parameter:%s is neither GEN_KW nor EXT_PARAM \n",__func__ , key);
+
+  if ((matrix_get_columns( values ) != size) || (matrix_get_rows( values ) != int_vector_size( target_iens )))
+    util_abort("%s: size mismatch for parameter:%s - expected %d x %d values, got %d x %d \n",__func__ , key ,
+               int_vector_size( target_iens ) , size , matrix_get_rows( values ) , matrix_get_columns( values ));
+
+  for (int k = 0; k < int_vector_size( target_iens ); k++) {
+    node_id_type node_id = {.report_step = 0 , .iens = int_vector_iget( target_iens , k ) };
+
+    for (int i = 0; i < size; i++) {
+      if (impl_type == GEN_KW)
+        gen_kw_data_iset( value_ptr , i , matrix_iget( values , k , i ));
+      else
+        ext_param_iset( value_ptr , i , matrix_iget( values , k , i ));
+    }
+    enkf_node_store( node , target_case_fs , true , node_id );
+  }
+  enkf_node_free( node );
+}
+
+
 /**
    This function will go through the filesystem and check that we have
    initial data for all parameters and all realizations. If the second
@@ -322,8 +478,31 @@ static bool enkf_main_case_is_initialized__( const enkf_main_type * enkf_main ,
 
 
 
+/*
+  Checking whether a case is initialized is typically done when
+  browsing cases, and only looks at a few nodes per realization; the
+  case is therefore opened with a lazy read-only mount, which does not
+  mount the shards up front or lock the case. A case mounted with
+  enkf_main_mount_alt_fs() is mounted eagerly, with the dynamic
+  results preloaded, since it will be used for simulations and
+  updates.
+*/
+
+static enkf_fs_type * enkf_main_mount_alt_fs_readonly(const enkf_main_type * enkf_main , const char * case_path) {
+  if (enkf_main_case_is_current( enkf_main , case_path )) {
+    enkf_fs_incref( enkf_main->dbase );
+    return enkf_main->dbase;
+  } else {
+    char * mount_point = enkf_main_alloc_mount_point( enkf_main , case_path );
+    enkf_fs_type * fs = enkf_fs_mount_lazy( mount_point , true );
+    free( mount_point );
+    return fs;
+  }
+}
+
+
 bool enkf_main_case_is_initialized( const enkf_main_type * enkf_main , const char * case_name ,  bool_vector_type * __mask) {
-  enkf_fs_type * fs = enkf_main_mount_alt_fs(enkf_main , case_name , false );
+  enkf_fs_type * fs = enkf_main_mount_alt_fs_readonly( enkf_main , case_name );
   if (fs) {
     bool initialized = enkf_main_case_is_initialized__(enkf_main , fs , __mask);
     enkf_fs_decref( fs );
@@ -490,6 +669,33 @@ const char * enkf_main_get_current_fs( const enkf_main_type * enkf_main ) {
 */
 
 
+/*
+  Applies the storage settings from the configuration to a newly
+  mounted case.
+*/
+
+static void enkf_main_configure_fs( const enkf_main_type * enkf_main , enkf_fs_type * fs ) {
+  const model_config_type * model_config = enkf_main_get_model_config( enkf_main );
+
+  if (model_config_get_summary_store( model_config ) && !enkf_fs_is_read_only( fs ))
+    enkf_fs_enable_summary_store( fs );
+
+  if (!enkf_fs_is_read_only( fs )) {
+    enkf_fs_set_fsync_policy( fs ,
+                              model_config_get_fsync_interval( model_config ) ,
+                              (size_t) model_config_get_fsync_mb( model_config ) * 1024 * 1024 ,
+                              model_config_get_fsync_seconds( model_config ));
+    enkf_fs_set_codec( fs , model_config_get_codec( model_config ));
+  }
+
+  {
+    summary_store_type * summary_store = enkf_fs_get_summary_store( fs );
+    if (summary_store)
+      summary_store_set_max_pending( summary_store , (size_t) model_config_get_summary_store_max_pending( model_config ) * 1024 * 1024 );
+  }
+}
+
+
 enkf_fs_type * enkf_main_mount_alt_fs(const enkf_main_type * enkf_main , const char * case_path , bool create) {
   if (enkf_main_case_is_current( enkf_main , case_path )) {
     // Fast path - we just return a reference to the currently selected case;
@@ -512,6 +718,8 @@ enkf_fs_type * enkf_main_mount_alt_fs(const enkf_main_type * enkf_main , const c
         const model_config_type * model_config = enkf_main_get_model_config( enkf_main );
         const ecl_sum_type * refcase = model_config_get_refcase( model_config );
 
+        enkf_main_configure_fs( enkf_main , new_fs );
+
         if (refcase) {
           time_map_type * time_map = enkf_fs_get_time_map( new_fs );
           if (time_map_attach_refcase( time_map , refcase))
@@ -20,11 +20,13 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 
 #include <ert/util/util.h>
 #include <ert/util/buffer.h>
 #include <ert/util/rng.h>
 #include <ert/util/vector.h>
+#include <ert/util/double_vector.h>
 #include <ert/util/type_macros.h>
 
 #include <ert/res_util/path_fmt.h>
@@ -445,14 +447,35 @@ bool enkf_node_forward_load_vector(enkf_node_type *enkf_node , const forward_loa
 
 
 
-static bool enkf_node_store_buffer( enkf_node_type * enkf_node , enkf_fs_type * fs , int report_step , int iens) {
+static bool enkf_node_write_buffer__( enkf_node_type * enkf_node , buffer_type * buffer , int report_step ) {
   FUNC_ASSERT(enkf_node->write_to_buffer);
+  buffer_fwrite_time_t( buffer , time(NULL));
+  return enkf_node->write_to_buffer(enkf_node->data , buffer , report_step );
+}
+
+
+/**
+   Serializes a node with vector storage to @buffer, in the format
+   used by enkf_node_store_vector(); can be used to collect the
+   buffers of many nodes and write them with
+   enkf_fs_fwrite_vectors(). Returns false if the node did not have
+   any data to write.
+*/
+
+bool enkf_node_write_vector_buffer( enkf_node_type * enkf_node , buffer_type * buffer ) {
+  if (!enkf_node->vector_storage)
+    util_abort("%s: internal error - function should only be called by nodes with vector storage.\n",__func__);
+
+  return enkf_node_write_buffer__( enkf_node , buffer , -1 );
+}
+
+
+static bool enkf_node_store_buffer( enkf_node_type * enkf_node , enkf_fs_type * fs , int report_step , int iens) {
   {
     bool data_written;
     buffer_type * buffer = buffer_alloc( 100 );
     const enkf_config_node_type * config_node = enkf_node_get_config( enkf_node );
-    buffer_fwrite_time_t( buffer , time(NULL));
-    data_written = enkf_node->write_to_buffer(enkf_node->data , buffer , report_step );
+    data_written = enkf_node_write_buffer__( enkf_node , buffer , report_step );
     if (data_written) {
       const char * node_key = enkf_config_node_get_key( config_node );
       enkf_var_type var_type = enkf_config_node_get_var_type( config_node );
@@ -512,6 +535,65 @@ bool enkf_node_try_load(enkf_node_type *enkf_node , enkf_fs_type * fs , node_id_
 }
 
 
+/**
+   Loads the GEN_DATA node @config_node at @report_step for all the
+   realizations in @iens_list, and stores the values in @data with one
+   row per realization, i.e. element i of realization iens_list[k] is
+   stored at index k * row_size + i. The row size is the largest data
+   size found, and is returned.
+
+   The data size of each realization is stored in @data_size; the
+   realizations which could not be loaded get data size -1. The unused
+   elements of @data are NaN.
+*/
+
+int enkf_node_load_gen_data_rows( const enkf_config_node_type * config_node , enkf_fs_type * fs , int report_step ,
+                                  const int_vector_type * iens_list , double_vector_type * data , int_vector_type * data_size) {
+  const int num_rows = int_vector_size( iens_list );
+  enkf_node_type * node = enkf_node_alloc( config_node );
+  double_vector_type ** rows = util_calloc( num_rows , sizeof * rows );
+  int row_size = 0;
+
+  if (enkf_config_node_get_impl_type( config_node ) != GEN_DATA)
+    util_abort("%s: node:%s is not GEN_DATA \n",__func__ , enkf_config_node_get_key( config_node ));
+
+  int_vector_reset( data_size );
+  for (int k = 0; k < num_rows; k++) {
+    node_id_type node_id = {.report_step = report_step , .iens = int_vector_iget( iens_list , k )};
+    double_vector_type * row = NULL;
+
+    if (enkf_node_try_load( node , fs , node_id )) {
+      row = double_vector_alloc( 0 , 0 );
+      gen_data_export_data( enkf_node_value_ptr( node ) , row );
+      row_size = util_int_max( row_size , double_vector_size( row ));
+      int_vector_append( data_size , double_vector_size( row ));
+    } else
+      int_vector_append( data_size , -1 );
+
+    rows[k] = row;
+  }
+
+  double_vector_reset( data );
+  double_vector_set_default( data , NAN );
+  if (num_rows > 0 && row_size > 0)
+    double_vector_iset( data , num_rows * row_size - 1 , NAN );
+
+  {
+    double * data_ptr = double_vector_get_ptr( data );
+    for (int k = 0; k < num_rows; k++) {
+      if (rows[k] != NULL) {
+        memcpy( &data_ptr[ k * row_size ] , double_vector_get_const_ptr( rows[k] ) , double_vector_size( rows[k] ) * sizeof * data_ptr );
+        double_vector_free( rows[k] );
+      }
+    }
+  }
+
+  free( rows );
+  enkf_node_free( node );
+  return row_size;
+}
+
+
 static void enkf_node_buffer_load( enkf_node_type * enkf_node , enkf_fs_type * fs , int report_step , int iens) {
   FUNC_ASSERT(enkf_node->read_from_buffer);
   {
@@ -607,31 +689,97 @@ enkf_node_type * enkf_node_load_alloc( const enkf_config_node_type * config_node
 
 
 
+/**
+   Nodes which have a self contained payload can be copied as raw
+   bytes between the cases with enkf_fs_copy_node(), without
+   deserializing and serializing them. GEN_DATA nodes must be loaded
+   to keep the size information in the config up to date, and
+   CONTAINER nodes do not have a stored payload of their own.
+*/
+
+bool enkf_node_raw_copy( const enkf_config_node_type * config_node ) {
+  ert_impl_type impl_type = enkf_config_node_get_impl_type( config_node );
+  return (impl_type != GEN_DATA) && (impl_type != CONTAINER);
+}
+
+
+/*
+  Copies the value at src_id.report_step into the vector of the target
+  realization at target_id.report_step; the other elements of the
+  target vector are left as they are. SUMMARY is the only
+  implementation with vector storage.
+*/
+
+static void enkf_node_copy_vector_step(const enkf_config_node_type * config_node ,
+                                       enkf_fs_type * src_case,
+                                       enkf_fs_type * target_case,
+                                       node_id_type src_id ,
+                                       node_id_type target_id) {
+
+  enkf_node_type * src_node    = enkf_node_load_alloc( config_node , src_case , src_id );
+  enkf_node_type * target_node = enkf_node_alloc( config_node );
+
+  enkf_node_try_load_vector( target_node , target_case , target_id.iens );
+  {
+    const summary_type * src_summary = summary_safe_cast_const( enkf_node_value_ptr( src_node ));
+    summary_type * target_summary    = summary_safe_cast( enkf_node_value_ptr( target_node ));
+
+    summary_set( target_summary , target_id.report_step , summary_get( src_summary , src_id.report_step ));
+  }
+  enkf_node_store( target_node , target_case , true , target_id );
+
+  enkf_node_free( target_node );
+  enkf_node_free( src_node );
+}
+
+
+/*
+  For nodes with vector storage the whole vector is raw copied only when
+  the source and target report steps are equal; when they differ only
+  the single source step is copied into the target vector.
+*/
+
 void enkf_node_copy(const enkf_config_node_type * config_node ,
                     enkf_fs_type * src_case,
                     enkf_fs_type * target_case,
                     node_id_type src_id ,
                     node_id_type target_id) {
 
-  enkf_node_type * enkf_node = enkf_node_load_alloc(config_node, src_case , src_id);
+  bool vector_storage = enkf_config_node_vector_storage( config_node );
 
+  if (vector_storage && (src_id.report_step != target_id.report_step))
+    enkf_node_copy_vector_step( config_node , src_case , target_case , src_id , target_id );
+  else if (enkf_node_raw_copy( config_node )) {
+    const char * node_key  = enkf_config_node_get_key( config_node );
+    enkf_var_type var_type = enkf_config_node_get_var_type( config_node );
+    buffer_type * buffer   = buffer_alloc( 100 );
 
-  /* Hack to ensure that size is set for the gen_data instances.
-     This sneeks low level stuff into a high level scope. BAD. */
-  {
-    ert_impl_type impl_type = enkf_node_get_impl_type( enkf_node );
-    if (impl_type == GEN_DATA) {
-      /* Read the size at report_step_from */
-      gen_data_type * gen_data = enkf_node_value_ptr( enkf_node );
-      int size                 = gen_data_get_size( gen_data );
-
-      /* Enforce the size at report_step_to */
-      gen_data_assert_size( gen_data , size , target_id.report_step);
+    if (vector_storage)
+      enkf_fs_copy_vector( src_case , target_case , buffer , node_key , var_type , src_id.iens , target_id.iens );
+    else
+      enkf_fs_copy_node( src_case , target_case , buffer , node_key , var_type , src_id , target_id );
+
+    buffer_free( buffer );
+  } else {
+    enkf_node_type * enkf_node = enkf_node_load_alloc(config_node, src_case , src_id);
+
+    /* Hack to ensure that size is set for the gen_data instances.
+       This sneeks low level stuff into a high level scope. BAD. */
+    {
+      ert_impl_type impl_type = enkf_node_get_impl_type( enkf_node );
+      if (impl_type == GEN_DATA) {
+        /* Read the size at report_step_from */
+        gen_data_type * gen_data = enkf_node_value_ptr( enkf_node );
+        int size                 = gen_data_get_size( gen_data );
+
+        /* Enforce the size at report_step_to */
+        gen_data_assert_size( gen_data , size , target_id.report_step);
+      }
     }
-  }
 
-  enkf_node_store(enkf_node, target_case , true , target_id );
-  enkf_node_free(enkf_node);
+    enkf_node_store(enkf_node, target_case , true , target_id );
+    enkf_node_free(enkf_node);
+  }
 }
 
 bool enkf_node_has_data( enkf_node_type * enkf_node , enkf_fs_type * fs , node_id_type node_id) {
@@ -701,13 +849,35 @@ enkf_node_type ** enkf_node_load_alloc_ensemble( const enkf_config_node_type * c
 
 
 
-void enkf_node_serialize(enkf_node_type *enkf_node , enkf_fs_type * fs, node_id_type node_id ,
-                         const active_list_type * active_list , matrix_type * A , int row_offset , int column) {
+/**
+   The serialize_data() and deserialize_data() functions move the
+   content of an already loaded node to/from a column in the matrix A,
+   without touching the filesystem. The enkf_node_serialize() and
+   enkf_node_deserialize() functions below will in addition load and
+   store the node.
+*/
+
+void enkf_node_serialize_data(const enkf_node_type *enkf_node , node_id_type node_id ,
+                              const active_list_type * active_list , matrix_type * A , int row_offset , int column) {
 
   FUNC_ASSERT(enkf_node->serialize);
-  enkf_node_load( enkf_node , fs , node_id);
   enkf_node->serialize(enkf_node->data , node_id , active_list , A , row_offset , column);
+}
+
+
+void enkf_node_deserialize_data(enkf_node_type *enkf_node , node_id_type node_id ,
+                                const active_list_type * active_list , const matrix_type * A , int row_offset , int column) {
 
+  FUNC_ASSERT(enkf_node->deserialize);
+  enkf_node->deserialize(enkf_node->data , node_id , active_list , A , row_offset , column);
+}
+
+
+void enkf_node_serialize(enkf_node_type *enkf_node , enkf_fs_type * fs, node_id_type node_id ,
+                         const active_list_type * active_list , matrix_type * A , int row_offset , int column) {
+
+  enkf_node_load( enkf_node , fs , node_id);
+  enkf_node_serialize_data( enkf_node , node_id , active_list , A , row_offset , column);
 }
 
 
@@ -715,8 +885,7 @@ void enkf_node_serialize(enkf_node_type *enkf_node , enkf_fs_type * fs, node_id_
 void enkf_node_deserialize(enkf_node_type *enkf_node , enkf_fs_type * fs , node_id_type node_id,
                            const active_list_type * active_list , const matrix_type * A , int row_offset , int column) {
 
-  FUNC_ASSERT(enkf_node->deserialize);
-  enkf_node->deserialize(enkf_node->data , node_id , active_list , A , row_offset , column);
+  enkf_node_deserialize_data( enkf_node , node_id , active_list , A , row_offset , column);
   enkf_node_store( enkf_node , fs , true , node_id );
 }
 
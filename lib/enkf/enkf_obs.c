@@ -328,7 +328,7 @@ int enkf_obs_get_size( const enkf_obs_type * obs ) {
 
 static void enkf_obs_get_obs_and_measure_summary(const enkf_obs_type      * enkf_obs,
                                                  obs_vector_type          * obs_vector ,
-                                                 enkf_fs_type             * fs,
+                                                 response_cache_type      * cache,
                                                  const local_obsdata_node_type * obs_node ,
                                                  const int_vector_type      * ens_active_list ,
                                                  meas_data_type             * meas_data,
@@ -394,9 +394,9 @@ static void enkf_obs_get_obs_and_measure_summary(const enkf_obs_type      * enkf
           const int iens = int_vector_iget( ens_active_list , iens_index );
           node_id_type node_id = {.report_step = step,
                                   .iens        = iens};
-          enkf_node_load( work_node , fs , node_id );
+          const enkf_node_type * summary_node = response_cache_get_node( cache , obs_vector_get_config_node( obs_vector ) , node_id , work_node );
 
-          int smlength   = summary_length( enkf_node_value_ptr( work_node ) );
+          int smlength   = summary_length( enkf_node_value_ptr( summary_node ) );
           if (step >= smlength) {
             // if obs vector and sim vector have different length
             // deactivate and continue to next
@@ -407,7 +407,7 @@ static void enkf_obs_get_obs_and_measure_summary(const enkf_obs_type      * enkf
             break;
           } else {
             meas_block_iset(meas_block , iens , active_count ,
-                            summary_get( enkf_node_value_ptr( work_node ),
+                            summary_get( enkf_node_value_ptr( summary_node ),
                                          node_id.report_step ));
           }
         }
@@ -419,12 +419,12 @@ static void enkf_obs_get_obs_and_measure_summary(const enkf_obs_type      * enkf
 }
 
 
-void enkf_obs_get_obs_and_measure_node( const enkf_obs_type      * enkf_obs,
-                                        enkf_fs_type             * fs,
-                                        const local_obsdata_node_type * obs_node ,
-                                        const int_vector_type    * ens_active_list ,
-                                        meas_data_type           * meas_data,
-                                        obs_data_type            * obs_data) {
+static void enkf_obs_get_obs_and_measure_node__( const enkf_obs_type      * enkf_obs,
+                                                 response_cache_type      * cache,
+                                                 const local_obsdata_node_type * obs_node ,
+                                                 const int_vector_type    * ens_active_list ,
+                                                 meas_data_type           * meas_data,
+                                                 obs_data_type            * obs_data) {
 
   const char * obs_key         = local_obsdata_node_get_key( obs_node );
   obs_vector_type * obs_vector = hash_get( enkf_obs->obs_hash , obs_key );
@@ -437,7 +437,7 @@ void enkf_obs_get_obs_and_measure_node( const enkf_obs_type      * enkf_obs,
 
     enkf_obs_get_obs_and_measure_summary( enkf_obs ,
                                           obs_vector ,
-                                          fs ,
+                                          cache ,
                                           obs_node ,
                                           ens_active_list ,
                                           meas_data ,
@@ -463,20 +463,58 @@ void enkf_obs_get_obs_and_measure_node( const enkf_obs_type      * enkf_obs,
       /* The observation is active for this report step. */
       const active_list_type * active_list = local_obsdata_node_get_active_list( obs_node );
       /* Collect the observed data in the obs_data instance. */
-      obs_vector_iget_observations(obs_vector , report_step , obs_data , active_list, fs);
-      obs_vector_measure(obs_vector , fs , report_step , ens_active_list , meas_data , active_list);
+      obs_vector_iget_observations(obs_vector , report_step , obs_data , active_list, response_cache_get_fs( cache ));
+      obs_vector_measure_cached(obs_vector , cache , report_step , ens_active_list , meas_data , active_list);
     }
   }
 }
 
 
+void enkf_obs_get_obs_and_measure_node( const enkf_obs_type      * enkf_obs,
+                                        enkf_fs_type             * fs,
+                                        const local_obsdata_node_type * obs_node ,
+                                        const int_vector_type    * ens_active_list ,
+                                        meas_data_type           * meas_data,
+                                        obs_data_type            * obs_data) {
+
+  response_cache_type * cache = response_cache_alloc( fs );
+  enkf_obs_get_obs_and_measure_node__( enkf_obs , cache , obs_node , ens_active_list , meas_data , obs_data );
+  response_cache_free( cache );
+}
+
+
 /*
   This will append observations and simulated responses from
   report_step to obs_data and meas_data.
   Call obs_data_reset and meas_data_reset on obs_data and meas_data
   if you want to use fresh instances.
+
+  The responses are loaded through the response cache; when the
+  observations of several ministeps are collected in one update the
+  same cache should be used for all of them.
 */
 
+void enkf_obs_get_obs_and_measure_data_cached(const enkf_obs_type      * enkf_obs,
+                                              response_cache_type      * cache,
+                                              const local_obsdata_type * local_obsdata ,
+                                              const int_vector_type    * ens_active_list ,
+                                              meas_data_type           * meas_data,
+                                              obs_data_type            * obs_data) {
+
+
+  int iobs;
+  for (iobs = 0; iobs < local_obsdata_get_size( local_obsdata ); iobs++) {
+    const local_obsdata_node_type * obs_node = local_obsdata_iget( local_obsdata , iobs );
+    enkf_obs_get_obs_and_measure_node__( enkf_obs ,
+                                         cache ,
+                                         obs_node ,
+                                         ens_active_list ,
+                                         meas_data ,
+                                         obs_data);
+  }
+}
+
+
 void enkf_obs_get_obs_and_measure_data(const enkf_obs_type      * enkf_obs,
                                        enkf_fs_type             * fs,
                                        const local_obsdata_type * local_obsdata ,
@@ -484,17 +522,9 @@ void enkf_obs_get_obs_and_measure_data(const enkf_obs_type      * enkf_obs,
                                        meas_data_type           * meas_data,
                                        obs_data_type            * obs_data) {
 
-
-  int iobs;
-  for (iobs = 0; iobs < local_obsdata_get_size( local_obsdata ); iobs++) {
-    const local_obsdata_node_type * obs_node = local_obsdata_iget( local_obsdata , iobs );
-    enkf_obs_get_obs_and_measure_node( enkf_obs ,
-                                       fs ,
-                                       obs_node ,
-                                       ens_active_list ,
-                                       meas_data ,
-                                       obs_data);
-  }
+  response_cache_type * cache = response_cache_alloc( fs );
+  enkf_obs_get_obs_and_measure_data_cached( enkf_obs , cache , local_obsdata , ens_active_list , meas_data , obs_data );
+  response_cache_free( cache );
 }
 
 
@@ -1221,17 +1251,17 @@ void enkf_obs_local_scale_std( const enkf_obs_type * enkf_obs , const local_obsd
 }
 
 
-double enkf_obs_scale_correlated_std(const enkf_obs_type * enkf_obs,
-                                     enkf_fs_type * fs,
-                                     const int_vector_type * ens_active_list,
-                                     const local_obsdata_type * local_obsdata) {
+double enkf_obs_scale_correlated_std_cached(const enkf_obs_type * enkf_obs,
+                                            response_cache_type * cache,
+                                            const int_vector_type * ens_active_list,
+                                            const local_obsdata_type * local_obsdata) {
   bool_vector_type * ens_mask = int_vector_alloc_mask( ens_active_list );
   meas_data_type * meas_data = meas_data_alloc( ens_mask );
   obs_data_type * obs_data = obs_data_alloc( 1.0 );
   double scale_factor = 1.0;
 
-  enkf_obs_get_obs_and_measure_data( enkf_obs , fs , local_obsdata , ens_active_list,
-                                     meas_data , obs_data );
+  enkf_obs_get_obs_and_measure_data_cached( enkf_obs , cache , local_obsdata , ens_active_list,
+                                            meas_data , obs_data );
   {
     matrix_type * S      = meas_data_allocS( meas_data );
     if (S) {
@@ -1253,6 +1283,17 @@ double enkf_obs_scale_correlated_std(const enkf_obs_type * enkf_obs,
 }
 
 
+double enkf_obs_scale_correlated_std(const enkf_obs_type * enkf_obs,
+                                     enkf_fs_type * fs,
+                                     const int_vector_type * ens_active_list,
+                                     const local_obsdata_type * local_obsdata) {
+  response_cache_type * cache = response_cache_alloc( fs );
+  double scale_factor = enkf_obs_scale_correlated_std_cached( enkf_obs , cache , ens_active_list , local_obsdata );
+  response_cache_free( cache );
+  return scale_factor;
+}
+
+
 
 void enkf_obs_add_local_nodes_with_data(const enkf_obs_type * enkf_obs , local_obsdata_type * local_obs , enkf_fs_type *fs , const bool_vector_type * ens_mask) {
   hash_iter_type  * iter = hash_iter_alloc(enkf_obs->obs_hash);
@@ -28,6 +28,7 @@
 #include <ert/enkf/enkf_plot_tvector.h>
 #include <ert/enkf/enkf_plot_data.h>
 #include <ert/enkf/state_map.h>
+#include <ert/enkf/summary_store.h>
 
 
 #define ENKF_PLOT_DATA_TYPE_ID 3331063
@@ -112,6 +113,33 @@ int enkf_plot_data_get_size( const enkf_plot_data_type * plot_data ) {
 
 
 
+/*
+  If the case has a columnar summary store the data for all the
+  realizations are loaded from one table, instead of loading the
+  realizations one by one.
+*/
+
+static bool enkf_plot_data_load_summary_store( enkf_plot_data_type * plot_data ,
+                                               enkf_fs_type * fs ,
+                                               const bool_vector_type * mask) {
+  summary_store_type * summary_store = enkf_fs_get_summary_store( fs );
+  summary_table_type * table = NULL;
+
+  if (summary_store && (enkf_config_node_get_impl_type( plot_data->config_node ) == SUMMARY))
+    table = summary_store_alloc_table( summary_store , enkf_config_node_get_key( plot_data->config_node ));
+
+  if (table) {
+    for (int iens = 0; iens < plot_data->size; iens++) {
+      if (bool_vector_iget( mask , iens))
+        enkf_plot_tvector_load_table( enkf_plot_data_iget( plot_data , iens ) , fs , table );
+    }
+    summary_table_free( table );
+    return true;
+  } else
+    return false;
+}
+
+
 void enkf_plot_data_load( enkf_plot_data_type * plot_data ,
                           enkf_fs_type * fs ,
                           const char * index_key ,
@@ -128,7 +156,7 @@ void enkf_plot_data_load( enkf_plot_data_type * plot_data ,
 
   enkf_plot_data_resize( plot_data , ens_size );
   enkf_plot_data_reset( plot_data );
-  {
+  if (!enkf_plot_data_load_summary_store( plot_data , fs , mask )) {
     const int num_cpu = 4;
     thread_pool_type * tp = thread_pool_alloc( num_cpu , true );
     for (int iens = 0; iens < ens_size ; iens++) {
@@ -32,6 +32,7 @@
 #include <ert/enkf/enkf_fs.h>
 #include <ert/enkf/obs_vector.h>
 #include <ert/enkf/enkf_config_node.h>
+#include <ert/enkf/ensemble_stat.h>
 #include <ert/enkf/enkf_plot_gendata.h>
 
 
@@ -43,8 +44,11 @@ struct enkf_plot_gendata_struct {
   const enkf_config_node_type * enkf_config_node;
   enkf_plot_genvector_type ** ensemble;
   arg_pack_type              ** work_arg;
+  ensemble_stat_type * stat;
   double_vector_type * max_values;
   double_vector_type * min_values;
+  double_vector_type * mean_values;
+  double_vector_type * std_values;
 };
 
 UTIL_IS_INSTANCE_FUNCTION( enkf_plot_gendata , ENKF_PLOT_GENDATA_TYPE_ID )
@@ -58,8 +62,11 @@ enkf_plot_gendata_type * enkf_plot_gendata_alloc( const enkf_config_node_type *
         data->work_arg = NULL;
         data->ensemble = NULL;
 
+        data->stat = NULL;
         data->max_values = NULL;
         data->min_values = NULL;
+        data->mean_values = NULL;
+        data->std_values = NULL;
         return data;
     } else {
         return NULL;
@@ -72,11 +79,27 @@ enkf_plot_gendata_type * enkf_plot_gendata_alloc_from_obs_vector( const obs_vect
     return enkf_plot_gendata_alloc(obs_vector_get_config_node(obs_vector));
 }
 
+static void enkf_plot_gendata_free_statistics( enkf_plot_gendata_type * data ){
+    if (data->stat) {
+        ensemble_stat_free( data->stat );
+        double_vector_free( data->min_values );
+        double_vector_free( data->max_values );
+        double_vector_free( data->mean_values );
+        double_vector_free( data->std_values );
+    }
+    data->stat = NULL;
+    data->min_values = NULL;
+    data->max_values = NULL;
+    data->mean_values = NULL;
+    data->std_values = NULL;
+}
+
 void enkf_plot_gendata_free( enkf_plot_gendata_type * data ){
     for (int iens = 0; iens < data->size; iens++) {
         arg_pack_free( data->work_arg[iens] );
         enkf_plot_genvector_free( data->ensemble[iens] );
     }
+    enkf_plot_gendata_free_statistics( data );
 
     free( data->work_arg );
     free( data->ensemble );
@@ -147,6 +170,7 @@ void enkf_plot_gendata_load( enkf_plot_gendata_type * plot_data ,
 
     enkf_plot_gendata_resize( plot_data , ens_size );
     enkf_plot_gendata_reset( plot_data , report_step );
+    enkf_plot_gendata_free_statistics( plot_data );
 
     {
       const int num_cpu = 4;
@@ -171,34 +195,74 @@ void enkf_plot_gendata_load( enkf_plot_gendata_type * plot_data ,
 
 }
 
-void enkf_plot_gendata_find_min_max_values__(enkf_plot_gendata_type * plot_data){
+/*
+   The statistics are accumulated in one pass over the loaded
+   realizations with ensemble_stat; the realizations which have not
+   been loaded, or have a different size than the first loaded
+   realization, are ignored.
+*/
+
+static void enkf_plot_gendata_update_statistics__(enkf_plot_gendata_type * plot_data){
+    int size = 0;
+    double * data = NULL;
+
+    plot_data->stat = ensemble_stat_alloc( NULL );
     for (int iens = 0; iens < plot_data->size; iens++){
         enkf_plot_genvector_type * vector = enkf_plot_gendata_iget(plot_data, iens);
-        int size = enkf_plot_genvector_get_size(vector);
-        if(iens == 0) {
-            plot_data->min_values = double_vector_alloc(size, DBL_MAX);
-            plot_data->max_values = double_vector_alloc(size, -DBL_MAX);
+        int vector_size = enkf_plot_genvector_get_size(vector);
+
+        if (size == 0 && vector_size > 0) {
+            size = vector_size;
+            data = util_calloc( size , sizeof * data );
         }
-        for(int index = 0; index < size; index++){
-            double value = enkf_plot_genvector_iget(vector, index);
-            double_vector_iset(plot_data->min_values, index, util_double_min(double_vector_iget(plot_data->min_values, index), value));
-            double_vector_iset(plot_data->max_values, index, util_double_max(double_vector_iget(plot_data->max_values, index), value));
+
+        if (vector_size > 0 && vector_size == size) {
+            for(int index = 0; index < size; index++)
+                data[index] = enkf_plot_genvector_iget(vector, index);
+            ensemble_stat_add_sample( plot_data->stat , data , size );
         }
     }
+    free( data );
+
+    plot_data->min_values = double_vector_alloc(size, 0);
+    plot_data->max_values = double_vector_alloc(size, 0);
+    plot_data->mean_values = double_vector_alloc(size, 0);
+    plot_data->std_values = double_vector_alloc(size, 0);
+    for(int index = 0; index < size; index++){
+        double_vector_iset(plot_data->min_values, index, ensemble_stat_iget_min(plot_data->stat, index));
+        double_vector_iset(plot_data->max_values, index, ensemble_stat_iget_max(plot_data->stat, index));
+        double_vector_iset(plot_data->mean_values, index, ensemble_stat_iget_mean(plot_data->stat, index));
+        double_vector_iset(plot_data->std_values, index, ensemble_stat_iget_std(plot_data->stat, index));
+    }
+}
+
+static void enkf_plot_gendata_assert_statistics(enkf_plot_gendata_type * plot_data) {
+    if(plot_data->stat == NULL)
+        enkf_plot_gendata_update_statistics__(plot_data);
 }
 
 double_vector_type * enkf_plot_gendata_get_min_values(enkf_plot_gendata_type * plot_data) {
-    if(plot_data->min_values == NULL) {
-        enkf_plot_gendata_find_min_max_values__(plot_data);
-    }
+    enkf_plot_gendata_assert_statistics(plot_data);
     return plot_data->min_values;
 }
 
 
 
 double_vector_type * enkf_plot_gendata_get_max_values(enkf_plot_gendata_type * plot_data) {
-    if(plot_data->max_values == NULL) {
-        enkf_plot_gendata_find_min_max_values__(plot_data);
-    }
+    enkf_plot_gendata_assert_statistics(plot_data);
     return plot_data->max_values;
 }
+
+
+
+double_vector_type * enkf_plot_gendata_get_mean_values(enkf_plot_gendata_type * plot_data) {
+    enkf_plot_gendata_assert_statistics(plot_data);
+    return plot_data->mean_values;
+}
+
+
+
+double_vector_type * enkf_plot_gendata_get_std_values(enkf_plot_gendata_type * plot_data) {
+    enkf_plot_gendata_assert_statistics(plot_data);
+    return plot_data->std_values;
+}
@@ -169,6 +169,26 @@ void enkf_plot_tvector_load( enkf_plot_tvector_type * plot_tvector ,
 }
 
 
+/**
+   Loads the vector from a summary_table holding the whole ensemble,
+   instead of loading the realization from the fs_driver.
+*/
+
+void enkf_plot_tvector_load_table( enkf_plot_tvector_type * plot_tvector ,
+                                   enkf_fs_type * fs ,
+                                   const summary_table_type * table) {
+
+  time_map_type * time_map = enkf_fs_get_time_map( fs );
+  if (summary_table_get_vector( table , plot_tvector->iens , plot_tvector->work )) {
+    for (int step = 0; step < double_vector_size( plot_tvector->work ); step++)
+      enkf_plot_tvector_iset( plot_tvector ,
+                              step ,
+                              time_map_iget( time_map , step ) ,
+                              double_vector_iget( plot_tvector->work , step ));
+  }
+}
+
+
 void * enkf_plot_tvector_load__( void * arg ) {
   arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
   enkf_plot_tvector_type * tvector = arg_pack_iget_ptr( arg_pack , 0 );
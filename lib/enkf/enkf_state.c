@@ -34,6 +34,9 @@
 #include <ert/util/timer.h>
 #include <ert/util/time_t_vector.h>
 #include <ert/util/rng.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/vector.h>
+#include <ert/util/buffer.h>
 #include <ert/res_util/subst_list.h>
 
 #include <ert/ecl/fortio.h>
@@ -76,6 +79,7 @@
 #include <ert/enkf/callback_arg.h>
 
 #define  ENKF_STATE_TYPE_ID 78132
+#define  SUMMARY_BATCH_BYTES (64 * 1024 * 1024)   /* Max size of the summary vectors written in one batch. */
 
 
 
@@ -333,6 +337,89 @@ static int_vector_type * __enkf_state_get_time_index(enkf_fs_type * sim_fs, cons
 }
 
 
+static void enkf_state_fwrite_summary_batch(enkf_fs_type * sim_fs, stringlist_type * node_keys, vector_type * buffers, enkf_var_type var_type, int iens) {
+  enkf_fs_fwrite_vectors( sim_fs , buffers , node_keys , var_type , iens );
+
+  for (int i = 0; i < vector_get_size( buffers ); i++)
+    buffer_free( vector_iget( buffers , i ));
+  vector_clear( buffers );
+  stringlist_clear( node_keys );
+}
+
+
+/*
+  Internalizes all the summary vectors of @smspec which are matched by
+  the summary key matcher. The matching node indices come from the
+  per layout cache in the matcher, and the vectors are written to the
+  storage in large batches.
+
+  When the forward model was started from the first report step
+  (@full_load) the loaded vectors hold the complete history of the
+  realization and are written in full, any vector already stored for
+  this realization is replaced. Otherwise - for a restarted forward
+  model - the stored vector is read back first, so that the steps
+  before load_start are retained.
+*/
+
+static void enkf_state_internalize_summary_vectors(ensemble_config_type * ens_config,
+                                                   forward_load_context_type * load_context,
+                                                   const summary_key_matcher_type * matcher,
+                                                   const ecl_smspec_type * smspec,
+                                                   const int_vector_type * time_index,
+                                                   bool full_load,
+                                                   enkf_fs_type * sim_fs,
+                                                   int iens) {
+
+  int_vector_type * match_index = summary_key_matcher_alloc_match_index(matcher, smspec);
+  summary_key_set_type * key_set = enkf_fs_get_summary_key_set(sim_fs);
+  summary_store_type * summary_store = enkf_fs_get_summary_store( sim_fs );
+  stringlist_type * node_keys = stringlist_alloc_new();
+  vector_type * buffers = vector_alloc_new();
+  enkf_var_type var_type = DYNAMIC_RESULT;
+  size_t batch_bytes = 0;
+
+  for (int i = 0; i < int_vector_size(match_index); i++) {
+    const smspec_node_type * smspec_node = ecl_smspec_iget_node(smspec, int_vector_iget(match_index, i));
+    const char * key = smspec_node_get_gen_key1(smspec_node);
+    enkf_config_node_type * config_node;
+    enkf_node_type * node;
+
+    summary_key_set_add_summary_key(key_set, key);
+    config_node = ensemble_config_get_or_create_summary_node(ens_config, key);
+    node = enkf_node_alloc( config_node );
+    var_type = enkf_config_node_get_var_type( config_node );
+
+    if (!full_load && enkf_config_node_has_vector( config_node , sim_fs , iens ))
+      enkf_node_load_vector( node , sim_fs , iens );  // Ensure that what is currently on file is loaded before we update.
+
+    enkf_node_forward_load_vector( node , load_context , time_index);
+    {
+      buffer_type * buffer = buffer_alloc( 100 );
+      if (enkf_node_write_vector_buffer( node , buffer )) {
+        batch_bytes += buffer_get_size( buffer );
+        stringlist_append_copy( node_keys , key );
+        vector_append_ref( buffers , buffer );
+      } else
+        buffer_free( buffer );
+    }
+
+    if (summary_store)
+      summary_store_set_vector( summary_store , key , iens , summary_get_data_vector( enkf_node_value_ptr( node )));
+    enkf_node_free( node );
+
+    if (batch_bytes >= SUMMARY_BATCH_BYTES) {
+      enkf_state_fwrite_summary_batch( sim_fs , node_keys , buffers , var_type , iens );
+      batch_bytes = 0;
+    }
+  }
+  enkf_state_fwrite_summary_batch( sim_fs , node_keys , buffers , var_type , iens );
+
+  vector_free( buffers );
+  stringlist_free( node_keys );
+  int_vector_free( match_index );
+}
+
+
 /*
  * Check if there are summary keys in the ensemble config that is not found in Eclipse. If this is the case, AND we
  * have observations for this key, we have a problem. Otherwise, just print a message to the log.
@@ -388,6 +475,7 @@ static bool enkf_state_internalize_dynamic_eclipse_results(ensemble_config_type
 
   if (load_summary || matcher_size > 0 || summary) {
     int load_start = run_arg_get_load_start( run_arg );
+    bool full_load = (load_start == 0);
 
     if (load_start == 0) { /* Do not attempt to load the "S0000" summary results. */
       load_start++;
@@ -419,27 +507,7 @@ static bool enkf_state_internalize_dynamic_eclipse_results(ensemble_config_type
         int_vector_resize( time_index , step2 + 1);
 
         const ecl_smspec_type * smspec = ecl_sum_get_smspec(summary);
-
-        for(int i = 0; i < ecl_smspec_num_nodes(smspec); i++) {
-	  const smspec_node_type * smspec_node = ecl_smspec_iget_node(smspec, i);
-	  if (smspec_node_is_valid( smspec_node )) {
-	    const char * key = smspec_node_get_gen_key1(smspec_node);
-
-              if(summary_key_matcher_match_summary_key(matcher, key)) {
-                summary_key_set_type * key_set = enkf_fs_get_summary_key_set(sim_fs);
-                summary_key_set_add_summary_key(key_set, key);
-
-                enkf_config_node_type * config_node = ensemble_config_get_or_create_summary_node(ens_config, key);
-                enkf_node_type * node = enkf_node_alloc( config_node );
-
-                enkf_node_try_load_vector( node , sim_fs , iens );  // Ensure that what is currently on file is loaded before we update.
-
-                enkf_node_forward_load_vector( node , load_context , time_index);
-                enkf_node_store_vector( node , sim_fs , iens );
-		enkf_node_free( node );
-              }
-            }
-        }
+        enkf_state_internalize_summary_vectors(ens_config, load_context, matcher, smspec, time_index, full_load, sim_fs, iens);
 
         int_vector_free( time_index );
 
@@ -764,6 +832,35 @@ void enkf_state_free(enkf_state_type *enkf_state) {
 
 
 
+/*
+  The GEN_DATA result files as fnmatch() patterns relative to the
+  runpath; the report step in the RESULT_FILE format matches any
+  step. These are the files, apart from the summary and restart
+  files, which the job manager must make durable before it creates
+  the OK file.
+*/
+
+static stringlist_type * enkf_state_alloc_result_files(const ensemble_config_type * ens_config,
+                                                       const run_arg_type * run_arg) {
+  stringlist_type * result_files = stringlist_alloc_new();
+  stringlist_type * keylist_GEN_DATA = ensemble_config_alloc_keylist_from_impl_type(ens_config, GEN_DATA);
+
+  for (int ikey=0; ikey < stringlist_get_size(keylist_GEN_DATA); ikey++) {
+    const enkf_config_node_type * config_node = ensemble_config_get_node(ens_config,
+                                                                         stringlist_iget(keylist_GEN_DATA, ikey));
+    const char * infile_fmt = enkf_config_node_get_enkf_infile(config_node);
+    if (infile_fmt) {
+      char * pattern = util_string_replace_alloc(infile_fmt, "%d", "*");
+      subst_list_update_string(run_arg_get_subst_list(run_arg), &pattern);
+      stringlist_append_owned_ref(result_files, pattern);
+    }
+  }
+
+  stringlist_free(keylist_GEN_DATA);
+  return result_files;
+}
+
+
 /**
    init_step    : The parameters are loaded from this EnKF/report step.
    report_step1 : The simulation should start from this report step;
@@ -828,13 +925,16 @@ void enkf_state_init_eclipse(const res_config_type * res_config,
 
   /* This is where the job script is created */
   const env_varlist_type * varlist = site_config_get_env_varlist(res_config_get_site_config(res_config));
-  forward_model_formatted_fprintf(model_config_get_forward_model(model_config),
-                                  run_arg_get_run_id( run_arg ),
-                                  run_arg_get_runpath(run_arg),
-                                  model_config_get_data_root(model_config),
-                                  run_arg_get_subst_list(run_arg),
-                                  umask,
-                                  varlist);
+  stringlist_type * result_files = enkf_state_alloc_result_files(ens_config, run_arg);
+  forward_model_formatted_fprintf_with_results(model_config_get_forward_model(model_config),
+                                               run_arg_get_run_id( run_arg ),
+                                               run_arg_get_runpath(run_arg),
+                                               model_config_get_data_root(model_config),
+                                               run_arg_get_subst_list(run_arg),
+                                               umask,
+                                               varlist,
+                                               result_files);
+  stringlist_free(result_files);
 }
 
 
@@ -0,0 +1,465 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'ensemble_stat.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/double_vector.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/res_util/matrix.h>
+#include <ert/res_util/thread_pool.h>
+
+#include <ert/enkf/active_list.h>
+#include <ert/enkf/enkf_node.h>
+#include <ert/enkf/ensemble_stat.h>
+
+/**
+   The ensemble_stat object accumulates elementwise statistics
+   (mean, standard deviation, min, max and optionally quantiles) for
+   an ensemble of nodes, without ever holding more than a few
+   realizations in memory:
+
+     1. The moments are updated with Welford's algorithm, i.e. each
+        realization is added to running mean and sum of squared
+        deviations in one pass.
+
+     2. The quantiles are estimated with the P^2 algorithm of Jain and
+        Chlamtac, which keeps five markers per element and quantile;
+        the estimate is exact as long as no more than five
+        realizations have been added.
+
+   In ensemble_stat_add_ensemble() the realizations are loaded in
+   batches; each thread of the work pool loads one realization into
+   a column of a (data_size x num_threads) matrix, and then the
+   elements of the batch are split in row ranges and accumulated by
+   the threads. Since each element is owned by exactly one thread the
+   result is independent of the number of threads.
+
+   The standard deviation is the population standard deviation,
+   i.e. normalized with 1/N, which is what the inflation code has
+   always used.
+*/
+
+#define ENSEMBLE_STAT_TYPE_ID  771092
+#define P2_MARKERS             5
+
+struct ensemble_stat_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int                  size;            /* The number of elements; -1 until the first sample is added. */
+  int                  count;           /* The number of samples (i.e. realizations) added. */
+  double             * mean;
+  double             * M2;              /* Sum of squared deviations from the current mean. */
+  double             * min;
+  double             * max;
+  double_vector_type * quantiles;
+  double             * marker_height;   /* size * num_quantiles * P2_MARKERS */
+  int                * marker_pos;
+};
+
+
+typedef struct {
+  ensemble_stat_type          * stat;
+  const enkf_config_node_type * config_node;
+  enkf_fs_type                * fs;
+  const active_list_type      * active_list;
+  matrix_type                 * A;
+  int                           report_step;
+  int                           iens;
+  int                           column;
+  int                           num_columns;
+  int                           row1;
+  int                           row2;
+} ensemble_stat_job_type;
+
+
+UTIL_IS_INSTANCE_FUNCTION( ensemble_stat , ENSEMBLE_STAT_TYPE_ID )
+
+
+ensemble_stat_type * ensemble_stat_alloc( const double_vector_type * quantiles ) {
+  ensemble_stat_type * stat = util_malloc( sizeof * stat );
+  UTIL_TYPE_ID_INIT( stat , ENSEMBLE_STAT_TYPE_ID );
+  stat->size          = -1;
+  stat->count         = 0;
+  stat->mean          = NULL;
+  stat->M2            = NULL;
+  stat->min           = NULL;
+  stat->max           = NULL;
+  stat->marker_height = NULL;
+  stat->marker_pos    = NULL;
+
+  if (quantiles)
+    stat->quantiles = double_vector_alloc_copy( quantiles );
+  else
+    stat->quantiles = double_vector_alloc( 0 , 0 );
+
+  for (int iq = 0; iq < double_vector_size( stat->quantiles ); iq++) {
+    double p = double_vector_iget( stat->quantiles , iq );
+    if ((p < 0) || (p > 1))
+      util_abort("%s: invalid quantile:%g - must be in [0,1]\n",__func__ , p);
+  }
+  return stat;
+}
+
+
+void ensemble_stat_free( ensemble_stat_type * stat ) {
+  free( stat->mean );
+  free( stat->M2 );
+  free( stat->min );
+  free( stat->max );
+  free( stat->marker_height );
+  free( stat->marker_pos );
+  double_vector_free( stat->quantiles );
+  free( stat );
+}
+
+
+static void ensemble_stat_assert_size( ensemble_stat_type * stat , int size ) {
+  if (stat->size < 0) {
+    const int num_markers = size * double_vector_size( stat->quantiles ) * P2_MARKERS;
+    stat->size = size;
+    stat->mean = util_calloc( size , sizeof * stat->mean );
+    stat->M2   = util_calloc( size , sizeof * stat->M2 );
+    stat->min  = util_calloc( size , sizeof * stat->min );
+    stat->max  = util_calloc( size , sizeof * stat->max );
+    if (num_markers > 0) {
+      stat->marker_height = util_calloc( num_markers , sizeof * stat->marker_height );
+      stat->marker_pos    = util_calloc( num_markers , sizeof * stat->marker_pos );
+    }
+  } else if (stat->size != size)
+    util_abort("%s: size mismatch - have accumulated statistics for %d elements, got sample with %d elements\n",__func__ , stat->size , size);
+}
+
+
+/**
+   Adds observation number @n (counting from one) to the P^2 markers
+   @q (heights) and @pos (zero based positions) for quantile @p.
+*/
+
+static void ensemble_stat_p2_update( double * q , int * pos , double p , double x , int n ) {
+  if (n <= P2_MARKERS) {
+    /* Insertion sort of the first observations. */
+    int i = n - 1;
+    while ((i > 0) && (q[i - 1] > x)) {
+      q[i] = q[i - 1];
+      i--;
+    }
+    q[i] = x;
+    pos[n - 1] = n - 1;
+  } else {
+    const double dn[P2_MARKERS] = {0 , 0.5 * p , p , 0.5 * (1 + p) , 1};
+    int k;
+
+    if (x < q[0]) {
+      q[0] = x;
+      k = 0;
+    } else if (x >= q[P2_MARKERS - 1]) {
+      q[P2_MARKERS - 1] = x;
+      k = P2_MARKERS - 2;
+    } else {
+      k = 0;
+      while (x >= q[k + 1])
+        k++;
+    }
+
+    for (int i = k + 1; i < P2_MARKERS; i++)
+      pos[i]++;
+
+    for (int i = 1; i < P2_MARKERS - 1; i++) {
+      double d = (n - 1) * dn[i] - pos[i];
+      if (((d >= 1) && (pos[i + 1] - pos[i] > 1)) || ((d <= -1) && (pos[i - 1] - pos[i] < -1))) {
+        int s = (d > 0) ? 1 : -1;
+        double qp = q[i] + 1.0 * s / (pos[i + 1] - pos[i - 1]) *
+          ((pos[i] - pos[i - 1] + s) * (q[i + 1] - q[i]) / (pos[i + 1] - pos[i]) +
+           (pos[i + 1] - pos[i] - s) * (q[i] - q[i - 1]) / (pos[i] - pos[i - 1]));
+
+        if ((q[i - 1] < qp) && (qp < q[i + 1]))
+          q[i] = qp;
+        else
+          q[i] += s * (q[i + s] - q[i]) / (pos[i + s] - pos[i]);
+
+        pos[i] += s;
+      }
+    }
+  }
+}
+
+
+static double ensemble_stat_p2_estimate( const double * q , double p , int n ) {
+  if (n > P2_MARKERS)
+    return q[2];
+  else {
+    double h  = p * (n - 1);
+    int    lo = (int) floor( h );
+    int    hi = util_int_min( lo + 1 , n - 1 );
+    return q[lo] + (h - lo) * (q[hi] - q[lo]);
+  }
+}
+
+
+static void ensemble_stat_update_element( ensemble_stat_type * stat , int index , double x , int n ) {
+  {
+    double delta = x - stat->mean[index];
+    stat->mean[index] += delta / n;
+    stat->M2[index]   += delta * (x - stat->mean[index]);
+  }
+
+  if (n == 1) {
+    stat->min[index] = x;
+    stat->max[index] = x;
+  } else {
+    stat->min[index] = util_double_min( stat->min[index] , x );
+    stat->max[index] = util_double_max( stat->max[index] , x );
+  }
+
+  {
+    const int num_quantiles = double_vector_size( stat->quantiles );
+    for (int iq = 0; iq < num_quantiles; iq++) {
+      int offset = (index * num_quantiles + iq) * P2_MARKERS;
+      ensemble_stat_p2_update( &stat->marker_height[offset] ,
+                               &stat->marker_pos[offset] ,
+                               double_vector_iget( stat->quantiles , iq ) ,
+                               x , n );
+    }
+  }
+}
+
+
+void ensemble_stat_add_sample( ensemble_stat_type * stat , const double * data , int size) {
+  ensemble_stat_assert_size( stat , size );
+  stat->count++;
+  for (int index = 0; index < size; index++)
+    ensemble_stat_update_element( stat , index , data[index] , stat->count );
+}
+
+
+/*****************************************************************/
+
+static void * ensemble_stat_load_mt( void * arg ) {
+  ensemble_stat_job_type * job = (ensemble_stat_job_type *) arg;
+  enkf_node_type * node = enkf_node_alloc( job->config_node );
+  node_id_type node_id = {.report_step = job->report_step , .iens = job->iens };
+
+  enkf_node_serialize( node , job->fs , node_id , job->active_list , job->A , 0 , job->column );
+  enkf_node_free( node );
+  return NULL;
+}
+
+
+static void * ensemble_stat_accumulate_mt( void * arg ) {
+  ensemble_stat_job_type * job = (ensemble_stat_job_type *) arg;
+  ensemble_stat_type * stat = job->stat;
+
+  for (int row = job->row1; row < job->row2; row++)
+    for (int column = 0; column < job->num_columns; column++)
+      ensemble_stat_update_element( stat , row , matrix_iget( job->A , row , column ) , stat->count + column + 1);
+
+  return NULL;
+}
+
+
+/**
+   Will load the node @config_node for all the realizations in
+   @iens_list from @fs and add them to the statistics. The work pool
+   should be allocated with start_queue == false; the number of
+   realizations in memory at any time is equal to the maximum number
+   of running threads in the pool.
+*/
+
+void ensemble_stat_add_ensemble( ensemble_stat_type * stat ,
+                                 const enkf_config_node_type * config_node ,
+                                 enkf_fs_type * fs ,
+                                 int report_step ,
+                                 const int_vector_type * iens_list ,
+                                 thread_pool_type * work_pool) {
+
+  const int ens_size    = int_vector_size( iens_list );
+  const int num_threads = thread_pool_get_max_running( work_pool );
+  if (ens_size == 0)
+    return;
+
+  /*
+    For GEN_DATA the size is not known by the config node before one
+    instance has been loaded; see the comment in __get_active_size()
+    in enkf_main.c.
+  */
+  {
+    enkf_node_type * node = enkf_node_alloc( config_node );
+    node_id_type node_id = {.report_step = report_step , .iens = int_vector_iget( iens_list , 0 )};
+    enkf_node_load( node , fs , node_id );
+    enkf_node_free( node );
+  }
+
+  {
+    const int size = enkf_config_node_get_data_size( config_node , report_step );
+    const int rows_per_thread = (size + num_threads - 1) / num_threads;
+    active_list_type * active_list = active_list_alloc( );
+    matrix_type * A = matrix_alloc( size , num_threads );
+    ensemble_stat_job_type * jobs = util_calloc( num_threads , sizeof * jobs );
+
+    ensemble_stat_assert_size( stat , size );
+    for (int ithread = 0; ithread < num_threads; ithread++) {
+      jobs[ithread].stat        = stat;
+      jobs[ithread].config_node = config_node;
+      jobs[ithread].fs          = fs;
+      jobs[ithread].active_list = active_list;
+      jobs[ithread].A           = A;
+      jobs[ithread].report_step = report_step;
+      jobs[ithread].row1        = util_int_min( size , ithread * rows_per_thread );
+      jobs[ithread].row2        = util_int_min( size , (ithread + 1) * rows_per_thread );
+    }
+
+    for (int batch_start = 0; batch_start < ens_size; batch_start += num_threads) {
+      const int num_columns = util_int_min( num_threads , ens_size - batch_start );
+
+      thread_pool_restart( work_pool );
+      for (int column = 0; column < num_columns; column++) {
+        jobs[column].iens   = int_vector_iget( iens_list , batch_start + column );
+        jobs[column].column = column;
+        thread_pool_add_job( work_pool , ensemble_stat_load_mt , &jobs[column] );
+      }
+      thread_pool_join( work_pool );
+
+      thread_pool_restart( work_pool );
+      for (int ithread = 0; ithread < num_threads; ithread++) {
+        jobs[ithread].num_columns = num_columns;
+        thread_pool_add_job( work_pool , ensemble_stat_accumulate_mt , &jobs[ithread] );
+      }
+      thread_pool_join( work_pool );
+
+      stat->count += num_columns;
+    }
+
+    free( jobs );
+    matrix_free( A );
+    active_list_free( active_list );
+  }
+}
+
+
+/*****************************************************************/
+
+static void ensemble_stat_assert_index( const ensemble_stat_type * stat , int index ) {
+  if (stat->count == 0)
+    util_abort("%s: no samples have been added\n",__func__);
+
+  if ((index < 0) || (index >= stat->size))
+    util_abort("%s: invalid index:%d - valid range: [0,%d)\n",__func__ , index , stat->size);
+}
+
+
+int ensemble_stat_get_size( const ensemble_stat_type * stat ) {
+  return stat->size;
+}
+
+
+int ensemble_stat_get_count( const ensemble_stat_type * stat ) {
+  return stat->count;
+}
+
+
+int ensemble_stat_get_num_quantiles( const ensemble_stat_type * stat ) {
+  return double_vector_size( stat->quantiles );
+}
+
+
+double ensemble_stat_iget_mean( const ensemble_stat_type * stat , int index ) {
+  ensemble_stat_assert_index( stat , index );
+  return stat->mean[index];
+}
+
+
+double ensemble_stat_iget_std( const ensemble_stat_type * stat , int index ) {
+  ensemble_stat_assert_index( stat , index );
+  return sqrt( stat->M2[index] / stat->count );
+}
+
+
+double ensemble_stat_iget_min( const ensemble_stat_type * stat , int index ) {
+  ensemble_stat_assert_index( stat , index );
+  return stat->min[index];
+}
+
+
+double ensemble_stat_iget_max( const ensemble_stat_type * stat , int index ) {
+  ensemble_stat_assert_index( stat , index );
+  return stat->max[index];
+}
+
+
+double ensemble_stat_iget_quantile( const ensemble_stat_type * stat , int iq , int index ) {
+  const int num_quantiles = double_vector_size( stat->quantiles );
+  ensemble_stat_assert_index( stat , index );
+  if ((iq < 0) || (iq >= num_quantiles))
+    util_abort("%s: invalid quantile index:%d\n",__func__ , iq);
+
+  return ensemble_stat_p2_estimate( &stat->marker_height[ (index * num_quantiles + iq) * P2_MARKERS ] ,
+                                    double_vector_iget( stat->quantiles , iq ) ,
+                                    stat->count );
+}
+
+
+/*****************************************************************/
+
+/*
+  The node arguments to the get_xxx_node() functions must have the
+  correct shape, i.e. typically they should be allocated and loaded
+  from one of the realizations which have been added.
+*/
+
+static void ensemble_stat_set_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id ,
+                                    double (*iget)( const ensemble_stat_type * , int ) , int iq) {
+  matrix_type * A = matrix_alloc( stat->size , 1 );
+  active_list_type * active_list = active_list_alloc( );
+
+  for (int index = 0; index < stat->size; index++) {
+    double value = iget ? iget( stat , index ) : ensemble_stat_iget_quantile( stat , iq , index );
+    matrix_iset( A , index , 0 , value );
+  }
+  enkf_node_deserialize_data( node , node_id , active_list , A , 0 , 0 );
+
+  active_list_free( active_list );
+  matrix_free( A );
+}
+
+
+void ensemble_stat_get_mean_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id) {
+  ensemble_stat_set_node( stat , node , node_id , ensemble_stat_iget_mean , 0 );
+}
+
+
+void ensemble_stat_get_std_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id) {
+  ensemble_stat_set_node( stat , node , node_id , ensemble_stat_iget_std , 0 );
+}
+
+
+void ensemble_stat_get_min_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id) {
+  ensemble_stat_set_node( stat , node , node_id , ensemble_stat_iget_min , 0 );
+}
+
+
+void ensemble_stat_get_max_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id) {
+  ensemble_stat_set_node( stat , node , node_id , ensemble_stat_iget_max , 0 );
+}
+
+
+void ensemble_stat_get_quantile_node( const ensemble_stat_type * stat , int iq , enkf_node_type * node , node_id_type node_id) {
+  ensemble_stat_set_node( stat , node , node_id , NULL , iq );
+}
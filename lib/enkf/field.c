@@ -32,6 +32,7 @@
 #include <ert/ecl/ecl_type.h>
 
 #include <ert/rms/rms_file.h>
+#include <ert/rms/rms_file_index.h>
 #include <ert/rms/rms_tagkey.h>
 #include <ert/rms/rms_type.h>
 #include <ert/rms/rms_util.h>
@@ -77,42 +78,48 @@ struct field_struct {
 
 #define EXPORT_MACRO                                                                                    \
 {                                                                                                       \
-  int nx,ny,nz;                                                                                         \
-  field_config_get_dims(field->config , &nx , &ny , &nz);                                               \
-  int i,j,k;                                                                                            \
-  for (k=0; k < nz; k++) {                                                                              \
-    for (j=0; j < ny; j++) {                                                                            \
-      for (i=0; i < nx; i++) {                                                                          \
-        bool active_cell          = field_config_active_cell(config, i, j, k);                          \
-        bool use_initial_value    = false;                                                              \
-                                                                                                        \
-        if (init_file && !active_cell)                                                                  \
-          use_initial_value = true;                                                                     \
-                                                                                                        \
-        int source_index = 0;                                                                           \
-        if (use_initial_value)                                                                          \
-          source_index = field_config_global_index(config , i , j , k);                                 \
-        else                                                                                            \
-          source_index = field_config_active_index(config, i, j, k);                                    \
-                                                                                                        \
-        int target_index;                                                                               \
-        if (rms_index_order)                                                                            \
-          target_index = rms_util_global_index_from_eclipse_ijk(nx,ny,nz,i,j,k);                        \
-        else                                                                                            \
-          target_index = i + j * nx + k* nx*ny;                                                         \
-                                                                                                        \
-        if (use_initial_value)                                                                          \
-          target_data[target_index] = initial_src_data[source_index];                                   \
-        else if (active_cell)                                                                           \
-          target_data[target_index] = src_data[source_index];                                           \
-        else                                                                                            \
-          memcpy(&target_data[target_index] , fill_value , sizeof_ctype_target);                        \
-      }                                                                                                 \
-    }                                                                                                   \
+  const int * active_map = field_config_get_active_map(config , rms_index_order);                       \
+  const int * global_map = field_config_get_global_map(config , rms_index_order);                       \
+  const int volume       = field_config_get_volume(config);                                             \
+  for (int index = 0; index < volume; index++) {                                                        \
+    int active_index = active_map[index];                                                               \
+    if (active_index >= 0)                                                                              \
+      target_data[index] = src_data[active_index];                                                      \
+    else if (initial_src_data)                                                                          \
+      target_data[index] = initial_src_data[global_map[index]];                                         \
+    else                                                                                                \
+      memcpy(&target_data[index] , fill_value , sizeof_ctype_target);                                   \
   }                                                                                                     \
 }                                                                                                       \
 
 
+/*
+  The content of the INIT_FILE is loaded once, and then cached in the
+  field_config instance for subsequent exports; the data must be
+  returned with field_config_release_init_data().
+*/
+
+static const void * field_get_init_data(const field_type * field , const char * init_file) {
+  const field_config_type * config = field->config;
+  const void * init_data = field_config_get_init_data(config , init_file);
+
+  if (init_data == NULL) {
+    ecl_grid_type * grid                     = field_config_get_grid(config);
+    bool global_size                         = true;
+    field_config_type * initial_field_config = field_config_alloc_empty(field_config_get_key(config), grid, NULL, global_size);
+    field_type * initial_field               = field_alloc(initial_field_config);
+
+    field_fload_keep_inactive(initial_field, init_file);
+    init_data = field_config_add_init_data(config ,
+                                           init_file ,
+                                           util_alloc_copy(initial_field->data , field_config_get_byte_size(initial_field_config)));
+    field_free(initial_field);
+    field_config_free(initial_field_config);
+  }
+  return init_data;
+}
+
+
 void field_export3D(const field_type * field ,
                     void *_target_data ,
                     bool rms_index_order ,
@@ -123,21 +130,13 @@ void field_export3D(const field_type * field ,
   ecl_data_type data_type = field_config_get_ecl_data_type( config );
   int   sizeof_ctype_target = ecl_type_get_sizeof_ctype(target_data_type);
 
-  field_type * initial_field               = NULL;
-  field_config_type * initial_field_config = NULL;
-  if (init_file) {
-    ecl_grid_type * grid        = field_config_get_grid(config);
-    bool global_size            = true;
-    initial_field_config        = field_config_alloc_empty(field_config_get_key(config), grid, NULL, global_size);
-    initial_field               = field_alloc(initial_field_config);
+  const void * init_data = init_file ? field_get_init_data(field , init_file) : NULL;
 
-    field_fload_keep_inactive(initial_field, init_file);
-  }
   switch(ecl_type_get_type(data_type)) {
   case(ECL_DOUBLE_TYPE):
     {
       const double * src_data         = (const double *) field->data;
-      const double * initial_src_data = initial_field ? (const double *) initial_field->data : NULL;
+      const double * initial_src_data = (const double *) init_data;
 
       if (ecl_type_is_float(target_data_type)) {
         float *target_data = (float *) _target_data;
@@ -154,7 +153,7 @@ void field_export3D(const field_type * field ,
   case(ECL_FLOAT_TYPE):
     {
       const float * src_data          = (const float *) field->data;
-      const float * initial_src_data = initial_field ? (const float *) initial_field->data : NULL;
+      const float * initial_src_data = (const float *) init_data;
       if (ecl_type_is_float(target_data_type)) {
         float *target_data = (float *) _target_data;
         EXPORT_MACRO;
@@ -170,7 +169,7 @@ void field_export3D(const field_type * field ,
   case(ECL_INT_TYPE):
     {
       const int * src_data         = (const int *) field->data;
-      const int * initial_src_data = initial_field ? (const int *) initial_field->data : NULL;
+      const int * initial_src_data = (const int *) init_data;
       if (ecl_type_is_float(target_data_type)) {
         float *target_data = (float *) _target_data;
         EXPORT_MACRO;
@@ -191,10 +190,8 @@ void field_export3D(const field_type * field ,
     break;
   }
 
-  if (initial_field) {
-    field_config_free(initial_field_config);
-    field_free(initial_field);
-  }
+  if (init_data != NULL)
+    field_config_release_init_data( config , init_data );
 }
 #undef EXPORT_MACRO
 
@@ -202,25 +199,13 @@ void field_export3D(const field_type * field ,
 /*****************************************************************/
 #define IMPORT_MACRO                                                                                                                      \
 {                                                                                                                                         \
-  int i,j,k;                                                                                                                              \
-  int nx,ny,nz;                                                                                                                           \
-  field_config_get_dims(field->config , &nx , &ny , &nz);                                                                                 \
-  for (k=0; k < nz; k++) {                                                                                                                \
-    for (j=0; j < ny; j++) {                                                                                                              \
-      for (i=0; i < nx; i++) {                                                                                                            \
-        int target_index = keep_inactive_cells ? field_config_global_index(config, i, j, k) : field_config_active_index(config, i, j, k); \
-                                                                                                                                          \
-        if (target_index >= 0) {                                                                                                          \
-          int source_index;                                                                                                               \
-          if (rms_index_order)                                                                                                            \
-            source_index = rms_util_global_index_from_eclipse_ijk(nx,ny,nz,i,j,k);                                                        \
-          else                                                                                                                            \
-            source_index = i + j * nx + k* nx*ny;                                                                                         \
-                                                                                                                                          \
-          target_data[target_index] = src_data[source_index] ;                                                                            \
-        }                                                                                                                                 \
-      }                                                                                                                                   \
-    }                                                                                                                                     \
+  const int * target_map = keep_inactive_cells ? field_config_get_global_map(config , rms_index_order) :                                  \
+                                                 field_config_get_active_map(config , rms_index_order);                                   \
+  const int volume       = field_config_get_volume(config);                                                                               \
+  for (int index = 0; index < volume; index++) {                                                                                          \
+    int target_index = target_map[index];                                                                                                 \
+    if (target_index >= 0)                                                                                                                \
+      target_data[target_index] = src_data[index];                                                                                        \
   }                                                                                                                                       \
 }                                                                                                                                         \
 
@@ -605,15 +590,10 @@ static void field_apply(field_type * field , field_func_type * func) {
     const int data_size          = field_config_get_data_size( field->config );
     const ecl_data_type data_type = field_config_get_ecl_data_type(field->config);
 
-    if (ecl_type_is_float(data_type)) {
-      float * data = (float *) field->data;
-      for (int i=0; i < data_size; i++)
-        data[i] = func(data[i]);
-    } else if (ecl_type_is_double(data_type)) {
-      double * data = (double *) field->data;
-      for (int i=0; i < data_size; i++)
-        data[i] = func(data[i]);
-    }
+    if (ecl_type_is_float(data_type))
+      field_trans_apply_float(func , (float *) field->data , data_size);
+    else if (ecl_type_is_double(data_type))
+      field_trans_apply_double(func , (double *) field->data , data_size);
   }
 }
 
@@ -647,17 +627,6 @@ void  field_inplace_output_transform(field_type * field ) {
 
 
 
-#define TRUNCATE_MACRO(s , d , t , min , max)  \
-for (int i=0; i < s; i++) {                    \
-  if ( t & TRUNCATE_MIN )                      \
-    if (d[i] < min)                            \
-      d[i] = min;                              \
-  if ( t & TRUNCATE_MAX )                      \
-    if (d[i] > max)                            \
-      d[i] = max;                              \
-}
-
-
 static void field_apply_truncation(field_type * field) {
   truncation_type   truncation = field_config_get_truncation_mode( field->config );
   if (truncation != TRUNCATE_NONE) {
@@ -666,13 +635,11 @@ static void field_apply_truncation(field_type * field) {
 
     const int data_size           = field_config_get_data_size(field->config );
     const ecl_data_type data_type = field_config_get_ecl_data_type(field->config);
-    if (ecl_type_is_float(data_type)) {
-      float * data = (float *) field->data;
-      TRUNCATE_MACRO(data_size , data , truncation , min_value , max_value);
-    } else if (ecl_type_is_double(data_type)) {
-      double * data = (double *) field->data;
-      TRUNCATE_MACRO(data_size , data , truncation , min_value , max_value);
-    } else
+    if (ecl_type_is_float(data_type))
+      field_trans_truncate_float((float *) field->data , data_size , truncation , min_value , max_value);
+    else if (ecl_type_is_double(data_type))
+      field_trans_truncate_double((double *) field->data , data_size , truncation , min_value , max_value);
+    else
       util_abort("%s: Field type not supported for truncation \n",__func__);
   }
 }
@@ -1078,6 +1045,27 @@ void field_copy_ecl_kw_data(field_type * field , const ecl_kw_type * ecl_kw) {
 
 /*****************************************************************/
 
+static ecl_data_type field_rms_ecl_data_type(rms_type_enum rms_type) {
+  switch (rms_type) {
+  case(rms_float_type):
+    return ECL_FLOAT;
+  case(rms_double_type):
+    return ECL_DOUBLE;
+  case(rms_int_type):
+    return ECL_INT;
+  default:
+    util_abort("%s: sorry rms_type: %d not implemented - aborting \n",__func__ , rms_type);
+    return ECL_INT; /* Dummy */
+  }
+}
+
+
+/*
+  The ROFF file is indexed with rms_file_index, and the data of the
+  parameter tag is read directly into a buffer; the other parameters
+  in the file are skipped.
+*/
+
 bool field_fload_rms(field_type * field , const char * filename, bool keep_inactive) {
   {
     FILE * stream = util_fopen__( filename , "r");
@@ -1088,32 +1076,40 @@ bool field_fload_rms(field_type * field , const char * filename, bool keep_inact
   }
 
   {
-    const char * key           = field_config_get_ecl_kw_name(field->config);
-    rms_file_type * rms_file   = rms_file_alloc(filename , false);
-    rms_tagkey_type * data_tag;
+    const char * key              = field_config_get_ecl_kw_name(field->config);
+    rms_file_index_type * index   = rms_file_index_alloc(filename);
+    int tag_nr;
+
     if (field_config_enkf_mode(field->config))
-      data_tag = rms_file_fread_alloc_data_tagkey(rms_file , "parameter" , "name" , key);
+      tag_nr = rms_file_index_find_tag(index , "parameter" , "name" , key);
     else {
       /**
           Setting the key - purely to support converting between
           different types of files, without knowing the key. A usable
           feature - but not really well defined.
       */
-
-      rms_tag_type * rms_tag = rms_file_fread_alloc_tag(rms_file , "parameter" , NULL , NULL);
-      const char * parameter_name = rms_tag_get_namekey_name(rms_tag);
-      field_config_set_key( (field_config_type *) field->config , parameter_name );
-      data_tag = rms_tagkey_copyc( rms_tag_get_key(rms_tag , "data") );
-      rms_tag_free(rms_tag);
+      tag_nr = rms_file_index_find_tag(index , "parameter" , NULL , NULL);
+      if (tag_nr >= 0)
+        field_config_set_key( (field_config_type *) field->config , rms_file_index_iget_key_string(index , tag_nr , "name"));
     }
 
-    ecl_data_type data_type = rms_tagkey_get_ecl_data_type(data_tag);
-    if (rms_tagkey_get_size(data_tag) != field_config_get_volume(field->config))
-      util_abort("%s: trying to import rms_data_tag from:%s with wrong size - aborting \n",__func__ , filename);
+    if (tag_nr < 0)
+      util_abort("%s: could not find parameter:%s in file:%s - aborting \n",__func__ , key , filename);
+
+    {
+      ecl_data_type data_type = field_rms_ecl_data_type( rms_file_index_iget_key_type(index , tag_nr , "data"));
+      int size = rms_file_index_iget_key_size(index , tag_nr , "data");
+      void * data;
 
-    field_import3D(field , rms_tagkey_get_data_ref(data_tag) , true , keep_inactive, data_type);
-    rms_tagkey_free(data_tag);
-    rms_file_free(rms_file);
+      if (size != field_config_get_volume(field->config))
+        util_abort("%s: trying to import rms_data_tag from:%s with wrong size - aborting \n",__func__ , filename);
+
+      data = util_malloc( size * rms_file_index_iget_key_sizeof_ctype(index , tag_nr , "data"));
+      rms_file_index_iget_key_data(index , tag_nr , "data" , data);
+      field_import3D(field , data , true , keep_inactive, data_type);
+      free( data );
+    }
+    rms_file_index_free(index);
   }
   return true;
 }
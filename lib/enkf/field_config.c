@@ -19,9 +19,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include <ert/util/util.h>
 #include <ert/util/string_util.h>
+#include <ert/util/vector.h>
 
 #include <ert/ecl/ecl_grid.h>
 #include <ert/ecl/ecl_kw.h>
@@ -154,9 +156,24 @@ struct field_config_struct {
   char * output_transform_name;
   char * init_transform_name;
   char * input_transform_name;
+
+  /*****************************************************************/
+  pthread_mutex_t         cache_lock;           /* Protects the lazily created index maps and init data below. */
+  int                   * active_map[2];        /* Index in a 3D export buffer -> active index, -1 for inactive cells. [0]: ECLIPSE order, [1]: RMS order. */
+  int                   * global_map[2];        /* Index in a 3D export buffer -> global index. */
+  vector_type           * init_data;            /* Cached content of INIT_FILE(s) used to fill inactive cells on export. */
 };
 
 
+typedef struct {
+  char   * filename;
+  time_t   mtime;
+  void   * data;
+  int      refcount;   /* The number of callers currently using data. */
+  bool     stale;      /* The file has been modified; freed when refcount drops to zero. */
+} field_init_data_type;
+
+
 UTIL_IS_INSTANCE_FUNCTION(field_config , FIELD_CONFIG_ID)
 
 /*****************************************************************/
@@ -318,10 +335,22 @@ const char * field_config_get_output_transform_name( const field_config_type * f
 */
 
 
+static void field_config_clear_index_maps( field_config_type * config ) {
+  for (int order = 0; order < 2; order++) {
+    util_safe_free( config->active_map[order] );
+    util_safe_free( config->global_map[order] );
+    config->active_map[order] = NULL;
+    config->global_map[order] = NULL;
+  }
+}
+
+
 void field_config_set_grid(field_config_type * config, ecl_grid_type * grid , bool private_grid) {
   if ((config->private_grid) && (config->grid != NULL))
     ecl_grid_free( config->grid );
 
+  field_config_clear_index_maps( config );
+
   config->grid         = grid;
   config->private_grid = private_grid;
 
@@ -365,6 +394,13 @@ field_config_type * field_config_alloc_empty( const char * ecl_kw_name , ecl_gri
   config->min_std          = NULL;
   config->trans_table      = trans_table;
 
+  pthread_mutex_init( &config->cache_lock , NULL );
+  for (int order = 0; order < 2; order++) {
+    config->active_map[order] = NULL;
+    config->global_map[order] = NULL;
+  }
+  config->init_data = vector_alloc_new();
+
   field_config_set_grid(config , ecl_grid , false);       /* The grid is (currently) set on allocation and can NOT be updated afterwards. */
   field_config_set_ecl_data_type( config , ECL_FLOAT );   /* This is the internal type - currently not exported any API to change it. */
   return config;
@@ -606,6 +642,9 @@ void field_config_free(field_config_type * config) {
   util_safe_free(config->output_transform_name);
   util_safe_free(config->init_transform_name);
   if ((config->private_grid) && (config->grid != NULL)) ecl_grid_free( config->grid );
+  field_config_clear_index_maps( config );
+  vector_free( config->init_data );
+  pthread_mutex_destroy( &config->cache_lock );
   free(config);
 }
 
@@ -655,6 +694,181 @@ bool field_config_active_cell(const field_config_type * config , int i , int j ,
 
 
 
+/**
+   The field_export3D() and field_import3D() functions map between the
+   internal storage, indexed with active or global index, and a 3D
+   buffer of nx*ny*nz elements in either ECLIPSE (i fastest) or RMS
+   (k fastest and reversed) order. The permutations are computed once
+   per config and order; the export/import is then a plain gather or
+   scatter over these arrays.
+*/
+
+static void field_config_alloc_index_maps( field_config_type * config , bool rms_index_order ) {
+  const int volume = field_config_get_volume( config );
+  const int order  = rms_index_order ? 1 : 0;
+  int * active_map = util_calloc( volume , sizeof * active_map );
+  int * global_map = util_calloc( volume , sizeof * global_map );
+
+  for (int k=0; k < config->nz; k++) {
+    for (int j=0; j < config->ny; j++) {
+      for (int i=0; i < config->nx; i++) {
+        int index;
+        if (rms_index_order)
+          index = rms_util_global_index_from_eclipse_ijk( config->nx , config->ny , config->nz , i , j , k);
+        else
+          index = i + j * config->nx + k * config->nx * config->ny;
+
+        active_map[index] = field_config_active_index( config , i , j , k);
+        global_map[index] = field_config_global_index( config , i , j , k);
+      }
+    }
+  }
+
+  config->global_map[order] = global_map;
+  config->active_map[order] = active_map;
+}
+
+
+static void field_config_assert_index_maps( const field_config_type * __config , bool rms_index_order ) {
+  field_config_type * config = (field_config_type *) __config;
+  const int order = rms_index_order ? 1 : 0;
+
+  pthread_mutex_lock( &config->cache_lock );
+  if (config->active_map[order] == NULL)
+    field_config_alloc_index_maps( config , rms_index_order );
+  pthread_mutex_unlock( &config->cache_lock );
+}
+
+
+const int * field_config_get_active_map( const field_config_type * config , bool rms_index_order ) {
+  field_config_assert_index_maps( config , rms_index_order );
+  return config->active_map[ rms_index_order ? 1 : 0 ];
+}
+
+
+const int * field_config_get_global_map( const field_config_type * config , bool rms_index_order ) {
+  field_config_assert_index_maps( config , rms_index_order );
+  return config->global_map[ rms_index_order ? 1 : 0 ];
+}
+
+
+/*****************************************************************/
+
+static void field_init_data_free__( void * arg ) {
+  field_init_data_type * init_data = (field_init_data_type *) arg;
+  free( init_data->filename );
+  free( init_data->data );
+  free( init_data );
+}
+
+
+static field_init_data_type * field_config_lookup_init_data__( const field_config_type * config , const char * init_file , time_t mtime) {
+  for (int i = 0; i < vector_get_size( config->init_data ); i++) {
+    field_init_data_type * init_data = vector_iget( config->init_data , i );
+    if (!init_data->stale && (init_data->mtime == mtime) && util_string_equal( init_data->filename , init_file ))
+      return init_data;
+  }
+  return NULL;
+}
+
+
+static void field_config_drop_init_data__( field_config_type * config , int index ) {
+  field_init_data_type * init_data = vector_iget( config->init_data , index );
+  if (init_data->stale && (init_data->refcount == 0))
+    vector_idel( config->init_data , index );
+}
+
+
+/**
+   The content of the INIT_FILE used to fill inactive cells on export
+   is loaded by field.c and cached here, keyed by filename and
+   modification time. There is at most one current entry per filename;
+   when the file has been modified the old entry is replaced.
+
+   The functions returning cached data take a reference which must be
+   returned with field_config_release_init_data(); the data of a
+   replaced entry is freed when the last reference has been released,
+   so the returned pointer can be used without holding any lock.
+*/
+
+const void * field_config_get_init_data( const field_config_type * __config , const char * init_file ) {
+  field_config_type * config = (field_config_type *) __config;
+  const void * data = NULL;
+
+  pthread_mutex_lock( &config->cache_lock );
+  {
+    field_init_data_type * init_data = field_config_lookup_init_data__( config , init_file , util_file_mtime( init_file ));
+    if (init_data != NULL) {
+      init_data->refcount++;
+      data = init_data->data;
+    }
+  }
+  pthread_mutex_unlock( &config->cache_lock );
+
+  return data;
+}
+
+
+/*
+  Takes ownership of @data; if another thread has already inserted
+  data for the same file @data is discarded and the existing data is
+  returned.
+*/
+
+const void * field_config_add_init_data( const field_config_type * __config , const char * init_file , void * data ) {
+  field_config_type * config = (field_config_type *) __config;
+  time_t mtime = util_file_mtime( init_file );
+  field_init_data_type * init_data;
+
+  pthread_mutex_lock( &config->cache_lock );
+  init_data = field_config_lookup_init_data__( config , init_file , mtime );
+  if (init_data == NULL) {
+    for (int i = vector_get_size( config->init_data ) - 1; i >= 0; i--) {
+      field_init_data_type * old_data = vector_iget( config->init_data , i );
+      if (util_string_equal( old_data->filename , init_file )) {
+        old_data->stale = true;
+        field_config_drop_init_data__( config , i );
+      }
+    }
+
+    init_data = util_malloc( sizeof * init_data );
+    init_data->filename = util_alloc_string_copy( init_file );
+    init_data->mtime    = mtime;
+    init_data->data     = data;
+    init_data->refcount = 0;
+    init_data->stale    = false;
+    vector_append_owned_ref( config->init_data , init_data , field_init_data_free__ );
+  } else
+    free( data );
+  init_data->refcount++;
+  pthread_mutex_unlock( &config->cache_lock );
+
+  return init_data->data;
+}
+
+
+void field_config_release_init_data( const field_config_type * __config , const void * data ) {
+  field_config_type * config = (field_config_type *) __config;
+
+  pthread_mutex_lock( &config->cache_lock );
+  for (int i = 0; i < vector_get_size( config->init_data ); i++) {
+    field_init_data_type * init_data = vector_iget( config->init_data , i );
+    if (init_data->data == data) {
+      init_data->refcount--;
+      field_config_drop_init_data__( config , i );
+      break;
+    }
+  }
+  pthread_mutex_unlock( &config->cache_lock );
+}
+
+
+int field_config_get_num_init_data( const field_config_type * config ) {
+  return vector_get_size( config->init_data );
+}
+
+
+
  void field_config_get_dims(const field_config_type * config , int *nx , int *ny , int *nz) {
    *nx = config->nx;
    *ny = config->ny;
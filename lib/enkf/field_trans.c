@@ -35,6 +35,7 @@
 #include <ert/util/hash.h>
 #include <ert/util/util.h>
 
+#include <ert/enkf/enkf_types.h>
 #include <ert/enkf/field_trans.h>
 /*****************************************************************/
 
@@ -187,6 +188,8 @@ void field_trans_table_free(field_trans_table_type * table ) {
 /*                                                               */
 /*  1. Write the function - as a float in - float out.           */
 /*  2. Register the function in field_trans_table_alloc().       */
+/*  3. Optionally write a batch version, and add it to the       */
+/*     field_trans_vector_funcs table.                           */
 /*                                                               */
 /*****************************************************************/
 
@@ -259,6 +262,154 @@ static float field_trans_exp0( float x ) {
 
 
 
+/*****************************************************************/
+/*
+  Batch versions of the builtin functions. They operate on a complete
+  array in one call; the function pointer is resolved once for the
+  array instead of once per element. The result is the same as
+  applying the scalar function element by element.
+*/
+
+static void field_trans_pow10_vector(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = powf(10.0 , data[i]);
+}
+
+static void trunc_pow10f_vector(float * data , int size) {
+  for (int i=0; i < size; i++) {
+    float y = powf(10.0 , data[i]);
+    data[i] = (y > 0.001f) ? y : 0.001f;
+  }
+}
+
+static void field_trans_log_vector(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = logf(data[i]);
+}
+
+static void field_trans_log10_vector(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = log10f(data[i]);
+}
+
+static void field_trans_exp_vector(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = expf(data[i]);
+}
+
+static void field_trans_sqrt_vector(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = sqrtf(data[i]);
+}
+
+#define LN_SHIFT 0.0000001
+static void field_trans_ln0_vector(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = logf(data[i] + LN_SHIFT);
+}
+
+static void field_trans_exp0_vector(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = expf(data[i]) - LN_SHIFT;
+}
+#undef LN_SHIFT
+
+
+typedef struct {
+  field_func_type        * func;
+  field_vector_func_type * vector_func;
+} field_vector_func_node_type;
+
+
+static const field_vector_func_node_type field_trans_vector_funcs[] = {{field_trans_pow10 , field_trans_pow10_vector},
+                                                                       {trunc_pow10f      , trunc_pow10f_vector},
+                                                                       {logf              , field_trans_log_vector},
+                                                                       {log10f            , field_trans_log10_vector},
+                                                                       {expf              , field_trans_exp_vector},
+                                                                       {sqrtf             , field_trans_sqrt_vector},
+                                                                       {field_trans_ln0   , field_trans_ln0_vector},
+                                                                       {field_trans_exp0  , field_trans_exp0_vector}};
+
+
+/**
+   Returns the batch version of @func, or NULL if @func does not have
+   one; i.e. user supplied functions.
+*/
+
+field_vector_func_type * field_trans_get_vector_func(field_func_type * func) {
+  const int num_funcs = sizeof field_trans_vector_funcs / sizeof field_trans_vector_funcs[0];
+  for (int i=0; i < num_funcs; i++)
+    if (field_trans_vector_funcs[i].func == func)
+      return field_trans_vector_funcs[i].vector_func;
+
+  return NULL;
+}
+
+
+void field_trans_apply_float(field_func_type * func , float * data , int size) {
+  field_vector_func_type * vector_func = field_trans_get_vector_func( func );
+  if (vector_func != NULL)
+    vector_func( data , size );
+  else {
+    for (int i=0; i < size; i++)
+      data[i] = func(data[i]);
+  }
+}
+
+
+void field_trans_apply_double(field_func_type * func , double * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = func(data[i]);
+}
+
+
+/*
+  The truncation mode is checked once, outside the loops. For float
+  data the double limits are replaced with the float thresholds which
+  give exactly the same comparison result, so the loops are pure float
+  code: x < min_value <=> x < lower, where lower is the smallest float
+  >= min_value, and correspondingly for the max value.
+*/
+
+#define TRUNCATE_VECTOR(data , size , truncation , lower , upper , min , max , ctype) \
+{                                                                                     \
+  if ((truncation & TRUNCATE_MIN) && (truncation & TRUNCATE_MAX)) {                   \
+    for (int i=0; i < size; i++) {                                                    \
+      ctype x = (data[i] < lower) ? min : data[i];                                    \
+      data[i] = (x > upper) ? max : x;                                                \
+    }                                                                                 \
+  } else if (truncation & TRUNCATE_MIN) {                                             \
+    for (int i=0; i < size; i++)                                                      \
+      data[i] = (data[i] < lower) ? min : data[i];                                    \
+  } else if (truncation & TRUNCATE_MAX) {                                             \
+    for (int i=0; i < size; i++)                                                      \
+      data[i] = (data[i] > upper) ? max : data[i];                                    \
+  }                                                                                   \
+}
+
+
+void field_trans_truncate_float(float * data , int size , int truncation , double min_value , double max_value) {
+  const float min = min_value;
+  const float max = max_value;
+  float lower = min;
+  float upper = max;
+
+  if (lower < min_value)
+    lower = nextafterf(lower , INFINITY);
+
+  if (upper > max_value)
+    upper = nextafterf(upper , -INFINITY);
+
+  TRUNCATE_VECTOR(data , size , truncation , lower , upper , min , max , float);
+}
+
+
+void field_trans_truncate_double(double * data , int size , int truncation , double min_value , double max_value) {
+  TRUNCATE_VECTOR(data , size , truncation , min_value , max_value , min_value , max_value , double);
+}
+#undef TRUNCATE_VECTOR
+
+
 field_trans_table_type * field_trans_table_alloc() {
   field_trans_table_type * table = util_malloc( sizeof * table);
   table->function_table = hash_alloc();
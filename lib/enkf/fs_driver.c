@@ -46,6 +46,7 @@ void fs_driver_init(fs_driver_type * driver) {
   driver->save_vector   = NULL;
   driver->has_vector    = NULL;
   driver->unlink_vector = NULL;
+  driver->save_vectors  = NULL;
   
   driver->free_driver   = NULL;
   driver->fsync_driver  = NULL;
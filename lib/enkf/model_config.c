@@ -98,6 +98,12 @@ struct model_config_struct {
   char                 * default_data_root;
 
   fs_driver_impl         dbase_type;
+  bool                   summary_store;              /* Should the cases keep a columnar summary store - see summary_store.c. */
+  int                    summary_store_max_pending;  /* MB of summary tables the store can keep in memory before writing. */
+  int                    fsync_interval;             /* The block_fs fsync policy - see block_fs_set_fsync_policy(). */
+  int                    fsync_mb;
+  double                 fsync_seconds;
+  block_fs_codec_type    codec;                      /* Compression of the stored nodes - see block_fs_set_codec(). */
   bool                   has_prediction;
   int                    max_internal_submit;        /* How many times to retry if the load fails. */
   const ecl_sum_type   * refcase;                    /* A pointer to the refcase - can be NULL. Observe that this ONLY a pointer
@@ -220,6 +226,51 @@ fs_driver_impl model_config_get_dbase_type(const model_config_type * model_confi
   return model_config->dbase_type;
 }
 
+bool model_config_get_summary_store( const model_config_type * model_config ) {
+  return model_config->summary_store;
+}
+
+void model_config_set_summary_store( model_config_type * model_config , bool summary_store , int max_pending_mb ) {
+  if (max_pending_mb <= 0)
+    util_abort("%s: the maximum pending memory for the summary store must be positive\n",__func__);
+
+  model_config->summary_store = summary_store;
+  model_config->summary_store_max_pending = max_pending_mb;
+}
+
+int model_config_get_summary_store_max_pending( const model_config_type * model_config ) {
+  return model_config->summary_store_max_pending;
+}
+
+void model_config_set_fsync_policy( model_config_type * model_config , int fsync_interval , int fsync_mb , double fsync_seconds ) {
+  if ((fsync_interval < 0) || (fsync_mb < 0) || (fsync_seconds < 0))
+    util_abort("%s: the fsync policy values can not be negative\n",__func__);
+
+  model_config->fsync_interval = fsync_interval;
+  model_config->fsync_mb = fsync_mb;
+  model_config->fsync_seconds = fsync_seconds;
+}
+
+int model_config_get_fsync_interval( const model_config_type * model_config ) {
+  return model_config->fsync_interval;
+}
+
+int model_config_get_fsync_mb( const model_config_type * model_config ) {
+  return model_config->fsync_mb;
+}
+
+double model_config_get_fsync_seconds( const model_config_type * model_config ) {
+  return model_config->fsync_seconds;
+}
+
+void model_config_set_codec( model_config_type * model_config , block_fs_codec_type codec ) {
+  model_config->codec = codec;
+}
+
+block_fs_codec_type model_config_get_codec( const model_config_type * model_config ) {
+  return model_config->codec;
+}
+
 const ecl_sum_type * model_config_get_refcase( const model_config_type * model_config ) {
   return model_config->refcase;
 }
@@ -292,6 +343,12 @@ model_config_type * model_config_alloc_empty() {
   model_config->data_root                 = NULL;
   model_config->default_data_root         = NULL;
   model_config->dbase_type                = INVALID_DRIVER_ID;
+  model_config->summary_store             = DEFAULT_SUMMARY_STORE;
+  model_config->summary_store_max_pending = DEFAULT_SUMMARY_STORE_MAX_PENDING_MB;
+  model_config->fsync_interval            = DEFAULT_BLOCK_FS_FSYNC_INTERVAL;
+  model_config->fsync_mb                  = DEFAULT_BLOCK_FS_FSYNC_MB;
+  model_config->fsync_seconds             = DEFAULT_BLOCK_FS_FSYNC_SECONDS;
+  model_config->codec                     = DEFAULT_BLOCK_FS_CODEC;
   model_config->current_runpath           = NULL;
   model_config->current_path_key          = NULL;
   model_config->history                   = NULL;
@@ -546,6 +603,42 @@ void model_config_init(model_config_type * model_config ,
   if (config_content_has_item( config , DBASE_TYPE_KEY))
     model_config_set_dbase_type( model_config , config_content_get_value(config , DBASE_TYPE_KEY));
 
+  if (config_content_has_item( config , SUMMARY_STORE_KEY)) {
+    const config_content_item_type * item = config_content_get_item( config , SUMMARY_STORE_KEY );
+    const config_content_node_type * node = config_content_item_get_last_node( item );
+    int max_pending_mb = DEFAULT_SUMMARY_STORE_MAX_PENDING_MB;
+
+    if (config_content_node_get_size( node ) > 1)
+      max_pending_mb = config_content_node_iget_as_int( node , 1 );
+
+    model_config_set_summary_store( model_config , config_content_node_iget_as_bool( node , 0 ) , max_pending_mb );
+  }
+
+  if (config_content_has_item( config , BLOCK_FS_FSYNC_KEY)) {
+    const config_content_item_type * item = config_content_get_item( config , BLOCK_FS_FSYNC_KEY );
+    const config_content_node_type * node = config_content_item_get_last_node( item );
+    int fsync_mb = DEFAULT_BLOCK_FS_FSYNC_MB;
+    double fsync_seconds = DEFAULT_BLOCK_FS_FSYNC_SECONDS;
+
+    if (config_content_node_get_size( node ) > 1)
+      fsync_mb = config_content_node_iget_as_int( node , 1 );
+
+    if (config_content_node_get_size( node ) > 2)
+      fsync_seconds = config_content_node_iget_as_double( node , 2 );
+
+    model_config_set_fsync_policy( model_config , config_content_node_iget_as_int( node , 0 ) , fsync_mb , fsync_seconds );
+  }
+
+  if (config_content_has_item( config , BLOCK_FS_CODEC_KEY)) {
+    const char * codec = config_content_get_value( config , BLOCK_FS_CODEC_KEY );
+    if (util_string_equal( codec , "ZLIB" ))
+      model_config_set_codec( model_config , BLOCK_FS_CODEC_ZLIB );
+    else if (util_string_equal( codec , "SHUFFLE_RLE" ))
+      model_config_set_codec( model_config , BLOCK_FS_CODEC_SHUFFLE_RLE );
+    else
+      model_config_set_codec( model_config , BLOCK_FS_CODEC_NONE );
+  }
+
   if (config_content_has_item( config , MAX_RESAMPLE_KEY))
     model_config_set_max_internal_submit( model_config , config_content_get_value_as_int( config , MAX_RESAMPLE_KEY ));
 
@@ -812,6 +905,23 @@ static void model_config_init_user_config(config_parser_type * config ) {
           item, 2, (const char *[2]) {"PLAIN" , "BLOCK_FS"}
           );
 
+  item = config_add_schema_item(config, SUMMARY_STORE_KEY, false);
+  config_schema_item_set_argc_minmax(item , 1, 2);
+  config_schema_item_iset_type(item, 0, CONFIG_BOOL);
+  config_schema_item_iset_type(item, 1, CONFIG_INT);
+
+  item = config_add_schema_item(config, BLOCK_FS_FSYNC_KEY, false);
+  config_schema_item_set_argc_minmax(item , 1, 3);
+  config_schema_item_iset_type(item, 0, CONFIG_INT);
+  config_schema_item_iset_type(item, 1, CONFIG_INT);
+  config_schema_item_iset_type(item, 2, CONFIG_FLOAT);
+
+  item = config_add_schema_item(config, BLOCK_FS_CODEC_KEY, false);
+  config_schema_item_set_argc_minmax(item , 1, 1);
+  config_schema_item_set_common_selection_set(
+          item, 3, (const char *[3]) {"NONE" , "ZLIB" , "SHUFFLE_RLE"}
+          );
+
   item = config_add_schema_item(config, FORWARD_MODEL_KEY, false);
   config_schema_item_set_argc_minmax(item , 1, CONFIG_DEFAULT_ARG_MAX);
 
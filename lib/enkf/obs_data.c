@@ -70,6 +70,10 @@ Matrices: S, D, E and various internal variables.
 #include <ert/util/vector.h>
 #include <ert/res_util/matrix.h>
 #include <ert/util/rng.h>
+#include <ert/util/arg_pack.h>
+#include <ert/util/int_vector.h>
+#include <ert/res_util/thread_pool.h>
+#include <ert/res_util/counter_rng.h>
 
 #include <ert/enkf/obs_data.h>
 #include <ert/enkf/meas_data.h>
@@ -249,7 +253,7 @@ static void obs_block_initdObs( const obs_block_type * obs_block , matrix_type *
 
 
 
-static void obs_block_initR( const obs_block_type * obs_block , matrix_type * R, int * __obs_offset) {
+static void obs_block_initR( const obs_block_type * obs_block , obs_covar_type * R, int * __obs_offset) {
   int obs_offset = *__obs_offset;
   if (obs_block->error_covar == NULL) {
     int iobs;
@@ -257,24 +261,27 @@ static void obs_block_initR( const obs_block_type * obs_block , matrix_type * R,
     for (iobs =0; iobs < obs_block->size; iobs++) {
       if (obs_block->active_mode[iobs] == ACTIVE) {
         double var = obs_block_iget_std(obs_block, iobs) * obs_block_iget_std(obs_block, iobs);
-        matrix_iset_safe(R , obs_offset + iactive, obs_offset + iactive, var);
+        obs_covar_iset_var(R , obs_offset + iactive, var);
         iactive++;
       }
     }
-  } else {
+  } else if (obs_block->active_size > 0) {
+    matrix_type * block = matrix_alloc( obs_block->active_size , obs_block->active_size );
     int row_active = 0;   /* We have a covar matrix */
     for (int row = 0; row < obs_block->size; row++) {
       if (obs_block->active_mode[row] == ACTIVE) {
         int col_active = 0;
         for (int col = 0; col < obs_block->size; col++) {
           if (obs_block->active_mode[col] == ACTIVE) {
-            matrix_iset_safe(R , obs_offset + row_active , obs_offset + col_active , matrix_iget( obs_block->error_covar , row , col ));
+            matrix_iset( block , row_active , col_active , matrix_iget( obs_block->error_covar , row , col ));
             col_active++;
           }
         }
         row_active++;
       }
     }
+    obs_covar_add_block( R , obs_offset , block );
+    matrix_free( block );
   }
 
   *__obs_offset = obs_offset + obs_block->active_size;
@@ -380,30 +387,19 @@ void obs_data_free(obs_data_type * obs_data) {
 
 
 
-matrix_type * obs_data_allocE(const obs_data_type * obs_data , rng_type * rng , int active_ens_size ) {
+/*
+  Centres the perturbations in E, and scales them with the observation
+  error std, so that each row has the sample variance std^2.
+*/
+
+static void obs_data_centreE(const obs_data_type * obs_data , matrix_type * E) {
+  int active_obs_size = matrix_get_rows( E );
+  int active_ens_size = matrix_get_columns( E );
   double *pert_mean , *pert_var;
-  matrix_type * E;
   int iens, iobs_active;
-  int active_obs_size = obs_data_get_active_size( obs_data );
-
-  E         = matrix_alloc( active_obs_size , active_ens_size);
 
   pert_mean = util_calloc(active_obs_size , sizeof * pert_mean );
   pert_var  = util_calloc(active_obs_size , sizeof * pert_var  );
-  {
-    double * tmp = util_calloc( active_obs_size * active_ens_size , sizeof * tmp );
-    int i,j;
-    int k = 0;
-
-    enkf_util_rand_stdnormal_vector(active_obs_size * active_ens_size , tmp , rng);
-    for (j=0; j < active_ens_size; j++) {
-      for (i=0; i < active_obs_size; i++) {
-        matrix_iset( E , i , j , tmp[k]);
-        k++;
-      }
-    }
-    free(tmp);
-  }
 
   for (iobs_active = 0; iobs_active < active_obs_size; iobs_active++) {
     pert_mean[iobs_active] = 0;
@@ -440,6 +436,30 @@ matrix_type * obs_data_allocE(const obs_data_type * obs_data , rng_type * rng ,
 
   free(pert_mean);
   free(pert_var);
+}
+
+
+matrix_type * obs_data_allocE(const obs_data_type * obs_data , rng_type * rng , int active_ens_size ) {
+  matrix_type * E;
+  int active_obs_size = obs_data_get_active_size( obs_data );
+
+  E         = matrix_alloc( active_obs_size , active_ens_size);
+  {
+    double * tmp = util_calloc( active_obs_size * active_ens_size , sizeof * tmp );
+    int i,j;
+    int k = 0;
+
+    enkf_util_rand_stdnormal_vector(active_obs_size * active_ens_size , tmp , rng);
+    for (j=0; j < active_ens_size; j++) {
+      for (i=0; i < active_obs_size; i++) {
+        matrix_iset( E , i , j , tmp[k]);
+        k++;
+      }
+    }
+    free(tmp);
+  }
+
+  obs_data_centreE( obs_data , E );
 
   matrix_set_name( E , "E");
   matrix_assert_finite( E );
@@ -447,6 +467,84 @@ matrix_type * obs_data_allocE(const obs_data_type * obs_data , rng_type * rng ,
 }
 
 
+static void * obs_data_allocE_counter_mt( void * arg ) {
+  arg_pack_type * arg_pack                = arg_pack_safe_cast( arg );
+  matrix_type * E                         = arg_pack_iget_ptr( arg_pack , 0 );
+  const counter_rng_type * counter_rng    = arg_pack_iget_const_ptr( arg_pack , 1 );
+  unsigned int stream                     = arg_pack_iget_int( arg_pack , 2 );
+  const int_vector_type * iens_list       = arg_pack_iget_const_ptr( arg_pack , 3 );
+  int column1                             = arg_pack_iget_int( arg_pack , 4 );
+  int column2                             = arg_pack_iget_int( arg_pack , 5 );
+  int rows , columns , row_stride , column_stride;
+  double * data = matrix_get_data( E );
+
+  matrix_get_dims( E , &rows , &columns , &row_stride , &column_stride );
+  for (int column = column1; column < column2; column++)
+    counter_rng_std_normal_vector( counter_rng ,
+                                   stream ,
+                                   int_vector_iget( iens_list , column ) ,
+                                   0 ,
+                                   rows ,
+                                   &data[ column * column_stride ] ,
+                                   row_stride );
+  return NULL;
+}
+
+
+/**
+   As obs_data_allocE(), but the perturbations are drawn from the
+   counter based rng: the unscaled perturbation of active observation
+   i for realization iens is a function of (stream , iens , i) only.
+   The @iens_list vector gives the realization number of each column
+   in E. The columns are generated by @num_threads threads, and the
+   result does not depend on the number of threads.
+*/
+
+matrix_type * obs_data_allocE_counter(const obs_data_type * obs_data , const counter_rng_type * counter_rng , unsigned int stream , const int_vector_type * iens_list , int num_threads) {
+  int active_obs_size = obs_data_get_active_size( obs_data );
+  int active_ens_size = int_vector_size( iens_list );
+  matrix_type * E     = matrix_alloc( active_obs_size , active_ens_size );
+
+  if (num_threads < 1)
+    num_threads = 1;
+  if (num_threads > active_ens_size)
+    num_threads = util_int_max( 1 , active_ens_size );
+
+  {
+    thread_pool_type * tp = thread_pool_alloc( num_threads , true );
+    arg_pack_type ** arg_list = util_calloc( num_threads , sizeof * arg_list );
+    int columns_per_thread = active_ens_size / num_threads;
+
+    for (int thread_nr = 0; thread_nr < num_threads; thread_nr++) {
+      int column1 = thread_nr * columns_per_thread;
+      int column2 = (thread_nr == num_threads - 1) ? active_ens_size : column1 + columns_per_thread;
+
+      arg_list[thread_nr] = arg_pack_alloc( );
+      arg_pack_append_ptr( arg_list[thread_nr] , E );
+      arg_pack_append_const_ptr( arg_list[thread_nr] , counter_rng );
+      arg_pack_append_int( arg_list[thread_nr] , stream );
+      arg_pack_append_const_ptr( arg_list[thread_nr] , iens_list );
+      arg_pack_append_int( arg_list[thread_nr] , column1 );
+      arg_pack_append_int( arg_list[thread_nr] , column2 );
+      thread_pool_add_job( tp , obs_data_allocE_counter_mt , arg_list[thread_nr] );
+    }
+    thread_pool_join( tp );
+
+    for (int thread_nr = 0; thread_nr < num_threads; thread_nr++)
+      arg_pack_free( arg_list[thread_nr] );
+    free( arg_list );
+    thread_pool_free( tp );
+  }
+
+  obs_data_centreE( obs_data , E );
+
+  matrix_set_name( E , "E");
+  matrix_assert_finite( E );
+  return E;
+}
+
+
+
 /* Function that returns a matrix of independent, normal distributed random vector having mean zero,
  and variance (covariance) specified in the input (obs_data) file. NOTICE THE DIFFERENCE WITH allocE, WHERE THE
  RETURNED MATRIX IS CENTRED
@@ -511,9 +609,15 @@ matrix_type * obs_data_allocD(const obs_data_type * obs_data , const matrix_type
 
 
 
-matrix_type * obs_data_allocR(const obs_data_type * obs_data) {
+/**
+   The observation error covariance is allocated as a obs_covar
+   instance; only the observation blocks with a full error covariance
+   matrix are stored as dense blocks.
+*/
+
+obs_covar_type * obs_data_alloc_covar(const obs_data_type * obs_data) {
   int active_size = obs_data_get_active_size( obs_data );
-  matrix_type * R = matrix_alloc( active_size , active_size );
+  obs_covar_type * R = obs_covar_alloc( active_size );
   {
     int obs_offset = 0;
     for (int block_nr = 0; block_nr < vector_get_size( obs_data->data ); block_nr++) {
@@ -522,6 +626,15 @@ matrix_type * obs_data_allocR(const obs_data_type * obs_data) {
     }
   }
 
+  return R;
+}
+
+
+matrix_type * obs_data_allocR(const obs_data_type * obs_data) {
+  obs_covar_type * covar = obs_data_alloc_covar( obs_data );
+  matrix_type * R = obs_covar_alloc_matrix( covar );
+
+  obs_covar_free( covar );
   matrix_set_name( R , "R");
   matrix_assert_finite( R );
   return R;
@@ -609,9 +722,7 @@ void obs_data_scale_Rmatrix(const obs_data_type * obs_data , matrix_type * R) {
 }
 
 
-void obs_data_scale(const obs_data_type * obs_data , matrix_type *S , matrix_type *E , matrix_type *D , matrix_type *R , matrix_type * dObs) {
-  double * scale_factor  = obs_data_alloc_scale_factor( obs_data );
-
+static void obs_data_scale__(const double * scale_factor , matrix_type *S , matrix_type *E , matrix_type *D , matrix_type * dObs) {
   /* Scale the forecasted data so that they (in theory) have the same variance
      (if the prior distribution for the observation errors is correct) */
   obs_data_scale_matrix__( S , scale_factor );
@@ -628,7 +739,13 @@ void obs_data_scale(const obs_data_type * obs_data , matrix_type *S , matrix_typ
 
   if (dObs != NULL)
     obs_data_scale_matrix__( dObs , scale_factor );
+}
+
 
+void obs_data_scale(const obs_data_type * obs_data , matrix_type *S , matrix_type *E , matrix_type *D , matrix_type *R , matrix_type * dObs) {
+  double * scale_factor  = obs_data_alloc_scale_factor( obs_data );
+
+  obs_data_scale__( scale_factor , S , E , D , dObs );
   if (R != NULL)
     obs_data_scale_Rmatrix__(R , scale_factor);
 
@@ -636,6 +753,17 @@ void obs_data_scale(const obs_data_type * obs_data , matrix_type *S , matrix_typ
 }
 
 
+void obs_data_scale_covar(const obs_data_type * obs_data , matrix_type *S , matrix_type *E , matrix_type *D , obs_covar_type *R , matrix_type * dObs) {
+  double * scale_factor  = obs_data_alloc_scale_factor( obs_data );
+
+  obs_data_scale__( scale_factor , S , E , D , dObs );
+  if (R != NULL)
+    obs_covar_scale(R , scale_factor);
+
+  free(scale_factor);
+}
+
+
 void obs_data_scale_kernel(const obs_data_type * obs_data , matrix_type *S , matrix_type *E , matrix_type *D , double *dObs) {
   const int nrobs_active = matrix_get_rows( S );
   const int ens_size     = matrix_get_columns( S );
@@ -851,6 +851,40 @@ void obs_vector_measure(const obs_vector_type * obs_vector ,
 }
 
 
+/**
+   Same as obs_vector_measure(), but the responses are fetched through
+   the response cache; the cache is shared by all the ministeps of one
+   update.
+*/
+
+void obs_vector_measure_cached(const obs_vector_type * obs_vector ,
+                               response_cache_type * cache ,
+                               int report_step ,
+                               const int_vector_type * ens_active_list ,
+                               meas_data_type * meas_data ,
+                               const active_list_type * active_list) {
+
+  void * obs_node = vector_iget( obs_vector->nodes , report_step );
+  if ( obs_node != NULL ) {
+    enkf_node_type * work_node = enkf_node_deep_alloc( obs_vector->config_node );
+
+    node_id_type node_id = { .report_step = report_step ,
+                             .iens        = 0 };
+
+    int vec_size = int_vector_size( ens_active_list );
+    for (int active_iens_index = 0; active_iens_index < vec_size; active_iens_index++) {
+      node_id.iens = int_vector_iget( ens_active_list , active_iens_index );
+      {
+        const enkf_node_type * enkf_node = response_cache_get_node( cache , obs_vector->config_node , node_id , work_node );
+        obs_vector->measure(obs_node , enkf_node_value_ptr(enkf_node) , node_id , meas_data , active_list);
+      }
+    }
+
+    enkf_node_free( work_node );
+  }
+}
+
+
 static bool obs_vector_has_data_at_report_step( const obs_vector_type * obs_vector , const bool_vector_type * active_mask , enkf_fs_type * fs, int report_step) {
   void * obs_node = vector_iget( obs_vector->nodes , report_step );
   if ( obs_node ) {
@@ -0,0 +1,146 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'response_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/hash.h>
+
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/enkf_node.h>
+#include <ert/enkf/enkf_config_node.h>
+#include <ert/enkf/response_cache.h>
+
+/**
+   The response_cache holds the simulated responses which have been
+   loaded from one enkf_fs instance during an update. When the
+   observations of several ministeps are measured the same responses
+   are needed again and again; e.g. every summary observation for
+   every report step needs the complete summary vector of every
+   realization. With the cache each response is only loaded once per
+   update.
+
+   FIELD responses are not cached; they are large and only measured
+   in a few cells. For these nodes the response is loaded into the
+   work_node supplied by the caller, exactly as without the cache.
+*/
+
+#define RESPONSE_CACHE_TYPE_ID  772016
+
+struct response_cache_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  enkf_fs_type    * fs;
+  hash_type       * nodes;
+  pthread_mutex_t   lock;
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( response_cache , RESPONSE_CACHE_TYPE_ID )
+
+
+response_cache_type * response_cache_alloc( enkf_fs_type * fs ) {
+  response_cache_type * cache = util_malloc( sizeof * cache );
+  UTIL_TYPE_ID_INIT( cache , RESPONSE_CACHE_TYPE_ID );
+  cache->fs    = fs;
+  cache->nodes = hash_alloc();
+  pthread_mutex_init( &cache->lock , NULL );
+  return cache;
+}
+
+
+void response_cache_free( response_cache_type * cache ) {
+  hash_free( cache->nodes );
+  pthread_mutex_destroy( &cache->lock );
+  free( cache );
+}
+
+
+enkf_fs_type * response_cache_get_fs( const response_cache_type * cache ) {
+  return cache->fs;
+}
+
+
+int response_cache_get_size( const response_cache_type * cache ) {
+  return hash_get_size( cache->nodes );
+}
+
+
+static bool response_cache_use_cache( const enkf_config_node_type * config_node ) {
+  return (enkf_config_node_get_impl_type( config_node ) != FIELD);
+}
+
+
+/*
+  Nodes with vector storage hold all the report steps, and are only
+  keyed by the realization number.
+*/
+
+static char * response_cache_alloc_key( const enkf_config_node_type * config_node , node_id_type node_id ) {
+  if (enkf_config_node_vector_storage( config_node ))
+    return util_alloc_sprintf("%s:%d" , enkf_config_node_get_key( config_node ) , node_id.iens );
+  else
+    return util_alloc_sprintf("%s:%d:%d" , enkf_config_node_get_key( config_node ) , node_id.report_step , node_id.iens );
+}
+
+
+/**
+   Returns the response @config_node/@node_id; the returned node is
+   owned by the cache - or it is the @work_node for responses which
+   are not cached, in which case the node is only valid until the
+   @work_node is used again.
+
+   The function can be called concurrently; the loading from the
+   filesystem is done without holding the lock.
+*/
+
+const enkf_node_type * response_cache_get_node( response_cache_type * cache , const enkf_config_node_type * config_node , node_id_type node_id , enkf_node_type * work_node) {
+  if (!response_cache_use_cache( config_node )) {
+    enkf_node_load( work_node , cache->fs , node_id );
+    return work_node;
+  }
+
+  {
+    char * key = response_cache_alloc_key( config_node , node_id );
+    enkf_node_type * node = NULL;
+
+    pthread_mutex_lock( &cache->lock );
+    if (hash_has_key( cache->nodes , key ))
+      node = hash_get( cache->nodes , key );
+    pthread_mutex_unlock( &cache->lock );
+
+    if (node == NULL) {
+      enkf_node_type * new_node = enkf_node_deep_alloc( config_node );
+      enkf_node_load( new_node , cache->fs , node_id );
+
+      pthread_mutex_lock( &cache->lock );
+      if (hash_has_key( cache->nodes , key )) {
+        node = hash_get( cache->nodes , key );
+        enkf_node_free( new_node );
+      } else {
+        hash_insert_hash_owned_ref( cache->nodes , key , new_node , enkf_node_free__ );
+        node = new_node;
+      }
+      pthread_mutex_unlock( &cache->lock );
+    }
+
+    free( key );
+    return node;
+  }
+}
@@ -36,6 +36,7 @@
 
 struct rng_config_struct {
   rng_alg_type      type;
+  rng_engine_type   engine;
   char            * random_seed;
   char            * seed_load_file;    /* NULL: Do not store the seed. */
   char            * seed_store_file;   /* NULL: Do not load a seed from file. */
@@ -75,6 +76,14 @@ rng_alg_type rng_config_get_type(const rng_config_type * rng_config ) {
   return rng_config->type;
 }
 
+void rng_config_set_engine( rng_config_type * rng_config , rng_engine_type engine) {
+  rng_config->engine = engine;
+}
+
+rng_engine_type rng_config_get_engine(const rng_config_type * rng_config ) {
+  return rng_config->engine;
+}
+
 const char * rng_config_get_seed_load_file( const rng_config_type * rng_config ) {
   return rng_config->seed_load_file;
 }
@@ -96,6 +105,7 @@ static rng_config_type * rng_config_alloc_default(void) {
   rng_config_type * rng_config = util_malloc( sizeof * rng_config);
 
   rng_config_set_type( rng_config , MZRAN );  /* Only type ... */
+  rng_config_set_engine( rng_config , RNG_ENGINE_MZRAN );
   rng_config->random_seed = NULL;
   rng_config->seed_store_file = NULL;
   rng_config->seed_load_file = NULL;
@@ -150,6 +160,9 @@ rng_manager_type * rng_config_alloc_rng_manager( const rng_config_type * rng_con
     rng_manager = rng_manager_alloc_random( );
   }
 
+  if (rng_config->engine == RNG_ENGINE_COUNTER)
+    rng_manager_enable_counter_rng( rng_manager );
+
   rng_manager_log_state(rng_manager);
   if (seed_store)
     rng_manager_save_state( rng_manager , seed_store );
@@ -174,10 +187,26 @@ void rng_config_add_config_items( config_parser_type * parser ) {
           "WARNING: LOAD_SEED is deprecated - use RANDOM_SEED instead");
 
   config_add_key_value(parser, RANDOM_SEED_KEY, false, CONFIG_STRING);
+
+  {
+    config_schema_item_type * item = config_add_schema_item(parser, RANDOM_ENGINE_KEY, false);
+    config_schema_item_set_argc_minmax(item , 1, 1);
+    config_schema_item_set_common_selection_set(
+            item, 2, (const char *[2]) {RNG_ENGINE_MZRAN_STRING , RNG_ENGINE_COUNTER_STRING}
+            );
+  }
 }
 
 
 void rng_config_init(rng_config_type * rng_config, const config_content_type * config_content) {
+  if(config_content_has_item(config_content, RANDOM_ENGINE_KEY)) {
+    const char * engine = config_content_get_value(config_content, RANDOM_ENGINE_KEY);
+    if (util_string_equal(engine, RNG_ENGINE_COUNTER_STRING))
+      rng_config_set_engine(rng_config, RNG_ENGINE_COUNTER);
+    else
+      rng_config_set_engine(rng_config, RNG_ENGINE_MZRAN);
+  }
+
   if(config_content_has_item(config_content, RANDOM_SEED_KEY)) {
     const char * random_seed = config_content_get_value(config_content, RANDOM_SEED_KEY);
     rng_config_set_random_seed(rng_config, random_seed);
@@ -206,6 +235,11 @@ void rng_config_init(rng_config_type * rng_config, const config_content_type * c
 
 
 void rng_config_fprintf_config( rng_config_type * rng_config , FILE * stream ) {
+  if (rng_config->engine == RNG_ENGINE_COUNTER) {
+    fprintf( stream , CONFIG_KEY_FORMAT      , RANDOM_ENGINE_KEY );
+    fprintf( stream , CONFIG_ENDVALUE_FORMAT , RNG_ENGINE_COUNTER_STRING);
+  }
+
   if (rng_config->seed_load_file != NULL) {
     fprintf( stream , CONFIG_KEY_FORMAT      , LOAD_SEED_KEY );
     fprintf( stream , CONFIG_ENDVALUE_FORMAT , rng_config->seed_load_file);
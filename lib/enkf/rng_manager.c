@@ -21,8 +21,10 @@
 
 #include <ert/util/rng.h>
 #include <ert/util/vector.h>
+#include <ert/util/util.h>
 #include <ert/enkf/rng_manager.h>
 #include <ert/res_util/res_log.h>
+#include <ert/res_util/counter_rng.h>
 
 #define RNG_MANAGER_TYPE_ID 77250451
 
@@ -33,6 +35,7 @@ struct rng_manager_struct {
   rng_type    * internal_seed_rng;   /* This is used to seed the RNG's which are managed. */
   rng_type    * external_seed_rng;   /* This is used to seed the RNG's which are managed by external scope. */
   vector_type * rng_list;
+  counter_rng_type * counter_rng;    /* Non NULL when the counter based engine is selected. */
 };
 
 
@@ -43,6 +46,7 @@ static rng_manager_type * rng_manager_alloc__(rng_init_mode init_mode) {
   UTIL_TYPE_ID_INIT( rng_manager, RNG_MANAGER_TYPE_ID );
   rng_manager->rng_list = vector_alloc_new( );
   rng_manager->rng_alg = MZRAN;
+  rng_manager->counter_rng = NULL;
   rng_manager->internal_seed_rng = rng_alloc( rng_manager->rng_alg, init_mode );
   rng_manager->external_seed_rng = rng_alloc( rng_manager->rng_alg, init_mode );
 
@@ -97,6 +101,8 @@ void rng_manager_free( rng_manager_type * rng_manager ) {
   vector_free( rng_manager->rng_list );
   rng_free( rng_manager->internal_seed_rng );
   rng_free( rng_manager->external_seed_rng );
+  if (rng_manager->counter_rng)
+    counter_rng_free( rng_manager->counter_rng );
   free( rng_manager );
 }
 
@@ -105,12 +111,50 @@ static void rng_manager_grow(rng_manager_type * rng_manager, int min_size) {
   int new_size = util_int_max( min_size, 2*vector_get_size( rng_manager->rng_list ));
   for (int i = vector_get_size( rng_manager->rng_list ); i < new_size; i++) {
     rng_type * rng = rng_alloc( rng_manager->rng_alg, INIT_DEFAULT );
-    rng_rng_init( rng, rng_manager->internal_seed_rng );
+    if (rng_manager->counter_rng) {
+      unsigned int state[RNG_STATE_SIZE];
+      counter_rng_get_uint4( rng_manager->counter_rng , RNG_STREAM_INIT , i , 0 , state );
+      rng_set_state( rng , (const char *) state );
+    } else
+      rng_rng_init( rng, rng_manager->internal_seed_rng );
     vector_append_owned_ref( rng_manager->rng_list , rng, rng_free__ );
   }
 }
 
 
+/**
+   Selects the counter based engine. The key of the counter_rng is
+   derived from the seed, so the RANDOM_SEED logged for the run still
+   reproduces it. With the counter engine the rng for realization iens
+   returned by rng_manager_iget() is seeded as a function of (seed ,
+   iens) only, i.e. independent of the order the generators are
+   requested in, and the counter_rng can be used directly for
+   perturbations which are generated in parallel.
+
+   Must be called before any rng is handed out with rng_manager_iget().
+*/
+
+void rng_manager_enable_counter_rng( rng_manager_type * rng_manager ) {
+  if (vector_get_size( rng_manager->rng_list ) > 0)
+    util_abort("%s: the counter engine must be selected before any rng is handed out\n",__func__);
+
+  if (rng_manager->counter_rng == NULL) {
+    unsigned int state[RNG_STATE_SIZE];
+    rng_get_state( rng_manager->internal_seed_rng , (char *) state );
+    rng_manager->counter_rng = counter_rng_alloc( state[0] ^ state[2] , state[1] ^ state[3] );
+  }
+}
+
+
+/*
+  Returns NULL when the MZRAN engine is used.
+*/
+
+const counter_rng_type * rng_manager_get_counter_rng( const rng_manager_type * rng_manager ) {
+  return rng_manager->counter_rng;
+}
+
+
 rng_type * rng_manager_alloc_rng(rng_manager_type * rng_manager) {
   rng_type * rng = rng_alloc( rng_manager->rng_alg, INIT_DEFAULT );
   rng_rng_init( rng, rng_manager->external_seed_rng );
@@ -175,10 +175,18 @@ int summary_length(const summary_type * summary) {
   return double_vector_size(summary->data_vector);
 }
 
+const double_vector_type * summary_get_data_vector(const summary_type * summary) {
+  return summary->data_vector;
+}
+
 double summary_get(const summary_type * summary, int report_step) {
   return SUMMARY_GET_VALUE( summary, report_step );
 }
 
+void summary_set(summary_type * summary, int report_step, double value) {
+  SUMMARY_SET_VALUE( summary, report_step, value );
+}
+
 
 bool summary_user_get(const summary_type * summary,
                       const char * index_key,
@@ -2,36 +2,112 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
 
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/type_macros.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/vector.h>
+
+#include <ert/ecl/ecl_smspec.h>
+#include <ert/ecl/smspec_node.h>
 
 #include <ert/enkf/enkf_types.h>
 
 
 
 #define SUMMARY_KEY_MATCHER_TYPE_ID 700672137
+#define MAX_CACHED_LAYOUTS          8
+
+/*
+  The patterns are "compiled" when they are added: keys without any
+  fnmatch special characters are matched with a hash lookup in
+  key_set, for the remaining patterns the literal prefix before the
+  first special character is stored, so that most keys can be
+  rejected with a strncmp() before util_fnmatch() is called.
+
+  Since the realizations of an ensemble will normally have exactly the
+  same SMSPEC layout, the indices of the matching nodes are cached per
+  layout; see summary_key_matcher_alloc_match_index().
+*/
+
+typedef struct {
+  int_vector_type  * node_index;     /* Index of all the valid nodes in the layout. */
+  stringlist_type  * node_keys;      /* The gen_key1 of the valid nodes. */
+  int_vector_type  * match_index;    /* Index of the nodes matching the patterns. */
+} layout_match_type;
+
 
 struct summary_key_matcher_struct {
   UTIL_TYPE_ID_DECLARATION;
   hash_type        * key_set;
+  stringlist_type  * patterns;
+  int_vector_type  * prefix_length;
+  bool               match_all;
+  vector_type      * layout_cache;
+  pthread_mutex_t    cache_lock;
 };
 
 
 UTIL_IS_INSTANCE_FUNCTION( summary_key_matcher , SUMMARY_KEY_MATCHER_TYPE_ID )
 
 
+static void layout_match_free( layout_match_type * layout ) {
+  int_vector_free( layout->node_index );
+  stringlist_free( layout->node_keys );
+  int_vector_free( layout->match_index );
+  free( layout );
+}
+
+
+static void layout_match_free__( void * arg ) {
+  layout_match_free( arg );
+}
+
+
+static bool layout_match_equal( const layout_match_type * layout , const ecl_smspec_type * smspec ) {
+  int valid_index = 0;
+  for (int i = 0; i < ecl_smspec_num_nodes( smspec ); i++) {
+    const smspec_node_type * smspec_node = ecl_smspec_iget_node( smspec , i );
+    if (smspec_node_is_valid( smspec_node )) {
+      if (valid_index == int_vector_size( layout->node_index ))
+        return false;
+
+      if (int_vector_iget( layout->node_index , valid_index ) != i)
+        return false;
+
+      if (!util_string_equal( stringlist_iget( layout->node_keys , valid_index ) , smspec_node_get_gen_key1( smspec_node )))
+        return false;
+
+      valid_index++;
+    }
+  }
+  return (valid_index == int_vector_size( layout->node_index ));
+}
+
+
+
 summary_key_matcher_type * summary_key_matcher_alloc() {
   summary_key_matcher_type * matcher = util_malloc(sizeof * matcher);
   UTIL_TYPE_ID_INIT( matcher , SUMMARY_KEY_MATCHER_TYPE_ID);
-  matcher->key_set = hash_alloc();
+  matcher->key_set       = hash_alloc();
+  matcher->patterns      = stringlist_alloc_new();
+  matcher->prefix_length = int_vector_alloc( 0 , 0 );
+  matcher->match_all     = false;
+  matcher->layout_cache  = vector_alloc_new();
+  pthread_mutex_init( &matcher->cache_lock , NULL );
   return matcher;
 }
 
 void summary_key_matcher_free(summary_key_matcher_type * matcher) {
     hash_free(matcher->key_set);
+    stringlist_free(matcher->patterns);
+    int_vector_free(matcher->prefix_length);
+    vector_free(matcher->layout_cache);
+    pthread_mutex_destroy(&matcher->cache_lock);
     free(matcher);
 }
 
@@ -42,24 +118,95 @@ int summary_key_matcher_get_size(const summary_key_matcher_type * matcher) {
 void summary_key_matcher_add_summary_key(summary_key_matcher_type * matcher, const char * summary_key) {
     if(!hash_has_key(matcher->key_set, summary_key)) {
         hash_insert_int(matcher->key_set, summary_key, !util_string_has_wildcard(summary_key));
+        {
+            size_t prefix_length = strcspn(summary_key, "*?[\\");
+            if (summary_key[prefix_length] != '\0') {
+                stringlist_append_copy(matcher->patterns, summary_key);
+                int_vector_append(matcher->prefix_length, prefix_length);
+                if (strcmp(summary_key, "*") == 0)
+                    matcher->match_all = true;
+            }
+        }
+
+        pthread_mutex_lock(&matcher->cache_lock);
+        vector_clear(matcher->layout_cache);
+        pthread_mutex_unlock(&matcher->cache_lock);
     }
 }
 
 bool summary_key_matcher_match_summary_key(const summary_key_matcher_type * matcher, const char * summary_key) {
-    stringlist_type * keys = hash_alloc_stringlist(matcher->key_set);
-    bool has_key = false;
+    if (matcher->match_all)
+        return true;
+
+    /* A hit in key_set is only an exact match if the key is not a pattern itself. */
+    if (hash_has_key(matcher->key_set, summary_key) && (strcspn(summary_key, "*?[\\") == strlen(summary_key)))
+        return true;
 
-    for (int i = 0; i < stringlist_get_size(keys); i++) {
-        const char * pattern = stringlist_iget(keys, i);
-        if(util_fnmatch(pattern, summary_key) == 0) {
-            has_key = true;
+    for (int i = 0; i < stringlist_get_size(matcher->patterns); i++) {
+        const char * pattern = stringlist_iget(matcher->patterns, i);
+        int prefix_length = int_vector_iget(matcher->prefix_length, i);
+
+        if (strncmp(pattern, summary_key, prefix_length) == 0) {
+            if(util_fnmatch(pattern, summary_key) == 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+   Returns the index of all the valid nodes in @smspec whose gen_key1
+   matches the patterns of the matcher, i.e. the nodes which should be
+   internalized. The result for each distinct SMSPEC layout is cached
+   in the matcher - and reused when the next realization comes with
+   exactly the same list of keys. The cache is invalidated when a new
+   key is added. The returned vector must be freed by the calling
+   scope; the function can be called concurrently.
+*/
+
+int_vector_type * summary_key_matcher_alloc_match_index(const summary_key_matcher_type * matcher, const ecl_smspec_type * smspec) {
+    summary_key_matcher_type * cache_owner = (summary_key_matcher_type *) matcher;
+    int_vector_type * match_index = NULL;
+
+    pthread_mutex_lock(&cache_owner->cache_lock);
+    for (int i = 0; i < vector_get_size(matcher->layout_cache); i++) {
+        const layout_match_type * layout = vector_iget_const(matcher->layout_cache, i);
+        if (layout_match_equal(layout, smspec)) {
+            match_index = int_vector_alloc_copy(layout->match_index);
             break;
         }
     }
+    pthread_mutex_unlock(&cache_owner->cache_lock);
+
+    if (match_index == NULL) {
+        layout_match_type * layout = util_malloc(sizeof * layout);
+        layout->node_index  = int_vector_alloc(0, 0);
+        layout->node_keys   = stringlist_alloc_new();
+        layout->match_index = int_vector_alloc(0, 0);
+
+        for (int i = 0; i < ecl_smspec_num_nodes(smspec); i++) {
+            const smspec_node_type * smspec_node = ecl_smspec_iget_node(smspec, i);
+            if (smspec_node_is_valid(smspec_node)) {
+                const char * key = smspec_node_get_gen_key1(smspec_node);
+
+                int_vector_append(layout->node_index, i);
+                stringlist_append_copy(layout->node_keys, key);
+                if (summary_key_matcher_match_summary_key(matcher, key))
+                    int_vector_append(layout->match_index, i);
+            }
+        }
+        match_index = int_vector_alloc_copy(layout->match_index);
 
-    stringlist_free(keys);
+        pthread_mutex_lock(&cache_owner->cache_lock);
+        if (vector_get_size(cache_owner->layout_cache) == MAX_CACHED_LAYOUTS)
+            vector_clear(cache_owner->layout_cache);
+        vector_append_owned_ref(cache_owner->layout_cache, layout, layout_match_free__);
+        pthread_mutex_unlock(&cache_owner->cache_lock);
+    }
 
-    return has_key;
+    return match_index;
 }
 
 stringlist_type * summary_key_matcher_get_keys(const summary_key_matcher_type * matcher) {
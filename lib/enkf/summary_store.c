@@ -0,0 +1,327 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'summary_store.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#define  _GNU_SOURCE   /* Must define this to get access to pthread_rwlock_t */
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/hash.h>
+#include <ert/util/vector.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
+#include <ert/util/double_vector.h>
+
+#include <ert/res_util/block_fs.h>
+
+#include <ert/enkf/enkf_defaults.h>
+#include <ert/enkf/summary_table.h>
+#include <ert/enkf/summary_store.h>
+
+/**
+   The summary_store is an optional columnar storage of summary
+   responses, in addition to the ordinary per realization vectors
+   stored through the fs_driver. For every summary key there is one
+   record holding a summary_table, i.e. the values for all the
+   realizations, and the ensemble wide consumers (plotting, export,
+   ...) can get the data for one key with one read - or a time range
+   with a partial read.
+
+   The realizations are added one at a time as they are internalized;
+   the modified tables are kept in memory and written out when the
+   store is fsynced, i.e. typically once after a batch of
+   realizations has been loaded - or earlier if the pending tables
+   use more than max_pending_bytes of memory.
+*/
+
+#define SUMMARY_STORE_TYPE_ID  831173
+#define SUMMARY_STORE_SHARDS      16
+
+/*
+   The pending tables are divided in shards based on the key, so
+   realizations which are internalized concurrently only contend on
+   the lock when they update keys in the same shard. When the pending
+   tables of a shard grow beyond its share of max_pending_bytes they
+   are written out, without fsync, and the memory is released.
+*/
+
+typedef struct {
+  hash_type       * pending;      /* Tables which have been modified since they were last written. */
+  size_t            pending_bytes;
+  pthread_mutex_t   lock;
+} summary_store_shard_type;
+
+
+struct summary_store_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  block_fs_type            * block_fs;
+  bool                       read_only;
+  size_t                     max_pending_bytes;
+  summary_store_shard_type   shards[SUMMARY_STORE_SHARDS];
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( summary_store , SUMMARY_STORE_TYPE_ID )
+
+
+summary_store_type * summary_store_mount( const char * mount_file , bool read_only ) {
+  summary_store_type * store = util_malloc( sizeof * store );
+  UTIL_TYPE_ID_INIT( store , SUMMARY_STORE_TYPE_ID );
+  store->read_only = read_only;
+  store->max_pending_bytes = DEFAULT_SUMMARY_STORE_MAX_PENDING_MB * 1024 * 1024;
+  store->block_fs  = block_fs_mount( mount_file , 64 , 0 , 1.0 , 0 , false , read_only , false );
+  for (int i = 0; i < SUMMARY_STORE_SHARDS; i++) {
+    store->shards[i].pending = hash_alloc( );
+    store->shards[i].pending_bytes = 0;
+    pthread_mutex_init( &store->shards[i].lock , NULL );
+  }
+  return store;
+}
+
+
+/**
+   Sets the upper limit for the memory used by tables which have not
+   yet been written to disk.
+*/
+
+void summary_store_set_max_pending( summary_store_type * store , size_t max_pending_bytes ) {
+  store->max_pending_bytes = max_pending_bytes;
+}
+
+
+size_t summary_store_get_max_pending( const summary_store_type * store ) {
+  return store->max_pending_bytes;
+}
+
+
+static summary_store_shard_type * summary_store_get_shard( summary_store_type * store , const char * key ) {
+  unsigned int hash = 5381;
+  for (const char * c = key; *c; c++)
+    hash = hash * 33 + (unsigned char) *c;
+  return &store->shards[ hash % SUMMARY_STORE_SHARDS ];
+}
+
+
+static size_t summary_store_table_bytes( const summary_table_type * table ) {
+  return (size_t) summary_table_get_ens_size( table ) * summary_table_get_time_size( table ) * (sizeof(double) + sizeof(unsigned char));
+}
+
+
+/*
+  All the pending tables of the shard are written with one block_fs
+  batch write; the caller must hold the shard lock.
+*/
+
+static void summary_store_flush_shard__( summary_store_type * store , summary_store_shard_type * shard ) {
+  if (hash_get_size( shard->pending ) > 0) {
+    stringlist_type * keys = hash_alloc_stringlist( shard->pending );
+    vector_type * buffers  = vector_alloc_new();
+
+    for (int i = 0; i < stringlist_get_size( keys ); i++) {
+      const summary_table_type * table = hash_get( shard->pending , stringlist_iget( keys , i ));
+      buffer_type * buffer = buffer_alloc( 1024 );
+
+      summary_table_fwrite_buffer( table , buffer );
+      vector_append_ref( buffers , buffer );
+    }
+    block_fs_fwrite_batch( store->block_fs , keys , buffers );
+
+    for (int i = 0; i < vector_get_size( buffers ); i++)
+      buffer_free( vector_iget( buffers , i ));
+    vector_free( buffers );
+    stringlist_free( keys );
+    hash_clear( shard->pending );
+    shard->pending_bytes = 0;
+  }
+}
+
+
+/*
+  All the shards are locked, in order, while the store is fsynced;
+  block_fs_fsync() can not run concurrently with a shard flush.
+*/
+
+static void summary_store_fsync__( summary_store_type * store ) {
+  for (int i = 0; i < SUMMARY_STORE_SHARDS; i++) {
+    summary_store_shard_type * shard = &store->shards[i];
+    pthread_mutex_lock( &shard->lock );
+    summary_store_flush_shard__( store , shard );
+  }
+
+  block_fs_fsync( store->block_fs );
+
+  for (int i = 0; i < SUMMARY_STORE_SHARDS; i++)
+    pthread_mutex_unlock( &store->shards[i].lock );
+}
+
+
+void summary_store_fsync( summary_store_type * store ) {
+  summary_store_fsync__( store );
+}
+
+
+/**
+   Will fsync the store and then clone the underlying block_fs data
+   to @target_mount_file; see block_fs_clone().
+*/
+
+bool summary_store_clone( summary_store_type * store , const char * target_mount_file ) {
+  if (!store->read_only)
+    summary_store_fsync__( store );
+  return block_fs_clone( store->block_fs , target_mount_file );
+}
+
+
+void summary_store_close( summary_store_type * store ) {
+  if (!store->read_only)
+    summary_store_fsync( store );
+
+  block_fs_close( store->block_fs , false );
+  for (int i = 0; i < SUMMARY_STORE_SHARDS; i++) {
+    hash_free( store->shards[i].pending );
+    pthread_mutex_destroy( &store->shards[i].lock );
+  }
+  free( store );
+}
+
+
+static summary_table_type * summary_store_fread_table( summary_store_type * store , const char * key ) {
+  if (block_fs_has_file( store->block_fs , key )) {
+    buffer_type * buffer = buffer_alloc( 1024 );
+    summary_table_type * table;
+
+    block_fs_fread_realloc_buffer( store->block_fs , key , buffer );
+    table = summary_table_alloc_from_buffer( buffer );
+    buffer_free( buffer );
+    return table;
+  } else
+    return NULL;
+}
+
+
+bool summary_store_has_key( summary_store_type * store , const char * key ) {
+  summary_store_shard_type * shard = summary_store_get_shard( store , key );
+  bool has_key;
+  pthread_mutex_lock( &shard->lock );
+  has_key = hash_has_key( shard->pending , key ) || block_fs_has_file( store->block_fs , key );
+  pthread_mutex_unlock( &shard->lock );
+  return has_key;
+}
+
+
+/**
+   Will update the column of realization @iens in the table for @key;
+   this function can be called concurrently from the threads loading
+   different realizations.
+*/
+
+void summary_store_set_vector( summary_store_type * store , const char * key , int iens , const double_vector_type * data ) {
+  summary_store_shard_type * shard = summary_store_get_shard( store , key );
+  if (store->read_only)
+    util_abort("%s: tried to write to read only summary store\n",__func__);
+
+  pthread_mutex_lock( &shard->lock );
+  {
+    summary_table_type * table;
+    if (hash_has_key( shard->pending , key ))
+      table = hash_get( shard->pending , key );
+    else {
+      table = summary_store_fread_table( store , key );
+      if (table == NULL)
+        table = summary_table_alloc( 0 , 0 );
+      hash_insert_hash_owned_ref( shard->pending , key , table , summary_table_free__ );
+      shard->pending_bytes += summary_store_table_bytes( table );
+    }
+
+    shard->pending_bytes -= summary_store_table_bytes( table );
+    summary_table_set_vector( table , iens , data );
+    shard->pending_bytes += summary_store_table_bytes( table );
+
+    if (shard->pending_bytes > store->max_pending_bytes / SUMMARY_STORE_SHARDS)
+      summary_store_flush_shard__( store , shard );
+  }
+  pthread_mutex_unlock( &shard->lock );
+}
+
+
+/**
+   Returns a newly allocated table with all the data for @key, or
+   NULL if the store does not have @key.
+*/
+
+summary_table_type * summary_store_alloc_table( summary_store_type * store , const char * key ) {
+  summary_store_shard_type * shard = summary_store_get_shard( store , key );
+  summary_table_type * table;
+
+  pthread_mutex_lock( &shard->lock );
+  if (hash_has_key( shard->pending , key )) {
+    const summary_table_type * pending = hash_get( shard->pending , key );
+    table = summary_table_alloc_copy( pending , 0 , summary_table_get_time_size( pending ));
+  } else
+    table = summary_store_fread_table( store , key );
+  pthread_mutex_unlock( &shard->lock );
+
+  return table;
+}
+
+
+/**
+   Returns a newly allocated table with the report steps [step1,
+   step2) for @key, or NULL if the store does not have @key. Only the
+   requested steps are read from disk; step2 is truncated to the
+   number of steps in the table.
+*/
+
+summary_table_type * summary_store_alloc_time_slice( summary_store_type * store , const char * key , int step1 , int step2 ) {
+  summary_store_shard_type * shard = summary_store_get_shard( store , key );
+  summary_table_type * table = NULL;
+
+  pthread_mutex_lock( &shard->lock );
+  if (hash_has_key( shard->pending , key )) {
+    const summary_table_type * pending = hash_get( shard->pending , key );
+    step2 = util_int_min( step2 , summary_table_get_time_size( pending ));
+    table = summary_table_alloc_copy( pending , step1 , step2 );
+  } else if (block_fs_has_file( store->block_fs , key )) {
+    int header[3];
+    int ens_size , time_size;
+
+    block_fs_fread_range( store->block_fs , key , 0 , sizeof header , header );
+    summary_table_parse_header( header , &ens_size , &time_size );
+    step2 = util_int_min( step2 , time_size );
+    if ((step1 < 0) || (step1 > step2))
+      util_abort("%s: invalid step range [%d,%d) \n",__func__ , step1 , step2);
+
+    table = summary_table_alloc( ens_size , step2 - step1 );
+    if (step2 > step1) {
+      size_t num_elements = (size_t) ens_size * (step2 - step1);
+      block_fs_fread_range( store->block_fs , key ,
+                            summary_table_data_offset( ens_size , time_size , step1 ) ,
+                            num_elements * sizeof(double) ,
+                            summary_table_get_data( table ));
+
+      block_fs_fread_range( store->block_fs , key ,
+                            summary_table_mask_offset( ens_size , time_size , step1 ) ,
+                            num_elements * sizeof(unsigned char) ,
+                            summary_table_get_mask( table ));
+    }
+  }
+  pthread_mutex_unlock( &shard->lock );
+
+  return table;
+}
@@ -0,0 +1,283 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'summary_table.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/buffer.h>
+#include <ert/util/double_vector.h>
+
+#include <ert/enkf/summary.h>
+#include <ert/enkf/summary_table.h>
+
+/**
+   The summary_table holds the values of one summary key for the
+   whole ensemble, as a (time x realization) matrix and a
+   corresponding active mask. The matrix is stored time-major,
+   i.e. all the realizations for one report step are contiguous;
+   that way a range of report steps is one contiguous block, both in
+   memory and in the serialized record:
+
+     int     SUMMARY_TABLE_ID
+     int     ens_size
+     int     time_size
+     double  data[time_size][ens_size]
+     uint8   mask[time_size][ens_size]
+
+   The mask distinguishes between elements which are beyond the end
+   of the vector for that realization (MASK_MISSING), and elements
+   holding the undefined summary value (MASK_UNDEFINED); that way a
+   vector goes unchanged through summary_table_set_vector() and
+   summary_table_get_vector().
+*/
+
+#define SUMMARY_TABLE_TYPE_ID  661209
+#define SUMMARY_TABLE_ID       118
+
+#define MASK_MISSING           0
+#define MASK_ACTIVE            1
+#define MASK_UNDEFINED         2
+
+struct summary_table_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int             ens_size;
+  int             time_size;
+  double        * data;
+  unsigned char * mask;
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( summary_table , SUMMARY_TABLE_TYPE_ID )
+
+
+summary_table_type * summary_table_alloc( int ens_size , int time_size ) {
+  summary_table_type * table = util_malloc( sizeof * table );
+  UTIL_TYPE_ID_INIT( table , SUMMARY_TABLE_TYPE_ID );
+  table->ens_size  = 0;
+  table->time_size = 0;
+  table->data      = NULL;
+  table->mask      = NULL;
+  summary_table_resize( table , ens_size , time_size );
+  return table;
+}
+
+
+void summary_table_free( summary_table_type * table ) {
+  free( table->data );
+  free( table->mask );
+  free( table );
+}
+
+
+void summary_table_free__( void * arg ) {
+  summary_table_free( (summary_table_type *) arg );
+}
+
+
+/**
+   Will resize the table, keeping the existing content; new elements
+   are inactive.
+*/
+
+void summary_table_resize( summary_table_type * table , int ens_size , int time_size ) {
+  if ((ens_size == table->ens_size) && (time_size == table->time_size))
+    return;
+  {
+    const size_t num_elements = (size_t) ens_size * time_size;
+    double * data = util_calloc( util_size_t_max( num_elements , 1 ) , sizeof * data );
+    unsigned char * mask = util_calloc( util_size_t_max( num_elements , 1 ) , sizeof * mask );
+    const int copy_ens  = util_int_min( ens_size , table->ens_size );
+    const int copy_time = util_int_min( time_size , table->time_size );
+
+    for (int step = 0; step < copy_time; step++) {
+      memcpy( &data[ (size_t) step * ens_size ] , &table->data[ (size_t) step * table->ens_size ] , copy_ens * sizeof * data );
+      memcpy( &mask[ (size_t) step * ens_size ] , &table->mask[ (size_t) step * table->ens_size ] , copy_ens * sizeof * mask );
+    }
+
+    free( table->data );
+    free( table->mask );
+    table->data      = data;
+    table->mask      = mask;
+    table->ens_size  = ens_size;
+    table->time_size = time_size;
+  }
+}
+
+
+/**
+   Allocates a copy of the report steps [step1, step2) of @src.
+*/
+
+summary_table_type * summary_table_alloc_copy( const summary_table_type * src , int step1 , int step2 ) {
+  if ((step1 < 0) || (step2 > src->time_size) || (step1 > step2))
+    util_abort("%s: invalid step range [%d,%d) - table has %d steps\n",__func__ , step1 , step2 , src->time_size);
+  {
+    summary_table_type * table = summary_table_alloc( src->ens_size , step2 - step1 );
+    const size_t num_elements = (size_t) src->ens_size * (step2 - step1);
+
+    memcpy( table->data , &src->data[ (size_t) step1 * src->ens_size ] , num_elements * sizeof * table->data );
+    memcpy( table->mask , &src->mask[ (size_t) step1 * src->ens_size ] , num_elements * sizeof * table->mask );
+    return table;
+  }
+}
+
+
+/*****************************************************************/
+
+size_t summary_table_data_offset( int ens_size , int time_size , int step ) {
+  return SUMMARY_TABLE_HEADER_SIZE + (size_t) step * ens_size * sizeof(double);
+}
+
+
+size_t summary_table_mask_offset( int ens_size , int time_size , int step ) {
+  return summary_table_data_offset( ens_size , time_size , time_size ) + (size_t) step * ens_size * sizeof(unsigned char);
+}
+
+
+void summary_table_parse_header( const int * header , int * ens_size , int * time_size ) {
+  if (header[0] != SUMMARY_TABLE_ID)
+    util_abort("%s: wrong table id:%d - expected:%d \n",__func__ , header[0] , SUMMARY_TABLE_ID);
+
+  *ens_size  = header[1];
+  *time_size = header[2];
+}
+
+
+void summary_table_fwrite_buffer( const summary_table_type * table , buffer_type * buffer ) {
+  const size_t num_elements = (size_t) table->ens_size * table->time_size;
+
+  buffer_fwrite_int( buffer , SUMMARY_TABLE_ID );
+  buffer_fwrite_int( buffer , table->ens_size );
+  buffer_fwrite_int( buffer , table->time_size );
+  buffer_fwrite( buffer , table->data , sizeof * table->data , num_elements );
+  buffer_fwrite( buffer , table->mask , sizeof * table->mask , num_elements );
+}
+
+
+summary_table_type * summary_table_alloc_from_buffer( buffer_type * buffer ) {
+  int header[3];
+  int ens_size , time_size;
+
+  for (int i = 0; i < 3; i++)
+    header[i] = buffer_fread_int( buffer );
+  summary_table_parse_header( header , &ens_size , &time_size );
+  {
+    summary_table_type * table = summary_table_alloc( ens_size , time_size );
+    const size_t num_elements = (size_t) ens_size * time_size;
+
+    buffer_fread( buffer , table->data , sizeof * table->data , num_elements );
+    buffer_fread( buffer , table->mask , sizeof * table->mask , num_elements );
+    return table;
+  }
+}
+
+
+/*****************************************************************/
+
+/**
+   Will set the column for realization @iens from the summary vector
+   @data; the table is grown as needed. Elements beyond the end of
+   @data, and elements holding the undefined summary value, are
+   inactive.
+*/
+
+void summary_table_set_vector( summary_table_type * table , int iens , const double_vector_type * data ) {
+  const int size = double_vector_size( data );
+  summary_table_resize( table , util_int_max( table->ens_size , iens + 1 ) , util_int_max( table->time_size , size ));
+  {
+    const double * values = double_vector_get_const_ptr( data );
+    for (int step = 0; step < table->time_size; step++) {
+      size_t index = (size_t) step * table->ens_size + iens;
+      if (step < size) {
+        table->data[index] = values[step];
+        table->mask[index] = summary_active_value( values[step] ) ? MASK_ACTIVE : MASK_UNDEFINED;
+      } else {
+        table->data[index] = 0;
+        table->mask[index] = MASK_MISSING;
+      }
+    }
+  }
+}
+
+
+/**
+   Will fill @data with the vector for realization @iens; returns
+   false if there is no data for the realization.
+*/
+
+bool summary_table_get_vector( const summary_table_type * table , int iens , double_vector_type * data ) {
+  int size = 0;
+  double_vector_reset( data );
+  if ((iens >= 0) && (iens < table->ens_size)) {
+    for (int step = 0; step < table->time_size; step++)
+      if (table->mask[ (size_t) step * table->ens_size + iens ] != MASK_MISSING)
+        size = step + 1;
+
+    for (int step = 0; step < size; step++)
+      double_vector_iset( data , step , table->data[ (size_t) step * table->ens_size + iens ]);
+  }
+  return (size > 0);
+}
+
+
+int summary_table_get_ens_size( const summary_table_type * table ) {
+  return table->ens_size;
+}
+
+
+int summary_table_get_time_size( const summary_table_type * table ) {
+  return table->time_size;
+}
+
+
+double summary_table_iget( const summary_table_type * table , int iens , int step ) {
+  if ((iens < 0) || (iens >= table->ens_size) || (step < 0) || (step >= table->time_size))
+    util_abort("%s: invalid index iens:%d step:%d - table size: %d x %d\n",__func__ , iens , step , table->ens_size , table->time_size);
+
+  return table->data[ (size_t) step * table->ens_size + iens ];
+}
+
+
+bool summary_table_iget_active( const summary_table_type * table , int iens , int step ) {
+  if ((iens < 0) || (iens >= table->ens_size) || (step < 0) || (step >= table->time_size))
+    return false;
+
+  return (table->mask[ (size_t) step * table->ens_size + iens ] == MASK_ACTIVE);
+}
+
+
+bool summary_table_has_realization( const summary_table_type * table , int iens ) {
+  if ((iens >= 0) && (iens < table->ens_size)) {
+    for (int step = 0; step < table->time_size; step++)
+      if (table->mask[ (size_t) step * table->ens_size + iens ] != MASK_MISSING)
+        return true;
+  }
+  return false;
+}
+
+
+double * summary_table_get_data( summary_table_type * table ) {
+  return table->data;
+}
+
+
+unsigned char * summary_table_get_mask( summary_table_type * table ) {
+  return table->mask;
+}
@@ -0,0 +1,290 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_distance_localization.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/rng.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#include <ert/res_util/matrix.h>
+
+#include <ert/analysis/obs_covar.h>
+#include <ert/analysis/analysis_module.h>
+
+#include <ert/enkf/distance_localization.h>
+
+
+typedef struct {
+  matrix_type    * S;
+  matrix_type    * dObs;
+  matrix_type    * E;
+  matrix_type    * D;
+  obs_covar_type * R;
+} update_input_type;
+
+
+static update_input_type * update_input_alloc( int num_obs , int ens_size , rng_type * rng ) {
+  update_input_type * input = util_malloc( sizeof * input );
+  input->S    = matrix_alloc( num_obs , ens_size );
+  input->dObs = matrix_alloc( num_obs , 2 );
+  input->E    = matrix_alloc( num_obs , ens_size );
+  input->D    = matrix_alloc( num_obs , ens_size );
+  input->R    = obs_covar_alloc( num_obs );
+
+  matrix_random_init( input->S , rng );
+  matrix_random_init( input->E , rng );
+  for (int iobs = 0; iobs < num_obs; iobs++) {
+    matrix_iset( input->dObs , iobs , 0 , rng_get_double( rng ));
+    matrix_iset( input->dObs , iobs , 1 , 0.5 );
+    obs_covar_iset_var( input->R , iobs , 0.25 );
+    for (int iens = 0; iens < ens_size; iens++)
+      matrix_iset( input->D , iobs , iens , matrix_iget( input->dObs , iobs , 0 ) + matrix_iget( input->E , iobs , iens ) - matrix_iget( input->S , iobs , iens ));
+  }
+  return input;
+}
+
+
+static void update_input_free( update_input_type * input ) {
+  matrix_free( input->S );
+  matrix_free( input->dObs );
+  matrix_free( input->E );
+  matrix_free( input->D );
+  obs_covar_free( input->R );
+  free( input );
+}
+
+
+static int update_field( const distance_localization_type * localization , const ecl_grid_type * grid , matrix_type * A ,
+                         analysis_module_type * module , const update_input_type * input , rng_type * rng , int num_threads) {
+  return distance_localization_update_field( localization , grid , NULL , A , 0 , matrix_get_rows( A ) , module ,
+                                             input->S , input->R , input->dObs , input->E , input->D , rng , num_threads );
+}
+
+
+void test_gaspari_cohn( ) {
+  const double radius = 10;
+
+  test_assert_double_equal( 1.0 , distance_localization_gaspari_cohn( 0 , radius ));
+  test_assert_double_equal( 0.0 , distance_localization_gaspari_cohn( radius , radius ));
+  test_assert_double_equal( 0.0 , distance_localization_gaspari_cohn( 2 * radius , radius ));
+  test_assert_double_equal( distance_localization_gaspari_cohn( -3 , radius ) , distance_localization_gaspari_cohn( 3 , radius ));
+
+  /* The two branches must agree at the half width. */
+  test_assert_double_equal( distance_localization_gaspari_cohn( 0.5 * radius * (1 - 1e-12) , radius ) ,
+                            distance_localization_gaspari_cohn( 0.5 * radius * (1 + 1e-12) , radius ));
+
+  {
+    double prev = 1.0;
+    for (int i = 1; i <= 100; i++) {
+      double rho = distance_localization_gaspari_cohn( i * radius / 100 , radius );
+      test_assert_true( rho <= prev );
+      test_assert_true( rho >= 0 );
+      prev = rho;
+    }
+  }
+}
+
+
+/*
+  With a localization radius much larger than the grid all the
+  weights are one, and the localized update must be equal to the
+  global update A*X.
+*/
+
+void test_large_radius( analysis_module_type * module , rng_type * rng ) {
+  const int ens_size = 10;
+  const int num_obs  = 6;
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( 8 , 7 , 3 , 1.0 , 1.0 , 1.0 , NULL );
+  const int num_cells = ecl_grid_get_active_size( grid );
+  distance_localization_type * localization = distance_localization_alloc( 1e9 , 2 );
+  update_input_type * input = update_input_alloc( num_obs , ens_size , rng );
+  matrix_type * A  = matrix_alloc( num_cells , ens_size );
+  matrix_type * A2 = NULL;
+  matrix_type * X  = matrix_alloc( ens_size , ens_size );
+
+  test_assert_true( distance_localization_is_instance( localization ));
+  for (int iobs = 0; iobs < num_obs - 1; iobs++)
+    distance_localization_add_obs( localization , iobs , 2 * iobs , 1 );
+  distance_localization_add_global_obs( localization );
+  test_assert_int_equal( num_obs , distance_localization_get_num_obs( localization ));
+
+  matrix_random_init( A , rng );
+  A2 = matrix_alloc_copy( A );
+
+  analysis_module_initX_covar( module , X , NULL , input->S , input->R , input->dObs , input->E , input->D , rng );
+  matrix_inplace_matmul( A2 , X );
+  test_assert_int_equal( 4 * 4 * 2 , update_field( localization , grid , A , module , input , rng , 1 ));
+
+  for (int row = 0; row < num_cells; row++)
+    for (int col = 0; col < ens_size; col++)
+      test_assert_double_equal( matrix_iget( A2 , row , col ) , matrix_iget( A , row , col ));
+
+  matrix_free( X );
+  matrix_free( A2 );
+  matrix_free( A );
+  update_input_free( input );
+  distance_localization_free( localization );
+  ecl_grid_free( grid );
+}
+
+
+/*
+  One observation in the corner of the grid; the cells outside the
+  localization radius must be unchanged, and the result must not
+  depend on the number of threads.
+*/
+
+void test_local_update( analysis_module_type * module , rng_type * rng ) {
+  const int ens_size = 10;
+  const double radius = 3;
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( 10 , 10 , 2 , 1.0 , 1.0 , 1.0 , NULL );
+  const int num_cells = ecl_grid_get_active_size( grid );
+  distance_localization_type * localization = distance_localization_alloc( radius , 1 );
+  update_input_type * input = update_input_alloc( 1 , ens_size , rng );
+  matrix_type * A0 = matrix_alloc( num_cells , ens_size );
+  matrix_type * A1 = NULL;
+  matrix_type * A4 = NULL;
+  double ox , oy , oz;
+
+  ecl_grid_get_xyz3( grid , 0 , 0 , 0 , &ox , &oy , &oz );
+  distance_localization_add_obs( localization , ox , oy , oz );
+
+  matrix_random_init( A0 , rng );
+  A1 = matrix_alloc_copy( A0 );
+  A4 = matrix_alloc_copy( A0 );
+  update_field( localization , grid , A1 , module , input , rng , 1 );
+  update_field( localization , grid , A4 , module , input , rng , 4 );
+
+  for (int cell = 0; cell < num_cells; cell++) {
+    double x , y , z;
+    double dist;
+    bool changed = false;
+
+    ecl_grid_get_xyz1A( grid , cell , &x , &y , &z );
+    dist = sqrt( (x - ox)*(x - ox) + (y - oy)*(y - oy) + (z - oz)*(z - oz));
+    for (int iens = 0; iens < ens_size; iens++) {
+      test_assert_double_equal( matrix_iget( A1 , cell , iens ) , matrix_iget( A4 , cell , iens ));
+      if (matrix_iget( A1 , cell , iens ) != matrix_iget( A0 , cell , iens ))
+        changed = true;
+    }
+
+    if (dist >= radius)
+      test_assert_false( changed );
+
+    if (dist == 0)
+      test_assert_true( changed );
+  }
+
+  matrix_free( A4 );
+  matrix_free( A1 );
+  matrix_free( A0 );
+  update_input_free( input );
+  distance_localization_free( localization );
+  ecl_grid_free( grid );
+}
+
+
+/*
+  One cell with an observation in the cell, one observation at a
+  distance and one observation without position. The update must be
+  equal to the global update with R scaled with 1/rho, E scaled with
+  1/sqrt(rho) and D recomputed from the scaled E; both when the module
+  uses R and when it uses the ensemble perturbations E (USE_EE).
+*/
+
+void test_scaled_perturbations( analysis_module_type * module , rng_type * rng , bool use_EE ) {
+  const int ens_size  = 10;
+  const int num_obs   = 3;
+  const double radius = 4;
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( 1 , 1 , 1 , 1.0 , 1.0 , 1.0 , NULL );
+  distance_localization_type * localization = distance_localization_alloc( radius , 1 );
+  update_input_type * input = update_input_alloc( num_obs , ens_size , rng );
+  matrix_type * A  = matrix_alloc( 1 , ens_size );
+  matrix_type * A2 = NULL;
+  double scale_factor[3];
+  double x , y , z;
+
+  test_assert_true( analysis_module_set_var( module , "USE_EE" , use_EE ? "True" : "False" ));
+  ecl_grid_get_xyz3( grid , 0 , 0 , 0 , &x , &y , &z );
+  distance_localization_add_obs( localization , x , y , z );
+  distance_localization_add_obs( localization , x + 1 , y , z );
+  distance_localization_add_global_obs( localization );
+
+  scale_factor[0] = 1;
+  scale_factor[1] = 1.0 / sqrt( distance_localization_gaspari_cohn( 1 , radius ));
+  scale_factor[2] = 1;
+  test_assert_true( scale_factor[1] > 1 );
+
+  matrix_random_init( A , rng );
+  A2 = matrix_alloc_copy( A );
+  {
+    matrix_type * S = matrix_alloc_copy( input->S );
+    matrix_type * E = matrix_alloc_copy( input->E );
+    matrix_type * D = matrix_alloc( num_obs , ens_size );
+    matrix_type * X = matrix_alloc( ens_size , ens_size );
+    obs_covar_type * R = obs_covar_alloc( num_obs );
+
+    for (int iobs = 0; iobs < num_obs; iobs++) {
+      obs_covar_iset_var( R , iobs , obs_covar_iget_var( input->R , iobs ));
+      for (int iens = 0; iens < ens_size; iens++) {
+        matrix_iset( E , iobs , iens , scale_factor[iobs] * matrix_iget( input->E , iobs , iens ));
+        matrix_iset( D , iobs , iens , matrix_iget( input->dObs , iobs , 0 ) + matrix_iget( E , iobs , iens ) - matrix_iget( input->S , iobs , iens ));
+      }
+    }
+    obs_covar_scale( R , scale_factor );
+
+    analysis_module_initX_covar( module , X , NULL , S , R , input->dObs , E , D , rng );
+    matrix_inplace_matmul( A2 , X );
+
+    obs_covar_free( R );
+    matrix_free( X );
+    matrix_free( D );
+    matrix_free( E );
+    matrix_free( S );
+  }
+
+  test_assert_int_equal( 1 , update_field( localization , grid , A , module , input , rng , 1 ));
+  for (int iens = 0; iens < ens_size; iens++)
+    test_assert_double_equal( matrix_iget( A2 , 0 , iens ) , matrix_iget( A , 0 , iens ));
+
+  test_assert_true( analysis_module_set_var( module , "USE_EE" , "False" ));
+  matrix_free( A2 );
+  matrix_free( A );
+  update_input_free( input );
+  distance_localization_free( localization );
+  ecl_grid_free( grid );
+}
+
+
+int main(int argc , char ** argv) {
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  analysis_module_type * module = analysis_module_alloc_internal( "STD_ENKF" );
+
+  test_gaspari_cohn( );
+  test_large_radius( module , rng );
+  test_local_update( module , rng );
+  test_scaled_perturbations( module , rng , false );
+  test_scaled_perturbations( module , rng , true );
+
+  analysis_module_free( module );
+  rng_free( rng );
+  exit(0);
+}
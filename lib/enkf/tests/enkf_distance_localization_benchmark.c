@@ -0,0 +1,124 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_distance_localization_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Benchmark of the distance based localization on a synthetic grid;
+  prints the wall clock time used for the localized update with
+  different tile sizes. The benchmark is not part of the test suite,
+  run it manually as:
+
+     enkf_distance_localization_benchmark [nx] [ny] [nz] [num_threads]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#include <ert/res_util/matrix.h>
+
+#include <ert/analysis/obs_covar.h>
+#include <ert/analysis/analysis_module.h>
+
+#include <ert/enkf/distance_localization.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+int main( int argc , char ** argv ) {
+  const int nx          = int_arg( argc , argv , 1 , 100 );
+  const int ny          = int_arg( argc , argv , 2 , 100 );
+  const int nz          = int_arg( argc , argv , 3 , 10 );
+  const int num_threads = int_arg( argc , argv , 4 , 4 );
+  const int ens_size    = 50;
+  const int num_obs     = 200;
+  const double radius   = 20;
+  int tile_sizes[]      = {2 , 4 , 8};
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  analysis_module_type * module = analysis_module_alloc_internal( "STD_ENKF" );
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( nx , ny , nz , 1.0 , 1.0 , 1.0 , NULL );
+  const int num_cells = ecl_grid_get_active_size( grid );
+  matrix_type * A    = matrix_alloc( num_cells , ens_size );
+  matrix_type * S    = matrix_alloc( num_obs , ens_size );
+  matrix_type * E    = matrix_alloc( num_obs , ens_size );
+  matrix_type * D    = matrix_alloc( num_obs , ens_size );
+  matrix_type * dObs = matrix_alloc( num_obs , 2 );
+  obs_covar_type * R = obs_covar_alloc( num_obs );
+
+  matrix_random_init( A , rng );
+  matrix_random_init( S , rng );
+  matrix_random_init( E , rng );
+  for (int iobs = 0; iobs < num_obs; iobs++) {
+    matrix_iset( dObs , iobs , 0 , rng_get_double( rng ));
+    matrix_iset( dObs , iobs , 1 , 0.5 );
+    obs_covar_iset_var( R , iobs , 0.25 );
+    for (int iens = 0; iens < ens_size; iens++)
+      matrix_iset( D , iobs , iens , matrix_iget( dObs , iobs , 0 ) + matrix_iget( E , iobs , iens ) - matrix_iget( S , iobs , iens ));
+  }
+
+  printf("Synthetic grid: %d cells  %d realizations  %d observations  radius:%g  threads:%d\n",
+         num_cells , ens_size , num_obs , radius , num_threads);
+  for (int itile = 0; itile < 3; itile++) {
+    distance_localization_type * localization = distance_localization_alloc( radius , tile_sizes[itile] );
+    for (int iobs = 0; iobs < num_obs; iobs++) {
+      double x , y , z;
+      ecl_grid_get_xyz3( grid ,
+                         rng_get_int( rng , nx ) ,
+                         rng_get_int( rng , ny ) ,
+                         rng_get_int( rng , nz ) ,
+                         &x , &y , &z );
+      distance_localization_add_obs( localization , x , y , z );
+    }
+
+    {
+      double start = wall_clock( );
+      int num_tiles = distance_localization_update_field( localization , grid , NULL , A , 0 , num_cells , module ,
+                                                          S , R , dObs , E , D , rng , num_threads );
+      printf("  tile size:%d  tiles:%6d  wall time: %8.3f s\n", tile_sizes[itile] , num_tiles , wall_clock( ) - start);
+    }
+    distance_localization_free( localization );
+  }
+
+  obs_covar_free( R );
+  matrix_free( dObs );
+  matrix_free( D );
+  matrix_free( E );
+  matrix_free( S );
+  matrix_free( A );
+  ecl_grid_free( grid );
+  analysis_module_free( module );
+  rng_free( rng );
+  exit(0);
+}
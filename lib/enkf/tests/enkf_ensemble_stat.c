@@ -0,0 +1,125 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_ensemble_stat.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/double_vector.h>
+
+#include <ert/enkf/ensemble_stat.h>
+
+
+void test_empty() {
+  ensemble_stat_type * stat = ensemble_stat_alloc( NULL );
+  test_assert_true( ensemble_stat_is_instance( stat ));
+  test_assert_int_equal( -1 , ensemble_stat_get_size( stat ));
+  test_assert_int_equal( 0 , ensemble_stat_get_count( stat ));
+  test_assert_int_equal( 0 , ensemble_stat_get_num_quantiles( stat ));
+  ensemble_stat_free( stat );
+}
+
+
+void test_moments() {
+  const int ens_size = 100;
+  const int size = 3;
+  ensemble_stat_type * stat = ensemble_stat_alloc( NULL );
+  double sum[3] = {0,0,0};
+  double sum2[3] = {0,0,0};
+
+  for (int iens = 0; iens < ens_size; iens++) {
+    double data[3] = { iens , 1e6 + 0.001 * iens , -iens * iens };
+    ensemble_stat_add_sample( stat , data , size );
+    for (int i = 0; i < size; i++) {
+      sum[i] += data[i];
+      sum2[i] += data[i] * data[i];
+    }
+  }
+
+  test_assert_int_equal( size , ensemble_stat_get_size( stat ));
+  test_assert_int_equal( ens_size , ensemble_stat_get_count( stat ));
+  for (int i = 0; i < size; i++) {
+    double mean = sum[i] / ens_size;
+    test_assert_double_equal( mean , ensemble_stat_iget_mean( stat , i ));
+  }
+
+  test_assert_double_equal( sqrt( sum2[0] / ens_size - (sum[0] / ens_size) * (sum[0] / ens_size)) , ensemble_stat_iget_std( stat , 0 ));
+  /* The naive formula loses all precision for element 1; the expected value is 0.001 * std(0..99). */
+  test_assert_true( fabs( ensemble_stat_iget_std( stat , 1 ) - 0.001 * ensemble_stat_iget_std( stat , 0 )) < 1e-7 );
+
+  test_assert_double_equal( 0 , ensemble_stat_iget_min( stat , 0 ));
+  test_assert_double_equal( ens_size - 1 , ensemble_stat_iget_max( stat , 0 ));
+  test_assert_double_equal( -(ens_size - 1) * (ens_size - 1) , ensemble_stat_iget_min( stat , 2 ));
+  test_assert_double_equal( 0 , ensemble_stat_iget_max( stat , 2 ));
+  ensemble_stat_free( stat );
+}
+
+
+void test_quantiles() {
+  double_vector_type * quantiles = double_vector_alloc( 0 , 0 );
+  double_vector_append( quantiles , 0.10 );
+  double_vector_append( quantiles , 0.50 );
+  double_vector_append( quantiles , 0.90 );
+  {
+    ensemble_stat_type * stat = ensemble_stat_alloc( quantiles );
+    double values[5] = { 4 , 0 , 3 , 1 , 2 };
+
+    /* Exact quantiles as long as there are no more than five samples. */
+    for (int i = 0; i < 5; i++)
+      ensemble_stat_add_sample( stat , &values[i] , 1 );
+
+    test_assert_double_equal( 0.4 , ensemble_stat_iget_quantile( stat , 0 , 0 ));
+    test_assert_double_equal( 2.0 , ensemble_stat_iget_quantile( stat , 1 , 0 ));
+    test_assert_double_equal( 3.6 , ensemble_stat_iget_quantile( stat , 2 , 0 ));
+    ensemble_stat_free( stat );
+  }
+  {
+    const int ens_size = 1000;
+    ensemble_stat_type * stat = ensemble_stat_alloc( quantiles );
+
+    /* A fixed permutation of 0 ... ens_size - 1. */
+    for (int i = 0; i < ens_size; i++) {
+      double value = (i * 367) % ens_size;
+      ensemble_stat_add_sample( stat , &value , 1 );
+    }
+
+    for (int iq = 0; iq < double_vector_size( quantiles ); iq++) {
+      double expected = double_vector_iget( quantiles , iq ) * (ens_size - 1);
+      test_assert_true( fabs( ensemble_stat_iget_quantile( stat , iq , 0 ) - expected ) < 0.02 * ens_size );
+    }
+    ensemble_stat_free( stat );
+  }
+  double_vector_free( quantiles );
+}
+
+
+void test_size_mismatch( void * arg ) {
+  ensemble_stat_type * stat = ensemble_stat_alloc( NULL );
+  double data[2] = {0 , 1};
+  ensemble_stat_add_sample( stat , data , 2 );
+  ensemble_stat_add_sample( stat , data , 1 );
+}
+
+
+int main(int argc , char ** argv) {
+  test_empty();
+  test_moments();
+  test_quantiles();
+  test_assert_util_abort( "ensemble_stat_assert_size" , test_size_mismatch , NULL );
+  exit(0);
+}
@@ -0,0 +1,203 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_field_export3D.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <utime.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#include <ert/rms/rms_util.h>
+
+#include <ert/enkf/field.h>
+#include <ert/enkf/field_config.h>
+
+
+static ecl_grid_type * alloc_grid( int nx , int ny , int nz ) {
+  int * actnum = util_calloc( nx*ny*nz , sizeof * actnum );
+  ecl_grid_type * grid;
+
+  for (int g = 0; g < nx*ny*nz; g++)
+    actnum[g] = (g % 7 == 3) ? 0 : 1;
+
+  grid = ecl_grid_alloc_rectangular( nx , ny , nz , 1.0 , 1.0 , 1.0 , actnum );
+  free( actnum );
+  return grid;
+}
+
+
+static field_type * alloc_field( const field_config_type * config , int iens ) {
+  field_type * field = field_alloc( config );
+  int nx,ny,nz;
+
+  field_config_get_dims( config , &nx , &ny , &nz );
+  for (int k=0; k < nz; k++)
+    for (int j=0; j < ny; j++)
+      for (int i=0; i < nx; i++) {
+        if (field_config_active_cell( config , i , j , k )) {
+          float value = iens + 0.001 * field_config_global_index( config , i , j , k );
+          field_ijk_set( field , i , j , k , &value );
+        }
+      }
+  return field;
+}
+
+
+/*
+  Writes a GRDECL file with a value for every cell, active and
+  inactive; the value is -(global_index + 1 + offset).
+*/
+
+static void write_init_file( const char * filename , const char * kw , int volume , int offset ) {
+  FILE * stream = util_fopen( filename , "w");
+  fprintf(stream , "%s\n" , kw);
+  for (int g = 0; g < volume; g++)
+    fprintf(stream , "%g\n" , -(g + 1.0 + offset));
+  fprintf(stream , "/\n");
+  fclose( stream );
+}
+
+
+static void test_export( const field_config_type * config , const field_type * field , int iens , bool rms_index_order , const char * init_file , int init_offset) {
+  int nx,ny,nz;
+  float fill = -999;
+  float * data;
+
+  field_config_get_dims( config , &nx , &ny , &nz );
+  data = util_calloc( nx*ny*nz , sizeof * data );
+  field_export3D( field , data , rms_index_order , ECL_FLOAT , &fill , init_file );
+
+  for (int k=0; k < nz; k++)
+    for (int j=0; j < ny; j++)
+      for (int i=0; i < nx; i++) {
+        int g = field_config_global_index( config , i , j , k );
+        int index = rms_index_order ? rms_util_global_index_from_eclipse_ijk( nx , ny , nz , i , j , k) : i + j*nx + k*nx*ny;
+
+        if (field_config_active_cell( config , i , j , k ))
+          test_assert_double_equal( (float) (iens + 0.001 * g) , data[index] );
+        else if (init_file)
+          test_assert_double_equal( -(g + 1.0 + init_offset) , data[index] );
+        else
+          test_assert_double_equal( fill , data[index] );
+      }
+
+  free( data );
+}
+
+
+void test_export3D( ) {
+  test_work_area_type * work_area = test_work_area_alloc("field_export3D");
+  ecl_grid_type * grid = alloc_grid( 6 , 5 , 4 );
+  field_config_type * config = field_config_alloc_empty( "PORO" , grid , NULL , false );
+  field_type * field = alloc_field( config , 3 );
+
+  write_init_file( "init.grdecl" , "PORO" , 6*5*4 , 0 );
+  test_assert_NULL( field_config_get_init_data( config , "init.grdecl" ));
+
+  test_export( config , field , 3 , false , NULL , 0 );
+  test_export( config , field , 3 , true  , NULL , 0 );
+  test_export( config , field , 3 , false , "init.grdecl" , 0 );
+  {
+    const void * init_data = field_config_get_init_data( config , "init.grdecl" );
+    test_assert_not_NULL( init_data );
+    field_config_release_init_data( config , init_data );
+  }
+  test_export( config , field , 3 , true  , "init.grdecl" , 0 );
+
+  {
+    const int * active_map = field_config_get_active_map( config , false );
+    const int * global_map = field_config_get_global_map( config , false );
+    test_assert_true( active_map == field_config_get_active_map( config , false ));
+    for (int g = 0; g < 6*5*4; g++) {
+      test_assert_int_equal( g , global_map[g] );
+      test_assert_int_equal( ecl_grid_get_active_index1( grid , g ) , active_map[g] );
+    }
+  }
+
+  /* Round trip through the ROFF file; exercises the import path. */
+  {
+    field_type * field2 = field_alloc( config );
+    field_ROFF_export( field , "poro.roff" , NULL );
+    test_assert_true( field_fload_rms( field2 , "poro.roff" , false ));
+    test_assert_true( field_cmp( field , field2 ));
+    field_free( field2 );
+  }
+
+  field_free( field );
+  field_config_free( config );
+  ecl_grid_free( grid );
+  test_work_area_free( work_area );
+}
+
+
+/*
+  When the INIT_FILE is modified the cached data is replaced, also
+  while a reference to the old data is still held.
+*/
+
+static void set_mtime( const char * filename , time_t mtime ) {
+  struct utimbuf times = {.actime = mtime , .modtime = mtime};
+  utime( filename , &times );
+}
+
+
+void test_init_file_modified( ) {
+  test_work_area_type * work_area = test_work_area_alloc("field_export3D_init_modified");
+  ecl_grid_type * grid = alloc_grid( 6 , 5 , 4 );
+  field_config_type * config = field_config_alloc_empty( "PORO" , grid , NULL , false );
+  field_type * field = alloc_field( config , 1 );
+  time_t mtime = time( NULL ) - 100;
+  const void * old_data;
+
+  write_init_file( "init.grdecl" , "PORO" , 6*5*4 , 0 );
+  set_mtime( "init.grdecl" , mtime );
+  test_export( config , field , 1 , false , "init.grdecl" , 0 );
+  old_data = field_config_get_init_data( config , "init.grdecl" );
+  test_assert_not_NULL( old_data );
+
+  for (int offset = 1; offset <= 3; offset++) {
+    write_init_file( "init.grdecl" , "PORO" , 6*5*4 , 100 * offset );
+    set_mtime( "init.grdecl" , mtime + offset );
+    test_assert_NULL( field_config_get_init_data( config , "init.grdecl" ));
+    test_export( config , field , 1 , false , "init.grdecl" , 100 * offset );
+  }
+
+  /* The first entry is kept until its last reference is released. */
+  test_assert_int_equal( 2 , field_config_get_num_init_data( config ));
+  field_config_release_init_data( config , old_data );
+  test_assert_int_equal( 1 , field_config_get_num_init_data( config ));
+
+  test_export( config , field , 1 , true , "init.grdecl" , 300 );
+  test_assert_int_equal( 1 , field_config_get_num_init_data( config ));
+
+  field_free( field );
+  field_config_free( config );
+  ecl_grid_free( grid );
+  test_work_area_free( work_area );
+}
+
+
+int main(int argc , char ** argv) {
+  test_export3D( );
+  test_init_file_modified( );
+  exit(0);
+}
@@ -0,0 +1,111 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_field_export_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Benchmark of the FIELD export done when the realizations are
+  started: the parameter of a full ensemble is exported to ROFF and
+  GRDECL files, with the inactive cells filled from an INIT_FILE. The
+  benchmark is not part of the test suite, run it manually as:
+
+     enkf_field_export_benchmark [nx] [ny] [nz] [ens_size]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#include <ert/enkf/field.h>
+#include <ert/enkf/field_config.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static ecl_grid_type * alloc_grid( int nx , int ny , int nz ) {
+  int * actnum = util_calloc( nx*ny*nz , sizeof * actnum );
+  ecl_grid_type * grid;
+
+  for (int g = 0; g < nx*ny*nz; g++)
+    actnum[g] = (g % 7 == 3) ? 0 : 1;
+
+  grid = ecl_grid_alloc_rectangular( nx , ny , nz , 1.0 , 1.0 , 1.0 , actnum );
+  free( actnum );
+  return grid;
+}
+
+
+static void write_init_file( const char * filename , const char * kw , int volume ) {
+  FILE * stream = util_fopen( filename , "w");
+  fprintf(stream , "%s\n" , kw);
+  for (int g = 0; g < volume; g++)
+    fprintf(stream , "%g\n" , -(g + 1.0));
+  fprintf(stream , "/\n");
+  fclose( stream );
+}
+
+
+int main( int argc , char ** argv ) {
+  const int nx       = int_arg( argc , argv , 1 , 100 );
+  const int ny       = int_arg( argc , argv , 2 , 100 );
+  const int nz       = int_arg( argc , argv , 3 , 20 );
+  const int ens_size = int_arg( argc , argv , 4 , 25 );
+  test_work_area_type * work_area = test_work_area_alloc("field_export_benchmark");
+  ecl_grid_type * grid = alloc_grid( nx , ny , nz );
+  field_config_type * config = field_config_alloc_empty( "PORO" , grid , NULL , false );
+  field_type * field = field_alloc( config );
+
+  write_init_file( "init.grdecl" , "PORO" , nx*ny*nz );
+  {
+    double start = wall_clock( );
+    for (int iens = 0; iens < ens_size; iens++) {
+      char * roff_file = util_alloc_sprintf( "poro_%d.roff" , iens );
+      char * grdecl_file = util_alloc_sprintf( "poro_%d.grdecl" , iens );
+
+      field_export( field , roff_file , NULL , RMS_ROFF_FILE , false , "init.grdecl" );
+      field_export( field , grdecl_file , NULL , ECL_GRDECL_FILE , false , "init.grdecl" );
+
+      free( grdecl_file );
+      free( roff_file );
+    }
+    printf("Exported %d realizations of %d cells to ROFF and GRDECL: %8.3f s\n", ens_size , nx*ny*nz ,
+           wall_clock( ) - start);
+  }
+
+  field_free( field );
+  field_config_free( config );
+  ecl_grid_free( grid );
+  test_work_area_free( work_area );
+  exit(0);
+}
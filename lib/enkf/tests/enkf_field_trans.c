@@ -0,0 +1,126 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_field_trans.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+
+#include <ert/enkf/enkf_types.h>
+#include <ert/enkf/field_trans.h>
+
+
+static const char * builtin_keys[] = {"POW10" , "TRUNC_POW10" , "LOG" , "LN" , "LOG10" , "EXP" , "LN0" , "EXP0" , "NORMALIZE_PORO"};
+#define NUM_KEYS (sizeof builtin_keys / sizeof builtin_keys[0])
+
+
+static float user_func(float x) {
+  return 2*x + 1;
+}
+
+
+static void init_data(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = 0.1 + 2.0 * i / size;
+}
+
+
+/* The per element path - as in field_apply() before the batch kernels. */
+static void apply_scalar(field_func_type * func , float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = func(data[i]);
+}
+
+
+void test_apply(field_trans_table_type * table) {
+  const int size = 1000;
+  float * data1 = util_calloc( size , sizeof * data1 );
+  float * data2 = util_calloc( size , sizeof * data2 );
+
+  for (int ikey = 0; ikey < NUM_KEYS; ikey++) {
+    field_func_type * func = field_trans_table_lookup( table , builtin_keys[ikey] );
+
+    init_data( data1 , size );
+    init_data( data2 , size );
+    apply_scalar( func , data1 , size );
+    field_trans_apply_float( func , data2 , size );
+
+    for (int i=0; i < size; i++)
+      test_assert_double_equal( data1[i] , data2[i] );
+  }
+
+  test_assert_NULL( field_trans_get_vector_func( user_func ));
+  test_assert_not_NULL( field_trans_get_vector_func( field_trans_table_lookup( table , "EXP" )));
+
+  init_data( data1 , size );
+  field_trans_apply_float( user_func , data1 , size );
+  test_assert_double_equal( user_func( 0.1 ) , data1[0] );
+
+  free( data2 );
+  free( data1 );
+}
+
+
+void test_truncate( ) {
+  float  fdata[5] = {-2 , -1 , 0 , 1 , 2};
+  double ddata[5] = {-2 , -1 , 0 , 1 , 2};
+
+  field_trans_truncate_float( fdata , 5 , TRUNCATE_NONE , -1 , 1);
+  test_assert_double_equal( -2 , fdata[0] );
+
+  field_trans_truncate_float( fdata , 5 , TRUNCATE_MIN , -1 , 1);
+  test_assert_double_equal( -1 , fdata[0] );
+  test_assert_double_equal(  2 , fdata[4] );
+
+  field_trans_truncate_float( fdata , 5 , TRUNCATE_MAX , -1 , 1);
+  test_assert_double_equal(  1 , fdata[4] );
+
+  field_trans_truncate_double( ddata , 5 , TRUNCATE_MIN + TRUNCATE_MAX , -0.5 , 0.5);
+  test_assert_double_equal( -0.5 , ddata[0] );
+  test_assert_double_equal( -0.5 , ddata[1] );
+  test_assert_double_equal(  0.0 , ddata[2] );
+  test_assert_double_equal(  0.5 , ddata[3] );
+  test_assert_double_equal(  0.5 , ddata[4] );
+
+  /* Limits which are not representable as float must compare as double. */
+  {
+    float x[3] = {0.1f , nextafterf(0.1f , 0) , 0.7f};
+    field_trans_truncate_float( x , 3 , TRUNCATE_MIN + TRUNCATE_MAX , 0.1 , 0.7);
+    test_assert_true( x[0] == 0.1f );
+    test_assert_true( x[1] == 0.1f );
+    test_assert_true( x[2] == 0.7f );
+  }
+  {
+    float x[2] = {0.7f , nextafterf(0.7f , 1)};
+    field_trans_truncate_float( x , 2 , TRUNCATE_MAX , 0 , 0.7);
+    test_assert_true( x[0] == 0.7f );
+    test_assert_true( x[1] == 0.7f );
+  }
+}
+
+
+int main(int argc , char ** argv) {
+  field_trans_table_type * table = field_trans_table_alloc();
+
+  test_apply( table );
+  test_truncate( );
+
+  field_trans_table_free( table );
+  exit(0);
+}
@@ -0,0 +1,118 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_field_trans_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Micro benchmark of the FIELD output transforms and truncation: the
+  per element function pointer path against the batch kernels. The
+  benchmark is not part of the test suite, run it manually as:
+
+     enkf_field_trans_benchmark [size]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/util.h>
+
+#include <ert/enkf/enkf_types.h>
+#include <ert/enkf/field_trans.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static void init_data(float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = 0.1 + 2.0 * i / size;
+}
+
+
+static void apply_scalar(field_func_type * func , float * data , int size) {
+  for (int i=0; i < size; i++)
+    data[i] = func(data[i]);
+}
+
+
+static void truncate_scalar(float * data , int size , int truncation , float min_value , float max_value) {
+  for (int i=0; i < size; i++) {
+    if (truncation & TRUNCATE_MIN)
+      if (data[i] < min_value)
+        data[i] = min_value;
+    if (truncation & TRUNCATE_MAX)
+      if (data[i] > max_value)
+        data[i] = max_value;
+  }
+}
+
+
+int main( int argc , char ** argv ) {
+  const int size = int_arg( argc , argv , 1 , 5000000 );
+  field_trans_table_type * table = field_trans_table_alloc();
+  float * data = util_calloc( size , sizeof * data );
+  const char * keys[] = {"EXP" , "LOG" , "POW10"};
+
+  for (int ikey = 0; ikey < 3; ikey++) {
+    field_func_type * func = field_trans_table_lookup( table , keys[ikey] );
+    double start , scalar_time , batch_time;
+
+    init_data( data , size );
+    start = wall_clock( );
+    apply_scalar( func , data , size );
+    scalar_time = wall_clock( ) - start;
+
+    init_data( data , size );
+    start = wall_clock( );
+    field_trans_apply_float( func , data , size );
+    batch_time = wall_clock( ) - start;
+
+    printf("%-6s  scalar: %8.3f s   batch: %8.3f s\n", keys[ikey] , scalar_time , batch_time);
+  }
+
+  {
+    double start , scalar_time , batch_time;
+
+    init_data( data , size );
+    start = wall_clock( );
+    truncate_scalar( data , size , TRUNCATE_MIN + TRUNCATE_MAX , 0.5 , 1.5 );
+    scalar_time = wall_clock( ) - start;
+
+    init_data( data , size );
+    start = wall_clock( );
+    field_trans_truncate_float( data , size , TRUNCATE_MIN + TRUNCATE_MAX , 0.5 , 1.5 );
+    batch_time = wall_clock( ) - start;
+
+    printf("TRUNC   scalar: %8.3f s   batch: %8.3f s\n", scalar_time , batch_time);
+  }
+
+  free( data );
+  field_trans_table_free( table );
+  exit(0);
+}
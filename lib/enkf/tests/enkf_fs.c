@@ -25,11 +25,20 @@
 #include <assert.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <string.h>
 
 
+#include <ert/util/buffer.h>
 #include <ert/util/test_util.h>
 #include <ert/util/test_work_area.h>
 #include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/enkf_node.h>
+#include <ert/enkf/enkf_config_node.h>
+#include <ert/enkf/summary.h>
+
+
+#define COPY_ENS_SIZE  20
+#define COPY_NODE_SIZE 10000
 
 
 typedef struct
@@ -148,9 +157,237 @@ void test_read_only2() {
   munmap(data, sizeof(data));
 }
 
+static void store_test_nodes( enkf_fs_type * fs ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  for (int iens = 0; iens < COPY_ENS_SIZE; iens++) {
+    buffer_clear( buffer );
+    for (int i = 0; i < COPY_NODE_SIZE; i++)
+      buffer_fwrite_double( buffer , iens * 1000 + i );
+    enkf_fs_fwrite_node( fs , buffer , "PARAM" , PARAMETER , 0 , iens );
+  }
+  buffer_free( buffer );
+}
+
+
+static void assert_equal_nodes( enkf_fs_type * fs1 , enkf_fs_type * fs2 ) {
+  buffer_type * buffer1 = buffer_alloc( 100 );
+  buffer_type * buffer2 = buffer_alloc( 100 );
+  for (int iens = 0; iens < COPY_ENS_SIZE; iens++) {
+    test_assert_true( enkf_fs_has_node( fs2 , "PARAM" , PARAMETER , 0 , iens ));
+    enkf_fs_fread_node( fs1 , buffer1 , "PARAM" , PARAMETER , 0 , iens );
+    enkf_fs_fread_node( fs2 , buffer2 , "PARAM" , PARAMETER , 0 , iens );
+    test_assert_size_t_equal( buffer_get_size( buffer1 ) , buffer_get_size( buffer2 ));
+    test_assert_int_equal( 0 , memcmp( buffer_get_data( buffer1 ) , buffer_get_data( buffer2 ) , buffer_get_size( buffer1 )));
+  }
+  buffer_free( buffer1 );
+  buffer_free( buffer2 );
+}
+
+
+void test_copy_node() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/copy_node");
+  enkf_fs_type * src_fs = enkf_fs_create_fs( "src" , BLOCK_FS_DRIVER_ID , NULL , true);
+  enkf_fs_type * target_fs = enkf_fs_create_fs( "target" , BLOCK_FS_DRIVER_ID , NULL , true);
+  store_test_nodes( src_fs );
+  {
+    buffer_type * buffer = buffer_alloc( 100 );
+    for (int iens = 0; iens < COPY_ENS_SIZE; iens++) {
+      node_id_type node_id = {.report_step = 0 , .iens = iens};
+      enkf_fs_copy_node( src_fs , target_fs , buffer , "PARAM" , PARAMETER , node_id , node_id );
+    }
+    buffer_free( buffer );
+  }
+  assert_equal_nodes( src_fs , target_fs );
+  enkf_fs_decref( target_fs );
+  enkf_fs_decref( src_fs );
+  test_work_area_free( work_area );
+}
+
+
+static void store_summary_vector( const enkf_config_node_type * config_node , enkf_fs_type * fs , int iens , double offset ) {
+  enkf_node_type * node = enkf_node_alloc( config_node );
+  summary_type * summary = enkf_node_value_ptr( node );
+  node_id_type node_id = {.report_step = 0 , .iens = iens};
+  for (int step = 0; step < 5; step++)
+    summary_set( summary , step , offset + step );
+  enkf_node_store( node , fs , true , node_id );
+  enkf_node_free( node );
+}
+
+
+void test_copy_vector_step() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/copy_vector_step");
+  enkf_config_node_type * config_node = enkf_config_node_alloc_summary( "FOPR" , LOAD_FAIL_SILENT );
+  enkf_fs_type * src_fs = enkf_fs_create_fs( "src" , BLOCK_FS_DRIVER_ID , NULL , true);
+  enkf_fs_type * target_fs = enkf_fs_create_fs( "target" , BLOCK_FS_DRIVER_ID , NULL , true);
+
+  store_summary_vector( config_node , src_fs , 0 , 100 );
+  store_summary_vector( config_node , target_fs , 0 , 200 );
+  {
+    node_id_type src_id = {.report_step = 1 , .iens = 0};
+    node_id_type target_id = {.report_step = 3 , .iens = 0};
+    enkf_node_copy( config_node , src_fs , target_fs , src_id , target_id );
+  }
+  {
+    node_id_type node_id = {.report_step = 0 , .iens = 0};
+    enkf_node_type * node = enkf_node_load_alloc( config_node , target_fs , node_id );
+    const summary_type * summary = enkf_node_value_ptr( node );
+
+    /* Only step 3 of the target vector is replaced. */
+    test_assert_int_equal( 5 , summary_length( summary ));
+    test_assert_double_equal( 200 , summary_get( summary , 0 ));
+    test_assert_double_equal( 202 , summary_get( summary , 2 ));
+    test_assert_double_equal( 101 , summary_get( summary , 3 ));
+    test_assert_double_equal( 204 , summary_get( summary , 4 ));
+    enkf_node_free( node );
+  }
+  {
+    /* Equal report steps move the whole vector. */
+    node_id_type node_id = {.report_step = 2 , .iens = 0};
+    enkf_node_copy( config_node , src_fs , target_fs , node_id , node_id );
+    {
+      enkf_node_type * node = enkf_node_load_alloc( config_node , target_fs , node_id );
+      const summary_type * summary = enkf_node_value_ptr( node );
+      for (int step = 0; step < 5; step++)
+        test_assert_double_equal( 100 + step , summary_get( summary , step ));
+      enkf_node_free( node );
+    }
+  }
+
+  enkf_fs_decref( target_fs );
+  enkf_fs_decref( src_fs );
+  enkf_config_node_free( config_node );
+  test_work_area_free( work_area );
+}
+
+
+void test_io_counters() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/io_counters");
+  enkf_fs_type * fs = enkf_fs_create_fs( "mnt" , BLOCK_FS_DRIVER_ID , NULL , true);
+  long bytes_read = enkf_fs_get_bytes_read( fs );
+  long bytes_written = enkf_fs_get_bytes_written( fs );
+
+  store_test_nodes( fs );
+  test_assert_long_equal( bytes_written + (long) (COPY_ENS_SIZE * COPY_NODE_SIZE * sizeof(double)) , enkf_fs_get_bytes_written( fs ));
+  test_assert_long_equal( bytes_read , enkf_fs_get_bytes_read( fs ));
+  {
+    buffer_type * buffer = buffer_alloc( 100 );
+    enkf_fs_fread_node( fs , buffer , "PARAM" , PARAMETER , 0 , 0 );
+    test_assert_long_equal( bytes_read + (long) (COPY_NODE_SIZE * sizeof(double)) , enkf_fs_get_bytes_read( fs ));
+    buffer_free( buffer );
+  }
+  enkf_fs_decref( fs );
+  test_work_area_free( work_area );
+}
+
+
+void test_clone() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/clone");
+  enkf_fs_type * src_fs = enkf_fs_create_fs( "src" , BLOCK_FS_DRIVER_ID , NULL , true);
+  store_test_nodes( src_fs );
+  {
+    enkf_fs_type * clone_fs = enkf_fs_clone( src_fs , "clone" , true );
+
+    test_assert_true( enkf_fs_is_instance( clone_fs ));
+    test_assert_false( enkf_fs_is_read_only( clone_fs ));
+    assert_equal_nodes( src_fs , clone_fs );
+
+    /* Writing to the clone should not affect the source case. */
+    {
+      buffer_type * buffer = buffer_alloc( 100 );
+      buffer_fwrite_double( buffer , -1 );
+      enkf_fs_fwrite_node( clone_fs , buffer , "PARAM" , PARAMETER , 0 , 0 );
+      buffer_clear( buffer );
+      enkf_fs_fread_node( src_fs , buffer , "PARAM" , PARAMETER , 0 , 0 );
+      test_assert_size_t_equal( COPY_NODE_SIZE * sizeof(double) , buffer_get_size( buffer ));
+      buffer_free( buffer );
+    }
+    enkf_fs_decref( clone_fs );
+  }
+  test_assert_true( enkf_fs_exists( "clone" ));
+  enkf_fs_decref( src_fs );
+  test_work_area_free( work_area );
+}
+
+
+static void assert_test_node( enkf_fs_type * fs , int iens ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  enkf_fs_fread_node( fs , buffer , "PARAM" , PARAMETER , 0 , iens );
+  test_assert_size_t_equal( COPY_NODE_SIZE * sizeof(double) , buffer_get_size( buffer ));
+  for (int i = 0; i < COPY_NODE_SIZE; i++)
+    test_assert_double_equal( iens * 1000 + i , buffer_fread_double( buffer ));
+  buffer_free( buffer );
+}
+
+
+void test_lazy_mount() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/lazy_mount");
+  {
+    enkf_fs_type * fs = enkf_fs_create_fs( "mnt" , BLOCK_FS_DRIVER_ID , NULL , true);
+    test_assert_int_equal( 65 , enkf_fs_get_num_mounted_shards( fs ));
+    store_test_nodes( fs );
+    enkf_fs_decref( fs );
+  }
+
+  {
+    enkf_fs_type * fs = enkf_fs_mount_lazy( "mnt" , false );
+    test_assert_false( enkf_fs_is_read_only( fs ));
+    test_assert_true( util_file_exists("mnt/mnt.lock"));
+    test_assert_int_equal( 0 , enkf_fs_get_num_mounted_shards( fs ));
+
+    assert_test_node( fs , 3 );
+    test_assert_int_equal( 1 , enkf_fs_get_num_mounted_shards( fs ));
+    assert_test_node( fs , 3 );
+    test_assert_true( enkf_fs_has_node( fs , "PARAM" , PARAMETER , 0 , 5 ));
+    test_assert_int_equal( 2 , enkf_fs_get_num_mounted_shards( fs ));
+
+    /* Realization 35 lives in the same shard as realization 3. */
+    {
+      buffer_type * buffer = buffer_alloc( 100 );
+      buffer_fwrite_double( buffer , 35 );
+      enkf_fs_fwrite_node( fs , buffer , "PARAM" , PARAMETER , 0 , 35 );
+      buffer_free( buffer );
+    }
+    test_assert_int_equal( 2 , enkf_fs_get_num_mounted_shards( fs ));
+    enkf_fs_decref( fs );
+  }
+
+  {
+    enkf_fs_type * fs = enkf_fs_mount_lazy( "mnt" , true );
+    test_assert_true( enkf_fs_is_read_only( fs ));
+    test_assert_false( util_file_exists("mnt/mnt.lock"));
+    for (int iens = 0; iens < COPY_ENS_SIZE; iens++)
+      assert_test_node( fs , iens );
+    test_assert_true( enkf_fs_has_node( fs , "PARAM" , PARAMETER , 0 , 35 ));
+    test_assert_int_equal( COPY_ENS_SIZE , enkf_fs_get_num_mounted_shards( fs ));
+    test_assert_util_abort( "enkf_fs_fwrite_node" , test_fwrite_readonly , fs );
+    enkf_fs_decref( fs );
+  }
+
+  /* A read only lazy mount should not create anything on disk. */
+  enkf_fs_create_fs( "empty" , BLOCK_FS_DRIVER_ID , NULL , false);
+  {
+    enkf_fs_type * fs = enkf_fs_mount_lazy( "empty" , true );
+    test_assert_false( enkf_fs_has_node( fs , "PARAM" , PARAMETER , 0 , 0 ));
+    test_assert_false( enkf_fs_has_vector( fs , "VECTOR" , DYNAMIC_RESULT , 7 ));
+    test_assert_int_equal( 2 , enkf_fs_get_num_mounted_shards( fs ));
+    test_assert_false( util_file_exists("empty/Ensemble/mod_0/PARAMETER.mnt"));
+    test_assert_false( util_file_exists("empty/Ensemble/mod_7/FORECAST.mnt"));
+    test_assert_false( util_file_exists("empty/empty.lock"));
+    enkf_fs_decref( fs );
+  }
+  test_work_area_free( work_area );
+}
+
+
 int main(int argc, char ** argv) {
   test_mount();
   test_refcount();
+  test_copy_node();
+  test_copy_vector_step();
+  test_io_counters();
+  test_clone();
+  test_lazy_mount();
   test_read_only2();
   exit(0);
 }
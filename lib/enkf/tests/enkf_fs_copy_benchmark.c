@@ -0,0 +1,179 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_fs_copy_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Benchmark of the case copying done by the smoother and by IES: the
+  parameters of the whole ensemble are copied from one case to the
+  next, for IES once per iteration. Three strategies are timed:
+
+    decode   : load every node, decode the values and encode/store them
+               again; this is the cost of the old enkf_node load/store
+               copy.
+    raw      : enkf_fs_copy_node() - the stored bytes are moved without
+               decoding.
+    clone    : enkf_fs_clone() - the data files of the case are cloned.
+
+  The benchmark is not part of the test suite, run it manually as:
+
+     enkf_fs_copy_benchmark [ens_size] [num_params] [param_size] [iterations]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/buffer.h>
+#include <ert/util/util.h>
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/enkf/enkf_fs.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static void param_key( char * key , int iparam ) {
+  sprintf( key , "PARAM%d" , iparam );
+}
+
+
+static void store_prior( enkf_fs_type * fs , int ens_size , int num_params , int param_size ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  char key[32];
+  for (int iparam = 0; iparam < num_params; iparam++) {
+    param_key( key , iparam );
+    for (int iens = 0; iens < ens_size; iens++) {
+      buffer_clear( buffer );
+      for (int i = 0; i < param_size; i++)
+        buffer_fwrite_double( buffer , iparam + iens * 1000 + i );
+      enkf_fs_fwrite_node( fs , buffer , key , PARAMETER , 0 , iens );
+    }
+  }
+  buffer_free( buffer );
+  enkf_fs_fsync( fs );
+}
+
+
+static void copy_decode( enkf_fs_type * src_fs , enkf_fs_type * target_fs , int ens_size , int num_params , int param_size ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  double * data = util_calloc( param_size , sizeof * data );
+  char key[32];
+  for (int iparam = 0; iparam < num_params; iparam++) {
+    param_key( key , iparam );
+    for (int iens = 0; iens < ens_size; iens++) {
+      enkf_fs_fread_node( src_fs , buffer , key , PARAMETER , 0 , iens );
+      buffer_fread( buffer , data , sizeof * data , param_size );
+
+      buffer_clear( buffer );
+      buffer_fwrite( buffer , data , sizeof * data , param_size );
+      enkf_fs_fwrite_node( target_fs , buffer , key , PARAMETER , 0 , iens );
+    }
+  }
+  free( data );
+  buffer_free( buffer );
+  enkf_fs_fsync( target_fs );
+}
+
+
+static void copy_raw( enkf_fs_type * src_fs , enkf_fs_type * target_fs , int ens_size , int num_params ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  char key[32];
+  for (int iparam = 0; iparam < num_params; iparam++) {
+    param_key( key , iparam );
+    for (int iens = 0; iens < ens_size; iens++) {
+      node_id_type node_id = {.report_step = 0 , .iens = iens};
+      enkf_fs_copy_node( src_fs , target_fs , buffer , key , PARAMETER , node_id , node_id );
+    }
+  }
+  buffer_free( buffer );
+  enkf_fs_fsync( target_fs );
+}
+
+
+/*
+  Copies the prior through @iterations cases, iteration k+1 is created
+  from iteration k; returns the wall clock time per iteration.
+*/
+
+static double run_strategy( const char * strategy , int ens_size , int num_params , int param_size , int iterations ) {
+  char * case_name = util_alloc_sprintf( "%s_0" , strategy );
+  enkf_fs_type * src_fs = enkf_fs_create_fs( case_name , BLOCK_FS_DRIVER_ID , NULL , true );
+  double elapsed = 0;
+
+  store_prior( src_fs , ens_size , num_params , param_size );
+  for (int iter = 1; iter <= iterations; iter++) {
+    enkf_fs_type * target_fs;
+    double start;
+
+    free( case_name );
+    case_name = util_alloc_sprintf( "%s_%d" , strategy , iter );
+
+    start = wall_clock( );
+    if (util_string_equal( strategy , "clone" ))
+      target_fs = enkf_fs_clone( src_fs , case_name , true );
+    else {
+      target_fs = enkf_fs_create_fs( case_name , BLOCK_FS_DRIVER_ID , NULL , true );
+      if (util_string_equal( strategy , "raw" ))
+        copy_raw( src_fs , target_fs , ens_size , num_params );
+      else
+        copy_decode( src_fs , target_fs , ens_size , num_params , param_size );
+    }
+    elapsed += wall_clock( ) - start;
+
+    test_assert_true( enkf_fs_has_node( target_fs , "PARAM0" , PARAMETER , 0 , ens_size - 1 ));
+    enkf_fs_decref( src_fs );
+    src_fs = target_fs;
+  }
+  enkf_fs_decref( src_fs );
+  free( case_name );
+  return elapsed / iterations;
+}
+
+
+int main( int argc , char ** argv ) {
+  int ens_size   = int_arg( argc , argv , 1 , 100 );
+  int num_params = int_arg( argc , argv , 2 , 10 );
+  int param_size = int_arg( argc , argv , 3 , 10000 );
+  int iterations = int_arg( argc , argv , 4 , 4 );
+  const char * strategies[] = {"decode" , "raw" , "clone"};
+  test_work_area_type * work_area = test_work_area_alloc( "enkf_fs/copy_benchmark" );
+
+  printf("ens_size:%d  num_params:%d  param_size:%d  iterations:%d  (%g MB per case)\n",
+         ens_size , num_params , param_size , iterations ,
+         1.0 * ens_size * num_params * param_size * sizeof(double) / (1024 * 1024));
+  for (int i = 0; i < 3; i++) {
+    double seconds = run_strategy( strategies[i] , ens_size , num_params , param_size , iterations );
+    printf("%-8s %10.4f seconds per iteration\n" , strategies[i] , seconds);
+  }
+
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,120 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_fs_mount_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Switching between cases the way the GUI does when browsing: mount
+  the case, look at the metadata and one realization, and unmount it
+  again; with an eager mount, a lazy mount and a read only lazy
+  mount. The benchmark is not part of the test suite, run it manually
+  as:
+
+     enkf_fs_mount_benchmark [num_cases] [num_switch]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/buffer.h>
+#include <ert/util/util.h>
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/enkf/enkf_fs.h>
+
+#define ENS_SIZE  20
+#define NODE_SIZE 10000
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static void create_case( const char * case_path ) {
+  enkf_fs_type * fs = enkf_fs_create_fs( case_path , BLOCK_FS_DRIVER_ID , NULL , true);
+  buffer_type * buffer = buffer_alloc( 100 );
+  for (int iens = 0; iens < ENS_SIZE; iens++) {
+    buffer_clear( buffer );
+    for (int i = 0; i < NODE_SIZE; i++)
+      buffer_fwrite_double( buffer , iens * 1000 + i );
+    enkf_fs_fwrite_node( fs , buffer , "PARAM" , PARAMETER , 0 , iens );
+  }
+  buffer_free( buffer );
+  enkf_fs_decref( fs );
+}
+
+
+static double switch_cases( char ** cases , int num_cases , int num_switch , int mode ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  double start = wall_clock( );
+
+  for (int iswitch = 0; iswitch < num_switch; iswitch++) {
+    for (int icase = 0; icase < num_cases; icase++) {
+      enkf_fs_type * fs;
+      if (mode == 0)
+        fs = enkf_fs_mount( cases[icase] );
+      else
+        fs = enkf_fs_mount_lazy( cases[icase] , mode == 2 );
+
+      enkf_fs_get_state_map( fs );
+      enkf_fs_fread_node( fs , buffer , "PARAM" , PARAMETER , 0 , icase % ENS_SIZE );
+      test_assert_size_t_equal( NODE_SIZE * sizeof(double) , buffer_get_size( buffer ));
+      enkf_fs_decref( fs );
+    }
+  }
+
+  buffer_free( buffer );
+  return wall_clock( ) - start;
+}
+
+
+int main(int argc, char ** argv) {
+  const int num_cases  = int_arg( argc , argv , 1 , 10 );
+  const int num_switch = int_arg( argc , argv , 2 , 3 );
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/mount_benchmark");
+  char ** cases = util_calloc( num_cases , sizeof * cases );
+  double elapsed[3];
+
+  for (int icase = 0; icase < num_cases; icase++) {
+    cases[icase] = util_alloc_sprintf( "case_%d" , icase );
+    create_case( cases[icase] );
+  }
+
+  for (int mode = 0; mode < 3; mode++)
+    elapsed[mode] = switch_cases( cases , num_cases , num_switch , mode );
+
+  printf("Switching %d times between %d cases: eager: %g s   lazy: %g s   lazy read only: %g s\n" ,
+         num_switch , num_cases , elapsed[0] , elapsed[1] , elapsed[2]);
+
+  for (int icase = 0; icase < num_cases; icase++)
+    free( cases[icase] );
+  free( cases );
+  test_work_area_free( work_area );
+  exit(0);
+}
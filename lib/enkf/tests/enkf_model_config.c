@@ -22,6 +22,7 @@
 
 #include <ert/util/test_util.h>
 
+#include <ert/enkf/enkf_defaults.h>
 #include <ert/enkf/model_config.h>
 
 
@@ -64,6 +65,42 @@ void test_data_root( ) {
 }
 
 
+void test_summary_store( ) {
+  model_config_type * model_config = model_config_alloc_empty();
+  test_assert_false( model_config_get_summary_store( model_config ));
+  test_assert_int_equal( DEFAULT_SUMMARY_STORE_MAX_PENDING_MB , model_config_get_summary_store_max_pending( model_config ));
+
+  model_config_set_summary_store( model_config , true , 64 );
+  test_assert_true( model_config_get_summary_store( model_config ));
+  test_assert_int_equal( 64 , model_config_get_summary_store_max_pending( model_config ));
+  model_config_free( model_config );
+}
+
+
+void test_fsync_policy( ) {
+  model_config_type * model_config = model_config_alloc_empty();
+  test_assert_int_equal( DEFAULT_BLOCK_FS_FSYNC_INTERVAL , model_config_get_fsync_interval( model_config ));
+  test_assert_int_equal( DEFAULT_BLOCK_FS_FSYNC_MB , model_config_get_fsync_mb( model_config ));
+  test_assert_double_equal( DEFAULT_BLOCK_FS_FSYNC_SECONDS , model_config_get_fsync_seconds( model_config ));
+
+  model_config_set_fsync_policy( model_config , 0 , 16 , 2.5 );
+  test_assert_int_equal( 0 , model_config_get_fsync_interval( model_config ));
+  test_assert_int_equal( 16 , model_config_get_fsync_mb( model_config ));
+  test_assert_double_equal( 2.5 , model_config_get_fsync_seconds( model_config ));
+  model_config_free( model_config );
+}
+
+
+void test_codec( ) {
+  model_config_type * model_config = model_config_alloc_empty();
+  test_assert_int_equal( DEFAULT_BLOCK_FS_CODEC , model_config_get_codec( model_config ));
+
+  model_config_set_codec( model_config , BLOCK_FS_CODEC_SHUFFLE_RLE );
+  test_assert_int_equal( BLOCK_FS_CODEC_SHUFFLE_RLE , model_config_get_codec( model_config ));
+  model_config_free( model_config );
+}
+
+
 void test_export_file( ) {
   model_config_type * model_config = model_config_alloc_empty();
   
@@ -75,6 +112,9 @@ int main(int argc , char ** argv) {
   test_runpath( );
   test_data_root( );
   test_export_file( );
+  test_summary_store( );
+  test_fsync_policy( );
+  test_codec( );
   exit(0);
 }
 
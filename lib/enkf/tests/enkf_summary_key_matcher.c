@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_summary_key_matcher.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/ecl_smspec.h>
+#include <ert/ecl/smspec_node.h>
+
+#include <ert/enkf/summary_key_matcher.h>
+
+
+static bool fnmatch_any( const stringlist_type * patterns , const char * key ) {
+  for (int i = 0; i < stringlist_get_size( patterns ); i++)
+    if (util_fnmatch( stringlist_iget( patterns , i ) , key ) == 0)
+      return true;
+  return false;
+}
+
+
+void test_match( ) {
+  const char * pattern_list[] = { "FOPT" , "WOPR:*" , "W?CT:OP_1" , "G[OW]PR:*" , "BPR:1,1,[1-3]" , "WBHP:OP\\_2" , "A[1]" };
+  const char * key_list[] = { "FOPT" , "FOPR" , "WOPR:OP_1" , "WOPR" , "WWCT:OP_1" , "WGCT:OP_1" , "WWCT:OP_2" ,
+                              "GOPR:FIELD" , "GWPR:G1" , "GGPR:G1" , "BPR:1,1,2" , "BPR:1,1,4" , "WBHP:OP_2" ,
+                              "A[1]" , "A1" , "" };
+  const int num_patterns = sizeof pattern_list / sizeof pattern_list[0];
+  const int num_keys = sizeof key_list / sizeof key_list[0];
+  summary_key_matcher_type * matcher = summary_key_matcher_alloc( );
+  stringlist_type * patterns = stringlist_alloc_new( );
+
+  for (int i = 0; i < num_patterns; i++) {
+    summary_key_matcher_add_summary_key( matcher , pattern_list[i] );
+    stringlist_append_copy( patterns , pattern_list[i] );
+
+    for (int j = 0; j < num_keys; j++)
+      test_assert_bool_equal( fnmatch_any( patterns , key_list[j] ) ,
+                              summary_key_matcher_match_summary_key( matcher , key_list[j] ));
+  }
+
+  test_assert_true( summary_key_matcher_summary_key_is_required( matcher , "FOPT" ));
+  test_assert_false( summary_key_matcher_summary_key_is_required( matcher , "WOPR:*" ));
+
+  summary_key_matcher_add_summary_key( matcher , "*" );
+  for (int j = 0; j < num_keys; j++)
+    test_assert_true( summary_key_matcher_match_summary_key( matcher , key_list[j] ));
+
+  stringlist_free( patterns );
+  summary_key_matcher_free( matcher );
+}
+
+
+static ecl_sum_type * alloc_sum( int num_wells , const char * extra_key ) {
+  ecl_sum_type * ecl_sum = ecl_sum_alloc_writer( "CASE" , false , true , ":" , 0 , true , 10 , 10 , 10 );
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL , 0 , "SM3" , 0 );
+  ecl_sum_add_var( ecl_sum , "FOPR" , NULL , 0 , "SM3/DAY" , 0 );
+  for (int i = 0; i < num_wells; i++) {
+    char * well = util_alloc_sprintf( "OP_%d" , i );
+    ecl_sum_add_var( ecl_sum , "WOPR" , well , 0 , "SM3/DAY" , 0 );
+    ecl_sum_add_var( ecl_sum , "WWCT" , well , 0 , "" , 0 );
+    free( well );
+  }
+  if (extra_key)
+    ecl_sum_add_var( ecl_sum , extra_key , NULL , 0 , "SM3" , 0 );
+  return ecl_sum;
+}
+
+
+static int_vector_type * alloc_match_index( const summary_key_matcher_type * matcher , const ecl_smspec_type * smspec ) {
+  int_vector_type * match_index = int_vector_alloc( 0 , 0 );
+  for (int i = 0; i < ecl_smspec_num_nodes( smspec ); i++) {
+    const smspec_node_type * smspec_node = ecl_smspec_iget_node( smspec , i );
+    if (smspec_node_is_valid( smspec_node ) && summary_key_matcher_match_summary_key( matcher , smspec_node_get_gen_key1( smspec_node )))
+      int_vector_append( match_index , i );
+  }
+  return match_index;
+}
+
+
+static void assert_match_index( const summary_key_matcher_type * matcher , const ecl_sum_type * ecl_sum ) {
+  const ecl_smspec_type * smspec = ecl_sum_get_smspec( ecl_sum );
+  int_vector_type * expected = alloc_match_index( matcher , smspec );
+  int_vector_type * index    = summary_key_matcher_alloc_match_index( matcher , smspec );
+
+  test_assert_true( int_vector_equal( expected , index ));
+
+  int_vector_free( index );
+  int_vector_free( expected );
+}
+
+
+void test_layout_cache( ) {
+  summary_key_matcher_type * matcher = summary_key_matcher_alloc( );
+  ecl_sum_type * sum1 = alloc_sum( 100 , NULL );
+  ecl_sum_type * sum2 = alloc_sum( 100 , NULL );
+  ecl_sum_type * sum3 = alloc_sum( 100 , "FGPT" );
+  ecl_sum_type * sum4 = alloc_sum( 50 , NULL );
+
+  summary_key_matcher_add_summary_key( matcher , "FOPT" );
+  summary_key_matcher_add_summary_key( matcher , "WOPR:OP_1*" );
+
+  assert_match_index( matcher , sum1 );
+  assert_match_index( matcher , sum2 );
+  assert_match_index( matcher , sum3 );
+  assert_match_index( matcher , sum4 );
+  assert_match_index( matcher , sum1 );
+
+  /* Adding a key must invalidate the cached results. */
+  summary_key_matcher_add_summary_key( matcher , "F*" );
+  assert_match_index( matcher , sum3 );
+  assert_match_index( matcher , sum1 );
+
+  ecl_sum_free( sum4 );
+  ecl_sum_free( sum3 );
+  ecl_sum_free( sum2 );
+  ecl_sum_free( sum1 );
+  summary_key_matcher_free( matcher );
+}
+
+
+int main(int argc , char ** argv) {
+  test_match( );
+  test_layout_cache( );
+  exit(0);
+}
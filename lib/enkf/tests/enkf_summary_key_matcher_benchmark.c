@@ -0,0 +1,119 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_summary_key_matcher_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Matching the SUMMARY keys against the nodes of a large smspec, once
+  key by key as the loader did before and once through the layout
+  cache in summary_key_matcher. The benchmark is not part of the test
+  suite, run it manually as:
+
+     enkf_summary_key_matcher_benchmark [num_wells] [num_real]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/ecl_smspec.h>
+#include <ert/ecl/smspec_node.h>
+
+#include <ert/enkf/summary_key_matcher.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static ecl_sum_type * alloc_sum( int num_wells ) {
+  ecl_sum_type * ecl_sum = ecl_sum_alloc_writer( "CASE" , false , true , ":" , 0 , true , 10 , 10 , 10 );
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL , 0 , "SM3" , 0 );
+  ecl_sum_add_var( ecl_sum , "FOPR" , NULL , 0 , "SM3/DAY" , 0 );
+  for (int i = 0; i < num_wells; i++) {
+    char * well = util_alloc_sprintf( "OP_%d" , i );
+    ecl_sum_add_var( ecl_sum , "WOPR" , well , 0 , "SM3/DAY" , 0 );
+    ecl_sum_add_var( ecl_sum , "WWCT" , well , 0 , "" , 0 );
+    free( well );
+  }
+  return ecl_sum;
+}
+
+
+static int_vector_type * alloc_match_index( const summary_key_matcher_type * matcher , const ecl_smspec_type * smspec ) {
+  int_vector_type * match_index = int_vector_alloc( 0 , 0 );
+  for (int i = 0; i < ecl_smspec_num_nodes( smspec ); i++) {
+    const smspec_node_type * smspec_node = ecl_smspec_iget_node( smspec , i );
+    if (smspec_node_is_valid( smspec_node ) && summary_key_matcher_match_summary_key( matcher , smspec_node_get_gen_key1( smspec_node )))
+      int_vector_append( match_index , i );
+  }
+  return match_index;
+}
+
+
+int main(int argc , char ** argv) {
+  const int num_wells = int_arg( argc , argv , 1 , 10000 );
+  const int num_real  = int_arg( argc , argv , 2 , 20 );
+  summary_key_matcher_type * matcher = summary_key_matcher_alloc( );
+  ecl_sum_type * ecl_sum = alloc_sum( num_wells );
+  const ecl_smspec_type * smspec = ecl_sum_get_smspec( ecl_sum );
+  double key_time , cache_time;
+
+  summary_key_matcher_add_summary_key( matcher , "FOPT" );
+  summary_key_matcher_add_summary_key( matcher , "WOPR:OP_1*" );
+  summary_key_matcher_add_summary_key( matcher , "F*" );
+
+  {
+    double start = wall_clock( );
+    for (int iens = 0; iens < num_real; iens++) {
+      int_vector_type * index = alloc_match_index( matcher , smspec );
+      int_vector_free( index );
+    }
+    key_time = wall_clock( ) - start;
+  }
+
+  {
+    double start = wall_clock( );
+    for (int iens = 0; iens < num_real; iens++) {
+      int_vector_type * index = summary_key_matcher_alloc_match_index( matcher , smspec );
+      int_vector_free( index );
+    }
+    cache_time = wall_clock( ) - start;
+  }
+
+  printf("Matching %d keys for %d realizations: per key: %.3f s  cached layout: %.3f s\n" ,
+         ecl_smspec_num_nodes( smspec ) , num_real , key_time , cache_time );
+
+  ecl_sum_free( ecl_sum );
+  summary_key_matcher_free( matcher );
+  exit(0);
+}
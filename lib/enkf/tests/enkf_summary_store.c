@@ -0,0 +1,219 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_summary_store.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/buffer.h>
+#include <ert/util/double_vector.h>
+
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/summary_store.h>
+#include <ert/enkf/summary_table.h>
+
+#define ENS_SIZE   50
+#define NUM_KEYS   20
+#define TIME_SIZE 200
+
+
+static double test_value( int ikey , int iens , int step ) {
+  return ikey * 1000000 + iens * 1000 + step;
+}
+
+
+static void fill_vector( double_vector_type * vector , int ikey , int iens ) {
+  double_vector_reset( vector );
+  for (int step = 0; step < TIME_SIZE; step++)
+    double_vector_iset( vector , step , test_value( ikey , iens , step ));
+}
+
+
+static void fill_case( enkf_fs_type * fs ) {
+  summary_store_type * store = enkf_fs_get_summary_store( fs );
+  double_vector_type * vector = double_vector_alloc( 0 , 0 );
+  buffer_type * buffer = buffer_alloc( 1024 );
+
+  for (int iens = 0; iens < ENS_SIZE; iens++) {
+    for (int ikey = 0; ikey < NUM_KEYS; ikey++) {
+      char * key = util_alloc_sprintf( "KEY%d" , ikey );
+      fill_vector( vector , ikey , iens );
+
+      buffer_clear( buffer );
+      buffer_fwrite( buffer , double_vector_get_ptr( vector ) , sizeof(double) , TIME_SIZE );
+      enkf_fs_fwrite_vector( fs , buffer , key , DYNAMIC_RESULT , iens );
+      summary_store_set_vector( store , key , iens , vector );
+      free( key );
+    }
+  }
+  enkf_fs_fsync( fs );
+
+  buffer_free( buffer );
+  double_vector_free( vector );
+}
+
+
+/*
+  Reading all the realizations for all the keys, i.e. what the
+  plotting code does, from the ordinary per realization storage and
+  from the columnar summary store should give the same values.
+*/
+
+static void compare_storage( enkf_fs_type * fs ) {
+  summary_store_type * store = enkf_fs_get_summary_store( fs );
+  double_vector_type * vector = double_vector_alloc( 0 , 0 );
+  buffer_type * buffer = buffer_alloc( 1024 );
+
+  for (int ikey = 0; ikey < NUM_KEYS; ikey++) {
+    char * key = util_alloc_sprintf( "KEY%d" , ikey );
+    summary_table_type * table = summary_store_alloc_table( store , key );
+    for (int iens = 0; iens < ENS_SIZE; iens++) {
+      enkf_fs_fread_vector( fs , buffer , key , DYNAMIC_RESULT , iens );
+      double_vector_resize( vector , TIME_SIZE );
+      buffer_fread( buffer , double_vector_get_ptr( vector ) , sizeof(double) , TIME_SIZE );
+      for (int step = 0; step < TIME_SIZE; step++) {
+        test_assert_double_equal( test_value( ikey , iens , step ) , double_vector_iget( vector , step ));
+        test_assert_double_equal( test_value( ikey , iens , step ) , summary_table_iget( table , iens , step ));
+      }
+    }
+    summary_table_free( table );
+    free( key );
+  }
+
+  buffer_free( buffer );
+  double_vector_free( vector );
+}
+
+
+typedef struct {
+  summary_store_type * store;
+  int                  iens1;
+  int                  iens2;
+} fill_job_type;
+
+
+static void * fill_store_mt( void * arg ) {
+  fill_job_type * job = (fill_job_type *) arg;
+  double_vector_type * vector = double_vector_alloc( 0 , 0 );
+
+  for (int iens = job->iens1; iens < job->iens2; iens++) {
+    for (int ikey = 0; ikey < NUM_KEYS; ikey++) {
+      char * key = util_alloc_sprintf( "KEY%d" , ikey );
+      fill_vector( vector , ikey , iens );
+      summary_store_set_vector( job->store , key , iens , vector );
+      free( key );
+    }
+  }
+  double_vector_free( vector );
+  return NULL;
+}
+
+
+/*
+  Several threads add realizations concurrently, with a pending memory
+  limit so small that the tables are written out on every update.
+*/
+
+void test_bounded_pending() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_summary_store_pending");
+  {
+    const int num_threads = 5;
+    enkf_fs_type * fs = enkf_fs_create_fs( "mnt" , BLOCK_FS_DRIVER_ID , NULL , true );
+    summary_store_type * store;
+    pthread_t threads[num_threads];
+    fill_job_type jobs[num_threads];
+
+    test_assert_true( enkf_fs_enable_summary_store( fs ));
+    store = enkf_fs_get_summary_store( fs );
+    summary_store_set_max_pending( store , 1 );
+    test_assert_size_t_equal( 1 , summary_store_get_max_pending( store ));
+
+    for (int i = 0; i < num_threads; i++) {
+      jobs[i].store = store;
+      jobs[i].iens1 = i * ENS_SIZE / num_threads;
+      jobs[i].iens2 = (i + 1) * ENS_SIZE / num_threads;
+      pthread_create( &threads[i] , NULL , fill_store_mt , &jobs[i] );
+    }
+    for (int i = 0; i < num_threads; i++)
+      pthread_join( threads[i] , NULL );
+
+    for (int ikey = 0; ikey < NUM_KEYS; ikey++) {
+      char * key = util_alloc_sprintf( "KEY%d" , ikey );
+      summary_table_type * table = summary_store_alloc_table( store , key );
+      test_assert_int_equal( ENS_SIZE , summary_table_get_ens_size( table ));
+      for (int iens = 0; iens < ENS_SIZE; iens++)
+        test_assert_double_equal( test_value( ikey , iens , TIME_SIZE - 1 ) , summary_table_iget( table , iens , TIME_SIZE - 1));
+      summary_table_free( table );
+      free( key );
+    }
+    enkf_fs_decref( fs );
+  }
+  test_work_area_free( work_area );
+}
+
+
+void test_store() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_summary_store");
+  {
+    enkf_fs_type * fs = enkf_fs_create_fs( "mnt" , BLOCK_FS_DRIVER_ID , NULL , true );
+    test_assert_NULL( enkf_fs_get_summary_store( fs ));
+    test_assert_true( enkf_fs_enable_summary_store( fs ));
+    test_assert_true( summary_store_is_instance( enkf_fs_get_summary_store( fs )));
+    fill_case( fs );
+    enkf_fs_decref( fs );
+  }
+  {
+    enkf_fs_type * fs = enkf_fs_mount( "mnt" );
+    summary_store_type * store = enkf_fs_get_summary_store( fs );
+
+    test_assert_true( summary_store_is_instance( store ));
+    test_assert_true( summary_store_has_key( store , "KEY0" ));
+    test_assert_false( summary_store_has_key( store , "NO_SUCH_KEY" ));
+    test_assert_NULL( summary_store_alloc_table( store , "NO_SUCH_KEY" ));
+
+    {
+      summary_table_type * slice = summary_store_alloc_time_slice( store , "KEY7" , 100 , 110 );
+      test_assert_int_equal( ENS_SIZE , summary_table_get_ens_size( slice ));
+      test_assert_int_equal( 10 , summary_table_get_time_size( slice ));
+      for (int iens = 0; iens < ENS_SIZE; iens++)
+        for (int step = 0; step < 10; step++) {
+          test_assert_true( summary_table_iget_active( slice , iens , step ));
+          test_assert_double_equal( test_value( 7 , iens , 100 + step ) , summary_table_iget( slice , iens , step ));
+        }
+      summary_table_free( slice );
+    }
+
+    {
+      summary_table_type * slice = summary_store_alloc_time_slice( store , "KEY7" , TIME_SIZE - 5 , 2 * TIME_SIZE );
+      test_assert_int_equal( 5 , summary_table_get_time_size( slice ));
+      summary_table_free( slice );
+    }
+
+    compare_storage( fs );
+    enkf_fs_decref( fs );
+  }
+  test_work_area_free( work_area );
+}
+
+
+int main(int argc , char ** argv) {
+  test_store();
+  test_bounded_pending();
+  exit(0);
+}
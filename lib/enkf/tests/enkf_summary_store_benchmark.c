@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_summary_store_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Benchmark of the key wise ensemble read done by the plotting and
+  export code: every realization of every key is read, once from the
+  ordinary per realization vector storage and once from the columnar
+  summary store. The benchmark is not part of the test suite, run it
+  manually as:
+
+     enkf_summary_store_benchmark [ens_size] [num_keys] [time_size]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ert/util/buffer.h>
+#include <ert/util/util.h>
+#include <ert/util/double_vector.h>
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/summary_store.h>
+#include <ert/enkf/summary_table.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static void fill_case( enkf_fs_type * fs , int ens_size , int num_keys , int time_size ) {
+  summary_store_type * store = enkf_fs_get_summary_store( fs );
+  double_vector_type * vector = double_vector_alloc( 0 , 0 );
+  buffer_type * buffer = buffer_alloc( 1024 );
+
+  for (int iens = 0; iens < ens_size; iens++) {
+    for (int ikey = 0; ikey < num_keys; ikey++) {
+      char * key = util_alloc_sprintf( "KEY%d" , ikey );
+      double_vector_reset( vector );
+      for (int step = 0; step < time_size; step++)
+        double_vector_iset( vector , step , ikey + iens * 1000 + step );
+
+      buffer_clear( buffer );
+      buffer_fwrite( buffer , double_vector_get_ptr( vector ) , sizeof(double) , time_size );
+      enkf_fs_fwrite_vector( fs , buffer , key , DYNAMIC_RESULT , iens );
+      summary_store_set_vector( store , key , iens , vector );
+      free( key );
+    }
+  }
+  enkf_fs_fsync( fs );
+
+  buffer_free( buffer );
+  double_vector_free( vector );
+}
+
+
+static double read_vectors( enkf_fs_type * fs , int ens_size , int num_keys , int time_size ) {
+  double_vector_type * vector = double_vector_alloc( 0 , 0 );
+  buffer_type * buffer = buffer_alloc( 1024 );
+  double start = wall_clock( );
+
+  for (int ikey = 0; ikey < num_keys; ikey++) {
+    char * key = util_alloc_sprintf( "KEY%d" , ikey );
+    for (int iens = 0; iens < ens_size; iens++) {
+      enkf_fs_fread_vector( fs , buffer , key , DYNAMIC_RESULT , iens );
+      double_vector_resize( vector , time_size );
+      buffer_fread( buffer , double_vector_get_ptr( vector ) , sizeof(double) , time_size );
+    }
+    free( key );
+  }
+
+  buffer_free( buffer );
+  double_vector_free( vector );
+  return wall_clock( ) - start;
+}
+
+
+static double read_store( enkf_fs_type * fs , int num_keys ) {
+  summary_store_type * store = enkf_fs_get_summary_store( fs );
+  double start = wall_clock( );
+
+  for (int ikey = 0; ikey < num_keys; ikey++) {
+    char * key = util_alloc_sprintf( "KEY%d" , ikey );
+    summary_table_type * table = summary_store_alloc_table( store , key );
+    summary_table_free( table );
+    free( key );
+  }
+  return wall_clock( ) - start;
+}
+
+
+int main( int argc , char ** argv ) {
+  int ens_size  = int_arg( argc , argv , 1 , 100 );
+  int num_keys  = int_arg( argc , argv , 2 , 100 );
+  int time_size = int_arg( argc , argv , 3 , 500 );
+  test_work_area_type * work_area = test_work_area_alloc( "enkf_fs/summary_store_benchmark" );
+
+  {
+    enkf_fs_type * fs = enkf_fs_create_fs( "mnt" , BLOCK_FS_DRIVER_ID , NULL , true );
+    test_assert_true( enkf_fs_enable_summary_store( fs ));
+    fill_case( fs , ens_size , num_keys , time_size );
+    enkf_fs_decref( fs );
+  }
+  {
+    enkf_fs_type * fs = enkf_fs_mount( "mnt" );
+    double vector_time = read_vectors( fs , ens_size , num_keys , time_size );
+    double store_time = read_store( fs , num_keys );
+
+    printf("Reading %d keys x %d realizations x %d steps: per realization: %8.4f s  columnar: %8.4f s\n",
+           num_keys , ens_size , time_size , vector_time , store_time);
+    enkf_fs_decref( fs );
+  }
+
+  test_work_area_free( work_area );
+  exit(0);
+}
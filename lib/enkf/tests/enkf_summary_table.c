@@ -0,0 +1,97 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_summary_table.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/buffer.h>
+#include <ert/util/double_vector.h>
+
+#include <ert/enkf/summary_table.h>
+
+
+void test_set_get() {
+  summary_table_type * table = summary_table_alloc( 0 , 0 );
+  double_vector_type * v1 = double_vector_alloc( 0 , 0 );
+  double_vector_type * v2 = double_vector_alloc( 0 , 0 );
+  double_vector_type * result = double_vector_alloc( 0 , 0 );
+
+  test_assert_true( summary_table_is_instance( table ));
+  for (int i = 0; i < 10; i++)
+    double_vector_iset( v1 , i , i );
+  double_vector_iset( v1 , 5 , -9999 );
+
+  for (int i = 0; i < 5; i++)
+    double_vector_iset( v2 , i , 100 + i );
+
+  summary_table_set_vector( table , 3 , v1 );
+  summary_table_set_vector( table , 1 , v2 );
+
+  test_assert_int_equal( 4 , summary_table_get_ens_size( table ));
+  test_assert_int_equal( 10 , summary_table_get_time_size( table ));
+  test_assert_false( summary_table_has_realization( table , 0 ));
+  test_assert_true( summary_table_has_realization( table , 1 ));
+  test_assert_true( summary_table_has_realization( table , 3 ));
+  test_assert_false( summary_table_has_realization( table , 10 ));
+
+  test_assert_true( summary_table_iget_active( table , 3 , 4 ));
+  test_assert_false( summary_table_iget_active( table , 3 , 5 ));
+  test_assert_false( summary_table_iget_active( table , 1 , 5 ));
+  test_assert_double_equal( 104 , summary_table_iget( table , 1 , 4 ));
+
+  test_assert_false( summary_table_get_vector( table , 0 , result ));
+  test_assert_true( summary_table_get_vector( table , 3 , result ));
+  test_assert_true( double_vector_equal( v1 , result ));
+  test_assert_true( summary_table_get_vector( table , 1 , result ));
+  test_assert_true( double_vector_equal( v2 , result ));
+
+  {
+    summary_table_type * slice = summary_table_alloc_copy( table , 2 , 7 );
+    test_assert_int_equal( 4 , summary_table_get_ens_size( slice ));
+    test_assert_int_equal( 5 , summary_table_get_time_size( slice ));
+    test_assert_double_equal( 6 , summary_table_iget( slice , 3 , 4 ));
+    test_assert_false( summary_table_iget_active( slice , 1 , 4 ));
+    summary_table_free( slice );
+  }
+
+  {
+    buffer_type * buffer = buffer_alloc( 100 );
+    summary_table_type * copy;
+
+    summary_table_fwrite_buffer( table , buffer );
+    buffer_rewind( buffer );
+    copy = summary_table_alloc_from_buffer( buffer );
+    test_assert_true( summary_table_get_vector( copy , 3 , result ));
+    test_assert_true( double_vector_equal( v1 , result ));
+    test_assert_false( summary_table_has_realization( copy , 2 ));
+
+    summary_table_free( copy );
+    buffer_free( buffer );
+  }
+
+  double_vector_free( result );
+  double_vector_free( v2 );
+  double_vector_free( v1 );
+  summary_table_free( table );
+}
+
+
+int main(int argc , char ** argv) {
+  test_set_get();
+  exit(0);
+}
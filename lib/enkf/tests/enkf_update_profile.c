@@ -0,0 +1,118 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'enkf_update_profile.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/buffer.h>
+#include <ert/util/util.h>
+
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/update_profile.h>
+
+
+/* With a NULL profile all the functions should be noops. */
+
+void test_disabled( ) {
+  update_phase_type * phase = update_profile_start_phase( NULL , NULL , "MINISTEP" , NULL , "measure" );
+  test_assert_NULL( phase );
+  update_phase_set_dims( phase , 10 , 10 );
+  update_phase_stop( phase , NULL );
+  update_profile_fwrite_json( NULL , "profile.json" );
+  update_profile_free( NULL );
+  test_assert_false( util_file_exists( "profile.json" ));
+}
+
+
+void test_phases( ) {
+  test_work_area_type * work_area = test_work_area_alloc("update_profile");
+  enkf_fs_type * fs = enkf_fs_create_fs( "mnt" , BLOCK_FS_DRIVER_ID , NULL , true);
+  update_profile_type * profile = update_profile_alloc( "default" , 0 , 10 );
+
+  test_assert_true( update_profile_is_instance( profile ));
+  {
+    update_phase_type * phase = update_profile_start_phase( profile , NULL , "MINISTEP" , NULL , "allocS" );
+    update_phase_set_dims( phase , 100 , 50 );
+    usleep( 10000 );
+    update_phase_stop( phase , NULL );
+  }
+  {
+    update_phase_type * phase = update_profile_start_phase( profile , fs , "MINISTEP" , "DATA\"SET" , "deserialize" );
+    buffer_type * buffer = buffer_alloc( 100 );
+    for (int i = 0; i < 1000; i++)
+      buffer_fwrite_double( buffer , i );
+
+    enkf_fs_fwrite_node( fs , buffer , "PARAM" , PARAMETER , 0 , 0 );
+    enkf_fs_fwrite_node( fs , buffer , "PARAM" , PARAMETER , 0 , 1 );
+    buffer_free( buffer );
+    update_phase_stop( phase , fs );
+  }
+
+  test_assert_int_equal( 2 , update_profile_get_num_phases( profile ));
+  {
+    const update_phase_type * phase = update_profile_iget_phase( profile , 0 );
+    test_assert_string_equal( "allocS" , update_phase_get_name( phase ));
+    test_assert_string_equal( "MINISTEP" , update_phase_get_ministep( phase ));
+    test_assert_NULL( update_phase_get_dataset( phase ));
+    test_assert_int_equal( 100 , update_phase_get_rows( phase ));
+    test_assert_int_equal( 50 , update_phase_get_columns( phase ));
+    test_assert_true( update_phase_get_wall_time( phase ) >= 0.01 );
+    test_assert_true( update_phase_get_cpu_time( phase ) >= 0 );
+    test_assert_long_equal( 0 , update_phase_get_bytes_written( phase ));
+  }
+  {
+    const update_phase_type * phase = update_profile_iget_phase( profile , 1 );
+    test_assert_int_equal( -1 , update_phase_get_rows( phase ));
+    test_assert_long_equal( 2 * 1000 * sizeof(double) , update_phase_get_bytes_written( phase ));
+    test_assert_long_equal( 0 , update_phase_get_bytes_read( phase ));
+  }
+
+  update_profile_fwrite_json( profile , "log/0010.json" );
+  test_assert_true( util_file_exists( "log/0010.json" ));
+  {
+    FILE * stream = util_fopen( "log/0010.json" , "r");
+    char line[1024];
+    int num_phases = 0;
+    bool escaped = false;
+
+    while (fgets( line , sizeof line , stream )) {
+      if (strstr( line , "\"name\" : "))
+        num_phases++;
+      if (strstr( line , "\"dataset\" : \"DATA\\\"SET\""))
+        escaped = true;
+    }
+    fclose( stream );
+
+    test_assert_int_equal( 2 , num_phases );
+    test_assert_true( escaped );
+  }
+
+  update_profile_free( profile );
+  enkf_fs_decref( fs );
+  test_work_area_free( work_area );
+}
+
+
+int main(int argc , char ** argv) {
+  test_disabled( );
+  test_phases( );
+  exit(0);
+}
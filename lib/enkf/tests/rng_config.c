@@ -134,8 +134,41 @@ void test_reproducibility(char * random_seed)
   test_assert_int_equal(rng_get_int(orig_rng_100, MAX_INT), rng_get_int(rep_rng_100, MAX_INT));
 }
 
+void test_engine()
+{
+  test_work_area_type * work_area = test_work_area_alloc("rng_config");
+  res_log_init_log(LOG_DEBUG, "log", true);
+  {
+    const char * config_file = "my_rng_config";
+    create_config(config_file, "42");
+    rng_config_type * rng_config = rng_config_alloc_load_user_config(config_file);
+    test_assert_int_equal(RNG_ENGINE_MZRAN, rng_config_get_engine(rng_config));
+    rng_config_free(rng_config);
+  }
+  {
+    const char * config_file = "counter_rng_config";
+    FILE * stream;
+    create_config(config_file, "42");
+    stream = util_fopen(config_file, "a");
+    fprintf(stream, "RANDOM_ENGINE COUNTER\n");
+    fclose(stream);
+    {
+      rng_config_type * rng_config = rng_config_alloc_load_user_config(config_file);
+      rng_manager_type * rng_manager;
+      test_assert_int_equal(RNG_ENGINE_COUNTER, rng_config_get_engine(rng_config));
+
+      rng_manager = rng_config_alloc_rng_manager(rng_config);
+      test_assert_not_NULL(rng_manager_get_counter_rng(rng_manager));
+      rng_manager_free(rng_manager);
+      rng_config_free(rng_config);
+    }
+  }
+  test_work_area_free(work_area);
+}
+
 int main(int argc , char ** argv) {
   test_init();
+  test_engine();
   test_reproducibility(NULL); // Random seed
   test_reproducibility("42");
   test_reproducibility("423543854372895743289507289532");
@@ -177,8 +177,42 @@ static void test_alloc() {
 }
 
 
+/*
+  With the counter engine the rng for realization i only depends on
+  the seed and i, and not on the order the rng's are requested.
+*/
+
+static void test_counter() {
+  const char * random_seed = "apekatterbesting";
+  rng_manager_type * rng_man0 = rng_manager_alloc(random_seed);
+  rng_manager_type * rng_man1 = rng_manager_alloc(random_seed);
+
+  test_assert_NULL(rng_manager_get_counter_rng(rng_man0));
+  rng_manager_enable_counter_rng(rng_man0);
+  rng_manager_enable_counter_rng(rng_man1);
+  test_assert_true(counter_rng_is_instance(rng_manager_get_counter_rng(rng_man0)));
+
+  {
+    rng_type * rng0_0   = rng_manager_iget(rng_man0, 0);
+    rng_type * rng0_100 = rng_manager_iget(rng_man0, 100);
+
+    rng_type * rng1_100 = rng_manager_iget(rng_man1, 100);
+    rng_type * rng1_0   = rng_manager_iget(rng_man1, 0);
+
+    test_assert_int_equal(rng_get_int(rng0_0, MAX_INT), rng_get_int(rng1_0, MAX_INT));
+    test_assert_int_equal(rng_get_int(rng0_100, MAX_INT), rng_get_int(rng1_100, MAX_INT));
+  }
+  test_assert_double_equal(counter_rng_std_normal(rng_manager_get_counter_rng(rng_man0), RNG_STREAM_OBS_PERTURBATION, 3, 17),
+                           counter_rng_std_normal(rng_manager_get_counter_rng(rng_man1), RNG_STREAM_OBS_PERTURBATION, 3, 17));
+
+  rng_manager_free(rng_man0);
+  rng_manager_free(rng_man1);
+}
+
+
 int main(int argc , char ** argv) {
   test_alloc();
+  test_counter();
   test_create();
   test_default();
   test_state();
@@ -0,0 +1,299 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'update_profile.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/vector.h>
+
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/update_profile.h>
+
+/**
+   The update_profile records the wall time, the cpu time, the number
+   of bytes read and written through enkf_fs and the matrix dimensions
+   for the different phases of one analysis update; the result is
+   written as a json report next to the update log.
+
+   All the functions accept a NULL profile / phase and then do
+   nothing; that way the update code can be instrumented
+   unconditionally, and when profiling is not enabled the overhead is
+   one pointer comparison per phase.
+
+   When the ministeps are updated concurrently the phases of different
+   ministeps overlap in time; the cpu time and the enkf_fs byte counts
+   are for the whole process and will then include the work of the
+   other ministeps.
+*/
+
+#define UPDATE_PROFILE_TYPE_ID 771623095
+
+struct update_phase_struct {
+  char   * name;
+  char   * ministep;
+  char   * dataset;
+  double   start_time;      /* Wall time in seconds since the profile was allocated. */
+  double   wall_time;
+  double   cpu_time;
+  long     bytes_read;
+  long     bytes_written;
+  int      rows;
+  int      columns;
+};
+
+
+struct update_profile_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char            * case_name;
+  int               step1;
+  int               step2;
+  double            start_time;
+  vector_type     * phases;
+  pthread_mutex_t   lock;
+};
+
+
+static double update_profile_wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static double update_profile_cpu_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_PROCESS_CPUTIME_ID , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static void update_phase_free( update_phase_type * phase ) {
+  free( phase->name );
+  util_safe_free( phase->ministep );
+  util_safe_free( phase->dataset );
+  free( phase );
+}
+
+
+static void update_phase_free__( void * arg ) {
+  update_phase_free( (update_phase_type *) arg );
+}
+
+
+UTIL_IS_INSTANCE_FUNCTION( update_profile , UPDATE_PROFILE_TYPE_ID )
+
+
+update_profile_type * update_profile_alloc( const char * case_name , int step1 , int step2 ) {
+  update_profile_type * profile = util_malloc( sizeof * profile );
+  UTIL_TYPE_ID_INIT( profile , UPDATE_PROFILE_TYPE_ID );
+  profile->case_name  = util_alloc_string_copy( case_name );
+  profile->step1      = step1;
+  profile->step2      = step2;
+  profile->start_time = update_profile_wall_clock( );
+  profile->phases     = vector_alloc_new( );
+  pthread_mutex_init( &profile->lock , NULL );
+  return profile;
+}
+
+
+void update_profile_free( update_profile_type * profile ) {
+  if (profile == NULL)
+    return;
+
+  pthread_mutex_destroy( &profile->lock );
+  vector_free( profile->phases );
+  util_safe_free( profile->case_name );
+  free( profile );
+}
+
+
+/*
+  Starts the timing of a new phase; the phase is owned by the profile
+  and is completed with update_phase_stop(). The @ministep and
+  @dataset arguments can be NULL for phases which are not specific to
+  one ministep / dataset.
+*/
+
+update_phase_type * update_profile_start_phase( update_profile_type * profile , enkf_fs_type * fs , const char * ministep , const char * dataset , const char * name ) {
+  if (profile == NULL)
+    return NULL;
+  {
+    update_phase_type * phase = util_malloc( sizeof * phase );
+    phase->name          = util_alloc_string_copy( name );
+    phase->ministep      = util_alloc_string_copy( ministep );
+    phase->dataset       = util_alloc_string_copy( dataset );
+    phase->rows          = -1;
+    phase->columns       = -1;
+    phase->bytes_read    = fs ? enkf_fs_get_bytes_read( fs ) : 0;
+    phase->bytes_written = fs ? enkf_fs_get_bytes_written( fs ) : 0;
+    phase->cpu_time      = update_profile_cpu_clock( );
+    phase->wall_time     = update_profile_wall_clock( );
+    phase->start_time    = phase->wall_time - profile->start_time;
+
+    pthread_mutex_lock( &profile->lock );
+    vector_append_owned_ref( profile->phases , phase , update_phase_free__ );
+    pthread_mutex_unlock( &profile->lock );
+    return phase;
+  }
+}
+
+
+void update_phase_stop( update_phase_type * phase , enkf_fs_type * fs ) {
+  if (phase == NULL)
+    return;
+
+  phase->wall_time = update_profile_wall_clock( ) - phase->wall_time;
+  phase->cpu_time  = update_profile_cpu_clock( ) - phase->cpu_time;
+  if (fs) {
+    phase->bytes_read    = enkf_fs_get_bytes_read( fs ) - phase->bytes_read;
+    phase->bytes_written = enkf_fs_get_bytes_written( fs ) - phase->bytes_written;
+  } else {
+    phase->bytes_read    = 0;
+    phase->bytes_written = 0;
+  }
+}
+
+
+void update_phase_set_dims( update_phase_type * phase , int rows , int columns ) {
+  if (phase == NULL)
+    return;
+
+  phase->rows    = rows;
+  phase->columns = columns;
+}
+
+
+int update_profile_get_num_phases( const update_profile_type * profile ) {
+  return vector_get_size( profile->phases );
+}
+
+
+const update_phase_type * update_profile_iget_phase( const update_profile_type * profile , int index ) {
+  return vector_iget_const( profile->phases , index );
+}
+
+
+const char * update_phase_get_name( const update_phase_type * phase ) {
+  return phase->name;
+}
+
+const char * update_phase_get_ministep( const update_phase_type * phase ) {
+  return phase->ministep;
+}
+
+const char * update_phase_get_dataset( const update_phase_type * phase ) {
+  return phase->dataset;
+}
+
+double update_phase_get_wall_time( const update_phase_type * phase ) {
+  return phase->wall_time;
+}
+
+double update_phase_get_cpu_time( const update_phase_type * phase ) {
+  return phase->cpu_time;
+}
+
+long update_phase_get_bytes_read( const update_phase_type * phase ) {
+  return phase->bytes_read;
+}
+
+long update_phase_get_bytes_written( const update_phase_type * phase ) {
+  return phase->bytes_written;
+}
+
+int update_phase_get_rows( const update_phase_type * phase ) {
+  return phase->rows;
+}
+
+int update_phase_get_columns( const update_phase_type * phase ) {
+  return phase->columns;
+}
+
+
+/*****************************************************************/
+
+static void update_profile_fprintf_json_string( const char * string , FILE * stream ) {
+  if (string == NULL) {
+    fprintf( stream , "null" );
+    return;
+  }
+
+  fputc( '"' , stream );
+  for (const char * c = string; *c; c++) {
+    if ((*c == '"') || (*c == '\\'))
+      fprintf( stream , "\\%c" , *c );
+    else if ((unsigned char) *c < 0x20)
+      fprintf( stream , "\\u%04x" , (unsigned char) *c );
+    else
+      fputc( *c , stream );
+  }
+  fputc( '"' , stream );
+}
+
+
+static void update_phase_fprintf_json( const update_phase_type * phase , FILE * stream ) {
+  fprintf( stream , "    {\"name\" : ");
+  update_profile_fprintf_json_string( phase->name , stream );
+  fprintf( stream , ", \"ministep\" : ");
+  update_profile_fprintf_json_string( phase->ministep , stream );
+  fprintf( stream , ", \"dataset\" : ");
+  update_profile_fprintf_json_string( phase->dataset , stream );
+  fprintf( stream , ", \"start\" : %.6f" , phase->start_time );
+  fprintf( stream , ", \"wall_time\" : %.6f" , phase->wall_time );
+  fprintf( stream , ", \"cpu_time\" : %.6f" , phase->cpu_time );
+  fprintf( stream , ", \"bytes_read\" : %ld" , phase->bytes_read );
+  fprintf( stream , ", \"bytes_written\" : %ld" , phase->bytes_written );
+  if (phase->rows >= 0)
+    fprintf( stream , ", \"rows\" : %d, \"columns\" : %d" , phase->rows , phase->columns );
+  fprintf( stream , "}");
+}
+
+
+void update_profile_fprintf_json( const update_profile_type * profile , FILE * stream ) {
+  const int num_phases = vector_get_size( profile->phases );
+
+  fprintf( stream , "{\n");
+  fprintf( stream , "  \"case\" : ");
+  update_profile_fprintf_json_string( profile->case_name , stream );
+  fprintf( stream , ",\n");
+  fprintf( stream , "  \"step1\" : %d,\n" , profile->step1 );
+  fprintf( stream , "  \"step2\" : %d,\n" , profile->step2 );
+  fprintf( stream , "  \"wall_time\" : %.6f,\n" , update_profile_wall_clock( ) - profile->start_time );
+  fprintf( stream , "  \"phases\" : [\n");
+  for (int i = 0; i < num_phases; i++) {
+    update_phase_fprintf_json( vector_iget_const( profile->phases , i ) , stream );
+    fprintf( stream , "%s\n" , (i < (num_phases - 1)) ? "," : "");
+  }
+  fprintf( stream , "  ]\n");
+  fprintf( stream , "}\n");
+}
+
+
+void update_profile_fwrite_json( const update_profile_type * profile , const char * filename ) {
+  if (profile == NULL)
+    return;
+  {
+    FILE * stream = util_mkdir_fopen( filename , "w" );
+    update_profile_fprintf_json( profile , stream );
+    fclose( stream );
+  }
+}
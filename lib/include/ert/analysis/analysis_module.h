@@ -27,6 +27,7 @@ extern "C" {
 #include <ert/util/bool_vector.h>
 
 #include <ert/analysis/module_info.h>
+#include <ert/analysis/obs_covar.h>
 
 /*
    These are option flag values which are used by the core ert code to
@@ -46,16 +47,18 @@ typedef enum {
     ANALYSIS_USE_A      = 4,       // The module will read the content of A - but not modify it.
     ANALYSIS_UPDATE_A   = 8,       // The update will be based on modifying A directly, and not on an X matrix.
     ANALYSIS_SCALE_DATA = 16,
-    ANALYSIS_ITERABLE   = 32       // The module can bu used as an iterative smoother.
+    ANALYSIS_ITERABLE   = 32,      // The module can bu used as an iterative smoother.
+    ANALYSIS_THREAD_SAFE = 64      // The module has no per update state, and can update several ministeps concurrently.
 } analysis_module_flag_enum;
 
 
-#define ANALYSIS_MODULE_FLAG_ENUM_SIZE 5
+#define ANALYSIS_MODULE_FLAG_ENUM_SIZE 6
 #define ANALYSIS_MODULE_FLAG_ENUM_DEFS {.value = ANALYSIS_NEED_ED     , .name = "ANALYSIS_NEED_ED"},\
                                        {.value = ANALYSIS_USE_A       , .name = "ANALYSIS_USE_A"},\
                                        {.value = ANALYSIS_UPDATE_A    , .name = "ANALYSIS_UPDATE_A"},\
                                        {.value = ANALYSIS_SCALE_DATA  , .name = "ANALYSIS_SCALE_DATA"},\
-                                       {.value = ANALYSIS_ITERABLE    , .name = "ANALYSIS_ITERABLE"}
+                                       {.value = ANALYSIS_ITERABLE    , .name = "ANALYSIS_ITERABLE"},\
+                                       {.value = ANALYSIS_THREAD_SAFE , .name = "ANALYSIS_THREAD_SAFE"}
 
 
 #define EXTERNAL_MODULE_NAME "analysis_table"
@@ -111,6 +114,38 @@ typedef enum {
                                                       rng_type * rng);
 
 
+  void analysis_module_initX_covar(analysis_module_type * module ,
+                                   matrix_type * X ,
+                                   matrix_type * A ,
+                                   matrix_type * S ,
+                                   const obs_covar_type * R ,
+                                   matrix_type * dObs ,
+                                   matrix_type * E ,
+                                   matrix_type * D,
+                                   rng_type * rng);
+
+
+  void analysis_module_updateA_covar(analysis_module_type * module ,
+                                     matrix_type * A ,
+                                     matrix_type * S ,
+                                     const obs_covar_type * R ,
+                                     matrix_type * dObs ,
+                                     matrix_type * E ,
+                                     matrix_type * D ,
+                                     const module_info_type* module_info,
+                                     rng_type * rng);
+
+
+  void                   analysis_module_init_update_covar( analysis_module_type * module ,
+                                                            const bool_vector_type * ens_mask ,
+                                                            const matrix_type * S ,
+                                                            const obs_covar_type * R ,
+                                                            const matrix_type * dObs ,
+                                                            const matrix_type * E ,
+                                                            const matrix_type * D,
+                                                            rng_type * rng);
+
+
   const char           * analysis_module_get_lib_name( const analysis_module_type * module);
   bool                   analysis_module_internal( const analysis_module_type * module );
   bool                   analysis_module_set_var( analysis_module_type * module , const char * var_name , const char * string_value );
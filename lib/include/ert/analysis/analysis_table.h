@@ -11,6 +11,7 @@ extern "C" {
 #include <ert/util/bool_vector.h>
 
 #include <ert/analysis/module_info.h>
+#include <ert/analysis/obs_covar.h>
 
 
   typedef void (analysis_updateA_ftype) (void * module_data ,
@@ -52,6 +53,42 @@ extern "C" {
                                              const matrix_type * D,
                                              rng_type * rng);
 
+  /*
+    The same update functions taking the observation error covariance
+    as a structured obs_covar instance instead of a dense matrix.
+  */
+
+  typedef void (analysis_updateA_covar_ftype) (void * module_data ,
+                                               matrix_type * A ,
+                                               matrix_type * S ,
+                                               const obs_covar_type * R ,
+                                               matrix_type * dObs ,
+                                               matrix_type * E ,
+                                               matrix_type * D ,
+                                               const module_info_type* module_info,
+                                               rng_type * rng);
+
+
+  typedef void (analysis_initX_covar_ftype)    (void * module_data ,
+                                                matrix_type * X ,
+                                                matrix_type * A ,
+                                                matrix_type * S ,
+                                                const obs_covar_type * R ,
+                                                matrix_type * dObs ,
+                                                matrix_type * E ,
+                                                matrix_type * D,
+                                                rng_type * rng);
+
+
+  typedef void (analysis_init_update_covar_ftype) (void * module_data,
+                                                   const bool_vector_type * ens_mask ,
+                                                   const matrix_type * S ,
+                                                   const obs_covar_type * R ,
+                                                   const matrix_type * dObs ,
+                                                   const matrix_type * E ,
+                                                   const matrix_type * D,
+                                                   rng_type * rng);
+
   typedef void (analysis_complete_update_ftype) (void * module_data );
 
   typedef long (analysis_get_options_ftype) (void * module_data , long option);
@@ -89,6 +126,28 @@ typedef struct {
 } analysis_table_type;
 
 
+/*
+  The layout of analysis_table_type is fixed, modules compiled against
+  it are loaded with dlopen(). A module which can use the structured
+  observation error covariance exports an additional, optional,
+  analysis_covar_table_type instance with the name of the table and
+  the suffix "_covar"; use ANALYSIS_COVAR_TABLE( LINK_NAME ) to get the
+  name. When a covar entry is set it is used instead of the
+  corresponding entry in the main table; modules without the covar
+  table get a dense R as before.
+*/
+
+typedef struct {
+  analysis_updateA_covar_ftype     * updateA;
+  analysis_initX_covar_ftype       * initX;
+  analysis_init_update_covar_ftype * init_update;
+} analysis_covar_table_type;
+
+#define ANALYSIS_COVAR_TABLE_SUFFIX        "_covar"
+#define ANALYSIS_COVAR_TABLE__( link_name ) link_name ## _covar
+#define ANALYSIS_COVAR_TABLE( link_name )   ANALYSIS_COVAR_TABLE__( link_name )
+
+
 
 
 
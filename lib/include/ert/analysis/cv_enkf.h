@@ -18,6 +18,7 @@
 
 #include <ert/util/rng.h>
 #include <ert/res_util/matrix.h>
+#include <ert/analysis/obs_covar.h>
 #include <ert/util/bool_vector.h>
 
 typedef struct cv_enkf_data_struct cv_enkf_data_type;
@@ -28,7 +29,7 @@ void   cv_enkf_data_free( void * arg );
 void cv_enkf_init_update( void * arg ,
                           const bool_vector_type * ens_mask ,
                           const matrix_type * S ,
-                          const matrix_type * R ,
+                          const obs_covar_type * R ,
                           const matrix_type * dObs ,
                           const matrix_type * E ,
                           const matrix_type * D,
@@ -38,7 +39,7 @@ void cv_enkf_initX(void * module_data ,
                    matrix_type * X ,
                    matrix_type * A ,
                    matrix_type * S ,
-                   matrix_type * R ,
+                   const obs_covar_type * R ,
                    matrix_type * dObs ,
                    matrix_type * E ,
                    matrix_type * D,
@@ -51,3 +52,11 @@ bool        cv_enkf_set_bool(  void * arg , const char * var_name , bool value )
 void        cv_enkf_set_truncation( cv_enkf_data_type * data , double truncation );
 void        cv_enkf_set_pen_press( cv_enkf_data_type * data , bool value );
 void        cv_enkf_set_subspace_dimension( cv_enkf_data_type * data , int subspace_dimension);
+void        cv_enkf_set_nfolds( cv_enkf_data_type * data , int nfolds );
+
+int                 cv_enkf_get_nfolds( const cv_enkf_data_type * cv_data );
+const matrix_type * cv_enkf_get_Z( const cv_enkf_data_type * cv_data );
+const matrix_type * cv_enkf_get_Rp( const cv_enkf_data_type * cv_data );
+int                 cv_enkf_get_max_subspace_dimension( const cv_enkf_data_type * cv_data );
+matrix_type       * cv_enkf_alloc_cv_error( cv_enkf_data_type * cv_data , const matrix_type * A , const int * randperms , int maxP);
+int                 cv_enkf_get_optimal_numb_comp(cv_enkf_data_type * cv_data , const matrix_type * cvErr , const int maxP );
@@ -5,6 +5,7 @@
 
 #include <ert/res_util/matrix_lapack.h>
 #include <ert/res_util/matrix.h>
+#include <ert/analysis/obs_covar.h>
 
 
 int enkf_linalg_get_PC( const matrix_type * S0, 
@@ -35,7 +36,7 @@ void enkf_linalg_init_sqrtX(matrix_type * X5      ,
                             bool bootstrap);
 
 
-void enkf_linalg_Cee(matrix_type * B, int nrens , const matrix_type * R , const matrix_type * U0 , const double * inv_sig0);
+void enkf_linalg_Cee(matrix_type * B, int nrens , const obs_covar_type * R , const matrix_type * U0 , const double * inv_sig0);
 
 
 int enkf_linalg_svd_truncation(const matrix_type * S , 
@@ -60,7 +61,7 @@ int enkf_linalg_svdS(const matrix_type * S ,
 matrix_type * enkf_linalg_alloc_innov( const matrix_type * dObs , const matrix_type * S);
 
 void enkf_linalg_lowrankCinv__(const matrix_type * S , 
-                               const matrix_type * R , 
+                               const obs_covar_type * R , 
                                matrix_type * V0T , 
                                matrix_type * Z, 
                                double * eig , 
@@ -71,7 +72,7 @@ void enkf_linalg_lowrankCinv__(const matrix_type * S ,
 
 
 void enkf_linalg_lowrankCinv(const matrix_type * S , 
-                             const matrix_type * R , 
+                             const obs_covar_type * R , 
                              matrix_type * W       , /* Corresponding to X1 from Eq. 14.29 */
                              double * eig          , /* Corresponding to 1 / (1 + Lambda_1) (14.29) */
                              double truncation     ,
@@ -18,6 +18,7 @@
 
 #include <ert/util/rng.h>
 #include <ert/res_util/matrix.h>
+#include <ert/analysis/obs_covar.h>
 
 #include <ert/analysis/module_data_block_vector.h>
 #include <ert/analysis/module_info.h>
@@ -30,7 +31,7 @@ void   fwd_step_enkf_data_free( void * arg );
 void fwd_step_enkf_updateA(void * module_data ,
                             matrix_type * A ,
                             matrix_type * S ,
-                            matrix_type * R ,
+                            const obs_covar_type * R ,
                             matrix_type * dObs ,
                             matrix_type * E ,
                             matrix_type * D ,
@@ -8,6 +8,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include <ert/res_util/matrix.h>
+#include <ert/analysis/obs_covar.h>
 #include <ert/util/rng.h>
 
 #define  DEFAULT_ENKF_TRUNCATION_  0.98
@@ -44,7 +45,7 @@ extern "C" {
                         matrix_type * X ,
                         matrix_type * A ,
                         matrix_type * S ,
-                        matrix_type * R ,
+                        const obs_covar_type * R ,
                         matrix_type * dObs ,
                         matrix_type * E ,
                         matrix_type * D,
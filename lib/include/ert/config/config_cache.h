@@ -0,0 +1,74 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'config_cache.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_CONFIG_CACHE_H
+#define ERT_CONFIG_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ert/util/type_macros.h>
+#include <ert/util/stringlist.h>
+
+/*
+  Setting this environment variable to an existing directory enables
+  caching of the parsed configuration files in that directory. Only
+  the parsed config_content is cached, the objects built from it are
+  not.
+*/
+#define CONFIG_CACHE_ENV "ERT_CONFIG_CACHE"
+
+typedef enum { CONFIG_CACHE_PUSH    = 1,     /* Start parsing a (included) file. */
+               CONFIG_CACHE_POP     = 2,     /* Done with the current file. */
+               CONFIG_CACHE_DEFINE  = 3,     /* A DEFINE statement: args = {key , value}. */
+               CONFIG_CACHE_KEYWORD = 4 }    /* A keyword line after substitution: args = {kw , arg1 , arg2 , ...}. */
+  config_cache_event_type;
+
+typedef struct config_cache_struct config_cache_type;
+
+  uint64_t                 config_cache_hash_string( uint64_t hash , const char * string );
+  bool                     config_cache_hash_file( const char * filename , uint64_t * hash );
+  config_cache_type      * config_cache_alloc( const char * key );
+  void                     config_cache_free( config_cache_type * cache );
+  char                   * config_cache_alloc_filename( const char * cache_path , const char * key );
+  const char             * config_cache_get_key( const config_cache_type * cache );
+  void                     config_cache_add_file( config_cache_type * cache , const char * filename );
+  void                     config_cache_add_env( config_cache_type * cache , const char * var , const char * value );
+  void                     config_cache_push( config_cache_type * cache , const char * config_filename );
+  void                     config_cache_pop( config_cache_type * cache );
+  void                     config_cache_add_define( config_cache_type * cache , const char * key , const char * value );
+  void                     config_cache_add_keyword( config_cache_type * cache , const char * config_file , const stringlist_type * tokens );
+  int                      config_cache_get_num_files( const config_cache_type * cache );
+  int                      config_cache_get_size( const config_cache_type * cache );
+  config_cache_event_type  config_cache_iget_event( const config_cache_type * cache , int index );
+  const char             * config_cache_iget_file( const config_cache_type * cache , int index );
+  const stringlist_type  * config_cache_iget_args( const config_cache_type * cache , int index );
+  bool                     config_cache_is_current( const config_cache_type * cache );
+  bool                     config_cache_fwrite( const config_cache_type * cache , const char * filename );
+  config_cache_type      * config_cache_fread_alloc( const char * filename , const char * key );
+
+UTIL_IS_INSTANCE_HEADER( config_cache );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
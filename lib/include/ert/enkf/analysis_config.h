@@ -87,6 +87,14 @@ void                   analysis_config_set_penalised_press( analysis_config_type
 void                   analysis_config_set_log_path(analysis_config_type * config , const char * log_path );
 void                   analysis_config_set_std_cutoff( analysis_config_type * config , double std_cutoff );
 double                 analysis_config_get_std_cutoff( const analysis_config_type * config );
+void                   analysis_config_set_ministep_threads( analysis_config_type * config , int ministep_threads );
+int                    analysis_config_get_ministep_threads( const analysis_config_type * config );
+void                   analysis_config_set_localization_radius( analysis_config_type * config , double radius );
+double                 analysis_config_get_localization_radius( const analysis_config_type * config );
+void                   analysis_config_set_localization_tile_size( analysis_config_type * config , int tile_size );
+int                    analysis_config_get_localization_tile_size( const analysis_config_type * config );
+void                   analysis_config_set_update_profile( analysis_config_type * config , bool update_profile );
+bool                   analysis_config_get_update_profile( const analysis_config_type * config );
 void                   analysis_config_add_config_items( config_parser_type * config );
 void                   analysis_config_fprintf_config( analysis_config_type * config , FILE * stream);
 
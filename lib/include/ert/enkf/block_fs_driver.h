@@ -25,6 +25,8 @@ extern "C" {
 #include <stdio.h>
 #include <stdbool.h>
 
+#include <ert/res_util/block_fs.h>
+
 #include <ert/enkf/fs_types.h>  
 
   typedef struct block_fs_driver_struct block_fs_driver_type;
@@ -33,7 +35,7 @@ extern "C" {
   void                   block_fs_driver_fwrite_mount_info(FILE * stream , fs_driver_enum driver_type , int num_block_fs_drivers);
   block_fs_driver_type * block_fs_driver_fread_alloc(const char * root_path , FILE * stream);
   bool                   block_fs_sscanf_key(const char * key , char ** config_key , int * __report_step , int * __iens);
-  void                 * block_fs_driver_open(FILE * fstab_stream , const char * mount_point , fs_driver_enum driver_type , bool read_only);
+  void                 * block_fs_driver_open(FILE * fstab_stream , const char * mount_point , fs_driver_enum driver_type , bool read_only , bool lazy);
   void                   block_fs_driver_create_fs( FILE * stream , 
                                                     const char * mount_point , 
                                                     fs_driver_enum driver_type , 
@@ -41,6 +43,10 @@ extern "C" {
                                                     const char * ens_path_fmt, 
                                                     const char * filename );
   void                   block_fs_driver_fskip(FILE * fstab_stream);
+  bool                   block_fs_driver_clone( void * driver , const char * target_mount_point );
+  int                    block_fs_driver_get_num_mounted( void * driver );
+  void                   block_fs_driver_set_fsync_policy( void * driver , int fsync_interval , size_t fsync_bytes , double fsync_seconds );
+  void                   block_fs_driver_set_codec( void * driver , block_fs_codec_type codec );
 
 #ifdef __cplusplus
 }
@@ -54,6 +54,8 @@ extern "C" {
 #define  ANALYSIS_LOAD_KEY                 "ANALYSIS_LOAD"
 #define  ANALYSIS_SET_VAR_KEY              "ANALYSIS_SET_VAR"
 #define  ANALYSIS_SELECT_KEY               "ANALYSIS_SELECT"
+#define  BLOCK_FS_CODEC_KEY                "BLOCK_FS_CODEC"
+#define  BLOCK_FS_FSYNC_KEY                "BLOCK_FS_FSYNC"
 #define  CONTAINER_KEY                     "CONTAINER"
 #define  CUSTOM_KW_KEY                     "CUSTOM_KW"
 #define  DATA_ROOT_KEY                     "DATA_ROOT"
@@ -138,12 +140,14 @@ extern "C" {
 #define  STATIC_KW_KEY                     "ADD_STATIC_KW"
 #define  STD_CUTOFF_KEY                    "STD_CUTOFF"
 #define  SUMMARY_KEY                       "SUMMARY"
+#define  SUMMARY_STORE_KEY                 "SUMMARY_STORE"
 #define  SURFACE_KEY                       "SURFACE"
 #define  UPDATE_LOG_PATH_KEY               "UPDATE_LOG_PATH"
 #define  UPDATE_PATH_KEY                   "UPDATE_PATH"
 #define  SINGLE_NODE_UPDATE_KEY            "SINGLE_NODE_UPDATE"
 #define  STORE_SEED_KEY                    "STORE_SEED"
 #define  RANDOM_SEED_KEY                   "RANDOM_SEED"
+#define  RANDOM_ENGINE_KEY                 "RANDOM_ENGINE"
 #define  UMASK_KEY                         "UMASK"
 #define  WORKFLOW_JOB_DIRECTORY_KEY        "WORKFLOW_JOB_DIRECTORY"
 #define  LOAD_WORKFLOW_KEY                 "LOAD_WORKFLOW"
@@ -0,0 +1,71 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'distance_localization.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_DISTANCE_LOCALIZATION_H
+#define ERT_DISTANCE_LOCALIZATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ert/util/type_macros.h>
+#include <ert/util/rng.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#include <ert/res_util/matrix.h>
+
+#include <ert/analysis/obs_covar.h>
+#include <ert/analysis/analysis_module.h>
+
+#include <ert/enkf/enkf_obs.h>
+#include <ert/enkf/obs_data.h>
+#include <ert/enkf/active_list.h>
+
+typedef struct distance_localization_struct distance_localization_type;
+
+  double                       distance_localization_gaspari_cohn( double distance , double radius );
+  distance_localization_type * distance_localization_alloc( double radius , int tile_size );
+  void                         distance_localization_free( distance_localization_type * localization );
+  double                       distance_localization_get_radius( const distance_localization_type * localization );
+  int                          distance_localization_get_tile_size( const distance_localization_type * localization );
+  int                          distance_localization_get_num_obs( const distance_localization_type * localization );
+  void                         distance_localization_add_obs( distance_localization_type * localization , double x , double y , double z );
+  void                         distance_localization_add_global_obs( distance_localization_type * localization );
+  void                         distance_localization_add_obs_data( distance_localization_type * localization , const enkf_obs_type * enkf_obs , const obs_data_type * obs_data , const ecl_grid_type * grid );
+  int                          distance_localization_update_field( const distance_localization_type * localization ,
+                                                                   const ecl_grid_type * grid ,
+                                                                   const active_list_type * active_list ,
+                                                                   matrix_type * A ,
+                                                                   int row_offset ,
+                                                                   int num_rows ,
+                                                                   analysis_module_type * module ,
+                                                                   const matrix_type * S ,
+                                                                   const obs_covar_type * R ,
+                                                                   const matrix_type * dObs ,
+                                                                   const matrix_type * E ,
+                                                                   const matrix_type * D ,
+                                                                   rng_type * rng ,
+                                                                   int num_threads);
+
+UTIL_IS_INSTANCE_HEADER( distance_localization );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -67,6 +67,30 @@
 
 #define DEFAULT_DBASE_TYPE "BLOCK_FS"
 
+/*
+  The optional columnar summary store, see summary_store.c; the
+  maximum amount of memory (in MB) used for tables which have not yet
+  been written to disk.
+*/
+#define DEFAULT_SUMMARY_STORE                false
+#define DEFAULT_SUMMARY_STORE_MAX_PENDING_MB   256
+
+/*
+  When the block_fs storage calls fsync(): after every N'th write, after
+  a number of MB written and after a number of seconds since the last
+  fsync(); 0 disables the size and time based criteria. See
+  block_fs_set_fsync_policy().
+*/
+#define DEFAULT_BLOCK_FS_FSYNC_INTERVAL   10
+#define DEFAULT_BLOCK_FS_FSYNC_MB          0
+#define DEFAULT_BLOCK_FS_FSYNC_SECONDS     0
+
+/*
+  The codec used by the block_fs storage to compress the parameter and
+  dynamic nodes; see block_fs_codec_type.
+*/
+#define DEFAULT_BLOCK_FS_CODEC            BLOCK_FS_CODEC_NONE
+
 /** 
     The default number of block_fs instances allocated. 
 */
@@ -103,6 +127,10 @@
 #define DEFAULT_ENKF_TRUNCATION            0.99
 #define DEFAULT_ENKF_ALPHA                 3.0
 #define DEFAULT_ENKF_STD_CUTOFF            1e-6
+#define DEFAULT_MINISTEP_THREADS           1
+#define DEFAULT_LOCALIZATION_RADIUS        0
+#define DEFAULT_LOCALIZATION_TILE_SIZE     4
+#define DEFAULT_UPDATE_PROFILE             false
 #define DEFAULT_MERGE_OBSERVATIONS         false
 #define DEFAULT_RERUN                      false
 #define DEFAULT_RERUN_START                0  
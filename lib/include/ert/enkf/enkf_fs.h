@@ -26,8 +26,11 @@ extern "C" {
 #include <ert/util/stringlist.h>
 #include <ert/util/type_macros.h>
 #include <ert/util/buffer.h>
+#include <ert/util/vector.h>
 #include <ert/util/stringlist.h>
 
+#include <ert/res_util/block_fs.h>
+
 #include <ert/enkf/fs_driver.h>
 #include <ert/enkf/enkf_types.h>
 #include <ert/enkf/fs_types.h>
@@ -37,6 +40,7 @@ extern "C" {
 #include <ert/enkf/state_map.h>
 #include <ert/enkf/misfit_ensemble_typedef.h>
 #include <ert/enkf/summary_key_set.h>
+#include <ert/enkf/summary_store.h>
 #include <ert/enkf/custom_kw_config_set.h>
 
   const      char * enkf_fs_get_mount_point( const enkf_fs_type * fs );
@@ -51,6 +55,10 @@ extern "C" {
   int               enkf_fs_incref( enkf_fs_type * fs );
   int               enkf_fs_get_refcount( const enkf_fs_type * fs );
   enkf_fs_type    * enkf_fs_mount( const char * path );
+  enkf_fs_type    * enkf_fs_mount_lazy( const char * path , bool read_only );
+  int               enkf_fs_get_num_mounted_shards( const enkf_fs_type * fs );
+  void              enkf_fs_set_fsync_policy( enkf_fs_type * fs , int fsync_interval , size_t fsync_bytes , double fsync_seconds );
+  void              enkf_fs_set_codec( enkf_fs_type * fs , block_fs_codec_type codec );
   bool              enkf_fs_update_disk_version(const char * mount_point , int src_version , int target_version);
   int               enkf_fs_disk_version(const char * mount_point );
   int               enkf_fs_get_version104( const char * path );
@@ -63,8 +71,22 @@ extern "C" {
                                           enkf_var_type var_type,
                                           int iens);
 
+  void              enkf_fs_fwrite_vectors(enkf_fs_type * enkf_fs ,
+                                           const vector_type * buffers ,
+                                           const stringlist_type * node_keys,
+                                           enkf_var_type var_type,
+                                           int iens);
+
   bool              enkf_fs_exists( const char * mount_point );
 
+  void              enkf_fs_copy_node(enkf_fs_type * src_fs , enkf_fs_type * target_fs , buffer_type * buffer ,
+                                      const char * node_key , enkf_var_type var_type ,
+                                      node_id_type src_id , node_id_type target_id);
+
+  void              enkf_fs_copy_vector(enkf_fs_type * src_fs , enkf_fs_type * target_fs , buffer_type * buffer ,
+                                        const char * node_key , enkf_var_type var_type ,
+                                        int src_iens , int target_iens);
+
   void              enkf_fs_fread_node(enkf_fs_type * enkf_fs , buffer_type * buffer ,
                                        const char * node_key , enkf_var_type var_type ,
                                        int report_step , int iens);
@@ -75,12 +97,16 @@ extern "C" {
                                          int iens);
 
 
+  long              enkf_fs_get_bytes_read( enkf_fs_type * fs );
+  long              enkf_fs_get_bytes_written( enkf_fs_type * fs );
+
   bool              enkf_fs_has_vector(enkf_fs_type * enkf_fs , const char * node_key , enkf_var_type var_type , int iens);
   bool              enkf_fs_has_node(enkf_fs_type * enkf_fs , const char * node_key , enkf_var_type var_type , int report_step , int iens);
 
   void              enkf_fs_debug_fprintf( const enkf_fs_type * fs);
 
   enkf_fs_type *    enkf_fs_create_fs( const char * mount_point , fs_driver_impl driver_id , void * arg, bool mount);
+  enkf_fs_type *    enkf_fs_clone( enkf_fs_type * src_fs , const char * target_mount_point , bool mount );
 
   char             * enkf_fs_alloc_case_filename( const enkf_fs_type * fs , const char * input_name);
   char             * enkf_fs_alloc_case_member_filename( const enkf_fs_type * fs , int iens , const char * input_name);
@@ -105,6 +131,8 @@ extern "C" {
   cases_config_type         * enkf_fs_get_cases_config( const enkf_fs_type * fs);
   misfit_ensemble_type      * enkf_fs_get_misfit_ensemble( const enkf_fs_type * fs );
   summary_key_set_type      * enkf_fs_get_summary_key_set( const enkf_fs_type * fs );
+  summary_store_type        * enkf_fs_get_summary_store( const enkf_fs_type * fs );
+  bool                        enkf_fs_enable_summary_store( enkf_fs_type * fs );
   custom_kw_config_set_type * enkf_fs_get_custom_kw_config_set( const enkf_fs_type * fs );
 
   void             enkf_fs_increase_run_count(enkf_fs_type * fs);
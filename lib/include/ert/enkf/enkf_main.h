@@ -267,6 +267,19 @@ extern "C" {
                                                              stringlist_type * node_list,
                                                              bool_vector_type * iactive);
 
+  void              enkf_main_init_realizations_from_existing( enkf_main_type * enkf_main,
+                                                               enkf_fs_type * source_case_fs,
+                                                               enkf_fs_type * target_case_fs,
+                                                               const int_vector_type * source_iens,
+                                                               const int_vector_type * target_iens,
+                                                               const stringlist_type * skip_keys);
+
+  void              enkf_main_store_parameter_rows( enkf_main_type * enkf_main,
+                                                    enkf_fs_type * target_case_fs,
+                                                    const char * key,
+                                                    const int_vector_type * target_iens,
+                                                    const matrix_type * values);
+
   bool              enkf_main_case_is_initialized( const enkf_main_type * enkf_main ,
                                                    const char * case_name ,
                                                    bool_vector_type * __mask);
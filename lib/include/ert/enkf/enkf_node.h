@@ -26,6 +26,7 @@
 #include <ert/util/rng.h>
 #include <ert/util/hash.h>
 #include <ert/util/int_vector.h>
+#include <ert/util/double_vector.h>
 #include <ert/util/type_macros.h>
 
 #include <ert/ecl/ecl_kw.h>
@@ -135,6 +136,8 @@ extern "C" {
   enkf_var_type    enkf_node_get_var_type(const enkf_node_type * );
   bool             enkf_node_use_forward_init( const enkf_node_type * enkf_node );
   void             enkf_node_clear_serial_state(enkf_node_type * );
+  void             enkf_node_serialize_data(const enkf_node_type *enkf_node , node_id_type node_id , const active_list_type * active_list , matrix_type * A , int row_offset , int column);
+  void             enkf_node_deserialize_data(enkf_node_type *enkf_node , node_id_type node_id , const active_list_type * active_list , const matrix_type * A , int row_offset , int column);
   void             enkf_node_serialize(enkf_node_type * enkf_node , enkf_fs_type * fs , node_id_type node_id , const active_list_type * active_list , matrix_type * A , int row_offset , int column);
   void             enkf_node_deserialize(enkf_node_type *enkf_node , enkf_fs_type * fs , node_id_type node_id , const active_list_type * active_list , const matrix_type * A , int row_offset , int column);
 
@@ -168,8 +171,12 @@ extern "C" {
   void              enkf_node_load_vector( enkf_node_type * enkf_node , enkf_fs_type * fs , int iens);
   bool              enkf_node_store(enkf_node_type * enkf_node , enkf_fs_type * fs , bool force_vectors , node_id_type node_id);
   bool              enkf_node_store_vector(enkf_node_type *enkf_node , enkf_fs_type * fs , int iens );
+  bool              enkf_node_write_vector_buffer( enkf_node_type * enkf_node , buffer_type * buffer );
   bool              enkf_node_try_load(enkf_node_type *enkf_node , enkf_fs_type * fs , node_id_type node_id);
   bool              enkf_node_try_load_vector(enkf_node_type *enkf_node , enkf_fs_type * fs , int iens );
+  bool              enkf_node_raw_copy( const enkf_config_node_type * config_node );
+  int               enkf_node_load_gen_data_rows( const enkf_config_node_type * config_node , enkf_fs_type * fs , int report_step ,
+                                                  const int_vector_type * iens_list , double_vector_type * data , int_vector_type * data_size);
   bool              enkf_node_exists( enkf_node_type *enkf_node , enkf_fs_type * fs , int report_step , int iens);
   bool              enkf_node_vector_storage( const enkf_node_type * node );
   enkf_node_type  * enkf_node_alloc_shared_container(const enkf_config_node_type * config, hash_type * node_hash);
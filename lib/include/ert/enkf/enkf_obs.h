@@ -43,6 +43,7 @@ extern "C" {
 #include <ert/enkf/enkf_types.h>
 #include <ert/enkf/local_obsdata_node.h>
 #include <ert/enkf/local_obsdata.h>
+#include <ert/enkf/response_cache.h>
 
   bool enkf_obs_have_obs(const enkf_obs_type * enkf_obs);
   bool enkf_obs_is_valid(const enkf_obs_type*);
@@ -78,6 +79,13 @@ extern "C" {
                                          meas_data_type           * meas_data,
                                          obs_data_type            * obs_data);
 
+  void enkf_obs_get_obs_and_measure_data_cached(const enkf_obs_type      * enkf_obs,
+                                                response_cache_type      * cache,
+                                                const local_obsdata_type * local_obsdata ,
+                                                const int_vector_type    * ens_active_list ,
+                                                meas_data_type           * meas_data,
+                                                obs_data_type            * obs_data);
+
 
   stringlist_type * enkf_obs_alloc_typed_keylist( enkf_obs_type * enkf_obs , obs_impl_type );
   hash_type * enkf_obs_alloc_data_map(enkf_obs_type * enkf_obs);
@@ -95,6 +103,7 @@ extern "C" {
   void enkf_obs_local_scale_std( const enkf_obs_type * enkf_obs , const local_obsdata_type * local_obsdata, double scale_factor);
   void              enkf_obs_add_local_nodes_with_data(const enkf_obs_type * enkf_obs , local_obsdata_type * local_obs , enkf_fs_type *fs , const bool_vector_type * ens_mask);
   double            enkf_obs_scale_correlated_std(const enkf_obs_type * enkf_obs , enkf_fs_type * fs , const int_vector_type * ens_active_list , const local_obsdata_type * local_obsdata);
+  double            enkf_obs_scale_correlated_std_cached(const enkf_obs_type * enkf_obs , response_cache_type * cache , const int_vector_type * ens_active_list , const local_obsdata_type * local_obsdata);
   local_obsdata_type * enkf_obs_alloc_all_active_local_obs( const enkf_obs_type * enkf_obs , const char * key);
   conf_class_type * enkf_obs_get_obs_conf_class();
   UTIL_IS_INSTANCE_HEADER( enkf_obs );
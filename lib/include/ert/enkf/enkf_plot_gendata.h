@@ -47,6 +47,8 @@ void                        enkf_plot_gendata_load( enkf_plot_gendata_type * plo
 
 double_vector_type * enkf_plot_gendata_get_min_values(enkf_plot_gendata_type * plot_data);
 double_vector_type * enkf_plot_gendata_get_max_values(enkf_plot_gendata_type * plot_data);
+double_vector_type * enkf_plot_gendata_get_mean_values(enkf_plot_gendata_type * plot_data);
+double_vector_type * enkf_plot_gendata_get_std_values(enkf_plot_gendata_type * plot_data);
 
 
 UTIL_IS_INSTANCE_HEADER( enkf_plot_gendata );
@@ -31,6 +31,7 @@ extern "C" {
 #include <ert/enkf/enkf_fs.h>
 #include <ert/enkf/enkf_types.h>
 #include <ert/enkf/enkf_config_node.h>
+#include <ert/enkf/summary_table.h>
   
   typedef struct enkf_plot_tvector_struct enkf_plot_tvector_type;
   
@@ -43,6 +44,7 @@ extern "C" {
   enkf_plot_tvector_type * enkf_plot_tvector_alloc( const enkf_config_node_type * config_node , int iens);
   void                     enkf_plot_tvector_load( enkf_plot_tvector_type * plot_tvector , enkf_fs_type * fs , const char * user_key );
   void *                   enkf_plot_tvector_load__( void * arg );
+  void                     enkf_plot_tvector_load_table( enkf_plot_tvector_type * plot_tvector , enkf_fs_type * fs , const summary_table_type * table);
   void                     enkf_plot_tvector_free( enkf_plot_tvector_type * plot_tvector );
   void                     enkf_plot_tvector_iset( enkf_plot_tvector_type * plot_tvector , int index , time_t time , double value);
   
@@ -0,0 +1,68 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'ensemble_stat.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_ENSEMBLE_STAT_H
+#define ERT_ENSEMBLE_STAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ert/util/type_macros.h>
+#include <ert/util/double_vector.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/res_util/thread_pool.h>
+
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/enkf_node.h>
+#include <ert/enkf/enkf_config_node.h>
+
+typedef struct ensemble_stat_struct ensemble_stat_type;
+
+  ensemble_stat_type * ensemble_stat_alloc( const double_vector_type * quantiles );
+  void                 ensemble_stat_free( ensemble_stat_type * stat );
+  void                 ensemble_stat_add_sample( ensemble_stat_type * stat , const double * data , int size);
+  void                 ensemble_stat_add_ensemble( ensemble_stat_type * stat ,
+                                                   const enkf_config_node_type * config_node ,
+                                                   enkf_fs_type * fs ,
+                                                   int report_step ,
+                                                   const int_vector_type * iens_list ,
+                                                   thread_pool_type * work_pool);
+
+  int                  ensemble_stat_get_size( const ensemble_stat_type * stat );
+  int                  ensemble_stat_get_count( const ensemble_stat_type * stat );
+  int                  ensemble_stat_get_num_quantiles( const ensemble_stat_type * stat );
+  double               ensemble_stat_iget_mean( const ensemble_stat_type * stat , int index );
+  double               ensemble_stat_iget_std( const ensemble_stat_type * stat , int index );
+  double               ensemble_stat_iget_min( const ensemble_stat_type * stat , int index );
+  double               ensemble_stat_iget_max( const ensemble_stat_type * stat , int index );
+  double               ensemble_stat_iget_quantile( const ensemble_stat_type * stat , int iq , int index );
+
+  void                 ensemble_stat_get_mean_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id);
+  void                 ensemble_stat_get_std_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id);
+  void                 ensemble_stat_get_min_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id);
+  void                 ensemble_stat_get_max_node( const ensemble_stat_type * stat , enkf_node_type * node , node_id_type node_id);
+  void                 ensemble_stat_get_quantile_node( const ensemble_stat_type * stat , int iq , enkf_node_type * node , node_id_type node_id);
+
+UTIL_IS_INSTANCE_HEADER( ensemble_stat );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -146,6 +146,12 @@ void                    field_config_get_ijk(const field_config_type * , int , i
 bool                    field_config_ijk_valid(const field_config_type *  , int  , int  , int );
 bool                    field_config_ijk_active(const field_config_type * config , int i , int j , int k);
 bool                    field_config_active_cell(const field_config_type *  , int , int , int);
+const int             * field_config_get_active_map( const field_config_type * config , bool rms_index_order );
+const int             * field_config_get_global_map( const field_config_type * config , bool rms_index_order );
+const void            * field_config_get_init_data( const field_config_type * config , const char * init_file );
+const void            * field_config_add_init_data( const field_config_type * config , const char * init_file , void * data );
+void                    field_config_release_init_data( const field_config_type * config , const void * data );
+int                     field_config_get_num_init_data( const field_config_type * config );
 char                  * field_config_alloc_init_file(const field_config_type * , int );
 field_file_format_type  field_config_get_export_format(const field_config_type * );
 field_file_format_type  field_config_get_import_format(const field_config_type * );
@@ -26,6 +26,7 @@ extern "C" {
 
 
 typedef  float  (field_func_type) ( float );
+typedef  void   (field_vector_func_type) ( float * , int );
 typedef  struct field_trans_table_struct field_trans_table_type;
 
 
@@ -36,6 +37,12 @@ field_trans_table_type * field_trans_table_alloc();
 bool                     field_trans_table_has_key(field_trans_table_type *  , const char * );
 field_func_type        * field_trans_table_lookup(field_trans_table_type *  , const char * );
 
+field_vector_func_type * field_trans_get_vector_func(field_func_type * func);
+void                     field_trans_apply_float(field_func_type * func , float * data , int size);
+void                     field_trans_apply_double(field_func_type * func , double * data , int size);
+void                     field_trans_truncate_float(float * data , int size , int truncation , double min_value , double max_value);
+void                     field_trans_truncate_double(double * data , int size , int truncation , double min_value , double max_value);
+
 
 
 #ifdef __cplusplus 
@@ -39,6 +39,7 @@ extern "C" {
 #include <ert/ecl/ecl_sum.h>
 
 #include <ert/res_util/path_fmt.h>
+#include <ert/res_util/block_fs.h>
 
 #include <ert/enkf/enkf_types.h>
 #include <ert/enkf/fs_types.h>
@@ -59,6 +60,15 @@ extern "C" {
   const char           * model_config_get_enspath( const model_config_type * model_config);
   const char           * model_config_get_rftpath( const model_config_type * model_config);
   fs_driver_impl         model_config_get_dbase_type(const model_config_type * model_config );
+  bool                   model_config_get_summary_store( const model_config_type * model_config );
+  void                   model_config_set_summary_store( model_config_type * model_config , bool summary_store , int max_pending_mb );
+  int                    model_config_get_summary_store_max_pending( const model_config_type * model_config );
+  void                   model_config_set_fsync_policy( model_config_type * model_config , int fsync_interval , int fsync_mb , double fsync_seconds );
+  int                    model_config_get_fsync_interval( const model_config_type * model_config );
+  int                    model_config_get_fsync_mb( const model_config_type * model_config );
+  double                 model_config_get_fsync_seconds( const model_config_type * model_config );
+  void                   model_config_set_codec( model_config_type * model_config , block_fs_codec_type codec );
+  block_fs_codec_type    model_config_get_codec( const model_config_type * model_config );
   const ecl_sum_type   * model_config_get_refcase( const model_config_type * model_config );
   void                   model_config_init_internalization( model_config_type * );
   void                   model_config_set_internalize_state( model_config_type *  , int );
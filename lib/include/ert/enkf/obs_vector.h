@@ -44,6 +44,7 @@ extern "C" {
 #include <ert/enkf/active_list.h>
 #include <ert/enkf/time_map.h>
 #include <ert/enkf/local_obsdata_node.h>
+#include <ert/enkf/response_cache.h>
 
 
   typedef void   (obs_free_ftype)                (void *);
@@ -68,6 +69,7 @@ extern "C" {
   void                 obs_vector_iget_observations(const obs_vector_type *  , int  , obs_data_type * , const active_list_type * active_list, enkf_fs_type * fs);
   bool                 obs_vector_has_data( const obs_vector_type * obs_vector , const bool_vector_type * active_mask , enkf_fs_type * fs);
   void                 obs_vector_measure(const obs_vector_type *  , enkf_fs_type * fs, int report_step , const int_vector_type * ens_active_list , meas_data_type * , const active_list_type * active_list);
+  void                 obs_vector_measure_cached(const obs_vector_type *  , response_cache_type * cache, int report_step , const int_vector_type * ens_active_list , meas_data_type * , const active_list_type * active_list);
   const char         * obs_vector_get_state_kw(const obs_vector_type * );
   const char         * obs_vector_get_key(const obs_vector_type * );
   obs_impl_type        obs_vector_get_impl_type(const obs_vector_type * );
@@ -0,0 +1,45 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'response_cache.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_RESPONSE_CACHE_H
+#define ERT_RESPONSE_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ert/util/type_macros.h>
+
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/enkf_node.h>
+#include <ert/enkf/enkf_config_node.h>
+
+typedef struct response_cache_struct response_cache_type;
+
+  response_cache_type  * response_cache_alloc( enkf_fs_type * fs );
+  void                   response_cache_free( response_cache_type * cache );
+  enkf_fs_type         * response_cache_get_fs( const response_cache_type * cache );
+  int                    response_cache_get_size( const response_cache_type * cache );
+  const enkf_node_type * response_cache_get_node( response_cache_type * cache , const enkf_config_node_type * config_node , node_id_type node_id , enkf_node_type * work_node);
+
+UTIL_IS_INSTANCE_HEADER( response_cache );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
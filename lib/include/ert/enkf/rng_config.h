@@ -30,10 +30,19 @@ extern "C" {
 
 typedef struct rng_config_struct rng_config_type;
 
+typedef enum { RNG_ENGINE_MZRAN   = 0 ,     /* Sequential MZRAN streams - the default. */
+               RNG_ENGINE_COUNTER = 1 }     /* Counter based; reproducible in parallel. */
+  rng_engine_type;
+
+#define RNG_ENGINE_MZRAN_STRING   "MZRAN"
+#define RNG_ENGINE_COUNTER_STRING "COUNTER"
+
   void               rng_config_fprintf_config( rng_config_type * rng_config , FILE * stream );
   void               rng_config_init(rng_config_type * rng_config, const config_content_type * config);
   void               rng_config_set_type( rng_config_type * rng_config , rng_alg_type type);
   rng_alg_type       rng_config_get_type(const rng_config_type * rng_config );
+  void               rng_config_set_engine( rng_config_type * rng_config , rng_engine_type engine);
+  rng_engine_type    rng_config_get_engine(const rng_config_type * rng_config );
   const char       * rng_config_get_seed_load_file( const rng_config_type * rng_config );
   const char       * rng_config_get_random_seed(const rng_config_type * rng_config);
   void               rng_config_set_seed_load_file( rng_config_type * rng_config , const char * seed_load_file);
@@ -22,6 +22,8 @@
 #include <ert/util/type_macros.h>
 #include <ert/util/rng.h>
 
+#include <ert/res_util/counter_rng.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,6 +41,12 @@ extern "C" {
  */
 #define RNG_STATE_DIGITS 10
 
+/*
+  The purposes of the different counter_rng streams.
+*/
+#define RNG_STREAM_INIT              1
+#define RNG_STREAM_OBS_PERTURBATION  2
+
 
 typedef struct rng_manager_struct rng_manager_type;
 
@@ -52,6 +60,8 @@ rng_type         * rng_manager_iget(rng_manager_type * rng_manager, int index);
 void               rng_manager_free( rng_manager_type * rng_manager );
 void               rng_manager_save_state(const rng_manager_type * rng_manager, const char * seed_file);
 void               rng_manager_log_state(const rng_manager_type * rng_manager);
+void               rng_manager_enable_counter_rng( rng_manager_type * rng_manager );
+const counter_rng_type * rng_manager_get_counter_rng( const rng_manager_type * rng_manager );
 
 
 UTIL_IS_INSTANCE_HEADER( rng_manager );
@@ -7,6 +7,9 @@ extern "C" {
 
 #include <ert/util/type_macros.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/ecl_smspec.h>
 
 #include <ert/enkf/enkf_types.h>
 
@@ -19,6 +22,7 @@ extern "C" {
   bool                       summary_key_matcher_match_summary_key(const summary_key_matcher_type * matcher, const char * summary_key);
   bool                       summary_key_matcher_summary_key_is_required(const summary_key_matcher_type * matcher, const char * summary_key);
   stringlist_type *          summary_key_matcher_get_keys(const summary_key_matcher_type * matcher);
+  int_vector_type *          summary_key_matcher_alloc_match_index(const summary_key_matcher_type * matcher, const ecl_smspec_type * smspec);
 
   UTIL_IS_INSTANCE_HEADER( summary_key_matcher );
 
@@ -0,0 +1,52 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'summary_store.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_SUMMARY_STORE_H
+#define ERT_SUMMARY_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <ert/util/type_macros.h>
+#include <ert/util/double_vector.h>
+
+#include <ert/enkf/summary_table.h>
+
+typedef struct summary_store_struct summary_store_type;
+
+  summary_store_type * summary_store_mount( const char * mount_file , bool read_only );
+  void                 summary_store_close( summary_store_type * store );
+  void                 summary_store_fsync( summary_store_type * store );
+  void                 summary_store_set_max_pending( summary_store_type * store , size_t max_pending_bytes );
+  size_t               summary_store_get_max_pending( const summary_store_type * store );
+  bool                 summary_store_clone( summary_store_type * store , const char * target_mount_file );
+  bool                 summary_store_has_key( summary_store_type * store , const char * key );
+  void                 summary_store_set_vector( summary_store_type * store , const char * key , int iens , const double_vector_type * data );
+  summary_table_type * summary_store_alloc_table( summary_store_type * store , const char * key );
+  summary_table_type * summary_store_alloc_time_slice( summary_store_type * store , const char * key , int step1 , int step2 );
+
+UTIL_IS_INSTANCE_HEADER( summary_store );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,62 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'summary_table.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_SUMMARY_TABLE_H
+#define ERT_SUMMARY_TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/type_macros.h>
+#include <ert/util/buffer.h>
+#include <ert/util/double_vector.h>
+
+#define SUMMARY_TABLE_HEADER_SIZE (3 * sizeof(int))
+
+typedef struct summary_table_struct summary_table_type;
+
+  summary_table_type * summary_table_alloc( int ens_size , int time_size );
+  summary_table_type * summary_table_alloc_copy( const summary_table_type * src , int step1 , int step2 );
+  summary_table_type * summary_table_alloc_from_buffer( buffer_type * buffer );
+  void                 summary_table_free( summary_table_type * table );
+  void                 summary_table_free__( void * arg );
+  void                 summary_table_resize( summary_table_type * table , int ens_size , int time_size );
+  void                 summary_table_fwrite_buffer( const summary_table_type * table , buffer_type * buffer );
+  void                 summary_table_parse_header( const int * header , int * ens_size , int * time_size );
+  size_t               summary_table_data_offset( int ens_size , int time_size , int step );
+  size_t               summary_table_mask_offset( int ens_size , int time_size , int step );
+  void                 summary_table_set_vector( summary_table_type * table , int iens , const double_vector_type * data );
+  bool                 summary_table_get_vector( const summary_table_type * table , int iens , double_vector_type * data );
+
+  int                  summary_table_get_ens_size( const summary_table_type * table );
+  int                  summary_table_get_time_size( const summary_table_type * table );
+  double               summary_table_iget( const summary_table_type * table , int iens , int step );
+  bool                 summary_table_iget_active( const summary_table_type * table , int iens , int step );
+  bool                 summary_table_has_realization( const summary_table_type * table , int iens );
+  double             * summary_table_get_data( summary_table_type * table );
+  unsigned char      * summary_table_get_mask( summary_table_type * table );
+
+UTIL_IS_INSTANCE_HEADER( summary_table );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
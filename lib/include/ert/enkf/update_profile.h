@@ -0,0 +1,59 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'update_profile.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_UPDATE_PROFILE_H
+#define ERT_UPDATE_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+
+#include <ert/util/type_macros.h>
+
+#include <ert/enkf/enkf_fs_type.h>
+
+typedef struct update_profile_struct update_profile_type;
+typedef struct update_phase_struct   update_phase_type;
+
+  update_profile_type     * update_profile_alloc( const char * case_name , int step1 , int step2 );
+  void                      update_profile_free( update_profile_type * profile );
+  update_phase_type       * update_profile_start_phase( update_profile_type * profile , enkf_fs_type * fs , const char * ministep , const char * dataset , const char * name );
+  void                      update_phase_stop( update_phase_type * phase , enkf_fs_type * fs );
+  void                      update_phase_set_dims( update_phase_type * phase , int rows , int columns );
+  int                       update_profile_get_num_phases( const update_profile_type * profile );
+  const update_phase_type * update_profile_iget_phase( const update_profile_type * profile , int index );
+  const char              * update_phase_get_name( const update_phase_type * phase );
+  const char              * update_phase_get_ministep( const update_phase_type * phase );
+  const char              * update_phase_get_dataset( const update_phase_type * phase );
+  double                    update_phase_get_wall_time( const update_phase_type * phase );
+  double                    update_phase_get_cpu_time( const update_phase_type * phase );
+  long                      update_phase_get_bytes_read( const update_phase_type * phase );
+  long                      update_phase_get_bytes_written( const update_phase_type * phase );
+  int                       update_phase_get_rows( const update_phase_type * phase );
+  int                       update_phase_get_columns( const update_phase_type * phase );
+  void                      update_profile_fprintf_json( const update_profile_type * profile , FILE * stream );
+  void                      update_profile_fwrite_json( const update_profile_type * profile , const char * filename );
+
+UTIL_IS_INSTANCE_HEADER( update_profile );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
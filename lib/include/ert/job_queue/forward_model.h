@@ -42,6 +42,8 @@ typedef struct  forward_model_struct forward_model_type ;
   void                     forward_model_parse_job_deprecated_args(forward_model_type * forward_model, const char * input_string); //DEPRECATED
   void                     forward_model_formatted_fprintf(const forward_model_type *  , const char * run_id, const char *, const char * , const subst_list_type * ,
                                                            mode_t umask, const env_varlist_type * list);
+  void                     forward_model_formatted_fprintf_with_results(const forward_model_type *  , const char * run_id, const char *, const char * , const subst_list_type * ,
+                                                                        mode_t umask, const env_varlist_type * list, const stringlist_type * result_files);
   void                     forward_model_free( forward_model_type * );
   forward_model_type *     forward_model_alloc_copy(const forward_model_type * forward_model);
   void                     forward_model_iset_job_arg( forward_model_type * forward_model , int job_index , const char * arg , const char * value);
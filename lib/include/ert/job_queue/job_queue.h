@@ -35,6 +35,8 @@ extern "C" {
   time_t              job_queue_get_progress_timestamp(const job_queue_type * queue);
   time_t              job_queue_iget_progress_timestamp(job_queue_type *queue, int job_index);
   time_t              job_queue_get_status_timestamp(const job_queue_type * queue);
+  int                 job_queue_get_status_change_count(const job_queue_type * queue);
+  int                 job_queue_wait_status_change(const job_queue_type * queue, int change_count, double timeout);
   void                job_queue_submit_complete( job_queue_type * queue );
   job_driver_type     job_queue_get_driver_type( const job_queue_type * queue );
   void                job_queue_set_driver(job_queue_type * queue , queue_driver_type * driver);
@@ -49,6 +49,8 @@ typedef struct job_queue_manager_struct job_queue_manager_type;
 
   job_status_type job_queue_manager_iget_job_status(const job_queue_manager_type * manager, int job_index);
   time_t job_queue_manager_get_status_timestamp(const job_queue_manager_type * queue);
+  int    job_queue_manager_get_status_change_count(const job_queue_manager_type * manager);
+  int    job_queue_manager_wait_status_change(const job_queue_manager_type * manager, int change_count, double timeout);
 
 
   UTIL_IS_INSTANCE_HEADER( job_queue_manager );
@@ -37,6 +37,9 @@ extern "C" {
   bool job_queue_status_transition( job_queue_status_type * status_count , job_status_type src_status , job_status_type target_status);
   int job_queue_status_get_total_count( const job_queue_status_type * status );
   time_t job_queue_status_get_timestamp(const job_queue_status_type * status);
+  void job_queue_status_notify( job_queue_status_type * status );
+  int  job_queue_status_get_change_count( job_queue_status_type * status );
+  int  job_queue_status_wait_change( job_queue_status_type * status , int change_count , double timeout);
 
   UTIL_IS_INSTANCE_HEADER( job_queue_status );
   UTIL_SAFE_CAST_HEADER( job_queue_status );
@@ -20,6 +20,7 @@
 #define ERT_BLOCK_FS
 #include <ert/util/buffer.h>
 #include <ert/util/vector.h>
+#include <ert/util/stringlist.h>
 #include <ert/util/type_macros.h>
 
 #ifdef __cplusplus
@@ -34,6 +35,26 @@ extern "C" {
     STRING_SORT = 1,
     OFFSET_SORT = 2
   } block_fs_sort_type;
+
+  /*
+    The codec used to store the payload of a node; the codec is
+    recorded in the node header, so the codec setting of a block_fs
+    instance only affects the nodes written after it is set.
+  */
+  typedef enum {
+    BLOCK_FS_CODEC_NONE        = 0,
+    BLOCK_FS_CODEC_ZLIB        = 1,   /* zlib - through buffer_fwrite_compressed(). */
+    BLOCK_FS_CODEC_SHUFFLE_RLE = 2    /* Byte planes of 8 byte words + run length encoding; cheap and without dependencies. */
+  } block_fs_codec_type;
+
+  /*
+    How the index was established when the filesystem was mounted.
+  */
+  typedef enum {
+    BLOCK_FS_MOUNT_INDEX   = 0,   /* The index file was up to date. */
+    BLOCK_FS_MOUNT_JOURNAL = 1,   /* The index file + the changes since the last checkpoint from the journal. */
+    BLOCK_FS_MOUNT_SCAN    = 2    /* The index was rebuilt by scanning the whole data file. */
+  } block_fs_mount_type;
   
   size_t          block_fs_get_cache_usage( const block_fs_type * block_fs );
   double          block_fs_get_fragmentation( const block_fs_type * block_fs );
@@ -50,9 +71,15 @@ extern "C" {
                                   bool read_only, 
                                   bool use_lockfile);
   void            block_fs_close( block_fs_type * block_fs , bool unlink_empty);
+  bool            block_fs_clone( block_fs_type * block_fs , const char * target_mount_file );
   void            block_fs_fwrite_file(block_fs_type * block_fs , const char * filename , const void * ptr , size_t byte_size);
   void            block_fs_fwrite_buffer(block_fs_type * block_fs , const char * filename , const buffer_type * buffer);
+  void            block_fs_fwrite_batch( block_fs_type * block_fs , const stringlist_type * filenames , const vector_type * buffers );
+  void            block_fs_set_fsync_policy( block_fs_type * block_fs , int fsync_interval , size_t fsync_bytes , double fsync_seconds );
+  void            block_fs_set_checkpoint_interval( block_fs_type * block_fs , int checkpoint_interval );
+  block_fs_mount_type block_fs_get_mount_type( const block_fs_type * block_fs );
   void            block_fs_fread_file( block_fs_type * block_fs , const char * filename , void * ptr);
+  void            block_fs_fread_range( block_fs_type * block_fs , const char * filename , size_t offset , size_t read_bytes , void * ptr);
   int             block_fs_get_filesize( block_fs_type * block_fs , const char * filename);
   void            block_fs_fread_realloc_buffer( block_fs_type * block_fs , const char * filename , buffer_type * buffer);
   void            block_fs_sync( block_fs_type * block_fs );
@@ -60,6 +87,9 @@ extern "C" {
   bool            block_fs_has_file( block_fs_type * block_fs , const char * filename);
   vector_type   * block_fs_alloc_filelist( block_fs_type * block_fs  , const char * pattern , block_fs_sort_type sort_mode , bool include_free_nodes );
   void            block_fs_defrag( block_fs_type * block_fs );
+  void            block_fs_set_codec( block_fs_type * block_fs , block_fs_codec_type codec );
+  block_fs_codec_type block_fs_get_codec( const block_fs_type * block_fs );
+  int             block_fs_get_stored_size( block_fs_type * block_fs , const char * filename);
   
   long int        user_file_node_get_node_offset( const user_file_node_type * user_file_node );
   long int        user_file_node_get_data_offset( const user_file_node_type * user_file_node );
@@ -0,0 +1,43 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'counter_rng.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_COUNTER_RNG_H
+#define ERT_COUNTER_RNG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ert/util/type_macros.h>
+
+typedef struct counter_rng_struct counter_rng_type;
+
+  counter_rng_type * counter_rng_alloc( unsigned int key0 , unsigned int key1 );
+  void               counter_rng_free( counter_rng_type * counter_rng );
+  unsigned int       counter_rng_stream_id( unsigned int purpose , const char * name );
+  void               counter_rng_get_uint4( const counter_rng_type * counter_rng , unsigned int stream , int iens , long index , unsigned int * output );
+  double             counter_rng_get_double( const counter_rng_type * counter_rng , unsigned int stream , int iens , long index );
+  double             counter_rng_std_normal( const counter_rng_type * counter_rng , unsigned int stream , int iens , long index );
+  void               counter_rng_std_normal_vector( const counter_rng_type * counter_rng , unsigned int stream , int iens , long offset , int size , double * data , int stride );
+
+UTIL_IS_INSTANCE_HEADER( counter_rng );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
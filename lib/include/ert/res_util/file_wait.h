@@ -0,0 +1,34 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'file_wait.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_FILE_WAIT_H
+#define ERT_FILE_WAIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+  int  file_wait_any( const char ** files , int num_files , double timeout );
+  bool file_wait_use_inotify( const char * path );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
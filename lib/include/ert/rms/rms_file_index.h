@@ -0,0 +1,52 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'rms_file_index.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef ERT_RMS_FILE_INDEX_H
+#define ERT_RMS_FILE_INDEX_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/rms/rms_type.h>
+
+typedef struct rms_file_index_struct rms_file_index_type;
+
+rms_file_index_type * rms_file_index_alloc( const char * filename );
+void                  rms_file_index_free( rms_file_index_type * index );
+const char          * rms_file_index_get_filename( const rms_file_index_type * index );
+bool                  rms_file_index_get_endian_convert( const rms_file_index_type * index );
+int                   rms_file_index_get_num_tags( const rms_file_index_type * index );
+const char          * rms_file_index_iget_tag_name( const rms_file_index_type * index , int tag_nr );
+long                  rms_file_index_iget_tag_offset( const rms_file_index_type * index , int tag_nr );
+int                   rms_file_index_find_tag( const rms_file_index_type * index , const char * tagname , const char * keyname , const char * keyvalue);
+bool                  rms_file_index_has_tag( const rms_file_index_type * index , const char * tagname , const char * keyname , const char * keyvalue);
+bool                  rms_file_index_iget_has_key( const rms_file_index_type * index , int tag_nr , const char * keyname );
+int                   rms_file_index_iget_key_size( const rms_file_index_type * index , int tag_nr , const char * keyname );
+rms_type_enum         rms_file_index_iget_key_type( const rms_file_index_type * index , int tag_nr , const char * keyname );
+int                   rms_file_index_iget_key_sizeof_ctype( const rms_file_index_type * index , int tag_nr , const char * keyname );
+const char          * rms_file_index_iget_key_string( const rms_file_index_type * index , int tag_nr , const char * keyname );
+int                   rms_file_index_iget_key_int( const rms_file_index_type * index , int tag_nr , const char * keyname );
+void                  rms_file_index_iget_key_data( const rms_file_index_type * index , int tag_nr , const char * keyname , void * buffer );
+bool                  rms_file_index_get_dims( const rms_file_index_type * index , int * dims );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
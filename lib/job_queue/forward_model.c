@@ -179,7 +179,8 @@ static void forward_model_json_fprintf(const forward_model_type * forward_model,
                                        const char * data_root,
                                        const subst_list_type * global_args,
                                        mode_t umask,
-                                       const env_varlist_type * varlist) {
+                                       const env_varlist_type * varlist,
+                                       const stringlist_type * result_files) {
   char * json_file = util_alloc_filename(path , DEFAULT_JOB_JSON, NULL);
   FILE * stream    = util_fopen(json_file, "w");
   int i;
@@ -198,6 +199,16 @@ static void forward_model_json_fprintf(const forward_model_type * forward_model,
   }
   fprintf(stream, "],\n");
 
+  if (result_files) {
+    fprintf(stream, "\"result_files\" : [");
+    for (i=0; i < stringlist_get_size(result_files); i++) {
+      fprintf(stream, "\"%s\"", stringlist_iget(result_files, i));
+      if (i < (stringlist_get_size( result_files ) - 1))
+        fprintf(stream,", ");
+    }
+    fprintf(stream, "],\n");
+  }
+
   fprintf(stream, "\n\"ert_version\" : [%d, %d, \"%s\"],\n",
           ecl_version_get_major_version(),
           ecl_version_get_minor_version(),
@@ -217,7 +228,27 @@ void forward_model_formatted_fprintf(const forward_model_type * forward_model ,
                                      const subst_list_type * global_args,
                                      mode_t umask,
                                      const env_varlist_type * list) {
-  forward_model_json_fprintf(   forward_model, run_id, path, data_root, global_args, umask, list);
+  forward_model_json_fprintf(   forward_model, run_id, path, data_root, global_args, umask, list, NULL);
+}
+
+
+/*
+  As forward_model_formatted_fprintf(), and in addition a
+  "result_files" list in jobs.json with fnmatch() patterns, relative to
+  the runpath, for the result files ERT loads apart from the summary
+  and restart files. The job manager lists only these files, and the
+  summary and restart files, in the OK file.
+*/
+
+void forward_model_formatted_fprintf_with_results(const forward_model_type * forward_model ,
+                                                  const char * run_id,
+                                                  const char * path,
+                                                  const char * data_root,
+                                                  const subst_list_type * global_args,
+                                                  mode_t umask,
+                                                  const env_varlist_type * list,
+                                                  const stringlist_type * result_files) {
+  forward_model_json_fprintf(   forward_model, run_id, path, data_root, global_args, umask, list, result_files);
 }
 
 #undef DEFAULT_JOB_JSON
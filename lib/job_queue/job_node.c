@@ -489,7 +489,8 @@ submit_status_type job_queue_node_submit(job_queue_node_type * node,
   */
   submit_status = SUBMIT_OK;
   job_queue_node_set_status( node , new_status);
-  job_queue_status_transition(status, old_status, new_status);
+  if (job_queue_status_transition(status, old_status, new_status))
+    job_queue_status_notify( status );
 
 
 cleanup:
@@ -553,6 +554,8 @@ bool job_queue_node_update_status(job_queue_node_type * node,
       job_status_type new_status = JOB_QUEUE_DO_KILL_NODE_FAILURE;
       status_change = job_queue_status_transition(status, current_status, new_status);
       job_queue_node_set_status(node, new_status);
+      if (status_change)
+        job_queue_status_notify( status );
     }
   }
 
@@ -561,6 +564,8 @@ bool job_queue_node_update_status(job_queue_node_type * node,
     job_status_type new_status = queue_driver_get_status( driver , node->job_data);
     status_change = job_queue_status_transition(status , current_status , new_status);
     job_queue_node_set_status(node,new_status);
+    if (status_change)
+      job_queue_status_notify( status );
   }
 
 cleanup:
@@ -578,8 +583,10 @@ bool job_queue_node_status_transition(job_queue_node_type * node,
   job_status_type old_status = job_queue_node_get_status( node );
   status_change = job_queue_status_transition(status , old_status, new_status);
 
-  if (status_change)
+  if (status_change) {
     job_queue_node_set_status( node , new_status );
+    job_queue_status_notify( status );
+  }
 
   pthread_mutex_unlock( &node->data_mutex );
   return status_change;
@@ -616,6 +623,7 @@ bool job_queue_node_kill(job_queue_node_type * node,
     }
     job_queue_status_transition(status, current_status, JOB_QUEUE_IS_KILLED);
     job_queue_node_set_status( node , JOB_QUEUE_IS_KILLED);
+    job_queue_status_notify( status );
     res_log_finfo("job %s set to killed",
                   node->job_name);
     result = true;
@@ -669,8 +677,10 @@ void job_queue_node_restart(job_queue_node_type * node,
   pthread_mutex_lock( &node->data_mutex );
 
   job_status_type current_status = job_queue_node_get_status( node );
-  job_queue_status_transition(status, current_status, JOB_QUEUE_WAITING);
-  job_queue_node_set_status( node , JOB_QUEUE_WAITING);
+  if (job_queue_status_transition(status, current_status, JOB_QUEUE_WAITING)) {
+    job_queue_node_set_status( node , JOB_QUEUE_WAITING);
+    job_queue_status_notify( status );
+  }
   job_queue_node_reset_submit_attempt(node);
 
   pthread_mutex_unlock( &node->data_mutex );
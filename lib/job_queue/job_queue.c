@@ -23,11 +23,14 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #include <ert/util/util.h>
 #include <ert/util/arg_pack.h>
+#include <ert/util/stringlist.h>
 #include <ert/res_util/res_log.h>
 #include <ert/res_util/thread_pool.h>
+#include <ert/res_util/file_wait.h>
 
 #include <ert/job_queue/job_queue.h>
 #include <ert/job_queue/job_node.h>
@@ -634,6 +637,64 @@ static void job_queue_user_exit__( job_queue_type * queue ) {
 }
 
 
+/*
+  The OK file written by the job manager lists the files produced by
+  the forward model, as lines 'FILE <size> <path>' with the path
+  relative to the runpath. When the OK file is visible the job manager
+  has already fsynced all of these, but on a network filesystem the
+  file attributes seen from this host can lag behind; the sizes are
+  therefore checked, and re-checked with increasing intervals for up
+  to @timeout seconds. A file is complete when it is at least as large
+  as listed, a file which has grown since the OK file was written has
+  not lost anything. OK files without a file list are accepted as is.
+*/
+
+static bool job_queue_check_ok_file_list( const char * ok_file , int timeout ) {
+  char * content = util_fread_alloc_file_content( ok_file , NULL );
+  stringlist_type * lines = stringlist_alloc_from_split( content , "\n" );
+  char * run_path = NULL;
+  int usleep_time = 10000;
+  long total_usleep = 0;
+  bool complete = false;
+
+  util_alloc_file_components( ok_file , &run_path , NULL , NULL );
+  while (true) {
+    complete = true;
+    for (int i = 0; i < stringlist_get_size( lines ); i++) {
+      const char * line = stringlist_iget( lines , i );
+      if (strncmp( line , "FILE " , 5 ) == 0) {
+        char * end;
+        long size = strtol( line + 5 , &end , 10 );
+        if (*end == ' ') {
+          char * path = run_path ? util_alloc_filename( run_path , end + 1 , NULL ) : util_alloc_string_copy( end + 1 );
+          struct stat st;
+          if ((stat( path , &st ) != 0) || (st.st_size < size))
+            complete = false;
+          free( path );
+        }
+      }
+      if (!complete)
+        break;
+    }
+
+    if (complete || (total_usleep >= 1000000L * timeout))
+      break;
+
+    usleep( usleep_time );
+    total_usleep += usleep_time;
+    usleep_time = util_int_min( 2 * usleep_time , 1000000 );
+  }
+
+  if (!complete)
+    res_log_fwarning("The result files listed in: %s are not complete", ok_file);
+
+  free( run_path );
+  stringlist_free( lines );
+  free( content );
+  return complete;
+}
+
+
 static bool job_queue_check_node_status_files(const job_queue_type * job_queue,
                                               job_queue_node_type * node) {
   const char * exit_file = job_queue_node_get_exit_file( node );
@@ -646,21 +707,19 @@ static bool job_queue_check_node_status_files(const job_queue_type * job_queue,
   if (!ok_file)
     return true;
 
-  int ok_sleep_time   = 1; // Time to wait between checks for OK|EXIT file
-  int total_wait_time = 0;
-
-  /* Wait for OK file */
-  while (total_wait_time < job_queue->max_ok_wait_time) {
-    if (util_file_exists( ok_file ))
-      return true;
-
-    if (exit_file && util_file_exists(exit_file))
-      return false;  // job has failed
-
-    sleep( ok_sleep_time );
-    total_wait_time += ok_sleep_time;
+  /*
+    Wait for the OK file, or the EXIT file, to appear. On a local
+    filesystem this is event driven, otherwise the files are polled
+    with increasing intervals; see file_wait.c.
+  */
+  {
+    const char * status_files[2] = { ok_file , exit_file };
+    int num_files = exit_file ? 2 : 1;
+    if (file_wait_any( status_files , num_files , job_queue->max_ok_wait_time ) != 0)
+      return false;
   }
-  return false;
+
+  return job_queue_check_ok_file_list( ok_file , job_queue->max_ok_wait_time );
 }
 
 
@@ -1044,6 +1103,7 @@ void job_queue_run_jobs(job_queue_type * queue, int num_total_run, bool verbose)
   */
   queue->open = false;
   queue->running = false;
+  job_queue_status_notify( queue->status );
   pthread_mutex_unlock(&queue->run_mutex);
 }
 
@@ -1367,6 +1427,20 @@ time_t job_queue_get_status_timestamp(const job_queue_type * queue) {
 }
 
 
+int job_queue_get_status_change_count(const job_queue_type * queue) {
+  return job_queue_status_get_change_count(queue->status);
+}
+
+
+/*
+  Blocks until a job changes status or the queue stops running, see
+  job_queue_status_wait_change().
+*/
+int job_queue_wait_status_change(const job_queue_type * queue, int change_count, double timeout) {
+  return job_queue_status_wait_change(queue->status, change_count, timeout);
+}
+
+
 time_t job_queue_get_progress_timestamp(const job_queue_type * queue) {
   return queue->progress_timestamp;
 }
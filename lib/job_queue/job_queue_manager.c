@@ -199,6 +199,16 @@ time_t job_queue_manager_get_status_timestamp(const job_queue_manager_type * man
 }
 
 
+int job_queue_manager_get_status_change_count(const job_queue_manager_type * manager) {
+  return job_queue_get_status_change_count(manager->job_queue);
+}
+
+
+int job_queue_manager_wait_status_change(const job_queue_manager_type * manager, int change_count, double timeout) {
+  return job_queue_wait_status_change(manager->job_queue, change_count, timeout);
+}
+
+
 time_t job_queue_manager_get_progress_timestamp(const job_queue_manager_type * manager) {
   return job_queue_get_progress_timestamp(manager->job_queue);
 }
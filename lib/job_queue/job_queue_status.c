@@ -16,6 +16,8 @@
    for more details.
 */
 #include <pthread.h>
+#include <errno.h>
+#include <time.h>
 
 #include <ert/util/type_macros.h>
 #include <ert/util/util.h>
@@ -31,6 +33,10 @@ struct job_queue_status_struct {
   pthread_rwlock_t rw_lock;
   int status_index[JOB_QUEUE_MAX_STATE];
   time_t timestamp;
+
+  pthread_mutex_t change_lock;
+  pthread_cond_t change_cond;
+  int change_count;                /* Incremented on every status change; protected by change_lock. */
 };
 
 
@@ -58,6 +64,9 @@ job_queue_status_type * job_queue_status_alloc() {
   job_queue_status_type * status = util_malloc( sizeof * status );
   UTIL_TYPE_ID_INIT( status ,   JOB_QUEUE_STATUS_TYPE_ID );
   pthread_rwlock_init( &status->rw_lock , NULL);
+  pthread_mutex_init( &status->change_lock , NULL );
+  pthread_cond_init( &status->change_cond , NULL );
+  status->change_count = 0;
   job_queue_status_clear( status );
   status->timestamp = time(NULL);
 
@@ -82,6 +91,8 @@ job_queue_status_type * job_queue_status_alloc() {
 
 
 void job_queue_status_free( job_queue_status_type * status ) {
+  pthread_cond_destroy( &status->change_cond );
+  pthread_mutex_destroy( &status->change_lock );
   free( status );
 }
 
@@ -179,3 +190,65 @@ int job_queue_status_get_total_count( const job_queue_status_type * status ) {
 time_t job_queue_status_get_timestamp(const job_queue_status_type * status) {
   return status->timestamp;
 }
+
+
+/*
+  Wakes up all the threads blocking in job_queue_status_wait_change();
+  called by the job nodes on every status change, and by the job_queue
+  when the queue stops running. The nodes call this after the new
+  status has been stored in the node, and with the node data_mutex
+  still held, so that a woken thread will always observe the new
+  status; notifying from job_queue_status_transition() would wake the
+  waiters before the node had been updated.
+*/
+
+void job_queue_status_notify( job_queue_status_type * status ) {
+  pthread_mutex_lock( &status->change_lock );
+  status->change_count++;
+  pthread_cond_broadcast( &status->change_cond );
+  pthread_mutex_unlock( &status->change_lock );
+}
+
+
+int job_queue_status_get_change_count( job_queue_status_type * status ) {
+  int change_count;
+  pthread_mutex_lock( &status->change_lock );
+  change_count = status->change_count;
+  pthread_mutex_unlock( &status->change_lock );
+  return change_count;
+}
+
+
+/*
+  Will block until the change count differs from @change_count, or
+  @timeout seconds have passed; a negative timeout means wait
+  forever. Returns the current change count, which should be passed
+  to the next call. The caller should get the change count *before*
+  inspecting the job status, otherwise a change in between can be
+  missed.
+*/
+
+int job_queue_status_wait_change( job_queue_status_type * status , int change_count , double timeout) {
+  struct timespec deadline;
+
+  if (timeout >= 0) {
+    clock_gettime( CLOCK_REALTIME , &deadline );
+    deadline.tv_sec  += (time_t) timeout;
+    deadline.tv_nsec += (long) ((timeout - (time_t) timeout) * 1e9);
+    if (deadline.tv_nsec >= 1000000000) {
+      deadline.tv_sec  += 1;
+      deadline.tv_nsec -= 1000000000;
+    }
+  }
+
+  pthread_mutex_lock( &status->change_lock );
+  while (status->change_count == change_count) {
+    if (timeout < 0)
+      pthread_cond_wait( &status->change_cond , &status->change_lock );
+    else if (pthread_cond_timedwait( &status->change_cond , &status->change_lock , &deadline ) == ETIMEDOUT)
+      break;
+  }
+  change_count = status->change_count;
+  pthread_mutex_unlock( &status->change_lock );
+  return change_count;
+}
@@ -17,9 +17,11 @@
 */
 #include <stdlib.h>
 #include <stdbool.h>
+#include <pthread.h>
 
 #include <ert/util/test_util.h>
 #include <ert/job_queue/job_node.h>
+#include <ert/job_queue/job_queue_status.h>
 
 
 void test_create() {
@@ -50,9 +52,66 @@ void test_path_does_not_exist() {
 }
 
 
+typedef struct {
+  job_queue_node_type   * node;
+  job_queue_status_type * status;
+} transition_arg_type;
+
+
+void * finish_node( void * arg ) {
+  transition_arg_type * transition_arg = arg;
+  job_queue_node_status_transition( transition_arg->node , transition_arg->status , JOB_QUEUE_DONE );
+  return NULL;
+}
+
+
+/*
+  One job finishes while the others keep running, i.e. there is exactly
+  one status change to wake up on. A thread waiting for the change must
+  see the new status of the node when it is woken; if it is notified
+  before the node status is stored it will go back to waiting, and
+  time out.
+*/
+
+void test_finish_one_while_others_run() {
+  const int num_nodes = 4;
+  job_queue_status_type * status = job_queue_status_alloc();
+  job_queue_node_type * nodes[num_nodes];
+
+  for (int i = 0; i < num_nodes; i++) {
+    nodes[i] = job_queue_node_alloc_simple( "name" , "/tmp" , "/bin/ls" , 0 , NULL );
+    job_queue_status_inc( status , job_queue_node_get_status( nodes[i] ));
+    test_assert_true( job_queue_node_status_transition( nodes[i] , status , JOB_QUEUE_RUNNING ));
+  }
+
+  for (int iter = 0; iter < 500; iter++) {
+    transition_arg_type arg = { .node = nodes[0] , .status = status };
+    int change_count = job_queue_status_get_change_count( status );
+    pthread_t thread;
+
+    pthread_create( &thread , NULL , finish_node , &arg );
+    while (job_queue_node_get_status( nodes[0] ) != JOB_QUEUE_DONE) {
+      int new_count = job_queue_status_wait_change( status , change_count , 5 );
+      test_assert_int_not_equal( change_count , new_count );
+      change_count = new_count;
+    }
+    pthread_join( thread , NULL );
+
+    test_assert_int_equal( 1 , job_queue_status_get_count( status , JOB_QUEUE_DONE ));
+    test_assert_int_equal( num_nodes - 1 , job_queue_status_get_count( status , JOB_QUEUE_RUNNING ));
+    test_assert_true( job_queue_node_status_transition( nodes[0] , status , JOB_QUEUE_RUNNING ));
+  }
+
+  for (int i = 0; i < num_nodes; i++)
+    job_queue_node_free( nodes[i] );
+  job_queue_status_free( status );
+}
+
+
 int main( int argc , char ** argv) {
   util_install_signals();
   test_create();
   test_queue_index();
   test_path_does_not_exist();
+  test_finish_one_while_others_run();
 }
@@ -0,0 +1,155 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'job_queue_latency_test.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ert/util/util.h>
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/type_macros.h>
+
+#include <ert/job_queue/job_queue.h>
+#include <ert/job_queue/job_queue_manager.h>
+
+
+/*
+  Many near-instant jobs where the OK file is created a short time
+  after the job has exited, i.e. when the queue detects the job as
+  DONE the OK file is typically not there yet. The DONE callback
+  measures the time from the OK file was created until the callback
+  runs; that is the latency of the OK file detection, and should be
+  far below the one second of the old polling loop.
+*/
+
+#define JOB_TYPE_ID 66153309
+#define NUM_JOBS    100
+#define OK_DELAY    300000
+
+typedef struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char   * run_path;
+  char   * ok_file;
+  bool     callback_run;
+  double   latency;
+  int      argc;
+  char  ** argv;
+} job_type;
+
+UTIL_SAFE_CAST_FUNCTION( job , JOB_TYPE_ID )
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_REALTIME , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+job_type * alloc_job( int index ) {
+  job_type * job = util_malloc( sizeof * job );
+  UTIL_TYPE_ID_INIT( job , JOB_TYPE_ID );
+  job->callback_run = false;
+  job->latency      = -1;
+  job->run_path     = util_alloc_sprintf( "latency_%03d" , index );
+  job->ok_file      = util_alloc_filename( job->run_path , "OK" , NULL );
+  job->argc         = 5;
+
+  job->argv = util_malloc( 5 * sizeof * job->argv );
+  job->argv[0] = job->run_path;
+  job->argv[1] = "RUNNING";
+  job->argv[2] = "OK";
+  job->argv[3] = "0";
+  job->argv[4] = util_alloc_sprintf( "%d" , OK_DELAY );
+
+  util_make_path( job->run_path );
+  return job;
+}
+
+
+void free_job( job_type * job ) {
+  free( job->argv[4] );
+  free( job->argv );
+  free( job->ok_file );
+  free( job->run_path );
+  free( job );
+}
+
+
+bool callback( void * arg ) {
+  job_type * job = job_safe_cast( arg );
+  double now = wall_clock( );
+  FILE * stream = util_fopen( job->ok_file , "r" );
+  double created;
+
+  if (fscanf( stream , "%lf" , &created ) == 1)
+    job->latency = now - created;
+  fclose( stream );
+
+  job->callback_run = true;
+  return true;
+}
+
+
+int main(int argc , char ** argv) {
+  const char * task = util_alloc_abs_path( argv[1] );
+  test_work_area_type * work_area = test_work_area_alloc( "job_queue_latency" );
+  job_type * jobs[NUM_JOBS];
+
+  job_queue_type * queue = job_queue_alloc( NUM_JOBS , "OK" , "STATUS" , "ERROR" );
+  queue_driver_type * driver = queue_driver_alloc_local( );
+  job_queue_manager_type * queue_manager = job_queue_manager_alloc( queue );
+
+  util_install_signals( );
+  job_queue_set_driver( queue , driver );
+  job_queue_manager_start_queue( queue_manager , NUM_JOBS , false );
+
+  for (int i = 0; i < NUM_JOBS; i++) {
+    jobs[i] = alloc_job( i );
+    job_queue_add_job( queue , task , callback , NULL , NULL , jobs[i] , 1 , jobs[i]->run_path , jobs[i]->run_path , jobs[i]->argc , (const char **) jobs[i]->argv );
+  }
+  job_queue_submit_complete( queue );
+
+  if (!job_queue_manager_try_wait( queue_manager , 120 ))
+    util_exit( "job_queue never completed \n" );
+
+  {
+    double sum = 0;
+    double max = 0;
+    for (int i = 0; i < NUM_JOBS; i++) {
+      job_type * job = jobs[i];
+      test_assert_true( job->callback_run );
+      test_assert_true( job->latency >= -0.01 );
+      sum += job->latency;
+      max = util_double_max( max , job->latency );
+    }
+    printf( "OK file to SUCCESS latency for %d jobs: mean: %.3f s  max: %.3f s\n" , NUM_JOBS , sum / NUM_JOBS , max );
+    test_assert_true( sum / NUM_JOBS < 0.5 );
+  }
+
+  job_queue_manager_free( queue_manager );
+  job_queue_free( queue );
+  queue_driver_free( driver );
+  for (int i = 0; i < NUM_JOBS; i++)
+    free_job( jobs[i] );
+  test_work_area_free( work_area );
+  free( (char *) task );
+  exit(0);
+}
@@ -16,6 +16,9 @@
    for more details.
 */
 
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <ert/util/util.h>
@@ -31,6 +34,14 @@
     3. Remove the @runfile.
     4. Create new file @OK_file
     5. exit.
+
+  If the optional argument @ok_delay is given the job exits
+  immediately after step 3, and the @OK_file is created by a child
+  process @ok_delay microseconds later; the @OK_file will then contain
+  the time it was created, and list the result file RESULT in the
+  same format as the job manager. This is used by the
+  job_queue_latency_test to simulate a filesystem where the OK file
+  becomes visible after the job has finished.
 */
 
 int main(int argc, char ** argv) {
@@ -49,6 +60,34 @@ int main(int argc, char ** argv) {
   }
   usleep( usleep_time );
   util_unlink_existing(runfile);
+
+  if (argc > 5) {
+    int ok_delay;
+    util_sscanf_int( argv[5] , &ok_delay );
+    if (fork() == 0) {
+      struct timespec ts;
+      long result_size;
+      usleep( ok_delay );
+      {
+        FILE * stream = util_fopen( "RESULT" , "w");
+        fprintf(stream , "Result from: %s\n" , runpath);
+        result_size = ftell( stream );
+        fclose( stream );
+      }
+      clock_gettime( CLOCK_REALTIME , &ts );
+      {
+        char * tmp_file = util_alloc_sprintf("%s.tmp" , OK_file);
+        FILE * stream = util_fopen( tmp_file , "w");
+        fprintf(stream , "%ld.%09ld\n" , (long) ts.tv_sec , ts.tv_nsec);
+        fprintf(stream , "FILE %ld RESULT\n" , result_size);
+        fclose( stream );
+        rename( tmp_file , OK_file );
+        free( tmp_file );
+      }
+    }
+    return 0;
+  }
+
   {
     FILE * stream = util_fopen( OK_file , "w");
     fprintf(stream , "OK ... \n");
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <unistd.h>
 
 #include <ert/job_queue/job_queue_status.h>
 #include <ert/job_queue/queue_driver.h>
@@ -59,6 +60,7 @@ void * user_exit( void * arg ) {
 void * user_done( void * arg ) {
    job_queue_status_type * job_status = job_queue_status_safe_cast( arg );
    job_queue_status_transition( job_status , JOB_QUEUE_WAITING  , JOB_QUEUE_DONE);
+   job_queue_status_notify( job_status );
    return NULL;
 }
 
@@ -195,9 +197,46 @@ void test_index() {
   job_queue_status_free( status );
 }
 
+void * delayed_done( void * arg ) {
+   job_queue_status_type * job_status = job_queue_status_safe_cast( arg );
+   usleep( 100000 );
+   job_queue_status_transition( job_status , JOB_QUEUE_WAITING  , JOB_QUEUE_DONE);
+   job_queue_status_notify( job_status );
+   return NULL;
+}
+
+
+void test_wait_change() {
+  job_queue_status_type * status = job_queue_status_alloc();
+  int change_count;
+
+  job_queue_status_inc( status , JOB_QUEUE_WAITING );
+  change_count = job_queue_status_get_change_count( status );
+
+  /* Timeout without any change. */
+  test_assert_int_equal( change_count , job_queue_status_wait_change( status , change_count , 0.05 ));
+
+  /* A change which has already happened returns immediately. */
+  test_assert_int_not_equal( change_count - 1 , job_queue_status_wait_change( status , change_count - 1 , -1 ));
+
+  {
+    pthread_t thread;
+    pthread_create( &thread , NULL , delayed_done , status );
+    change_count = job_queue_status_wait_change( status , change_count , -1 );
+    test_assert_int_equal( 1 , job_queue_status_get_count( status , JOB_QUEUE_DONE ));
+    pthread_join( thread , NULL );
+  }
+
+  job_queue_status_notify( status );
+  test_assert_int_equal( change_count + 1 , job_queue_status_wait_change( status , change_count , 10 ));
+  job_queue_status_free( status );
+}
+
+
 int main( int argc , char ** argv) {
   util_install_signals();
   test_create();
   test_index();
   test_update();
+  test_wait_change();
 }
@@ -26,19 +26,30 @@
 #include <pthread.h>
 #include <time.h>
 #include <fnmatch.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
 
 #include <ert/util/hash.h>
 #include <ert/util/util.h>
 #include <ert/util/vector.h>
 #include <ert/util/buffer.h>
 #include <ert/util/long_vector.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/int_vector.h>
 #include <ert/res_util/block_fs.h>
 
 
 #define MOUNT_MAP_MAGIC_INT  8861290
 #define BLOCK_FS_TYPE_ID     7100652
 #define INDEX_MAGIC_INT      1213775
-#define INDEX_FORMAT_VERSION       1
+#define INDEX_FORMAT_VERSION       3
+#define JOURNAL_MAGIC_INT    2071548
+#define JOURNAL_RECORD_MAGIC 6513271
+#define DEFAULT_CHECKPOINT_INTERVAL 10000
 
 // #define ENABLE_CACHE
 
@@ -81,6 +92,55 @@ typedef enum {
 } node_status_type;
 
 
+/**
+   On disk an in use node with an encoded payload is tagged with
+   NODE_IN_USE_CODEC instead of NODE_IN_USE, and the header has two
+   extra int fields: the codec and the decoded size. The first byte
+   (on a little endian machine) is NODE_IN_USE_BYTE, so the node is
+   found by block_fs_fseek_valid_node(). In memory the status of such
+   a node is NODE_IN_USE, and the codec field is != BLOCK_FS_CODEC_NONE.
+
+   The nodes written without codec have exactly the same layout as
+   before, i.e. a file written without codec can be read by older
+   versions.
+*/
+
+#define NODE_IN_USE_CODEC    1437226325    /* Binary 01010101101010100101010101010101 */
+
+
+/**
+   The index journal is an append-only log of the changes to the
+   index since the last checkpoint, i.e. since the index file was
+   written. The journal file starts with a header:
+
+      |<JOURNAL_MAGIC_INT: Int><journal_id: Long>|
+
+   where journal_id must be equal to the journal_id stored in the
+   index file for the journal to apply. Then follows one record for
+   every change:
+
+      |<JOURNAL_RECORD_MAGIC: Int><op: Int><size: Int><Key: String><node: index layout><checksum: Int>|
+
+   The checksum covers op, size and the payload, a record which has
+   been torn by a crash is recognized and ends the journal.
+
+     JOURNAL_BEGIN  : Written before the data of a node is written.
+     JOURNAL_COMMIT : Written when the node - including header and
+                      NODE_END_TAG - has been flushed to the data file.
+     JOURNAL_FREE   : Written before a node is marked as free in the
+                      data file.
+
+   A node with a BEGIN record and no later COMMIT was interrupted
+   while writing, and is discarded when the journal is replayed.
+*/
+
+typedef enum {
+  JOURNAL_BEGIN  = 1,
+  JOURNAL_COMMIT = 2,
+  JOURNAL_FREE   = 3
+} journal_op_type;
+
+
 /**
    The free_node_struct is used to implement a doubly linked list of
    free nodes; i.e. holes in the file which are available for other use.
@@ -108,6 +168,8 @@ struct file_node_struct{
   int                node_size;     /* The size in bytes of this node - must be >= data_size. NEVER Changed. */
   int                data_size;     /* The size of the data stored in this node - in addition the node might need to store header information. */
   node_status_type   status;        /* This should be: NODE_IN_USE | NODE_FREE; in addition the disk can have NODE_WRITE_ACTIVE for incomplete writes. */
+  block_fs_codec_type codec;        /* The codec of the data stored in the node; for BLOCK_FS_CODEC_NONE raw_size == data_size. */
+  int                raw_size;      /* The size of the data after decoding. */
 
 #ifdef ENABLE_CACHE
   char             * cache;
@@ -138,6 +200,7 @@ struct block_fs_struct {
   char           * data_file;
   char           * lock_file;
   char           * index_file;
+  char           * journal_file;
 
   int              data_fd;
   FILE           * data_stream;
@@ -164,11 +227,24 @@ struct block_fs_struct {
                                             fragmentation_limit == 0.0 : Rotate when one byte is wasted. */
   bool             data_owner;
   int              fsync_interval;  /* 0: never  n: every nth iteration. */
+  size_t           fsync_bytes;     /* 0: never  n: when n bytes have been written since the last fsync. */
+  double           fsync_seconds;   /* 0: never  t: at the first write t seconds after the last fsync. */
+  int              unsynced_writes;
+  size_t           unsynced_bytes;
+  time_t           last_fsync;
+  block_fs_codec_type codec;        /* The codec used for new writes. */
+  FILE           * journal_stream;  /* NULL when no journal is written, i.e. read only and while rotating. */
+  long int         journal_id;      /* The id shared by the index file and the journal since the last checkpoint. */
+  int              journal_records; /* The number of records written to the journal since the last checkpoint. */
+  int              checkpoint_interval;  /* 0: only checkpoint when closing  n: checkpoint after n journal records. */
+  block_fs_mount_type mount_type;
 };
 
 /*****************************************************************/
 
 static void block_fs_rotate__( block_fs_type * block_fs );
+static void block_fs_checkpoint( block_fs_type * block_fs );
+static void block_fs_unlink_free_node( block_fs_type * block_fs , free_node_type * node);
 
 UTIL_SAFE_CAST_FUNCTION( block_fs , BLOCK_FS_TYPE_ID )
 
@@ -207,6 +283,8 @@ static file_node_type * file_node_alloc( node_status_type status , long int offs
   file_node->data_size   = 0;
   file_node->data_offset = 0;
   file_node->status      = status;
+  file_node->codec       = BLOCK_FS_CODEC_NONE;
+  file_node->raw_size    = 0;
 
 #ifdef ENABLE_CACHE
   file_node->cache      = NULL;
@@ -297,6 +375,12 @@ static file_node_type * file_node_fread_alloc( FILE * stream , char ** key) {
   node_status_type status;
   long int node_offset = ftell( stream );
   if (fread( &status , sizeof status , 1 , stream) == 1) {
+    bool has_codec = false;
+    if (status == NODE_IN_USE_CODEC) {
+      has_codec = true;
+      status = NODE_IN_USE;
+    }
+
     if ((status == NODE_IN_USE) || (status == NODE_FREE)) {
       int node_size;
       if (status == NODE_IN_USE)
@@ -319,6 +403,11 @@ static file_node_type * file_node_fread_alloc( FILE * stream , char ** key) {
       file_node = file_node_alloc( status , node_offset , node_size );
       if (status == NODE_IN_USE) {
         file_node->data_size = util_fread_int( stream );
+        if (has_codec) {
+          file_node->codec    = util_fread_int( stream );
+          file_node->raw_size = util_fread_int( stream );
+        } else
+          file_node->raw_size = file_node->data_size;
         file_node->data_offset    = ftell( stream ) - file_node->node_offset;
       }
     } else {
@@ -339,6 +428,7 @@ static file_node_type * file_node_fread_alloc( FILE * stream , char ** key) {
    Internal index layout:
 
    |<InUse: Bool><Key: String><node_size: Int><data_size: Int>|
+   |<InUse: Bool><Key: String><node_size: Int><data_size: Int><codec: Int><raw_size: Int>|
    |<InUse: Bool><node_size: Int><data_size: Int>|
 
   /|\
@@ -361,12 +451,17 @@ static void file_node_fwrite( const file_node_type * file_node , const char * ke
   if (file_node->node_size == 0)
     util_abort("%s: trying to write node with z<ero size \n",__func__);
   {
+    bool has_codec = ((file_node->status == NODE_IN_USE) && (file_node->codec != BLOCK_FS_CODEC_NONE));
     fseek__( stream , file_node->node_offset , SEEK_SET);
-    util_fwrite_int( file_node->status , stream );
+    util_fwrite_int( has_codec ? NODE_IN_USE_CODEC : file_node->status , stream );
     if (file_node->status == NODE_IN_USE)
       util_fwrite_string( key , stream );
     util_fwrite_int( file_node->node_size , stream );
     util_fwrite_int( file_node->data_size , stream );
+    if (has_codec) {
+      util_fwrite_int( file_node->codec    , stream );
+      util_fwrite_int( file_node->raw_size , stream );
+    }
     fseek__( stream , file_node->node_offset + file_node->node_size - sizeof NODE_END_TAG , SEEK_SET);
     util_fwrite_int( NODE_END_TAG , stream );
   }
@@ -399,17 +494,22 @@ static void file_node_init_fwrite( const file_node_type * file_node , FILE * str
    marker NODE_END_TAG.
 */
 
-static int file_node_header_size( const char * filename ) {
+static int file_node_header_size( const char * filename , block_fs_codec_type codec ) {
   file_node_type * file_node;
-  return sizeof ( file_node->status    ) +
-         sizeof ( file_node->node_size ) +
-         sizeof ( file_node->data_size ) +
-         sizeof ( NODE_END_TAG )         + sizeof(int) /* embedded by the util_fwrite_string routine */ + strlen(filename) + 1 /* \0 */;
+  int header_size = sizeof ( file_node->status    ) +
+                    sizeof ( file_node->node_size ) +
+                    sizeof ( file_node->data_size ) +
+                    sizeof ( NODE_END_TAG )         + sizeof(int) /* embedded by the util_fwrite_string routine */ + strlen(filename) + 1 /* \0 */;
+
+  if (codec != BLOCK_FS_CODEC_NONE)
+    header_size += sizeof( int ) + sizeof( file_node->raw_size );
+
+  return header_size;
 }
 
 
 static void file_node_set_data_offset( file_node_type * file_node, const char * filename ) {
-  file_node->data_offset = file_node_header_size( filename ) - sizeof( NODE_END_TAG );
+  file_node->data_offset = file_node_header_size( filename , file_node->codec ) - sizeof( NODE_END_TAG );
 }
 
 
@@ -420,6 +520,19 @@ static void file_node_dump_index( const file_node_type * file_node , FILE * inde
   util_fwrite_int( file_node->node_size   , index_stream );
   util_fwrite_int( file_node->data_offset , index_stream );
   util_fwrite_int( file_node->data_size   , index_stream );
+  util_fwrite_int( file_node->codec       , index_stream );
+  util_fwrite_int( file_node->raw_size    , index_stream );
+}
+
+
+static void file_node_buffer_dump_index( const file_node_type * file_node , buffer_type * buffer) {
+  buffer_fwrite_int( buffer , file_node->status );
+  buffer_fwrite_long( buffer , file_node->node_offset );
+  buffer_fwrite_int( buffer , file_node->node_size );
+  buffer_fwrite_int( buffer , file_node->data_offset );
+  buffer_fwrite_int( buffer , file_node->data_size );
+  buffer_fwrite_int( buffer , file_node->codec );
+  buffer_fwrite_int( buffer , file_node->raw_size );
 }
 
 
@@ -439,7 +552,11 @@ static file_node_type * file_node_index_fread_alloc( FILE * stream ) {
 }
 */
 
-static file_node_type * file_node_index_buffer_fread_alloc( buffer_type * buffer) {
+/*
+  Version 1 of the index does not have the codec and raw_size fields.
+*/
+
+static file_node_type * file_node_index_buffer_fread_alloc( buffer_type * buffer , int version) {
   node_status_type status = buffer_fread_int( buffer );
   long int node_offset    = buffer_fread_long( buffer );
   int node_size           = buffer_fread_int( buffer );
@@ -448,6 +565,11 @@ static file_node_type * file_node_index_buffer_fread_alloc( buffer_type * buffer
 
     file_node->data_offset = buffer_fread_int( buffer );
     file_node->data_size   = buffer_fread_int( buffer );
+    if (version >= 2) {
+      file_node->codec     = buffer_fread_int( buffer );
+      file_node->raw_size  = buffer_fread_int( buffer );
+    } else
+      file_node->raw_size  = file_node->data_size;
 
     return file_node;
   }
@@ -606,14 +728,17 @@ static void block_fs_set_filenames( block_fs_type * block_fs ) {
   char * data_ext  = util_alloc_sprintf("data_%d" , block_fs->version );
   char * lock_ext  = util_alloc_sprintf("lock_%d" , block_fs->version );
   const char * index_ext = "index";
+  const char * journal_ext = "journal";
 
   util_safe_free( block_fs->data_file );
   util_safe_free( block_fs->lock_file );
   util_safe_free( block_fs->index_file );
+  util_safe_free( block_fs->journal_file );
 
   block_fs->data_file  = util_alloc_filename( block_fs->path , block_fs->base_name , data_ext);
   block_fs->lock_file  = util_alloc_filename( block_fs->path , block_fs->base_name , lock_ext);
   block_fs->index_file = util_alloc_filename( block_fs->path , block_fs->base_name , index_ext);
+  block_fs->journal_file = util_alloc_filename( block_fs->path , block_fs->base_name , journal_ext);
 
   free( data_ext );
   free( lock_ext );
@@ -654,12 +779,23 @@ static block_fs_type * block_fs_alloc_empty( const char * mount_file ,
 
   block_fs->mount_file           = util_alloc_string_copy( mount_file );
   block_fs->fsync_interval       = fsync_interval;
+  block_fs->fsync_bytes          = 0;
+  block_fs->fsync_seconds        = 0;
+  block_fs->unsynced_writes      = 0;
+  block_fs->unsynced_bytes       = 0;
+  block_fs->last_fsync           = time( NULL );
   block_fs->block_size           = block_size;
   block_fs->max_cache_size       = max_cache_size;
   block_fs->total_cache_size     = 0;
   block_fs->max_total_cache_size = 512 * 1024 * 1024;  /* 512 MB */
 
   block_fs->fragmentation_limit = fragmentation_limit;
+  block_fs->codec               = BLOCK_FS_CODEC_NONE;
+  block_fs->journal_stream      = NULL;
+  block_fs->journal_id          = 0;
+  block_fs->journal_records     = 0;
+  block_fs->checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+  block_fs->mount_type          = BLOCK_FS_MOUNT_INDEX;
   util_alloc_file_components( mount_file , &block_fs->path , &block_fs->base_name, NULL );
   pthread_mutex_init( &block_fs->io_lock  , NULL);
   pthread_rwlock_init( &block_fs->rw_lock , NULL);
@@ -675,6 +811,7 @@ static block_fs_type * block_fs_alloc_empty( const char * mount_file ,
   block_fs->data_file   = NULL;
   block_fs->lock_file   = NULL;
   block_fs->index_file  = NULL;
+  block_fs->journal_file = NULL;
   block_fs_reinit( block_fs );
 
 
@@ -749,7 +886,7 @@ static bool block_fs_fseek_valid_node( block_fs_type * block_fs ) {
         */
         fseek__( block_fs->data_stream , -1 , SEEK_CUR);
         if (fread(&status , sizeof status , 1 , block_fs->data_stream) == 1) {
-          if (status == NODE_IN_USE || status == NODE_FREE_BYTE) {
+          if (status == NODE_IN_USE || status == NODE_IN_USE_CODEC || status == NODE_FREE_BYTE) {
             /*
                OK - we have found a valid identifier. We reposition to
                the start of this valid status id and return true.
@@ -874,6 +1011,10 @@ static void block_fs_preload( block_fs_type * block_fs ) { return; }
      2. The node is added to the block_fs instance as a free node, which can
         be recycled at a later stage.
 
+   The nodes discarded by block_fs_replay_journal() are already on the
+   free list with the correct size, for those only the header on disk
+   is updated.
+
    If the instance is not data owner (i.e. read-only) the function
    will return immediately.
 */
@@ -885,34 +1026,31 @@ static void block_fs_fix_nodes( block_fs_type * block_fs , long_vector_type * of
     {
       char * key = NULL;
       for (int inode = 0; inode < long_vector_size( offset_list ); inode++) {
-        bool new_node = false;
         long int node_offset = long_vector_iget( offset_list , inode );
-        file_node_type * file_node;
-        block_fs_fseek(block_fs , node_offset);
-        file_node = file_node_fread_alloc( block_fs->data_stream , &key );
-
-        if ((file_node->status == NODE_INVALID) || (file_node->status == NODE_WRITE_ACTIVE)) {
-          /* This node is really quite broken. */
-          long int node_end;
-          block_fs_fseek_valid_node( block_fs );
-          node_end             = ftell( block_fs->data_stream );
-          file_node->node_size = node_end - node_offset;
-        }
+        file_node_type * file_node = block_fs_lookup_free_node( block_fs , node_offset );
+
+        if (file_node == NULL) {
+          block_fs_fseek(block_fs , node_offset);
+          file_node = file_node_fread_alloc( block_fs->data_stream , &key );
+
+          if ((file_node->status == NODE_INVALID) || (file_node->status == NODE_WRITE_ACTIVE)) {
+            /* This node is really quite broken. */
+            long int node_end;
+            block_fs_fseek_valid_node( block_fs );
+            node_end             = ftell( block_fs->data_stream );
+            file_node->node_size = node_end - node_offset;
+          }
 
-        file_node->status      = NODE_FREE;
-        file_node->data_size   = 0;
-        file_node->data_offset = 0;
-        if (block_fs_lookup_free_node( block_fs , node_offset) == NULL) {
-          /* The node is already on the free list - we just change some metadata. */
-          new_node = true;
+          file_node->status      = NODE_FREE;
+          file_node->data_size   = 0;
+          file_node->data_offset = 0;
+          file_node->codec       = BLOCK_FS_CODEC_NONE;
           block_fs_install_node( block_fs , file_node );
           block_fs_insert_free_node( block_fs , file_node );
         }
 
         block_fs_fseek(block_fs , node_offset);
         file_node_fwrite( file_node , NULL , block_fs->data_stream );
-        if (!new_node)
-          file_node_free( file_node );
       }
       util_safe_free( key );
     }
@@ -922,6 +1060,401 @@ static void block_fs_fix_nodes( block_fs_type * block_fs , long_vector_type * of
 
 
 
+/*****************************************************************/
+/* The index journal, see the description of the format at the    */
+/* top of the file.                                               */
+/*****************************************************************/
+
+static unsigned int block_fs_journal_checksum( const char * data , size_t size ) {
+  unsigned int checksum = 2166136261u;    /* FNV-1a */
+  for (size_t i = 0; i < size; i++) {
+    checksum ^= (unsigned char) data[i];
+    checksum *= 16777619u;
+  }
+  return checksum;
+}
+
+
+/*
+  Appends one record to the journal; the record is not flushed, that
+  is done by block_fs_journal_flush(). When no journal is open this is
+  a noop.
+*/
+
+static void block_fs_journal_fwrite( block_fs_type * block_fs , journal_op_type op , const char * filename , const file_node_type * node ) {
+  if (block_fs->journal_stream != NULL) {
+    buffer_type * record = buffer_alloc( 128 );
+    buffer_fwrite_int( record , JOURNAL_RECORD_MAGIC );
+    buffer_fwrite_int( record , op );
+    buffer_fwrite_int( record , 0 );          /* Placeholder for the payload size. */
+    buffer_fwrite_string( record , filename );
+    file_node_buffer_dump_index( node , record );
+    {
+      char * data = buffer_get_data( record );
+      int payload_size = buffer_get_size( record ) - 3 * sizeof( int );
+      unsigned int checksum;
+
+      memcpy( &data[ 2 * sizeof( int ) ] , &payload_size , sizeof payload_size );
+      checksum = block_fs_journal_checksum( &data[ sizeof( int ) ] , buffer_get_size( record ) - sizeof( int ));
+      buffer_fwrite( record , &checksum , sizeof checksum , 1 );
+    }
+    util_fwrite( buffer_get_data( record ) , 1 , buffer_get_size( record ) , block_fs->journal_stream , __func__ );
+    buffer_free( record );
+    block_fs->journal_records++;
+  }
+}
+
+
+static void block_fs_journal_flush( block_fs_type * block_fs ) {
+  if (block_fs->journal_stream != NULL)
+    fflush( block_fs->journal_stream );
+}
+
+
+/*
+  The BEGIN record must reach the journal before any of the data of the
+  node reaches the data file.
+*/
+
+static void block_fs_journal_begin( block_fs_type * block_fs , const char * filename , const file_node_type * node ) {
+  block_fs_journal_fwrite( block_fs , JOURNAL_BEGIN , filename , node );
+  block_fs_journal_flush( block_fs );
+}
+
+
+/*
+  The COMMIT record is only written when the node has been flushed
+  from the data stream.
+*/
+
+static void block_fs_journal_commit( block_fs_type * block_fs , const char * filename , const file_node_type * node ) {
+  if (block_fs->journal_stream != NULL) {
+    fflush( block_fs->data_stream );
+    block_fs_journal_fwrite( block_fs , JOURNAL_COMMIT , filename , node );
+    block_fs_journal_flush( block_fs );
+  }
+}
+
+
+static void block_fs_journal_free( block_fs_type * block_fs , const char * filename , const file_node_type * node ) {
+  block_fs_journal_fwrite( block_fs , JOURNAL_FREE , filename , node );
+  block_fs_journal_flush( block_fs );
+}
+
+
+/*
+  Returns the journal_id from the header of the journal file, or 0 if
+  there is no valid journal file.
+*/
+
+static long int block_fs_journal_fread_id( const char * journal_file ) {
+  long int journal_id = 0;
+  FILE * stream = fopen( journal_file , "r");
+  if (stream != NULL) {
+    int id;
+    if (fread( &id , sizeof id , 1 , stream ) == 1 && (id == JOURNAL_MAGIC_INT)) {
+      if (fread( &journal_id , sizeof journal_id , 1 , stream ) != 1)
+        journal_id = 0;
+    }
+    fclose( stream );
+  }
+  return journal_id;
+}
+
+
+/*
+  Starts a new empty journal with the current journal_id; the new
+  journal is written to a temporary file which is renamed in place,
+  so there is always either the old or the new journal on disk.
+*/
+
+static void block_fs_journal_reset( block_fs_type * block_fs ) {
+  char * tmp_file = util_alloc_sprintf("%s.tmp" , block_fs->journal_file );
+  FILE * stream = util_fopen( tmp_file , "w");
+
+  util_fwrite_int( JOURNAL_MAGIC_INT , stream );
+  util_fwrite_long( block_fs->journal_id , stream );
+  fflush( stream );
+  fsync( fileno( stream ));
+  if (rename( tmp_file , block_fs->journal_file ) != 0)
+    util_abort("%s: failed to rename %s -> %s: %s \n",__func__ , tmp_file , block_fs->journal_file , strerror( errno ));
+
+  if (block_fs->journal_stream != NULL)
+    fclose( block_fs->journal_stream );
+  block_fs->journal_stream  = stream;
+  block_fs->journal_records = 0;
+  free( tmp_file );
+}
+
+
+/*
+  Closes the journal and removes the journal file; until the next
+  checkpoint nothing is journaled. This is used while rotating, where
+  the data file is replaced.
+*/
+
+static void block_fs_journal_discard( block_fs_type * block_fs ) {
+  if (block_fs->journal_stream != NULL) {
+    fclose( block_fs->journal_stream );
+    block_fs->journal_stream = NULL;
+    util_unlink_existing( block_fs->journal_file );
+  }
+}
+
+
+static void block_fs_journal_maybe_checkpoint( block_fs_type * block_fs ) {
+  if ((block_fs->journal_stream != NULL) &&
+      (block_fs->checkpoint_interval > 0) &&
+      (block_fs->journal_records >= block_fs->checkpoint_interval))
+    block_fs_checkpoint( block_fs );
+}
+
+
+static free_node_type * block_fs_find_free_node( const block_fs_type * block_fs , const file_node_type * file_node ) {
+  free_node_type * current = block_fs->free_nodes;
+  while (current != NULL && (current->file_node != file_node))
+    current = current->next;
+  return current;
+}
+
+
+/*
+  During replay a node which is neither in the index nor on the free
+  list has status NODE_WRITE_ACTIVE.
+*/
+
+static void block_fs_replay_detach_node( block_fs_type * block_fs , file_node_type * node , const char * filename ) {
+  if (node->status == NODE_FREE) {
+    free_node_type * free_node = block_fs_find_free_node( block_fs , node );
+    if (free_node != NULL)
+      block_fs_unlink_free_node( block_fs , free_node );
+  } else if (node->status == NODE_IN_USE) {
+    if (hash_has_key( block_fs->index , filename ) && (hash_get( block_fs->index , filename ) == node))
+      hash_del( block_fs->index , filename );
+  }
+  node->status = NODE_WRITE_ACTIVE;
+}
+
+
+static void block_fs_replay_free_node( block_fs_type * block_fs , file_node_type * node , hash_type * freed ) {
+  char * key = util_alloc_sprintf("%ld" , node->node_offset );
+  node->status      = NODE_FREE;
+  node->data_offset = 0;
+  node->data_size   = 0;
+  node->codec       = BLOCK_FS_CODEC_NONE;
+  node->raw_size    = 0;
+  block_fs_insert_free_node( block_fs , node );
+  hash_insert_ref( freed , key , node );
+  free( key );
+}
+
+
+static file_node_type * block_fs_replay_get_node( block_fs_type * block_fs , hash_type * node_map , const file_node_type * record_node ) {
+  char * key = util_alloc_sprintf("%ld" , record_node->node_offset );
+  file_node_type * node;
+
+  if (hash_has_key( node_map , key ))
+    node = hash_get( node_map , key );
+  else {
+    /* A node which has been created after the checkpoint. */
+    node = file_node_alloc( NODE_WRITE_ACTIVE , record_node->node_offset , record_node->node_size );
+    block_fs_install_node( block_fs , node );
+    hash_insert_ref( node_map , key , node );
+  }
+  free( key );
+  return node;
+}
+
+
+/*
+  Checks that the header and end tag of a node in the data file agree
+  with the journal; a COMMIT record can in principle be on disk without
+  the data if the machine went down between two fsync() calls.
+*/
+
+static bool block_fs_verify_node( block_fs_type * block_fs , const file_node_type * node , const char * filename ) {
+  bool valid = false;
+  char * key = NULL;
+  file_node_type * disk_node;
+
+  block_fs_fseek( block_fs , node->node_offset );
+  disk_node = file_node_fread_alloc( block_fs->data_stream , &key );
+  if (disk_node != NULL) {
+    if ((disk_node->status    == NODE_IN_USE)     &&
+        (disk_node->node_size == node->node_size) &&
+        (disk_node->data_size == node->data_size) &&
+        (disk_node->codec     == node->codec)     &&
+        util_string_equal( key , filename ))
+      valid = file_node_verify_end_tag( disk_node , block_fs->data_stream );
+    file_node_free( disk_node );
+  }
+  util_safe_free( key );
+  return valid;
+}
+
+
+static void block_fs_replay_record( block_fs_type * block_fs , journal_op_type op , const char * filename , const file_node_type * record_node ,
+                                    hash_type * node_map , hash_type * pending , hash_type * committed , hash_type * freed ) {
+  file_node_type * node = block_fs_replay_get_node( block_fs , node_map , record_node );
+  char * key = util_alloc_sprintf("%ld" , node->node_offset );
+
+  switch (op) {
+  case(JOURNAL_BEGIN):
+    block_fs_replay_detach_node( block_fs , node , filename );
+    hash_insert_ref( pending , key , node );
+    break;
+  case(JOURNAL_COMMIT):
+    block_fs_replay_detach_node( block_fs , node , filename );
+    if (hash_has_key( block_fs->index , filename )) {
+      /* The old node of a batch write; it is released by a later FREE record. */
+      file_node_type * old_node = hash_pop( block_fs->index , filename );
+      block_fs_replay_free_node( block_fs , old_node , freed );
+    }
+    node->status      = NODE_IN_USE;
+    node->data_offset = record_node->data_offset;
+    node->data_size   = record_node->data_size;
+    node->codec       = record_node->codec;
+    node->raw_size    = record_node->raw_size;
+    block_fs_insert_index_node( block_fs , filename , node );
+    hash_insert_ref( committed , filename , node );
+    if (hash_has_key( pending , key ))
+      hash_del( pending , key );
+    break;
+  case(JOURNAL_FREE):
+    if (node->status != NODE_FREE) {
+      block_fs_replay_detach_node( block_fs , node , filename );
+      block_fs_replay_free_node( block_fs , node , freed );
+    }
+    if (hash_has_key( pending , key ))
+      hash_del( pending , key );
+    break;
+  default:
+    util_abort("%s: journal operation:%d not recognized \n",__func__ , op);
+  }
+  free( key );
+}
+
+
+/*
+  Replays the journal on top of the index which has just been loaded.
+  The journal is read until the end, or until the first record which
+  is incomplete or has a wrong checksum. Afterwards:
+
+    1. Nodes with a BEGIN record and no COMMIT are discarded.
+    2. The nodes which have been committed are verified against the
+       header in the data file.
+
+  The nodes which are free when the replay is complete are added to
+  @fix_nodes, to ensure that the free header is on disk; a node can be
+  freed and then reused for another file later in the journal.
+  Returns the number of records replayed; @complete is set to false if
+  the journal ended with a torn record.
+*/
+
+static int block_fs_replay_journal( block_fs_type * block_fs , long_vector_type * fix_nodes , bool * complete) {
+  int num_records = 0;
+  buffer_type * buffer = buffer_fread_alloc( block_fs->journal_file );
+  hash_type * node_map  = NULL;
+  hash_type * pending   = hash_alloc();
+  hash_type * committed = hash_alloc();
+  hash_type * freed     = hash_alloc();
+
+  buffer_fskip( buffer , sizeof( int ) + sizeof( long ));
+  while (true) {
+    const char * data = buffer_get_data( buffer );
+    size_t record_start = buffer_get_offset( buffer );
+    int magic , op , payload_size;
+    unsigned int checksum;
+
+    if (buffer_get_remaining_size( buffer ) < 3 * sizeof( int ))
+      break;
+
+    memcpy( &magic , &data[ record_start ] , sizeof magic );
+    memcpy( &op , &data[ record_start + sizeof( int ) ] , sizeof op );
+    memcpy( &payload_size , &data[ record_start + 2 * sizeof( int ) ] , sizeof payload_size );
+    if ((magic != JOURNAL_RECORD_MAGIC) || (payload_size < 0) ||
+        (buffer_get_remaining_size( buffer ) < 3 * sizeof( int ) + payload_size + sizeof checksum))
+      break;
+
+    memcpy( &checksum , &data[ record_start + 3 * sizeof( int ) + payload_size ] , sizeof checksum );
+    if (checksum != block_fs_journal_checksum( &data[ record_start + sizeof( int ) ] , 2 * sizeof( int ) + payload_size ))
+      break;
+
+    if (node_map == NULL) {
+      node_map = hash_alloc();
+      for (int i = 0; i < vector_get_size( block_fs->file_nodes ); i++) {
+        file_node_type * node = vector_iget( block_fs->file_nodes , i );
+        char * key = util_alloc_sprintf("%ld" , node->node_offset );
+        hash_insert_ref( node_map , key , node );
+        free( key );
+      }
+    }
+
+    buffer_fskip( buffer , 3 * sizeof( int ));
+    {
+      char * filename = util_alloc_string_copy( buffer_fread_string( buffer ));
+      file_node_type * record_node = file_node_index_buffer_fread_alloc( buffer , INDEX_FORMAT_VERSION );
+
+      block_fs_replay_record( block_fs , op , filename , record_node , node_map , pending , committed , freed );
+      file_node_free( record_node );
+      free( filename );
+    }
+    buffer_fseek( buffer , record_start + 3 * sizeof( int ) + payload_size + sizeof checksum , SEEK_SET );
+    num_records++;
+  }
+  *complete = (buffer_get_remaining_size( buffer ) == 0);
+
+  /* 1: Writes which were interrupted. */
+  {
+    hash_iter_type * iter = hash_iter_alloc( pending );
+    while (!hash_iter_is_complete( iter )) {
+      file_node_type * node = hash_iter_get_next_value( iter );
+      fprintf(stderr,"** Warning:: file system was prematurely shut down while writing node in %s/%ld - will be discarded.\n",block_fs->data_file , node->node_offset);
+      block_fs_replay_free_node( block_fs , node , freed );
+    }
+    hash_iter_free( iter );
+  }
+
+  /* 2: Verifying the committed nodes. */
+  {
+    hash_iter_type * iter = hash_iter_alloc( committed );
+    while (!hash_iter_is_complete( iter )) {
+      const char * filename = hash_iter_get_next_key( iter );
+      file_node_type * node = hash_get( committed , filename );
+
+      /* The node might have been released, and even reused for another file, later in the journal. */
+      if (hash_has_key( block_fs->index , filename ) && (hash_get( block_fs->index , filename ) == node)) {
+        if (!block_fs_verify_node( block_fs , node , filename )) {
+          fprintf(stderr,"** Warning found node:%s at offset:%ld which was incomplete - discarded.\n",filename , node->node_offset);
+          hash_del( block_fs->index , filename );
+          block_fs_replay_free_node( block_fs , node , freed );
+        }
+      }
+    }
+    hash_iter_free( iter );
+  }
+
+  {
+    hash_iter_type * iter = hash_iter_alloc( freed );
+    while (!hash_iter_is_complete( iter )) {
+      const file_node_type * node = hash_iter_get_next_value( iter );
+      if (node->status == NODE_FREE)
+        long_vector_append( fix_nodes , node->node_offset );
+    }
+    hash_iter_free( iter );
+  }
+
+  if (node_map != NULL)
+    hash_free( node_map );
+  hash_free( freed );
+  hash_free( committed );
+  hash_free( pending );
+  buffer_free( buffer );
+  return num_records;
+}
+
+
+
 static void block_fs_build_index( block_fs_type * block_fs , long_vector_type * error_offset ) {
   char * filename = NULL;
   file_node_type * file_node;
@@ -947,6 +1480,19 @@ static void block_fs_build_index( block_fs_type * block_fs , long_vector_type *
           block_fs_install_node( block_fs , file_node );
           switch(file_node->status) {
           case(NODE_IN_USE):
+            if (hash_has_key( block_fs->index , filename )) {
+              /*
+                 A batch write was interrupted before the old node
+                 was released, see block_fs_fwrite_batch(); the node
+                 with the highest offset is the newest.
+              */
+              file_node_type * old_node = hash_get( block_fs->index , filename );
+              old_node->status      = NODE_FREE;
+              old_node->data_offset = 0;
+              old_node->data_size   = 0;
+              old_node->codec       = BLOCK_FS_CODEC_NONE;
+              block_fs_insert_free_node( block_fs , old_node );
+            }
             block_fs_insert_index_node(block_fs , filename , file_node);
             break;
           case(NODE_FREE):
@@ -984,26 +1530,38 @@ static void block_fs_build_index( block_fs_type * block_fs , long_vector_type *
 */
 
 
-static bool block_fs_load_index( block_fs_type * block_fs ) {
+static bool block_fs_load_index( block_fs_type * block_fs , bool * journal_valid ) {
   stat_type data_stat;
+  *journal_valid = false;
   if (fstat( block_fs->data_fd , &data_stat) == 0) {
     FILE * stream = fopen( block_fs->index_file , "r");
     if (stream != NULL) {
       int    id          = util_fread_int( stream );
       int    version     = util_fread_int( stream );
       time_t index_mtime = util_fread_time_t( stream );
+      long int journal_id = 0;
 
       time_t data_mtime  = data_stat.st_mtime;
+      if ((id == INDEX_MAGIC_INT) && (version >= 3))
+        journal_id = util_fread_long( stream );
       fclose( stream );
 
+      if (journal_id != 0)
+        *journal_valid = (journal_id == block_fs_journal_fread_id( block_fs->journal_file ));
+
       if ((id == INDEX_MAGIC_INT) &&               /* This is indeed an index file. */
-          (version == INDEX_FORMAT_VERSION) &&     /* The version on disk agrees with this version. */
-          (index_mtime == data_mtime)) {           /* The time stamp agrees with the time stamp of the data. */
+          (version >= 1) &&                        /* The version on disk is one we can read. */
+          (version <= INDEX_FORMAT_VERSION) &&
+          ((index_mtime == data_mtime) ||          /* The time stamp agrees with the time stamp of the data, */
+           *journal_valid)) {                      /* or the changes since the index was written are in the journal. */
 
         /* Read the whole index file in one single read operation. */
         buffer_type * buffer = buffer_fread_alloc( block_fs->index_file );
 
         buffer_fskip( buffer , sizeof( time_t ) + 2 * sizeof( int ));
+        if (version >= 3)
+          buffer_fskip( buffer , sizeof( long ));
+        block_fs->journal_id = journal_id;
         /*1: Loading all the active nodes. */
         {
           int num_active_nodes = buffer_fread_int( buffer );
@@ -1011,7 +1569,7 @@ static bool block_fs_load_index( block_fs_type * block_fs ) {
 
           for (int i=0; i < num_active_nodes; i++) {
             const char * filename = buffer_fread_string( buffer );
-            file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer );
+            file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer , version );
             block_fs_install_node( block_fs , file_node);
             block_fs_insert_index_node(block_fs , filename , file_node);
           }
@@ -1021,7 +1579,7 @@ static bool block_fs_load_index( block_fs_type * block_fs ) {
         {
           int num_free_nodes = buffer_fread_int( buffer );
           for (int i=0; i < num_free_nodes; i++) {
-            file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer );
+            file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer , version );
             block_fs_install_node( block_fs , file_node);
             block_fs_insert_free_node(block_fs , file_node);
           }
@@ -1033,6 +1591,7 @@ static bool block_fs_load_index( block_fs_type * block_fs ) {
     }
   }
   /** No index was loaded - for whatever reason. */
+  *journal_valid = false;
   return false;
 }
 
@@ -1075,12 +1634,25 @@ block_fs_type * block_fs_mount( const char * mount_file ,
       block_fs_fwrite_mount_info__( mount_file , 0 );
     {
       long_vector_type * fix_nodes = long_vector_alloc(0 , 0);
+      bool journal_clean = false;
       block_fs = block_fs_alloc_empty( mount_file , block_size , max_cache_size , fragmentation_limit , fsync_interval , read_only, use_lockfile);
       /* We build up the index & free_nodes_list based on the header/index information embedded in the datafile. */
       block_fs_open_data( block_fs , false );
       if (block_fs->data_stream != NULL) {
-        if (!block_fs_load_index( block_fs ))
+        bool journal_valid;
+        if (block_fs_load_index( block_fs , &journal_valid )) {
+          if (journal_valid) {
+            /* After an unclean shutdown only the tail since the last checkpoint is replayed. */
+            bool complete;
+            int num_records = block_fs_replay_journal( block_fs , fix_nodes , &complete );
+            if (num_records > 0)
+              block_fs->mount_type = BLOCK_FS_MOUNT_JOURNAL;
+            journal_clean = (complete && (num_records == 0));
+          }
+        } else {
           block_fs_build_index( block_fs , fix_nodes );
+          block_fs->mount_type = BLOCK_FS_MOUNT_SCAN;
+        }
 
         fclose(block_fs->data_stream);
       }
@@ -1088,6 +1660,18 @@ block_fs_type * block_fs_mount( const char * mount_file ,
       block_fs_open_data( block_fs , block_fs->data_owner ); /* The data_stream is opened for reading AND writing (IFF we are data_owner - otherwise it is still read only) */
       block_fs_fix_nodes( block_fs , fix_nodes );
       long_vector_free( fix_nodes );
+
+      if (block_fs->data_owner) {
+        /* The journal_id must never be reused, also not when the index has been rebuilt. */
+        long int file_id = block_fs_journal_fread_id( block_fs->journal_file );
+        if (file_id > block_fs->journal_id)
+          block_fs->journal_id = file_id;
+
+        if (journal_clean)
+          block_fs->journal_stream = util_fopen( block_fs->journal_file , "a");
+        else
+          block_fs_checkpoint( block_fs );
+      }
     }
   }
   if (preload) block_fs_preload( block_fs );
@@ -1116,6 +1700,22 @@ static void block_fs_unlink_free_node( block_fs_type * block_fs , free_node_type
 
 
 
+/**
+   Returns the first free node which can hold @min_size bytes and is
+   located after @min_offset in the data file, or NULL if there is no
+   such node.
+*/
+
+static free_node_type * block_fs_find_usable_free_node( const block_fs_type * block_fs , size_t min_size , long int min_offset) {
+  free_node_type * current = block_fs->free_nodes;
+
+  while (current != NULL && ((current->file_node->node_size < min_size) || (current->file_node->node_offset <= min_offset))) {
+    current = current->next;
+  }
+  return current;
+}
+
+
 /**
    This function first checks the free nodes if any of them can be
    used, otherwise a new node is created.
@@ -1123,11 +1723,8 @@ static void block_fs_unlink_free_node( block_fs_type * block_fs , free_node_type
 
 static file_node_type * block_fs_get_new_node( block_fs_type * block_fs , const char * filename , size_t min_size) {
 
-  free_node_type * current = block_fs->free_nodes;
+  free_node_type * current = block_fs_find_usable_free_node( block_fs , min_size , -1 );
 
-  while (current != NULL && (current->file_node->node_size < min_size)) {
-    current = current->next;
-  }
   if (current != NULL) {
     /*
        Current points to a file_node which can be used. Before we return current we must:
@@ -1193,7 +1790,9 @@ static void block_fs_unlink_file__( block_fs_type * block_fs , const char * file
   node->status      = NODE_FREE;
   node->data_offset = 0;
   node->data_size   = 0;
+  node->codec       = BLOCK_FS_CODEC_NONE;
   if (block_fs->data_stream != NULL) {
+    block_fs_journal_free( block_fs , filename , node );
     fsync( block_fs->data_fd );
     block_fs_fseek(block_fs , node->node_offset);
     file_node_fwrite( node , NULL , block_fs->data_stream );
@@ -1216,6 +1815,7 @@ void block_fs_unlink_file( block_fs_type * block_fs , const char * filename) {
   block_fs_unlink_file__( block_fs , filename );
   if (block_fs_get_fragmentation( block_fs ) > block_fs->fragmentation_limit)
     block_fs_rotate__( block_fs );
+  block_fs_journal_maybe_checkpoint( block_fs );
 
   block_fs_release_rwlock( block_fs );
 }
@@ -1260,13 +1860,267 @@ bool block_fs_rotate( block_fs_type * block_fs , double fragmentation_limit) {
 void block_fs_fsync( block_fs_type * block_fs ) {
   if (block_fs->data_owner) {
     //fdatasync( block_fs->data_fd );
+    fflush( block_fs->data_stream );
     fsync( block_fs->data_fd );
     block_fs_fseek( block_fs , block_fs->data_file_size );
     ftell( block_fs->data_stream );
+
+    /* The journal is synced after the data it refers to. */
+    if (block_fs->journal_stream != NULL) {
+      fflush( block_fs->journal_stream );
+      fsync( fileno( block_fs->journal_stream ));
+    }
+  }
+  block_fs->unsynced_writes = 0;
+  block_fs->unsynced_bytes  = 0;
+  block_fs->last_fsync      = time( NULL );
+}
+
+
+/**
+   The group commit policy: instead of calling fsync() after every
+   write the writes are grouped, and fsync() is called when one of the
+   thresholds has been passed:
+
+     fsync_interval : the number of writes since the last fsync().
+     fsync_bytes    : the number of bytes written since the last fsync().
+     fsync_seconds  : the time since the last fsync(); this is only
+                      checked when writing, there is no background
+                      thread.
+
+   A threshold value of zero disables that criterion. A write batch
+   counts as one write. The group commit does not change the crash
+   consistency of the filesystem; every node is still written between
+   the NODE_WRITE_ACTIVE_START / NODE_WRITE_ACTIVE_END tags, and
+   incomplete nodes are discarded by block_fs_build_index() when the
+   filesystem is mounted after a crash. What is lost is at most the
+   writes since the last fsync().
+*/
+
+void block_fs_set_fsync_policy( block_fs_type * block_fs , int fsync_interval , size_t fsync_bytes , double fsync_seconds ) {
+  block_fs->fsync_interval = fsync_interval;
+  block_fs->fsync_bytes    = fsync_bytes;
+  block_fs->fsync_seconds  = fsync_seconds;
+}
+
+
+static void block_fs_group_commit( block_fs_type * block_fs , int num_writes , size_t num_bytes ) {
+  block_fs->write_count     += num_writes;
+  block_fs->unsynced_writes += num_writes;
+  block_fs->unsynced_bytes  += num_bytes;
+
+  if ((block_fs->fsync_interval && (block_fs->unsynced_writes >= block_fs->fsync_interval)) ||
+      (block_fs->fsync_bytes && (block_fs->unsynced_bytes >= block_fs->fsync_bytes)) ||
+      ((block_fs->fsync_seconds > 0) && (difftime( time( NULL ) , block_fs->last_fsync ) >= block_fs->fsync_seconds)))
+    block_fs_fsync( block_fs );
+}
+
+
+
+
+/*****************************************************************/
+/* Codecs for the node payload.                                  */
+/*****************************************************************/
+
+/*
+  The BLOCK_FS_CODEC_SHUFFLE_RLE codec first splits the payload in
+  eight byte planes, i.e. byte 0 of all 8 byte words, then byte 1 of
+  all words and so on, with the trailing size % 8 bytes last, and then
+  run length encodes the result. For arrays of double the planes with
+  the sign and exponent bytes are very repetitive, and a vector of
+  constant values collapses completely. The run length encoding is:
+
+     c in [0,127]   : c + 1 literal bytes follow.
+     c in [128,255] : the next byte should be repeated c - 128 + 3 times.
+*/
+
+#define RLE_MIN_RUN      3
+#define RLE_MAX_RUN    130
+#define RLE_MAX_LITERAL 128
+#define SHUFFLE_WORD      8
+
+
+static void block_fs_shuffle( const unsigned char * src , int size , unsigned char * target ) {
+  const int num_words = size / SHUFFLE_WORD;
+  int pos = 0;
+  for (int plane = 0; plane < SHUFFLE_WORD; plane++)
+    for (int word = 0; word < num_words; word++)
+      target[pos++] = src[ word * SHUFFLE_WORD + plane ];
+
+  memcpy( &target[pos] , &src[pos] , size - pos );
+}
+
+
+/*
+  Returns the number of bytes written to @target, or -1 if the
+  encoded data does not fit in @target_size bytes.
+*/
+
+static int block_fs_rle_encode( const unsigned char * src , int size , unsigned char * target , int target_size ) {
+  int pos = 0;
+  int out = 0;
+  while (pos < size) {
+    int run = 1;
+    while ((pos + run < size) && (run < RLE_MAX_RUN) && (src[pos + run] == src[pos]))
+      run++;
+
+    if (run >= RLE_MIN_RUN) {
+      if (out + 2 > target_size)
+        return -1;
+
+      target[out++] = 128 + run - RLE_MIN_RUN;
+      target[out++] = src[pos];
+      pos += run;
+    } else {
+      int literal_start = pos;
+      int literal_size  = 0;
+      while ((pos < size) && (literal_size < RLE_MAX_LITERAL)) {
+        if ((pos + 2 < size) && (src[pos] == src[pos + 1]) && (src[pos] == src[pos + 2]))
+          break;
+        pos++;
+        literal_size++;
+      }
+
+      if (out + 1 + literal_size > target_size)
+        return -1;
+
+      target[out++] = literal_size - 1;
+      memcpy( &target[out] , &src[literal_start] , literal_size );
+      out += literal_size;
+    }
+  }
+  return out;
+}
+
+
+/*
+  Decodes the run length encoded data and writes the bytes directly
+  to their unshuffled position in @target, i.e. without going through
+  a temporary copy of the shuffled data.
+*/
+
+static void block_fs_rle_decode( const unsigned char * src , int size , unsigned char * target , int target_size ) {
+  const int num_words = target_size / SHUFFLE_WORD;
+  int plane = (num_words > 0) ? 0 : SHUFFLE_WORD;
+  int word  = 0;
+  int out   = 0;
+  int pos   = 0;
+
+  while (pos < size) {
+    int control = src[pos++];
+    int count;
+    bool repeat;
+
+    if (control < 128) {
+      count  = control + 1;
+      repeat = false;
+    } else {
+      count  = control - 128 + RLE_MIN_RUN;
+      repeat = true;
+    }
+
+    if ((out + count > target_size) || (pos + (repeat ? 1 : count) > size))
+      util_abort("%s: corrupt run length encoded data \n",__func__);
+
+    for (int i = 0; i < count; i++) {
+      unsigned char byte = repeat ? src[pos] : src[pos + i];
+      if (plane < SHUFFLE_WORD) {
+        target[ word * SHUFFLE_WORD + plane ] = byte;
+        word++;
+        if (word == num_words) {
+          word = 0;
+          plane++;
+        }
+      } else
+        target[out] = byte;
+      out++;
+    }
+    pos += repeat ? 1 : count;
+  }
+
+  if (out != target_size)
+    util_abort("%s: decoded size:%d - expected:%d \n",__func__ , out , target_size);
+}
+
+
+/*
+  Will encode @data_size bytes from @ptr with @codec and store the
+  result in @encoded. The return value is the codec which was actually
+  used; if the encoded data is not smaller than the input the data
+  should be stored as is, and BLOCK_FS_CODEC_NONE is returned.
+*/
+
+static block_fs_codec_type block_fs_encode( block_fs_codec_type codec , const void * ptr , int data_size , buffer_type * encoded) {
+  buffer_clear( encoded );
+  if (data_size == 0)
+    return BLOCK_FS_CODEC_NONE;
+
+  switch (codec) {
+  case( BLOCK_FS_CODEC_NONE ):
+    return BLOCK_FS_CODEC_NONE;
+  case( BLOCK_FS_CODEC_ZLIB ):
+    {
+      size_t compressed_size = buffer_fwrite_compressed( encoded , ptr , data_size );
+      if (compressed_size >= (size_t) data_size)
+        return BLOCK_FS_CODEC_NONE;
+    }
+    return BLOCK_FS_CODEC_ZLIB;
+  case( BLOCK_FS_CODEC_SHUFFLE_RLE ):
+    {
+      unsigned char * shuffled = util_malloc( data_size );
+      unsigned char * target   = util_malloc( data_size );
+      int encoded_size;
+
+      block_fs_shuffle( ptr , data_size , shuffled );
+      encoded_size = block_fs_rle_encode( shuffled , data_size , target , data_size - 1 );
+      if (encoded_size > 0)
+        buffer_fwrite( encoded , target , 1 , encoded_size );
+
+      free( target );
+      free( shuffled );
+      if (encoded_size < 0)
+        return BLOCK_FS_CODEC_NONE;
+    }
+    return BLOCK_FS_CODEC_SHUFFLE_RLE;
+  default:
+    util_abort("%s: codec:%d not recognized \n",__func__ , codec);
+    return BLOCK_FS_CODEC_NONE;
+  }
+}
+
+
+/*
+  Decodes the content of @stored - which should be positioned at the
+  start of the stored data - into @target which must have room for
+  @raw_size bytes.
+*/
+
+static void block_fs_decode( block_fs_codec_type codec , buffer_type * stored , void * target , int raw_size ) {
+  switch (codec) {
+  case( BLOCK_FS_CODEC_ZLIB ):
+    {
+      size_t decoded_size = buffer_fread_compressed( stored , buffer_get_remaining_size( stored ) , target , raw_size );
+      if (decoded_size != (size_t) raw_size)
+        util_abort("%s: decoded size:%zd - expected:%d \n",__func__ , decoded_size , raw_size);
+    }
+    break;
+  case( BLOCK_FS_CODEC_SHUFFLE_RLE ):
+    block_fs_rle_decode( buffer_get_data( stored ) , buffer_get_size( stored ) , target , raw_size );
+    break;
+  default:
+    util_abort("%s: codec:%d not recognized - data written by a newer version?\n",__func__ , codec);
   }
 }
 
 
+void block_fs_set_codec( block_fs_type * block_fs , block_fs_codec_type codec ) {
+  block_fs->codec = codec;
+}
+
+
+block_fs_codec_type block_fs_get_codec( const block_fs_type * block_fs ) {
+  return block_fs->codec;
+}
 
 
 /**
@@ -1289,7 +2143,31 @@ void block_fs_fsync( block_fs_type * block_fs ) {
 */
 
 
-static void block_fs_fwrite__(block_fs_type * block_fs , const char * filename , file_node_type * node , const void * ptr , int data_size) {
+static void block_fs_fwrite_node__(block_fs_type * block_fs , const char * filename , file_node_type * node , const void * ptr , int data_size , block_fs_codec_type codec , int raw_size) {
+  block_fs_fseek(block_fs , node->node_offset);
+  node->status      = NODE_IN_USE;
+  node->data_size   = data_size;
+  node->codec       = codec;
+  node->raw_size    = raw_size;
+  file_node_set_data_offset( node , filename );
+  block_fs_journal_begin( block_fs , filename , node );
+
+  /* This marks the node section in the datafile as write in progress with: NODE_WRITE_ACTIVE_START ... NODE_WRITE_ACTIVE_END */
+  file_node_init_fwrite( node , block_fs->data_stream );
+
+  /* Writes the actual data content. */
+  block_fs_fseek_node_data(block_fs , node);
+  util_fwrite( ptr , 1 , data_size , block_fs->data_stream , __func__);
+
+  /* Writes the file node header data, including the NODE_END_TAG. */
+  file_node_fwrite( node , filename , block_fs->data_stream );
+  block_fs_journal_commit( block_fs , filename , node );
+
+  block_fs_update_cache_node( block_fs , node , data_size , ptr);
+}
+
+
+static void block_fs_fwrite__(block_fs_type * block_fs , const char * filename , file_node_type * node , const void * ptr , int data_size , block_fs_codec_type codec , int raw_size) {
 
 #ifdef ENABLE_CACHE
   if ((node->cache_size == data_size) && (memcmp( ptr , node->cache , data_size ) == 0))
@@ -1301,35 +2179,22 @@ static void block_fs_fwrite__(block_fs_type * block_fs , const char * filename ,
 #endif
 
   else {
-    block_fs_fseek(block_fs , node->node_offset);
-    node->status      = NODE_IN_USE;
-    node->data_size   = data_size;
-    file_node_set_data_offset( node , filename );
-
-    /* This marks the node section in the datafile as write in progress with: NODE_WRITE_ACTIVE_START ... NODE_WRITE_ACTIVE_END */
-    file_node_init_fwrite( node , block_fs->data_stream );
-
-    /* Writes the actual data content. */
-    block_fs_fseek_node_data(block_fs , node);
-    util_fwrite( ptr , 1 , data_size , block_fs->data_stream , __func__);
-
-    /* Writes the file node header data, including the NODE_END_TAG. */
-    file_node_fwrite( node , filename , block_fs->data_stream );
-
-    block_fs_update_cache_node( block_fs , node , data_size , ptr);
-    block_fs->write_count++;
-    if (block_fs->fsync_interval && ((block_fs->write_count % block_fs->fsync_interval) == 0))
-      block_fs_fsync( block_fs );
-
+    block_fs_fwrite_node__( block_fs , filename , node , ptr , data_size , codec , raw_size );
+    block_fs_group_commit( block_fs , 1 , data_size );
   }
 }
 
 
 
-static void block_fs_fwrite_file_unlocked(block_fs_type * block_fs , const char * filename , const void * ptr , size_t data_size) {
+/*
+  Writes @data_size bytes of data which have already been encoded
+  with @codec; @raw_size is the size of the data after decoding.
+*/
+
+static void block_fs_fwrite_file_unlocked(block_fs_type * block_fs , const char * filename , const void * ptr , size_t data_size , block_fs_codec_type codec , int raw_size) {
   file_node_type * file_node;
   bool   new_node = true;
-  size_t min_size = data_size + file_node_header_size( filename );
+  size_t min_size = data_size + file_node_header_size( filename , codec );
 
   if (block_fs_has_file__( block_fs , filename )) {
     file_node = hash_get( block_fs->index , filename );
@@ -1352,24 +2217,44 @@ static void block_fs_fwrite_file_unlocked(block_fs_type * block_fs , const char
 
 
   /* The actual writing ... */
-  block_fs_fwrite__( block_fs , filename , file_node , ptr , data_size);
+  block_fs_fwrite__( block_fs , filename , file_node , ptr , data_size , codec , raw_size);
   if (new_node)
     block_fs_insert_index_node(block_fs , filename , file_node);
 }
 
 
 
+/*
+  The encoding is done before the write lock is taken, so several
+  threads can encode their data concurrently.
+*/
+
 void block_fs_fwrite_file(block_fs_type * block_fs , const char * filename , const void * ptr , size_t data_size) {
+  block_fs_codec_type codec = BLOCK_FS_CODEC_NONE;
+  buffer_type * encoded = NULL;
+
+  if (block_fs->codec != BLOCK_FS_CODEC_NONE) {
+    encoded = buffer_alloc( data_size / 2 + 64 );
+    codec = block_fs_encode( block_fs->codec , ptr , data_size , encoded );
+  }
+
   block_fs_aquire_wlock( block_fs );
   {
-    block_fs_fwrite_file_unlocked( block_fs , filename , ptr , data_size );
+    if (codec == BLOCK_FS_CODEC_NONE)
+      block_fs_fwrite_file_unlocked( block_fs , filename , ptr , data_size , codec , data_size );
+    else
+      block_fs_fwrite_file_unlocked( block_fs , filename , buffer_get_data( encoded ) , buffer_get_size( encoded ) , codec , data_size );
 
     /* OKAY - this is going to take some time ... */
     if ((block_fs->free_size * 1.0 / block_fs->data_file_size) > block_fs->fragmentation_limit)
       block_fs_rotate__( block_fs );
 
+    block_fs_journal_maybe_checkpoint( block_fs );
   }
   block_fs_release_rwlock( block_fs );
+
+  if (encoded != NULL)
+    buffer_free( encoded );
 }
 
 
@@ -1385,6 +2270,202 @@ void block_fs_fwrite_buffer(block_fs_type * block_fs , const char * filename , c
 }
 
 
+/**
+   Writes all the buffers in @buffers, with the corresponding names in
+   @filenames, holding the write lock only once. Nodes which fit in
+   their existing node are overwritten in place, and nodes which fit in
+   a free node are written there as in block_fs_fwrite_file(); all the
+   other nodes are laid out in one contiguous region at the end of the
+   data file, which is written with one write call. If the same
+   filename occurs several times the last buffer wins.
+
+   The crash consistency is as for block_fs_fwrite_file():
+
+     1. The region is written with the NODE_WRITE_ACTIVE_START /
+        NODE_WRITE_ACTIVE_END tags around every node.
+
+     2. The real node headers and NODE_END_TAG are written.
+
+     3. The old nodes of the filenames which have been moved to the
+        new region are marked as free.
+
+   If the process dies between 2 and 3 there will be two nodes in use
+   with the same filename; block_fs_build_index() will then use the
+   one with the highest offset. For that reason a free node is only
+   reused for a filename which already has a node if the free node is
+   located after the old node.
+*/
+
+void block_fs_fwrite_batch( block_fs_type * block_fs , const stringlist_type * filenames , const vector_type * buffers ) {
+  const int size = stringlist_get_size( filenames );
+  buffer_type ** encoded        = util_calloc( size , sizeof * encoded );
+  block_fs_codec_type * codec   = util_calloc( size , sizeof * codec );
+  hash_type * last_index        = hash_alloc();
+
+  if (vector_get_size( buffers ) != size)
+    util_abort("%s: size mismatch - %d filenames and %d buffers \n",__func__ , size , vector_get_size( buffers ));
+
+  for (int i = 0; i < size; i++) {
+    const buffer_type * buffer = vector_iget_const( buffers , i );
+    codec[i] = BLOCK_FS_CODEC_NONE;
+    if (block_fs->codec != BLOCK_FS_CODEC_NONE) {
+      encoded[i] = buffer_alloc( buffer_get_size( buffer ) / 2 + 64 );
+      codec[i] = block_fs_encode( block_fs->codec , buffer_get_data( buffer ) , buffer_get_size( buffer ) , encoded[i] );
+    }
+    hash_insert_int( last_index , stringlist_iget( filenames , i ) , i );
+  }
+
+  block_fs_aquire_wlock( block_fs );
+  {
+    vector_type * region_nodes     = vector_alloc_new();
+    vector_type * superseded_nodes = vector_alloc_new();
+    stringlist_type * superseded_names = stringlist_alloc_new();
+    int_vector_type * region_items = int_vector_alloc( 0 , 0 );
+    long int region_offset         = block_fs->data_file_size;
+    size_t   total_size            = 0;
+
+    for (int i = 0; i < size; i++) {
+      const char * filename = stringlist_iget( filenames , i );
+      const buffer_type * buffer = vector_iget_const( buffers , i );
+      const void * ptr = (codec[i] == BLOCK_FS_CODEC_NONE) ? buffer_get_data( buffer ) : buffer_get_data( encoded[i] );
+      int data_size    = (codec[i] == BLOCK_FS_CODEC_NONE) ? buffer_get_size( buffer ) : buffer_get_size( encoded[i] );
+      size_t min_size  = data_size + file_node_header_size( filename , codec[i] );
+      file_node_type * old_node = NULL;
+
+      if (hash_get_int( last_index , filename ) != i)
+        continue;
+
+      total_size += data_size;
+      if (block_fs_has_file__( block_fs , filename ))
+        old_node = hash_get( block_fs->index , filename );
+
+      if ((old_node != NULL) && (old_node->node_size >= min_size))
+        block_fs_fwrite_node__( block_fs , filename , old_node , ptr , data_size , codec[i] , buffer_get_size( buffer ));
+      else {
+        file_node_type * file_node;
+        free_node_type * free_node = block_fs_find_usable_free_node( block_fs , min_size , (old_node == NULL) ? -1 : old_node->node_offset );
+        int node_size;
+
+        if (old_node != NULL) {
+          hash_del( block_fs->index , filename );
+          vector_append_ref( superseded_nodes , old_node );
+          stringlist_append_copy( superseded_names , filename );
+        }
+
+        if (free_node != NULL) {
+          file_node = free_node->file_node;
+          block_fs_unlink_free_node( block_fs , free_node );
+          block_fs_fwrite_node__( block_fs , filename , file_node , ptr , data_size , codec[i] , buffer_get_size( buffer ));
+          block_fs_insert_index_node( block_fs , filename , file_node );
+          continue;
+        }
+
+        {
+          div_t d   = div( min_size , block_fs->block_size );
+          node_size = d.quot * block_fs->block_size;
+          if (d.rem)
+            node_size += block_fs->block_size;
+        }
+
+        file_node = file_node_alloc( NODE_IN_USE , block_fs->data_file_size , node_size );
+        file_node->data_size = data_size;
+        file_node->codec     = codec[i];
+        file_node->raw_size  = buffer_get_size( buffer );
+        file_node_set_data_offset( file_node , filename );
+        block_fs_install_node( block_fs , file_node );
+
+        vector_append_ref( region_nodes , file_node );
+        int_vector_append( region_items , i );
+      }
+    }
+
+    if (vector_get_size( region_nodes ) > 0) {
+      size_t region_size = block_fs->data_file_size - region_offset;
+      char * region      = util_calloc( region_size , sizeof * region );
+
+      for (int inode = 0; inode < vector_get_size( region_nodes ); inode++) {
+        int i = int_vector_iget( region_items , inode );
+        block_fs_journal_fwrite( block_fs , JOURNAL_BEGIN , stringlist_iget( filenames , i ) , vector_iget_const( region_nodes , inode ));
+      }
+      block_fs_journal_flush( block_fs );
+
+      /* 1: The data with the NODE_WRITE_ACTIVE_START / NODE_WRITE_ACTIVE_END tags. */
+      for (int inode = 0; inode < vector_get_size( region_nodes ); inode++) {
+        const file_node_type * file_node = vector_iget_const( region_nodes , inode );
+        int i = int_vector_iget( region_items , inode );
+        const void * ptr = (codec[i] == BLOCK_FS_CODEC_NONE) ? buffer_get_data( vector_iget_const( buffers , i )) : buffer_get_data( encoded[i] );
+        char * node_start = &region[ file_node->node_offset - region_offset ];
+
+        memcpy( node_start , &NODE_WRITE_ACTIVE_START , sizeof NODE_WRITE_ACTIVE_START );
+        memcpy( &node_start[ file_node->data_offset ] , ptr , file_node->data_size );
+        memcpy( &node_start[ file_node->node_size - sizeof NODE_WRITE_ACTIVE_END ] , &NODE_WRITE_ACTIVE_END , sizeof NODE_WRITE_ACTIVE_END );
+      }
+      block_fs_fseek( block_fs , region_offset );
+      util_fwrite( region , 1 , region_size , block_fs->data_stream , __func__);
+
+      /* 2: The node headers and NODE_END_TAG. */
+      for (int inode = 0; inode < vector_get_size( region_nodes ); inode++) {
+        file_node_type * file_node = vector_iget( region_nodes , inode );
+        int i = int_vector_iget( region_items , inode );
+        const char * filename = stringlist_iget( filenames , i );
+
+        file_node_fwrite( file_node , filename , block_fs->data_stream );
+        block_fs_update_cache_node( block_fs , file_node , file_node->data_size , &region[ file_node->node_offset - region_offset + file_node->data_offset ]);
+        block_fs_insert_index_node( block_fs , filename , file_node );
+      }
+      free( region );
+
+      fflush( block_fs->data_stream );
+      for (int inode = 0; inode < vector_get_size( region_nodes ); inode++) {
+        int i = int_vector_iget( region_items , inode );
+        block_fs_journal_fwrite( block_fs , JOURNAL_COMMIT , stringlist_iget( filenames , i ) , vector_iget_const( region_nodes , inode ));
+      }
+      block_fs_journal_flush( block_fs );
+    }
+
+    /* 3: Releasing the old nodes. */
+    for (int inode = 0; inode < vector_get_size( superseded_nodes ); inode++) {
+      file_node_type * file_node = vector_iget( superseded_nodes , inode );
+      block_fs_clear_cache_node( block_fs , file_node );
+
+      file_node->status      = NODE_FREE;
+      file_node->data_offset = 0;
+      file_node->data_size   = 0;
+      file_node->codec       = BLOCK_FS_CODEC_NONE;
+      block_fs_journal_fwrite( block_fs , JOURNAL_FREE , stringlist_iget( superseded_names , inode ) , file_node );
+    }
+    block_fs_journal_flush( block_fs );
+
+    for (int inode = 0; inode < vector_get_size( superseded_nodes ); inode++) {
+      file_node_type * file_node = vector_iget( superseded_nodes , inode );
+      file_node_fwrite( file_node , NULL , block_fs->data_stream );
+      block_fs_insert_free_node( block_fs , file_node );
+    }
+
+    if (size > 0)
+      block_fs_group_commit( block_fs , 1 , total_size );
+
+    if ((block_fs->free_size * 1.0 / block_fs->data_file_size) > block_fs->fragmentation_limit)
+      block_fs_rotate__( block_fs );
+    block_fs_journal_maybe_checkpoint( block_fs );
+
+    int_vector_free( region_items );
+    stringlist_free( superseded_names );
+    vector_free( superseded_nodes );
+    vector_free( region_nodes );
+  }
+  block_fs_release_rwlock( block_fs );
+
+  for (int i = 0; i < size; i++)
+    if (encoded[i] != NULL)
+      buffer_free( encoded[i] );
+
+  hash_free( last_index );
+  free( codec );
+  free( encoded );
+}
+
+
 /**
    Need extra locking here - because the global rwlock allows many
    concurrent readers.
@@ -1410,39 +2491,77 @@ static void block_fs_fread__(block_fs_type * block_fs , const file_node_type * f
 
 
 /**
-   Reads the full content of 'filename' into the buffer.
+   Reads the data stored in the node - i.e. still encoded - into the
+   buffer.
 */
 
-void block_fs_fread_realloc_buffer( block_fs_type * block_fs , const char * filename , buffer_type * buffer) {
-  block_fs_aquire_rlock( block_fs );
+static void block_fs_fread_stored__( block_fs_type * block_fs , const file_node_type * node , buffer_type * buffer) {
+  buffer_clear( buffer );   /* Setting: content_size = 0; pos = 0;  */
   {
-    file_node_type * node = hash_get( block_fs->index , filename);
-
-    buffer_clear( buffer );   /* Setting: content_size = 0; pos = 0;  */
-    {
-      /*
-         Going low-level - essentially a second implementation of
-         block_fs_fread__():
-      */
+    /*
+       Going low-level - essentially a second implementation of
+       block_fs_fread__():
+    */
 
 #ifdef ENABLE_CACHE
-      if (node->cache != NULL)
-        file_node_buffer_read_from_cache( node , buffer );
-      else
+    if (node->cache != NULL)
+      file_node_buffer_read_from_cache( node , buffer );
+    else
 #else
-      if (true)
+    if (true)
 #endif
 
-      {
-        pthread_mutex_lock( &block_fs->io_lock );
-        block_fs_fseek_node_data(block_fs , node );
-        buffer_stream_fread( buffer , node->data_size , block_fs->data_stream );
-        //file_node_verify_end_tag( node , block_fs->data_stream );
-        pthread_mutex_unlock( &block_fs->io_lock );
-      }
+    {
+      pthread_mutex_lock( &block_fs->io_lock );
+      block_fs_fseek_node_data(block_fs , node );
+      buffer_stream_fread( buffer , node->data_size , block_fs->data_stream );
+      //file_node_verify_end_tag( node , block_fs->data_stream );
+      pthread_mutex_unlock( &block_fs->io_lock );
+    }
+
+  }
+  buffer_rewind( buffer );  /* Setting: pos = 0; */
+}
+
+
+/**
+   Reads the decoded data of the node into @ptr, which must have room
+   for node->raw_size bytes. Data without codec is read directly into
+   @ptr.
+*/
+
+static void block_fs_fread_decoded__( block_fs_type * block_fs , const file_node_type * node , void * ptr) {
+  if (node->codec == BLOCK_FS_CODEC_NONE)
+    block_fs_fread__( block_fs , node , ptr , node->data_size );
+  else {
+    buffer_type * stored = buffer_alloc( node->data_size );
+    block_fs_fread_stored__( block_fs , node , stored );
+    block_fs_decode( node->codec , stored , ptr , node->raw_size );
+    buffer_free( stored );
+  }
+}
+
+
+/**
+   Reads the full content of 'filename' into the buffer.
+*/
+
+void block_fs_fread_realloc_buffer( block_fs_type * block_fs , const char * filename , buffer_type * buffer) {
+  block_fs_aquire_rlock( block_fs );
+  {
+    file_node_type * node = hash_get( block_fs->index , filename);
 
+    if (node->codec == BLOCK_FS_CODEC_NONE)
+      block_fs_fread_stored__( block_fs , node , buffer );
+    else {
+      void * data = util_malloc( node->raw_size );
+      block_fs_fread_decoded__( block_fs , node , data );
+
+      buffer_clear( buffer );
+      buffer_fwrite( buffer , data , 1 , node->raw_size );
+      buffer_rewind( buffer );
+      free( data );
     }
-    buffer_rewind( buffer );  /* Setting: pos = 0; */
   }
   block_fs_release_rwlock( block_fs );
 }
@@ -1465,7 +2584,40 @@ void block_fs_fread_file( block_fs_type * block_fs , const char * filename , voi
   block_fs_aquire_rlock( block_fs );
   {
     file_node_type * node = hash_get( block_fs->index , filename);
-    block_fs_fread__( block_fs , node , ptr , node->data_size);
+    block_fs_fread_decoded__( block_fs , node , ptr );
+  }
+  block_fs_release_rwlock( block_fs );
+}
+
+
+
+/*
+  Reads @read_bytes bytes starting at @offset within the data stored
+  in 'filename'; this is used to read a part of a large record
+  without loading all of it. The codecs encode the record as one
+  frame, so if the record has been stored with a codec the whole
+  record is read and decoded, and the range read costs as much as a
+  full block_fs_fread_file().
+*/
+
+void block_fs_fread_range( block_fs_type * block_fs , const char * filename , size_t offset , size_t read_bytes , void * ptr) {
+  block_fs_aquire_rlock( block_fs );
+  {
+    file_node_type * node = hash_get( block_fs->index , filename);
+    if ((offset + read_bytes) > (size_t) node->raw_size)
+      util_abort("%s: trying to read bytes [%zd,%zd) from %s which has only %d bytes \n",__func__ , offset , offset + read_bytes , filename , node->raw_size);
+
+    if (node->codec == BLOCK_FS_CODEC_NONE) {
+      pthread_mutex_lock( &block_fs->io_lock );
+      block_fs_fseek( block_fs , node->node_offset + node->data_offset + offset );
+      util_fread( ptr , 1 , read_bytes , block_fs->data_stream , __func__);
+      pthread_mutex_unlock( &block_fs->io_lock );
+    } else {
+      char * data = util_malloc( node->raw_size );
+      block_fs_fread_decoded__( block_fs , node , data );
+      memcpy( ptr , &data[offset] , read_bytes );
+      free( data );
+    }
   }
   block_fs_release_rwlock( block_fs );
 }
@@ -1477,57 +2629,128 @@ int block_fs_get_filesize( block_fs_type * block_fs , const char * filename) {
   block_fs_aquire_rlock( block_fs );
   {
     file_node_type * node = hash_get( block_fs->index , filename );
-    data_size = node->data_size;
+    data_size = node->raw_size;
   }
   block_fs_release_rwlock( block_fs );
   return data_size;
 }
 
 
-static void block_fs_dump_index( block_fs_type * block_fs ) {
-  if (block_fs->data_owner) {
-    struct stat stat_buffer;
-    int stat_return = stat(block_fs->data_file , &stat_buffer);
-    if (stat_return != 0)
-      return;
+/*
+  The number of bytes actually stored for 'filename', i.e. after
+  encoding; for a node without codec this is equal to
+  block_fs_get_filesize().
+*/
+
+int block_fs_get_stored_size( block_fs_type * block_fs , const char * filename) {
+  int stored_size;
+  block_fs_aquire_rlock( block_fs );
+  {
+    file_node_type * node = hash_get( block_fs->index , filename );
+    stored_size = node->data_size;
+  }
+  block_fs_release_rwlock( block_fs );
+  return stored_size;
+}
+
+
+/**
+   Writes the current in-memory index to @index_file, stamped with
+   the mtime of @data_file and @journal_id. The normal case is to write
+   the index of the block_fs instance itself, but block_fs_clone() uses
+   this to write an index for the cloned data file, without a journal.
+
+   The index is written to a temporary file which is renamed in place,
+   so a crash while writing the index leaves the previous index.
+*/
+
+static void block_fs_fwrite_index__( const block_fs_type * block_fs , const char * data_file , const char * index_file , long int journal_id) {
+  struct stat stat_buffer;
+  int stat_return = stat(data_file , &stat_buffer);
+  if (stat_return != 0)
+    return;
+  {
+    time_t data_mtime = stat_buffer.st_mtime;
+    char * tmp_file = util_alloc_sprintf("%s.tmp" , index_file );
+    FILE * index_stream = util_fopen( tmp_file , "w");
+    util_fwrite_int( INDEX_MAGIC_INT , index_stream );
+    util_fwrite_int( INDEX_FORMAT_VERSION , index_stream );
+    util_fwrite_time_t( data_mtime , index_stream );
+    util_fwrite_long( journal_id , index_stream );
+
+    /* 1: Dumping the hash table of active nodes. */
     {
-      time_t data_mtime = stat_buffer.st_mtime;
-      FILE * index_stream = util_fopen( block_fs->index_file , "w");
-      util_fwrite_int( INDEX_MAGIC_INT , index_stream );
-      util_fwrite_int( INDEX_FORMAT_VERSION , index_stream );
-      util_fwrite_time_t( data_mtime , index_stream );
-
-      /* 1: Dumping the hash table of active nodes. */
-      {
-        hash_iter_type * index_iter = hash_iter_alloc( block_fs->index );
-
-        util_fwrite_int( hash_get_size( block_fs->index ) , index_stream);
-        while (!hash_iter_is_complete( index_iter )) {
-          const char * key = hash_iter_get_next_key( index_iter );
-          const file_node_type * file_node = hash_get( block_fs->index , key );
-
-          util_fwrite_string( key , index_stream);
-          file_node_dump_index( file_node , index_stream );
-        }
-        hash_iter_free( index_iter );
-      }
+      hash_iter_type * index_iter = hash_iter_alloc( block_fs->index );
 
-      /* 2: Dumping information about empty slots in the datafile. */
-      util_fwrite_int( block_fs->num_free_nodes , index_stream );
-      {
-        free_node_type * current = block_fs->free_nodes;
-        while ( current != NULL) {
-          file_node_dump_index( current->file_node , index_stream );
-          current = current->next;
-        }
+      util_fwrite_int( hash_get_size( block_fs->index ) , index_stream);
+      while (!hash_iter_is_complete( index_iter )) {
+        const char * key = hash_iter_get_next_key( index_iter );
+        const file_node_type * file_node = hash_get( block_fs->index , key );
+
+        util_fwrite_string( key , index_stream);
+        file_node_dump_index( file_node , index_stream );
       }
+      hash_iter_free( index_iter );
+    }
 
-      fclose( index_stream );
+    /* 2: Dumping information about empty slots in the datafile. */
+    util_fwrite_int( block_fs->num_free_nodes , index_stream );
+    {
+      free_node_type * current = block_fs->free_nodes;
+      while ( current != NULL) {
+        file_node_dump_index( current->file_node , index_stream );
+        current = current->next;
+      }
     }
+
+    fflush( index_stream );
+    fsync( fileno( index_stream ));
+    fclose( index_stream );
+    if (rename( tmp_file , index_file ) != 0)
+      util_abort("%s: failed to rename %s -> %s: %s \n",__func__ , tmp_file , index_file , strerror( errno ));
+    free( tmp_file );
   }
 }
 
 
+/**
+   A checkpoint writes the full index, and starts a new empty journal
+   with a new journal_id. The data must be on disk before the index
+   which refers to it. If the process dies after the index has been
+   written, but before the new journal is in place, the journal_id of
+   the journal and the index will differ, and the index is only used if
+   the mtime check in block_fs_load_index() succeeds.
+*/
+
+static void block_fs_checkpoint( block_fs_type * block_fs ) {
+  if (block_fs->data_owner && (block_fs->data_stream != NULL)) {
+    fflush( block_fs->data_stream );
+    fsync( block_fs->data_fd );
+
+    block_fs->journal_id++;
+    block_fs_fwrite_index__( block_fs , block_fs->data_file , block_fs->index_file , block_fs->journal_id );
+    block_fs_journal_reset( block_fs );
+  }
+}
+
+
+/**
+   The number of journal records between checkpoints; the journal
+   replayed when mounting after a crash is at most this long. A value
+   of zero means that the index is only written when the filesystem
+   is closed.
+*/
+
+void block_fs_set_checkpoint_interval( block_fs_type * block_fs , int checkpoint_interval ) {
+  block_fs->checkpoint_interval = checkpoint_interval;
+}
+
+
+block_fs_mount_type block_fs_get_mount_type( const block_fs_type * block_fs ) {
+  return block_fs->mount_type;
+}
+
+
 /**
    Close/synchronize the open file descriptors and free all memory
    related to the block_fs instance.
@@ -1539,14 +2762,19 @@ static void block_fs_dump_index( block_fs_type * block_fs ) {
 void block_fs_close( block_fs_type * block_fs , bool unlink_empty) {
   block_fs_fsync( block_fs );
 
-  if (block_fs->data_owner)
+  if (block_fs->data_owner) {
     block_fs_aquire_wlock( block_fs );
 
+    /* Nothing has changed since the last checkpoint if the journal is empty. */
+    if ((block_fs->journal_stream == NULL) || (block_fs->journal_records > 0))
+      block_fs_checkpoint( block_fs );
+  }
+
   if (block_fs->data_stream != NULL)
     fclose( block_fs->data_stream );
 
-  if (block_fs->data_owner)
-    block_fs_dump_index( block_fs );
+  if (block_fs->journal_stream != NULL)
+    fclose( block_fs->journal_stream );
 
   if (block_fs->lock_fd > 0) {
     close( block_fs->lock_fd );     /* Closing the lock_file file descriptor - and releasing the lock. */
@@ -1557,12 +2785,14 @@ void block_fs_close( block_fs_type * block_fs , bool unlink_empty) {
     if ( unlink_empty && (hash_get_size( block_fs->index) == 0)) {
       util_unlink_existing( block_fs->data_file );
       util_unlink_existing( block_fs->index_file );
+      util_unlink_existing( block_fs->journal_file );
       util_unlink_existing( block_fs->mount_file );
     }
     block_fs_release_rwlock( block_fs );
   }
 
   free( block_fs->index_file );
+  free( block_fs->journal_file );
   free( block_fs->lock_file );
   free( block_fs->base_name );
   free( block_fs->data_file );
@@ -1577,6 +2807,139 @@ void block_fs_close( block_fs_type * block_fs , bool unlink_empty) {
 
 
 
+/**
+   Copies the data file @src_file to @target_file. The copy is first
+   attempted as a copy-on-write reflink, which is instantaneous on
+   filesystems like btrfs and xfs, then with copy_file_range() which
+   keeps the copy inside the kernel, and finally with a plain
+   read()/write() loop. Returns true if the copy succeeded.
+*/
+
+static bool block_fs_copy_data_file( const char * src_file , const char * target_file ) {
+  bool copy_ok = false;
+  int src_fd   = open( src_file , O_RDONLY );
+  if (src_fd == -1)
+    return false;
+  {
+    int target_fd = open( target_file , O_WRONLY | O_CREAT | O_TRUNC , S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH );
+    if (target_fd == -1) {
+      close( src_fd );
+      return false;
+    }
+
+#ifdef FICLONE
+    if (ioctl( target_fd , FICLONE , src_fd ) == 0)
+      copy_ok = true;
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+    if (!copy_ok) {
+      stat_type src_stat;
+      if (fstat( src_fd , &src_stat ) == 0) {
+        off_t remaining = src_stat.st_size;
+        while (remaining > 0) {
+          ssize_t bytes = copy_file_range( src_fd , NULL , target_fd , NULL , remaining , 0 );
+          if (bytes <= 0)
+            break;
+          remaining -= bytes;
+        }
+        copy_ok = (remaining == 0);
+      }
+    }
+#endif
+
+    if (!copy_ok) {
+      /* Fallback: start from scratch with an ordinary user space copy. */
+      const size_t buffer_size = 4 * 1024 * 1024;
+      char * buffer = util_malloc( buffer_size );
+
+      if ((lseek( src_fd , 0 , SEEK_SET ) == 0) && (lseek( target_fd , 0 , SEEK_SET ) == 0) && (ftruncate( target_fd , 0 ) == 0)) {
+        copy_ok = true;
+        while (copy_ok) {
+          ssize_t read_bytes = read( src_fd , buffer , buffer_size );
+          if (read_bytes == 0)
+            break;
+
+          if (read_bytes < 0)
+            copy_ok = false;
+          else {
+            ssize_t offset = 0;
+            while (copy_ok && (offset < read_bytes)) {
+              ssize_t write_bytes = write( target_fd , &buffer[offset] , read_bytes - offset );
+              if (write_bytes <= 0)
+                copy_ok = false;
+              else
+                offset += write_bytes;
+            }
+          }
+        }
+      }
+      free( buffer );
+    }
+
+    if (copy_ok)
+      fsync( target_fd );
+
+    close( target_fd );
+  }
+  close( src_fd );
+  return copy_ok;
+}
+
+
+/**
+   Will create a complete copy of the block_fs instance with mount
+   file @target_mount_file; i.e. the mount map, the data file and an
+   index matching the copied data file. The copy works on the raw data
+   file, so no node is read or written individually; where the
+   underlying filesystem supports it the data file is shared
+   copy-on-write between the source and the clone.
+
+   The write lock is held while copying, so the clone is a consistent
+   snapshot of the source. Observe that the target should not be
+   mounted while cloning. Returns true if the clone succeeded.
+*/
+
+bool block_fs_clone( block_fs_type * block_fs , const char * target_mount_file ) {
+  bool clone_ok = true;
+  if (block_fs->data_owner)
+    block_fs_aquire_wlock( block_fs );
+  else
+    block_fs_aquire_rlock( block_fs );
+  {
+    char * target_path;
+    char * target_base;
+    char * data_ext = util_alloc_sprintf("data_%d" , block_fs->version );
+    util_alloc_file_components( target_mount_file , &target_path , &target_base , NULL );
+    {
+      char * target_data_file  = util_alloc_filename( target_path , target_base , data_ext );
+      char * target_index_file = util_alloc_filename( target_path , target_base , "index" );
+
+      if (block_fs->data_owner && (block_fs->data_stream != NULL)) {
+        fflush( block_fs->data_stream );
+        fsync( block_fs->data_fd );
+      }
+
+      block_fs_fwrite_mount_info__( target_mount_file , block_fs->version );
+      if (util_file_exists( block_fs->data_file )) {
+        clone_ok = block_fs_copy_data_file( block_fs->data_file , target_data_file );
+        if (clone_ok)
+          block_fs_fwrite_index__( block_fs , target_data_file , target_index_file , 0 );
+      }
+
+      free( target_data_file );
+      free( target_index_file );
+    }
+    free( data_ext );
+    free( target_path );
+    free( target_base );
+  }
+  block_fs_release_rwlock( block_fs );
+  return clone_ok;
+}
+
+
+
 
 
 /**
@@ -1596,6 +2959,10 @@ static void block_fs_rotate__( block_fs_type * block_fs ) {
   */
   block_fs->version++;
   block_fs_fwrite_mount_info__( block_fs->mount_file , block_fs->version );
+
+  /* The index and the journal describe the old data file; nothing is journaled until the checkpoint below. */
+  block_fs_journal_discard( block_fs );
+  util_unlink_existing( block_fs->index_file );
   {
     vector_type    * old_nodes         = block_fs->file_nodes;
     hash_type      * old_index         = block_fs->index;
@@ -1623,7 +2990,7 @@ static void block_fs_rotate__( block_fs_type * block_fs ) {
         fseek__( old_data_stream , old_node->node_offset + old_node->data_offset , SEEK_SET );
         buffer_stream_fread( buffer , old_node->data_size , old_data_stream );
 
-        block_fs_fwrite_file_unlocked( block_fs , key , buffer_get_data( buffer ) , buffer_get_size( buffer ));  /* Normal write to the new file. */
+        block_fs_fwrite_file_unlocked( block_fs , key , buffer_get_data( buffer ) , buffer_get_size( buffer ) , old_node->codec , old_node->raw_size );  /* Normal write to the new file - the data is copied over still encoded. */
       }
 
       buffer_free( buffer );
@@ -1649,6 +3016,7 @@ static void block_fs_rotate__( block_fs_type * block_fs ) {
     hash_free( old_index );
     vector_free( old_nodes );
   }
+  block_fs_checkpoint( block_fs );
 }
 
 
@@ -0,0 +1,169 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'counter_rng.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <ert/util/util.h>
+
+#include <ert/res_util/counter_rng.h>
+
+/**
+   The counter_rng is a counter based random number generator; the
+   Philox4x32-10 function of Salmon et al. (2011). In contrast to the
+   sequential generators (MZRAN) there is no state which is updated
+   when a number is drawn: the value is a pure function of the key and
+   the counter (stream , iens , index). Consequently:
+
+   o The numbers can be drawn in any order, and from any number of
+     threads, and the result is bitwise identical.
+
+   o The value for realization iens does not depend on which other
+     realizations are active, or on the ensemble size.
+
+   The stream argument separates different uses of the numbers; the
+   function counter_rng_stream_id() can be used to combine a purpose
+   and e.g. the name of a ministep into a stream id.
+
+   The object is immutable after allocation and can be shared freely
+   between threads.
+*/
+
+#define COUNTER_RNG_TYPE_ID 661093
+
+#define PHILOX_M0     0xD2511F53U
+#define PHILOX_M1     0xCD9E8D57U
+#define PHILOX_W0     0x9E3779B9U
+#define PHILOX_W1     0xBB67AE85U
+#define PHILOX_ROUNDS 10
+
+struct counter_rng_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  uint32_t key[2];
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( counter_rng , COUNTER_RNG_TYPE_ID )
+
+
+counter_rng_type * counter_rng_alloc( unsigned int key0 , unsigned int key1 ) {
+  counter_rng_type * counter_rng = util_malloc( sizeof * counter_rng );
+  UTIL_TYPE_ID_INIT( counter_rng , COUNTER_RNG_TYPE_ID );
+  counter_rng->key[0] = key0;
+  counter_rng->key[1] = key1;
+  return counter_rng;
+}
+
+
+void counter_rng_free( counter_rng_type * counter_rng ) {
+  free( counter_rng );
+}
+
+
+/*
+  FNV-1a hash of the name, starting from the purpose.
+*/
+
+unsigned int counter_rng_stream_id( unsigned int purpose , const char * name ) {
+  uint32_t hash = 2166136261U ^ purpose;
+  hash *= 16777619U;
+  if (name) {
+    for (const char * c = name; *c; c++) {
+      hash ^= (unsigned char) *c;
+      hash *= 16777619U;
+    }
+  }
+  return hash;
+}
+
+
+static void philox_round( uint32_t * ctr , const uint32_t * key ) {
+  uint64_t prod0 = (uint64_t) PHILOX_M0 * ctr[0];
+  uint64_t prod1 = (uint64_t) PHILOX_M1 * ctr[2];
+  uint32_t hi0 = (uint32_t) (prod0 >> 32);
+  uint32_t lo0 = (uint32_t) prod0;
+  uint32_t hi1 = (uint32_t) (prod1 >> 32);
+  uint32_t lo1 = (uint32_t) prod1;
+
+  ctr[0] = hi1 ^ ctr[1] ^ key[0];
+  ctr[1] = lo1;
+  ctr[2] = hi0 ^ ctr[3] ^ key[1];
+  ctr[3] = lo0;
+}
+
+
+void counter_rng_get_uint4( const counter_rng_type * counter_rng , unsigned int stream , int iens , long index , unsigned int * output ) {
+  uint32_t ctr[4] = { (uint32_t) index , (uint32_t) (((uint64_t) index) >> 32) , (uint32_t) iens , (uint32_t) stream };
+  uint32_t key[2] = { counter_rng->key[0] , counter_rng->key[1] };
+
+  for (int round = 0; round < PHILOX_ROUNDS; round++) {
+    if (round > 0) {
+      key[0] += PHILOX_W0;
+      key[1] += PHILOX_W1;
+    }
+    philox_round( ctr , key );
+  }
+
+  for (int i = 0; i < 4; i++)
+    output[i] = ctr[i];
+}
+
+
+/*
+  53 bit uniform in the open interval (0,1) from two 32 bit words.
+*/
+
+static double counter_rng_uniform( uint32_t a , uint32_t b ) {
+  return ((a >> 5) * 67108864.0 + (b >> 6) + 0.5) / 9007199254740992.0;
+}
+
+
+double counter_rng_get_double( const counter_rng_type * counter_rng , unsigned int stream , int iens , long index ) {
+  unsigned int output[4];
+  counter_rng_get_uint4( counter_rng , stream , iens , index , output );
+  return counter_rng_uniform( output[0] , output[1] );
+}
+
+
+/*
+  Box-Muller with the two uniforms of one counter block; only the
+  cosine branch is used, so that one (stream , iens , index) gives
+  exactly one normal variate.
+*/
+
+double counter_rng_std_normal( const counter_rng_type * counter_rng , unsigned int stream , int iens , long index ) {
+  unsigned int output[4];
+  counter_rng_get_uint4( counter_rng , stream , iens , index , output );
+  {
+    double u1 = counter_rng_uniform( output[0] , output[1] );
+    double u2 = counter_rng_uniform( output[2] , output[3] );
+    return sqrt( -2.0 * log( u1 )) * cos( 2.0 * M_PI * u2 );
+  }
+}
+
+
+/*
+  Fills data[i*stride] with the normal variates for index offset + i,
+  i = 0,...,size-1.
+*/
+
+void counter_rng_std_normal_vector( const counter_rng_type * counter_rng , unsigned int stream , int iens , long offset , int size , double * data , int stride ) {
+  for (int i = 0; i < size; i++)
+    data[i * stride] = counter_rng_std_normal( counter_rng , stream , iens , offset + i );
+}
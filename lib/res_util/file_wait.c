@@ -0,0 +1,201 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'file_wait.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HAVE_INOTIFY
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#endif
+
+#include <ert/util/util.h>
+
+#include <ert/res_util/file_wait.h>
+
+/**
+   Small utility to wait for one of several files to appear, typically
+   the OK or EXIT file of a job which the queue driver has reported as
+   finished. When inotify is available, and the directory is on a
+   local filesystem, the wait is event driven; otherwise the files are
+   polled with an exponentially increasing sleep time, starting at 10
+   ms and levelling off at one second.
+
+   Even with inotify the files are checked at least once every second,
+   so a lost event will only delay the detection.
+*/
+
+#define FILE_WAIT_MIN_USLEEP     10000
+#define FILE_WAIT_MAX_USLEEP   1000000
+
+
+static double file_wait_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int file_wait_find( const char ** files , int num_files ) {
+  for (int i = 0; i < num_files; i++) {
+    if (files[i] && util_file_exists( files[i] ))
+      return i;
+  }
+  return -1;
+}
+
+
+static int file_wait_poll( const char ** files , int num_files , double deadline ) {
+  int usleep_time = FILE_WAIT_MIN_USLEEP;
+  while (true) {
+    int index = file_wait_find( files , num_files );
+    if (index >= 0)
+      return index;
+    {
+      double remaining = deadline - file_wait_clock( );
+      if (remaining <= 0)
+        return -1;
+
+      if (remaining * 1e6 < usleep_time)
+        usleep( remaining * 1e6 + 1 );
+      else
+        usleep( usleep_time );
+      usleep_time = util_int_min( 2 * usleep_time , FILE_WAIT_MAX_USLEEP );
+    }
+  }
+}
+
+
+#ifdef HAVE_INOTIFY
+
+/*
+  inotify only sees changes made through the local kernel; for network
+  and cluster filesystems a file created on the compute node will not
+  generate an event on the machine running the queue.
+*/
+
+bool file_wait_use_inotify( const char * path ) {
+  struct statfs st;
+  if (statfs( path , &st ) != 0)
+    return false;
+
+  switch ((uint32_t) st.f_type) {
+  case 0x6969:          /* NFS     */
+  case 0x517B:          /* SMB     */
+  case 0xFF534D42:      /* CIFS    */
+  case 0xFE534D42:      /* SMB2    */
+  case 0x73757245:      /* CODA    */
+  case 0x5346414F:      /* AFS     */
+  case 0x65735546:      /* FUSE    */
+  case 0x0BD00BD0:      /* Lustre  */
+  case 0x47504653:      /* GPFS    */
+  case 0x01021997:      /* 9P      */
+  case 0x00C36400:      /* Ceph    */
+    return false;
+  default:
+    return true;
+  }
+}
+
+
+static int file_wait_inotify_add_watch( int fd , const char * file ) {
+  char * path;
+  int wd = -1;
+
+  util_alloc_file_components( file , &path , NULL , NULL );
+  if (path == NULL)
+    path = util_alloc_string_copy( "." );
+
+  if (file_wait_use_inotify( path ))
+    wd = inotify_add_watch( fd , path , IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB );
+
+  free( path );
+  return wd;
+}
+
+
+static int file_wait_inotify( const char ** files , int num_files , double deadline ) {
+  int fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+  if (fd < 0)
+    return file_wait_poll( files , num_files , deadline );
+
+  for (int i = 0; i < num_files; i++) {
+    if (files[i] && (file_wait_inotify_add_watch( fd , files[i] ) < 0)) {
+      close( fd );
+      return file_wait_poll( files , num_files , deadline );
+    }
+  }
+
+  {
+    /* Must check again after the watches are installed. */
+    int index = file_wait_find( files , num_files );
+    while (index < 0) {
+      double remaining = deadline - file_wait_clock( );
+      struct pollfd pfd = { .fd = fd , .events = POLLIN , .revents = 0 };
+      int timeout_ms;
+
+      if (remaining <= 0)
+        break;
+
+      timeout_ms = FILE_WAIT_MAX_USLEEP / 1000;
+      if (remaining * 1000 < timeout_ms)
+        timeout_ms = remaining * 1000 + 1;
+      if (poll( &pfd , 1 , timeout_ms ) > 0) {
+        char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        while (read( fd , buffer , sizeof buffer ) > 0)
+          ;
+      }
+      index = file_wait_find( files , num_files );
+    }
+    close( fd );
+    return index;
+  }
+}
+
+#else
+
+bool file_wait_use_inotify( const char * path ) {
+  return false;
+}
+
+#endif
+
+
+/**
+   Waits up to @timeout seconds for one of the @num_files files to
+   exist. The files are checked in order, and the index of the first
+   existing file is returned; if none of the files appear within the
+   timeout the function returns -1. Elements in @files can be NULL.
+*/
+
+int file_wait_any( const char ** files , int num_files , double timeout ) {
+  int index = file_wait_find( files , num_files );
+  if ((index >= 0) || (timeout <= 0))
+    return index;
+  {
+    double deadline = file_wait_clock( ) + timeout;
+#ifdef HAVE_INOTIFY
+    return file_wait_inotify( files , num_files , deadline );
+#else
+    return file_wait_poll( files , num_files , deadline );
+#endif
+  }
+}
@@ -17,12 +17,14 @@
 */
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 
 #include <ert/util/test_util.h>
 #include <ert/util/test_work_area.h>
+#include <ert/util/rng.h>
 #include <ert/res_util/block_fs.h>
 
 void test_assert_util_abort(const char * function_name , void call_func (void *) , void * arg);
@@ -102,8 +104,261 @@ void test_lock_conflict() {
 
 
 
+static block_fs_type * mount_codec_fs( block_fs_codec_type codec ) {
+  block_fs_type * bfs = block_fs_mount( "test.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  block_fs_set_codec( bfs , codec );
+  return bfs;
+}
+
+
+static void assert_file_content( block_fs_type * bfs , const char * filename , const void * data , int data_size ) {
+  test_assert_int_equal( data_size , block_fs_get_filesize( bfs , filename ));
+  {
+    char * read_data = util_malloc( data_size );
+    block_fs_fread_file( bfs , filename , read_data );
+    test_assert_true( memcmp( data , read_data , data_size ) == 0 );
+    free( read_data );
+  }
+  {
+    buffer_type * buffer = buffer_alloc( 100 );
+    block_fs_fread_realloc_buffer( bfs , filename , buffer );
+    test_assert_int_equal( data_size , buffer_get_size( buffer ));
+    test_assert_true( memcmp( data , buffer_get_data( buffer ) , data_size ) == 0 );
+    buffer_free( buffer );
+  }
+}
+
+
+/*
+  Writes the same content with all the codecs, and checks that it
+  reads back unchanged - both directly, after a remount with index,
+  and after a remount where the index must be rebuilt from the data
+  file.
+*/
+
+void test_codec( ) {
+  test_work_area_type * work_area = test_work_area_alloc("block_fs/codec");
+  const int size = 1003;
+  double * smooth = util_malloc( size * sizeof * smooth );
+  double * noise  = util_malloc( size * sizeof * noise );
+  double * zero   = util_calloc( size , sizeof * zero );
+  rng_type * rng  = rng_alloc( MZRAN , INIT_DEFAULT );
+
+  for (int i = 0; i < size; i++) {
+    smooth[i] = 100 + 0.25 * i;
+    noise[i]  = rng_get_double( rng );
+  }
+
+  {
+    block_fs_type * bfs = mount_codec_fs( BLOCK_FS_CODEC_NONE );
+    block_fs_fwrite_file( bfs , "none" , smooth , size * sizeof * smooth );
+    test_assert_int_equal( block_fs_get_filesize( bfs , "none" ) , block_fs_get_stored_size( bfs , "none" ));
+
+    block_fs_set_codec( bfs , BLOCK_FS_CODEC_ZLIB );
+    block_fs_fwrite_file( bfs , "zlib" , smooth , size * sizeof * smooth );
+    block_fs_fwrite_file( bfs , "noise" , noise , size * sizeof * noise );
+
+    block_fs_set_codec( bfs , BLOCK_FS_CODEC_SHUFFLE_RLE );
+    block_fs_fwrite_file( bfs , "rle" , smooth , size * sizeof * smooth );
+    block_fs_fwrite_file( bfs , "zero" , zero , size * sizeof * zero );
+    block_fs_fwrite_file( bfs , "odd" , smooth , 13 );
+    block_fs_fwrite_file( bfs , "empty" , smooth , 0 );
+
+    /* Overwriting an existing node with content of different size. */
+    block_fs_fwrite_file( bfs , "none" , zero , size * sizeof * zero );
+    block_fs_fwrite_file( bfs , "none" , smooth , size * sizeof * smooth );
+
+    test_assert_true( block_fs_get_stored_size( bfs , "zlib" ) < block_fs_get_filesize( bfs , "zlib" ));
+    test_assert_true( block_fs_get_stored_size( bfs , "rle" ) < block_fs_get_filesize( bfs , "rle" ));
+    test_assert_true( block_fs_get_stored_size( bfs , "zero" ) < 200 );
+    block_fs_close( bfs , false );
+  }
+
+  for (int remount = 0; remount < 2; remount++) {
+    block_fs_type * bfs;
+    if (remount == 1)
+      unlink( "test.index" );
+
+    bfs = mount_codec_fs( BLOCK_FS_CODEC_NONE );
+    assert_file_content( bfs , "none"  , smooth , size * sizeof * smooth );
+    assert_file_content( bfs , "zlib"  , smooth , size * sizeof * smooth );
+    assert_file_content( bfs , "noise" , noise  , size * sizeof * noise );
+    assert_file_content( bfs , "rle"   , smooth , size * sizeof * smooth );
+    assert_file_content( bfs , "zero"  , zero   , size * sizeof * zero );
+    assert_file_content( bfs , "odd"   , smooth , 13 );
+    test_assert_int_equal( 0 , block_fs_get_filesize( bfs , "empty" ));
+    {
+      double range[10];
+      block_fs_fread_range( bfs , "rle" , 100 * sizeof(double) , sizeof range , range );
+      test_assert_true( memcmp( range , &smooth[100] , sizeof range ) == 0 );
+    }
+    block_fs_close( bfs , false );
+  }
+
+  rng_free( rng );
+  free( zero );
+  free( noise );
+  free( smooth );
+  test_work_area_free( work_area );
+}
+
+
+static void free_buffer__( void * arg ) {
+  buffer_free( (buffer_type *) arg );
+}
+
+
+static buffer_type * alloc_int_buffer( int size , int value ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  for (int i = 0; i < size; i++)
+    buffer_fwrite_int( buffer , value + i );
+  return buffer;
+}
+
+
+static void assert_int_file( block_fs_type * bfs , const char * filename , int size , int value ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  block_fs_fread_realloc_buffer( bfs , filename , buffer );
+  test_assert_int_equal( size * sizeof(int) , buffer_get_size( buffer ));
+  for (int i = 0; i < size; i++)
+    test_assert_int_equal( value + i , buffer_fread_int( buffer ));
+  buffer_free( buffer );
+}
+
+
+/*
+  Batch write with: new files, a file overwritten in place, a file
+  which must be moved because it has grown, and a filename which
+  occurs twice in the batch.
+*/
+
+void test_batch( ) {
+  test_work_area_type * work_area = test_work_area_alloc("block_fs/batch");
+  {
+    block_fs_type * bfs = block_fs_mount( "test.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    stringlist_type * filenames = stringlist_alloc_new();
+    vector_type * buffers = vector_alloc_new();
+
+    block_fs_set_fsync_policy( bfs , 0 , 1024 , 1 );
+    {
+      buffer_type * buffer = alloc_int_buffer( 10 , 0 );
+      block_fs_fwrite_buffer( bfs , "inplace" , buffer );
+      block_fs_fwrite_buffer( bfs , "grow" , buffer );
+      buffer_free( buffer );
+    }
+
+    stringlist_append_copy( filenames , "inplace" );  vector_append_owned_ref( buffers , alloc_int_buffer( 5 , 100 ) , free_buffer__ );
+    stringlist_append_copy( filenames , "grow" );     vector_append_owned_ref( buffers , alloc_int_buffer( 1000 , 200 ) , free_buffer__ );
+    for (int i = 0; i < 20; i++) {
+      char * filename = util_alloc_sprintf("new.%d" , i);
+      stringlist_append_copy( filenames , filename );
+      vector_append_owned_ref( buffers , alloc_int_buffer( i + 1 , 1000 * i ) , free_buffer__ );
+      free( filename );
+    }
+    stringlist_append_copy( filenames , "new.0" );    vector_append_owned_ref( buffers , alloc_int_buffer( 7 , 77 ) , free_buffer__ );
+
+    block_fs_fwrite_batch( bfs , filenames , buffers );
+    assert_int_file( bfs , "inplace" , 5 , 100 );
+    assert_int_file( bfs , "grow" , 1000 , 200 );
+    assert_int_file( bfs , "new.0" , 7 , 77 );
+    for (int i = 1; i < 20; i++) {
+      char * filename = util_alloc_sprintf("new.%d" , i);
+      assert_int_file( bfs , filename , i + 1 , 1000 * i );
+      free( filename );
+    }
+
+    vector_free( buffers );
+    stringlist_free( filenames );
+    block_fs_close( bfs , false );
+  }
+
+  for (int remount = 0; remount < 2; remount++) {
+    block_fs_type * bfs;
+    if (remount == 1)
+      unlink( "test.index" );
+
+    bfs = block_fs_mount( "test.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    assert_int_file( bfs , "inplace" , 5 , 100 );
+    assert_int_file( bfs , "grow" , 1000 , 200 );
+    assert_int_file( bfs , "new.0" , 7 , 77 );
+    assert_int_file( bfs , "new.19" , 20 , 19000 );
+    {
+      vector_type * files = block_fs_alloc_filelist( bfs , NULL , NO_SORT , false );
+      test_assert_int_equal( 22 , vector_get_size( files ));
+      vector_free( files );
+    }
+    block_fs_close( bfs , false );
+  }
+  test_work_area_free( work_area );
+}
+
+
+static void fwrite_batch1( block_fs_type * bfs , const char * filename , int size , int value ) {
+  stringlist_type * filenames = stringlist_alloc_new();
+  vector_type * buffers = vector_alloc_new();
+
+  stringlist_append_copy( filenames , filename );
+  vector_append_owned_ref( buffers , alloc_int_buffer( size , value ) , free_buffer__ );
+  block_fs_fwrite_batch( bfs , filenames , buffers );
+
+  vector_free( buffers );
+  stringlist_free( filenames );
+}
+
+
+/*
+  The batch write should reuse the nodes on the free list instead of
+  growing the data file, but never place a file in a free node located
+  before the node it replaces.
+*/
+
+void test_batch_free_list( ) {
+  test_work_area_type * work_area = test_work_area_alloc("block_fs/batch_free_list");
+  {
+    block_fs_type * bfs = block_fs_mount( "test.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    size_t data_size;
+
+    fwrite_batch1( bfs , "a" , 1000 , 0 );
+    fwrite_batch1( bfs , "b" , 10 , 0 );
+    fwrite_batch1( bfs , "a" , 2000 , 1 );     /* The old node of "a" goes to the free list. */
+    block_fs_fsync( bfs );
+    data_size = util_file_size( "test.data_0" );
+
+    fwrite_batch1( bfs , "c" , 1000 , 2 );     /* Reuses the old node of "a". */
+    block_fs_fsync( bfs );
+    test_assert_long_equal( data_size , util_file_size( "test.data_0" ));
+
+    fwrite_batch1( bfs , "b" , 500 , 3 );
+    fwrite_batch1( bfs , "c" , 4000 , 4 );     /* The old node of "c" goes to the free list. */
+    block_fs_fsync( bfs );
+    data_size = util_file_size( "test.data_0" );
+
+    fwrite_batch1( bfs , "b" , 900 , 5 );      /* The free node is located before the node of "b" - must append. */
+    block_fs_fsync( bfs );
+    test_assert_true( util_file_size( "test.data_0" ) > data_size );
+    block_fs_close( bfs , false );
+  }
+
+  for (int remount = 0; remount < 2; remount++) {
+    block_fs_type * bfs;
+    if (remount == 1)
+      unlink( "test.index" );
+
+    bfs = block_fs_mount( "test.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    assert_int_file( bfs , "a" , 2000 , 1 );
+    assert_int_file( bfs , "b" , 900 , 5 );
+    assert_int_file( bfs , "c" , 4000 , 4 );
+    block_fs_close( bfs , false );
+  }
+  test_work_area_free( work_area );
+}
+
+
 int main(int argc , char ** argv) {
   test_readonly();
   test_lock_conflict();
+  test_codec();
+  test_batch();
+  test_batch_free_list();
   exit(0);
 }
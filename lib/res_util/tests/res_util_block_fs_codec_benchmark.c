@@ -0,0 +1,136 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'res_util_block_fs_codec_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Compression ratio and write/read throughput of the block_fs codecs
+  for payloads similar to the real ones: a layered porosity FIELD and
+  a declining rate summary vector. The benchmark is not part of the
+  test suite, run it manually as:
+
+     res_util_block_fs_codec_benchmark [field_files] [summary_files]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/res_util/block_fs.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static void benchmark_payload( const char * name , const void * data , int data_size , int num_files ) {
+  block_fs_codec_type codec_list[3] = { BLOCK_FS_CODEC_NONE , BLOCK_FS_CODEC_ZLIB , BLOCK_FS_CODEC_SHUFFLE_RLE };
+  const char * codec_names[3]       = { "none" , "zlib" , "shuffle_rle" };
+  char * read_data = util_malloc( data_size );
+
+  for (int ic = 0; ic < 3; ic++) {
+    test_work_area_type * work_area = test_work_area_alloc("block_fs/codec_benchmark");
+    block_fs_type * bfs = block_fs_mount( "bench.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    double write_time , read_time;
+    long stored_size = 0;
+
+    block_fs_set_codec( bfs , codec_list[ic] );
+    {
+      double start = wall_clock( );
+      for (int i = 0; i < num_files; i++) {
+        char * filename = util_alloc_sprintf("%s.%d" , name , i);
+        block_fs_fwrite_file( bfs , filename , data , data_size );
+        free( filename );
+      }
+      write_time = wall_clock( ) - start;
+    }
+
+    {
+      double start = wall_clock( );
+      for (int i = 0; i < num_files; i++) {
+        char * filename = util_alloc_sprintf("%s.%d" , name , i);
+        block_fs_fread_file( bfs , filename , read_data );
+        stored_size += block_fs_get_stored_size( bfs , filename );
+        free( filename );
+      }
+      read_time = wall_clock( ) - start;
+    }
+    test_assert_true( memcmp( data , read_data , data_size ) == 0 );
+
+    {
+      double MB = 1.0 * data_size * num_files / (1024 * 1024);
+      printf("%-8s %-12s ratio: %6.2f  write: %8.1f MB/s  read: %8.1f MB/s\n", name , codec_names[ic] ,
+             1.0 * data_size * num_files / stored_size ,
+             MB / util_double_max( write_time , 1e-6 ) ,
+             MB / util_double_max( read_time , 1e-6 ));
+    }
+
+    block_fs_close( bfs , false );
+    test_work_area_free( work_area );
+  }
+  free( read_data );
+}
+
+
+int main( int argc , char ** argv ) {
+  int field_files   = int_arg( argc , argv , 1 , 20 );
+  int summary_files = int_arg( argc , argv , 2 , 2000 );
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+
+  /* FIELD: A float porosity field of 100x100x20 cells with a layered structure. */
+  {
+    const int nx = 100, ny = 100, nz = 20;
+    float * poro = util_malloc( nx * ny * nz * sizeof * poro );
+    for (int k = 0; k < nz; k++) {
+      float layer_mean = 0.15 + 0.1 * (k % 3);
+      for (int j = 0; j < ny; j++)
+        for (int i = 0; i < nx; i++)
+          poro[ i + j * nx + k * nx * ny ] = layer_mean + 0.02 * rng_get_double( rng );
+    }
+    benchmark_payload( "FIELD" , poro , nx * ny * nz * sizeof * poro , field_files );
+    free( poro );
+  }
+
+  /* Summary: a rate vector with 500 report steps, shut in for the first 100 steps. */
+  {
+    const int time_size = 500;
+    double * rate = util_malloc( time_size * sizeof * rate );
+    for (int step = 0; step < time_size; step++)
+      rate[step] = (step < 100) ? 0 : 1000 * exp( -0.005 * (step - 100));
+    benchmark_payload( "SUMMARY" , rate , time_size * sizeof * rate , summary_files );
+    free( rate );
+  }
+
+  rng_free( rng );
+  exit(0);
+}
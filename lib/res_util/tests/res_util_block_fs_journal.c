@@ -0,0 +1,304 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'res_util_block_fs_journal.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/util/buffer.h>
+#include <ert/util/vector.h>
+#include <ert/util/stringlist.h>
+
+#include <ert/res_util/block_fs.h>
+
+#define NUM_KEYS 50
+
+
+static block_fs_type * mount_fs( ) {
+  return block_fs_mount( "test.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+}
+
+
+/*
+  The content of version v of a file: the size varies with the
+  version, so that nodes are both overwritten in place and moved.
+*/
+
+static buffer_type * alloc_content( int version ) {
+  buffer_type * buffer = buffer_alloc( 1024 );
+  int size = 16 + (version % 7) * 300;
+  for (int i = 0; i < size; i++)
+    buffer_fwrite_int( buffer , version + i );
+  return buffer;
+}
+
+
+static void free_buffer__( void * arg ) {
+  buffer_free( (buffer_type *) arg );
+}
+
+
+/*
+  Returns the version stored in 'filename', or -1 if the file does not
+  exist; the content must be intact.
+*/
+
+static int read_version( block_fs_type * bfs , const char * filename ) {
+  int version = -1;
+  if (block_fs_has_file( bfs , filename )) {
+    buffer_type * buffer = buffer_alloc( 1024 );
+    block_fs_fread_realloc_buffer( bfs , filename , buffer );
+    version = buffer_fread_int( buffer );
+    {
+      buffer_type * expected = alloc_content( version );
+      test_assert_int_equal( buffer_get_size( expected ) , buffer_get_size( buffer ));
+      test_assert_true( memcmp( buffer_get_data( expected ) , buffer_get_data( buffer ) , buffer_get_size( buffer )) == 0 );
+      buffer_free( expected );
+    }
+    buffer_free( buffer );
+  }
+  return version;
+}
+
+
+static void log_line( int log_fd , const char * fmt , int key , int version ) {
+  char line[64];
+  int length = snprintf( line , sizeof line , fmt , key , version );
+  test_assert_int_equal( length , write( log_fd , line , length ));
+}
+
+
+/*
+  The child process: writes, unlinks and batch writes random files
+  until it is killed. Before an operation the affected keys are logged
+  with "B key version" (version -1 for unlink) and when the operation
+  has returned "D" is logged.
+*/
+
+static void run_writer( int seed , int checkpoint_interval ) {
+  int log_fd = open( "ops.log" , O_WRONLY | O_APPEND | O_CREAT , 0644 );
+  block_fs_type * bfs = mount_fs( );
+  int version = seed * 100000;
+  srand( seed );
+
+  block_fs_set_checkpoint_interval( bfs , checkpoint_interval );
+  while (true) {
+    int op = rand() % 10;
+    int key = rand() % NUM_KEYS;
+    char * filename = util_alloc_sprintf("key.%d" , key );
+
+    version++;
+    if (op < 6) {
+      buffer_type * buffer = alloc_content( version );
+      log_line( log_fd , "B %d %d\n" , key , version );
+      block_fs_fwrite_buffer( bfs , filename , buffer );
+      buffer_free( buffer );
+    } else if (op < 8) {
+      if (block_fs_has_file( bfs , filename )) {
+        log_line( log_fd , "B %d %d\n" , key , -1 );
+        block_fs_unlink_file( bfs , filename );
+      }
+    } else {
+      stringlist_type * filenames = stringlist_alloc_new( );
+      vector_type * buffers = vector_alloc_new( );
+      for (int i = 0; i < 5; i++) {
+        int batch_key = (key + 3 * i) % NUM_KEYS;
+        stringlist_append_owned_ref( filenames , util_alloc_sprintf("key.%d" , batch_key ));
+        vector_append_owned_ref( buffers , alloc_content( version + i ) , free_buffer__ );
+        log_line( log_fd , "B %d %d\n" , batch_key , version + i );
+      }
+      block_fs_fwrite_batch( bfs , filenames , buffers );
+      version += 5;
+      vector_free( buffers );
+      stringlist_free( filenames );
+    }
+    log_line( log_fd , "D %d %d\n" , 0 , 0 );
+    free( filename );
+  }
+}
+
+
+/*
+  Applies the log of the killed writer to @committed; the keys of the
+  operation which was in progress are marked in @in_flight with the
+  version which was being written.
+*/
+
+static void load_log( int * committed , int * in_flight ) {
+  FILE * stream = util_fopen( "ops.log" , "r");
+  char tag;
+  int key , version;
+
+  for (int key = 0; key < NUM_KEYS; key++)
+    in_flight[key] = -2;
+
+  while (fscanf( stream , " %c %d %d" , &tag , &key , &version ) == 3) {
+    if (tag == 'B')
+      in_flight[key] = version;
+    else {
+      for (int k = 0; k < NUM_KEYS; k++) {
+        if (in_flight[k] != -2)
+          committed[k] = in_flight[k];
+        in_flight[k] = -2;
+      }
+    }
+  }
+  fclose( stream );
+  unlink( "ops.log" );
+}
+
+
+/*
+  Kills the writer at random points, and checks after every crash
+  that the filesystem mounts without a scan of the data file, that
+  every operation which completed before the crash is present, and
+  that a file touched by the operation in progress has either the old
+  or the new content. A write which must move the file to a larger
+  node releases the old node first, so such a file can also be gone.
+*/
+
+void test_crash_recovery( int num_crashes , int checkpoint_interval ) {
+  test_work_area_type * work_area = test_work_area_alloc("block_fs/journal_crash");
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  int committed[NUM_KEYS];
+  int in_flight[NUM_KEYS];
+  int journal_mounts = 0;
+
+  for (int key = 0; key < NUM_KEYS; key++)
+    committed[key] = -1;
+
+  block_fs_close( mount_fs( ) , false );
+  for (int crash = 0; crash < num_crashes; crash++) {
+    pid_t pid = fork();
+
+    if (pid == 0) {
+      run_writer( crash + 1 , checkpoint_interval );
+      _exit( 0 );
+    }
+
+    usleep( 2000 + rng_get_int( rng , 30000 ));
+    kill( pid , SIGKILL );
+    waitpid( pid , NULL , 0 );
+
+    load_log( committed , in_flight );
+    {
+      block_fs_type * bfs = mount_fs( );
+      test_assert_true( block_fs_get_mount_type( bfs ) != BLOCK_FS_MOUNT_SCAN );
+      if (block_fs_get_mount_type( bfs ) == BLOCK_FS_MOUNT_JOURNAL)
+        journal_mounts++;
+
+      for (int key = 0; key < NUM_KEYS; key++) {
+        char * filename = util_alloc_sprintf("key.%d" , key );
+        int version = read_version( bfs , filename );
+
+        if (version != committed[key]) {
+          bool in_flight_ok = (in_flight[key] != -2) && ((version == in_flight[key]) || (version == -1));
+          if (!in_flight_ok)
+            fprintf(stderr,"crash:%d key:%d found version:%d expected:%d or:%d \n", crash , key , version , committed[key] , in_flight[key]);
+          test_assert_true( in_flight_ok );
+        }
+        committed[key] = version;
+        free( filename );
+      }
+
+      /* A clean close after the recovery should give a clean mount. */
+      block_fs_close( bfs , false );
+      bfs = mount_fs( );
+      test_assert_int_equal( BLOCK_FS_MOUNT_INDEX , block_fs_get_mount_type( bfs ));
+      for (int key = 0; key < NUM_KEYS; key++) {
+        char * filename = util_alloc_sprintf("key.%d" , key );
+        test_assert_int_equal( committed[key] , read_version( bfs , filename ));
+        free( filename );
+      }
+      block_fs_close( bfs , false );
+    }
+  }
+  test_assert_true( journal_mounts > 0 );
+
+  rng_free( rng );
+  test_work_area_free( work_area );
+}
+
+
+/*
+  A record which has been torn by the crash must end the journal; the
+  last write - whose COMMIT record is torn - is discarded.
+*/
+
+void test_torn_journal( ) {
+  test_work_area_type * work_area = test_work_area_alloc("block_fs/journal_torn");
+  pid_t pid = fork();
+
+  if (pid == 0) {
+    block_fs_type * bfs = mount_fs( );
+    buffer_type * buffer = alloc_content( 7 );
+    block_fs_set_checkpoint_interval( bfs , 0 );
+    block_fs_fwrite_buffer( bfs , "a" , buffer );
+    block_fs_fwrite_buffer( bfs , "b" , buffer );
+    block_fs_unlink_file( bfs , "a" );
+    block_fs_fwrite_buffer( bfs , "c" , buffer );
+    buffer_free( buffer );
+    _exit( 0 );
+  }
+  waitpid( pid , NULL , 0 );
+
+  test_assert_true( util_file_exists( "test.journal" ));
+  test_assert_int_equal( 0 , truncate( "test.journal" , util_file_size( "test.journal" ) - 3 ));
+  {
+    block_fs_type * bfs = mount_fs( );
+    test_assert_int_equal( BLOCK_FS_MOUNT_JOURNAL , block_fs_get_mount_type( bfs ));
+    test_assert_false( block_fs_has_file( bfs , "a" ));
+    test_assert_int_equal( 7 , read_version( bfs , "b" ));
+    test_assert_false( block_fs_has_file( bfs , "c" ));
+    {
+      buffer_type * buffer = alloc_content( 8 );
+      block_fs_fwrite_buffer( bfs , "c" , buffer );
+      buffer_free( buffer );
+    }
+    block_fs_close( bfs , false );
+  }
+
+  /* The discarded node has been marked as free in the data file, a full scan gives the same result. */
+  unlink( "test.index" );
+  unlink( "test.journal" );
+  {
+    block_fs_type * bfs = mount_fs( );
+    test_assert_int_equal( BLOCK_FS_MOUNT_SCAN , block_fs_get_mount_type( bfs ));
+    test_assert_false( block_fs_has_file( bfs , "a" ));
+    test_assert_int_equal( 7 , read_version( bfs , "b" ));
+    test_assert_int_equal( 8 , read_version( bfs , "c" ));
+    block_fs_close( bfs , false );
+  }
+  test_work_area_free( work_area );
+}
+
+
+int main(int argc , char ** argv) {
+  test_torn_journal( );
+  test_crash_recovery( 25 , 0 );
+  test_crash_recovery( 25 , 20 );
+  exit(0);
+}
@@ -0,0 +1,106 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'res_util_block_fs_journal_benchmark.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Mount time after a crash with the journal, compared to a full scan of
+  the same data file. A child process writes the files and exits
+  without closing the filesystem. The benchmark is not part of the
+  test suite, run it manually as:
+
+     res_util_block_fs_journal_benchmark [num_files] [checkpoint_interval]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/buffer.h>
+
+#include <ert/res_util/block_fs.h>
+
+
+static double wall_clock( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static int int_arg( int argc , char ** argv , int index , int default_value ) {
+  int value = default_value;
+  if (argc > index)
+    util_sscanf_int( argv[index] , &value );
+  return value;
+}
+
+
+static block_fs_type * mount_fs( ) {
+  return block_fs_mount( "bench.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+}
+
+
+static double timed_mount( block_fs_mount_type expected_type ) {
+  double start = wall_clock( );
+  block_fs_type * bfs = mount_fs( );
+  double elapsed = wall_clock( ) - start;
+
+  test_assert_int_equal( expected_type , block_fs_get_mount_type( bfs ));
+  block_fs_close( bfs , false );
+  return elapsed;
+}
+
+
+int main(int argc , char ** argv) {
+  const int num_files           = int_arg( argc , argv , 1 , 10000 );
+  const int checkpoint_interval = int_arg( argc , argv , 2 , 1500 );
+  test_work_area_type * work_area = test_work_area_alloc("block_fs/journal_benchmark");
+  double journal_time , scan_time;
+  pid_t pid = fork();
+
+  if (pid == 0) {
+    block_fs_type * bfs = mount_fs( );
+    block_fs_set_checkpoint_interval( bfs , checkpoint_interval );
+    for (int i = 0; i < num_files; i++) {
+      char * filename = util_alloc_sprintf("file.%d" , i );
+      buffer_type * buffer = buffer_alloc( 1024 );
+      int size = 16 + (i % 7) * 300;
+      for (int j = 0; j < size; j++)
+        buffer_fwrite_int( buffer , i + j );
+      block_fs_fwrite_buffer( bfs , filename , buffer );
+      buffer_free( buffer );
+      free( filename );
+    }
+    _exit( 0 );
+  }
+  waitpid( pid , NULL , 0 );
+
+  journal_time = timed_mount( BLOCK_FS_MOUNT_JOURNAL );
+  unlink( "bench.index" );
+  unlink( "bench.journal" );
+  scan_time = timed_mount( BLOCK_FS_MOUNT_SCAN );
+
+  printf("Mount after crash with %d files: journal: %.3f s  full scan: %.3f s\n", num_files , journal_time , scan_time );
+  test_work_area_free( work_area );
+  exit(0);
+}
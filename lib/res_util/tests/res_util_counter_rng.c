@@ -0,0 +1,127 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'res_util_counter_rng.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+
+#include <ert/res_util/counter_rng.h>
+
+
+/*
+  Known answer vectors for Philox4x32-10 from the Random123
+  distribution. The counter is laid out as (index lo, index hi, iens,
+  stream), so an all zero / all ones counter can be reproduced.
+*/
+
+void test_known_answer( ) {
+  unsigned int output[4];
+  {
+    counter_rng_type * crng = counter_rng_alloc( 0 , 0 );
+    test_assert_true( counter_rng_is_instance( crng ));
+    counter_rng_get_uint4( crng , 0 , 0 , 0 , output );
+    test_assert_uint_equal( 0x6627e8d5 , output[0] );
+    test_assert_uint_equal( 0xe169c58d , output[1] );
+    test_assert_uint_equal( 0xbc57ac4c , output[2] );
+    test_assert_uint_equal( 0x9b00dbd8 , output[3] );
+    counter_rng_free( crng );
+  }
+  {
+    counter_rng_type * crng = counter_rng_alloc( 0xffffffff , 0xffffffff );
+    counter_rng_get_uint4( crng , 0xffffffff , -1 , -1L , output );
+    test_assert_uint_equal( 0x408f276d , output[0] );
+    test_assert_uint_equal( 0x41c83b0e , output[1] );
+    test_assert_uint_equal( 0xa20bc7c6 , output[2] );
+    test_assert_uint_equal( 0x6d5451fd , output[3] );
+    counter_rng_free( crng );
+  }
+}
+
+
+/*
+  The value for (stream, iens, index) must not depend on which other
+  values have been drawn, or in which order.
+*/
+
+void test_order_independent( ) {
+  const int ens_size = 25;
+  const int size = 100;
+  counter_rng_type * crng = counter_rng_alloc( 1234 , 5678 );
+  unsigned int stream = counter_rng_stream_id( 2 , "MINISTEP" );
+  double * forward = util_calloc( ens_size * size , sizeof * forward );
+
+  for (int iens = 0; iens < ens_size; iens++)
+    counter_rng_std_normal_vector( crng , stream , iens , 0 , size , &forward[iens] , ens_size );
+
+  for (int iens = ens_size - 1; iens >= 0; iens--)
+    for (int i = size - 1; i >= 0; i--)
+      test_assert_double_equal( forward[i * ens_size + iens] , counter_rng_std_normal( crng , stream , iens , i ));
+
+  {
+    double * tail = util_calloc( size , sizeof * tail );
+    counter_rng_std_normal_vector( crng , stream , 7 , size / 2 , size / 2 , tail , 1 );
+    for (int i = 0; i < size / 2; i++)
+      test_assert_double_equal( forward[(i + size / 2) * ens_size + 7] , tail[i] );
+    free( tail );
+  }
+
+  test_assert_true( counter_rng_std_normal( crng , stream , 0 , 0 ) !=
+                    counter_rng_std_normal( crng , counter_rng_stream_id( 2 , "OTHER" ) , 0 , 0 ));
+
+  free( forward );
+  counter_rng_free( crng );
+}
+
+
+void test_distribution( ) {
+  const int size = 200000;
+  counter_rng_type * crng = counter_rng_alloc( 42 , 0 );
+  double * data = util_calloc( size , sizeof * data );
+  double sum = 0;
+  double sum2 = 0;
+
+  for (int i = 0; i < size; i++) {
+    double u = counter_rng_get_double( crng , 1 , 0 , i );
+    test_assert_true( u >= 0 );
+    test_assert_true( u < 1 );
+  }
+
+  counter_rng_std_normal_vector( crng , 1 , 0 , 0 , size , data , 1 );
+  for (int i = 0; i < size; i++) {
+    sum  += data[i];
+    sum2 += data[i] * data[i];
+  }
+  {
+    double mean = sum / size;
+    double var  = sum2 / size - mean * mean;
+    test_assert_true( fabs( mean ) < 0.01 );
+    test_assert_true( fabs( var - 1.0 ) < 0.02 );
+  }
+
+  free( data );
+  counter_rng_free( crng );
+}
+
+
+int main(int argc , char ** argv) {
+  test_known_answer( );
+  test_order_independent( );
+  test_distribution( );
+  exit(0);
+}
@@ -0,0 +1,91 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'res_util_file_wait.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/res_util/file_wait.h>
+
+
+static double clock_seconds( ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC , &ts );
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+static void * create_file( void * arg ) {
+  const char * filename = arg;
+  usleep( 100000 );
+  {
+    FILE * stream = util_fopen( filename , "w" );
+    fclose( stream );
+  }
+  return NULL;
+}
+
+
+void test_existing( ) {
+  const char * files[3] = { "does/not/exist" , NULL , "path/EXIT" };
+  util_make_path( "path" );
+  {
+    FILE * stream = util_fopen( "path/EXIT" , "w" );
+    fclose( stream );
+  }
+  test_assert_int_equal( 2 , file_wait_any( files , 3 , 0 ));
+  test_assert_int_equal( 2 , file_wait_any( files , 3 , 10 ));
+  remove( "path/EXIT" );
+}
+
+
+void test_timeout( ) {
+  const char * files[2] = { "path/OK" , "path/EXIT" };
+  double start = clock_seconds( );
+  test_assert_int_equal( -1 , file_wait_any( files , 2 , 0.25 ));
+  test_assert_true( clock_seconds( ) - start >= 0.25 );
+  test_assert_true( clock_seconds( ) - start < 1.0 );
+}
+
+
+void test_wait( ) {
+  const char * files[2] = { "path/OK" , "path/EXIT" };
+  pthread_t thread;
+  double start = clock_seconds( );
+
+  pthread_create( &thread , NULL , create_file , "path/OK" );
+  test_assert_int_equal( 0 , file_wait_any( files , 2 , 10 ));
+  test_assert_true( clock_seconds( ) - start < 0.9 );
+  pthread_join( thread , NULL );
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "file_wait" );
+  printf( "Using inotify: %s\n" , file_wait_use_inotify( "." ) ? "yes" : "no" );
+  test_existing( );
+  test_timeout( );
+  test_wait( );
+  test_work_area_free( work_area );
+  exit(0);
+}
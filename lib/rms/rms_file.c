@@ -29,6 +29,7 @@
 #include <ert/rms/rms_util.h>
 #include <ert/rms/rms_tag.h>
 #include <ert/rms/rms_file.h>
+#include <ert/rms/rms_file_index.h>
 #include <ert/rms/rms_tagkey.h>
 
 #include <ert/ecl/ecl_kw.h>
@@ -238,42 +239,42 @@ static void rms_file_init_fread(rms_file_type * rms_file) {
 }
 
 
+/*
+  The tag is located with an rms_file_index, which only reads the tag
+  and key headers of the file and skips the data payloads; the stream
+  is then positioned directly at the matching tag, so only the
+  requested tag is read and allocated.
+*/
+
 rms_tag_type * rms_file_fread_alloc_tag(rms_file_type * rms_file,
                                         const char *tagname,
                                         const char *keyname,
                                         const char *keyvalue) {
   rms_tag_type * tag = NULL;
-  rms_file_fopen_r(rms_file);
-
-  long int start_pos = util_ftell(rms_file->stream);
-  util_fseek(rms_file->stream , 0 , SEEK_SET);
-  rms_file_init_fread(rms_file);
-  while (true) {
-    bool eof_tag = false;  // will be set by rms_tag
-    rms_tag_type * tmp_tag = rms_tag_fread_alloc(rms_file->stream,
-                                                 rms_file->type_map,
-                                                 rms_file->endian_convert,
-                                                 &eof_tag);
-
-    if (!rms_tag_name_eq(tmp_tag, tagname, keyname, keyvalue)) {
-      rms_tag_free(tmp_tag);
-      continue;
-    }
-    tag = tmp_tag;
-    break;
-  }
+  rms_file_index_type * index = rms_file_index_alloc(rms_file->filename);
+  int tag_nr = rms_file_index_find_tag(index, tagname, keyname, keyvalue);
 
-  if (tag == NULL) {
-    util_fseek(rms_file->stream , start_pos , SEEK_SET);
+  if (tag_nr < 0)
     util_abort("%s: could not find tag: \"%s\" (with %s=%s) in file:%s - aborting.\n",
                __func__,
                tagname,
                keyname,
                keyvalue,
                rms_file->filename);
-  }
 
+  rms_file->fmt_file = false;
+  rms_file->endian_convert = rms_file_index_get_endian_convert(index);
+  rms_file_fopen_r(rms_file);
+  util_fseek(rms_file->stream , rms_file_index_iget_tag_offset(index, tag_nr) , SEEK_SET);
+  {
+    bool eof_tag = false;
+    tag = rms_tag_fread_alloc(rms_file->stream,
+                              rms_file->type_map,
+                              rms_file->endian_convert,
+                              &eof_tag);
+  }
   rms_file_fclose(rms_file);
+  rms_file_index_free(index);
   return tag;
 }
 
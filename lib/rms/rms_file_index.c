@@ -0,0 +1,437 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'rms_file_index.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/vector.h>
+
+#include <ert/rms/rms_type.h>
+#include <ert/rms/rms_file_index.h>
+
+/**
+   The rms_file_index is an index of the tags and tagkeys in a binary
+   ROFF file, built in one pass over the file where only the headers
+   are read and the data payloads are skipped with fseek(). For every
+   tagkey the type, the number of elements and the file offset of the
+   data is stored; the scalar values - e.g. the parameter names and
+   the dimensions - are stored in the index.
+
+   With the index a data array can be read directly from the file into
+   a buffer supplied by the caller, without reading or allocating any
+   of the other tags in the file.
+*/
+
+#define RMS_INDEX_MAX_STRING 1024
+#define RMS_INDEX_BUFFER_SIZE 65536
+
+typedef struct {
+  char          * name;
+  rms_type_enum   rms_type;
+  int             sizeof_ctype;
+  int             size;
+  bool            is_array;
+  long            data_offset;
+  char          * string_value;    /* Only for scalar char keys. */
+  char            scalar[8];       /* Raw bytes of scalar numeric keys. */
+} rms_key_index_type;
+
+
+typedef struct {
+  char          * name;
+  long            offset;          /* File offset of the "tag" string. */
+  vector_type   * keys;
+} rms_tag_index_type;
+
+
+struct rms_file_index_struct {
+  char          * filename;
+  bool            endian_convert;
+  vector_type   * tags;
+};
+
+
+/*****************************************************************/
+
+static void rms_key_index_free__( void * arg ) {
+  rms_key_index_type * key = (rms_key_index_type *) arg;
+  free( key->name );
+  free( key->string_value );
+  free( key );
+}
+
+
+static rms_tag_index_type * rms_tag_index_alloc( const char * name , long offset ) {
+  rms_tag_index_type * tag = util_malloc( sizeof * tag );
+  tag->name   = util_alloc_string_copy( name );
+  tag->offset = offset;
+  tag->keys   = vector_alloc_new();
+  return tag;
+}
+
+
+static void rms_tag_index_free__( void * arg ) {
+  rms_tag_index_type * tag = (rms_tag_index_type *) arg;
+  free( tag->name );
+  vector_free( tag->keys );
+  free( tag );
+}
+
+
+static const rms_key_index_type * rms_tag_index_get_key( const rms_tag_index_type * tag , const char * keyname ) {
+  for (int i = 0; i < vector_get_size( tag->keys ); i++) {
+    const rms_key_index_type * key = vector_iget_const( tag->keys , i );
+    if (strcmp( key->name , keyname ) == 0)
+      return key;
+  }
+  return NULL;
+}
+
+
+/*****************************************************************/
+
+/*
+  Reads a \0 terminated string; the stream is buffered so reading one
+  character at a time with getc() is cheap. Returns false on EOF.
+*/
+
+static bool rms_file_index_fread_string( FILE * stream , char * string ) {
+  int pos = 0;
+  while (true) {
+    int c = getc( stream );
+    if (c == EOF)
+      return false;
+
+    if (pos == RMS_INDEX_MAX_STRING)
+      util_abort("%s: string too long - not a valid ROFF file?\n",__func__);
+
+    string[pos] = c;
+    if (c == 0)
+      return true;
+    pos++;
+  }
+}
+
+
+static void rms_file_index_fskip_string( FILE * stream ) {
+  int c;
+  do {
+    c = getc( stream );
+  } while (c != 0 && c != EOF);
+}
+
+
+static bool rms_file_index_set_type( rms_key_index_type * key , const char * type_string ) {
+  static const char * type_names[6] = {"char" , "float" , "double" , "bool" , "byte" , "int"};
+  static const rms_type_enum types[6] = {rms_char_type , rms_float_type , rms_double_type , rms_bool_type , rms_byte_type , rms_int_type};
+  static const int sizes[6] = {1 , 4 , 8 , 1 , 1 , 4};
+
+  for (int i = 0; i < 6; i++) {
+    if (strcmp( type_names[i] , type_string ) == 0) {
+      key->rms_type     = types[i];
+      key->sizeof_ctype = sizes[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+
+static rms_key_index_type * rms_file_index_fread_key( rms_file_index_type * index , FILE * stream , const char * first_string ) {
+  rms_key_index_type * key = util_malloc( sizeof * key );
+  char string[RMS_INDEX_MAX_STRING];
+
+  key->string_value = NULL;
+  key->is_array     = (strcmp( first_string , "array" ) == 0);
+  if (key->is_array) {
+    if (!rms_file_index_fread_string( stream , string ))
+      util_abort("%s: premature EOF in:%s \n",__func__ , index->filename);
+  } else
+    strcpy( string , first_string );
+
+  if (!rms_file_index_set_type( key , string ))
+    util_abort("%s: unknown type:%s in:%s \n",__func__ , string , index->filename);
+
+  if (!rms_file_index_fread_string( stream , string ))
+    util_abort("%s: premature EOF in:%s \n",__func__ , index->filename);
+  key->name = util_alloc_string_copy( string );
+
+  if (key->is_array) {
+    if (fread( &key->size , sizeof key->size , 1 , stream ) != 1)
+      util_abort("%s: premature EOF in:%s \n",__func__ , index->filename);
+    if (index->endian_convert)
+      util_endian_flip_vector( &key->size , sizeof key->size , 1 );
+  } else
+    key->size = 1;
+
+  key->data_offset = util_ftell( stream );
+  if (key->rms_type == rms_char_type) {
+    if (key->is_array) {
+      for (int i = 0; i < key->size; i++)
+        rms_file_index_fskip_string( stream );
+    } else {
+      if (!rms_file_index_fread_string( stream , string ))
+        util_abort("%s: premature EOF in:%s \n",__func__ , index->filename);
+      key->string_value = util_alloc_string_copy( string );
+    }
+  } else {
+    long data_size = (long) key->size * key->sizeof_ctype;
+    if (key->is_array)
+      util_fseek( stream , data_size , SEEK_CUR );
+    else if (fread( key->scalar , 1 , key->sizeof_ctype , stream ) != key->sizeof_ctype)
+      util_abort("%s: premature EOF in:%s \n",__func__ , index->filename);
+  }
+
+  return key;
+}
+
+
+/*
+  The byteswaptest key of the filedata tag, which is the first tag in
+  the file, has the value 1 when written with the native byte order.
+*/
+
+static void rms_file_index_init_endian( rms_file_index_type * index , const rms_tag_index_type * filedata ) {
+  const rms_key_index_type * key = rms_tag_index_get_key( filedata , "byteswaptest" );
+  int byteswap_value;
+
+  if (key == NULL)
+    util_abort("%s: failed to find filedata/byteswaptest in:%s \n",__func__ , index->filename);
+
+  memcpy( &byteswap_value , key->scalar , sizeof byteswap_value );
+  index->endian_convert = (byteswap_value != 1);
+}
+
+
+static void rms_file_index_scan( rms_file_index_type * index , FILE * stream ) {
+  char string[RMS_INDEX_MAX_STRING];
+
+  if (!rms_file_index_fread_string( stream , string ) || strcmp( string , "roff-bin" ) != 0)
+    util_abort("%s: %s is not a binary ROFF file - only binary files implemented\n",__func__ , index->filename);
+
+  /* Skipping two comment lines ... */
+  rms_file_index_fskip_string( stream );
+  rms_file_index_fskip_string( stream );
+
+  while (true) {
+    long tag_offset = util_ftell( stream );
+    rms_tag_index_type * tag;
+
+    if (!rms_file_index_fread_string( stream , string ))
+      break;  /* No eof tag */
+
+    if (strcmp( string , "tag" ) != 0)
+      util_abort("%s: expected tag at offset:%ld in:%s \n",__func__ , tag_offset , index->filename);
+
+    if (!rms_file_index_fread_string( stream , string ))
+      util_abort("%s: premature EOF in:%s \n",__func__ , index->filename);
+
+    if (strcmp( string , "eof" ) == 0)
+      break;
+
+    tag = rms_tag_index_alloc( string , tag_offset );
+    while (true) {
+      if (!rms_file_index_fread_string( stream , string ))
+        util_abort("%s: premature EOF in tag:%s in:%s \n",__func__ , tag->name , index->filename);
+
+      if (strcmp( string , "endtag" ) == 0)
+        break;
+
+      vector_append_owned_ref( tag->keys , rms_file_index_fread_key( index , stream , string ) , rms_key_index_free__ );
+    }
+    vector_append_owned_ref( index->tags , tag , rms_tag_index_free__ );
+
+    if (vector_get_size( index->tags ) == 1)
+      rms_file_index_init_endian( index , tag );
+  }
+}
+
+
+rms_file_index_type * rms_file_index_alloc( const char * filename ) {
+  rms_file_index_type * index = util_malloc( sizeof * index );
+  FILE * stream = util_fopen( filename , "r" );
+
+  index->filename       = util_alloc_string_copy( filename );
+  index->endian_convert = false;
+  index->tags           = vector_alloc_new();
+
+  setvbuf( stream , NULL , _IOFBF , RMS_INDEX_BUFFER_SIZE );
+  rms_file_index_scan( index , stream );
+  fclose( stream );
+
+  return index;
+}
+
+
+void rms_file_index_free( rms_file_index_type * index ) {
+  vector_free( index->tags );
+  free( index->filename );
+  free( index );
+}
+
+
+const char * rms_file_index_get_filename( const rms_file_index_type * index ) {
+  return index->filename;
+}
+
+
+bool rms_file_index_get_endian_convert( const rms_file_index_type * index ) {
+  return index->endian_convert;
+}
+
+
+int rms_file_index_get_num_tags( const rms_file_index_type * index ) {
+  return vector_get_size( index->tags );
+}
+
+
+const char * rms_file_index_iget_tag_name( const rms_file_index_type * index , int tag_nr ) {
+  const rms_tag_index_type * tag = vector_iget_const( index->tags , tag_nr );
+  return tag->name;
+}
+
+
+long rms_file_index_iget_tag_offset( const rms_file_index_type * index , int tag_nr ) {
+  const rms_tag_index_type * tag = vector_iget_const( index->tags , tag_nr );
+  return tag->offset;
+}
+
+
+/**
+   Returns the number of the first tag with name @tagname; if
+   @keyname and @keyvalue are given the tag must also have a char key
+   @keyname with value @keyvalue - i.e. the same matching as
+   rms_tag_name_eq(). Returns -1 if no tag matches.
+*/
+
+int rms_file_index_find_tag( const rms_file_index_type * index , const char * tagname , const char * keyname , const char * keyvalue) {
+  for (int tag_nr = 0; tag_nr < vector_get_size( index->tags ); tag_nr++) {
+    const rms_tag_index_type * tag = vector_iget_const( index->tags , tag_nr );
+    if (strcmp( tag->name , tagname ) != 0)
+      continue;
+
+    if (keyname == NULL || keyvalue == NULL)
+      return tag_nr;
+
+    {
+      const rms_key_index_type * key = rms_tag_index_get_key( tag , keyname );
+      if (key != NULL && key->string_value != NULL && strcmp( key->string_value , keyvalue ) == 0)
+        return tag_nr;
+    }
+  }
+  return -1;
+}
+
+
+bool rms_file_index_has_tag( const rms_file_index_type * index , const char * tagname , const char * keyname , const char * keyvalue) {
+  return (rms_file_index_find_tag( index , tagname , keyname , keyvalue ) >= 0);
+}
+
+
+static const rms_key_index_type * rms_file_index_iget_key( const rms_file_index_type * index , int tag_nr , const char * keyname ) {
+  const rms_tag_index_type * tag = vector_iget_const( index->tags , tag_nr );
+  const rms_key_index_type * key = rms_tag_index_get_key( tag , keyname );
+  if (key == NULL)
+    util_abort("%s: tag:%s in:%s does not have key:%s \n",__func__ , tag->name , index->filename , keyname);
+  return key;
+}
+
+
+bool rms_file_index_iget_has_key( const rms_file_index_type * index , int tag_nr , const char * keyname ) {
+  const rms_tag_index_type * tag = vector_iget_const( index->tags , tag_nr );
+  return (rms_tag_index_get_key( tag , keyname ) != NULL);
+}
+
+
+int rms_file_index_iget_key_size( const rms_file_index_type * index , int tag_nr , const char * keyname ) {
+  return rms_file_index_iget_key( index , tag_nr , keyname )->size;
+}
+
+
+rms_type_enum rms_file_index_iget_key_type( const rms_file_index_type * index , int tag_nr , const char * keyname ) {
+  return rms_file_index_iget_key( index , tag_nr , keyname )->rms_type;
+}
+
+
+int rms_file_index_iget_key_sizeof_ctype( const rms_file_index_type * index , int tag_nr , const char * keyname ) {
+  return rms_file_index_iget_key( index , tag_nr , keyname )->sizeof_ctype;
+}
+
+
+const char * rms_file_index_iget_key_string( const rms_file_index_type * index , int tag_nr , const char * keyname ) {
+  const rms_key_index_type * key = rms_file_index_iget_key( index , tag_nr , keyname );
+  if (key->string_value == NULL)
+    util_abort("%s: key:%s in:%s is not a scalar char key \n",__func__ , keyname , index->filename);
+  return key->string_value;
+}
+
+
+int rms_file_index_iget_key_int( const rms_file_index_type * index , int tag_nr , const char * keyname ) {
+  const rms_key_index_type * key = rms_file_index_iget_key( index , tag_nr , keyname );
+  int value;
+
+  if (key->rms_type != rms_int_type || key->is_array)
+    util_abort("%s: key:%s in:%s is not a scalar int key \n",__func__ , keyname , index->filename);
+
+  memcpy( &value , key->scalar , sizeof value );
+  if (index->endian_convert)
+    util_endian_flip_vector( &value , sizeof value , 1 );
+  return value;
+}
+
+
+/**
+   Reads the data of a numeric key directly into @buffer, which must
+   have room for size * sizeof_ctype bytes. The data is converted to
+   the native byte order.
+*/
+
+void rms_file_index_iget_key_data( const rms_file_index_type * index , int tag_nr , const char * keyname , void * buffer ) {
+  const rms_key_index_type * key = rms_file_index_iget_key( index , tag_nr , keyname );
+  size_t data_size = (size_t) key->size * key->sizeof_ctype;
+
+  if (key->rms_type == rms_char_type)
+    util_abort("%s: key:%s in:%s is a char key \n",__func__ , keyname , index->filename);
+
+  if (key->is_array) {
+    FILE * stream = util_fopen( index->filename , "r" );
+    util_fseek( stream , key->data_offset , SEEK_SET );
+    if (fread( buffer , 1 , data_size , stream ) != data_size)
+      util_abort("%s: failed to read %zu bytes for key:%s from:%s - premature EOF?\n",__func__ , data_size , keyname , index->filename);
+    fclose( stream );
+  } else
+    memcpy( buffer , key->scalar , data_size );
+
+  if (index->endian_convert && key->sizeof_ctype > 1)
+    util_endian_flip_vector( buffer , key->sizeof_ctype , key->size );
+}
+
+
+bool rms_file_index_get_dims( const rms_file_index_type * index , int * dims ) {
+  int tag_nr = rms_file_index_find_tag( index , "dimensions" , NULL , NULL );
+  if (tag_nr < 0)
+    return false;
+
+  dims[0] = rms_file_index_iget_key_int( index , tag_nr , "nX" );
+  dims[1] = rms_file_index_iget_key_int( index , tag_nr , "nY" );
+  dims[2] = rms_file_index_iget_key_int( index , tag_nr , "nZ" );
+  return true;
+}
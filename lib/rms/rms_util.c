@@ -90,13 +90,10 @@ void rms_util_translate_undef(void * _data , int size , int sizeof_ctype , const
 
 
 void rms_util_fskip_string(FILE *stream) {
-  char c;
-  bool cont = true;
-  while (cont) {
-    fread(&c , 1 , 1 , stream);
-    if (c == 0)
-      cont = false;
-  } 
+  int c;
+  do {
+    c = getc(stream);
+  } while (c != 0 && c != EOF);
 }
 
 
@@ -119,7 +116,8 @@ bool rms_util_fread_string(char *string , int max_length , FILE *stream) {
   long int init_pos = util_ftell(stream);
   int pos = 0;
   while (cont) {
-    fread(&string[pos] , sizeof *string , 1 , stream);
+    int c = getc(stream);
+    string[pos] = (c == EOF) ? 0 : c;
     if (string[pos] == 0) {
       read_ok = true;
       cont = false;
@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2018  Statoil ASA, Norway.
+
+   The file 'rms_file_index_test.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/rms/rms_type.h>
+#include <ert/rms/rms_tag.h>
+#include <ert/rms/rms_tagkey.h>
+#include <ert/rms/rms_file.h>
+#include <ert/rms/rms_file_index.h>
+
+#define NX 4
+#define NY 3
+#define NZ 2
+
+
+static void write_roff_file(const char * filename , const float * poro , const int * facies) {
+  rms_file_type * rms_file = rms_file_alloc(filename , false);
+  FILE * stream = rms_file_fopen_w(rms_file);
+  rms_file_init_fwrite(rms_file , "parameter");
+  rms_tag_fwrite_dimensions(NX , NY , NZ , stream);
+  {
+    rms_tagkey_type * data_key = rms_tagkey_alloc_complete("data" , NX*NY*NZ , rms_float_type , poro , true);
+    rms_tag_fwrite_parameter("PORO" , data_key , stream);
+    rms_tagkey_free(data_key);
+  }
+  {
+    rms_tagkey_type * data_key = rms_tagkey_alloc_complete("data" , NX*NY*NZ , rms_int_type , facies , true);
+    rms_tag_fwrite_parameter("FACIES" , data_key , stream);
+    rms_tagkey_free(data_key);
+  }
+  rms_file_complete_fwrite(rms_file);
+  rms_file_fclose(rms_file);
+  rms_file_free(rms_file);
+}
+
+
+void test_index(const char * filename , const float * poro , const int * facies) {
+  rms_file_index_type * index = rms_file_index_alloc(filename);
+  int dims[3];
+
+  test_assert_string_equal(filename , rms_file_index_get_filename(index));
+  test_assert_false(rms_file_index_get_endian_convert(index));
+  test_assert_true(rms_file_index_get_dims(index , dims));
+  test_assert_int_equal(NX , dims[0]);
+  test_assert_int_equal(NY , dims[1]);
+  test_assert_int_equal(NZ , dims[2]);
+
+  test_assert_true(rms_file_index_has_tag(index , "parameter" , "name" , "PORO"));
+  test_assert_true(rms_file_index_has_tag(index , "parameter" , "name" , "FACIES"));
+  test_assert_false(rms_file_index_has_tag(index , "parameter" , "name" , "PERMX"));
+  test_assert_int_equal(-1 , rms_file_index_find_tag(index , "no-such-tag" , NULL , NULL));
+
+  {
+    int tag_nr = rms_file_index_find_tag(index , "parameter" , NULL , NULL);
+    test_assert_string_equal("PORO" , rms_file_index_iget_key_string(index , tag_nr , "name"));
+  }
+
+  {
+    int tag_nr = rms_file_index_find_tag(index , "parameter" , "name" , "FACIES");
+    int data[NX*NY*NZ];
+
+    test_assert_string_equal("parameter" , rms_file_index_iget_tag_name(index , tag_nr));
+    test_assert_true(rms_file_index_iget_has_key(index , tag_nr , "data"));
+    test_assert_int_equal(NX*NY*NZ , rms_file_index_iget_key_size(index , tag_nr , "data"));
+    test_assert_int_equal(rms_int_type , rms_file_index_iget_key_type(index , tag_nr , "data"));
+    test_assert_int_equal(sizeof(int) , rms_file_index_iget_key_sizeof_ctype(index , tag_nr , "data"));
+
+    rms_file_index_iget_key_data(index , tag_nr , "data" , data);
+    for (int i = 0; i < NX*NY*NZ; i++)
+      test_assert_int_equal(facies[i] , data[i]);
+  }
+
+  {
+    int tag_nr = rms_file_index_find_tag(index , "parameter" , "name" , "PORO");
+    float data[NX*NY*NZ];
+
+    rms_file_index_iget_key_data(index , tag_nr , "data" , data);
+    for (int i = 0; i < NX*NY*NZ; i++)
+      test_assert_double_equal(poro[i] , data[i]);
+  }
+
+  rms_file_index_free(index);
+}
+
+
+/*
+  The second parameter is located with the index and read with the
+  ordinary rms_tag machinery.
+*/
+
+void test_fread_alloc_tag(const char * filename , const int * facies) {
+  rms_file_type * rms_file = rms_file_alloc(filename , false);
+  rms_tagkey_type * data_key = rms_file_fread_alloc_data_tagkey(rms_file , "parameter" , "name" , "FACIES");
+  const int * data = rms_tagkey_get_data_ref(data_key);
+
+  test_assert_int_equal(rms_int_type , rms_tagkey_get_rms_type(data_key));
+  test_assert_int_equal(NX*NY*NZ , rms_tagkey_get_size(data_key));
+  for (int i = 0; i < NX*NY*NZ; i++)
+    test_assert_int_equal(facies[i] , data[i]);
+
+  rms_tagkey_free(data_key);
+  rms_file_free(rms_file);
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("rms_file_index");
+  const char * filename = "field.roff";
+  float poro[NX*NY*NZ];
+  int facies[NX*NY*NZ];
+
+  for (int i = 0; i < NX*NY*NZ; i++) {
+    poro[i]   = 0.01 * i;
+    facies[i] = i % 3;
+  }
+
+  write_roff_file(filename , poro , facies);
+  test_index(filename , poro , facies);
+  test_fread_alloc_tag(filename , facies);
+
+  test_work_area_free(work_area);
+  exit(0);
+}
@@ -53,6 +53,7 @@ class AnalysisModule(BaseCClass):
         "LOG_FILE": {"type": str, "description": "Log File"},
         "CLEAR_LOG": {"type": bool, "description": "Clear Existing Log File"},
         "LAMBDA_RECALCULATE": {"type": bool, "description": "Recalculate Lambda after each Iteration"},
+        "STATE_PATH": {"type": str, "description": "Directory for out of core RML iteration states"},
         "ENKF_TRUNCATION": {"type": float, "description": "Singular value truncation"},
         "ENKF_NCOMP": {"type": int, "description": "ENKF_NCOMP"},
         "CV_NFOLDS": {"type": int, "description": "CV_NFOLDS"},
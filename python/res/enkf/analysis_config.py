@@ -54,6 +54,8 @@ class AnalysisConfig(BaseCClass):
     _set_std_cutoff = ResPrototype("void analysis_config_set_std_cutoff(analysis_config, double)")
     _set_global_std_scaling = ResPrototype("void analysis_config_set_global_std_scaling(analysis_config, double)")
     _get_global_std_scaling = ResPrototype("double analysis_config_get_global_std_scaling(analysis_config)")
+    _get_ministep_threads = ResPrototype("int analysis_config_get_ministep_threads(analysis_config)")
+    _set_ministep_threads = ResPrototype("void analysis_config_set_ministep_threads(analysis_config, int)")
 
 
     def __init__(self, user_config_file=None):
@@ -159,6 +161,12 @@ class AnalysisConfig(BaseCClass):
     def getGlobalStdScaling(self):
         return self._get_global_std_scaling()
 
+    def getMinistepThreads(self):
+        return self._get_ministep_threads()
+
+    def setMinistepThreads(self, ministep_threads):
+        self._set_ministep_threads(ministep_threads)
+
     def haveEnoughRealisations(self, realizations, ensemble_size):
         return self._have_enough_realisations(realizations, ensemble_size)
 
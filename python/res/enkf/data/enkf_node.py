@@ -14,6 +14,8 @@
 #  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
 #  for more details.
 import sys
+import numpy
+from ecl.util.util import IntVector, DoubleVector
 from res.enkf.enums import ErtImplType
 from cwrap import BaseCClass
 from res import ResPrototype
@@ -31,6 +33,7 @@ class EnkfNode(BaseCClass):
     _store         = ResPrototype("bool  enkf_node_store(enkf_node, enkf_fs, bool, node_id)")
     _get_impl_type = ResPrototype("ert_impl_type_enum enkf_node_get_impl_type(enkf_node)")
     _ecl_write     = ResPrototype("void enkf_node_ecl_write(enkf_node, char*, void*, int)")
+    _load_gen_data_rows = ResPrototype("int enkf_node_load_gen_data_rows(enkf_config_node, enkf_fs, int, int_vector, double_vector, int_vector)", bind = False)
 
     def __init__(self, config_node, private=False):
         self._private = private
@@ -58,6 +61,26 @@ class EnkfNode(BaseCClass):
                 sys.stderr.write("** ERROR: Could not load realisation:%d - export failed" % iens)
 
 
+    @classmethod
+    def loadGenDataRows(cls, config_node, fs, iens_list, report_step = 0):
+        """Will load the GEN_DATA node for all the realizations in @iens_list
+        in one call, and return a tuple (data, sizes) where data is a numpy
+        array with one row for each realization, and sizes is a list with the
+        data size of each realization. The realizations which could not be
+        loaded have size -1; the unused elements of data are NaN.
+        """
+        iens_vector = IntVector()
+        for iens in iens_list:
+            iens_vector.append(iens)
+
+        data = DoubleVector()
+        sizes = IntVector()
+        row_size = cls._load_gen_data_rows(config_node, fs, report_step, iens_vector, data, sizes)
+        if row_size == 0:
+            return numpy.full((len(iens_vector), 0), numpy.nan), list(sizes)
+        return data.numpyCopy().reshape(len(iens_vector), row_size), list(sizes)
+
+
     def export(self , filename , file_type = None , arg = None):
         impl_type = self.getImplType()
         if impl_type == ErtImplType.FIELD:
@@ -24,6 +24,7 @@ class EnkfFs(BaseCClass):
     TYPE_NAME = "enkf_fs"
 
     _mount                = ResPrototype("void* enkf_fs_mount(char* )", bind = False)
+    _mount_lazy           = ResPrototype("void* enkf_fs_mount_lazy(char*, bool)", bind = False)
     _exists               = ResPrototype("bool  enkf_fs_exists(char*)", bind = False)
     _disk_version         = ResPrototype("int   enkf_fs_disk_version(char*)", bind = False)
     _update_disk_version  = ResPrototype("bool  enkf_fs_update_disk_version(char*, int, int)", bind = False)
@@ -34,6 +35,7 @@ class EnkfFs(BaseCClass):
     _has_vector           = ResPrototype("bool  enkf_fs_has_vector(enkf_fs,   char*,  int,   int, int)")
     _get_case_name        = ResPrototype("char* enkf_fs_get_case_name(enkf_fs)")
     _is_read_only         = ResPrototype("bool  enkf_fs_is_read_only(enkf_fs)")
+    _num_mounted_shards   = ResPrototype("int   enkf_fs_get_num_mounted_shards(enkf_fs)")
     _is_running           = ResPrototype("bool  enkf_fs_is_running(enkf_fs)")
     _fsync                = ResPrototype("void  enkf_fs_fsync(enkf_fs)")
     _create               = ResPrototype("enkf_fs_ref   enkf_fs_create_fs(char* , enkf_fs_type_enum , void* , bool)", bind = False)
@@ -42,8 +44,15 @@ class EnkfFs(BaseCClass):
     _summary_key_set      = ResPrototype("summary_key_set_ref enkf_fs_get_summary_key_set(enkf_fs)")
     _config_kw_config_set = ResPrototype("custom_kw_config_set_ref enkf_fs_get_custom_kw_config_set(enkf_fs)")
 
-    def __init__(self, mount_point):
-        c_ptr = self._mount(mount_point)
+    def __init__(self, mount_point, lazy=False, read_only=False):
+        """With lazy=True the storage shards are only mounted when a
+        realization is accessed; read_only=True gives a cheap lazy mount
+        which does not lock the case or write anything to disk.
+        """
+        if lazy or read_only:
+            c_ptr = self._mount_lazy(mount_point, read_only)
+        else:
+            c_ptr = self._mount(mount_point)
         super(EnkfFs, self).__init__(c_ptr)
 
 
@@ -77,6 +86,10 @@ class EnkfFs(BaseCClass):
         """ @rtype: bool """
         return self._is_read_only()
 
+    def numMountedShards(self):
+        """ @rtype: int """
+        return self._num_mounted_shards()
+
     def refCount(self):
         return self._get_refcount()
 
@@ -2,9 +2,11 @@ import os.path
 import re
 
 from cwrap import BaseCClass
-from ecl.util.util import StringList, BoolVector
+from ecl.util.util import StringList, BoolVector, IntVector
 from res import ResPrototype
+from res.util import Matrix
 from res.enkf import EnkfFs, StateMap, TimeMap, RealizationStateEnum, EnkfInitModeEnum
+from res.enkf.enums import ErtImplType
 
 
 def naturalSortKey(s, _nsre=re.compile('([0-9]+)')):
@@ -88,6 +90,8 @@ class EnkfFsManager(BaseCClass):
     _initialize_case_from_existing =         ResPrototype("void enkf_main_init_case_from_existing(enkf_fs_manager, enkf_fs, int, enkf_fs)")
     _custom_initialize_from_existing =       ResPrototype("void enkf_main_init_current_case_from_existing_custom(enkf_fs_manager, enkf_fs, int, stringlist, bool_vector)")
     _initialize_current_case_from_existing = ResPrototype("void enkf_main_init_current_case_from_existing(enkf_fs_manager, enkf_fs, int)")
+    _initialize_realizations_from_existing = ResPrototype("void enkf_main_init_realizations_from_existing(enkf_fs_manager, enkf_fs, enkf_fs, int_vector, int_vector, stringlist)")
+    _store_parameter_rows =                  ResPrototype("void enkf_main_store_parameter_rows(enkf_fs_manager, enkf_fs, char*, int_vector, matrix)")
 
     _alloc_readonly_state_map = ResPrototype("state_map_obj enkf_main_alloc_readonly_state_map(enkf_fs_manager, char*)")
     _alloc_readonly_time_map =  ResPrototype("time_map_obj enkf_main_alloc_readonly_time_map(enkf_fs_manager, char*)")
@@ -250,6 +254,73 @@ class EnkfFsManager(BaseCClass):
         self._initialize_case_from_existing(source_fs, source_report_step, target_fs)
 
 
+    def storeParameterValues(self, target_fs, target_iens, parameter_values):
+        """Will store the values of GEN_KW or EXT_PARAM parameters for many
+        realizations; @parameter_values is a dictionary where the value for
+        each key is a list with the values for each of the realizations in
+        @target_iens, in the order of the parameter. The case is not
+        fsynced.
+
+        @type target_fs: EnkfFs
+        @type target_iens: list of int
+        @type parameter_values: dict
+        """
+        target_vector = IntVector()
+        for iens in target_iens:
+            target_vector.append(iens)
+
+        ens_config = self.parent().ensembleConfig()
+        for key, rows in parameter_values.items():
+            config_node = ens_config[key]
+            if not config_node.getImplementationType() in (ErtImplType.GEN_KW, ErtImplType.EXT_PARAM):
+                raise ValueError("Parameter: %s is neither GEN_KW nor EXT_PARAM" % key)
+
+            if len(rows) != len(target_iens):
+                raise ValueError("Expected values for %d realizations for parameter: %s, got %d" % (len(target_iens), key, len(rows)))
+
+            columns = len(config_node.getModelConfig())
+            values = Matrix(len(rows), columns)
+            for row, row_values in enumerate(rows):
+                if len(row_values) != columns:
+                    raise ValueError("Expected %d values for parameter: %s, got %d" % (columns, key, len(row_values)))
+                for column, value in enumerate(row_values):
+                    values[row, column] = value
+
+            self._store_parameter_rows(target_fs, key, target_vector, values)
+
+
+    def initializeRealizationsFromExisting(self, source_fs, target_fs, source_iens, target_iens, parameter_values = None):
+        """Will initialize realization target_iens[k] of @target_fs from
+        realization source_iens[k] of @source_fs, for all k, in one call.
+
+        The parameters in the optional @parameter_values dictionary are not
+        copied from @source_fs, the values are stored as with
+        storeParameterValues(). The realizations are marked as initialized,
+        and the target case is fsynced once for the whole batch.
+
+        @type source_fs: EnkfFs
+        @type target_fs: EnkfFs
+        @type source_iens: list of int
+        @type target_iens: list of int
+        @type parameter_values: dict
+        """
+        if len(source_iens) != len(target_iens):
+            raise ValueError("Size mismatch: %d source and %d target realizations" % (len(source_iens), len(target_iens)))
+
+        skip_keys = StringList()
+        if parameter_values:
+            self.storeParameterValues(target_fs, target_iens, parameter_values)
+            for key in parameter_values.keys():
+                skip_keys.append(key)
+
+        source_vector = IntVector()
+        target_vector = IntVector()
+        for source, target in zip(source_iens, target_iens):
+            source_vector.append(source)
+            target_vector.append(target)
+        self._initialize_realizations_from_existing(source_fs, target_fs, source_vector, target_vector, skip_keys)
+
+
     def initializeFromScratch(self, parameter_list, run_context):
         self._initialize_from_scratch(parameter_list, run_context) 
 
@@ -31,6 +31,8 @@ class EnsemblePlotGenData(BaseCClass):
     _get        = ResPrototype("ensemble_plot_gen_data_vector_ref enkf_plot_gendata_iget(ensemble_plot_gen_data, int)")
     _min_values = ResPrototype("double_vector_ref enkf_plot_gendata_get_min_values(ensemble_plot_gen_data)")
     _max_values = ResPrototype("double_vector_ref enkf_plot_gendata_get_max_values(ensemble_plot_gen_data)")
+    _mean_values = ResPrototype("double_vector_ref enkf_plot_gendata_get_mean_values(ensemble_plot_gen_data)")
+    _std_values = ResPrototype("double_vector_ref enkf_plot_gendata_get_std_values(ensemble_plot_gen_data)")
     _free       = ResPrototype("void  enkf_plot_gendata_free(ensemble_plot_gen_data)")
 
     def __init__(self, ensemble_config_node, file_system, report_step, input_mask=None):
@@ -76,6 +78,14 @@ class EnsemblePlotGenData(BaseCClass):
         """ @rtype: DoubleVector """
         return self._min_values().setParent(self)
 
+    def getMeanValues(self):
+        """ @rtype: DoubleVector """
+        return self._mean_values().setParent(self)
+
+    def getStdValues(self):
+        """ @rtype: DoubleVector """
+        return self._std_values().setParent(self)
+
     def free(self):
         self._free()
 
@@ -79,7 +79,7 @@ from .ext_job import ExtJob
 from .ext_joblist import ExtJoblist
 from .environment_varlist import EnvironmentVarlist
 from .forward_model import ForwardModel
-from .forward_model_status import ForwardModelJobStatus, ForwardModelStatus
+from .forward_model_status import ForwardModelJobStatus, ForwardModelStatus, ForwardModelResourceSummary
 
 from .ert_script import ErtScript
 from .ert_plugin import ErtPlugin, CancelPluginException
@@ -92,3 +92,4 @@ from .workflow import Workflow
 from .workflow_runner import WorkflowRunner
 
 from .job_manager import JobManager, assert_file_executable
+from .license_semaphore import LicenseSemaphore
@@ -36,12 +36,15 @@ def _deserialize_date(serial_dt):
 
 class ForwardModelJobStatus(object):
 
-    def __init__(self, name, start_time = None, end_time = None, status = "Waiting", error=None):
+    def __init__(self, name, start_time = None, end_time = None, status = "Waiting", error=None, resources=None):
         self.start_time = start_time
         self.end_time = end_time
         self.name = name
         self.status = status
         self.error = error
+        # Dict with the resource usage of the job, see wait_child() in
+        # job_manager.py; None until the job has completed.
+        self.resources = resources
 
 
     @classmethod
@@ -51,12 +54,14 @@ class ForwardModelJobStatus(object):
         name = data["name"]
         status = data["status"]
         error = data["error"]
+        resources = data.get("resources")
 
         return cls(name,
                    start_time=start_time,
                    end_time=end_time,
                    status=status,
-                   error=error)
+                   error=error,
+                   resources=resources)
 
 
     def __str__(self):
@@ -68,7 +73,8 @@ class ForwardModelJobStatus(object):
                 "status" : self.status,
                 "error" : self.error,
                 "start_time" : _serialize_date(self.start_time),
-                "end_time" : _serialize_date(self.end_time)}
+                "end_time" : _serialize_date(self.end_time),
+                "resources" : self.resources}
 
 class ForwardModelStatus(object):
     STATUS_FILE = "status.json"
@@ -144,3 +150,110 @@ class ForwardModelStatus(object):
     def complete(self):
         self.end_time = datetime.datetime.now()
         self.dump( )
+
+
+
+class ForwardModelResourceSummary(object):
+    """Summary of the resource usage of the forward model jobs in an
+    ensemble. For every job name the summary holds a dict with:
+
+      count               : Number of realizations which reported resources.
+      max_rss             : Largest peak RSS, in bytes.
+      mean_rss            : Mean peak RSS, in bytes.
+      max_rss_realization : The realization with the largest peak RSS.
+      user_time           : Total user CPU time, in seconds.
+      system_time         : Total system CPU time, in seconds.
+      max_cpu_time        : Largest user + system CPU time for one realization.
+      read_bytes          : Total bytes read.
+      write_bytes         : Total bytes written.
+    """
+    SUMMED_FIELDS = ("user_time", "system_time", "read_bytes", "write_bytes")
+
+    def __init__(self):
+        self._jobs = {}
+        self._job_names = []
+
+
+    def add_status(self, iens, status):
+        for job in status.jobs:
+            resources = job.resources
+            if not resources:
+                continue
+
+            if not job.name in self._jobs:
+                self._job_names.append(job.name)
+                self._jobs[job.name] = {"count" : 0,
+                                        "max_rss" : 0,
+                                        "mean_rss" : 0,
+                                        "max_rss_realization" : None,
+                                        "max_cpu_time" : 0}
+                for field in self.SUMMED_FIELDS:
+                    self._jobs[job.name][field] = 0
+
+            summary = self._jobs[job.name]
+            max_rss = resources.get("max_rss") or 0
+            cpu_time = (resources.get("user_time") or 0) + (resources.get("system_time") or 0)
+
+            summary["count"] += 1
+            summary["mean_rss"] += (max_rss - summary["mean_rss"]) / float(summary["count"])
+            if summary["max_rss_realization"] is None or max_rss > summary["max_rss"]:
+                summary["max_rss"] = max_rss
+                summary["max_rss_realization"] = iens
+            summary["max_cpu_time"] = max(summary["max_cpu_time"], cpu_time)
+            for field in self.SUMMED_FIELDS:
+                summary[field] += resources.get(field) or 0
+
+
+    @classmethod
+    def load(cls, runpaths):
+        """Will create a summary from the status files in the runpaths;
+        @runpaths should be a dict {iens : runpath}. Realizations without a
+        status file are ignored.
+        """
+        summary = cls()
+        for iens in sorted(runpaths.keys()):
+            status_file = os.path.join(runpaths[iens], ForwardModelStatus.STATUS_FILE)
+            if not os.path.isfile(status_file):
+                continue
+
+            status = ForwardModelStatus.load(runpaths[iens])
+            if status is not None:
+                summary.add_status(iens, status)
+
+        return summary
+
+
+    @property
+    def job_names(self):
+        return list(self._job_names)
+
+
+    def __getitem__(self, job_name):
+        return self._jobs[job_name]
+
+
+    def __contains__(self, job_name):
+        return job_name in self._jobs
+
+
+    def __len__(self):
+        return len(self._job_names)
+
+
+    def dump_data(self):
+        return [dict(self._jobs[name], name=name) for name in self._job_names]
+
+
+    def __str__(self):
+        lines = ["%-32s %6s %12s %12s %12s %12s %12s" % ("Job", "Count", "Max RSS(MB)", "Mean RSS(MB)",
+                                                         "CPU(s)", "Read(MB)", "Write(MB)")]
+        MB = 1024.0 * 1024.0
+        for name in self._job_names:
+            s = self._jobs[name]
+            lines.append("%-32s %6d %12.1f %12.1f %12.1f %12.1f %12.1f" % (name, s["count"],
+                                                                          s["max_rss"] / MB,
+                                                                          s["mean_rss"] / MB,
+                                                                          s["user_time"] + s["system_time"],
+                                                                          s["read_bytes"] / MB,
+                                                                          s["write_bytes"] / MB))
+        return "\n".join(lines)
@@ -27,6 +27,8 @@ import pwd
 import requests
 import json
 import imp
+import re
+import fnmatch
 from ecl import EclVersion
 from res import ResVersion
 from res.job_queue import ForwardModelStatus, ForwardModelJobStatus
@@ -60,6 +62,81 @@ def cond_unlink(file):
         os.unlink(file)
 
 
+def fsync_path(path):
+    """Will fsync the file or directory @path; errors are ignored, not all
+    filesystems support fsync() of a directory."""
+    try:
+        fd = os.open(path, os.O_RDONLY)
+    except OSError:
+        return
+    try:
+        os.fsync(fd)
+    except OSError:
+        pass
+    finally:
+        os.close(fd)
+
+
+def read_proc_io(pid):
+    """Will return the io counters from /proc/<pid>/io as a dict, or None if
+    they are not available."""
+    try:
+        with open("/proc/%d/io" % pid) as f:
+            counters = {}
+            for line in f:
+                key, value = line.split(":")
+                counters[key.strip()] = int(value)
+            return counters
+    except (IOError, OSError, ValueError):
+        return None
+
+
+def wait_child(pid):
+    """Will wait for the child process @pid to complete, and return a tuple
+    (exit_status, resources) where exit_status is the raw status from
+    wait() and resources is a dict with the resource usage of the child:
+
+      max_rss      : Peak resident set size in bytes.
+      user_time    : User CPU time in seconds.
+      system_time  : System CPU time in seconds.
+      read_bytes   : Bytes read from storage.
+      write_bytes  : Bytes written to storage.
+      read_chars   : Bytes passed to read() like system calls.
+      write_chars  : Bytes passed to write() like system calls.
+
+    The io counters are taken from /proc/<pid>/io, which can only be read
+    after the child has terminated if we can wait for it without reaping
+    it, i.e. with os.waitid(); otherwise the block counts from rusage are
+    used for read_bytes and write_bytes, and the char counts are None.
+    """
+    io = None
+    if hasattr(os, "waitid") and hasattr(os, "WNOWAIT"):
+        os.waitid(os.P_PID, pid, os.WEXITED | os.WNOWAIT)
+        io = read_proc_io(pid)
+
+    _, exit_status, rusage = os.wait4(pid, 0)
+
+    # ru_maxrss is in kilobytes on Linux and in bytes on OS X.
+    max_rss = rusage.ru_maxrss
+    if sys.platform != "darwin":
+        max_rss *= 1024
+
+    resources = {"max_rss": max_rss,
+                 "user_time": rusage.ru_utime,
+                 "system_time": rusage.ru_stime}
+    if io:
+        resources.update({"read_bytes": io.get("read_bytes"),
+                          "write_bytes": io.get("write_bytes"),
+                          "read_chars": io.get("rchar"),
+                          "write_chars": io.get("wchar")})
+    else:
+        resources.update({"read_bytes": rusage.ru_inblock * 512,
+                          "write_bytes": rusage.ru_oublock * 512,
+                          "read_chars": None,
+                          "write_chars": None})
+    return exit_status, resources
+
+
 def assert_file_executable(fname):
     """The function raises an IOError if the given file is either not a file or
     not an executable.
@@ -124,8 +201,10 @@ class JobManager(object):
     STATUS_file   = "STATUS"
     OK_file       = "OK"
 
+    # Summary and restart files, unified or not, formatted or not.
+    ECLIPSE_RESULT_RE = re.compile(r"\.(F?UNSMRY|F?SMSPEC|[AS][0-9]{4}|F?UNRST|[FX][0-9]{4})$", re.IGNORECASE)
+
     DEFAULT_UMASK =  0
-    sleep_time    =  10  # Time to sleep before exiting the script - to let the disks sync up.
 
 
 
@@ -139,6 +218,7 @@ class JobManager(object):
         self._data_root = None
         self.global_environment = None
         self.global_update_path = None
+        self._result_files = []
         self.start_time = dt.now()
         if json_file is not None and os.path.isfile(json_file):
             self.job_status = ForwardModelStatus("????", self.start_time)
@@ -226,6 +306,8 @@ class JobManager(object):
             self.global_environment = _jsonGet(jobs_data, "global_environment")
         if "global_update_path" in jobs_data:
             self.global_update_path = _jsonGet(jobs_data, "global_update_path")
+        if "result_files" in jobs_data:
+            self._result_files = _jsonGet(jobs_data, "result_files")
         self.job_list = _jsonGet(jobs_data, "jobList")
         self._ensureCompatibleJobList()
         self._buildJobMap()
@@ -308,12 +390,71 @@ class JobManager(object):
             f.write("%02d:%02d:%02d  %s\n" % (now.tm_hour, now.tm_min, now.tm_sec, status))
 
 
+    def isResultFile(self, path):
+        """Returns True if @path, relative to the runpath, is one of the
+        files ERT loads after the forward model: the summary and restart
+        files, and the GEN_DATA result files listed as "result_files" in
+        jobs.json together with their "_active" files.
+        """
+        if self.ECLIPSE_RESULT_RE.search(os.path.basename(path)):
+            return True
+        for pattern in self._result_files:
+            if fnmatch.fnmatch(path, pattern) or fnmatch.fnmatch(path, pattern + "_active"):
+                return True
+        return False
+
+
+    def syncRunPath(self):
+        """Will fsync the result files in the runpath which have been
+        modified after the job manager started, see isResultFile(), and
+        the directories holding them. Returns a list of (path, size)
+        tuples for the synced files, with paths relative to the runpath.
+        """
+        start_time = time.mktime(self.start_time.timetuple())
+        files = []
+        for dirpath, _, filenames in os.walk("."):
+            dir_modified = False
+            for name in filenames:
+                path = os.path.normpath(os.path.join(dirpath, name))
+                if not self.isResultFile(path) or os.path.islink(path):
+                    continue
+                try:
+                    st = os.stat(path)
+                except OSError:
+                    continue
+                if st.st_mtime < start_time - 1:
+                    continue
+
+                fsync_path(path)
+                files.append((path, st.st_size))
+                dir_modified = True
+            if dir_modified:
+                fsync_path(dirpath)
+        return files
+
+
     def createOKFile(self):
+        """Will make the results durable, and then create the OK file.
+
+        The result files written by the forward model are fsynced, and their
+        sizes listed in the OK file; the OK file itself is written to a
+        temporary file which is fsynced and renamed, and finally the
+        directory is fsynced. When the queue sees the OK file it can
+        check the listed sizes to verify that the results are complete,
+        instead of waiting a fixed time for the disks to sync up.
+        """
         now = time.localtime()
-        with open(self.OK_file, "w") as f:
+        files = self.syncRunPath()
+        tmp_file = ".%s.tmp" % self.OK_file
+        with open(tmp_file, "w") as f:
             f.write("All jobs complete %02d:%02d:%02d \n" % (now.tm_hour, now.tm_min, now.tm_sec))
+            for path, size in files:
+                f.write("FILE %d %s\n" % (size, path))
+            f.flush()
+            os.fsync(f.fileno())
+        os.rename(tmp_file, self.OK_file)
+        fsync_path(".")
         self.postMessage(extra_fields={"status" : "OK"})
-        time.sleep(self.sleep_time)   # Let the disks sync up
 
 
     def getStartTime(self):
@@ -509,8 +650,8 @@ class JobManager(object):
                 sys.stderr.write("Failed to exec:%s error:%s\n" % (job["name"], str(e)))
                 os._exit(1)
         else:
-            _, exit_status = os.waitpid(pid, 0)
-            # The exit_status returned from os.waitpid encodes
+            exit_status, status.resources = wait_child(pid)
+            # The exit_status returned from wait_child() encodes
             # both the exit status of the external application,
             # and in case the job was killed by a signal - the
             # number of that signal.
@@ -36,6 +36,8 @@ class JobQueueManager(BaseCClass):
     _job_complete    = ResPrototype("bool job_queue_manager_job_complete( job_queue_manager , int)")
     _job_running     = ResPrototype("bool job_queue_manager_job_running( job_queue_manager , int)")
     _status_timestamp= ResPrototype("time_t job_queue_manager_get_status_timestamp(job_queue_manager)")
+    _status_change_count = ResPrototype("int job_queue_manager_get_status_change_count(job_queue_manager)")
+    _wait_status_change  = ResPrototype("int job_queue_manager_wait_status_change(job_queue_manager, int, double)")
     _global_progress_timestamp = ResPrototype("time_t job_queue_manager_get_progress_timestamp(job_queue_manager)")
     _iget_progress_timestamp = ResPrototype("time_t job_queue_manager_iget_progress_timestamp(job_queue_manager, int)")
 
@@ -64,6 +66,26 @@ class JobQueueManager(BaseCClass):
         ts = self._status_timestamp()
         return ts.datetime()
 
+    def status_change_count(self):
+        """
+        Will return a counter which is incremented on every status change.
+        """
+        return self._status_change_count()
+
+
+    def wait_status_change(self, change_count, timeout = None):
+        """Will block until the status change counter differs from
+        @change_count, or @timeout seconds have passed, and return the new
+        counter. The queue stopping also counts as a change.
+
+        Get the counter with status_change_count() *before* inspecting the
+        jobs, otherwise a change in between can be missed.
+        """
+        if timeout is None:
+            timeout = -1
+        return self._wait_status_change(change_count, timeout)
+
+
     def progress_timestamp(self, job_index = None):
         """Will return the timestamp of last progress update.
 
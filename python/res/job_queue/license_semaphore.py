@@ -0,0 +1,233 @@
+#  Copyright (C) 2018  Statoil ASA, Norway.
+#
+#  The file 'license_semaphore.py' is part of ERT - Ensemble based Reservoir Tool.
+#
+#  ERT is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+#  FITNESS FOR A PARTICULAR PURPOSE.
+#
+#  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+#  for more details.
+import os
+import os.path
+import errno
+import fcntl
+import time
+
+
+class LicenseSemaphore(object):
+    """Counting semaphore limiting how many instances of a forward model job
+    can run concurrently, implemented with advisory locks on files in the
+    license_path directory. All the locks are released by the operating
+    system when a process terminates, so a job which is killed will never
+    leak a slot.
+
+    The files used for the job NAME are:
+
+      NAME.ticket   : Counter handing out tickets to the waiting processes,
+                      protected by a lock on the file itself.
+
+      NAME.wait.N   : Created by the process holding ticket N, and kept
+                      locked until it has obtained a slot.
+
+      NAME.slot.I   : One file for each of the max_running slots; a slot
+                      is held by keeping an exclusive lock on the file.
+
+    The slots are granted in ticket order: a process only tries to grab a
+    slot when there are no waiters with a smaller ticket. Until then it
+    blocks on the lock of the closest waiter ahead of it in the queue, and
+    is woken as soon as that waiter has a slot or has died. Only the
+    process at the head of the queue polls the slot files, with a short
+    interval.
+    """
+
+    def __init__(self, license_path, name, max_running, poll_interval=0.05):
+        if max_running < 1:
+            raise ValueError("max_running must be positive, got: %s" % max_running)
+
+        self._license_path = license_path
+        self._name = name
+        self._max_running = max_running
+        self._poll_interval = poll_interval
+        self._ticket = None
+        self._wait_fd = None
+        self._slot_fd = None
+        self._slot = None
+
+        if not os.path.isdir(license_path):
+            try:
+                os.makedirs(license_path)
+            except OSError as e:
+                if e.errno != errno.EEXIST:
+                    raise
+
+
+    def __enter__(self):
+        self.acquire()
+        return self
+
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.release()
+
+
+    def __repr__(self):
+        return "LicenseSemaphore(%s, max_running=%d, slot=%s)" % (self._path(""), self._max_running, self._slot)
+
+
+    @property
+    def ticket(self):
+        return self._ticket
+
+
+    @property
+    def slot(self):
+        return self._slot
+
+
+    def _path(self, suffix):
+        return os.path.join(self._license_path, self._name + suffix)
+
+
+    def _wait_file(self, ticket):
+        return self._path(".wait.%d" % ticket)
+
+
+    def _take_ticket(self):
+        """Will draw the next ticket, and create the locked wait file for it
+        while still holding the ticket lock, so that all later tickets will
+        see it.
+        """
+        ticket_fd = os.open(self._path(".ticket"), os.O_RDWR | os.O_CREAT, 0o666)
+        try:
+            fcntl.flock(ticket_fd, fcntl.LOCK_EX)
+            content = os.read(ticket_fd, 64).strip()
+            ticket = int(content) if content else 0
+
+            # The wait file is locked before it gets its final name, a wait
+            # file which can be locked by others belongs to a dead process.
+            tmp_file = self._path(".wait.%d.%d.tmp" % (ticket, os.getpid()))
+            wait_fd = os.open(tmp_file, os.O_RDWR | os.O_CREAT, 0o666)
+            fcntl.flock(wait_fd, fcntl.LOCK_EX)
+            os.rename(tmp_file, self._wait_file(ticket))
+
+            os.lseek(ticket_fd, 0, os.SEEK_SET)
+            os.ftruncate(ticket_fd, 0)
+            os.write(ticket_fd, ("%d\n" % (ticket + 1)).encode("ascii"))
+        finally:
+            os.close(ticket_fd)
+
+        return ticket, wait_fd
+
+
+    def _waiters_ahead(self):
+        prefix = self._name + ".wait."
+        tickets = []
+        for entry in os.listdir(self._license_path):
+            if entry.startswith(prefix):
+                try:
+                    ticket = int(entry[len(prefix):])
+                except ValueError:
+                    continue
+                if ticket < self._ticket:
+                    tickets.append(ticket)
+        return sorted(tickets)
+
+
+    def _wait_for(self, ticket, deadline):
+        """Will block until the process holding @ticket has got a slot or has
+        died; returns False on timeout."""
+        wait_file = self._wait_file(ticket)
+        try:
+            fd = os.open(wait_file, os.O_RDONLY)
+        except OSError as e:
+            if e.errno == errno.ENOENT:
+                return True
+            raise
+
+        try:
+            if deadline is None:
+                fcntl.flock(fd, fcntl.LOCK_SH)
+            else:
+                while True:
+                    try:
+                        fcntl.flock(fd, fcntl.LOCK_SH | fcntl.LOCK_NB)
+                        break
+                    except (IOError, OSError) as e:
+                        if e.errno not in (errno.EAGAIN, errno.EACCES):
+                            raise
+                    if time.time() > deadline:
+                        return False
+                    time.sleep(self._poll_interval)
+
+            # A process which gets a slot removes its wait file before
+            # releasing the lock; if the file is still there the owner
+            # died while waiting.
+            try:
+                if os.fstat(fd).st_ino == os.stat(wait_file).st_ino:
+                    os.unlink(wait_file)
+            except OSError:
+                pass
+        finally:
+            os.close(fd)
+        return True
+
+
+    def _try_slots(self):
+        for slot in range(self._max_running):
+            fd = os.open(self._path(".slot.%d" % slot), os.O_RDWR | os.O_CREAT, 0o666)
+            try:
+                fcntl.flock(fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+            except (IOError, OSError) as e:
+                os.close(fd)
+                if e.errno not in (errno.EAGAIN, errno.EACCES):
+                    raise
+                continue
+
+            self._slot_fd = fd
+            self._slot = slot
+            return True
+        return False
+
+
+    def acquire(self, timeout=None):
+        """Will block until a slot is available; returns True when the slot
+        has been acquired and False if @timeout seconds passed first.
+        """
+        if self._slot is not None:
+            raise ValueError("%s has already been acquired" % self)
+
+        deadline = None if timeout is None else time.time() + timeout
+        self._ticket, self._wait_fd = self._take_ticket()
+        try:
+            while True:
+                ahead = self._waiters_ahead()
+                if ahead:
+                    if not self._wait_for(ahead[-1], deadline):
+                        return False
+                    continue
+
+                if self._try_slots():
+                    return True
+
+                if deadline is not None and time.time() > deadline:
+                    return False
+                time.sleep(self._poll_interval)
+        finally:
+            # Leave the queue; the next waiter is woken when the lock on the
+            # wait file is released.
+            os.unlink(self._wait_file(self._ticket))
+            os.close(self._wait_fd)
+            self._wait_fd = None
+
+
+    def release(self):
+        if self._slot_fd is not None:
+            os.close(self._slot_fd)
+            self._slot_fd = None
+            self._slot = None
@@ -87,6 +87,20 @@ class ErtRPCClient(object):
             raise convertFault(f)
 
 
+    def addSimulations(self, simulations):
+        """
+        Start many simulations with one request; the realizations are
+        initialized in one bulk operation on the server.
+        @type simulations: list[(int, int, int, dict[str, list])]
+        @raise UserWarning if the server is not ready to receive simulations
+        @raise UserWarning if the server is already running a simulation with the same id as one of the sim_ids
+        """
+        try:
+            self._server_proxy.addSimulations([list(simulation) for simulation in simulations])
+        except Fault as f:
+            raise convertFault(f)
+
+
     def isRealizationFinished(self, sim_id):
         """
         Returns true if the realization is finished running.
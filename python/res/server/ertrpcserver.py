@@ -15,7 +15,7 @@ from res.enkf import EnKFMain, NodeId, ResConfig
 from ecl.util.util import BoolVector
 from res.enkf.config import CustomKWConfig
 from res.enkf.data import EnkfNode, CustomKW
-from res.enkf.enums import RealizationStateEnum, EnkfVarType, ErtImplType
+from res.enkf.enums import RealizationStateEnum, ErtImplType
 from res.server import SimulationContext
 from res.server.ertrpcclient import FAULT_CODES
 
@@ -61,6 +61,7 @@ class ErtRPCServer(SimpleXMLRPCServer):
         self.register_function(self.isInitializationCaseAvailable)
         self.register_function(self.startSimulationBatch)
         self.register_function(self.addSimulation)
+        self.register_function(self.addSimulations)
         self.register_function(self.isRealizationFinished)
         self.register_function(self.didRealizationSucceed)
         self.register_function(self.didRealizationFail)
@@ -187,49 +188,57 @@ class ErtRPCServer(SimpleXMLRPCServer):
 
 
     def addSimulation(self, geo_id, pert_id, iens, keywords):
-        if not self.isRunning():
-            raise createFault(UserWarning, "The server is not ready to receive simulations. Have you called startSimulationBatch() first?")
+        self.addSimulations([(geo_id, pert_id, iens, keywords)])
 
-        if self._session.simulation_context.isRealizationQueued(iens):
-            raise createFault(UserWarning, "Simulation with id: '%d' is already running." % iens)
 
-        sim_fs = self._session.simulation_context.get_sim_fs( )
-        self._initializeRealization(sim_fs, geo_id, iens, keywords)
+    def addSimulations(self, simulations):
+        """Will initialize and submit all the simulations in the list
+        @simulations, where each element is a (geo_id, pert_id, iens,
+        keywords) tuple as for addSimulation(). The realizations are
+        initialized in one bulk operation before any of them are submitted.
+        """
+        if not self.isRunning():
+            raise createFault(UserWarning, "The server is not ready to receive simulations. Have you called startSimulationBatch() first?")
 
-        self._session.simulation_context.addSimulation(iens, geo_id)
+        simulation_context = self._session.simulation_context
+        keys = None
+        seen = set()
+        for geo_id, pert_id, iens, keywords in simulations:
+            if simulation_context.isRealizationQueued(iens) or iens in seen:
+                raise createFault(UserWarning, "Simulation with id: '%d' is already running." % iens)
+            seen.add(iens)
 
+            if keys is None:
+                keys = set(keywords.keys())
+            elif set(keywords.keys()) != keys:
+                raise createFault(UserWarning, "All the simulations in a batch must provide the same keywords.")
 
-    def _initializeRealization(self, sim_fs, geo_id, iens, keywords):
-        ens_config = self.ert.ensembleConfig()
+        if not simulations:
+            return
 
-        # Copy all parameter all parameter values which are not given by @keywords from the
-        # the initialization case to the target case.
+        sim_fs = simulation_context.get_sim_fs( )
+        self._initializeRealizations(sim_fs, simulations)
 
-        geo_case_fs = self.ert.getEnkfFsManager().getFileSystem(self._session.geo_case)
-        for kw in ens_config.getKeylistFromVarType(EnkfVarType.PARAMETER):
-            if not kw in keywords:
-                config_node = ens_config[kw]
-                data_node = EnkfNode( config_node )
-                init_id = NodeId(0, geo_id)
-                run_id = NodeId(0, iens)
-                data_node.load(geo_case_fs , init_id)
-                data_node.save(sim_fs, run_id)
+        for geo_id, pert_id, iens, keywords in simulations:
+            simulation_context.addSimulation(iens, geo_id)
 
-        # All the values supplied externally by the keywords list will be written
-        # directly into the result case.
-        for key, values in keywords.items():
-            config_node = ens_config[key]
-            data_node = EnkfNode( config_node )
 
-            gen_kw = data_node.asGenKw()
-            gen_kw.setValues(values)
+    def _initializeRealizations(self, sim_fs, simulations):
+        # All parameter values which are not given by the keywords are copied
+        # from realization geo_id in the initialization case to the target
+        # case, the values supplied externally by the keywords are written
+        # directly into the result case. The result case is fsynced once for
+        # all the realizations.
+        fs_manager = self.ert.getEnkfFsManager()
+        geo_case_fs = fs_manager.getFileSystem(self._session.geo_case)
 
-            run_id = NodeId(0, iens)
-            data_node.save(sim_fs, run_id)
+        source_iens = [geo_id for geo_id, _, _, _ in simulations]
+        target_iens = [iens for _, _, iens, _ in simulations]
+        parameter_values = {}
+        for key in simulations[0][3].keys():
+            parameter_values[key] = [keywords[key] for _, _, _, keywords in simulations]
 
-        sim_fs.fsync()
-        state_map = sim_fs.getStateMap()
-        state_map[iens] = RealizationStateEnum.STATE_INITIALIZED
+        fs_manager.initializeRealizationsFromExisting(geo_case_fs, sim_fs, source_iens, target_iens, parameter_values)
 
 
     def getGenDataResult(self, target_case_name, iens, report_step, keyword):
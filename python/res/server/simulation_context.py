@@ -2,7 +2,7 @@ import os.path
 from ecl.util.util import ArgPack, BoolVector
 
 from res import RES_LIB
-from res.job_queue import JobQueueManager, ForwardModelStatus
+from res.job_queue import JobQueueManager, ForwardModelStatus, ForwardModelResourceSummary
 from res.util import CThreadPool
 from res.enkf.ert_run_context import ErtRunContext
 from res.enkf.run_arg import RunArg
@@ -162,6 +162,16 @@ class SimulationContext(object):
 
 
 
+    def resource_summary(self):
+        """Will return a ForwardModelResourceSummary with the resource usage
+        of the forward model jobs of all the simulations in this context,
+        i.e. for one iteration; simulations which have not yet written a
+        status file are ignored.
+        """
+        runpaths = dict((iens, run_arg.runpath) for iens, run_arg in self._run_args.items())
+        return ForwardModelResourceSummary.load(runpaths)
+
+
     def run_path(self, iens):
         """
         Will return the path to the simulation.
@@ -197,6 +207,23 @@ class SimulationContext(object):
         return self._queue_manager.status_timestamp()
 
 
+    def status_change_count(self):
+        """
+        Will return a counter which is incremented every time a simulation
+        changes status, see wait_status_change().
+        """
+        return self._queue_manager.status_change_count()
+
+
+    def wait_status_change(self, change_count, timeout = None):
+        """
+        Will block until a simulation changes status, or the queue stops,
+        after the counter value @change_count was obtained; returns the new
+        counter value. Returns after @timeout seconds if given.
+        """
+        return self._queue_manager.wait_status_change(change_count, timeout)
+
+
     def progress_timestamp(self, iens = None):
         """
         Will return a timestamp for when the simulation has progressed to a new forward model step.
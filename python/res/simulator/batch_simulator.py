@@ -1,6 +1,6 @@
 from ecl.util.util import BoolVector
 
-from res.enkf import ResConfig, EnKFMain, EnkfConfigNode, EnkfNode, NodeId
+from res.enkf import ResConfig, EnKFMain, EnkfConfigNode
 from .batch_simulator_context import BatchContext
 
 def _slug(entity):
@@ -76,28 +76,30 @@ class BatchSimulator(object):
 
 
     def _setup_case(self, case, file_system):
+        ens_config = self.res_config.ensemble_config
+        parameter_values = dict((control_name, []) for control_name in self.control_keys)
         for sim_id, (geo_id, controls)  in enumerate(case):
             assert isinstance(geo_id, int)
 
-            node_id = NodeId(0, sim_id)
             if set(controls.keys()) != set(self.control_keys):
                 err_msg = "Mismatch between initialized and provided control names."
                 raise KeyError(err_msg)
 
             for control_name, control in controls.items():
-                ens_config = self.res_config.ensemble_config
-                node = EnkfNode(ens_config[control_name])
-                ext_node = node.as_ext_param()
+                var_names = list(ens_config[control_name].getModelConfig().keys())
 
-                if len(ext_node) != len(control.keys()):
+                if len(var_names) != len(control.keys()):
                     err_msg = "Expected %d variables for control: %s, received %d."
-                    err_in = (len(ext_node), control_name, len(control.keys()))
+                    err_in = (len(var_names), control_name, len(control.keys()))
                     raise KeyError(err_msg % err_in)
 
-                for var_name, value in control.items():
-                    ext_node[var_name] = value
+                parameter_values[control_name].append([float(control[var_name]) for var_name in var_names])
 
-                node.save(file_system, node_id)
+        # All the control values are stored with one call per control, and
+        # the case is fsynced once for the whole batch.
+        fs_manager = self.ert.getEnkfFsManager()
+        fs_manager.storeParameterValues(file_system, list(range(len(case))), parameter_values)
+        file_system.fsync()
 
 
     def start(self, case_name, case_data):
@@ -1,4 +1,3 @@
-import time
 from collections import namedtuple
 from res.server import SimulationContext
 from res.enkf import NodeId, EnkfNode
@@ -23,8 +22,9 @@ class BatchContext(SimulationContext):
         """
         Will block until the simulation is complete.
         """
+        change_count = self.status_change_count()
         while self.running():
-            time.sleep(1)
+            change_count = self.wait_status_change(change_count)
 
 
     def running(self):
@@ -74,19 +74,82 @@ class BatchContext(SimulationContext):
         if self.running():
             raise RuntimeError("Simulations are still running - need to wait before gettting results")
 
+        return self._load_results(range(len(self)))
+
+
+    def results_array(self, sim_ids = None):
+        """Will return the results of several simulations as one numpy array
+        for each result key, loaded in one call per key.
+
+        The return value is a dictionary with one 2D array for each of the
+        result keys, where row i holds the result of simulation sim_ids[i].
+        The rows of the simulations which have not succeeded are NaN, and so
+        are the elements beyond the end of results which are shorter than the
+        longest result. By default all the simulations are included, and as
+        for results() they must then all have completed.
+        """
+        if sim_ids is None:
+            if self.running():
+                raise RuntimeError("Simulations are still running - need to wait before gettting results")
+            sim_ids = range(len(self))
+        sim_ids = list(sim_ids)
+
+        arrays = {}
+        succeeded = [self.didRealizationSucceed(sim_id) for sim_id in sim_ids]
+        for key in self.result_keys:
+            config_node = self.res_config.ensemble_config[key]
+            data, _ = EnkfNode.loadGenDataRows(config_node, self.get_sim_fs(), sim_ids)
+            data[np.logical_not(succeeded), :] = np.nan
+            arrays[key] = data
+        return arrays
+
+
+    def iter_results(self):
+        """Will yield a tuple (sim_id, result) for each simulation as soon
+        as it has completed, where result is a dictionary like the elements
+        of the list returned by results(), or None if the simulation failed.
+
+        The simulations are yielded in the order they complete; the
+        generator blocks waiting for the queue to report status changes, and
+        stops when all the simulations have been yielded. If the queue is
+        stopped the simulations which never completed are yielded as None.
+        """
+        remaining = set(range(len(self)))
+        change_count = self.status_change_count()
+        while remaining:
+            # Check running() before collecting the finished simulations, a
+            # simulation which finishes as the queue stops is then included.
+            running = self.running()
+            completed = [sim_id for sim_id in sorted(remaining) if self.isRealizationFinished(sim_id)]
+            if completed:
+                for sim_id, result in zip(completed, self._load_results(completed)):
+                    remaining.remove(sim_id)
+                    yield sim_id, result
+            elif running:
+                change_count = self.wait_status_change(change_count)
+            else:
+                for sim_id in sorted(remaining):
+                    remaining.remove(sim_id)
+                    yield sim_id, None
+
+
+    def _load_results(self, sim_ids):
+        sim_ids = list(sim_ids)
+        rows = {}
+        for key in self.result_keys:
+            config_node = self.res_config.ensemble_config[key]
+            rows[key] = EnkfNode.loadGenDataRows(config_node, self.get_sim_fs(), sim_ids)
+
         res = []
-        nodes = [ EnkfNode(self.res_config.ensemble_config[key]) for key in self.result_keys ]
-        for sim_id in range(len(self)):
-            node_id = NodeId( 0, sim_id)
+        for index, sim_id in enumerate(sim_ids):
             if not self.didRealizationSucceed(sim_id):
-                logging.error('Simulation %d (node %s) failed.' % (sim_id, str(node_id)))
+                logging.error('Simulation %d (node %s) failed.' % (sim_id, str(NodeId(0, sim_id))))
                 res.append(None)
                 continue
+
             d = {}
-            for node in nodes:
-                node.load(self.get_sim_fs(), node_id)
-                data = node.asGenData().getData()
-                d[node.name()] = np.array(data)
+            for key in self.result_keys:
+                data, sizes = rows[key]
+                d[key] = data[index, :max(sizes[index], 0)].copy()
             res.append(d)
-
         return res
@@ -50,6 +50,23 @@ class EnKFFSTest(ResTest):
 
 
 
+    def test_lazy_mount(self):
+        with TestAreaContext("lazy_mount_fs") as work_area:
+            work_area.copy_parent_content(self.config_file)
+
+            fs = EnkfFs(self.mount_point, lazy=True)
+            self.assertFalse(fs.isReadOnly())
+            self.assertEqual(0, fs.numMountedShards())
+            state_map_size = len(fs.getStateMap())
+            fs.umount()
+
+            fs = EnkfFs(self.mount_point, read_only=True)
+            self.assertTrue(fs.isReadOnly())
+            self.assertEqual(0, fs.numMountedShards())
+            self.assertEqual(state_map_size, len(fs.getStateMap()))
+            fs.umount()
+
+
     def test_throws(self):
         with self.assertRaises(Exception):
             fs = EnkfFs("/does/not/exist")
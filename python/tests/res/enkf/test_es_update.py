@@ -1,7 +1,14 @@
+import os
+
+from ecl.util.util import BoolVector
+from ecl.util.test import TestAreaContext
 from tests import ResTest
 from res.test import ErtTestContext
 
-from res.enkf import ESUpdate
+from res.enkf import ESUpdate, ErtRunContext
+from res.enkf.export import GenKwCollector
+from res.util import PathFormat
+from res.util.substitution_list import SubstitutionList
 
 
 class ESUpdateTest(ResTest):
@@ -19,3 +26,93 @@ class ESUpdateTest(ResTest):
             module = es_update.getModule( "STD_ENKF" )
 
 
+    def _update_ministeps(self, ministep_threads):
+        """
+        Updates the snake_oil parameters with three ministeps and
+        returns the updated parameters; the ministeps update different
+        parameters from different observations.
+        """
+        config = self.createTestPath("local/snake_oil/snake_oil.ert")
+        with ErtTestContext("python/enkf/es_update/ministeps_%d" % ministep_threads, config) as context:
+            ert = context.getErt()
+            ert.analysisConfig().setMinistepThreads(ministep_threads)
+
+            local_config = ert.getLocalConfig()
+            local_config.clear()
+            updatestep = local_config.getUpdatestep()
+            for name, obs_keys, param_index in [("A", ["WOPR_OP1_9", "WOPR_OP1_36"], range(0, 4)),
+                                                ("B", ["WOPR_OP1_72", "WOPR_OP1_108"], range(4, 8)),
+                                                ("C", ["WOPR_OP1_144"], range(8, 10))]:
+                ministep = local_config.createMinistep("MINISTEP_%s" % name)
+                obsdata = local_config.createObsdata("OBS_%s" % name)
+                for obs_key in obs_keys:
+                    obsdata.addNode(obs_key)
+
+                dataset = local_config.createDataset("DATA_%s" % name)
+                dataset.addNode("SNAKE_OIL_PARAM")
+                active_list = dataset.getActiveList("SNAKE_OIL_PARAM")
+                for index in param_index:
+                    active_list.addActiveIndex(index)
+
+                ministep.attachObsset(obsdata)
+                ministep.attachDataset(dataset)
+                updatestep.attachMinistep(ministep)
+
+            fs_manager = ert.getEnkfFsManager()
+            sim_fs = fs_manager.getFileSystem("default_0")
+            target_fs = fs_manager.getFileSystem("target")
+            mask = BoolVector(initial_size=ert.getEnsembleSize(), default_value=True)
+            run_context = ErtRunContext.ensemble_smoother(sim_fs, target_fs, mask, PathFormat("path/to/sim%d"),
+                                                          "job%d", SubstitutionList(), 0)
+
+            es_update = ESUpdate(ert)
+            self.assertTrue(es_update.smootherUpdate(run_context))
+
+            prior = GenKwCollector.loadAllGenKwData(ert, "default_0")
+            posterior = GenKwCollector.loadAllGenKwData(ert, "target")
+            self.assertFalse((prior.values == posterior.values).all())
+            return posterior.values.tolist()
+
+
+    def test_ministep_threads(self):
+        # The concurrent update gives every ministep its own random
+        # stream, so the number of threads does not matter; the serial
+        # update keeps the single shared stream.
+        two_threads = self._update_ministeps(2)
+        three_threads = self._update_ministeps(3)
+        self.assertEqual(two_threads, three_threads)
+
+        serial = self._update_ministeps(1)
+        self.assertEqual(serial, self._update_ministeps(1))
+        self.assertNotEqual(serial, three_threads)
+
+
+    def test_counter_engine_iterations(self):
+        """
+        With RANDOM_ENGINE COUNTER the observation perturbations depend on
+        the target case; updating the same prior into the cases of two
+        iterations must give different posteriors.
+        """
+        with TestAreaContext("python/enkf/es_update/counter_engine") as work_area:
+            work_area.copy_parent_content(self.createTestPath("local/snake_oil/snake_oil.ert"))
+            with open("snake_oil.ert", "a") as config_file:
+                config_file.write("\nRANDOM_ENGINE COUNTER\n")
+
+            with ErtTestContext("python/enkf/es_update/counter_engine", os.path.abspath("snake_oil.ert")) as context:
+                ert = context.getErt()
+                fs_manager = ert.getEnkfFsManager()
+                sim_fs = fs_manager.getFileSystem("default_0")
+                mask = BoolVector(initial_size=ert.getEnsembleSize(), default_value=True)
+                es_update = ESUpdate(ert)
+
+                posterior = {}
+                for case in ["iter_1", "iter_2"]:
+                    target_fs = fs_manager.getFileSystem(case)
+                    run_context = ErtRunContext.ensemble_smoother(sim_fs, target_fs, mask, PathFormat("path/to/sim%d"),
+                                                                  "job%d", SubstitutionList(), 0)
+                    self.assertTrue(es_update.smootherUpdate(run_context))
+                    posterior[case] = GenKwCollector.loadAllGenKwData(ert, case).values
+
+                prior = GenKwCollector.loadAllGenKwData(ert, "default_0").values
+                self.assertFalse((prior == posterior["iter_1"]).all())
+                self.assertFalse((posterior["iter_1"] == posterior["iter_2"]).all())
@@ -0,0 +1,84 @@
+from tests import ResTest
+
+from res.test import ErtTestContext
+from res.enkf import EnkfConfigNode, NodeId, EnkfNode
+from res.enkf.enums import RealizationStateEnum
+
+
+class InitRealizationsTest(ResTest):
+
+    def setUp(self):
+        self.config_file = self.createTestPath("local/config/simulation_batch/config.ert")
+
+
+    def _add_controls(self, ert):
+        ens_config = ert.ensembleConfig()
+        ens_config.addNode(EnkfConfigNode.create_ext_param("WELL_ORDER", ["W1", "W2", "W3"]))
+        ens_config.addNode(EnkfConfigNode.create_ext_param("WELL_INJECTION", ["W1", "W4"]))
+        return ens_config
+
+
+    def _load(self, config_node, fs, iens):
+        node = EnkfNode(config_node)
+        node.load(fs, NodeId(0, iens))
+        ext_param = node.as_ext_param()
+        return [ext_param[key] for key in ext_param.keys()]
+
+
+    def test_store_parameter_rows(self):
+        with ErtTestContext("init_realizations_store_rows", self.config_file) as ctx:
+            ert = ctx.getErt()
+            ens_config = self._add_controls(ert)
+            fs_manager = ert.getEnkfFsManager()
+            target_fs = fs_manager.getFileSystem("target")
+
+            fs_manager.storeParameterValues(target_fs, [3, 0],
+                                            {"WELL_ORDER": [[1, 2, 3], [4, 5, 6]]})
+            self.assertEqual([1, 2, 3], self._load(ens_config["WELL_ORDER"], target_fs, 3))
+            self.assertEqual([4, 5, 6], self._load(ens_config["WELL_ORDER"], target_fs, 0))
+
+            with self.assertRaises(ValueError):
+                fs_manager.storeParameterValues(target_fs, [0], {"WELL_ORDER": [[1, 2]]})
+
+            with self.assertRaises(ValueError):
+                fs_manager.storeParameterValues(target_fs, [0, 1], {"WELL_ORDER": [[1, 2, 3]]})
+
+
+    def test_init_realizations_from_existing(self):
+        with ErtTestContext("init_realizations_from_existing", self.config_file) as ctx:
+            ert = ctx.getErt()
+            ens_config = self._add_controls(ert)
+            fs_manager = ert.getEnkfFsManager()
+            source_fs = fs_manager.getFileSystem("source")
+            target_fs = fs_manager.getFileSystem("target")
+
+            order = EnkfNode(ens_config["WELL_ORDER"])
+            injection = EnkfNode(ens_config["WELL_INJECTION"])
+            for iens in range(4):
+                order.as_ext_param().set_vector([iens, 10 * iens, 100 * iens])
+                order.save(source_fs, NodeId(0, iens))
+                injection.as_ext_param().set_vector([iens + 1, 3 * (iens + 1)])
+                injection.save(source_fs, NodeId(0, iens))
+
+            # Geo realization 2 is the source of two of the targets.
+            source_iens = [2, 2, 0, 3]
+            target_iens = [0, 1, 2, 3]
+            injection_rows = [[-1, -2], [-3, -4], [-5, -6], [-7, -8]]
+            fs_manager.initializeRealizationsFromExisting(source_fs, target_fs, source_iens, target_iens,
+                                                          parameter_values={"WELL_INJECTION": injection_rows})
+
+            state_map = target_fs.getStateMap()
+            for source, target, row in zip(source_iens, target_iens, injection_rows):
+                self.assertEqual(RealizationStateEnum.STATE_INITIALIZED, state_map[target])
+                self.assertEqual([source, 10 * source, 100 * source],
+                                 self._load(ens_config["WELL_ORDER"], target_fs, target))
+
+                # WELL_INJECTION is skipped by the copy, the stored rows must
+                # not be overwritten with the values from the source.
+                self.assertEqual(row, self._load(ens_config["WELL_INJECTION"], target_fs, target))
+
+            # The source case is left untouched.
+            self.assertEqual([3, 9], self._load(ens_config["WELL_INJECTION"], source_fs, 2))
+
+            with self.assertRaises(ValueError):
+                fs_manager.initializeRealizationsFromExisting(source_fs, target_fs, [0, 1], [0])
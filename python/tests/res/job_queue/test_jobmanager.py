@@ -4,11 +4,12 @@ import os.path
 import stat
 import time
 import datetime
+import sys
 from unittest import TestCase
 
 from ecl.util.test import TestAreaContext
 from res.job_queue import JobManager
-from res.job_queue import ForwardModelStatus
+from res.job_queue import ForwardModelStatus, ForwardModelResourceSummary
 
 # Test data generated by ForwardModel
 JSON_STRING = """
@@ -59,10 +60,12 @@ JSON_STRING_NO_DATA_ROOT = """
 def gen_area_name(base, f):
     return base + "_" + f.__name__.split("_")[-1]
 
-def create_jobs_json(jobList, umask="0000"):
+def create_jobs_json(jobList, umask="0000", result_files=None):
     data = {"umask"     : umask,
             "DATA_ROOT" : "/path/to/data",
             "jobList"   : jobList}
+    if result_files is not None:
+        data["result_files"] = result_files
 
     jobs_file = os.path.join(os.getcwd(), "jobs.json")
     with open(jobs_file, "w") as f:
@@ -220,11 +223,112 @@ class JobManagerTest(TestCase):
                 self.assertTrue(not os.path.exists(f))
             self.assertTrue(os.path.exists(jobm.STATUS_file))
 
-            jobm.sleep_time = 0
             jobm.createOKFile()
             self.assertTrue(os.path.exists(jobm.OK_file))
 
 
+    def test_ok_file_list(self):
+        with TestAreaContext("ok_file_list"):
+            with open("old_file", "w") as f:
+                f.write("Written before the job manager started")
+            old_time = time.time() - 3600
+            os.utime("old_file", (old_time, old_time))
+
+            script = ("mkdir -p sub && echo 12345 > sub/poly_3.out && echo 1 > sub/poly_3.out_active"
+                      " && echo 123 > CASE.UNSMRY && echo 12 > CASE.X0003 && echo scratch > sub/scratch")
+            create_jobs_json([{"name" : "RESULT",
+                               "executable" : "/bin/sh",
+                               "argList" : ["-c", script]}],
+                             result_files=["sub/poly_*.out"])
+            jobm = JobManager()
+            exit_status, msg = jobm.runJob(jobm[0])
+            self.assertEqual(exit_status, 0)
+            jobm.createOKFile()
+
+            self.assertTrue(os.path.isfile(jobm.OK_file))
+            self.assertFalse(os.path.exists(".%s.tmp" % jobm.OK_file))
+            with open(jobm.OK_file) as f:
+                lines = f.read().splitlines()
+            self.assertTrue(lines[0].startswith("All jobs complete"))
+
+            files = {}
+            for line in lines[1:]:
+                tag, size, path = line.split(" ", 2)
+                self.assertEqual(tag, "FILE")
+                files[path] = int(size)
+
+            self.assertEqual(files[os.path.join("sub", "poly_3.out")], 6)
+            self.assertEqual(files[os.path.join("sub", "poly_3.out_active")], 2)
+            self.assertEqual(files["CASE.UNSMRY"], 4)
+            self.assertEqual(files["CASE.X0003"], 3)
+            self.assertEqual(len(files), 4)
+            self.assertNotIn(os.path.join("sub", "scratch"), files)
+            self.assertNotIn("STATUS", files)
+            self.assertNotIn("old_file", files)
+            self.assertNotIn(jobm.OK_file, files)
+            for path, size in files.items():
+                self.assertEqual(os.path.getsize(path), size)
+
+
+    def test_resources(self):
+        with TestAreaContext("job_resources"):
+            root = os.getcwd()
+            runpaths = {}
+            for iens in range(3):
+                run_path = os.path.join(root, "realization-%d" % iens)
+                os.makedirs(run_path)
+                os.chdir(run_path)
+                runpaths[iens] = run_path
+
+                # Allocates and touches (iens + 1) * 4 MB, and writes 1 MB.
+                script = ("data = bytearray(%d * 4 * 1024 * 1024)\n"
+                          "sum(1 for i in range(0, len(data), 4096))\n"
+                          "open('RESULT', 'wb').write(b'x' * 1024 * 1024)\n") % (iens + 1)
+                create_jobs_json([{"name" : "ALLOC",
+                                   "executable" : sys.executable,
+                                   "argList" : ["-c", script]},
+                                  {"name" : "SLEEP",
+                                   "executable" : "/bin/sh",
+                                   "argList" : ["-c", "exit 0"]}])
+                jobm = JobManager()
+                for job in jobm:
+                    exit_status, msg = jobm.runJob(job)
+                    self.assertEqual(exit_status, 0)
+                jobm.complete()
+
+                status = ForwardModelStatus.load(run_path)
+                resources = status.jobs[0].resources
+                for key in ["max_rss", "user_time", "system_time", "read_bytes",
+                            "write_bytes", "read_chars", "write_chars"]:
+                    self.assertIn(key, resources)
+
+                self.assertTrue(resources["max_rss"] >= (iens + 1) * 4 * 1024 * 1024)
+                self.assertTrue(resources["user_time"] + resources["system_time"] > 0)
+                if resources["write_chars"] is not None:
+                    self.assertTrue(resources["write_chars"] >= 1024 * 1024)
+                self.assertTrue(status.jobs[1].resources["max_rss"] < resources["max_rss"])
+                os.chdir(root)
+
+            summary = ForwardModelResourceSummary.load(runpaths)
+            self.assertEqual(summary.job_names, ["ALLOC", "SLEEP"])
+            self.assertEqual(summary["ALLOC"]["count"], 3)
+            self.assertEqual(summary["ALLOC"]["max_rss_realization"], 2)
+            self.assertTrue(summary["ALLOC"]["max_rss"] >= 3 * 4 * 1024 * 1024)
+            self.assertTrue(summary["ALLOC"]["mean_rss"] < summary["ALLOC"]["max_rss"])
+            self.assertNotIn("MISSING", summary)
+
+            # Status files from before the resources were recorded.
+            with open(os.path.join(runpaths[0], ForwardModelStatus.STATUS_FILE)) as f:
+                data = json.load(f)
+            for job in data["jobs"]:
+                del job["resources"]
+            with open(os.path.join(runpaths[0], ForwardModelStatus.STATUS_FILE), "w") as f:
+                json.dump(data, f)
+            status = ForwardModelStatus.load(runpaths[0])
+            self.assertIsNone(status.jobs[0].resources)
+            self.assertEqual(ForwardModelResourceSummary.load(runpaths)["ALLOC"]["count"], 2)
+
+
     def test_run_job(self):
         with TestAreaContext(gen_area_name("run_job_fail", create_jobs_json)):
             with open("run.sh", "w") as f:
@@ -0,0 +1,159 @@
+import os
+import os.path
+import signal
+import time
+from unittest import TestCase
+
+from ecl.util.test import TestAreaContext
+from res.job_queue import LicenseSemaphore
+
+
+def fork_child(target, *args):
+    pid = os.fork()
+    if pid == 0:
+        exit_status = 1
+        try:
+            target(*args)
+            exit_status = 0
+        finally:
+            os._exit(exit_status)
+    return pid
+
+
+def log(log_file, msg):
+    fd = os.open(log_file, os.O_WRONLY | os.O_APPEND | os.O_CREAT, 0o666)
+    os.write(fd, ("%s\n" % msg).encode("ascii"))
+    os.close(fd)
+
+
+class LoggingSemaphore(LicenseSemaphore):
+    """Logs the ticket when a slot has been taken, while the process still
+    holds the lock on its wait file; the next waiter can not proceed until
+    that lock is released, so the log order is the order the slots were
+    granted in."""
+
+    def __init__(self, license_path, name, max_running, log_file):
+        super(LoggingSemaphore, self).__init__(license_path, name, max_running)
+        self._log_file = log_file
+
+    def _try_slots(self):
+        if super(LoggingSemaphore, self)._try_slots():
+            log(self._log_file, "ACQUIRE %d %d %.6f" % (os.getpid(), self.ticket, time.time()))
+            return True
+        return False
+
+
+def run_job(license_path, max_running, log_file, hold_time):
+    sem = LoggingSemaphore(license_path, "JOB", max_running, log_file)
+    sem.acquire()
+    time.sleep(hold_time)
+    log(log_file, "RELEASE %d %d %.6f" % (os.getpid(), sem.ticket, time.time()))
+    sem.release()
+
+
+def hold_forever(license_path, max_running):
+    sem = LicenseSemaphore(license_path, "JOB", max_running)
+    sem.acquire()
+    log("held", sem.slot)
+    while True:
+        time.sleep(1)
+
+
+class LicenseSemaphoreTest(TestCase):
+
+    def test_acquire(self):
+        with TestAreaContext("license_semaphore_acquire"):
+            with self.assertRaises(ValueError):
+                LicenseSemaphore("license", "JOB", 0)
+
+            sem1 = LicenseSemaphore("license", "JOB", 2)
+            sem2 = LicenseSemaphore("license", "JOB", 2)
+            sem3 = LicenseSemaphore("license", "JOB", 2)
+            other = LicenseSemaphore("license", "OTHER", 1)
+
+            self.assertTrue(sem1.acquire())
+            self.assertTrue(sem2.acquire(timeout=1))
+            self.assertNotEqual(sem1.slot, sem2.slot)
+            self.assertEqual(sem2.ticket, sem1.ticket + 1)
+            with self.assertRaises(ValueError):
+                sem1.acquire()
+
+            t0 = time.time()
+            self.assertFalse(sem3.acquire(timeout=0.2))
+            self.assertTrue(time.time() - t0 >= 0.2)
+            self.assertIsNone(sem3.slot)
+
+            with other:
+                self.assertEqual(other.slot, 0)
+            self.assertIsNone(other.slot)
+
+            sem1.release()
+            self.assertTrue(sem3.acquire(timeout=1))
+            sem3.release()
+            sem2.release()
+            sem2.release()
+
+            # No wait files should be left behind.
+            self.assertEqual([f for f in os.listdir("license") if ".wait." in f], [])
+
+
+    def test_killed_holder(self):
+        with TestAreaContext("license_semaphore_killed"):
+            pid = fork_child(hold_forever, "license", 1)
+            while not os.path.isfile("held"):
+                time.sleep(0.01)
+
+            sem = LicenseSemaphore("license", "JOB", 1)
+            self.assertFalse(sem.acquire(timeout=0.1))
+
+            # A process which is killed waiting for a slot must not block
+            # the queue either.
+            waiter = fork_child(run_job, "license", 1, "log", 0)
+            time.sleep(0.2)
+            os.kill(waiter, signal.SIGKILL)
+            os.waitpid(waiter, 0)
+
+            os.kill(pid, signal.SIGKILL)
+            os.waitpid(pid, 0)
+            t0 = time.time()
+            self.assertTrue(sem.acquire(timeout=5))
+            self.assertTrue(time.time() - t0 < 1)
+            sem.release()
+
+
+    def test_stress(self):
+        with TestAreaContext("license_semaphore_stress"):
+            num_jobs = 40
+            max_running = 4
+            hold_time = 0.05
+
+            t0 = time.time()
+            pids = []
+            for i in range(num_jobs):
+                pids.append(fork_child(run_job, "license", max_running, "log", hold_time))
+
+            for pid in pids:
+                _, exit_status = os.waitpid(pid, 0)
+                self.assertEqual(exit_status, 0)
+            elapsed = time.time() - t0
+
+            with open("log") as f:
+                events = [line.split() for line in f.read().splitlines()]
+
+            # The ACQUIRE entries are appended in the order the slots were
+            # granted, which must be exactly the ticket order.
+            acquired = [int(event[2]) for event in events if event[0] == "ACQUIRE"]
+            self.assertEqual(acquired, list(range(num_jobs)))
+
+            running = 0
+            max_seen = 0
+            for event in sorted(events, key=lambda event: float(event[3])):
+                if event[0] == "ACQUIRE":
+                    running += 1
+                else:
+                    running -= 1
+                max_seen = max(max_seen, running)
+            self.assertTrue(max_seen <= max_running)
+
+            ideal = num_jobs * hold_time / max_running
+            self.assertTrue(elapsed < ideal + 5)
@@ -163,6 +163,36 @@ class RPCServiceTest(ResTest):
             self.assertTrue(all(success for success in thread_success_state.values()))
 
 
+    def test_add_simulations(self):
+        with RPCServiceContext("ert/server/rpc/add_simulations", self.config, store_area=True) as server:
+            target_case_name = "default_1"
+            client = ErtRPCClient("localhost", server.port)
+            client.startSimulationBatch(target_case_name, target_case_name, 3)
+
+            simulations = []
+            for iens in range(3):
+                keywords = {"SNAKE_OIL_PARAM": [0.50, iens + 2, 1.750, 0.250, 0.990, 2 + 3 - iens, 1.770, 0.330, 0.550, 0.770]}
+                simulations.append((0, 0, iens, keywords))
+
+            # The same realization twice in one batch
+            with self.assertRaises(UserWarning):
+                client.addSimulations([simulations[0], simulations[0]])
+
+            client.addSimulations(simulations)
+            for iens in range(3):
+                self.assertTrue(realizationIsInitialized(server.ert, target_case_name, iens))
+
+            # Already queued
+            with self.assertRaises(UserWarning):
+                client.addSimulations(simulations[1:])
+
+            while client.isRunning():
+                time.sleep(0.5)
+
+            for iens in range(3):
+                self.assertTrue(client.didRealizationSucceed(iens))
+
+
     def test_runtime_geoid(self):
         config_rel_path = "local/snake_oil_no_data/snake_oil_GEO_ID.ert"
         geoid_config_path = self.createTestPath(config_rel_path)
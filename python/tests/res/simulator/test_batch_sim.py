@@ -222,6 +222,54 @@ class BatchSimulatorTest(ResTest):
             self.assertTrue( isinstance(monitor.sim_context, BatchContext))
 
 
+    def test_streaming_results(self):
+        config_file = self.createTestPath("local/batch_sim/batch_sim.ert")
+        with TestAreaContext("batch_sim_stream") as test_area:
+            test_area.copy_parent_content(config_file)
+            res_config = ResConfig(user_config_file=os.path.basename(config_file))
+
+            rsim = BatchSimulator(res_config,
+                                  {
+                                      "WELL_ORDER" : ["W1", "W2", "W3"],
+                                      "WELL_ON_OFF" : ["W1", "W2", "W3"]
+                                  },
+                                  ["ORDER", "ON_OFF"])
+
+            case_data = []
+            for sim_id in range(8):
+                case_data.append((1 + sim_id % 2,
+                                  {
+                                      "WELL_ORDER": {"W1": sim_id, "W2": sim_id + 1, "W3": sim_id + 2},
+                                      "WELL_ON_OFF": {"W1": -sim_id, "W2": 2 * sim_id, "W3": 3}
+                                  }))
+
+            ctx = rsim.start("stream_case", case_data)
+            streamed = {}
+            for sim_id, result in ctx.iter_results():
+                self.assertNotIn(sim_id, streamed)
+                streamed[sim_id] = result
+            self.assertFalse(ctx.running())
+            self.assertEqual(sorted(streamed.keys()), list(range(len(case_data))))
+
+            results = ctx.results()
+            arrays = ctx.results_array()
+            subset = ctx.results_array([5, 2])
+            for res_key, ctrl_key in (("ORDER", "WELL_ORDER"), ("ON_OFF", "WELL_ON_OFF")):
+                self.assertEqual(arrays[res_key].shape, (len(case_data), 3))
+                self.assertEqual(subset[res_key].shape, (2, 3))
+                for sim_id, (_, controls) in enumerate(case_data):
+                    expected = [controls[ctrl_key][var_name]**2 for var_name in ["W1", "W2", "W3"]]
+                    self.assertEqual(expected, list(streamed[sim_id][res_key]))
+                    self.assertEqual(expected, list(results[sim_id][res_key]))
+                    self.assertEqual(expected, list(arrays[res_key][sim_id]))
+                self.assertEqual(list(arrays[res_key][5]), list(subset[res_key][0]))
+                self.assertEqual(list(arrays[res_key][2]), list(subset[res_key][1]))
+
+            # The context is complete; join() and a new iteration return at once.
+            ctx.join()
+            self.assertEqual(len(list(ctx.iter_results())), len(case_data))
+
+
     def test_stop_sim(self):
         config_file = self.createTestPath("local/batch_sim/batch_sim.ert")
         with TestAreaContext("batch_sim_stop") as test_area:
@@ -0,0 +1,66 @@
+import os
+import time
+
+from ecl.util.test import TestAreaContext
+
+from res.simulator import BatchSimulator
+from res.enkf import ResConfig
+
+from tests import ResTest
+
+
+FAST_SQUARE_PARAMS = """#!/usr/bin/env python
+import json
+
+def copy_file(input_file, output_file):
+    data = json.load(open(input_file))
+    with open(output_file, "w") as f:
+        for key in ["W1", "W2", "W3"]:
+            f.write("%g\\n" % (data[key] * data[key]))
+
+if __name__ == "__main__":
+    copy_file("WELL_ORDER.json", "ORDER_0")
+    copy_file("WELL_ON_OFF.json", "ON_OFF_0")
+"""
+
+
+class RealizationOverheadTest(ResTest):
+
+    def test_realization_overhead(self):
+        # Runs a batch of realizations with a near instant forward model
+        # through the local queue driver and the job dispatcher. The job
+        # manager used to sleep ten seconds after creating the OK file,
+        # so no realization could complete in less than ten seconds.
+        config_file = self.createTestPath("local/batch_sim/batch_sim.ert")
+        num_realizations = 10
+
+        with TestAreaContext("realization_overhead") as test_area:
+            test_area.copy_parent_content(config_file)
+            with open("jobs/square_params.py", "w") as f:
+                f.write(FAST_SQUARE_PARAMS)
+
+            with open("batch_sim.ert", "a") as f:
+                f.write("\nQUEUE_OPTION LOCAL MAX_RUNNING %d\n" % num_realizations)
+
+            res_config = ResConfig(user_config_file="batch_sim.ert")
+            rsim = BatchSimulator(res_config,
+                                  {"WELL_ORDER" : ["W1", "W2", "W3"],
+                                   "WELL_ON_OFF" : ["W1", "W2", "W3"]},
+                                  ["ORDER", "ON_OFF"])
+
+            case_data = [(1, {"WELL_ORDER" : {"W1": i, "W2": i + 1, "W3": i + 2},
+                              "WELL_ON_OFF" : {"W1": 1, "W2": 0, "W3": 1}})
+                         for i in range(num_realizations)]
+
+            start = time.time()
+            ctx = rsim.start("case", case_data)
+            while ctx.running():
+                time.sleep(0.1)
+            elapsed = time.time() - start
+
+            results = ctx.results()
+            self.assertEqual(len(results), num_realizations)
+            for i, result in enumerate(results):
+                self.assertEqual([i * i, (i + 1) ** 2, (i + 2) ** 2], list(result["ORDER"]))
+
+            self.assertTrue(elapsed < 10.0, "Running %d realizations took %.1f s" % (num_realizations, elapsed))